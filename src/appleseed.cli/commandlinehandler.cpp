@@ -73,8 +73,8 @@ CommandLineHandler::CommandLineHandler()
         &m_threads
             .add_name("--threads")
             .add_name("-t")
-            .set_description("set the number of rendering threads")
-            .set_syntax("n")
+            .set_description("set the number of rendering threads and optionally their placement (none, compact or scatter)")
+            .set_syntax("n[:placement]")
             .set_exact_value_count(1));
 
     parser().add_option_handler(
@@ -158,6 +158,18 @@ CommandLineHandler::CommandLineHandler()
             .add_name("--disable-autosave")
             .set_description("disable automatic saving of rendered images"));
 
+    parser().add_option_handler(
+        &m_write_in_background
+            .add_name("--write-in-background")
+            .set_description("write the output images of the project in the background while the frame is archived"));
+
+    parser().add_option_handler(
+        &m_profile_shader_groups
+            .add_name("--profile-shader-groups")
+            .set_description("profile shader group executions and write the results to a JSON (.json) or CSV file")
+            .set_syntax("filename")
+            .set_exact_value_count(1));
+
     parser().add_option_handler(
         &m_run_unit_tests
             .add_name("--run-unit-tests")
@@ -78,6 +78,8 @@ class CommandLineHandler
     foundation::FlagOptionHandler                   m_send_to_mplay;
     foundation::ValueOptionHandler<int>             m_send_to_hrmanpipe;
     foundation::FlagOptionHandler                   m_disable_autosave;
+    foundation::FlagOptionHandler                   m_write_in_background;
+    foundation::ValueOptionHandler<std::string>     m_profile_shader_groups;
 
     // Developer-oriented options.
     foundation::ValueOptionHandler<std::string>     m_run_unit_tests;
@@ -46,8 +46,10 @@
 #include "renderer/api/project.h"
 #include "renderer/api/rendering.h"
 #include "renderer/api/scene.h"
+#include "renderer/api/shadergroup.h"
 #include "renderer/api/surfaceshader.h"
 #include "renderer/api/utility.h"
+#include "renderer/kernel/shading/shadergroupprofiler.h"
 
 // appleseed.foundation headers.
 #include "foundation/platform/console.h"
@@ -399,12 +401,27 @@ namespace
         if (g_cl.m_disable_autosave.is_set())
             params.insert_path("autosave", false);
 
+        // Apply --profile-shader-groups option.
+        if (g_cl.m_profile_shader_groups.is_set())
+            params.insert_path("profile_shader_groups", true);
+
         // Apply --threads option.
         if (g_cl.m_threads.is_set())
         {
+            // The value has the form n[:placement], e.g. "auto:scatter" or "16:compact".
+            const string& threads = g_cl.m_threads.value();
+            const size_t separator = threads.find(':');
+
             params.insert_path(
                 "rendering_threads",
-                g_cl.m_threads.value());
+                threads.substr(0, separator));
+
+            if (separator != string::npos)
+            {
+                params.insert_path(
+                    "thread_placement",
+                    threads.substr(separator + 1));
+            }
         }
 
         // Apply --resolution option.
@@ -590,6 +607,21 @@ namespace
             "rendering finished in %s.",
             pretty_time(result.m_render_time, 3).c_str());
 
+        // Start writing the output images of the project while the frame is archived.
+        // The images are copied first, so the frame is left untouched.
+        bool write_in_background = false;
+        if (g_cl.m_write_in_background.is_set())
+        {
+            if (g_cl.m_output.is_set())
+                LOG_WARNING(g_logger, "--write-in-background is ignored when --output is used.");
+            else
+            {
+                project->get_frame()->write_main_and_aov_images_async(
+                    project->get_rendering_thread_count());
+                write_in_background = true;
+            }
+        }
+
         // Archive the frame to disk.
         char* archive_path = nullptr;
         if (params.get_optional<bool>("autosave", true))
@@ -613,9 +645,21 @@ namespace
             project->get_frame()->write_main_image(file_path);
             project->get_frame()->write_aov_images(file_path);
         }
+        else if (write_in_background)
+        {
+            project->get_frame()->wait_for_pending_image_writes();
+        }
         else
         {
-            project->get_frame()->write_main_and_aov_images();
+            project->get_frame()->write_main_and_aov_images(
+                project->get_rendering_thread_count());
+        }
+
+        // Write the shader group profile to disk.
+        if (g_cl.m_profile_shader_groups.is_set())
+        {
+            project->get_shader_group_profiler().write(
+                g_cl.m_profile_shader_groups.value().c_str());
         }
 
 #if defined __APPLE__ || defined _WIN32
@@ -56,6 +56,7 @@
 #include "foundation/platform/_endexrheaders.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <vector>
@@ -157,40 +158,55 @@ void write_tiles(
 {
     const CanvasProperties& props = image.properties();
     const PixelType pixel_type = get_imf_pixel_type(props);
+    const size_t channel_size = Pixel::size(props.m_pixel_format);
+    const size_t stride_x = channel_size * props.m_channel_count;
+    const size_t stride_y = stride_x * props.m_canvas_width;
+
+    // Tiles are written one row of tiles at a time so that OpenEXR can compress
+    // the tiles of a row in parallel. Since the tiles of a canvas are not stored
+    // contiguously, each row of tiles is first copied to a band buffer.
+    vector<char> band(stride_y * props.m_tile_height);
 
-    // Write tiles.
     for (size_t y = 0; y < props.m_tile_count_y; ++y)
     {
+        const int iy = static_cast<int>(y);
+        const Box2i band_range = file.dataWindowForTile(0, iy);
+
+        // Copy the tiles of this row to the band buffer.
         for (size_t x = 0; x < props.m_tile_count_x; ++x)
         {
-            const int ix              = static_cast<int>(x);
-            const int iy              = static_cast<int>(y);
-            const Box2i range         = file.dataWindowForTile(ix, iy);
-            const Tile& tile          = image.tile(x, y);
-            const size_t channel_size = Pixel::size(tile.get_pixel_format());
-            const size_t stride_x     = channel_size * props.m_channel_count;
-            const size_t stride_y     = stride_x * tile.get_width();
-            const size_t tile_origin  = range.min.x * stride_x + range.min.y * stride_y;
-            const char* tile_base     = reinterpret_cast<const char*>(tile.pixel(0, 0)) - tile_origin;
-
-            // Construct FrameBuffer object.
-            FrameBuffer framebuffer;
-            for (size_t c = 0; c < channel_count; ++c)
+            const Tile& tile = image.tile(x, y);
+            const size_t tile_stride_y = stride_x * tile.get_width();
+            const char* src = reinterpret_cast<const char*>(tile.pixel(0, 0));
+            char* dest = &band[x * props.m_tile_width * stride_x];
+
+            for (size_t ty = 0, th = tile.get_height(); ty < th; ++ty)
             {
-                const char* base = tile_base + c * channel_size;
-                framebuffer.insert(
-                    channel_names[c],
-                    Slice(
-                        pixel_type,
-                        const_cast<char*>(base),
-                        stride_x,
-                        stride_y));
+                std::copy(src, src + tile_stride_y, dest);
+                src += tile_stride_y;
+                dest += stride_y;
             }
+        }
 
-            // Write tile.
-            file.setFrameBuffer(framebuffer);
-            file.writeTile(ix, iy);
+        // Construct FrameBuffer object.
+        const size_t band_origin = band_range.min.x * stride_x + band_range.min.y * stride_y;
+        const char* band_base = &band[0] - band_origin;
+        FrameBuffer framebuffer;
+        for (size_t c = 0; c < channel_count; ++c)
+        {
+            const char* base = band_base + c * channel_size;
+            framebuffer.insert(
+                channel_names[c],
+                Slice(
+                    pixel_type,
+                    const_cast<char*>(base),
+                    stride_x,
+                    stride_y));
         }
+
+        // Write the row of tiles.
+        file.setFrameBuffer(framebuffer);
+        file.writeTiles(0, static_cast<int>(props.m_tile_count_x) - 1, iy, iy);
     }
 }
 
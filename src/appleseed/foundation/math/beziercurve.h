@@ -31,6 +31,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
+#include "foundation/math/basis.h"
 #include "foundation/math/bezier.h"
 #include "foundation/math/matrix.h"
 #include "foundation/math/minmax.h"
@@ -89,6 +90,11 @@ class BezierCurveBase
     AABBType compute_bbox() const;
     ValueType compute_max_width() const;
 
+    // Compute the bounding box of the control points in an orthonormal frame that follows
+    // the curve: the first axis is along the chord of the curve and the second one points
+    // toward the control point furthest from the chord. The axes are returned in 'axes'.
+    AABBType compute_oriented_bbox(VectorType axes[3]) const;
+
   protected:
     template <typename>
     friend class BezierCurveIntersector;
@@ -339,6 +345,64 @@ inline T BezierCurveBase<T, N>::compute_max_width() const
     return max_width;
 }
 
+template <typename T, size_t N>
+typename BezierCurveBase<T, N>::AABBType BezierCurveBase<T, N>::compute_oriented_bbox(VectorType axes[3]) const
+{
+    const VectorType chord = m_ctrl_pts[N] - m_ctrl_pts[0];
+    const ValueType chord_length = norm(chord);
+
+    if (chord_length > ValueType(0.0))
+    {
+        axes[0] = chord / chord_length;
+
+        VectorType bend(ValueType(0.0));
+        ValueType bend_length(0.0);
+
+        for (size_t i = 1; i < N; ++i)
+        {
+            const VectorType d = m_ctrl_pts[i] - m_ctrl_pts[0];
+            const VectorType offset = d - dot(d, axes[0]) * axes[0];
+            const ValueType offset_length = norm(offset);
+
+            if (bend_length < offset_length)
+            {
+                bend = offset;
+                bend_length = offset_length;
+            }
+        }
+
+        if (bend_length > ValueType(1.0e-4) * chord_length)
+        {
+            axes[1] = bend / bend_length;
+            axes[2] = normalize(cross(axes[0], axes[1]));
+        }
+        else
+        {
+            // The curve is straight: any frame around the chord will do.
+            const Basis3<ValueType> basis(axes[0]);
+            axes[1] = basis.get_tangent_u();
+            axes[2] = basis.get_tangent_v();
+        }
+    }
+    else
+    {
+        axes[0] = VectorType(ValueType(1.0), ValueType(0.0), ValueType(0.0));
+        axes[1] = VectorType(ValueType(0.0), ValueType(1.0), ValueType(0.0));
+        axes[2] = VectorType(ValueType(0.0), ValueType(0.0), ValueType(1.0));
+    }
+
+    AABBType bbox;
+    bbox.invalidate();
+
+    for (size_t i = 0; i < N + 1; ++i)
+    {
+        const VectorType& p = m_ctrl_pts[i];
+        bbox.insert(VectorType(dot(axes[0], p), dot(axes[1], p), dot(axes[2], p)));
+    }
+
+    return bbox;
+}
+
 template <typename T, size_t N>
 inline typename BezierCurveBase<T, N>::VectorType BezierCurveBase<T, N>::transform_point(const MatrixType& xfm, const VectorType& p)
 {
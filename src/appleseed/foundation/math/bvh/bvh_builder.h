@@ -32,11 +32,17 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/stopwatch.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class Logger; }
 
 namespace foundation {
 namespace bvh {
@@ -65,6 +71,11 @@ namespace bvh {
 //              const AABBType&     bbox);
 //      };
 //
+// The multithreaded build() method additionally requires that compute_bbox() and
+// partition() may be called concurrently on disjoint sets of items, as long as none
+// of these sets contains more than half of all the items. All partitioners derived
+// from foundation::bvh::PartitionerBase satisfy this requirement.
+//
 
 template <typename Tree, typename Partitioner>
 class Builder
@@ -82,23 +93,79 @@ class Builder
         const size_t    size,
         const size_t    items_per_leaf_hint);
 
+    // Build a tree using multiple threads. The resulting tree is identical
+    // to the one produced by the single-threaded version of build().
+    template <typename Timer>
+    void build(
+        Tree&           tree,
+        Partitioner&    partitioner,
+        const size_t    size,
+        const size_t    items_per_leaf_hint,
+        Logger&         logger,
+        const size_t    thread_count);
+
     // Return the construction time.
     double get_build_time() const;
 
+    // Return the time spent by each thread building subtrees.
+    const std::vector<double>& get_thread_build_times() const;
+
   private:
+    typedef typename Tree::NodeVectorType NodeVectorType;
     typedef typename Tree::NodeType NodeType;
     typedef typename NodeType::AABBType AABBType;
 
-    double m_build_time;
+    // Number of subtrees per thread in a multithreaded build, for load balancing.
+    static const size_t SubtreesPerThread = 8;
 
-    // Recursively subdivide the tree.
+    // Minimum number of items in a subtree built by a separate job.
+    static const size_t MinSubtreeSize = 1024;
+
+    struct Subtree
+    {
+        size_t          m_node_index;       // index of the root of the subtree in the top-level tree
+        size_t          m_begin;
+        size_t          m_end;
+        AABBType        m_bbox;
+        NodeVectorType  m_nodes;
+
+        Subtree(
+            const size_t            node_index,
+            const size_t            begin,
+            const size_t            end,
+            const AABBType&         bbox,
+            const NodeVectorType&   nodes);
+    };
+
+    typedef std::vector<Subtree> SubtreeVector;
+
+    template <typename Timer> class SubtreeBuildJob;
+
+    double                  m_build_time;
+    std::vector<double>     m_thread_build_times;
+
+    // Recursively subdivide the tree. If 'subtrees' is not null, sets of items
+    // containing at most 'subtree_size' items are not subdivided but collected
+    // into 'subtrees' instead.
     void subdivide_recurse(
-        Tree&           tree,
+        NodeVectorType& nodes,
         Partitioner&    partitioner,
         const size_t    node_index,
         const size_t    begin,
         const size_t    end,
-        const AABBType& bbox);
+        const AABBType& bbox,
+        const size_t    subtree_size = 0,
+        SubtreeVector*  subtrees = nullptr);
+
+    // Recursively copy the top-level tree and the subtrees into the final tree,
+    // laying out the nodes exactly like the single-threaded build() would.
+    void merge_recurse(
+        Tree&                       tree,
+        const NodeVectorType&       top_nodes,
+        const SubtreeVector&        subtrees,
+        const std::vector<size_t>&  subtree_indices,
+        const size_t                top_node_index,
+        const size_t                node_index);
 };
 
 
@@ -106,6 +173,73 @@ class Builder
 // Builder class implementation.
 //
 
+template <typename Tree, typename Partitioner>
+Builder<Tree, Partitioner>::Subtree::Subtree(
+    const size_t            node_index,
+    const size_t            begin,
+    const size_t            end,
+    const AABBType&         bbox,
+    const NodeVectorType&   nodes)
+  : m_node_index(node_index)
+  , m_begin(begin)
+  , m_end(end)
+  , m_bbox(bbox)
+  , m_nodes(nodes.get_allocator())
+{
+}
+
+template <typename Tree, typename Partitioner>
+template <typename Timer>
+class Builder<Tree, Partitioner>::SubtreeBuildJob
+  : public IJob
+{
+  public:
+    SubtreeBuildJob(
+        Builder&                builder,
+        Partitioner&            partitioner,
+        Subtree&                subtree,
+        const size_t            items_per_leaf_hint,
+        std::vector<double>&    thread_build_times)
+      : m_builder(builder)
+      , m_partitioner(partitioner)
+      , m_subtree(subtree)
+      , m_items_per_leaf_hint(items_per_leaf_hint)
+      , m_thread_build_times(thread_build_times)
+    {
+    }
+
+    void execute(const size_t thread_index) override
+    {
+        Stopwatch<Timer> stopwatch;
+        stopwatch.start();
+
+        // Reserve memory for the nodes.
+        const size_t leaf_count_guess = (m_subtree.m_end - m_subtree.m_begin) / m_items_per_leaf_hint;
+        m_subtree.m_nodes.reserve(leaf_count_guess > 0 ? 2 * leaf_count_guess - 1 : 1);
+
+        // Build the subtree as if it was a tree of its own.
+        m_subtree.m_nodes.push_back(NodeType());
+        m_builder.subdivide_recurse(
+            m_subtree.m_nodes,
+            m_partitioner,
+            0,
+            m_subtree.m_begin,
+            m_subtree.m_end,
+            m_subtree.m_bbox);
+
+        // Each worker thread only ever updates its own entry.
+        stopwatch.measure();
+        m_thread_build_times[thread_index] += stopwatch.get_seconds();
+    }
+
+  private:
+    Builder&                    m_builder;
+    Partitioner&                m_partitioner;
+    Subtree&                    m_subtree;
+    const size_t                m_items_per_leaf_hint;
+    std::vector<double>&        m_thread_build_times;
+};
+
 template <typename Tree, typename Partitioner>
 Builder<Tree, Partitioner>::Builder()
   : m_build_time(0.0)
@@ -142,13 +276,103 @@ void Builder<Tree, Partitioner>::build(
 
     // Recursively subdivide the tree.
     subdivide_recurse(
-        tree,
+        tree.m_nodes,
         partitioner,
         0,              // node index
         0,              // begin
         size,           // end
         root_bbox);
 
+    // Measure and save construction time.
+    stopwatch.measure();
+    m_build_time = stopwatch.get_seconds();
+    m_thread_build_times.assign(1, m_build_time);
+}
+
+template <typename Tree, typename Partitioner>
+template <typename Timer>
+void Builder<Tree, Partitioner>::build(
+    Tree&               tree,
+    Partitioner&        partitioner,
+    const size_t        size,
+    const size_t        items_per_leaf_hint,
+    Logger&             logger,
+    const size_t        thread_count)
+{
+    // Subtrees must not contain more than half of the items, see the partitioner requirements above.
+    const size_t subtree_size =
+        std::max(size / (std::max<size_t>(thread_count, 1) * SubtreesPerThread), MinSubtreeSize);
+    if (thread_count < 2 || subtree_size > size / 2)
+    {
+        build<Timer>(tree, partitioner, size, items_per_leaf_hint);
+        return;
+    }
+
+    // Start stopwatch.
+    Stopwatch<Timer> stopwatch;
+    stopwatch.start();
+
+    // Clear the tree.
+    tree.m_nodes.clear();
+
+    // Build the top levels of the tree on the calling thread, collecting subtrees.
+    NodeVectorType top_nodes(tree.m_nodes.get_allocator());
+    top_nodes.push_back(NodeType());
+    SubtreeVector subtrees;
+    subdivide_recurse(
+        top_nodes,
+        partitioner,
+        0,
+        0,
+        size,
+        partitioner.compute_bbox(0, size),
+        subtree_size,
+        &subtrees);
+
+    // Schedule the construction of the subtrees, largest subtrees first.
+    std::vector<size_t> order(subtrees.size());
+    for (size_t i = 0, e = order.size(); i < e; ++i)
+        order[i] = i;
+    std::sort(
+        order.begin(),
+        order.end(),
+        [&subtrees](const size_t lhs, const size_t rhs)
+        {
+            return
+                subtrees[lhs].m_end - subtrees[lhs].m_begin >
+                subtrees[rhs].m_end - subtrees[rhs].m_begin;
+        });
+    m_thread_build_times.assign(thread_count, 0.0);
+    JobQueue job_queue;
+    for (size_t i = 0, e = order.size(); i < e; ++i)
+    {
+        job_queue.schedule(
+            new SubtreeBuildJob<Timer>(
+                *this,
+                partitioner,
+                subtrees[order[i]],
+                items_per_leaf_hint,
+                m_thread_build_times));
+    }
+
+    // Build the subtrees.
+    JobManager job_manager(logger, job_queue, thread_count);
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    // Merge the top-level tree and the subtrees into the final tree.
+    size_t node_count = top_nodes.size();
+    std::vector<size_t> subtree_indices(top_nodes.size(), ~size_t(0));
+    for (size_t i = 0, e = subtrees.size(); i < e; ++i)
+    {
+        subtree_indices[subtrees[i].m_node_index] = i;
+        node_count += subtrees[i].m_nodes.size() - 1;
+    }
+    tree.m_nodes.reserve(node_count);
+    tree.m_nodes.push_back(NodeType());
+    merge_recurse(tree, top_nodes, subtrees, subtree_indices, 0, 0);
+    assert(tree.m_nodes.size() == node_count);
+
     // Measure and save construction time.
     stopwatch.measure();
     m_build_time = stopwatch.get_seconds();
@@ -160,16 +384,31 @@ inline double Builder<Tree, Partitioner>::get_build_time() const
     return m_build_time;
 }
 
+template <typename Tree, typename Partitioner>
+inline const std::vector<double>& Builder<Tree, Partitioner>::get_thread_build_times() const
+{
+    return m_thread_build_times;
+}
+
 template <typename Tree, typename Partitioner>
 void Builder<Tree, Partitioner>::subdivide_recurse(
-    Tree&               tree,
+    NodeVectorType&     nodes,
     Partitioner&        partitioner,
     const size_t        node_index,
     const size_t        begin,
     const size_t        end,
-    const AABBType&     bbox)
+    const AABBType&     bbox,
+    const size_t        subtree_size,
+    SubtreeVector*      subtrees)
 {
-    assert(node_index < tree.m_nodes.size());
+    assert(node_index < nodes.size());
+
+    // Defer the construction of small enough subtrees.
+    if (subtrees && end - begin <= subtree_size)
+    {
+        subtrees->push_back(Subtree(node_index, begin, end, bbox, nodes));
+        return;
+    }
 
     // Try to partition the set of items.
     size_t pivot = end;
@@ -183,7 +422,7 @@ void Builder<Tree, Partitioner>::subdivide_recurse(
     if (pivot == end)
     {
         // Turn the current node into a leaf node.
-        NodeType& node = tree.m_nodes[node_index];
+        NodeType& node = nodes[node_index];
         node.make_leaf();
         node.set_item_index(begin);
         node.set_item_count(end - begin);
@@ -195,37 +434,103 @@ void Builder<Tree, Partitioner>::subdivide_recurse(
         const AABBType right_bbox(partitioner.compute_bbox(pivot, end));
 
         // Compute the indices of the child nodes.
-        const size_t left_node_index = tree.m_nodes.size();
+        const size_t left_node_index = nodes.size();
         const size_t right_node_index = left_node_index + 1;
 
         // Turn the current node into an interior node.
-        NodeType& node = tree.m_nodes[node_index];
+        NodeType& node = nodes[node_index];
         node.make_interior();
         node.set_left_bbox(left_bbox);
         node.set_right_bbox(right_bbox);
         node.set_child_node_index(left_node_index);
 
         // Create the child nodes.
-        tree.m_nodes.push_back(NodeType());
-        tree.m_nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
 
         // Recurse into the left subtree.
         subdivide_recurse(
-            tree,
+            nodes,
             partitioner,
             left_node_index,
             begin,
             pivot,
-            left_bbox);
+            left_bbox,
+            subtree_size,
+            subtrees);
 
         // Recurse into the right subtree.
         subdivide_recurse(
-            tree,
+            nodes,
             partitioner,
             right_node_index,
             pivot,
             end,
-            right_bbox);
+            right_bbox,
+            subtree_size,
+            subtrees);
+    }
+}
+
+template <typename Tree, typename Partitioner>
+void Builder<Tree, Partitioner>::merge_recurse(
+    Tree&                       tree,
+    const NodeVectorType&       top_nodes,
+    const SubtreeVector&        subtrees,
+    const std::vector<size_t>&  subtree_indices,
+    const size_t                top_node_index,
+    const size_t                node_index)
+{
+    const size_t subtree_index = subtree_indices[top_node_index];
+
+    if (subtree_index == ~size_t(0))
+    {
+        const NodeType& top_node = top_nodes[top_node_index];
+        tree.m_nodes[node_index] = top_node;
+
+        if (top_node.is_interior())
+        {
+            // Allocate the child nodes right away, like subdivide_recurse() does.
+            const size_t left_node_index = tree.m_nodes.size();
+            tree.m_nodes[node_index].set_child_node_index(left_node_index);
+            tree.m_nodes.push_back(NodeType());
+            tree.m_nodes.push_back(NodeType());
+
+            merge_recurse(
+                tree,
+                top_nodes,
+                subtrees,
+                subtree_indices,
+                top_node.get_child_node_index(),
+                left_node_index);
+
+            merge_recurse(
+                tree,
+                top_nodes,
+                subtrees,
+                subtree_indices,
+                top_node.get_child_node_index() + 1,
+                left_node_index + 1);
+        }
+    }
+    else
+    {
+        // The root of the subtree takes the place of the top-level node; its
+        // other nodes are appended, shifted by the number of nodes before them.
+        const NodeVectorType& nodes = subtrees[subtree_index].m_nodes;
+        const size_t offset = tree.m_nodes.size() - 1;
+
+        for (size_t i = 0, e = nodes.size(); i < e; ++i)
+        {
+            NodeType node = nodes[i];
+
+            if (node.is_interior())
+                node.set_child_node_index(node.get_child_node_index() + offset);
+
+            if (i == 0)
+                tree.m_nodes[node_index] = node;
+            else tree.m_nodes.push_back(node);
+        }
     }
 }
 
@@ -98,6 +98,26 @@ class SBVHPartitioner
         }
     };
 
+  private:
+    struct Bin
+    {
+        AABBType    m_bin_bbox;         // bbox of this bin
+        AABBType    m_left_bbox;        // bbox of all the bins to the left of this one
+        size_t      m_entry_counter;    // number of items that begin in this bin
+        size_t      m_exit_counter;     // number of items that end in this bin
+    };
+
+  public:
+    // Scratch memory and split counters. Leaves can be split concurrently as long as each thread uses its own workspace.
+    struct WorkspaceType
+    {
+        std::vector<AABBType>       m_left_bboxes;
+        std::vector<Bin>            m_bins;
+        std::vector<uint8>          m_tags;             // one bit per item
+        size_t                      m_spatial_split_count;
+        size_t                      m_object_split_count;
+    };
+
     // Constructor.
     SBVHPartitioner(
         ItemHandler&                item_handler,
@@ -122,6 +142,22 @@ class SBVHPartitioner
         LeafType&                   right_leaf,
         AABBType&                   right_leaf_bbox);
 
+    // Create a new workspace.
+    WorkspaceType create_workspace() const;
+
+    // Split a leaf using a given workspace. Thread-safe.
+    bool split(
+        WorkspaceType&              workspace,
+        LeafType&                   leaf,
+        const AABBType&             leaf_bbox,
+        LeafType&                   left_leaf,
+        AABBType&                   left_leaf_bbox,
+        LeafType&                   right_leaf,
+        AABBType&                   right_leaf_bbox) const;
+
+    // Accumulate the split counters of a workspace.
+    void merge_workspace(const WorkspaceType& workspace);
+
     // Store a leaf. Return the index of the first stored item.
     size_t store(const LeafType& leaf);
 
@@ -135,14 +171,6 @@ class SBVHPartitioner
   private:
     typedef Split<ValueType> SplitType;
 
-    struct Bin
-    {
-        AABBType    m_bin_bbox;         // bbox of this bin
-        AABBType    m_left_bbox;        // bbox of all the bins to the left of this one
-        size_t      m_entry_counter;    // number of items that begin in this bin
-        size_t      m_exit_counter;     // number of items that end in this bin
-    };
-
     ItemHandler&                    m_item_handler;
     const AABBVectorType&           m_bboxes;
     const size_t                    m_max_leaf_size;
@@ -152,14 +180,9 @@ class SBVHPartitioner
     const ValueType                 m_item_intersection_cost;
 
     ValueType                       m_root_bbox_rcp_sa;
-    std::vector<AABBType>           m_left_bboxes;
-    std::vector<Bin>                m_bins;
-    std::vector<uint8>              m_tags;
+    WorkspaceType                   m_workspace;
     std::vector<size_t>             m_final_indices;
 
-    size_t                          m_spatial_split_count;
-    size_t                          m_object_split_count;
-
     void compute_root_bbox_surface_area();
 
     ValueType compute_final_split_cost(
@@ -168,32 +191,35 @@ class SBVHPartitioner
 
     // Find the best object split for a given set of items.
     void find_object_split(
+        WorkspaceType&              workspace,
         LeafType&                   leaf,
         const AABBType&             leaf_bbox,
         AABBType&                   left_leaf_bbox,
         AABBType&                   right_leaf_bbox,
         size_t&                     best_split_dim,
         size_t&                     best_split_pivot,
-        ValueType&                  best_split_cost);
+        ValueType&                  best_split_cost) const;
 
     // Find the best spatial split for a given set of items.
     void find_spatial_split(
+        WorkspaceType&              workspace,
         const LeafType&             leaf,
         const AABBType&             leaf_bbox,
         AABBType&                   left_leaf_bbox,
         AABBType&                   right_leaf_bbox,
         SplitType&                  best_split,
-        ValueType&                  best_split_cost);
+        ValueType&                  best_split_cost) const;
 
     // Sort a set of items into two subsets according to a given object split.
     void object_sort(
+        WorkspaceType&              workspace,
         LeafType&                   leaf,
         const size_t                split_dim,
         const size_t                split_pivot,
         const AABBType&             left_leaf_bbox,
         const AABBType&             right_leaf_bbox,
         LeafType&                   left_leaf,
-        LeafType&                   right_leaf);
+        LeafType&                   right_leaf) const;
 
     // Sort a set of items into two subsets according to a given spatial split.
     void spatial_sort(
@@ -225,15 +251,29 @@ SBVHPartitioner<ItemHandler, AABBVector>::SBVHPartitioner(
   , m_rcp_bin_count(ValueType(1.0) / bin_count)
   , m_interior_node_traversal_cost(interior_node_traversal_cost)
   , m_item_intersection_cost(item_intersection_cost)
-  , m_left_bboxes(bboxes.size() > 1 ? bboxes.size() - 1 : 0)
-  , m_bins(bin_count)
-  , m_tags(bboxes.size())
-  , m_spatial_split_count(0)
-  , m_object_split_count(0)
+  , m_workspace(create_workspace())
 {
     compute_root_bbox_surface_area();
 }
 
+template <typename ItemHandler, typename AABBVector>
+typename SBVHPartitioner<ItemHandler, AABBVector>::WorkspaceType SBVHPartitioner<ItemHandler, AABBVector>::create_workspace() const
+{
+    WorkspaceType workspace;
+    workspace.m_bins.resize(m_bin_count);
+    workspace.m_tags.resize((m_bboxes.size() + 7) / 8);
+    workspace.m_spatial_split_count = 0;
+    workspace.m_object_split_count = 0;
+    return workspace;
+}
+
+template <typename ItemHandler, typename AABBVector>
+void SBVHPartitioner<ItemHandler, AABBVector>::merge_workspace(const WorkspaceType& workspace)
+{
+    m_workspace.m_spatial_split_count += workspace.m_spatial_split_count;
+    m_workspace.m_object_split_count += workspace.m_object_split_count;
+}
+
 template <typename ItemHandler, typename AABBVector>
 typename SBVHPartitioner<ItemHandler, AABBVector>::LeafType* SBVHPartitioner<ItemHandler, AABBVector>::create_root_leaf() const
 {
@@ -274,13 +314,34 @@ typename AABBVector::value_type SBVHPartitioner<ItemHandler, AABBVector>::comput
 }
 
 template <typename ItemHandler, typename AABBVector>
-bool SBVHPartitioner<ItemHandler, AABBVector>::split(
+inline bool SBVHPartitioner<ItemHandler, AABBVector>::split(
     LeafType&                       leaf,
     const AABBType&                 leaf_bbox,
     LeafType&                       left_leaf,
     AABBType&                       left_leaf_bbox,
     LeafType&                       right_leaf,
     AABBType&                       right_leaf_bbox)
+{
+    return
+        split(
+            m_workspace,
+            leaf,
+            leaf_bbox,
+            left_leaf,
+            left_leaf_bbox,
+            right_leaf,
+            right_leaf_bbox);
+}
+
+template <typename ItemHandler, typename AABBVector>
+bool SBVHPartitioner<ItemHandler, AABBVector>::split(
+    WorkspaceType&                  workspace,
+    LeafType&                       leaf,
+    const AABBType&                 leaf_bbox,
+    LeafType&                       left_leaf,
+    AABBType&                       left_leaf_bbox,
+    LeafType&                       right_leaf,
+    AABBType&                       right_leaf_bbox) const
 {
     assert(!leaf_bbox.is_valid() || leaf_bbox.rank() >= Dimension - 1);
 
@@ -305,6 +366,7 @@ bool SBVHPartitioner<ItemHandler, AABBVector>::split(
     size_t object_split_pivot;
     ValueType object_split_cost = std::numeric_limits<ValueType>::max();
     find_object_split(
+        workspace,
         leaf,
         leaf_bbox,
         object_split_left_bbox,
@@ -339,6 +401,7 @@ bool SBVHPartitioner<ItemHandler, AABBVector>::split(
     if (do_find_spatial_split)
     {
         find_spatial_split(
+            workspace,
             leaf,
             leaf_bbox,
             spatial_split_left_bbox,
@@ -362,6 +425,7 @@ bool SBVHPartitioner<ItemHandler, AABBVector>::split(
         left_leaf_bbox = object_split_left_bbox;
         right_leaf_bbox = object_split_right_bbox;
         object_sort(
+            workspace,
             leaf,
             object_split_dim,
             object_split_pivot,
@@ -369,7 +433,7 @@ bool SBVHPartitioner<ItemHandler, AABBVector>::split(
             right_leaf_bbox,
             left_leaf,
             right_leaf);
-        ++m_object_split_count;
+        ++workspace.m_object_split_count;
         return true;
     }
     else
@@ -384,7 +448,7 @@ bool SBVHPartitioner<ItemHandler, AABBVector>::split(
             right_leaf_bbox,
             left_leaf,
             right_leaf);
-        ++m_spatial_split_count;
+        ++workspace.m_spatial_split_count;
         return true;
     }
 }
@@ -427,14 +491,19 @@ inline typename AABBVector::value_type::ValueType SBVHPartitioner<ItemHandler, A
 
 template <typename ItemHandler, typename AABBVector>
 void SBVHPartitioner<ItemHandler, AABBVector>::find_object_split(
+    WorkspaceType&                  workspace,
     LeafType&                       leaf,
     const AABBType&                 leaf_bbox,
     AABBType&                       left_leaf_bbox,
     AABBType&                       right_leaf_bbox,
     size_t&                         best_split_dim,
     size_t&                         best_split_pivot,
-    ValueType&                      best_split_cost)
+    ValueType&                      best_split_cost) const
 {
+    std::vector<AABBType>& left_bboxes = workspace.m_left_bboxes;
+    if (left_bboxes.size() < leaf.size() - 1)
+        left_bboxes.resize(leaf.size() - 1);
+
     for (size_t d = 0; d < Dimension; ++d)
     {
         const std::vector<size_t>& indices = leaf.m_indices[d];
@@ -451,7 +520,7 @@ void SBVHPartitioner<ItemHandler, AABBVector>::find_object_split(
             const AABBType clipped_item_bbox = AABBType::intersect(item_bbox, leaf_bbox);
             assert(clipped_item_bbox.is_valid());
             bbox_accumulator.insert(clipped_item_bbox);
-            m_left_bboxes[i] = bbox_accumulator;
+            left_bboxes[i] = bbox_accumulator;
         }
 
         // Right-to-left sweep to accumulate bounding boxes, compute their surface area find the best partition.
@@ -466,7 +535,7 @@ void SBVHPartitioner<ItemHandler, AABBVector>::find_object_split(
             bbox_accumulator.insert(clipped_item_bbox);
 
             // Compute the cost of this partition.
-            const ValueType left_cost = half_surface_area(m_left_bboxes[i - 1]) * i;
+            const ValueType left_cost = half_surface_area(left_bboxes[i - 1]) * i;
             const ValueType right_cost = half_surface_area(bbox_accumulator) * (item_count - i);
             const ValueType split_cost = left_cost + right_cost;
 
@@ -476,7 +545,7 @@ void SBVHPartitioner<ItemHandler, AABBVector>::find_object_split(
                 best_split_cost = split_cost;
                 best_split_dim = d;
                 best_split_pivot = i;
-                left_leaf_bbox = m_left_bboxes[i - 1];
+                left_leaf_bbox = left_bboxes[i - 1];
                 right_leaf_bbox = bbox_accumulator;
             }
         }
@@ -487,13 +556,16 @@ void SBVHPartitioner<ItemHandler, AABBVector>::find_object_split(
 
 template <typename ItemHandler, typename AABBVector>
 void SBVHPartitioner<ItemHandler, AABBVector>::find_spatial_split(
+    WorkspaceType&                  workspace,
     const LeafType&                 leaf,
     const AABBType&                 leaf_bbox,
     AABBType&                       left_leaf_bbox,
     AABBType&                       right_leaf_bbox,
     SplitType&                      best_split,
-    ValueType&                      best_split_cost)
+    ValueType&                      best_split_cost) const
 {
+    std::vector<Bin>& bins = workspace.m_bins;
+
     for (size_t d = 0; d < Dimension; ++d)
     {
         const std::vector<size_t>& indices = leaf.m_indices[d];
@@ -512,7 +584,7 @@ void SBVHPartitioner<ItemHandler, AABBVector>::find_spatial_split(
         // Clear the bins.
         for (size_t i = 0; i < m_bin_count; ++i)
         {
-            Bin& bin = m_bins[i];
+            Bin& bin = bins[i];
             bin.m_bin_bbox.invalidate();
             bin.m_entry_counter = 0;
             bin.m_exit_counter = 0;
@@ -556,21 +628,21 @@ void SBVHPartitioner<ItemHandler, AABBVector>::find_spatial_split(
                 assert(item_clipped_bbox.is_valid());
 
                 // Grow the bounding box associated with this bin.
-                m_bins[b].m_bin_bbox.insert(item_clipped_bbox);
+                bins[b].m_bin_bbox.insert(item_clipped_bbox);
             }
 
             // Update the enter/leave counters.
-            ++m_bins[begin_bin].m_entry_counter;
-            ++m_bins[end_bin].m_exit_counter;
+            ++bins[begin_bin].m_entry_counter;
+            ++bins[end_bin].m_exit_counter;
         }
 
         AABBType bbox_accumulator;
 
         // Left-to-right sweep to compute the left bounding boxes.
-        bbox_accumulator = m_bins[0].m_bin_bbox;
+        bbox_accumulator = bins[0].m_bin_bbox;
         for (size_t i = 1; i < m_bin_count; ++i)
         {
-            Bin& bin = m_bins[i];
+            Bin& bin = bins[i];
             bin.m_left_bbox = bbox_accumulator;
             bbox_accumulator.insert(bin.m_bin_bbox);
         }
@@ -581,7 +653,7 @@ void SBVHPartitioner<ItemHandler, AABBVector>::find_spatial_split(
         bbox_accumulator.invalidate();
         for (size_t i = m_bin_count - 1; i > 0; --i)
         {
-            const Bin& bin = m_bins[i];
+            const Bin& bin = bins[i];
 
             // Compute the right bounding box.
             bbox_accumulator.insert(bin.m_bin_bbox);
@@ -623,24 +695,32 @@ void SBVHPartitioner<ItemHandler, AABBVector>::find_spatial_split(
 
 template <typename ItemHandler, typename AABBVector>
 void SBVHPartitioner<ItemHandler, AABBVector>::object_sort(
+    WorkspaceType&                  workspace,
     LeafType&                       leaf,
     const size_t                    split_dim,
     const size_t                    split_pivot,
     const AABBType&                 left_leaf_bbox,
     const AABBType&                 right_leaf_bbox,
     LeafType&                       left_leaf,
-    LeafType&                       right_leaf)
+    LeafType&                       right_leaf) const
 {
     const std::vector<size_t>& split_indices = leaf.m_indices[split_dim];
     const size_t size = split_indices.size();
 
-    enum { Left = 0, Right = 1 };
+    // A set bit means that the item goes to the right leaf.
+    std::vector<uint8>& tags = workspace.m_tags;
 
     for (size_t i = 0; i < split_pivot; ++i)
-        m_tags[split_indices[i]] = Left;
+    {
+        const size_t item_index = split_indices[i];
+        tags[item_index >> 3] &= ~(1 << (item_index & 7));
+    }
 
     for (size_t i = split_pivot; i < size; ++i)
-        m_tags[split_indices[i]] = Right;
+    {
+        const size_t item_index = split_indices[i];
+        tags[item_index >> 3] |= 1 << (item_index & 7);
+    }
 
     for (size_t d = 0; d < Dimension; ++d)
     {
@@ -680,7 +760,7 @@ void SBVHPartitioner<ItemHandler, AABBVector>::object_sort(
             {
                 const size_t item_index = leaf.m_indices[d][i];
 
-                if (m_tags[item_index] == Left)
+                if ((tags[item_index >> 3] & (1 << (item_index & 7))) == 0)
                 {
                     assert(left < split_pivot);
                     left_leaf.m_indices[d][left++] = item_index;
@@ -796,13 +876,13 @@ inline const std::vector<size_t>& SBVHPartitioner<ItemHandler, AABBVector>::get_
 template <typename ItemHandler, typename AABBVector>
 inline size_t SBVHPartitioner<ItemHandler, AABBVector>::get_spatial_split_count() const
 {
-    return m_spatial_split_count;
+    return m_workspace.m_spatial_split_count;
 }
 
 template <typename ItemHandler, typename AABBVector>
 inline size_t SBVHPartitioner<ItemHandler, AABBVector>::get_object_split_count() const
 {
-    return m_object_split_count;
+    return m_workspace.m_object_split_count;
 }
 
 }       // namespace bvh
@@ -32,13 +32,18 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/stopwatch.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <vector>
 
+// Forward declarations.
+namespace foundation    { class Logger; }
+
 namespace foundation {
 namespace bvh {
 
@@ -70,6 +75,32 @@ namespace bvh {
 //          size_t store(const LeafType& leaf);
 //      };
 //
+// In addition, the Partitioner class must provide the following members, which
+// are used by the multithreaded build() method:
+//
+//      class Partitioner
+//      {
+//        public:
+//          // Per-thread state.
+//          struct WorkspaceType;
+//
+//          // Create a new workspace.
+//          WorkspaceType create_workspace() const;
+//
+//          // Split a leaf using a given workspace. Must be thread-safe.
+//          bool split(
+//              WorkspaceType&      workspace,
+//              const LeafType&     leaf,
+//              const AABBType&     leaf_bbox,
+//              LeafType&           left_leaf,
+//              AABBType&           left_left_bbox,
+//              LeafType&           right_leaf,
+//              AABBType&           right_leaf_bbox) const;
+//
+//          // Accumulate the state of a workspace once it is no longer used.
+//          void merge_workspace(const WorkspaceType& workspace);
+//      };
+//
 
 template <typename Tree, typename Partitioner>
 class SpatialBuilder
@@ -91,23 +122,91 @@ class SpatialBuilder
         LeafType*           root_leaf,
         const AABBType&     root_leaf_bbox);
 
+    // Build a tree using multiple threads. The resulting tree is identical
+    // to the one produced by the single-threaded version of build().
+    template <typename Timer>
+    void build(
+        Tree&               tree,
+        Partitioner&        partitioner,
+        LeafType*           root_leaf,
+        const AABBType&     root_leaf_bbox,
+        Logger&             logger,
+        const size_t        thread_count);
+
     // Return the construction time.
     double get_build_time() const;
 
+    // Return the time spent by each thread building subtrees.
+    const std::vector<double>& get_thread_build_times() const;
+
   private:
+    typedef typename Tree::NodeVectorType NodeVectorType;
+    typedef typename Partitioner::WorkspaceType WorkspaceType;
     typedef std::vector<const LeafType*> LeafVector;
 
-    double m_build_time;
+    // Number of subtrees per thread in a multithreaded build, for load balancing.
+    static const size_t SubtreesPerThread = 8;
 
-    // Recursively subdivide the tree.
-    void subdivide_recurse(
+    // Minimum number of items in a subtree built by a separate job.
+    static const size_t MinSubtreeSize = 1024;
+
+    struct Subtree
+    {
+        size_t          m_node_index;       // index of the root of the subtree in the top-level tree
+        LeafType*       m_leaf;
+        AABBType        m_leaf_bbox;
+        size_t          m_depth;
+        NodeVectorType  m_nodes;
+        LeafVector      m_leaves;
+
+        Subtree(
+            const size_t            node_index,
+            LeafType*               leaf,
+            const AABBType&         leaf_bbox,
+            const size_t            depth,
+            const NodeVectorType&   nodes);
+    };
+
+    typedef std::vector<Subtree> SubtreeVector;
+
+    template <typename Timer> class SubtreeBuildJob;
+
+    double                  m_build_time;
+    std::vector<double>     m_thread_build_times;
+
+    // Store the leaves and measure construction time.
+    template <typename Timer>
+    void finalize(
         Tree&               tree,
         Partitioner&        partitioner,
+        const LeafVector&   leaves,
+        Stopwatch<Timer>&   stopwatch);
+
+    // Recursively subdivide the tree. If 'subtrees' is not null, leaves containing
+    // at most 'subtree_size' items are not subdivided but collected into 'subtrees'
+    // instead. If 'workspace' is not null, it is used to split the leaves.
+    void subdivide_recurse(
+        NodeVectorType&     nodes,
+        Partitioner&        partitioner,
+        WorkspaceType*      workspace,
         LeafVector&         leaves,
         LeafType*           leaf,
         const AABBType&     leaf_bbox,
         const size_t        leaf_node_index,
-        const size_t        depth);
+        const size_t        depth,
+        const size_t        subtree_size = 0,
+        SubtreeVector*      subtrees = nullptr);
+
+    // Recursively copy the top-level tree and the subtrees into the final tree,
+    // laying out the nodes exactly like the single-threaded build() would.
+    void merge_recurse(
+        Tree&                       tree,
+        LeafVector&                 leaves,
+        const NodeVectorType&       top_nodes,
+        const SubtreeVector&        subtrees,
+        const std::vector<size_t>&  subtree_indices,
+        const size_t                top_node_index,
+        const size_t                node_index);
 };
 
 
@@ -115,6 +214,71 @@ class SpatialBuilder
 // SpatialBuilder class implementation.
 //
 
+template <typename Tree, typename Partitioner>
+SpatialBuilder<Tree, Partitioner>::Subtree::Subtree(
+    const size_t            node_index,
+    LeafType*               leaf,
+    const AABBType&         leaf_bbox,
+    const size_t            depth,
+    const NodeVectorType&   nodes)
+  : m_node_index(node_index)
+  , m_leaf(leaf)
+  , m_leaf_bbox(leaf_bbox)
+  , m_depth(depth)
+  , m_nodes(nodes.get_allocator())
+{
+}
+
+template <typename Tree, typename Partitioner>
+template <typename Timer>
+class SpatialBuilder<Tree, Partitioner>::SubtreeBuildJob
+  : public IJob
+{
+  public:
+    SubtreeBuildJob(
+        SpatialBuilder&             builder,
+        Partitioner&                partitioner,
+        std::vector<WorkspaceType>& workspaces,
+        Subtree&                    subtree,
+        std::vector<double>&        thread_build_times)
+      : m_builder(builder)
+      , m_partitioner(partitioner)
+      , m_workspaces(workspaces)
+      , m_subtree(subtree)
+      , m_thread_build_times(thread_build_times)
+    {
+    }
+
+    void execute(const size_t thread_index) override
+    {
+        Stopwatch<Timer> stopwatch;
+        stopwatch.start();
+
+        // Build the subtree as if it was a tree of its own.
+        m_subtree.m_nodes.push_back(NodeType());
+        m_builder.subdivide_recurse(
+            m_subtree.m_nodes,
+            m_partitioner,
+            &m_workspaces[thread_index],
+            m_subtree.m_leaves,
+            m_subtree.m_leaf,
+            m_subtree.m_leaf_bbox,
+            0,
+            m_subtree.m_depth);
+
+        // Each worker thread only ever updates its own entry.
+        stopwatch.measure();
+        m_thread_build_times[thread_index] += stopwatch.get_seconds();
+    }
+
+  private:
+    SpatialBuilder&             m_builder;
+    Partitioner&                m_partitioner;
+    std::vector<WorkspaceType>& m_workspaces;
+    Subtree&                    m_subtree;
+    std::vector<double>&        m_thread_build_times;
+};
+
 template <typename Tree, typename Partitioner>
 SpatialBuilder<Tree, Partitioner>::SpatialBuilder()
   : m_build_time(0.0)
@@ -144,14 +308,135 @@ void SpatialBuilder<Tree, Partitioner>::build(
     // Recursively subdivide the tree.
     LeafVector leaves;
     subdivide_recurse(
-        tree,
+        tree.m_nodes,
         partitioner,
+        nullptr,
         leaves,
         root_leaf,
         root_leaf_bbox,
         0,
         0);
 
+    // Store the leaves.
+    finalize(tree, partitioner, leaves, stopwatch);
+    m_thread_build_times.assign(1, m_build_time);
+}
+
+template <typename Tree, typename Partitioner>
+template <typename Timer>
+void SpatialBuilder<Tree, Partitioner>::build(
+    Tree&                   tree,
+    Partitioner&            partitioner,
+    LeafType*               root_leaf,
+    const AABBType&         root_leaf_bbox,
+    Logger&                 logger,
+    const size_t            thread_count)
+{
+    const size_t subtree_size =
+        std::max(root_leaf->size() / (std::max<size_t>(thread_count, 1) * SubtreesPerThread), MinSubtreeSize);
+    if (thread_count < 2 || subtree_size >= root_leaf->size())
+    {
+        build<Timer>(tree, partitioner, root_leaf, root_leaf_bbox);
+        return;
+    }
+
+    // Start stopwatch.
+    Stopwatch<Timer> stopwatch;
+    stopwatch.start();
+
+    // Clear the tree.
+    tree.m_nodes.clear();
+
+    // Build the top levels of the tree on the calling thread, collecting subtrees.
+    NodeVectorType top_nodes(tree.m_nodes.get_allocator());
+    top_nodes.push_back(NodeType());
+    LeafVector leaves;
+    SubtreeVector subtrees;
+    subdivide_recurse(
+        top_nodes,
+        partitioner,
+        nullptr,
+        leaves,
+        root_leaf,
+        root_leaf_bbox,
+        0,
+        0,
+        subtree_size,
+        &subtrees);
+
+    // Schedule the construction of the subtrees, largest subtrees first.
+    std::vector<size_t> order(subtrees.size());
+    for (size_t i = 0, e = order.size(); i < e; ++i)
+        order[i] = i;
+    std::sort(
+        order.begin(),
+        order.end(),
+        [&subtrees](const size_t lhs, const size_t rhs)
+        {
+            return subtrees[lhs].m_leaf->size() > subtrees[rhs].m_leaf->size();
+        });
+    std::vector<WorkspaceType> workspaces;
+    workspaces.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i)
+        workspaces.push_back(partitioner.create_workspace());
+    m_thread_build_times.assign(thread_count, 0.0);
+    JobQueue job_queue;
+    for (size_t i = 0, e = order.size(); i < e; ++i)
+    {
+        job_queue.schedule(
+            new SubtreeBuildJob<Timer>(
+                *this,
+                partitioner,
+                workspaces,
+                subtrees[order[i]],
+                m_thread_build_times));
+    }
+
+    // Build the subtrees.
+    JobManager job_manager(logger, job_queue, thread_count);
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    for (size_t i = 0; i < thread_count; ++i)
+        partitioner.merge_workspace(workspaces[i]);
+
+    // Merge the top-level tree and the subtrees into the final tree.
+    size_t node_count = top_nodes.size();
+    std::vector<size_t> subtree_indices(top_nodes.size(), ~size_t(0));
+    for (size_t i = 0, e = subtrees.size(); i < e; ++i)
+    {
+        subtree_indices[subtrees[i].m_node_index] = i;
+        node_count += subtrees[i].m_nodes.size() - 1;
+    }
+    tree.m_nodes.reserve(node_count);
+    tree.m_nodes.push_back(NodeType());
+    merge_recurse(tree, leaves, top_nodes, subtrees, subtree_indices, 0, 0);
+    assert(tree.m_nodes.size() == node_count);
+
+    // Store the leaves.
+    finalize(tree, partitioner, leaves, stopwatch);
+}
+
+template <typename Tree, typename Partitioner>
+inline double SpatialBuilder<Tree, Partitioner>::get_build_time() const
+{
+    return m_build_time;
+}
+
+template <typename Tree, typename Partitioner>
+inline const std::vector<double>& SpatialBuilder<Tree, Partitioner>::get_thread_build_times() const
+{
+    return m_thread_build_times;
+}
+
+template <typename Tree, typename Partitioner>
+template <typename Timer>
+void SpatialBuilder<Tree, Partitioner>::finalize(
+    Tree&                   tree,
+    Partitioner&            partitioner,
+    const LeafVector&       leaves,
+    Stopwatch<Timer>&       stopwatch)
+{
     // Store the leaves.
     const size_t node_count = tree.m_nodes.size();
     for (size_t i = 0; i < node_count; ++i)
@@ -170,36 +455,49 @@ void SpatialBuilder<Tree, Partitioner>::build(
     m_build_time = stopwatch.get_seconds();
 }
 
-template <typename Tree, typename Partitioner>
-inline double SpatialBuilder<Tree, Partitioner>::get_build_time() const
-{
-    return m_build_time;
-}
-
 template <typename Tree, typename Partitioner>
 void SpatialBuilder<Tree, Partitioner>::subdivide_recurse(
-    Tree&                   tree,
+    NodeVectorType&         nodes,
     Partitioner&            partitioner,
+    WorkspaceType*          workspace,
     LeafVector&             leaves,
     LeafType*               leaf,
     const AABBType&         leaf_bbox,
     const size_t            leaf_node_index,
-    const size_t            depth)
+    const size_t            depth,
+    const size_t            subtree_size,
+    SubtreeVector*          subtrees)
 {
-    assert(leaf_node_index < tree.m_nodes.size());
+    assert(leaf_node_index < nodes.size());
+
+    // Defer the construction of small enough subtrees.
+    if (subtrees && leaf->size() <= subtree_size)
+    {
+        subtrees->push_back(Subtree(leaf_node_index, leaf, leaf_bbox, depth, nodes));
+        return;
+    }
 
     // Try to split the leaf.
     LeafType* left_leaf = new LeafType();
     LeafType* right_leaf = new LeafType();
     AABBType left_leaf_bbox, right_leaf_bbox;
     const bool split =
-        partitioner.split(
-            *leaf,
-            leaf_bbox,
-            *left_leaf,
-            left_leaf_bbox,
-            *right_leaf,
-            right_leaf_bbox);
+        workspace
+            ? partitioner.split(
+                  *workspace,
+                  *leaf,
+                  leaf_bbox,
+                  *left_leaf,
+                  left_leaf_bbox,
+                  *right_leaf,
+                  right_leaf_bbox)
+            : partitioner.split(
+                  *leaf,
+                  leaf_bbox,
+                  *left_leaf,
+                  left_leaf_bbox,
+                  *right_leaf,
+                  right_leaf_bbox);
 
     if (split)
     {
@@ -207,39 +505,45 @@ void SpatialBuilder<Tree, Partitioner>::subdivide_recurse(
         delete leaf;
 
         // Compute the indices of the child nodes.
-        const size_t left_node_index = tree.m_nodes.size();
+        const size_t left_node_index = nodes.size();
         const size_t right_node_index = left_node_index + 1;
 
         // Turn the current node into an interior node.
-        NodeType& node = tree.m_nodes[leaf_node_index];
+        NodeType& node = nodes[leaf_node_index];
         node.make_interior();
         node.set_left_bbox(left_leaf_bbox);
         node.set_right_bbox(right_leaf_bbox);
         node.set_child_node_index(left_node_index);
 
         // Create the child nodes.
-        tree.m_nodes.push_back(NodeType());
-        tree.m_nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
 
         // Recurse into the left subtree.
         subdivide_recurse(
-            tree,
+            nodes,
             partitioner,
+            workspace,
             leaves,
             left_leaf,
             left_leaf_bbox,
             left_node_index,
-            depth + 1);
+            depth + 1,
+            subtree_size,
+            subtrees);
 
         // Recurse into the right subtree.
         subdivide_recurse(
-            tree,
+            nodes,
             partitioner,
+            workspace,
             leaves,
             right_leaf,
             right_leaf_bbox,
             right_node_index,
-            depth + 1);
+            depth + 1,
+            subtree_size,
+            subtrees);
     }
     else
     {
@@ -248,7 +552,7 @@ void SpatialBuilder<Tree, Partitioner>::subdivide_recurse(
         delete right_leaf;
 
         // Turn the current node into a leaf node.
-        NodeType& node = tree.m_nodes[leaf_node_index];
+        NodeType& node = nodes[leaf_node_index];
         node.make_leaf();
         node.set_item_index(leaves.size());
         node.set_item_count(leaf->size());
@@ -256,6 +560,75 @@ void SpatialBuilder<Tree, Partitioner>::subdivide_recurse(
     }
 }
 
+template <typename Tree, typename Partitioner>
+void SpatialBuilder<Tree, Partitioner>::merge_recurse(
+    Tree&                       tree,
+    LeafVector&                 leaves,
+    const NodeVectorType&       top_nodes,
+    const SubtreeVector&        subtrees,
+    const std::vector<size_t>&  subtree_indices,
+    const size_t                top_node_index,
+    const size_t                node_index)
+{
+    const size_t subtree_index = subtree_indices[top_node_index];
+
+    if (subtree_index == ~size_t(0))
+    {
+        const NodeType& top_node = top_nodes[top_node_index];
+        tree.m_nodes[node_index] = top_node;
+
+        if (top_node.is_interior())
+        {
+            // Allocate the child nodes right away, like subdivide_recurse() does.
+            const size_t left_node_index = tree.m_nodes.size();
+            tree.m_nodes[node_index].set_child_node_index(left_node_index);
+            tree.m_nodes.push_back(NodeType());
+            tree.m_nodes.push_back(NodeType());
+
+            merge_recurse(
+                tree,
+                leaves,
+                top_nodes,
+                subtrees,
+                subtree_indices,
+                top_node.get_child_node_index(),
+                left_node_index);
+
+            merge_recurse(
+                tree,
+                leaves,
+                top_nodes,
+                subtrees,
+                subtree_indices,
+                top_node.get_child_node_index() + 1,
+                left_node_index + 1);
+        }
+    }
+    else
+    {
+        // The root of the subtree takes the place of the top-level node; its
+        // other nodes are appended, shifted by the number of nodes before them.
+        const Subtree& subtree = subtrees[subtree_index];
+        const size_t offset = tree.m_nodes.size() - 1;
+        const size_t leaf_offset = leaves.size();
+
+        for (size_t i = 0, e = subtree.m_nodes.size(); i < e; ++i)
+        {
+            NodeType node = subtree.m_nodes[i];
+
+            if (node.is_interior())
+                node.set_child_node_index(node.get_child_node_index() + offset);
+            else node.set_item_index(node.get_item_index() + leaf_offset);
+
+            if (i == 0)
+                tree.m_nodes[node_index] = node;
+            else tree.m_nodes.push_back(node);
+        }
+
+        leaves.insert(leaves.end(), subtree.m_leaves.begin(), subtree.m_leaves.end());
+    }
+}
+
 }       // namespace bvh
 }       // namespace foundation
 
@@ -76,6 +76,12 @@ class Tree
     template <typename Tree, typename Visitor, typename Ray, size_t StackSize, size_t N>
     friend class Intersector;
 
+    template <typename AABB, size_t Width>
+    friend class WideTree;
+
+    template <typename Tree, typename Visitor, typename Ray, size_t Width, size_t StackSize>
+    friend class WideIntersector;
+
     typedef typename NodeType::AABBType AABBType;
     typedef std::vector<AABBType> AABBVector;
 
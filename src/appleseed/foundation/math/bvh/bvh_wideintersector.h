@@ -0,0 +1,439 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDEINTERSECTOR_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDEINTERSECTOR_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/bvh/bvh_intersector.h"
+#include "foundation/math/bvh/bvh_statistics.h"
+#include "foundation/math/bvh/bvh_widenode.h"
+#include "foundation/math/bvh/bvh_widetree.h"
+#include "foundation/math/minmax.h"
+#include "foundation/math/ray.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/simdpack.h"
+#endif
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Wide BVH intersector.
+//
+// Traverses a wide BVH (see foundation::bvh::WideTree) built from a binary BVH,
+// testing the ray against all the children of a wide node at once, and visits
+// the leaves of the binary BVH. The Visitor class is the same as the one of
+// foundation::bvh::Intersector, so both intersectors are interchangeable.
+//
+
+template <
+    typename Tree,
+    typename Visitor,
+    typename Ray,
+    size_t Width,
+    size_t StackSize = 64 * (Width - 1)
+>
+class WideIntersector
+  : public NonCopyable
+{
+  public:
+    typedef typename Tree::NodeType NodeType;
+    typedef typename NodeType::AABBType AABBType;
+    typedef typename AABBType::ValueType ValueType;
+    typedef WideTree<AABBType, Width> WideTreeType;
+    typedef typename WideTreeType::NodeType WideNodeType;
+    typedef Ray RayType;
+    typedef RayInfo<ValueType, 3> RayInfoType;
+
+    // Intersect a ray with a given BVH without motion, using its wide counterpart.
+    void intersect_no_motion(
+        const Tree&             tree,
+        const WideTreeType&     wide_tree,
+        const RayType&          ray,
+        const RayInfoType&      ray_info,
+        Visitor&                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , TraversalStatistics&  stats
+#endif
+        ) const;
+};
+
+
+//
+// Ray-box tests against all the children of a wide node.
+//
+
+namespace impl
+{
+    // Reference implementation, used when no SIMD implementation is available.
+    template <typename T, size_t Width>
+    class WideBBoxTester
+    {
+      public:
+        template <typename RayType>
+        WideBBoxTester(
+            const RayType&          ray,
+            const RayInfo<T, 3>&    ray_info)
+          : m_org(ray.m_org)
+          , m_rcp_dir(ray_info.m_rcp_dir)
+          , m_ray_tmin(ray.m_tmin)
+        {
+            for (size_t d = 0; d < 3; ++d)
+            {
+                m_near[d] = (2 * d + 1 - ray_info.m_sgn_dir[d]) * Width;
+                m_far[d] = (2 * d + ray_info.m_sgn_dir[d]) * Width;
+            }
+        }
+
+        // Return a bitmask of the children hit by the ray; the distance to each
+        // child is stored in 'tmin' (only meaningful for children that were hit).
+        size_t test(
+            const T*                bbox_data,
+            const T                 ray_tmax,
+            T                       tmin[Width]) const
+        {
+            size_t hits = 0;
+
+            for (size_t i = 0; i < Width; ++i)
+            {
+                const T xl1 = m_rcp_dir[0] * (bbox_data[m_near[0] + i] - m_org[0]);
+                const T yl1 = m_rcp_dir[1] * (bbox_data[m_near[1] + i] - m_org[1]);
+                const T zl1 = m_rcp_dir[2] * (bbox_data[m_near[2] + i] - m_org[2]);
+
+                const T xl2 = m_rcp_dir[0] * (bbox_data[m_far[0] + i] - m_org[0]);
+                const T yl2 = m_rcp_dir[1] * (bbox_data[m_far[1] + i] - m_org[1]);
+                const T zl2 = m_rcp_dir[2] * (bbox_data[m_far[2] + i] - m_org[2]);
+
+                const T child_tmin = ssemax(zl1, ssemax(yl1, ssemax(xl1, m_ray_tmin)));
+                const T child_tmax = ssemin(zl2, ssemin(yl2, ssemin(xl2, ray_tmax)));
+
+                tmin[i] = child_tmin;
+
+                if (!(child_tmin > child_tmax || child_tmax < m_ray_tmin || child_tmin >= ray_tmax))
+                    hits |= size_t(1) << i;
+            }
+
+            return hits;
+        }
+
+      private:
+        const Vector<T, 3>  m_org;
+        const Vector<T, 3>  m_rcp_dir;
+        const T             m_ray_tmin;
+        size_t              m_near[3];
+        size_t              m_far[3];
+    };
+
+#ifdef APPLESEED_USE_SSE
+
+    // SIMD implementation, processing Pack::Lanes children at a time.
+    template <typename Pack, size_t Width>
+    class SIMDWideBBoxTester
+    {
+      public:
+        typedef typename Pack::ValueType T;
+        typedef typename Pack::VectorType V;
+
+        static_assert(Width % Pack::Lanes == 0, "Wide BVH width must be a multiple of the SIMD width");
+
+        template <typename RayType>
+        SIMDWideBBoxTester(
+            const RayType&          ray,
+            const RayInfo<T, 3>&    ray_info)
+        {
+            for (size_t d = 0; d < 3; ++d)
+            {
+                m_org[d] = Pack::set1(ray.m_org[d]);
+                m_rcp_dir[d] = Pack::set1(ray_info.m_rcp_dir[d]);
+                m_near[d] = (2 * d + 1 - ray_info.m_sgn_dir[d]) * Width;
+                m_far[d] = (2 * d + ray_info.m_sgn_dir[d]) * Width;
+            }
+
+            m_ray_tmin = Pack::set1(ray.m_tmin);
+        }
+
+        size_t test(
+            const T*                bbox_data,
+            const T                 ray_tmax,
+            T                       tmin[Width]) const
+        {
+            const V vray_tmax = Pack::set1(ray_tmax);
+
+            size_t hits = 0;
+
+            for (size_t i = 0; i < Width; i += Pack::Lanes)
+            {
+                const V xl1 = Pack::mul(m_rcp_dir[0], Pack::sub(Pack::load(bbox_data + m_near[0] + i), m_org[0]));
+                const V yl1 = Pack::mul(m_rcp_dir[1], Pack::sub(Pack::load(bbox_data + m_near[1] + i), m_org[1]));
+                const V zl1 = Pack::mul(m_rcp_dir[2], Pack::sub(Pack::load(bbox_data + m_near[2] + i), m_org[2]));
+
+                const V xl2 = Pack::mul(m_rcp_dir[0], Pack::sub(Pack::load(bbox_data + m_far[0] + i), m_org[0]));
+                const V yl2 = Pack::mul(m_rcp_dir[1], Pack::sub(Pack::load(bbox_data + m_far[1] + i), m_org[1]));
+                const V zl2 = Pack::mul(m_rcp_dir[2], Pack::sub(Pack::load(bbox_data + m_far[2] + i), m_org[2]));
+
+                const V child_tmin = Pack::max(zl1, Pack::max(yl1, Pack::max(xl1, m_ray_tmin)));
+                const V child_tmax = Pack::min(zl2, Pack::min(yl2, Pack::min(xl2, vray_tmax)));
+
+                Pack::store(tmin + i, child_tmin);
+
+                const int lane_hits = Pack::misses(child_tmin, child_tmax, m_ray_tmin, vray_tmax) ^ Pack::AllLanes;
+                hits |= static_cast<size_t>(lane_hits) << i;
+            }
+
+            return hits;
+        }
+
+      private:
+        V                   m_org[3];
+        V                   m_rcp_dir[3];
+        V                   m_ray_tmin;
+        size_t              m_near[3];
+        size_t              m_far[3];
+    };
+
+    template <>
+    class WideBBoxTester<float, 4>
+      : public SIMDWideBBoxTester<SSEFloat4, 4>
+    {
+      public:
+        template <typename RayType>
+        WideBBoxTester(const RayType& ray, const RayInfo<float, 3>& ray_info)
+          : SIMDWideBBoxTester<SSEFloat4, 4>(ray, ray_info)
+        {
+        }
+    };
+
+    template <>
+    class WideBBoxTester<float, 8>
+      : public SIMDWideBBoxTester<WideFloatPack, 8>
+    {
+      public:
+        template <typename RayType>
+        WideBBoxTester(const RayType& ray, const RayInfo<float, 3>& ray_info)
+          : SIMDWideBBoxTester<WideFloatPack, 8>(ray, ray_info)
+        {
+        }
+    };
+
+    template <>
+    class WideBBoxTester<double, 4>
+      : public SIMDWideBBoxTester<WideDoublePack, 4>
+    {
+      public:
+        template <typename RayType>
+        WideBBoxTester(const RayType& ray, const RayInfo<double, 3>& ray_info)
+          : SIMDWideBBoxTester<WideDoublePack, 4>(ray, ray_info)
+        {
+        }
+    };
+
+    template <>
+    class WideBBoxTester<double, 8>
+      : public SIMDWideBBoxTester<WideDoublePack, 8>
+    {
+      public:
+        template <typename RayType>
+        WideBBoxTester(const RayType& ray, const RayInfo<double, 3>& ray_info)
+          : SIMDWideBBoxTester<WideDoublePack, 8>(ray, ray_info)
+        {
+        }
+    };
+
+#endif  // APPLESEED_USE_SSE
+}
+
+
+//
+// WideIntersector class implementation.
+//
+
+template <
+    typename Tree,
+    typename Visitor,
+    typename Ray,
+    size_t Width,
+    size_t StackSize
+>
+void WideIntersector<Tree, Visitor, Ray, Width, StackSize>::intersect_no_motion(
+    const Tree&                 tree,
+    const WideTreeType&         wide_tree,
+    const RayType&              ray,
+    const RayInfoType&          ray_info,
+    Visitor&                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , TraversalStatistics&      stats
+#endif
+    ) const
+{
+    // Make sure the tree was built.
+    assert(!tree.m_nodes.empty());
+
+    // Initialize traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(++stats.m_traversal_count);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_nodes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_leaves = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t intersected_bboxes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t discarded_nodes = 0);
+
+    // Node stack. Each entry stores the distance to the node's bounding box
+    // so that nodes behind the closest intersection can be skipped.
+    struct StackEntry
+    {
+        uint32      m_child_ref;
+        ValueType   m_distance;
+    };
+    StackEntry stack[StackSize];
+    StackEntry* stack_ptr = stack;
+
+    // Current node: the root of the wide BVH, or the root of the binary BVH if it is a leaf.
+    assert(!wide_tree.empty() || tree.m_nodes[0].is_leaf());
+    uint32 child_ref = wide_tree.empty() ? WideNodeType::LeafFlag : 0;
+
+    const impl::WideBBoxTester<ValueType, Width> tester(ray, ray_info);
+
+    // Traverse the tree and intersect leaf nodes.
+    ValueType ray_tmax = ray.m_tmax;
+    while (true)
+    {
+        if ((child_ref & WideNodeType::LeafFlag) == 0)
+        {
+            // Fetch the node.
+            FOUNDATION_BVH_TRAVERSAL_STATS(++visited_nodes);
+            const WideNodeType& node = wide_tree.m_nodes[child_ref];
+            const size_t child_count = node.m_child_count;
+            FOUNDATION_BVH_TRAVERSAL_STATS(intersected_bboxes += child_count);
+
+            // Intersect all child bounding boxes at once.
+            APPLESEED_SIMD8_ALIGN ValueType tmin[Width];
+            size_t hits =
+                tester.test(node.m_bbox_data, ray_tmax, tmin) &
+                ((size_t(1) << child_count) - 1);
+
+            if (hits != 0)
+            {
+                // Sort the children that were hit by increasing distance.
+                uint32 hit_refs[Width];
+                ValueType hit_distances[Width];
+                size_t hit_count = 0;
+
+                for (size_t i = 0; hits != 0; ++i, hits >>= 1)
+                {
+                    if ((hits & 1) == 0)
+                        continue;
+
+                    size_t j = hit_count++;
+
+                    for (; j > 0 && hit_distances[j - 1] > tmin[i]; --j)
+                    {
+                        hit_refs[j] = hit_refs[j - 1];
+                        hit_distances[j] = hit_distances[j - 1];
+                    }
+
+                    hit_refs[j] = node.m_child_refs[i];
+                    hit_distances[j] = tmin[i];
+                }
+
+                FOUNDATION_BVH_TRAVERSAL_STATS(discarded_nodes += child_count - hit_count);
+
+                // Push the far child nodes to the stack, continue with the nearest child node.
+                assert(stack_ptr + hit_count - 1 <= stack + StackSize);
+                for (size_t i = hit_count - 1; i > 0; --i)
+                {
+                    stack_ptr->m_child_ref = hit_refs[i];
+                    stack_ptr->m_distance = hit_distances[i];
+                    ++stack_ptr;
+                }
+
+                child_ref = hit_refs[0];
+                continue;
+            }
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(discarded_nodes += child_count);
+        }
+        else
+        {
+            // Visit the leaf.
+            FOUNDATION_BVH_TRAVERSAL_STATS(++visited_leaves);
+            ValueType distance;
+#ifndef NDEBUG
+            distance = ValueType(-1.0);
+#endif
+            const bool proceed =
+                visitor.visit(
+                    tree.m_nodes[child_ref & ~WideNodeType::LeafFlag],
+                    ray,
+                    ray_info,
+                    distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                    , stats
+#endif
+                    );
+            assert(!proceed || distance >= ValueType(0.0));
+
+            // Terminate traversal if the visitor decided so.
+            if (!proceed)
+                break;
+
+            // Keep track of the distance to the closest intersection.
+            if (ray_tmax > distance)
+                ray_tmax = distance;
+        }
+
+        // Discard the nodes of the stack that lie beyond the closest intersection.
+        while (stack_ptr > stack && stack_ptr[-1].m_distance >= ray_tmax)
+        {
+            FOUNDATION_BVH_TRAVERSAL_STATS(++discarded_nodes);
+            --stack_ptr;
+        }
+
+        // Terminate traversal if the node stack is empty.
+        if (stack_ptr == stack)
+            break;
+
+        // Pop the top node from the stack.
+        child_ref = (--stack_ptr)->m_child_ref;
+    }
+
+    // Store traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_nodes.insert(visited_nodes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_leaves.insert(visited_leaves));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_bboxes.insert(intersected_bboxes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_discarded_nodes.insert(discarded_nodes));
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDEINTERSECTOR_H
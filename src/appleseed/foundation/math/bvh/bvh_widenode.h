@@ -0,0 +1,182 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDENODE_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDENODE_H
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Node of a wide BVH, i.e. a BVH with up to Width children per node.
+//
+// The bounding boxes of the children are stored in structure-of-arrays
+// layout so that they can all be tested against a ray with a handful of
+// SIMD instructions. A child is either another node of the wide BVH, or
+// a leaf node of the binary BVH from which the wide BVH was collapsed.
+//
+
+template <typename AABB, size_t Width>
+class APPLESEED_ALIGN(64) WideNode
+{
+  public:
+    typedef AABB AABBType;
+    typedef typename AABBType::ValueType ValueType;
+
+    static const size_t Dimension = AABBType::Dimension;
+    static const size_t MaxChildCount = Width;
+
+    // Remove all children.
+    void clear();
+
+    // Append a child node.
+    void add_interior_child(const AABBType& bbox, const size_t node_index);
+    void add_leaf_child(const AABBType& bbox, const size_t leaf_node_index);
+
+    // Return the number of children.
+    size_t get_child_count() const;
+
+    // Return whether a given child is a leaf node of the binary BVH.
+    bool is_leaf_child(const size_t i) const;
+
+    // Return the index of a given child, either in the wide BVH (interior children)
+    // or in the binary BVH (leaf children).
+    size_t get_child_index(const size_t i) const;
+
+    // Return the bounding box of a given child.
+    AABBType get_child_bbox(const size_t i) const;
+
+  private:
+    template <typename Tree, typename Visitor, typename Ray, size_t W, size_t StackSize>
+    friend class WideIntersector;
+
+    static const uint32 LeafFlag = 0x80000000UL;
+
+    // Bounding boxes as min x, max x, min y, max y, ... each row holding Width values.
+    APPLESEED_SIMD4_ALIGN ValueType m_bbox_data[2 * Dimension * Width];
+
+    uint32                          m_child_refs[Width];
+    uint32                          m_child_count;
+
+    void add_child(const AABBType& bbox, const uint32 child_ref);
+};
+
+
+//
+// WideNode class implementation.
+//
+
+template <typename AABB, size_t Width>
+inline void WideNode<AABB, Width>::clear()
+{
+    for (size_t i = 0; i < 2 * Dimension * Width; ++i)
+        m_bbox_data[i] = ValueType(0.0);
+
+    for (size_t i = 0; i < Width; ++i)
+        m_child_refs[i] = 0;
+
+    m_child_count = 0;
+}
+
+template <typename AABB, size_t Width>
+inline void WideNode<AABB, Width>::add_interior_child(const AABBType& bbox, const size_t node_index)
+{
+    assert(node_index < LeafFlag);
+    add_child(bbox, static_cast<uint32>(node_index));
+}
+
+template <typename AABB, size_t Width>
+inline void WideNode<AABB, Width>::add_leaf_child(const AABBType& bbox, const size_t leaf_node_index)
+{
+    assert(leaf_node_index < LeafFlag);
+    add_child(bbox, static_cast<uint32>(leaf_node_index) | LeafFlag);
+}
+
+template <typename AABB, size_t Width>
+inline size_t WideNode<AABB, Width>::get_child_count() const
+{
+    return m_child_count;
+}
+
+template <typename AABB, size_t Width>
+inline bool WideNode<AABB, Width>::is_leaf_child(const size_t i) const
+{
+    assert(i < m_child_count);
+    return (m_child_refs[i] & LeafFlag) != 0;
+}
+
+template <typename AABB, size_t Width>
+inline size_t WideNode<AABB, Width>::get_child_index(const size_t i) const
+{
+    assert(i < m_child_count);
+    return m_child_refs[i] & ~LeafFlag;
+}
+
+template <typename AABB, size_t Width>
+inline AABB WideNode<AABB, Width>::get_child_bbox(const size_t i) const
+{
+    assert(i < m_child_count);
+
+    AABBType bbox;
+
+    for (size_t d = 0; d < Dimension; ++d)
+    {
+        bbox.min[d] = m_bbox_data[(2 * d + 0) * Width + i];
+        bbox.max[d] = m_bbox_data[(2 * d + 1) * Width + i];
+    }
+
+    return bbox;
+}
+
+template <typename AABB, size_t Width>
+inline void WideNode<AABB, Width>::add_child(const AABBType& bbox, const uint32 child_ref)
+{
+    assert(m_child_count < Width);
+
+    const size_t i = m_child_count++;
+
+    for (size_t d = 0; d < Dimension; ++d)
+    {
+        m_bbox_data[(2 * d + 0) * Width + i] = bbox.min[d];
+        m_bbox_data[(2 * d + 1) * Width + i] = bbox.max[d];
+    }
+
+    m_child_refs[i] = child_ref;
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDENODE_H
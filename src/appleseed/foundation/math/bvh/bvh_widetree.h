@@ -0,0 +1,226 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDETREE_H
+#define APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDETREE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/bvh/bvh_widenode.h"
+#include "foundation/utility/alignedallocator.h"
+#include "foundation/utility/alignedvector.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Wide BVH obtained by collapsing the interior nodes of a binary BVH.
+//
+// Each wide node adopts up to Width descendants of a binary interior node,
+// always opening the child with the largest surface area first. The leaves
+// of the binary BVH are referenced rather than copied, so the binary BVH
+// must stay alive (and unmodified) as long as the wide BVH is in use.
+//
+// Only binary BVHs without motion can be collapsed.
+//
+
+template <typename AABB, size_t Width>
+class WideTree
+  : public NonCopyable
+{
+  public:
+    typedef AABB AABBType;
+    typedef WideNode<AABBType, Width> NodeType;
+    typedef AlignedVector<NodeType> NodeVectorType;
+
+    static_assert(Width >= 2 && Width <= 32, "Unsupported wide BVH width");
+
+    // Constructor.
+    WideTree();
+
+    // Build the wide BVH from a binary BVH.
+    template <typename Tree>
+    void build(const Tree& tree);
+
+    // Clear the wide BVH.
+    void clear();
+
+    // Return true if the wide BVH is empty, i.e. if it was not built
+    // or if the root of the binary BVH is a leaf.
+    bool empty() const;
+
+    // Return the number of nodes of the wide BVH.
+    size_t get_node_count() const;
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
+  private:
+    template <typename Tree, typename Visitor, typename Ray, size_t W, size_t StackSize>
+    friend class WideIntersector;
+
+    NodeVectorType  m_nodes;
+
+    template <typename Tree>
+    size_t collapse(const Tree& tree, const size_t binary_node_index);
+};
+
+
+//
+// WideTree class implementation.
+//
+
+template <typename AABB, size_t Width>
+WideTree<AABB, Width>::WideTree()
+  : m_nodes(AlignedAllocator<NodeType>(64))
+{
+}
+
+template <typename AABB, size_t Width>
+template <typename Tree>
+void WideTree<AABB, Width>::build(const Tree& tree)
+{
+    assert(tree.m_node_bboxes.empty());
+
+    clear();
+
+    if (!tree.m_nodes.empty() && tree.m_nodes[0].is_interior())
+        collapse(tree, 0);
+}
+
+template <typename AABB, size_t Width>
+void WideTree<AABB, Width>::clear()
+{
+    NodeVectorType(m_nodes.get_allocator()).swap(m_nodes);
+}
+
+template <typename AABB, size_t Width>
+inline bool WideTree<AABB, Width>::empty() const
+{
+    return m_nodes.empty();
+}
+
+template <typename AABB, size_t Width>
+inline size_t WideTree<AABB, Width>::get_node_count() const
+{
+    return m_nodes.size();
+}
+
+template <typename AABB, size_t Width>
+size_t WideTree<AABB, Width>::get_memory_size() const
+{
+    return
+          sizeof(*this)
+        + m_nodes.capacity() * sizeof(NodeType);
+}
+
+template <typename AABB, size_t Width>
+template <typename Tree>
+size_t WideTree<AABB, Width>::collapse(const Tree& tree, const size_t binary_node_index)
+{
+    assert(tree.m_nodes[binary_node_index].is_interior());
+
+    // Children of the new wide node, as indices into the binary BVH.
+    size_t child_indices[Width];
+    AABBType child_bboxes[Width];
+    size_t child_count = 2;
+
+    const size_t first_child_index = tree.m_nodes[binary_node_index].get_child_node_index();
+    child_indices[0] = first_child_index;
+    child_indices[1] = first_child_index + 1;
+    child_bboxes[0] = tree.m_nodes[binary_node_index].get_left_bbox();
+    child_bboxes[1] = tree.m_nodes[binary_node_index].get_right_bbox();
+
+    // Repeatedly replace the interior child with the largest surface area by its own children.
+    while (child_count < Width)
+    {
+        size_t best_child = Width;
+        typename AABBType::ValueType best_area(-1.0);
+
+        for (size_t i = 0; i < child_count; ++i)
+        {
+            if (tree.m_nodes[child_indices[i]].is_leaf())
+                continue;
+
+            const typename AABBType::ValueType area = half_surface_area(child_bboxes[i]);
+
+            if (best_area < area)
+            {
+                best_area = area;
+                best_child = i;
+            }
+        }
+
+        if (best_child == Width)
+            break;
+
+        // Open the selected child, keeping children in their original left-to-right order.
+        const typename Tree::NodeType& opened = tree.m_nodes[child_indices[best_child]];
+
+        for (size_t i = child_count; i > best_child + 1; --i)
+        {
+            child_indices[i] = child_indices[i - 1];
+            child_bboxes[i] = child_bboxes[i - 1];
+        }
+
+        child_indices[best_child] = opened.get_child_node_index();
+        child_indices[best_child + 1] = opened.get_child_node_index() + 1;
+        child_bboxes[best_child] = opened.get_left_bbox();
+        child_bboxes[best_child + 1] = opened.get_right_bbox();
+
+        ++child_count;
+    }
+
+    // Allocate the new wide node.
+    const size_t node_index = m_nodes.size();
+    m_nodes.push_back(NodeType());
+    m_nodes[node_index].clear();
+
+    // Recursively collapse interior children, then link them to the new node.
+    for (size_t i = 0; i < child_count; ++i)
+    {
+        if (tree.m_nodes[child_indices[i]].is_leaf())
+            m_nodes[node_index].add_leaf_child(child_bboxes[i], child_indices[i]);
+        else
+        {
+            const size_t child_node_index = collapse(tree, child_indices[i]);
+            m_nodes[node_index].add_interior_child(child_bboxes[i], child_node_index);
+        }
+    }
+
+    return node_index;
+}
+
+}       // namespace bvh
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_BVH_BVH_WIDETREE_H
@@ -0,0 +1,322 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_MATH_INTERSECTION_RAYOBBPACKET_H
+#define APPLESEED_FOUNDATION_MATH_INTERSECTION_RAYOBBPACKET_H
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/minmax.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/simdpack.h"
+#endif
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation { namespace impl { template <typename, size_t> class SIMDRayOBBPacketTester; } }
+
+namespace foundation
+{
+
+//
+// A packet of up to Width oriented bounding boxes.
+//
+// An oriented bounding box is defined by three orthonormal axes and, along each
+// axis, the interval covered by the box. The boxes are stored in structure-of-arrays
+// layout so that a ray can be tested against all of them with a handful of SIMD
+// instructions (see foundation::RayOBBPacketTester).
+//
+
+template <typename T, size_t Width>
+class APPLESEED_ALIGN(64) OBBPacket
+{
+  public:
+    typedef T ValueType;
+    typedef Vector<T, 3> VectorType;
+    typedef AABB<T, 3> AABBType;
+
+    static const size_t MaxBoxCount = Width;
+
+    // Remove all boxes. Must be called before the first box is added.
+    void clear();
+
+    // Append a box. The axes must be orthonormal, and the extent holds the interval
+    // covered by the box along each axis, i.e. the box in the frame of the axes.
+    void add_box(const VectorType axes[3], const AABBType& extent);
+
+    // Return the number of boxes.
+    size_t get_box_count() const;
+
+  private:
+    template <typename, size_t> friend class RayOBBPacketTester;
+    template <typename, size_t> friend class impl::SIMDRayOBBPacketTester;
+
+    // Axes as x, y, z of the first axis, x, y, z of the second axis, ... each row holding Width values.
+    APPLESEED_SIMD4_ALIGN ValueType m_axis_data[9 * Width];
+
+    // Extents as min, max along the first axis, min, max along the second axis, ... each row holding Width values.
+    APPLESEED_SIMD4_ALIGN ValueType m_extent_data[6 * Width];
+
+    uint32                          m_box_count;
+};
+
+
+//
+// Test a ray against all the boxes of an OBBPacket at once.
+//
+
+template <typename T, size_t Width>
+class RayOBBPacketTester
+{
+  public:
+    typedef OBBPacket<T, Width> PacketType;
+
+    // Constructor.
+    explicit RayOBBPacketTester(const Ray<T, 3>& ray);
+
+    // Return a bitmask of the boxes hit by the ray between ray.m_tmin and ray_tmax.
+    size_t test(
+        const PacketType&   packet,
+        const T             ray_tmax) const;
+
+  private:
+    const Vector<T, 3>      m_org;
+    const Vector<T, 3>      m_dir;
+    const T                 m_ray_tmin;
+};
+
+
+//
+// OBBPacket class implementation.
+//
+
+template <typename T, size_t Width>
+inline void OBBPacket<T, Width>::clear()
+{
+    for (size_t i = 0; i < 9 * Width; ++i)
+        m_axis_data[i] = ValueType(0.0);
+
+    for (size_t i = 0; i < 6 * Width; ++i)
+        m_extent_data[i] = ValueType(0.0);
+
+    m_box_count = 0;
+}
+
+template <typename T, size_t Width>
+inline void OBBPacket<T, Width>::add_box(const VectorType axes[3], const AABBType& extent)
+{
+    assert(m_box_count < Width);
+
+    const size_t i = m_box_count++;
+
+    for (size_t a = 0; a < 3; ++a)
+    {
+        for (size_t d = 0; d < 3; ++d)
+            m_axis_data[(3 * a + d) * Width + i] = axes[a][d];
+
+        m_extent_data[(2 * a + 0) * Width + i] = extent.min[a];
+        m_extent_data[(2 * a + 1) * Width + i] = extent.max[a];
+    }
+}
+
+template <typename T, size_t Width>
+inline size_t OBBPacket<T, Width>::get_box_count() const
+{
+    return m_box_count;
+}
+
+
+//
+// RayOBBPacketTester class implementation.
+//
+
+template <typename T, size_t Width>
+inline RayOBBPacketTester<T, Width>::RayOBBPacketTester(const Ray<T, 3>& ray)
+  : m_org(ray.m_org)
+  , m_dir(ray.m_dir)
+  , m_ray_tmin(ray.m_tmin)
+{
+}
+
+template <typename T, size_t Width>
+inline size_t RayOBBPacketTester<T, Width>::test(
+    const PacketType&       packet,
+    const T                 ray_tmax) const
+{
+    size_t hits = 0;
+
+    for (size_t i = 0; i < packet.m_box_count; ++i)
+    {
+        T tmin = m_ray_tmin;
+        T tmax = ray_tmax;
+
+        for (size_t a = 0; a < 3; ++a)
+        {
+            const T* axis = packet.m_axis_data + 3 * a * Width + i;
+
+            // Project the ray onto the axis of the box.
+            const T org = axis[0] * m_org.x + axis[Width] * m_org.y + axis[2 * Width] * m_org.z;
+            const T dir = axis[0] * m_dir.x + axis[Width] * m_dir.y + axis[2 * Width] * m_dir.z;
+
+            const T t1 = (packet.m_extent_data[(2 * a + 0) * Width + i] - org) / dir;
+            const T t2 = (packet.m_extent_data[(2 * a + 1) * Width + i] - org) / dir;
+
+            tmin = ssemax(tmin, ssemin(t1, t2));
+            tmax = ssemin(tmax, ssemax(t1, t2));
+        }
+
+        if (!(tmin > tmax || tmin >= ray_tmax))
+            hits |= size_t(1) << i;
+    }
+
+    return hits;
+}
+
+#ifdef APPLESEED_USE_SSE
+
+namespace impl
+{
+    // SIMD implementation, processing Pack::Lanes boxes at a time.
+    template <typename Pack, size_t Width>
+    class SIMDRayOBBPacketTester
+    {
+      public:
+        typedef typename Pack::ValueType T;
+        typedef typename Pack::VectorType V;
+        typedef OBBPacket<T, Width> PacketType;
+
+        static_assert(Width % Pack::Lanes == 0, "OBB packet width must be a multiple of the SIMD width");
+
+        explicit SIMDRayOBBPacketTester(const Ray<T, 3>& ray)
+        {
+            for (size_t d = 0; d < 3; ++d)
+            {
+                m_org[d] = Pack::set1(ray.m_org[d]);
+                m_dir[d] = Pack::set1(ray.m_dir[d]);
+            }
+
+            m_ray_tmin = Pack::set1(ray.m_tmin);
+        }
+
+        size_t test(
+            const PacketType&   packet,
+            const T             ray_tmax) const
+        {
+            const V vray_tmax = Pack::set1(ray_tmax);
+
+            size_t hits = 0;
+
+            for (size_t i = 0; i < packet.m_box_count; i += Pack::Lanes)
+            {
+                V tmin = m_ray_tmin;
+                V tmax = vray_tmax;
+
+                for (size_t a = 0; a < 3; ++a)
+                {
+                    const T* axis = packet.m_axis_data + 3 * a * Width + i;
+                    const V ax = Pack::load(axis);
+                    const V ay = Pack::load(axis + Width);
+                    const V az = Pack::load(axis + 2 * Width);
+
+                    // Project the ray onto the axes of the boxes.
+                    const V org =
+                        Pack::add(
+                            Pack::add(Pack::mul(ax, m_org[0]), Pack::mul(ay, m_org[1])),
+                            Pack::mul(az, m_org[2]));
+                    const V dir =
+                        Pack::add(
+                            Pack::add(Pack::mul(ax, m_dir[0]), Pack::mul(ay, m_dir[1])),
+                            Pack::mul(az, m_dir[2]));
+
+                    const V t1 = Pack::div(Pack::sub(Pack::load(packet.m_extent_data + (2 * a + 0) * Width + i), org), dir);
+                    const V t2 = Pack::div(Pack::sub(Pack::load(packet.m_extent_data + (2 * a + 1) * Width + i), org), dir);
+
+                    tmin = Pack::max(tmin, Pack::min(t1, t2));
+                    tmax = Pack::min(tmax, Pack::max(t1, t2));
+                }
+
+                const int lane_hits = Pack::misses(tmin, tmax, m_ray_tmin, vray_tmax) ^ Pack::AllLanes;
+                hits |= static_cast<size_t>(lane_hits) << i;
+            }
+
+            // Discard the unused slots of the last group of lanes.
+            return hits & ((size_t(1) << packet.m_box_count) - 1);
+        }
+
+      private:
+        V                   m_org[3];
+        V                   m_dir[3];
+        V                   m_ray_tmin;
+    };
+}
+
+template <>
+class RayOBBPacketTester<float, 4>
+  : public impl::SIMDRayOBBPacketTester<SSEFloat4, 4>
+{
+  public:
+    explicit RayOBBPacketTester(const Ray<float, 3>& ray)
+      : impl::SIMDRayOBBPacketTester<SSEFloat4, 4>(ray)
+    {
+    }
+};
+
+template <>
+class RayOBBPacketTester<float, 8>
+  : public impl::SIMDRayOBBPacketTester<WideFloatPack, 8>
+{
+  public:
+    explicit RayOBBPacketTester(const Ray<float, 3>& ray)
+      : impl::SIMDRayOBBPacketTester<WideFloatPack, 8>(ray)
+    {
+    }
+};
+
+template <>
+class RayOBBPacketTester<double, 4>
+  : public impl::SIMDRayOBBPacketTester<WideDoublePack, 4>
+{
+  public:
+    explicit RayOBBPacketTester(const Ray<double, 3>& ray)
+      : impl::SIMDRayOBBPacketTester<WideDoublePack, 4>(ray)
+    {
+    }
+};
+
+#endif  // APPLESEED_USE_SSE
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_INTERSECTION_RAYOBBPACKET_H
@@ -94,6 +94,7 @@ class Answer
 
   private:
     template <typename, size_t> friend class Query;
+    template <typename, size_t> friend class RangeQuery;
 
     const size_t        m_max_size;
     Entry*              m_entries;
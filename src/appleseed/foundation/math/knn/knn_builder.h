@@ -38,6 +38,7 @@
 #include "foundation/math/permutation.h"
 #include "foundation/math/split.h"
 #include "foundation/math/vector.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/stopwatch.h"
 
 // Standard headers.
@@ -47,6 +48,9 @@
 #include <cstring>
 #include <vector>
 
+// Forward declarations.
+namespace foundation    { class Logger; }
+
 namespace foundation {
 namespace knn {
 
@@ -75,14 +79,41 @@ class Builder
     void build_move_points(
         std::vector<VectorType>&    points);
 
+    // Like build_move_points() but using multiple threads. The resulting tree
+    // is identical to the one produced by the single-threaded version.
+    template <typename Timer>
+    void build_move_points(
+        std::vector<VectorType>&    points,
+        Logger&                     logger,
+        const size_t                thread_count);
+
     // Return the construction time.
     double get_build_time() const;
 
   private:
     typedef typename TreeType::NodeType NodeType;
+    typedef std::vector<NodeType> NodeVector;
     typedef AABB<T, N> BboxType;
     typedef Split<T> SplitType;
 
+    // Number of subtrees per thread in a multithreaded build, for load balancing.
+    static const size_t SubtreesPerThread = 8;
+
+    // Minimum number of points in a subtree built by a separate job.
+    static const size_t MinSubtreeSize = 4096;
+
+    struct Subtree
+    {
+        size_t                      m_node_index;       // index of the root of the subtree in the top-level tree
+        size_t                      m_begin;
+        size_t                      m_end;
+        NodeVector                  m_nodes;
+    };
+
+    typedef std::vector<Subtree> SubtreeVector;
+
+    class SubtreeBuildJob;
+
     struct PartitionPredicate
     {
         typedef std::vector<VectorType> PointVector;
@@ -101,10 +132,27 @@ class Builder
     TreeType&   m_tree;
     double      m_build_time;
 
+    void initialize_indices(std::vector<VectorType>& points);
+
+    void reorder_points();
+
+    // Recursively partition a set of points. If 'subtrees' is not null, sets of
+    // at most 'subtree_size' points are not partitioned but collected into
+    // 'subtrees' instead.
     void partition(
+        NodeVector&                 nodes,
         const size_t                parent_node_index,
         const size_t                begin,
-        const size_t                end) const;
+        const size_t                end,
+        const size_t                subtree_size = 0,
+        SubtreeVector*              subtrees = nullptr) const;
+
+    void merge_recurse(
+        const NodeVector&           top_nodes,
+        const SubtreeVector&        subtrees,
+        const std::vector<size_t>&  subtree_indices,
+        const size_t                top_node_index,
+        const size_t                node_index);
 
     BboxType compute_bbox(
         const size_t                begin,
@@ -145,6 +193,32 @@ void Builder<T, N>::build(
     build_move_points<Timer>(vec);
 }
 
+template <typename T, size_t N>
+class Builder<T, N>::SubtreeBuildJob
+  : public IJob
+{
+  public:
+    SubtreeBuildJob(
+        const Builder&              builder,
+        Subtree&                    subtree)
+      : m_builder(builder)
+      , m_subtree(subtree)
+    {
+    }
+
+    void execute(const size_t thread_index) override
+    {
+        // Build the subtree as if it was a tree of its own.
+        m_subtree.m_nodes.reserve((m_subtree.m_end - m_subtree.m_begin) * 2 + 1);
+        m_subtree.m_nodes.push_back(NodeType());
+        m_builder.partition(m_subtree.m_nodes, 0, m_subtree.m_begin, m_subtree.m_end);
+    }
+
+  private:
+    const Builder&                  m_builder;
+    Subtree&                        m_subtree;
+};
+
 template <typename T, size_t N>
 template <typename Timer>
 void Builder<T, N>::build_move_points(
@@ -155,31 +229,81 @@ void Builder<T, N>::build_move_points(
 
     const size_t count = points.size();
 
-    if (count > 0)
-    {
-        m_tree.m_points.swap(points);
-
-        m_tree.m_indices.resize(count);
-
-        for (size_t i = 0; i < count; ++i)
-            m_tree.m_indices[i] = i;
-    }
+    initialize_indices(points);
 
     m_tree.m_nodes.reserve(count * 2 + 1);
     m_tree.m_nodes.push_back(NodeType());
 
-    partition(0, 0, count);
+    partition(m_tree.m_nodes, 0, 0, count);
 
-    if (count > 0)
+    reorder_points();
+
+    stopwatch.measure();
+    m_build_time = stopwatch.get_seconds();
+}
+
+template <typename T, size_t N>
+template <typename Timer>
+void Builder<T, N>::build_move_points(
+    std::vector<VectorType>&    points,
+    Logger&                     logger,
+    const size_t                thread_count)
+{
+    const size_t count = points.size();
+    const size_t subtree_size =
+        std::max(count / (std::max<size_t>(thread_count, 1) * SubtreesPerThread), MinSubtreeSize);
+    if (thread_count < 2 || subtree_size > count / 2)
     {
-        std::vector<VectorType> temp(count);
+        build_move_points<Timer>(points);
+        return;
+    }
 
-        small_item_reorder(
-            &m_tree.m_points[0],
-            &temp[0],
-            &m_tree.m_indices[0],
-            count);
+    Stopwatch<Timer> stopwatch;
+    stopwatch.start();
+
+    initialize_indices(points);
+
+    // Partition the top levels of the tree on the calling thread, collecting subtrees.
+    NodeVector top_nodes;
+    top_nodes.push_back(NodeType());
+    SubtreeVector subtrees;
+    partition(top_nodes, 0, 0, count, subtree_size, &subtrees);
+
+    // Build the subtrees, largest subtrees first. Subtrees cover disjoint
+    // ranges of the index array so they can be partitioned concurrently.
+    std::vector<size_t> order(subtrees.size());
+    for (size_t i = 0, e = order.size(); i < e; ++i)
+        order[i] = i;
+    std::sort(
+        order.begin(),
+        order.end(),
+        [&subtrees](const size_t lhs, const size_t rhs)
+        {
+            return
+                subtrees[lhs].m_end - subtrees[lhs].m_begin >
+                subtrees[rhs].m_end - subtrees[rhs].m_begin;
+        });
+    JobQueue job_queue;
+    for (size_t i = 0, e = order.size(); i < e; ++i)
+        job_queue.schedule(new SubtreeBuildJob(*this, subtrees[order[i]]));
+    JobManager job_manager(logger, job_queue, thread_count);
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    // Merge the top-level tree and the subtrees into the final tree.
+    size_t node_count = top_nodes.size();
+    std::vector<size_t> subtree_indices(top_nodes.size(), ~size_t(0));
+    for (size_t i = 0, e = subtrees.size(); i < e; ++i)
+    {
+        subtree_indices[subtrees[i].m_node_index] = i;
+        node_count += subtrees[i].m_nodes.size() - 1;
     }
+    m_tree.m_nodes.reserve(node_count);
+    m_tree.m_nodes.push_back(NodeType());
+    merge_recurse(top_nodes, subtrees, subtree_indices, 0, 0);
+    assert(m_tree.m_nodes.size() == node_count);
+
+    reorder_points();
 
     stopwatch.measure();
     m_build_time = stopwatch.get_seconds();
@@ -207,17 +331,65 @@ inline bool Builder<T, N>::PartitionPredicate::operator()(
     return m_points[index][m_split.m_dimension] < m_split.m_abscissa;
 }
 
+template <typename T, size_t N>
+void Builder<T, N>::initialize_indices(
+    std::vector<VectorType>&    points)
+{
+    const size_t count = points.size();
+
+    if (count > 0)
+    {
+        m_tree.m_points.swap(points);
+
+        m_tree.m_indices.resize(count);
+
+        for (size_t i = 0; i < count; ++i)
+            m_tree.m_indices[i] = i;
+    }
+}
+
+template <typename T, size_t N>
+void Builder<T, N>::reorder_points()
+{
+    const size_t count = m_tree.m_points.size();
+
+    if (count > 0)
+    {
+        std::vector<VectorType> temp(count);
+
+        small_item_reorder(
+            &m_tree.m_points[0],
+            &temp[0],
+            &m_tree.m_indices[0],
+            count);
+    }
+}
+
 template <typename T, size_t N>
 void Builder<T, N>::partition(
+    NodeVector&                 nodes,
     const size_t                parent_node_index,
     const size_t                begin,
-    const size_t                end) const
+    const size_t                end,
+    const size_t                subtree_size,
+    SubtreeVector*              subtrees) const
 {
     const size_t count = end - begin;
 
+    // Defer the construction of small enough subtrees.
+    if (subtrees && count <= subtree_size)
+    {
+        Subtree subtree;
+        subtree.m_node_index = parent_node_index;
+        subtree.m_begin = begin;
+        subtree.m_end = end;
+        subtrees->push_back(subtree);
+        return;
+    }
+
     if (count <= 1)
     {
-        NodeType& parent_node = m_tree.m_nodes[parent_node_index];
+        NodeType& parent_node = nodes[parent_node_index];
         parent_node.make_leaf();
         parent_node.set_point_index(begin);
         parent_node.set_point_count(count);
@@ -244,13 +416,13 @@ void Builder<T, N>::partition(
         if (pivot == begin || pivot == end)
             pivot = (begin + end) / 2;
 
-        const size_t left_node_index = m_tree.m_nodes.size();
+        const size_t left_node_index = nodes.size();
         const size_t right_node_index = left_node_index + 1;
 
-        m_tree.m_nodes.push_back(NodeType());
-        m_tree.m_nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
 
-        NodeType& parent_node = m_tree.m_nodes[parent_node_index];
+        NodeType& parent_node = nodes[parent_node_index];
         parent_node.make_interior();
         parent_node.set_split_dim(split.m_dimension);
         parent_node.set_split_abs(split.m_abscissa);
@@ -258,8 +430,67 @@ void Builder<T, N>::partition(
         parent_node.set_point_index(begin);
         parent_node.set_point_count(count);
 
-        partition(left_node_index, begin, pivot);
-        partition(right_node_index, pivot, end);
+        partition(nodes, left_node_index, begin, pivot, subtree_size, subtrees);
+        partition(nodes, right_node_index, pivot, end, subtree_size, subtrees);
+    }
+}
+
+template <typename T, size_t N>
+void Builder<T, N>::merge_recurse(
+    const NodeVector&           top_nodes,
+    const SubtreeVector&        subtrees,
+    const std::vector<size_t>&  subtree_indices,
+    const size_t                top_node_index,
+    const size_t                node_index)
+{
+    const size_t subtree_index = subtree_indices[top_node_index];
+
+    if (subtree_index == ~size_t(0))
+    {
+        const NodeType& top_node = top_nodes[top_node_index];
+        m_tree.m_nodes[node_index] = top_node;
+
+        if (top_node.is_interior())
+        {
+            // Allocate the child nodes right away, like partition() does.
+            const size_t left_node_index = m_tree.m_nodes.size();
+            m_tree.m_nodes[node_index].set_child_node_index(left_node_index);
+            m_tree.m_nodes.push_back(NodeType());
+            m_tree.m_nodes.push_back(NodeType());
+
+            merge_recurse(
+                top_nodes,
+                subtrees,
+                subtree_indices,
+                top_node.get_child_node_index(),
+                left_node_index);
+
+            merge_recurse(
+                top_nodes,
+                subtrees,
+                subtree_indices,
+                top_node.get_child_node_index() + 1,
+                left_node_index + 1);
+        }
+    }
+    else
+    {
+        // The root of the subtree takes the place of the top-level node; its
+        // other nodes are appended, shifted by the number of nodes before them.
+        const NodeVector& nodes = subtrees[subtree_index].m_nodes;
+        const size_t offset = m_tree.m_nodes.size() - 1;
+
+        for (size_t i = 0, e = nodes.size(); i < e; ++i)
+        {
+            NodeType node = nodes[i];
+
+            if (node.is_interior())
+                node.set_child_node_index(node.get_child_node_index() + offset);
+
+            if (i == 0)
+                m_tree.m_nodes[node_index] = node;
+            else m_tree.m_nodes.push_back(node);
+        }
     }
 }
 
@@ -0,0 +1,172 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_FOUNDATION_MATH_KNN_KNN_RANGEQUERY_H
+#define APPLESEED_FOUNDATION_MATH_KNN_KNN_RANGEQUERY_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/distance.h"
+#include "foundation/math/knn/knn_answer.h"
+#include "foundation/math/knn/knn_tree.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace knn {
+
+//
+// Fixed-radius query: collect all the points within a given distance of the
+// query point, in no particular order. Unlike Query, no priority queue is
+// maintained, which makes this query much cheaper when the number of points
+// within the search radius is known to be moderate.
+//
+
+template <typename T, size_t N>
+class RangeQuery
+  : public NonCopyable
+{
+  public:
+    typedef T ValueType;
+    static const size_t Dimension = N;
+
+    typedef Vector<T, N> VectorType;
+    typedef Tree<T, N> TreeType;
+    typedef Answer<T> AnswerType;
+
+    RangeQuery(
+        const TreeType&     tree,
+        AnswerType&         answer);
+
+    // Return false if there are more points within the search radius than
+    // the answer can hold, in which case the answer is incomplete.
+    bool run(
+        const VectorType&   query_point,
+        const ValueType     query_max_square_distance) const;
+
+  private:
+    typedef typename TreeType::NodeType NodeType;
+
+    const TreeType&         m_tree;
+    AnswerType&             m_answer;
+};
+
+typedef RangeQuery<float, 2>  RangeQuery2f;
+typedef RangeQuery<double, 2> RangeQuery2d;
+typedef RangeQuery<float, 3>  RangeQuery3f;
+typedef RangeQuery<double, 3> RangeQuery3d;
+
+
+//
+// Implementation.
+//
+
+template <typename T, size_t N>
+inline RangeQuery<T, N>::RangeQuery(
+    const TreeType&         tree,
+    AnswerType&             answer)
+  : m_tree(tree)
+  , m_answer(answer)
+{
+}
+
+template <typename T, size_t N>
+bool RangeQuery<T, N>::run(
+    const VectorType&       query_point,
+    const ValueType         query_max_square_distance) const
+{
+    assert(!m_tree.empty());
+
+    m_answer.clear();
+
+    const VectorType* APPLESEED_RESTRICT points = &m_tree.m_points.front();
+    const NodeType* APPLESEED_RESTRICT nodes = &m_tree.m_nodes.front();
+    const size_t max_answer_size = m_answer.m_max_size;
+
+    const size_t NodeStackSize = 128;
+    const NodeType* node_stack[NodeStackSize];
+    size_t node_stack_size = 0;
+
+    node_stack[node_stack_size++] = nodes;
+
+    while (node_stack_size > 0)
+    {
+        const NodeType* APPLESEED_RESTRICT node = node_stack[--node_stack_size];
+
+        // Descend toward the query point, pushing the far children that intersect the search sphere.
+        while (node->is_interior())
+        {
+            const size_t split_dim = node->get_split_dim();
+            const ValueType split_abs = node->get_split_abs();
+            const ValueType distance = query_point[split_dim] - split_abs;
+
+            const NodeType* APPLESEED_RESTRICT left_child_node = nodes + node->get_child_node_index();
+            const size_t select = distance > ValueType(0.0) ? 1 : 0;
+
+            if (distance * distance < query_max_square_distance)
+            {
+                assert(node_stack_size < NodeStackSize);
+                node_stack[node_stack_size++] = left_child_node + 1 - select;
+            }
+
+            node = left_child_node + select;
+        }
+
+        // Collect the points of the leaf that are within the search radius.
+        size_t point_index = node->get_point_index();
+        const VectorType* APPLESEED_RESTRICT point_ptr = points + point_index;
+        const VectorType* APPLESEED_RESTRICT point_end = point_ptr + node->get_point_count();
+
+        while (point_ptr < point_end)
+        {
+            const ValueType square_dist = square_distance(*point_ptr++, query_point);
+
+            if (square_dist <= query_max_square_distance)
+            {
+                if (m_answer.m_size == max_answer_size)
+                    return false;
+
+                m_answer.array_insert(point_index, square_dist);
+            }
+
+            ++point_index;
+        }
+    }
+
+    return true;
+}
+
+}       // namespace knn
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_MATH_KNN_KNN_RANGEQUERY_H
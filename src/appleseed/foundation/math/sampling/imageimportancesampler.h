@@ -39,12 +39,19 @@
 #include "foundation/math/cdf.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/job/iabortswitch.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <utility>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class Logger; }
 
 namespace foundation
 {
@@ -119,6 +126,122 @@ class ImageImportanceSampler
 };
 
 
+//
+// An image importance sampler based on alias tables.
+//
+// Each row of the image has an alias table over its pixels, and an additional
+// alias table selects rows. Sampling takes constant time. The tables can be
+// built using multiple threads, in which case each thread samples the image
+// through its own copy of the image sampler.
+//
+// Reference:
+//
+//   A Linear Algorithm For Generating Random Numbers With a Given Distribution
+//   Michael D. Vose
+//   http://web.eecs.utk.edu/~vose/Publications/random.pdf
+//
+
+template <typename Payload, typename Importance>
+class AliasImageImportanceSampler
+  : public NonCopyable
+{
+  public:
+    typedef Vector<Importance, 2> Vector2Type;
+
+    // Constructor.
+    AliasImageImportanceSampler(
+        const size_t        width,
+        const size_t        height);
+
+    // Resample the image and rebuild the alias tables.
+    template <typename ImageSampler>
+    void rebuild(
+        ImageSampler&       sampler,
+        IAbortSwitch*       abort_switch = nullptr);
+
+    // Resample the image and rebuild the alias tables using multiple threads.
+    // The image sampler must be copy-constructible.
+    template <typename ImageSampler>
+    void rebuild(
+        const ImageSampler& sampler,
+        Logger&             logger,
+        const size_t        thread_count,
+        IAbortSwitch*       abort_switch = nullptr);
+
+    // Sample the image and return the coordinates of the chosen pixel
+    // and its probability density.
+    void sample(
+        const Vector2Type&  s,
+        size_t&             x,
+        size_t&             y,
+        Importance&         probability) const;
+
+    // Sample the image and return the coordinates of the chosen pixel,
+    // its probability density and its associated payload.
+    void sample(
+        const Vector2Type&  s,
+        size_t&             x,
+        size_t&             y,
+        Payload&            payload,
+        Importance&         probability) const;
+
+    // Return the probability density of a given pixel.
+    Importance get_pdf(
+        const size_t        x,
+        const size_t        y) const;
+
+    // Return the approximate amount of memory used by the sampler, in bytes.
+    size_t get_memory_size() const;
+
+  private:
+    struct Entry
+    {
+        Importance          m_threshold;    // probability of keeping this entry rather than its alias
+        Importance          m_pdf;          // probability of this entry
+        uint32              m_alias;
+    };
+
+    template <typename ImageSampler> class RowBuildJob;
+
+    const size_t            m_width;
+    const size_t            m_height;
+    const Importance        m_rcp_pixel_count;
+
+    std::vector<Payload>    m_payloads;
+    std::vector<Entry>      m_col_entries;  // one alias table per row
+    std::vector<Entry>      m_row_entries;
+    std::vector<Importance> m_row_weights;
+    bool                    m_valid;
+
+    template <typename ImageSampler>
+    void build_rows(
+        ImageSampler&       sampler,
+        const size_t        begin,
+        const size_t        end,
+        IAbortSwitch*       abort_switch);
+
+    void build_row_table();
+
+    static void build_alias_table(
+        const Importance*   weights,
+        const size_t        count,
+        Entry*              entries,
+        std::vector<uint32>& small,
+        std::vector<uint32>& large);
+
+    static size_t sample_alias_table(
+        const Entry*        entries,
+        const size_t        count,
+        const Importance    s);
+
+    void sample_pixel(
+        const Vector2Type&  s,
+        size_t&             x,
+        size_t&             y,
+        Importance&         probability) const;
+};
+
+
 //
 // A simple foundation::Image sampler designed for RGB and RGBA images.
 //
@@ -292,6 +415,332 @@ inline Importance ImageImportanceSampler<Payload, Importance>::get_pdf(
 }
 
 
+//
+// AliasImageImportanceSampler class implementation.
+//
+
+template <typename Payload, typename Importance>
+template <typename ImageSampler>
+class AliasImageImportanceSampler<Payload, Importance>::RowBuildJob
+  : public IJob
+{
+  public:
+    RowBuildJob(
+        AliasImageImportanceSampler&    importance_sampler,
+        std::vector<ImageSampler>&      samplers,
+        const size_t                    begin,
+        const size_t                    end,
+        IAbortSwitch*                   abort_switch)
+      : m_importance_sampler(importance_sampler)
+      , m_samplers(samplers)
+      , m_begin(begin)
+      , m_end(end)
+      , m_abort_switch(abort_switch)
+    {
+    }
+
+    void execute(const size_t thread_index) override
+    {
+        // Each worker thread only ever uses its own sampler.
+        m_importance_sampler.build_rows(
+            m_samplers[thread_index],
+            m_begin,
+            m_end,
+            m_abort_switch);
+    }
+
+  private:
+    AliasImageImportanceSampler&        m_importance_sampler;
+    std::vector<ImageSampler>&          m_samplers;
+    const size_t                        m_begin;
+    const size_t                        m_end;
+    IAbortSwitch*                       m_abort_switch;
+};
+
+template <typename Payload, typename Importance>
+AliasImageImportanceSampler<Payload, Importance>::AliasImageImportanceSampler(
+    const size_t            width,
+    const size_t            height)
+  : m_width(width)
+  , m_height(height)
+  , m_rcp_pixel_count(Importance(1.0) / (width * height))
+  , m_payloads(width * height)
+  , m_col_entries(width * height)
+  , m_row_entries(height)
+  , m_row_weights(height, Importance(0.0))
+  , m_valid(false)
+{
+}
+
+template <typename Payload, typename Importance>
+template <typename ImageSampler>
+void AliasImageImportanceSampler<Payload, Importance>::rebuild(
+    ImageSampler&           sampler,
+    IAbortSwitch*           abort_switch)
+{
+    build_rows(sampler, 0, m_height, abort_switch);
+
+    if (is_aborted(abort_switch))
+        m_valid = false;
+    else build_row_table();
+}
+
+template <typename Payload, typename Importance>
+template <typename ImageSampler>
+void AliasImageImportanceSampler<Payload, Importance>::rebuild(
+    const ImageSampler&     sampler,
+    Logger&                 logger,
+    const size_t            thread_count,
+    IAbortSwitch*           abort_switch)
+{
+    // Split the image into a few bands of rows per thread for load balancing.
+    const size_t RowsPerBandHint = 16;
+    const size_t rows_per_band =
+        std::max(m_height / (std::max<size_t>(thread_count, 1) * 8), RowsPerBandHint);
+
+    if (thread_count < 2 || rows_per_band >= m_height)
+    {
+        ImageSampler sampler_copy(sampler);
+        rebuild(sampler_copy, abort_switch);
+        return;
+    }
+
+    std::vector<ImageSampler> samplers(thread_count, sampler);
+
+    JobQueue job_queue;
+    for (size_t begin = 0; begin < m_height; begin += rows_per_band)
+    {
+        job_queue.schedule(
+            new RowBuildJob<ImageSampler>(
+                *this,
+                samplers,
+                begin,
+                std::min(begin + rows_per_band, m_height),
+                abort_switch));
+    }
+
+    JobManager job_manager(logger, job_queue, thread_count);
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    if (is_aborted(abort_switch))
+        m_valid = false;
+    else build_row_table();
+}
+
+template <typename Payload, typename Importance>
+inline void AliasImageImportanceSampler<Payload, Importance>::sample(
+    const Vector2Type&      s,
+    size_t&                 x,
+    size_t&                 y,
+    Importance&             probability) const
+{
+    sample_pixel(s, x, y, probability);
+}
+
+template <typename Payload, typename Importance>
+inline void AliasImageImportanceSampler<Payload, Importance>::sample(
+    const Vector2Type&      s,
+    size_t&                 x,
+    size_t&                 y,
+    Payload&                payload,
+    Importance&             probability) const
+{
+    sample_pixel(s, x, y, probability);
+    payload = m_payloads[y * m_width + x];
+}
+
+template <typename Payload, typename Importance>
+inline Importance AliasImageImportanceSampler<Payload, Importance>::get_pdf(
+    const size_t            x,
+    const size_t            y) const
+{
+    return
+        m_valid
+            ? m_row_entries[y].m_pdf * m_col_entries[y * m_width + x].m_pdf
+            : m_rcp_pixel_count;
+}
+
+template <typename Payload, typename Importance>
+size_t AliasImageImportanceSampler<Payload, Importance>::get_memory_size() const
+{
+    return
+          sizeof(*this)
+        + m_payloads.capacity() * sizeof(Payload)
+        + m_col_entries.capacity() * sizeof(Entry)
+        + m_row_entries.capacity() * sizeof(Entry)
+        + m_row_weights.capacity() * sizeof(Importance);
+}
+
+template <typename Payload, typename Importance>
+template <typename ImageSampler>
+void AliasImageImportanceSampler<Payload, Importance>::build_rows(
+    ImageSampler&           sampler,
+    const size_t            begin,
+    const size_t            end,
+    IAbortSwitch*           abort_switch)
+{
+    std::vector<Importance> weights(m_width);
+    std::vector<uint32> small, large;
+
+    for (size_t y = begin; y < end; ++y)
+    {
+        if (is_aborted(abort_switch))
+            break;
+
+        Payload* payloads = &m_payloads[y * m_width];
+        Importance row_weight(0.0);
+
+        for (size_t x = 0; x < m_width; ++x)
+        {
+            sampler.sample(x, y, payloads[x], weights[x]);
+            assert(weights[x] >= Importance(0.0));
+            row_weight += weights[x];
+        }
+
+        build_alias_table(&weights[0], m_width, &m_col_entries[y * m_width], small, large);
+        m_row_weights[y] = row_weight;
+    }
+}
+
+template <typename Payload, typename Importance>
+void AliasImageImportanceSampler<Payload, Importance>::build_row_table()
+{
+    std::vector<uint32> small, large;
+    build_alias_table(&m_row_weights[0], m_height, &m_row_entries[0], small, large);
+
+    m_valid = false;
+    for (size_t y = 0; y < m_height; ++y)
+    {
+        if (m_row_weights[y] > Importance(0.0))
+        {
+            m_valid = true;
+            break;
+        }
+    }
+}
+
+template <typename Payload, typename Importance>
+void AliasImageImportanceSampler<Payload, Importance>::build_alias_table(
+    const Importance*       weights,
+    const size_t            count,
+    Entry*                  entries,
+    std::vector<uint32>&    small,
+    std::vector<uint32>&    large)
+{
+    Importance total(0.0);
+    for (size_t i = 0; i < count; ++i)
+        total += weights[i];
+
+    const Importance rcp_total = total > Importance(0.0) ? Importance(1.0) / total : Importance(0.0);
+
+    // Scale the probabilities such that their average is 1 and
+    // split entries between underfull and overfull ones.
+    small.clear();
+    large.clear();
+    size_t heaviest = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (weights[heaviest] < weights[i])
+            heaviest = i;
+
+        Entry& entry = entries[i];
+        entry.m_pdf = weights[i] * rcp_total;
+        entry.m_threshold = entry.m_pdf * count;
+        entry.m_alias = static_cast<uint32>(i);
+
+        if (entry.m_threshold < Importance(1.0))
+            small.push_back(static_cast<uint32>(i));
+        else large.push_back(static_cast<uint32>(i));
+    }
+
+    // Fill each underfull entry with probability from an overfull one.
+    while (!small.empty() && !large.empty())
+    {
+        const uint32 s = small.back();
+        small.pop_back();
+
+        const uint32 l = large.back();
+        entries[s].m_alias = l;
+        entries[l].m_threshold -= Importance(1.0) - entries[s].m_threshold;
+
+        if (entries[l].m_threshold < Importance(1.0))
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Remaining entries are full, up to rounding errors.
+    for (size_t i = 0, e = large.size(); i < e; ++i)
+        entries[large[i]].m_threshold = Importance(1.0);
+
+    // With many entries, rounding errors may exhaust overfull entries early, leaving
+    // underfull ones behind. Never let entries with a null probability be chosen.
+    for (size_t i = 0, e = small.size(); i < e; ++i)
+    {
+        Entry& entry = entries[small[i]];
+
+        if (entry.m_pdf > Importance(0.0) || total == Importance(0.0))
+            entry.m_threshold = Importance(1.0);
+        else
+        {
+            entry.m_threshold = Importance(0.0);
+            entry.m_alias = static_cast<uint32>(heaviest);
+        }
+    }
+}
+
+template <typename Payload, typename Importance>
+inline size_t AliasImageImportanceSampler<Payload, Importance>::sample_alias_table(
+    const Entry*            entries,
+    const size_t            count,
+    const Importance        s)
+{
+    assert(s >= Importance(0.0) && s < Importance(1.0));
+
+    // Use the integer part of the scaled sample to select an entry
+    // and its fractional part to choose between the entry and its alias.
+    const Importance scaled = s * count;
+    const size_t i = std::min(truncate<size_t>(scaled), count - 1);
+    const Entry& entry = entries[i];
+
+    return scaled - i < entry.m_threshold ? i : entry.m_alias;
+}
+
+template <typename Payload, typename Importance>
+inline void AliasImageImportanceSampler<Payload, Importance>::sample_pixel(
+    const Vector2Type&      s,
+    size_t&                 x,
+    size_t&                 y,
+    Importance&             probability) const
+{
+    if (m_valid)
+    {
+        // Select a row.
+        y = sample_alias_table(&m_row_entries[0], m_height, s[1]);
+        assert(m_row_entries[y].m_pdf != Importance(0.0));
+
+        // Select a column within this row.
+        const Entry* row = &m_col_entries[y * m_width];
+        x = sample_alias_table(row, m_width, s[0]);
+        assert(row[x].m_pdf != Importance(0.0));
+
+        probability = m_row_entries[y].m_pdf * row[x].m_pdf;
+    }
+    else
+    {
+        // Uniform random sampling.
+        x = truncate<size_t>(s[0] * m_width);
+        y = truncate<size_t>(s[1] * m_height);
+
+        probability = m_rcp_pixel_count;
+    }
+
+    assert(probability > Importance(0.0));
+}
+
+
 //
 // ImageSampler class implementation.
 //
@@ -36,10 +36,20 @@
 #include "foundation/mesh/imeshbuilder.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/memorymappedfile.h"
+
+// lz4 headers.
+#include "lz4.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cstring>
+#include <limits>
 #include <memory>
 
 using namespace std;
@@ -47,12 +57,247 @@ using namespace std;
 namespace foundation
 {
 
+namespace
+{
+    const char Signature[10] = { 'B', 'I', 'N', 'A', 'R', 'Y', 'M', 'E', 'S', 'H' };
+
+    enum ArrayCompression
+    {
+        ArrayCompressionNone = 0,
+        ArrayCompressionLZ4Chunks = 1
+    };
+
+    // Bounds-checked sequential access to a memory-mapped file.
+    class MappedFileReader
+    {
+      public:
+        MappedFileReader(const uint8* data, const size_t size)
+          : m_data(data)
+          , m_size(size)
+          , m_offset(0)
+        {
+        }
+
+        bool at_end() const
+        {
+            return m_offset == m_size;
+        }
+
+        const uint8* skip(const size_t size)
+        {
+            if (size > m_size - m_offset)
+                throw ExceptionIOError("truncated binarymesh file");
+
+            const uint8* ptr = m_data + m_offset;
+            m_offset += size;
+            return ptr;
+        }
+
+        void align(const size_t alignment)
+        {
+            const size_t remainder = m_offset % alignment;
+            if (remainder > 0)
+                skip(alignment - remainder);
+        }
+
+        template <typename T>
+        T read()
+        {
+            T value;
+            memcpy(&value, skip(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        string read_string()
+        {
+            const uint16 length = read<uint16>();
+            const char* ptr = reinterpret_cast<const char*>(skip(length));
+            return string(ptr, ptr + length);
+        }
+
+      private:
+        const uint8*    m_data;
+        const size_t    m_size;
+        size_t          m_offset;
+    };
+
+    struct DecompressionTask
+    {
+        const uint8*    m_source;
+        size_t          m_source_size;
+        uint8*          m_dest;
+        size_t          m_dest_size;
+    };
+
+    // Decompress one chunk. Return false if the chunk is corrupted.
+    bool decompress_chunk(const DecompressionTask& task)
+    {
+        const int decompressed_size =
+            LZ4_decompress_safe(
+                reinterpret_cast<const char*>(task.m_source),
+                reinterpret_cast<char*>(task.m_dest),
+                static_cast<int>(task.m_source_size),
+                static_cast<int>(task.m_dest_size));
+
+        return decompressed_size >= 0 && static_cast<size_t>(decompressed_size) == task.m_dest_size;
+    }
+
+    class DecompressionJob
+      : public IJob
+    {
+      public:
+        DecompressionJob(
+            const DecompressionTask&    task,
+            boost::atomic<bool>&        failed)
+          : m_task(task)
+          , m_failed(failed)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            if (!m_failed && !decompress_chunk(m_task))
+                m_failed = true;
+        }
+
+      private:
+        const DecompressionTask&        m_task;
+        boost::atomic<bool>&            m_failed;
+    };
+
+    // Decompress all chunks using up to a given number of threads.
+    void decompress_chunks(
+        const vector<DecompressionTask>&    tasks,
+        Logger*                             logger,
+        const size_t                        thread_count)
+    {
+        boost::atomic<bool> failed(false);
+
+        if (logger != nullptr && thread_count > 1 && tasks.size() > 1)
+        {
+            JobQueue job_queue;
+
+            for (size_t i = 0, e = tasks.size(); i < e; ++i)
+                job_queue.schedule(new DecompressionJob(tasks[i], failed));
+
+            JobManager job_manager(*logger, job_queue, min(tasks.size(), thread_count));
+            job_manager.start();
+            job_queue.wait_until_completion();
+        }
+        else
+        {
+            for (size_t i = 0, e = tasks.size(); i < e && !failed; ++i)
+                failed = !decompress_chunk(tasks[i]);
+        }
+
+        if (failed)
+            throw ExceptionIOError("corrupted binarymesh data chunk");
+    }
+
+    // Locate an array of a version 4 mesh. Compressed arrays are not decompressed
+    // right away: a decompression task is recorded for each of their chunks instead.
+    const void* read_array(
+        MappedFileReader&               reader,
+        const uint32                compression,
+        const uint32                chunk_size,
+        const uint64                count,
+        const size_t                item_size,
+        vector<uint8>&              buffer,
+        vector<DecompressionTask>&  tasks)
+    {
+        if (count > numeric_limits<size_t>::max() / item_size)
+            throw ExceptionIOError("invalid binarymesh array size");
+
+        const size_t size = static_cast<size_t>(count) * item_size;
+
+        reader.align(16);
+
+        if (compression == ArrayCompressionNone)
+            return size > 0 ? reader.skip(size) : 0;
+
+        if (size == 0)
+            return 0;
+
+        const size_t chunk_count = (size + chunk_size - 1) / chunk_size;
+        const uint8* chunk_sizes = reader.skip(chunk_count * sizeof(uint64));
+
+        buffer.resize(size);
+
+        for (size_t i = 0; i < chunk_count; ++i)
+        {
+            uint64 compressed_size;
+            memcpy(&compressed_size, chunk_sizes + i * sizeof(uint64), sizeof(uint64));
+
+            if (compressed_size > static_cast<uint64>(numeric_limits<int>::max()))
+                throw ExceptionIOError("invalid binarymesh chunk size");
+
+            DecompressionTask task;
+            task.m_source_size = static_cast<size_t>(compressed_size);
+            task.m_source = reader.skip(task.m_source_size);
+            task.m_dest = &buffer[i * chunk_size];
+            task.m_dest_size = min(static_cast<size_t>(chunk_size), size - i * chunk_size);
+            tasks.push_back(task);
+        }
+
+        return &buffer[0];
+    }
+
+    // Feed meshes stored as arrays to a mesh builder, one array at a time.
+    class MeshBuilderAdapter
+      : public IBinaryMeshArraysHandler
+    {
+      public:
+        explicit MeshBuilderAdapter(IMeshBuilder& builder)
+          : m_builder(builder)
+        {
+        }
+
+        void on_mesh(const BinaryMeshArrays& mesh) override
+        {
+            m_builder.begin_mesh(mesh.m_name.c_str());
+
+            if (mesh.m_vertex_count > 0)
+                m_builder.push_vertex_array(mesh.m_vertices, mesh.m_vertex_count);
+
+            if (mesh.m_vertex_normal_count > 0)
+                m_builder.push_vertex_normal_array(mesh.m_vertex_normals, mesh.m_vertex_normal_count);
+
+            if (mesh.m_tex_coords_count > 0)
+                m_builder.push_tex_coords_array(mesh.m_tex_coords, mesh.m_tex_coords_count);
+
+            for (size_t i = 0; i < mesh.m_material_slots.size(); ++i)
+                m_builder.push_material_slot(mesh.m_material_slots[i].c_str());
+
+            if (mesh.m_triangle_count > 0)
+                m_builder.push_triangle_array(mesh.m_triangles, mesh.m_triangle_count);
+
+            m_builder.end_mesh();
+        }
+
+      private:
+        IMeshBuilder& m_builder;
+    };
+}
+
+
 //
 // BinaryMeshFileReader class implementation.
 //
 
 BinaryMeshFileReader::BinaryMeshFileReader(const string& filename)
   : m_filename(filename)
+  , m_logger(nullptr)
+  , m_thread_count(1)
+{
+}
+
+BinaryMeshFileReader::BinaryMeshFileReader(
+    const string&   filename,
+    Logger&         logger,
+    const size_t    thread_count)
+  : m_filename(filename)
+  , m_logger(&logger)
+  , m_thread_count(thread_count)
 {
 }
 
@@ -91,6 +336,15 @@ void BinaryMeshFileReader::read(IMeshBuilder& builder)
         reader.reset(new LZ4CompressedReaderAdapter(file));
         break;
 
+      // Aligned arrays, optionally compressed by chunks with LZ4.
+      case 4:
+        {
+            file.close();
+            MeshBuilderAdapter adapter(builder);
+            read_arrays(adapter);
+        }
+        return;
+
       // Unknown format.
       default:
         throw ExceptionIOError("unknown binarymesh format version");
@@ -101,12 +355,10 @@ void BinaryMeshFileReader::read(IMeshBuilder& builder)
 
 void BinaryMeshFileReader::read_and_check_signature(BufferedFile& file)
 {
-    static const char ExpectedSig[10] = { 'B', 'I', 'N', 'A', 'R', 'Y', 'M', 'E', 'S', 'H' };
-
-    char signature[sizeof(ExpectedSig)];
+    char signature[sizeof(Signature)];
     checked_read(file, signature, sizeof(signature));
 
-    if (memcmp(signature, ExpectedSig, sizeof(ExpectedSig)))
+    if (memcmp(signature, Signature, sizeof(Signature)))
         throw ExceptionIOError("invalid binarymesh format signature");
 }
 
@@ -253,4 +505,76 @@ void BinaryMeshFileReader::read_face(ReaderAdapter& reader, IMeshBuilder& builde
     builder.end_face();
 }
 
+bool BinaryMeshFileReader::read_arrays(IBinaryMeshArraysHandler& handler)
+{
+    static_assert(
+        sizeof(Vector3f) == 3 * sizeof(float) && sizeof(Vector2f) == 2 * sizeof(float),
+        "foundation::BinaryMeshFileReader expects tightly packed vectors");
+    static_assert(
+        sizeof(MeshTriangle) == 10 * sizeof(uint32),
+        "foundation::BinaryMeshFileReader expects triangles to match the binarymesh layout");
+
+    MemoryMappedFile file(m_filename.c_str());
+
+    if (!file.is_open())
+        throw ExceptionIOError();
+
+    MappedFileReader reader(file.data(), file.size());
+
+    if (memcmp(reader.skip(sizeof(Signature)), Signature, sizeof(Signature)))
+        throw ExceptionIOError("invalid binarymesh format signature");
+
+    if (reader.read<uint16>() != 4)
+        return false;
+
+    BinaryMeshArrays mesh;
+    vector<uint8> vertex_buffer, normal_buffer, tex_coords_buffer, triangle_buffer;
+    vector<DecompressionTask> tasks;
+
+    while (!reader.at_end())
+    {
+        mesh.m_name = reader.read_string();
+
+        mesh.m_material_slots.resize(reader.read<uint16>());
+        for (size_t i = 0; i < mesh.m_material_slots.size(); ++i)
+            mesh.m_material_slots[i] = reader.read_string();
+
+        reader.align(8);
+
+        const uint64 vertex_count = reader.read<uint64>();
+        const uint64 vertex_normal_count = reader.read<uint64>();
+        const uint64 tex_coords_count = reader.read<uint64>();
+        const uint64 triangle_count = reader.read<uint64>();
+        const uint32 compression = reader.read<uint32>();
+        const uint32 chunk_size = reader.read<uint32>();
+
+        if (compression != ArrayCompressionNone &&
+            (compression != ArrayCompressionLZ4Chunks || chunk_size == 0))
+            throw ExceptionIOError("invalid binarymesh array compression");
+
+        clear_keep_memory(tasks);
+
+        mesh.m_vertices = static_cast<const Vector3f*>(
+            read_array(reader, compression, chunk_size, vertex_count, sizeof(Vector3f), vertex_buffer, tasks));
+        mesh.m_vertex_normals = static_cast<const Vector3f*>(
+            read_array(reader, compression, chunk_size, vertex_normal_count, sizeof(Vector3f), normal_buffer, tasks));
+        mesh.m_tex_coords = static_cast<const Vector2f*>(
+            read_array(reader, compression, chunk_size, tex_coords_count, sizeof(Vector2f), tex_coords_buffer, tasks));
+        mesh.m_triangles = static_cast<const MeshTriangle*>(
+            read_array(reader, compression, chunk_size, triangle_count, sizeof(MeshTriangle), triangle_buffer, tasks));
+
+        mesh.m_vertex_count = static_cast<size_t>(vertex_count);
+        mesh.m_vertex_normal_count = static_cast<size_t>(vertex_normal_count);
+        mesh.m_tex_coords_count = static_cast<size_t>(tex_coords_count);
+        mesh.m_triangle_count = static_cast<size_t>(triangle_count);
+
+        if (!tasks.empty())
+            decompress_chunks(tasks, m_logger, m_thread_count);
+
+        handler.on_mesh(mesh);
+    }
+
+    return true;
+}
+
 }   // namespace foundation
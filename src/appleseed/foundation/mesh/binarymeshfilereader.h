@@ -31,6 +31,9 @@
 #define APPLESEED_FOUNDATION_MESH_BINARYMESHFILEREADER_H
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/vector.h"
+#include "foundation/mesh/imeshbuilder.h"
 #include "foundation/mesh/imeshfilereader.h"
 #include "foundation/platform/compiler.h"
 
@@ -41,12 +44,47 @@
 
 // Forward declarations.
 namespace foundation    { class BufferedFile; }
-namespace foundation    { class IMeshBuilder; }
+namespace foundation    { class Logger; }
 namespace foundation    { class ReaderAdapter; }
 
 namespace foundation
 {
 
+//
+// Meshes of binarymesh files using format version 4, exposed as flat arrays.
+//
+// Arrays point either directly into the memory-mapped file or into temporary
+// decompression buffers; in both cases they are only valid for the duration of
+// the IBinaryMeshArraysHandler::on_mesh() call.
+//
+
+struct BinaryMeshArrays
+{
+    std::string                 m_name;
+    std::vector<std::string>    m_material_slots;
+
+    size_t                      m_vertex_count;
+    const Vector3f*             m_vertices;
+    size_t                      m_vertex_normal_count;
+    const Vector3f*             m_vertex_normals;
+    size_t                      m_tex_coords_count;
+    const Vector2f*             m_tex_coords;
+    size_t                      m_triangle_count;
+    const MeshTriangle*         m_triangles;
+};
+
+class IBinaryMeshArraysHandler
+  : public NonCopyable
+{
+  public:
+    // Destructor.
+    virtual ~IBinaryMeshArraysHandler() {}
+
+    // Receive one mesh.
+    virtual void on_mesh(const BinaryMeshArrays& mesh) = 0;
+};
+
+
 //
 // Read for a simple binary mesh file format.
 //
@@ -58,11 +96,24 @@ class BinaryMeshFileReader
     // Constructor.
     explicit BinaryMeshFileReader(const std::string& filename);
 
+    // Constructor. Compressed chunks are decompressed using up to `thread_count` threads.
+    BinaryMeshFileReader(
+        const std::string&  filename,
+        Logger&             logger,
+        const size_t        thread_count);
+
     // Read a mesh.
     void read(IMeshBuilder& builder) override;
 
+    // Read a mesh stored using format version 4 without any per-element decoding.
+    // Returns false, without reading anything, if the file uses an older format
+    // version, in which case read() must be used instead.
+    bool read_arrays(IBinaryMeshArraysHandler& handler);
+
   private:
     const std::string       m_filename;
+    Logger*                 m_logger;
+    const size_t            m_thread_count;
     std::vector<size_t>     m_vertices;
     std::vector<size_t>     m_vertex_normals;
     std::vector<size_t>     m_tex_coords;
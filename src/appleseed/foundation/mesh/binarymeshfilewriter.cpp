@@ -32,26 +32,114 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/math/triangulator.h"
 #include "foundation/math/vector.h"
 #include "foundation/mesh/imeshwalker.h"
 #include "foundation/platform/types.h"
+#include "foundation/utility/memory.h"
+
+// lz4 headers.
+#include "lz4.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 using namespace std;
 
 namespace foundation
 {
 
+namespace
+{
+    // Return a vertex attribute index as stored in format version 4.
+    uint32 get_array_index(const size_t index, const size_t count)
+    {
+        return index < count ? static_cast<uint32>(index) : ~uint32(0);
+    }
+
+    // Append the triangles of a face to a version 4 triangle array.
+    void append_face_triangles(
+        const IMeshWalker&      walker,
+        const size_t            face_index,
+        Triangulator<double>&   triangulator,
+        vector<Vector3d>&       polygon,
+        vector<size_t>&         triangles,
+        vector<uint32>&         output)
+    {
+        const size_t face_vertex_count = walker.get_face_vertex_count(face_index);
+
+        if (face_vertex_count < 3)
+            return;
+
+        clear_keep_memory(triangles);
+
+        if (face_vertex_count > 3)
+        {
+            clear_keep_memory(polygon);
+
+            for (size_t i = 0; i < face_vertex_count; ++i)
+                polygon.push_back(walker.get_vertex(walker.get_face_vertex(face_index, i)));
+
+            // Polygons that cannot be triangulated are replaced by zero-area triangles,
+            // like it would happen when loading the original polygonal mesh.
+            if (!triangulator.triangulate(polygon, triangles))
+                triangles.assign((face_vertex_count - 2) * 3, 0);
+        }
+        else
+        {
+            triangles.push_back(0);
+            triangles.push_back(1);
+            triangles.push_back(2);
+        }
+
+        const size_t vertex_count = walker.get_vertex_count();
+        const size_t vertex_normal_count = walker.get_vertex_normal_count();
+        const size_t tex_coords_count = walker.get_tex_coords_count();
+
+        for (size_t i = 0; i < triangles.size(); i += 3)
+        {
+            uint32 t[10];
+
+            for (size_t j = 0; j < 3; ++j)
+            {
+                const size_t v = triangles[i + j];
+                t[j + 0] = get_array_index(walker.get_face_vertex(face_index, v), vertex_count);
+                t[j + 3] = get_array_index(walker.get_face_vertex_normal(face_index, v), vertex_normal_count);
+                t[j + 6] = get_array_index(walker.get_face_tex_coords(face_index, v), tex_coords_count);
+            }
+
+            // Vertex normals and texture coordinates are either all present or all absent.
+            if (t[3] == ~uint32(0) || t[4] == ~uint32(0) || t[5] == ~uint32(0))
+                t[3] = t[4] = t[5] = ~uint32(0);
+            if (t[6] == ~uint32(0) || t[7] == ~uint32(0) || t[8] == ~uint32(0))
+                t[6] = t[7] = t[8] = ~uint32(0);
+
+            t[9] = static_cast<uint32>(walker.get_face_material(face_index));
+
+            output.insert(output.end(), t, t + 10);
+        }
+    }
+}
+
 //
 // BinaryMeshFileWriter class implementation.
 //
 
-BinaryMeshFileWriter::BinaryMeshFileWriter(const string& filename)
+BinaryMeshFileWriter::BinaryMeshFileWriter(
+    const string&   filename,
+    const uint16    version,
+    const int       options)
   : m_filename(filename)
-  , m_writer(m_file, 256 * 1024)
+  , m_version(version)
+  , m_options(options)
 {
+    if (m_version == 3)
+        m_writer.reset(new LZ4CompressedWriterAdapter(m_file, 256 * 1024));
+    else if (m_version == 4)
+        m_writer.reset(new PassthroughWriterAdapter(m_file));
+    else throw ExceptionIOError("unsupported binarymesh format version");
 }
 
 void BinaryMeshFileWriter::write(const IMeshWalker& walker)
@@ -70,7 +158,9 @@ void BinaryMeshFileWriter::write(const IMeshWalker& walker)
         write_version();
     }
 
-    write_mesh(walker);
+    if (m_version == 4)
+        write_mesh_arrays(walker);
+    else write_mesh(walker);
 }
 
 void BinaryMeshFileWriter::write_signature()
@@ -82,17 +172,15 @@ void BinaryMeshFileWriter::write_signature()
 
 void BinaryMeshFileWriter::write_version()
 {
-    const uint16 Version = 3;
-
-    checked_write(m_file, Version);
+    checked_write(m_file, m_version);
 }
 
 void BinaryMeshFileWriter::write_string(const char* s)
 {
     const uint16 length = static_cast<uint16>(strlen(s));
 
-    checked_write(m_writer, length);
-    checked_write(m_writer, s, length);
+    checked_write(*m_writer, length);
+    checked_write(*m_writer, s, length);
 }
 
 void BinaryMeshFileWriter::write_mesh(const IMeshWalker& walker)
@@ -108,34 +196,34 @@ void BinaryMeshFileWriter::write_mesh(const IMeshWalker& walker)
 void BinaryMeshFileWriter::write_vertices(const IMeshWalker& walker)
 {
     const uint32 count = static_cast<uint32>(walker.get_vertex_count());
-    checked_write(m_writer, count);
+    checked_write(*m_writer, count);
 
     for (uint32 i = 0; i < count; ++i)
-        checked_write(m_writer, walker.get_vertex(i));
+        checked_write(*m_writer, walker.get_vertex(i));
 }
 
 void BinaryMeshFileWriter::write_vertex_normals(const IMeshWalker& walker)
 {
     const uint32 count = static_cast<uint32>(walker.get_vertex_normal_count());
-    checked_write(m_writer, count);
+    checked_write(*m_writer, count);
 
     for (uint32 i = 0; i < count; ++i)
-        checked_write(m_writer, walker.get_vertex_normal(i));
+        checked_write(*m_writer, walker.get_vertex_normal(i));
 }
 
 void BinaryMeshFileWriter::write_texture_coordinates(const IMeshWalker& walker)
 {
     const uint32 count = static_cast<uint32>(walker.get_tex_coords_count());
-    checked_write(m_writer, count);
+    checked_write(*m_writer, count);
 
     for (uint32 i = 0; i < count; ++i)
-        checked_write(m_writer, walker.get_tex_coords(i));
+        checked_write(*m_writer, walker.get_tex_coords(i));
 }
 
 void BinaryMeshFileWriter::write_material_slots(const IMeshWalker& walker)
 {
     const uint16 count = static_cast<uint16>(walker.get_material_slot_count());
-    checked_write(m_writer, count);
+    checked_write(*m_writer, count);
 
     for (uint16 i = 0; i < count; ++i)
         write_string(walker.get_material_slot(i));
@@ -144,7 +232,7 @@ void BinaryMeshFileWriter::write_material_slots(const IMeshWalker& walker)
 void BinaryMeshFileWriter::write_faces(const IMeshWalker& walker)
 {
     const uint32 count = static_cast<uint32>(walker.get_face_count());
-    checked_write(m_writer, count);
+    checked_write(*m_writer, count);
 
     for (uint32 i = 0; i < count; ++i)
         write_face(walker, i);
@@ -153,16 +241,126 @@ void BinaryMeshFileWriter::write_faces(const IMeshWalker& walker)
 void BinaryMeshFileWriter::write_face(const IMeshWalker& walker, const size_t face_index)
 {
     const uint16 count = static_cast<uint16>(walker.get_face_vertex_count(face_index));
-    checked_write(m_writer, count);
+    checked_write(*m_writer, count);
 
     for (uint16 i = 0; i < count; ++i)
     {
-        checked_write(m_writer, static_cast<uint32>(walker.get_face_vertex(face_index, i)));
-        checked_write(m_writer, static_cast<uint32>(walker.get_face_vertex_normal(face_index, i)));
-        checked_write(m_writer, static_cast<uint32>(walker.get_face_tex_coords(face_index, i)));
+        checked_write(*m_writer, static_cast<uint32>(walker.get_face_vertex(face_index, i)));
+        checked_write(*m_writer, static_cast<uint32>(walker.get_face_vertex_normal(face_index, i)));
+        checked_write(*m_writer, static_cast<uint32>(walker.get_face_tex_coords(face_index, i)));
+    }
+
+    checked_write(*m_writer, static_cast<uint16>(walker.get_face_material(face_index)));
+}
+
+void BinaryMeshFileWriter::write_mesh_arrays(const IMeshWalker& walker)
+{
+    write_string(walker.get_name());
+    write_material_slots(walker);
+
+    const size_t vertex_count = walker.get_vertex_count();
+    vector<float> vertices(vertex_count * 3);
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        const Vector3d v = walker.get_vertex(i);
+        vertices[i * 3 + 0] = static_cast<float>(v[0]);
+        vertices[i * 3 + 1] = static_cast<float>(v[1]);
+        vertices[i * 3 + 2] = static_cast<float>(v[2]);
+    }
+
+    const size_t vertex_normal_count = walker.get_vertex_normal_count();
+    vector<float> vertex_normals(vertex_normal_count * 3);
+    for (size_t i = 0; i < vertex_normal_count; ++i)
+    {
+        const Vector3d n = walker.get_vertex_normal(i);
+        vertex_normals[i * 3 + 0] = static_cast<float>(n[0]);
+        vertex_normals[i * 3 + 1] = static_cast<float>(n[1]);
+        vertex_normals[i * 3 + 2] = static_cast<float>(n[2]);
+    }
+
+    const size_t tex_coords_count = walker.get_tex_coords_count();
+    vector<float> tex_coords(tex_coords_count * 2);
+    for (size_t i = 0; i < tex_coords_count; ++i)
+    {
+        const Vector2d uv = walker.get_tex_coords(i);
+        tex_coords[i * 2 + 0] = static_cast<float>(uv[0]);
+        tex_coords[i * 2 + 1] = static_cast<float>(uv[1]);
+    }
+
+    // Polygonal faces are triangulated so that the triangle array can be loaded as is.
+    Triangulator<double> triangulator(Triangulator<double>::KeepDegenerateTriangles);
+    vector<Vector3d> polygon;
+    vector<size_t> face_triangles;
+    vector<uint32> triangles;
+    triangles.reserve(walker.get_face_count() * 10);
+    for (size_t i = 0, e = walker.get_face_count(); i < e; ++i)
+        append_face_triangles(walker, i, triangulator, polygon, face_triangles, triangles);
+
+    write_padding(8);
+    checked_write(m_file, static_cast<uint64>(vertex_count));
+    checked_write(m_file, static_cast<uint64>(vertex_normal_count));
+    checked_write(m_file, static_cast<uint64>(tex_coords_count));
+    checked_write(m_file, static_cast<uint64>(triangles.size() / 10));
+    checked_write(m_file, static_cast<uint32>(m_options & CompressArrays ? 1 : 0));
+    checked_write(m_file, static_cast<uint32>(m_options & CompressArrays ? DefaultChunkSize : 0));
+
+    write_array(vertices.data(), vertices.size() * sizeof(float));
+    write_array(vertex_normals.data(), vertex_normals.size() * sizeof(float));
+    write_array(tex_coords.data(), tex_coords.size() * sizeof(float));
+    write_array(triangles.data(), triangles.size() * sizeof(uint32));
+}
+
+void BinaryMeshFileWriter::write_padding(const size_t alignment)
+{
+    static const uint8 Zeros[16] = { 0 };
+
+    const size_t remainder = static_cast<size_t>(m_file.tell()) % alignment;
+
+    if (remainder > 0)
+        checked_write(m_file, Zeros, alignment - remainder);
+}
+
+void BinaryMeshFileWriter::write_array(const void* data, const size_t size)
+{
+    write_padding(16);
+
+    if (size == 0)
+        return;
+
+    if (!(m_options & CompressArrays))
+    {
+        checked_write(m_file, data, size);
+        return;
+    }
+
+    // Compress all chunks first since the table of compressed chunk sizes comes first.
+    const size_t chunk_count = (size + DefaultChunkSize - 1) / DefaultChunkSize;
+    vector<uint64> chunk_sizes(chunk_count);
+    vector<vector<char>> chunks(chunk_count);
+
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        const size_t begin = i * DefaultChunkSize;
+        const int chunk_size = static_cast<int>(min(static_cast<size_t>(DefaultChunkSize), size - begin));
+
+        chunks[i].resize(static_cast<size_t>(LZ4_compressBound(chunk_size)));
+
+        const int compressed_size =
+            LZ4_compress(
+                static_cast<const char*>(data) + begin,
+                &chunks[i][0],
+                chunk_size);
+
+        if (compressed_size <= 0)
+            throw ExceptionIOError();
+
+        chunk_sizes[i] = static_cast<uint64>(compressed_size);
     }
 
-    checked_write(m_writer, static_cast<uint16>(walker.get_face_material(face_index)));
+    checked_write(m_file, &chunk_sizes[0], chunk_count * sizeof(uint64));
+
+    for (size_t i = 0; i < chunk_count; ++i)
+        checked_write(m_file, &chunks[i][0], static_cast<size_t>(chunk_sizes[i]));
 }
 
 }   // namespace foundation
@@ -33,10 +33,15 @@
 // appleseed.foundation headers.
 #include "foundation/mesh/imeshfilewriter.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/bufferedfile.h"
 
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
 // Standard headers.
 #include <cstddef>
+#include <memory>
 #include <string>
 
 // Forward declarations.
@@ -49,20 +54,38 @@ namespace foundation
 // Writer for a simple binary mesh file format.
 //
 
-class BinaryMeshFileWriter
+class APPLESEED_DLLSYMBOL BinaryMeshFileWriter
   : public IMeshFileWriter
 {
   public:
+    // Options.
+    enum Options
+    {
+        Default                 = 0,            // none of the flags below
+        CompressArrays          = 1 << 0        // format version 4: compress arrays by chunks with LZ4
+    };
+
+    // Format version written unless specified otherwise.
+    static const uint16 DefaultVersion = 3;
+
+    // Uncompressed size of array chunks in format version 4.
+    static const uint32 DefaultChunkSize = 1024 * 1024;
+
     // Constructor.
-    explicit BinaryMeshFileWriter(const std::string& filename);
+    explicit BinaryMeshFileWriter(
+        const std::string&  filename,
+        const uint16        version = DefaultVersion,
+        const int           options = Default);
 
     // Write a mesh.
     void write(const IMeshWalker& walker) override;
 
   private:
-    const std::string           m_filename;
-    BufferedFile                m_file;
-    LZ4CompressedWriterAdapter  m_writer;
+    const std::string               m_filename;
+    const uint16                    m_version;
+    const int                       m_options;
+    BufferedFile                    m_file;
+    std::unique_ptr<WriterAdapter>  m_writer;
 
     void write_signature();
     void write_version();
@@ -75,6 +98,10 @@ class BinaryMeshFileWriter
     void write_material_slots(const IMeshWalker& walker);
     void write_faces(const IMeshWalker& walker);
     void write_face(const IMeshWalker& walker, const size_t face_index);
+
+    void write_mesh_arrays(const IMeshWalker& walker);
+    void write_padding(const size_t alignment);
+    void write_array(const void* data, const size_t size);
 };
 
 }       // namespace foundation
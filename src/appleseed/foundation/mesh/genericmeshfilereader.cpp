@@ -43,6 +43,7 @@
 #include "boost/filesystem/path.hpp"
 
 // Standard headers.
+#include <cstddef>
 #include <string>
 
 using namespace std;
@@ -55,6 +56,8 @@ struct GenericMeshFileReader::Impl
 {
     string  m_filename;
     int     m_obj_options;
+    Logger* m_logger;
+    size_t  m_thread_count;
 };
 
 GenericMeshFileReader::GenericMeshFileReader(const char* filename)
@@ -62,6 +65,8 @@ GenericMeshFileReader::GenericMeshFileReader(const char* filename)
 {
     impl->m_filename = filename;
     impl->m_obj_options = OBJMeshFileReader::Default;
+    impl->m_logger = nullptr;
+    impl->m_thread_count = 1;
 }
 
 GenericMeshFileReader::~GenericMeshFileReader()
@@ -79,6 +84,12 @@ void GenericMeshFileReader::set_obj_options(const int obj_options)
     impl->m_obj_options = obj_options;
 }
 
+void GenericMeshFileReader::set_thread_count(Logger& logger, const size_t thread_count)
+{
+    impl->m_logger = &logger;
+    impl->m_thread_count = thread_count;
+}
+
 void GenericMeshFileReader::read(IMeshBuilder& builder)
 {
     const bf::path filepath(impl->m_filename);
@@ -86,8 +97,16 @@ void GenericMeshFileReader::read(IMeshBuilder& builder)
 
     if (extension == ".obj")
     {
-        OBJMeshFileReader reader(impl->m_filename, impl->m_obj_options);
-        reader.read(builder);
+        if (impl->m_logger != nullptr)
+        {
+            OBJMeshFileReader reader(impl->m_filename, impl->m_obj_options, *impl->m_logger, impl->m_thread_count);
+            reader.read(builder);
+        }
+        else
+        {
+            OBJMeshFileReader reader(impl->m_filename, impl->m_obj_options);
+            reader.read(builder);
+        }
     }
 #ifdef APPLESEED_WITH_ALEMBIC
     else if (extension == ".abc")
@@ -98,8 +117,16 @@ void GenericMeshFileReader::read(IMeshBuilder& builder)
 #endif
     else if (extension == ".binarymesh")
     {
-        BinaryMeshFileReader reader(impl->m_filename);
-        reader.read(builder);
+        if (impl->m_logger != nullptr)
+        {
+            BinaryMeshFileReader reader(impl->m_filename, *impl->m_logger, impl->m_thread_count);
+            reader.read(builder);
+        }
+        else
+        {
+            BinaryMeshFileReader reader(impl->m_filename);
+            reader.read(builder);
+        }
     }
     else
     {
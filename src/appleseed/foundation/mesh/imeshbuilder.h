@@ -33,6 +33,7 @@
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 
 // appleseed.main headers.
 #include "main/dllsymbol.h"
@@ -43,9 +44,30 @@
 namespace foundation
 {
 
+//
+// A triangle as passed in bulk to IMeshBuilder::push_triangle_array().
+//
+
+struct MeshTriangle
+{
+    // Index used for missing vertex normals, texture coordinates or material.
+    static const uint32 None = ~uint32(0);
+
+    uint32  m_v0, m_v1, m_v2;       // vertex indices
+    uint32  m_n0, m_n1, m_n2;       // vertex normal indices, all None or none None
+    uint32  m_t0, m_t1, m_t2;       // texture coordinates indices, all None or none None
+    uint32  m_material;             // material slot index
+};
+
+
 //
 // Mesh builder interface.
 //
+// The methods taking arrays allow readers that have whole arrays at hand to
+// pass them in a single call. Their default implementations forward each element
+// to the corresponding per-element method; builders that can store arrays
+// directly should override them.
+//
 
 class APPLESEED_DLLSYMBOL IMeshBuilder
   : public NonCopyable
@@ -92,8 +114,107 @@ class APPLESEED_DLLSYMBOL IMeshBuilder
 
     // End the definition of the mesh.
     virtual void end_mesh() = 0;
+
+    // Append multiple vertices to the mesh.
+    // Return the index of the first vertex within the mesh.
+    virtual size_t push_vertex_array(const Vector3f vertices[], const size_t count);
+
+    // Append multiple vertex normals to the mesh. Normals are NOT necessarily unit-length.
+    // Return the index of the first normal within the mesh.
+    virtual size_t push_vertex_normal_array(const Vector3f vertex_normals[], const size_t count);
+
+    // Append multiple texture coordinates to the mesh.
+    // Return the index of the first vector within the mesh.
+    virtual size_t push_tex_coords_array(const Vector2f tex_coords[], const size_t count);
+
+    // Append multiple triangular faces to the mesh. Material slots must have been pushed first.
+    virtual void push_triangle_array(const MeshTriangle triangles[], const size_t count);
 };
 
+
+//
+// IMeshBuilder class implementation.
+//
+
+inline size_t IMeshBuilder::push_vertex_array(const Vector3f vertices[], const size_t count)
+{
+    size_t first = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t index = push_vertex(Vector3d(vertices[i]));
+        if (i == 0)
+            first = index;
+    }
+
+    return first;
+}
+
+inline size_t IMeshBuilder::push_vertex_normal_array(const Vector3f vertex_normals[], const size_t count)
+{
+    size_t first = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t index = push_vertex_normal(Vector3d(vertex_normals[i]));
+        if (i == 0)
+            first = index;
+    }
+
+    return first;
+}
+
+inline size_t IMeshBuilder::push_tex_coords_array(const Vector2f tex_coords[], const size_t count)
+{
+    size_t first = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t index = push_tex_coords(Vector2d(tex_coords[i]));
+        if (i == 0)
+            first = index;
+    }
+
+    return first;
+}
+
+inline void IMeshBuilder::push_triangle_array(const MeshTriangle triangles[], const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const MeshTriangle& triangle = triangles[i];
+        size_t indices[3];
+
+        begin_face(3);
+
+        indices[0] = triangle.m_v0;
+        indices[1] = triangle.m_v1;
+        indices[2] = triangle.m_v2;
+        set_face_vertices(indices);
+
+        if (triangle.m_n0 != MeshTriangle::None)
+        {
+            indices[0] = triangle.m_n0;
+            indices[1] = triangle.m_n1;
+            indices[2] = triangle.m_n2;
+            set_face_vertex_normals(indices);
+        }
+
+        if (triangle.m_t0 != MeshTriangle::None)
+        {
+            indices[0] = triangle.m_t0;
+            indices[1] = triangle.m_t1;
+            indices[2] = triangle.m_t2;
+            set_face_vertex_tex_coords(indices);
+        }
+
+        if (triangle.m_material != MeshTriangle::None)
+            set_face_material(triangle.m_material);
+
+        end_face();
+    }
+}
+
 }       // namespace foundation
 
 #endif  // !APPLESEED_FOUNDATION_MESH_IMESHBUILDER_H
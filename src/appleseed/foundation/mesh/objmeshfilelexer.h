@@ -37,10 +37,12 @@
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -60,12 +62,17 @@ class OBJMeshFileLexer
         Fast, Precise
     };
 
+    // Lines longer than this are split into several lines.
+    static const size_t MaxLineLength = 4095;
+
     // Constructor.
     explicit OBJMeshFileLexer(const ParsingMode parsing_mode = Precise)
       : m_parsing_mode(parsing_mode)
+      , m_source(0)
+      , m_source_end(0)
       , m_eof(false)
       , m_line_number(0)
-      , m_line(4096)
+      , m_line(MaxLineLength + 1)
       , m_line_size(0)
       , m_line_index(0)
     {
@@ -96,16 +103,43 @@ class OBJMeshFileLexer
         return true;
     }
 
-    // Close the input file.
+    // Open a block of text in memory, starting at the beginning of a line.
+    // 'first_line_number' is the position of this line in the enclosing file.
+    void open(
+        const char*         begin,
+        const char*         end,
+        const size_t        first_line_number = 1)
+    {
+        assert(begin);
+
+        m_source = begin;
+        m_source_end = end;
+        m_eof = false;
+        m_line_number = first_line_number - 1;
+        m_line_size = 0;
+        m_line_index = 0;
+
+        read_next_line();
+    }
+
+    // Close the input file or block of text.
     void close()
     {
         m_file.close();
+        m_source = 0;
+        m_source_end = 0;
+    }
+
+    // Return true if an input file or block of text is open.
+    bool is_open() const
+    {
+        return m_source != 0 || m_file.is_open();
     }
 
     // Return the position of the current line in the file.
     size_t get_line_number() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_number;
     }
@@ -113,7 +147,7 @@ class OBJMeshFileLexer
     // Return the current character in the line.
     APPLESEED_FORCE_INLINE unsigned char get_char() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_index == m_line_size ? '\n' : m_line[m_line_index];
     }
@@ -121,7 +155,7 @@ class OBJMeshFileLexer
     // Advance to the next character in the line.
     APPLESEED_FORCE_INLINE void next_char()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (m_line_index < m_line_size)
             ++m_line_index;
@@ -141,7 +175,7 @@ class OBJMeshFileLexer
     // Return true if the end of the line has been reached.
     APPLESEED_FORCE_INLINE bool is_eol() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_index == m_line_size;
     }
@@ -149,7 +183,7 @@ class OBJMeshFileLexer
     // Return true if the end of the file has been reached.
     APPLESEED_FORCE_INLINE bool is_eof() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_eof && is_eol();
     }
@@ -157,7 +191,7 @@ class OBJMeshFileLexer
     // Eat blank characters and comments.
     void eat_blanks()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         while (true)
         {
@@ -192,7 +226,7 @@ class OBJMeshFileLexer
     // Accept a end-of-line character, or generate a parse error.
     void accept_newline()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (!is_eol())
             parse_error();
@@ -203,7 +237,7 @@ class OBJMeshFileLexer
     // Accept a string of non-blank characters, or generate a parse error.
     void accept_string(const char** begin, size_t* length)
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (is_eof())
             parse_error();
@@ -236,7 +270,7 @@ class OBJMeshFileLexer
     // Accept a long integer, or generate a parse error.
     APPLESEED_FORCE_INLINE long accept_long()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         // Read an integer value at the current position in the line.
         const char* base_ptr = &m_line[0];
@@ -255,7 +289,7 @@ class OBJMeshFileLexer
     // Accept a double-precision floating point number, or generate a parse error.
     APPLESEED_FORCE_INLINE double accept_double()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         // Read a floating-point value at the current position in the line.
         char* base_ptr = &m_line[0];
@@ -279,6 +313,8 @@ class OBJMeshFileLexer
     const ParsingMode   m_parsing_mode;     // parsing mode for floating-point values
     bool                m_is_space[256];    // precomputed values of std::isspace(c) for all c
     BufferedFile        m_file;
+    const char*         m_source;           // current position in the block of text, if reading from memory
+    const char*         m_source_end;       // end of the block of text
     bool                m_eof;              // has the end of the file been reached?
     size_t              m_line_number;      // position of the current line in the file
     std::vector<char>   m_line;             // current line
@@ -288,18 +324,35 @@ class OBJMeshFileLexer
     // Close the input file and throw an ExceptionParseError exception.
     void parse_error()
     {
-        m_file.close();
+        close();
         throw OBJMeshFileReader::ExceptionParseError(m_line_number);
     }
 
     // Read the next line from the input file.
     void read_next_line()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         m_line_size = 0;
 
-        if (!m_eof)
+        if (!m_eof && m_source)
+        {
+            ++m_line_number;
+
+            // Same as below, but copying whole runs of characters at once.
+            const size_t capacity = MaxLineLength;
+            const size_t remaining = static_cast<size_t>(m_source_end - m_source);
+            const size_t max_size = std::min(capacity, remaining);
+            const char* newline = static_cast<const char*>(std::memchr(m_source, '\n', max_size));
+
+            m_line_size = newline ? static_cast<size_t>(newline - m_source) : max_size;
+            std::memcpy(&m_line[0], m_source, m_line_size);
+            m_source += newline ? m_line_size + 1 : m_line_size;
+
+            if (!newline && remaining < capacity)
+                m_eof = true;
+        }
+        else if (!m_eof)
         {
             ++m_line_number;
 
@@ -35,14 +35,21 @@
 #include "foundation/math/vector.h"
 #include "foundation/mesh/imeshbuilder.h"
 #include "foundation/mesh/objmeshfilelexer.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/memorymappedfile.h"
+#include "foundation/utility/otherwise.h"
 
 // Standard headers.
+#include <algorithm>
+#include <cassert>
 #include <cstring>
+#include <exception>
 #include <map>
 #include <utility>
 #include <vector>
 
+
 using namespace std;
 
 namespace foundation
@@ -51,315 +58,900 @@ namespace foundation
 //
 // OBJMeshFileReader class implementation.
 //
+// In parallel parsing mode, the file is mapped into memory and split into chunks
+// made of whole lines. A first pass counts the lines and the vertex, texture
+// coordinate and normal statements of every chunk. A second pass parses all
+// chunks concurrently: features are stored directly at their final position,
+// relative indices are resolved, and all other statements are recorded. These
+// statements are finally replayed in file order to the mesh builder, so that
+// the outcome is exactly the same as when parsing the file sequentially.
+//
 
 namespace
 {
     const size_t Undefined = ~0;
-}
 
-struct OBJMeshFileReader::Impl
-{
-    const int               m_options;
-    IMeshBuilder&           m_builder;
-    OBJMeshFileLexer        m_lexer;
+    // Files smaller than this are always parsed sequentially.
+    const size_t ParallelParsingMinFileSize = 1024 * 1024;
 
-    // Current state.
-    bool                    m_inside_mesh_def;              // currently inside a mesh definition?
-    string                  m_current_mesh_name;            // name of the current mesh
-    map<string, size_t>     m_material_slots;               // material slots for the current mesh
-    size_t                  m_current_material_slot_index;  // index of the current material slot
+    // Minimum size of the chunks parsed in parallel.
+    const size_t MinChunkSize = 256 * 1024;
 
-    // Features defined in the file.
-    vector<Vector3d>        m_vertices;
-    vector<Vector2d>        m_tex_coords;
-    vector<Vector3d>        m_normals;
-
-    // Mappings between internal indices and mesh indices.
-    vector<size_t>          m_vertex_index_mapping;
-    vector<size_t>          m_tex_coord_index_mapping;
-    vector<size_t>          m_normal_index_mapping;
-
-    // Temporary vectors for collecting indices while parsing face statements.
-    vector<size_t>          m_face_vertex_indices;
-    vector<size_t>          m_face_tex_coord_indices;
-    vector<size_t>          m_face_normal_indices;
-
-    // Constructor.
-    Impl(
-        const int           options,
-        IMeshBuilder&       builder)
-      : m_options(options)
-      , m_builder(builder)
-      , m_lexer(
-            (options & FavorSpeedOverPrecision)
-                ? OBJMeshFileLexer::Fast
-                : OBJMeshFileLexer::Precise)
-      , m_inside_mesh_def(false)
-      , m_current_material_slot_index(0)
+    OBJMeshFileLexer::ParsingMode get_parsing_mode(const int options)
     {
+        return
+            (options & OBJMeshFileReader::FavorSpeedOverPrecision)
+                ? OBJMeshFileLexer::Fast
+                : OBJMeshFileLexer::Precise;
     }
 
-    // Close the input file and throw an ExceptionParseError exception.
-    void parse_error()
-    {
-        const size_t line_number = m_lexer.get_line_number();
-
-        m_lexer.close();
-
-        throw ExceptionParseError(line_number);
-    }
+    //
+    // Parse the statements of an OBJ file and forward them to a handler.
+    //
+    // The handler must provide the number of vertices, texture coordinates
+    // and normals defined so far, in order to resolve relative indices.
+    //
 
-    void parse_file()
+    template <typename Handler>
+    class StatementParser
     {
-        while (true)
+      public:
+        StatementParser(
+            const int               options,
+            OBJMeshFileLexer&       lexer,
+            Handler&                handler)
+          : m_options(options)
+          , m_lexer(lexer)
+          , m_handler(handler)
         {
-            m_lexer.eat_blanks();
-
-            // Handle end of file.
-            if (m_lexer.is_eof())
-                break;
+        }
 
-            // Handle empty lines.
-            if (m_lexer.is_eol())
+        void parse_file()
+        {
+            while (true)
             {
-                m_lexer.accept_newline();
-                continue;
-            }
-
-            const char* keyword;
-            size_t keyword_length;
+                m_lexer.eat_blanks();
 
-            m_lexer.accept_string(&keyword, &keyword_length);
+                // Handle end of file.
+                if (m_lexer.is_eof())
+                    break;
 
-            if (keyword_length == 1)
-            {
-                switch (keyword[0])
+                // Handle empty lines.
+                if (m_lexer.is_eol())
                 {
-                  case 'f':
-                    parse_f_statement();
-                    break;
+                    m_lexer.accept_newline();
+                    continue;
+                }
 
-                  case 'g':
-                  case 'o':
-                    parse_o_g_statement();
-                    break;
+                const char* keyword;
+                size_t keyword_length;
 
-                  case 'v':
-                    parse_v_statement();
-                    break;
+                m_lexer.accept_string(&keyword, &keyword_length);
 
-                  default:
+                if (keyword_length == 1)
+                {
+                    switch (keyword[0])
+                    {
+                      case 'f':
+                        parse_f_statement();
+                        break;
+
+                      case 'g':
+                      case 'o':
+                        parse_o_g_statement();
+                        break;
+
+                      case 'v':
+                        parse_v_statement();
+                        break;
+
+                      default:
+                        // Ignore unknown or unhandled statements.
+                        m_lexer.eat_line();
+                        continue;
+                    }
+                }
+                else if (keyword_length == 2)
+                {
+                    switch (keyword[0] * 256 + keyword[1])
+                    {
+                      case 'v' * 256 + 'n':
+                        parse_vn_statement();
+                        break;
+
+                      case 'v' * 256 + 't':
+                        parse_vt_statement();
+                        break;
+
+                      default:
+                        // Ignore unknown or unhandled statements.
+                        m_lexer.eat_line();
+                        continue;
+                    }
+                }
+                else if (strncmp(keyword, "usemtl", keyword_length) == 0)
+                {
+                    parse_usemtl_statement();
+                }
+                else
+                {
                     // Ignore unknown or unhandled statements.
                     m_lexer.eat_line();
                     continue;
                 }
+
+                m_lexer.eat_blanks();
+                m_lexer.accept_newline();
             }
-            else if (keyword_length == 2)
+        }
+
+      private:
+        const int                   m_options;
+        OBJMeshFileLexer&           m_lexer;
+        Handler&                    m_handler;
+
+        // Temporary vectors for collecting indices while parsing face statements.
+        vector<size_t>              m_face_vertex_indices;
+        vector<size_t>              m_face_tex_coord_indices;
+        vector<size_t>              m_face_normal_indices;
+
+        // Close the input file and throw an ExceptionParseError exception.
+        void parse_error()
+        {
+            const size_t line_number = m_lexer.get_line_number();
+
+            m_lexer.close();
+
+            throw OBJMeshFileReader::ExceptionParseError(line_number);
+        }
+
+        void parse_f_statement()
+        {
+            clear_keep_memory(m_face_vertex_indices);
+            clear_keep_memory(m_face_tex_coord_indices);
+            clear_keep_memory(m_face_normal_indices);
+
+            while (true)
             {
-                switch (keyword[0] * 256 + keyword[1])
-                {
-                  case 'v' * 256 + 'n':
-                    parse_vn_statement();
-                    break;
+                m_lexer.eat_blanks();
 
-                  case 'v' * 256 + 't':
-                    parse_vt_statement();
+                if (m_lexer.is_eol())
                     break;
 
-                  default:
-                    // Ignore unknown or unhandled statements.
-                    m_lexer.eat_line();
-                    continue;
+                //
+                // Recognized (epsilon)
+                // Accept n
+                //
+
+                {
+                    const long n = m_lexer.accept_long();
+                    const size_t v = fix_index(n, m_handler.get_vertex_count());
+                    m_face_vertex_indices.push_back(v);
+                }
+
+                //
+                // Recognized n
+                // Accept (epsilon), /
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else if (c == '/')
+                        m_lexer.next_char();
+                    else parse_error();
+                }
+
+                //
+                // Recognized n/
+                // Accept /, n
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (c == '/')
+                    {
+                        m_lexer.next_char();
+                        goto skip;
+                    }
+                    else
+                    {
+                        const long n = m_lexer.accept_long();
+                        const size_t vt = fix_index(n, m_handler.get_tex_coord_count());
+                        m_face_tex_coord_indices.push_back(vt);
+                    }
+                }
+
+                //
+                // Recognized n/n
+                // Accept (epsilon), /
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else if (c == '/')
+                        m_lexer.next_char();
+                    else parse_error();
+                }
+
+              skip:
+
+                //
+                // Recognized n//, n/n/
+                // Accept (epsilon), n
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else
+                    {
+                        const long n = m_lexer.accept_long();
+                        const size_t vn = fix_index(n, m_handler.get_normal_count());
+                        m_face_normal_indices.push_back(vn);
+                    }
                 }
             }
-            else if (strncmp(keyword, "usemtl", keyword_length) == 0)
+
+            // Check whether the face is well-formed.
+            const size_t vc = m_face_vertex_indices.size();
+            const size_t tc = m_face_tex_coord_indices.size();
+            const size_t nc = m_face_normal_indices.size();
+            const bool well_formed =
+                    vc >= 3
+                && (tc == 0 || tc == vc)
+                && (nc == 0 || nc == vc);
+
+            if (well_formed)
             {
-                parse_usemtl_statement();
+                // The face is well-formed, insert it into the mesh.
+                m_handler.on_face(
+                    m_face_vertex_indices,
+                    m_face_tex_coord_indices,
+                    m_face_normal_indices);
             }
             else
             {
-                // Ignore unknown or unhandled statements.
-                m_lexer.eat_line();
-                continue;
+                // The face is ill-formed, ignore it or abort parsing.
+                if (m_options & OBJMeshFileReader::StopOnInvalidFaceDef)
+                    throw OBJMeshFileReader::ExceptionInvalidFaceDef(m_lexer.get_line_number());
             }
+        }
+
+        // Convert 1-based indices (including negative indices) to 0-based indices.
+        size_t fix_index(const long index, const size_t count)
+        {
+            if (index > 0)
+            {
+                const size_t i = static_cast<size_t>(index);
+                if (i > count)
+                    parse_error();
+                return i - 1;
+            }
+            else if (index < 0)
+            {
+                const size_t i = static_cast<size_t>(-index);
+                if (i > count)
+                    parse_error();
+                return count - i;
+            }
+            else
+            {
+                parse_error();
+                return 0;       // keep the compiler happy
+            }
+        }
+
+        void parse_o_g_statement()
+        {
+            m_handler.on_mesh_name(parse_compound_identifier());
+        }
+
+        string parse_compound_identifier()
+        {
+            string identifier;
 
             m_lexer.eat_blanks();
-            m_lexer.accept_newline();
+
+            while (!m_lexer.is_eol())
+            {
+                const char* token;
+                size_t token_length;
+
+                m_lexer.accept_string(&token, &token_length);
+                m_lexer.eat_blanks();
+
+                if (!identifier.empty())
+                    identifier += ' ';
+
+                identifier.append(token, token_length);
+            }
+
+            return identifier;
         }
 
-        // End the definition of the last object.
-        if (m_inside_mesh_def)
-            m_builder.end_mesh();
-    }
+        void parse_v_statement()
+        {
+            Vector3d v;
 
-    void parse_f_statement()
-    {
-        clear_keep_memory(m_face_vertex_indices);
-        clear_keep_memory(m_face_tex_coord_indices);
-        clear_keep_memory(m_face_normal_indices);
+            m_lexer.eat_blanks();
+            v.x = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            v.y = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            v.z = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+
+            if (!m_lexer.is_eol())
+                m_lexer.accept_double();
 
-        while (true)
+            m_handler.on_vertex(v);
+        }
+
+        void parse_vt_statement()
         {
+            Vector2d v;
+
             m_lexer.eat_blanks();
+            v.x = m_lexer.accept_double();
 
-            if (m_lexer.is_eol())
-                break;
+            m_lexer.eat_blanks();
+            v.y = m_lexer.accept_double();
 
-            //
-            // Recognized (epsilon)
-            // Accept n
-            //
+            m_lexer.eat_blanks();
 
-            {
-                const long n = m_lexer.accept_long();
-                const size_t v = fix_index(n, m_vertices.size());
-                m_face_vertex_indices.push_back(v);
-            }
+            if (!m_lexer.is_eol())
+                m_lexer.accept_double();
 
-            //
-            // Recognized n
-            // Accept (epsilon), /
-            //
+            m_handler.on_tex_coords(v);
+        }
 
-            {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else if (c == '/')
-                    m_lexer.next_char();
-                else parse_error();
-            }
+        void parse_vn_statement()
+        {
+            Vector3d n;
 
-            //
-            // Recognized n/
-            // Accept /, n
-            //
+            m_lexer.eat_blanks();
+            n.x = m_lexer.accept_double();
 
-            {
-                const unsigned char c = m_lexer.get_char();
-                if (c == '/')
-                {
-                    m_lexer.next_char();
-                    goto skip;
-                }
-                else
-                {
-                    const long n = m_lexer.accept_long();
-                    const size_t vt = fix_index(n, m_tex_coords.size());
-                    m_face_tex_coord_indices.push_back(vt);
-                }
-            }
+            m_lexer.eat_blanks();
+            n.y = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            n.z = m_lexer.accept_double();
 
-            //
-            // Recognized n/n
-            // Accept (epsilon), /
-            //
+            m_handler.on_normal(n);
+        }
+
+        void parse_usemtl_statement()
+        {
+            m_handler.on_usemtl(parse_compound_identifier());
+        }
+    };
+
+    //
+    // Parallel parsing.
+    //
+
+    enum StatementType
+    {
+        FaceStatement,                  // followed by vertex, tex coord and normal counts, then by the indices
+        MeshNameStatement,              // followed by the index of the name
+        UseMtlStatement,                // followed by the index of the material slot name
+        ParseErrorStatement,            // followed by the line number
+        InvalidFaceDefStatement         // followed by the line number
+    };
+
+    struct Chunk
+    {
+        const char*     m_begin;
+        const char*     m_end;
+
+        // Computed by the first pass.
+        size_t          m_line_count;
+        size_t          m_vertex_count;
+        size_t          m_tex_coord_count;
+        size_t          m_normal_count;
+
+        // Computed between the two passes.
+        size_t          m_first_line;
+        size_t          m_vertex_offset;
+        size_t          m_tex_coord_offset;
+        size_t          m_normal_offset;
+
+        // Computed by the second pass.
+        vector<size_t>  m_statements;
+        vector<string>  m_names;
+        exception_ptr   m_exception;
+
+        Chunk(const char* begin, const char* end)
+          : m_begin(begin)
+          , m_end(end)
+          , m_line_count(0)
+          , m_vertex_count(0)
+          , m_tex_coord_count(0)
+          , m_normal_count(0)
+          , m_first_line(0)
+          , m_vertex_offset(0)
+          , m_tex_coord_offset(0)
+          , m_normal_offset(0)
+        {
+        }
+    };
+
+    // Split a block of text into chunks made of whole lines.
+    void split_into_chunks(
+        const char*                 begin,
+        const char*                 end,
+        const size_t                chunk_size,
+        vector<Chunk>&              chunks)
+    {
+        while (begin < end)
+        {
+            const char* chunk_end = end;
 
+            if (static_cast<size_t>(end - begin) > chunk_size)
             {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else if (c == '/')
-                    m_lexer.next_char();
-                else parse_error();
+                const char* newline =
+                    static_cast<const char*>(
+                        memchr(begin + chunk_size, '\n', end - begin - chunk_size));
+
+                if (newline)
+                    chunk_end = newline + 1;
             }
 
-          skip:
+            chunks.push_back(Chunk(begin, chunk_end));
+            begin = chunk_end;
+        }
+    }
+
+    // Identify a vertex, texture coordinate or normal statement, the same way the parser would.
+    void count_statement(
+        const OBJMeshFileLexer&     lexer,
+        const char*                 begin,
+        const char*                 end,
+        Chunk&                      chunk)
+    {
+        while (begin < end && lexer.is_space(*begin))
+            ++begin;
+
+        if (begin == end || *begin == '#')
+            return;
+
+        const char* keyword = begin;
+
+        while (begin < end && !lexer.is_space(*begin))
+            ++begin;
+
+        const size_t keyword_length = begin - keyword;
+
+        if (keyword[0] == 'v')
+        {
+            if (keyword_length == 1)
+                ++chunk.m_vertex_count;
+            else if (keyword_length == 2 && keyword[1] == 't')
+                ++chunk.m_tex_coord_count;
+            else if (keyword_length == 2 && keyword[1] == 'n')
+                ++chunk.m_normal_count;
+        }
+    }
+
+    // First pass: count the lines and the features defined in a chunk.
+    void scan_chunk(
+        const OBJMeshFileLexer&     lexer,
+        Chunk&                      chunk)
+    {
+        const size_t MaxLineLength = OBJMeshFileLexer::MaxLineLength;
+
+        const char* line = chunk.m_begin;
 
-            //
-            // Recognized n//, n/n/
-            // Accept (epsilon), n
-            //
+        while (line < chunk.m_end)
+        {
+            const char* newline =
+                static_cast<const char*>(memchr(line, '\n', chunk.m_end - line));
+            const char* line_end = newline ? newline : chunk.m_end;
 
+            // Split long lines exactly like the lexer does.
+            while (true)
             {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else
-                {
-                    const long n = m_lexer.accept_long();
-                    const size_t vn = fix_index(n, m_normals.size());
-                    m_face_normal_indices.push_back(vn);
-                }
+                const size_t size = min(static_cast<size_t>(line_end - line), MaxLineLength);
+
+                count_statement(lexer, line, line + size, chunk);
+                ++chunk.m_line_count;
+
+                line += size;
+
+                if (size < MaxLineLength)
+                    break;
             }
+
+            line = newline ? newline + 1 : chunk.m_end;
         }
+    }
 
-        // Check whether the face is well-formed.
-        const size_t vc = m_face_vertex_indices.size();
-        const size_t tc = m_face_tex_coord_indices.size();
-        const size_t nc = m_face_normal_indices.size();
-        const bool well_formed =
-                vc >= 3
-            && (tc == 0 || tc == vc)
-            && (nc == 0 || nc == vc);
+    // Second pass: store features at their final position and record other statements.
+    class ChunkHandler
+    {
+      public:
+        ChunkHandler(
+            Chunk&                  chunk,
+            vector<Vector3d>&       vertices,
+            vector<Vector2d>&       tex_coords,
+            vector<Vector3d>&       normals)
+          : m_chunk(chunk)
+          , m_vertices(vertices)
+          , m_tex_coords(tex_coords)
+          , m_normals(normals)
+          , m_vertex_count(0)
+          , m_tex_coord_count(0)
+          , m_normal_count(0)
+        {
+        }
 
-        if (well_formed)
+        size_t get_vertex_count() const
         {
-            // The face is well-formed, insert it into the mesh.
-            insert_face_into_mesh();
+            return m_chunk.m_vertex_offset + m_vertex_count;
         }
-        else
+
+        size_t get_tex_coord_count() const
         {
-            // The face is ill-formed, ignore it or abort parsing.
-            if (m_options & StopOnInvalidFaceDef)
-                throw ExceptionInvalidFaceDef(m_lexer.get_line_number());
+            return m_chunk.m_tex_coord_offset + m_tex_coord_count;
+        }
+
+        size_t get_normal_count() const
+        {
+            return m_chunk.m_normal_offset + m_normal_count;
+        }
+
+        void on_vertex(const Vector3d& v)
+        {
+            assert(m_vertex_count < m_chunk.m_vertex_count);
+            m_vertices[m_chunk.m_vertex_offset + m_vertex_count++] = v;
+        }
+
+        void on_tex_coords(const Vector2d& v)
+        {
+            assert(m_tex_coord_count < m_chunk.m_tex_coord_count);
+            m_tex_coords[m_chunk.m_tex_coord_offset + m_tex_coord_count++] = v;
+        }
+
+        void on_normal(const Vector3d& n)
+        {
+            assert(m_normal_count < m_chunk.m_normal_count);
+            m_normals[m_chunk.m_normal_offset + m_normal_count++] = n;
         }
-    }
 
-    // Convert 1-based indices (including negative indices) to 0-based indices.
-    size_t fix_index(const long index, const size_t count)
+        void on_face(
+            vector<size_t>&         vertex_indices,
+            vector<size_t>&         tex_coord_indices,
+            vector<size_t>&         normal_indices)
+        {
+            vector<size_t>& statements = m_chunk.m_statements;
+            statements.push_back(FaceStatement);
+            statements.push_back(vertex_indices.size());
+            statements.push_back(tex_coord_indices.size());
+            statements.push_back(normal_indices.size());
+            statements.insert(statements.end(), vertex_indices.begin(), vertex_indices.end());
+            statements.insert(statements.end(), tex_coord_indices.begin(), tex_coord_indices.end());
+            statements.insert(statements.end(), normal_indices.begin(), normal_indices.end());
+        }
+
+        void on_mesh_name(const string& name)
+        {
+            push_name(MeshNameStatement, name);
+        }
+
+        void on_usemtl(const string& name)
+        {
+            push_name(UseMtlStatement, name);
+        }
+
+      private:
+        Chunk&                      m_chunk;
+        vector<Vector3d>&           m_vertices;
+        vector<Vector2d>&           m_tex_coords;
+        vector<Vector3d>&           m_normals;
+        size_t                      m_vertex_count;
+        size_t                      m_tex_coord_count;
+        size_t                      m_normal_count;
+
+        void push_name(const StatementType type, const string& name)
+        {
+            m_chunk.m_statements.push_back(type);
+            m_chunk.m_statements.push_back(m_chunk.m_names.size());
+            m_chunk.m_names.push_back(name);
+        }
+    };
+
+    template <typename Function>
+    class ChunkJob
+      : public IJob
     {
-        if (index > 0)
+      public:
+        ChunkJob(
+            Chunk&                  chunk,
+            const Function&         function)
+          : m_chunk(chunk)
+          , m_function(function)
         {
-            const size_t i = static_cast<size_t>(index);
-            if (i > count)
-                parse_error();
-            return i - 1;
         }
-        else if (index < 0)
+
+        void execute(const size_t thread_index) override
         {
-            const size_t i = static_cast<size_t>(-index);
-            if (i > count)
-                parse_error();
-            return count - i;
+            m_function(m_chunk);
         }
-        else
+
+      private:
+        Chunk&                      m_chunk;
+        const Function&             m_function;
+    };
+
+    // Run a function on every chunk using up to a given number of threads.
+    template <typename Function>
+    void for_each_chunk(
+        vector<Chunk>&              chunks,
+        const Function&             function,
+        Logger&                     logger,
+        const size_t                thread_count)
+    {
+        JobQueue job_queue;
+
+        for (size_t i = 0, e = chunks.size(); i < e; ++i)
+            job_queue.schedule(new ChunkJob<Function>(chunks[i], function));
+
+        JobManager job_manager(logger, job_queue, min(chunks.size(), thread_count));
+        job_manager.start();
+        job_queue.wait_until_completion();
+    }
+}
+
+struct OBJMeshFileReader::Impl
+{
+    IMeshBuilder&           m_builder;
+
+    // Current state.
+    bool                    m_inside_mesh_def;              // currently inside a mesh definition?
+    string                  m_current_mesh_name;            // name of the current mesh
+    map<string, size_t>     m_material_slots;               // material slots for the current mesh
+    size_t                  m_current_material_slot_index;  // index of the current material slot
+
+    // Features defined in the file.
+    vector<Vector3d>        m_vertices;
+    vector<Vector2d>        m_tex_coords;
+    vector<Vector3d>        m_normals;
+
+    // Mappings between internal indices and mesh indices.
+    vector<size_t>          m_vertex_index_mapping;
+    vector<size_t>          m_tex_coord_index_mapping;
+    vector<size_t>          m_normal_index_mapping;
+
+    // Constructor.
+    explicit Impl(IMeshBuilder& builder)
+      : m_builder(builder)
+      , m_inside_mesh_def(false)
+      , m_current_material_slot_index(0)
+    {
+    }
+
+    void parse_file(
+        const string&       filename,
+        const int           options)
+    {
+        OBJMeshFileLexer lexer(get_parsing_mode(options));
+
+        // Open the input file.
+        if (!lexer.open(filename))
+            throw ExceptionIOError();
+
+        // Parse the file.
+        StatementParser<Impl> parser(options, lexer, *this);
+        parser.parse_file();
+        end_file();
+
+        // Close the input file.
+        lexer.close();
+    }
+
+    void parse_file_parallel(
+        const char*         begin,
+        const char*         end,
+        const int           options,
+        Logger&             logger,
+        const size_t        thread_count)
+    {
+        const size_t size = end - begin;
+        const size_t chunk_size = max(size / (thread_count * 4), MinChunkSize);
+
+        vector<Chunk> chunks;
+        split_into_chunks(begin, end, chunk_size, chunks);
+
+        // Count the lines and the features of every chunk.
+        const OBJMeshFileLexer blanks;
+        for_each_chunk(
+            chunks,
+            [&blanks](Chunk& chunk) { scan_chunk(blanks, chunk); },
+            logger,
+            thread_count);
+
+        // Compute the position of every chunk in the file.
+        size_t line_count = 1;
+        size_t vertex_count = 0;
+        size_t tex_coord_count = 0;
+        size_t normal_count = 0;
+        for (size_t i = 0, e = chunks.size(); i < e; ++i)
+        {
+            Chunk& chunk = chunks[i];
+            chunk.m_first_line = line_count;
+            chunk.m_vertex_offset = vertex_count;
+            chunk.m_tex_coord_offset = tex_coord_count;
+            chunk.m_normal_offset = normal_count;
+            line_count += chunk.m_line_count;
+            vertex_count += chunk.m_vertex_count;
+            tex_coord_count += chunk.m_tex_coord_count;
+            normal_count += chunk.m_normal_count;
+        }
+
+        m_vertices.resize(vertex_count);
+        m_tex_coords.resize(tex_coord_count);
+        m_normals.resize(normal_count);
+
+        // Parse all chunks.
+        for_each_chunk(
+            chunks,
+            [this, options](Chunk& chunk)
+            {
+                try
+                {
+                    OBJMeshFileLexer lexer(get_parsing_mode(options));
+                    lexer.open(chunk.m_begin, chunk.m_end, chunk.m_first_line);
+
+                    ChunkHandler handler(chunk, m_vertices, m_tex_coords, m_normals);
+                    StatementParser<ChunkHandler> parser(options, lexer, handler);
+                    parser.parse_file();
+
+                    lexer.close();
+                }
+                catch (const ExceptionInvalidFaceDef& e)
+                {
+                    chunk.m_statements.push_back(InvalidFaceDefStatement);
+                    chunk.m_statements.push_back(e.m_line);
+                }
+                catch (const ExceptionParseError& e)
+                {
+                    chunk.m_statements.push_back(ParseErrorStatement);
+                    chunk.m_statements.push_back(e.m_line);
+                }
+                catch (...)
+                {
+                    chunk.m_exception = current_exception();
+                }
+            },
+            logger,
+            thread_count);
+
+        // Replay the statements in file order.
+        vector<size_t> vertex_indices;
+        vector<size_t> tex_coord_indices;
+        vector<size_t> normal_indices;
+        for (size_t i = 0, e = chunks.size(); i < e; ++i)
         {
-            parse_error();
-            return 0;       // keep the compiler happy
+            const Chunk& chunk = chunks[i];
+            const vector<size_t>& statements = chunk.m_statements;
+            vector<size_t>::const_iterator it = statements.begin();
+
+            while (it != statements.end())
+            {
+                switch (*it++)
+                {
+                  case FaceStatement:
+                    {
+                        const size_t vc = *it++;
+                        const size_t tc = *it++;
+                        const size_t nc = *it++;
+                        vertex_indices.assign(it, it + vc);
+                        it += vc;
+                        tex_coord_indices.assign(it, it + tc);
+                        it += tc;
+                        normal_indices.assign(it, it + nc);
+                        it += nc;
+                        on_face(vertex_indices, tex_coord_indices, normal_indices);
+                    }
+                    break;
+
+                  case MeshNameStatement:
+                    on_mesh_name(chunk.m_names[*it++]);
+                    break;
+
+                  case UseMtlStatement:
+                    on_usemtl(chunk.m_names[*it++]);
+                    break;
+
+                  case ParseErrorStatement:
+                    throw ExceptionParseError(*it);
+
+                  case InvalidFaceDefStatement:
+                    throw ExceptionInvalidFaceDef(*it);
+
+                  assert_otherwise;
+                }
+            }
+
+            if (chunk.m_exception)
+                rethrow_exception(chunk.m_exception);
         }
+
+        end_file();
+    }
+
+    size_t get_vertex_count() const
+    {
+        return m_vertices.size();
+    }
+
+    size_t get_tex_coord_count() const
+    {
+        return m_tex_coords.size();
+    }
+
+    size_t get_normal_count() const
+    {
+        return m_normals.size();
+    }
+
+    void on_vertex(const Vector3d& v)
+    {
+        m_vertices.push_back(v);
+    }
+
+    void on_tex_coords(const Vector2d& v)
+    {
+        m_tex_coords.push_back(v);
+    }
+
+    void on_normal(const Vector3d& n)
+    {
+        m_normals.push_back(n);
     }
 
-    void insert_face_into_mesh()
+    void on_face(
+        vector<size_t>&     vertex_indices,
+        vector<size_t>&     tex_coord_indices,
+        vector<size_t>&     normal_indices)
     {
         // Begin a mesh definition if we're not already inside one.
         ensure_mesh_def();
 
         // Insert the features into the mesh, updating index mappings as necessary.
-        insert_vertices_into_mesh();
-        insert_vertex_normals_into_mesh();
-        insert_tex_coords_into_mesh();
+        insert_vertices_into_mesh(vertex_indices);
+        insert_vertex_normals_into_mesh(normal_indices);
+        insert_tex_coords_into_mesh(tex_coord_indices);
 
         // Translate feature indices from internal space to mesh space.
-        translate_indices(m_face_vertex_indices, m_vertex_index_mapping);
-        translate_indices(m_face_normal_indices, m_normal_index_mapping);
-        translate_indices(m_face_tex_coord_indices, m_tex_coord_index_mapping);
+        translate_indices(vertex_indices, m_vertex_index_mapping);
+        translate_indices(normal_indices, m_normal_index_mapping);
+        translate_indices(tex_coord_indices, m_tex_coord_index_mapping);
 
-        const size_t n = m_face_vertex_indices.size();
+        const size_t n = vertex_indices.size();
 
         // Begin defining a new face.
         m_builder.begin_face(n);
 
         // Set face vertices.
-        m_builder.set_face_vertices(&m_face_vertex_indices.front());
+        m_builder.set_face_vertices(&vertex_indices.front());
 
         // Set face vertex normals (if any).
-        if (m_face_normal_indices.size() == n)
-            m_builder.set_face_vertex_normals(&m_face_normal_indices.front());
+        if (normal_indices.size() == n)
+            m_builder.set_face_vertex_normals(&normal_indices.front());
 
         // Set face vertex texture coordinates (if any).
-        if (m_face_tex_coord_indices.size() == n)
-            m_builder.set_face_vertex_tex_coords(&m_face_tex_coord_indices.front());
+        if (tex_coord_indices.size() == n)
+            m_builder.set_face_vertex_tex_coords(&tex_coord_indices.front());
 
         // Set face material.
         m_builder.set_face_material(m_current_material_slot_index);
@@ -368,39 +960,39 @@ struct OBJMeshFileReader::Impl
         m_builder.end_face();
     }
 
-    void insert_vertices_into_mesh()
+    void insert_vertices_into_mesh(const vector<size_t>& vertex_indices)
     {
-        const size_t face_vertex_index_count = m_face_vertex_indices.size();
+        const size_t face_vertex_index_count = vertex_indices.size();
 
         for (size_t i = 0; i < face_vertex_index_count; ++i)
         {
-            const size_t vertex_index = m_face_vertex_indices[i];
+            const size_t vertex_index = vertex_indices[i];
             ensure_minimum_size(m_vertex_index_mapping, vertex_index + 1, Undefined);
             if (m_vertex_index_mapping[vertex_index] == Undefined)
                 m_vertex_index_mapping[vertex_index] = m_builder.push_vertex(m_vertices[vertex_index]);
         }
     }
 
-    void insert_vertex_normals_into_mesh()
+    void insert_vertex_normals_into_mesh(const vector<size_t>& normal_indices)
     {
-        const size_t face_normal_index_count = m_face_normal_indices.size();
+        const size_t face_normal_index_count = normal_indices.size();
 
         for (size_t i = 0; i < face_normal_index_count; ++i)
         {
-            const size_t normal_index = m_face_normal_indices[i];
+            const size_t normal_index = normal_indices[i];
             ensure_minimum_size(m_normal_index_mapping, normal_index + 1, Undefined);
             if (m_normal_index_mapping[normal_index] == Undefined)
                 m_normal_index_mapping[normal_index] = m_builder.push_vertex_normal(m_normals[normal_index]);
         }
     }
 
-    void insert_tex_coords_into_mesh()
+    void insert_tex_coords_into_mesh(const vector<size_t>& tex_coord_indices)
     {
-        const size_t face_tex_coord_index_count = m_face_tex_coord_indices.size();
+        const size_t face_tex_coord_index_count = tex_coord_indices.size();
 
         for (size_t i = 0; i < face_tex_coord_index_count; ++i)
         {
-            const size_t tex_coord_index = m_face_tex_coord_indices[i];
+            const size_t tex_coord_index = tex_coord_indices[i];
             ensure_minimum_size(m_tex_coord_index_mapping, tex_coord_index + 1, Undefined);
             if (m_tex_coord_index_mapping[tex_coord_index] == Undefined)
                 m_tex_coord_index_mapping[tex_coord_index] = m_builder.push_tex_coords(m_tex_coords[tex_coord_index]);
@@ -417,11 +1009,8 @@ struct OBJMeshFileReader::Impl
             indices[i] = mapping[indices[i]];
     }
 
-    void parse_o_g_statement()
+    void on_mesh_name(const string& upcoming_mesh_name)
     {
-        // Retrieve the name of the upcoming mesh.
-        const string upcoming_mesh_name = parse_compound_identifier();
-
         // Start a new mesh only if the name of the object or group actually changes.
         if (upcoming_mesh_name != m_current_mesh_name)
         {
@@ -440,92 +1029,11 @@ struct OBJMeshFileReader::Impl
         }
     }
 
-    string parse_compound_identifier()
-    {
-        string identifier;
-
-        m_lexer.eat_blanks();
-
-        while (!m_lexer.is_eol())
-        {
-            const char* token;
-            size_t token_length;
-
-            m_lexer.accept_string(&token, &token_length);
-            m_lexer.eat_blanks();
-
-            if (!identifier.empty())
-                identifier += ' ';
-
-            identifier.append(token, token_length);
-        }
-
-        return identifier;
-    }
-
-    void parse_v_statement()
-    {
-        Vector3d v;
-
-        m_lexer.eat_blanks();
-        v.x = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        v.y = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        v.z = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-
-        if (!m_lexer.is_eol())
-            m_lexer.accept_double();
-
-        m_vertices.push_back(v);
-    }
-
-    void parse_vt_statement()
-    {
-        Vector2d v;
-
-        m_lexer.eat_blanks();
-        v.x = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        v.y = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-
-        if (!m_lexer.is_eol())
-            m_lexer.accept_double();
-
-        m_tex_coords.push_back(v);
-    }
-
-    void parse_vn_statement()
-    {
-        Vector3d n;
-
-        m_lexer.eat_blanks();
-        n.x = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        n.y = m_lexer.accept_double();
-
-        m_lexer.eat_blanks();
-        n.z = m_lexer.accept_double();
-
-        m_normals.push_back(n);
-    }
-
-    void parse_usemtl_statement()
+    void on_usemtl(const string& material_slot_name)
     {
         // Begin a mesh definition if we're not already inside one.
         ensure_mesh_def();
 
-        // Retrieve the name of the material slot.
-        const string material_slot_name = parse_compound_identifier();
-
         // Check whether this material slot has already been defined for this mesh.
         const map<string, size_t>::const_iterator& it =
             m_material_slots.find(material_slot_name);
@@ -556,6 +1064,13 @@ struct OBJMeshFileReader::Impl
             m_current_material_slot_index = 0;
         }
     }
+
+    void end_file()
+    {
+        // End the definition of the last object.
+        if (m_inside_mesh_def)
+            m_builder.end_mesh();
+    }
 };
 
 OBJMeshFileReader::OBJMeshFileReader(
@@ -563,22 +1078,43 @@ OBJMeshFileReader::OBJMeshFileReader(
     const int       options)
   : m_filename(filename)
   , m_options(options)
+  , m_logger(nullptr)
+  , m_thread_count(1)
+{
+}
+
+OBJMeshFileReader::OBJMeshFileReader(
+    const string&   filename,
+    const int       options,
+    Logger&         logger,
+    const size_t    thread_count)
+  : m_filename(filename)
+  , m_options(options)
+  , m_logger(&logger)
+  , m_thread_count(thread_count)
 {
 }
 
 void OBJMeshFileReader::read(IMeshBuilder& builder)
 {
-    Impl impl(m_options, builder);
+    Impl impl(builder);
+
+    if ((m_options & ParallelParsing) && m_logger != nullptr && m_thread_count > 1)
+    {
+        MemoryMappedFile file;
 
-    // Open the input file.
-    if (!impl.m_lexer.open(m_filename))
-        throw ExceptionIOError();
+        if (!file.open(m_filename.c_str()))
+            throw ExceptionIOError();
 
-    // Parse the file.
-    impl.parse_file();
+        if (file.size() >= ParallelParsingMinFileSize)
+        {
+            const char* data = reinterpret_cast<const char*>(file.data());
+            impl.parse_file_parallel(data, data + file.size(), m_options, *m_logger, m_thread_count);
+            return;
+        }
+    }
 
-    // Close the input file.
-    impl.m_lexer.close();
+    impl.parse_file(m_filename, m_options);
 }
 
 }   // namespace foundation
@@ -41,6 +41,7 @@
 
 // Forward declarations.
 namespace foundation    { class IMeshBuilder; }
+namespace foundation    { class Logger; }
 
 namespace foundation
 {
@@ -83,7 +84,8 @@ class OBJMeshFileReader
     {
         Default                 = 0,            // none of the flags below
         FavorSpeedOverPrecision = 1 << 0,       // use approximate algorithm for parsing floating-point values
-        StopOnInvalidFaceDef    = 1 << 1        // stop parsing on invalid face definitions
+        StopOnInvalidFaceDef    = 1 << 1,       // stop parsing on invalid face definitions
+        ParallelParsing         = 1 << 2        // parse large files using multiple threads
     };
 
     // Constructor.
@@ -91,6 +93,13 @@ class OBJMeshFileReader
         const std::string&  filename,
         const int           options = Default);
 
+    // Constructor. In parallel parsing mode, up to `thread_count` threads are used.
+    OBJMeshFileReader(
+        const std::string&  filename,
+        const int           options,
+        Logger&             logger,
+        const size_t        thread_count);
+
     // Read a mesh.
     void read(IMeshBuilder& builder) override;
 
@@ -99,6 +108,8 @@ class OBJMeshFileReader
 
     const std::string       m_filename;
     const int               m_options;
+    Logger*                 m_logger;
+    const size_t            m_thread_count;
 };
 
 }       // namespace foundation
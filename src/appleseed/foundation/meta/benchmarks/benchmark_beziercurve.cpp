@@ -0,0 +1,319 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/beziercurve.h"
+#include "foundation/math/bvh.h"
+#include "foundation/math/intersection/rayobbpacket.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/timers.h"
+#include "foundation/utility/alignedallocator.h"
+#include "foundation/utility/alignedvector.h"
+#include "foundation/utility/benchmark.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+BENCHMARK_SUITE(Foundation_Math_BezierCurveIntersector)
+{
+    typedef BezierCurve3f CurveType;
+    typedef BezierCurveIntersector<CurveType> CurveIntersectorType;
+    typedef bvh::Node<AABB3f> NodeType;
+    typedef AlignedVector<NodeType> NodeVector;
+    typedef bvh::SAHPartitioner<vector<AABB3f>> Partitioner;
+
+    class TreeType
+      : public bvh::Tree<NodeVector>
+    {
+      public:
+        TreeType()
+          : bvh::Tree<NodeVector>(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
+        {
+        }
+
+        NodeVector& get_nodes()
+        {
+            return m_nodes;
+        }
+    };
+
+#ifdef APPLESEED_USE_AVX
+    static const size_t PacketWidth = 8;
+#else
+    static const size_t PacketWidth = 4;
+#endif
+
+    typedef OBBPacket<float, PacketWidth> PacketType;
+    typedef RayOBBPacketTester<float, PacketWidth> PacketTesterType;
+
+    // A ball of hair: curly strands growing out of the unit sphere.
+    vector<CurveType> generate_hair_ball()
+    {
+        const size_t StrandCount = 20000;
+        const size_t SegmentsPerStrand = 4;
+        const float SegmentLength = 0.08f;
+        const float Width = 0.004f;
+
+        vector<CurveType> curves;
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < StrandCount; ++i)
+        {
+            Vector3f p = sample_sphere_uniform(rand_vector2<Vector2f>(rng));
+            Vector3f dir = p;
+
+            for (size_t j = 0; j < SegmentsPerStrand; ++j)
+            {
+                Vector3f ctrl_pts[4];
+                ctrl_pts[0] = p;
+
+                for (size_t k = 1; k < 4; ++k)
+                {
+                    const Vector3f jitter = sample_sphere_uniform(rand_vector2<Vector2f>(rng));
+                    dir = normalize(dir + 0.6f * jitter);
+                    p += (SegmentLength / 3.0f) * dir;
+                    ctrl_pts[k] = p;
+                }
+
+                curves.emplace_back(ctrl_pts, Width);
+            }
+        }
+
+        return curves;
+    }
+
+    struct Fixture
+    {
+        static const size_t RayCount = 1000;
+
+        vector<CurveType>           m_curves;
+        vector<AABB3f>              m_bboxes;
+        vector<Ray3f>               m_rays;
+        vector<RayInfo3f>           m_ray_infos;
+
+        // Leaves holding a single curve, intersected without further culling.
+        Partitioner                 m_single_partitioner;
+        TreeType                    m_single_tree;
+
+        // Leaves holding a packet of curves whose oriented bounding boxes are tested at once.
+        Partitioner                 m_packet_partitioner;
+        TreeType                    m_packet_tree;
+        AlignedVector<PacketType>   m_packets;
+
+        float                       m_distance;
+
+        Fixture()
+          : m_curves(generate_hair_ball())
+          , m_bboxes(compute_bboxes(m_curves))
+          , m_single_partitioner(m_bboxes, 1)
+          , m_packet_partitioner(m_bboxes, PacketWidth)
+          , m_packets(AlignedAllocator<PacketType>(64))
+          , m_distance(0.0f)
+        {
+            bvh::Builder<TreeType, Partitioner> builder;
+            builder.template build<DefaultWallclockTimer>(m_single_tree, m_single_partitioner, m_curves.size(), 1);
+            builder.template build<DefaultWallclockTimer>(m_packet_tree, m_packet_partitioner, m_curves.size(), PacketWidth);
+
+            // Compute the oriented bounding boxes of the curves of each leaf.
+            const vector<size_t>& ordering = m_packet_partitioner.get_item_ordering();
+            NodeVector& nodes = m_packet_tree.get_nodes();
+            for (size_t i = 0; i < nodes.size(); ++i)
+            {
+                NodeType& node = nodes[i];
+                if (!node.is_leaf())
+                    continue;
+
+                node.set_user_data(static_cast<uint32>(m_packets.size()));
+
+                for (size_t j = 0; j < node.get_item_count(); ++j)
+                {
+                    if (j % PacketWidth == 0)
+                    {
+                        m_packets.emplace_back();
+                        m_packets.back().clear();
+                    }
+
+                    const CurveType& curve = m_curves[ordering[node.get_item_index() + j]];
+
+                    Vector3f axes[3];
+                    AABB3f extent = curve.compute_oriented_bbox(axes);
+                    extent.grow(Vector3f(0.5f * curve.compute_max_width()));
+                    extent.robust_grow(1.0e-6f);
+
+                    m_packets.back().add_box(axes, extent);
+                }
+            }
+
+            // Shoot rays from a sphere surrounding the hair ball toward its center.
+            MersenneTwister rng;
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                const Vector3f org = 3.0f * sample_sphere_uniform(rand_vector2<Vector2f>(rng));
+                const Vector3f target = 1.2f * rand_vector1<Vector3f>(rng) - Vector3f(0.6f);
+                m_rays.emplace_back(org, normalize(target - org));
+                m_ray_infos.emplace_back(m_rays.back());
+            }
+        }
+
+        static vector<AABB3f> compute_bboxes(const vector<CurveType>& curves)
+        {
+            vector<AABB3f> bboxes;
+
+            for (const CurveType& curve : curves)
+            {
+                AABB3f bbox = curve.compute_bbox();
+                bbox.grow(Vector3f(0.5f * curve.compute_max_width()));
+                bboxes.push_back(bbox);
+            }
+
+            return bboxes;
+        }
+
+        struct SingleCurveVisitor
+        {
+            const Fixture&  m_fixture;
+            Matrix4f        m_xfm;
+            float           m_hit_distance;
+
+            SingleCurveVisitor(const Fixture& fixture, const Ray3f& ray)
+              : m_fixture(fixture)
+              , m_hit_distance(ray.m_tmax)
+            {
+                make_curve_projection_transform(m_xfm, ray);
+            }
+
+            bool visit(
+                const NodeType&             node,
+                const Ray3f&                ray,
+                const RayInfo3f&            ray_info,
+                float&                      distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , bvh::TraversalStatistics& stats
+#endif
+                )
+            {
+                const vector<size_t>& ordering = m_fixture.m_single_partitioner.get_item_ordering();
+
+                for (size_t i = 0; i < node.get_item_count(); ++i)
+                {
+                    const CurveType& curve = m_fixture.m_curves[ordering[node.get_item_index() + i]];
+
+                    float u, v;
+                    CurveIntersectorType::intersect(curve, ray, m_xfm, u, v, m_hit_distance);
+                }
+
+                distance = m_hit_distance;
+                return true;
+            }
+        };
+
+        struct CurvePacketVisitor
+        {
+            const Fixture&          m_fixture;
+            const PacketTesterType  m_tester;
+            Matrix4f                m_xfm;
+            float                   m_hit_distance;
+
+            CurvePacketVisitor(const Fixture& fixture, const Ray3f& ray)
+              : m_fixture(fixture)
+              , m_tester(ray)
+              , m_hit_distance(ray.m_tmax)
+            {
+                make_curve_projection_transform(m_xfm, ray);
+            }
+
+            bool visit(
+                const NodeType&             node,
+                const Ray3f&                ray,
+                const RayInfo3f&            ray_info,
+                float&                      distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , bvh::TraversalStatistics& stats
+#endif
+                )
+            {
+                const vector<size_t>& ordering = m_fixture.m_packet_partitioner.get_item_ordering();
+                const size_t packet_offset = node.get_user_data<uint32>();
+
+                for (size_t packet_begin = 0; packet_begin < node.get_item_count(); packet_begin += PacketWidth)
+                {
+                    const PacketType& packet = m_fixture.m_packets[packet_offset + packet_begin / PacketWidth];
+
+                    size_t hits = m_tester.test(packet, m_hit_distance);
+
+                    for (size_t i = packet_begin; hits != 0; ++i, hits >>= 1)
+                    {
+                        if ((hits & 1) == 0)
+                            continue;
+
+                        const CurveType& curve = m_fixture.m_curves[ordering[node.get_item_index() + i]];
+
+                        float u, v;
+                        CurveIntersectorType::intersect(curve, ray, m_xfm, u, v, m_hit_distance);
+                    }
+                }
+
+                distance = m_hit_distance;
+                return true;
+            }
+        };
+
+        template <typename Visitor>
+        void intersect(const TreeType& tree)
+        {
+            bvh::Intersector<TreeType, Visitor, Ray3f> intersector;
+
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                Visitor visitor(*this, m_rays[i]);
+                intersector.intersect_no_motion(tree, m_rays[i], m_ray_infos[i], visitor);
+                m_distance += visitor.m_hit_distance;
+            }
+        }
+    };
+
+    BENCHMARK_CASE_F(IntersectHairBall_SingleCurveLeaves, Fixture)
+    {
+        intersect<SingleCurveVisitor>(m_single_tree);
+    }
+
+    BENCHMARK_CASE_F(IntersectHairBall_OBBPacketLeaves, Fixture)
+    {
+        intersect<CurvePacketVisitor>(m_packet_tree);
+    }
+}
@@ -0,0 +1,205 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/bvh.h"
+#include "foundation/math/intersection/rayaabb.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/timers.h"
+#include "foundation/utility/alignedallocator.h"
+#include "foundation/utility/alignedvector.h"
+#include "foundation/utility/benchmark.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+BENCHMARK_SUITE(Foundation_Math_BVH_Intersector)
+{
+    typedef bvh::Node<AABB3d> NodeType;
+    typedef bvh::Tree<AlignedVector<NodeType>> TreeType;
+    typedef bvh::SAHPartitioner<vector<AABB3d>> Partitioner;
+
+    struct ClosestHitVisitor
+    {
+        const vector<AABB3d>&   m_bboxes;
+        const vector<size_t>&   m_ordering;
+        double                  m_hit_distance;
+
+        ClosestHitVisitor(
+            const vector<AABB3d>&   bboxes,
+            const vector<size_t>&   ordering,
+            const Ray3d&            ray)
+          : m_bboxes(bboxes)
+          , m_ordering(ordering)
+          , m_hit_distance(ray.m_tmax)
+        {
+        }
+
+        bool visit(
+            const NodeType&             node,
+            const Ray3d&                ray,
+            const RayInfo3d&            ray_info,
+            double&                     distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics& stats
+#endif
+            )
+        {
+            const size_t item_begin = node.get_item_index();
+            const size_t item_end = item_begin + node.get_item_count();
+
+            for (size_t i = item_begin; i < item_end; ++i)
+            {
+                double tmin;
+                if (intersect(ray, ray_info, m_bboxes[m_ordering[i]], tmin) && tmin < m_hit_distance)
+                    m_hit_distance = tmin;
+            }
+
+            distance = m_hit_distance;
+            return true;
+        }
+    };
+
+    // Small boxes scattered uniformly in the unit cube.
+    struct CloudScene
+    {
+        static vector<AABB3d> generate()
+        {
+            vector<AABB3d> bboxes;
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < 100000; ++i)
+            {
+                const Vector3d center = rand_vector1<Vector3d>(rng);
+                const Vector3d extent = 0.005 * rand_vector1<Vector3d>(rng);
+                bboxes.emplace_back(center - extent, center + extent);
+            }
+
+            return bboxes;
+        }
+    };
+
+    // Small boxes tightly covering the unit sphere, like the triangles of a tessellated surface.
+    struct SurfaceScene
+    {
+        static vector<AABB3d> generate()
+        {
+            vector<AABB3d> bboxes;
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < 100000; ++i)
+            {
+                const Vector3d center = sample_sphere_uniform(rand_vector2<Vector2d>(rng));
+                const Vector3d extent(0.01);
+                bboxes.emplace_back(center - extent, center + extent);
+            }
+
+            return bboxes;
+        }
+    };
+
+    template <typename Scene>
+    struct Fixture
+    {
+        static const size_t RayCount = 1000;
+
+        vector<AABB3d>              m_bboxes;
+        Partitioner                 m_partitioner;
+        TreeType                    m_tree;
+        bvh::WideTree<AABB3d, 4>    m_wide_tree4;
+        bvh::WideTree<AABB3d, 8>    m_wide_tree8;
+        vector<Ray3d>               m_rays;
+        vector<RayInfo3d>           m_ray_infos;
+        double                      m_distance;
+
+        Fixture()
+          : m_bboxes(Scene::generate())
+          , m_partitioner(m_bboxes, 4)
+          , m_tree(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
+          , m_distance(0.0)
+        {
+            bvh::Builder<TreeType, Partitioner> builder;
+            builder.template build<DefaultWallclockTimer>(m_tree, m_partitioner, m_bboxes.size(), 4);
+
+            m_wide_tree4.build(m_tree);
+            m_wide_tree8.build(m_tree);
+
+            // Shoot rays from a sphere surrounding the scene toward its center.
+            MersenneTwister rng;
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                const Vector3d org = 3.0 * sample_sphere_uniform(rand_vector2<Vector2d>(rng));
+                const Vector3d target = 0.5 * rand_vector1<Vector3d>(rng) - Vector3d(0.25);
+                m_rays.emplace_back(org, normalize(target - org));
+                m_ray_infos.emplace_back(m_rays.back());
+            }
+        }
+
+        void intersect_binary()
+        {
+            bvh::Intersector<TreeType, ClosestHitVisitor, Ray3d> intersector;
+
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                ClosestHitVisitor visitor(m_bboxes, m_partitioner.get_item_ordering(), m_rays[i]);
+                intersector.intersect_no_motion(m_tree, m_rays[i], m_ray_infos[i], visitor);
+                m_distance += visitor.m_hit_distance;
+            }
+        }
+
+        template <size_t Width>
+        void intersect_wide(const bvh::WideTree<AABB3d, Width>& wide_tree)
+        {
+            bvh::WideIntersector<TreeType, ClosestHitVisitor, Ray3d, Width> intersector;
+
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                ClosestHitVisitor visitor(m_bboxes, m_partitioner.get_item_ordering(), m_rays[i]);
+                intersector.intersect_no_motion(m_tree, wide_tree, m_rays[i], m_ray_infos[i], visitor);
+                m_distance += visitor.m_hit_distance;
+            }
+        }
+    };
+
+    BENCHMARK_CASE_F(IntersectCloudScene_BinaryBVH, Fixture<CloudScene>)    { intersect_binary(); }
+    BENCHMARK_CASE_F(IntersectCloudScene_BVH4, Fixture<CloudScene>)         { intersect_wide(m_wide_tree4); }
+    BENCHMARK_CASE_F(IntersectCloudScene_BVH8, Fixture<CloudScene>)         { intersect_wide(m_wide_tree8); }
+
+    BENCHMARK_CASE_F(IntersectSurfaceScene_BinaryBVH, Fixture<SurfaceScene>) { intersect_binary(); }
+    BENCHMARK_CASE_F(IntersectSurfaceScene_BVH4, Fixture<SurfaceScene>)     { intersect_wide(m_wide_tree4); }
+    BENCHMARK_CASE_F(IntersectSurfaceScene_BVH8, Fixture<SurfaceScene>)     { intersect_wide(m_wide_tree8); }
+}
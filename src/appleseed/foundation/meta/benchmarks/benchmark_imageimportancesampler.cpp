@@ -44,10 +44,10 @@ using namespace std;
 
 BENCHMARK_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
 {
+    template <typename ImportanceSamplerType>
     struct Fixture
     {
-        typedef ImageImportanceSampler<ImageSampler::Payload, float> ImportanceSamplerType;
-
+        unique_ptr<Image>                   m_image;
         unique_ptr<ImportanceSamplerType>   m_importance_sampler;
         Xorshift32                          m_rng;
 
@@ -59,26 +59,54 @@ BENCHMARK_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
           , m_texel_prob_sum(0.0f)
         {
             GenericImageFileReader reader;
-            unique_ptr<Image> image(reader.read("unit tests/inputs/test_imageimportancesampler_doge2.exr"));
+            m_image.reset(reader.read("unit tests/inputs/test_imageimportancesampler_doge2.exr"));
 
-            const size_t width = image->properties().m_canvas_width;
-            const size_t height = image->properties().m_canvas_height;
+            const size_t width = m_image->properties().m_canvas_width;
+            const size_t height = m_image->properties().m_canvas_height;
 
             m_importance_sampler.reset(new ImportanceSamplerType(width, height));
-            ImageSampler sampler(*image.get());
+            rebuild();
+        }
+
+        void rebuild()
+        {
+            ImageSampler sampler(*m_image.get());
             m_importance_sampler->rebuild(sampler);
         }
+
+        void sample()
+        {
+            const Vector2f s = rand_vector2<Vector2f>(m_rng);
+
+            Vector2u texel_coords;
+            float texel_prob;
+            m_importance_sampler->sample(s, texel_coords.x, texel_coords.y, texel_prob);
+
+            m_texel_coords_sum += texel_coords;
+            m_texel_prob_sum += texel_prob;
+        }
     };
 
-    BENCHMARK_CASE_F(Sample, Fixture)
+    typedef Fixture<ImageImportanceSampler<ImageSampler::Payload, float>> CDFFixture;
+    typedef Fixture<AliasImageImportanceSampler<ImageSampler::Payload, float>> AliasFixture;
+
+    BENCHMARK_CASE_F(Sample, CDFFixture)
+    {
+        sample();
+    }
+
+    BENCHMARK_CASE_F(Sample_AliasTables, AliasFixture)
     {
-        const Vector2f s = rand_vector2<Vector2f>(m_rng);
+        sample();
+    }
 
-        Vector2u texel_coords;
-        float texel_prob;
-        m_importance_sampler->sample(s, texel_coords.x, texel_coords.y, texel_prob);
+    BENCHMARK_CASE_F(Rebuild, CDFFixture)
+    {
+        rebuild();
+    }
 
-        m_texel_coords_sum += texel_coords;
-        m_texel_prob_sum += texel_prob;
+    BENCHMARK_CASE_F(Rebuild_AliasTables, AliasFixture)
+    {
+        rebuild();
     }
 }
@@ -40,6 +40,10 @@ using namespace std;
 
 BENCHMARK_SUITE(Foundation_Utility_Job)
 {
+    // Number of jobs executed by every benchmark case, regardless of the number of threads.
+    // Dividing this number by the time reported for a case gives the job throughput.
+    const size_t JobCount = 256;
+
     struct EmptyJob
       : public IJob
     {
@@ -48,6 +52,27 @@ BENCHMARK_SUITE(Foundation_Utility_Job)
         }
     };
 
+    struct JobSchedulingEmptyJobs
+      : public IJob
+    {
+        JobQueue&   m_job_queue;
+        EmptyJob*   m_jobs;
+        size_t      m_job_count;
+
+        JobSchedulingEmptyJobs(JobQueue& job_queue, EmptyJob* jobs, const size_t job_count)
+          : m_job_queue(job_queue)
+          , m_jobs(jobs)
+          , m_job_count(job_count)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            for (size_t i = 0; i < m_job_count; ++i)
+                m_job_queue.schedule(&m_jobs[i], false);
+        }
+    };
+
     template <size_t ThreadCount>
     struct Fixture
     {
@@ -61,9 +86,9 @@ BENCHMARK_SUITE(Foundation_Utility_Job)
             m_job_manager.start();
         }
 
+        // Jobs scheduled from the calling thread, going through the injection queue.
         void payload()
         {
-            const size_t JobCount = 256;
             EmptyJob jobs[JobCount];
 
             for (size_t i = 0; i < JobCount; ++i)
@@ -71,6 +96,23 @@ BENCHMARK_SUITE(Foundation_Utility_Job)
 
             m_job_queue.wait_until_completion();
         }
+
+        // Jobs scheduled from worker threads, going through their deques.
+        void sub_job_payload()
+        {
+            const size_t ParentJobCount = 8;
+            const size_t SubJobCount = JobCount / ParentJobCount;
+
+            EmptyJob jobs[JobCount];
+
+            for (size_t i = 0; i < ParentJobCount; ++i)
+            {
+                m_job_queue.schedule(
+                    new JobSchedulingEmptyJobs(m_job_queue, &jobs[i * SubJobCount], SubJobCount));
+            }
+
+            m_job_queue.wait_until_completion();
+        }
     };
 
     BENCHMARK_CASE_F(SingleThreadedJobExecution, Fixture<1>)
@@ -82,4 +124,44 @@ BENCHMARK_SUITE(Foundation_Utility_Job)
     {
         payload();
     }
+
+    BENCHMARK_CASE_F(QuadThreadedJobExecution, Fixture<4>)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(OctoThreadedJobExecution, Fixture<8>)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(HexadecaThreadedJobExecution, Fixture<16>)
+    {
+        payload();
+    }
+
+    BENCHMARK_CASE_F(SingleThreadedSubJobExecution, Fixture<1>)
+    {
+        sub_job_payload();
+    }
+
+    BENCHMARK_CASE_F(DoubleThreadedSubJobExecution, Fixture<2>)
+    {
+        sub_job_payload();
+    }
+
+    BENCHMARK_CASE_F(QuadThreadedSubJobExecution, Fixture<4>)
+    {
+        sub_job_payload();
+    }
+
+    BENCHMARK_CASE_F(OctoThreadedSubJobExecution, Fixture<8>)
+    {
+        sub_job_payload();
+    }
+
+    BENCHMARK_CASE_F(HexadecaThreadedSubJobExecution, Fixture<16>)
+    {
+        sub_job_payload();
+    }
 }
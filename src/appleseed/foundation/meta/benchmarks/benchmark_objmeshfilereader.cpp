@@ -0,0 +1,122 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/mesh/meshbuilderbase.h"
+#include "foundation/mesh/objmeshfilereader.h"
+#include "foundation/utility/benchmark.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+
+using namespace foundation;
+using namespace std;
+namespace bf = boost::filesystem;
+
+BENCHMARK_SUITE(Foundation_Mesh_OBJMeshFileReader)
+{
+    struct Fixture
+    {
+        static const char* filename()
+        {
+            return "unit benchmarks/outputs/benchmark_objmeshfilereader_large.obj";
+        }
+
+        Fixture()
+        {
+            bf::create_directories(bf::path(filename()).parent_path());
+
+            if (!bf::exists(filename()))
+                write_file();
+        }
+
+        // Write a tessellated grid per object, roughly 40 MB in total.
+        static void write_file()
+        {
+            const long GridSize = 250;
+            const long Row = GridSize + 1;
+            const long Count = Row * Row;
+
+            ofstream file(filename());
+            file << setprecision(7);
+
+            for (long object = 0; object < 8; ++object)
+            {
+                file << "o object" << object << "\n";
+
+                for (long y = 0; y <= GridSize; ++y)
+                {
+                    for (long x = 0; x <= GridSize; ++x)
+                    {
+                        file << "v " << x * 0.01 << " " << y * 0.01 << " " << object * 0.5 << "\n";
+                        file << "vt " << x * 0.004 << " " << y * 0.004 << "\n";
+                        file << "vn 0.0 0.0 1.0\n";
+                    }
+                }
+
+                file << "usemtl material" << object << "\n";
+
+                for (long y = 0; y < GridSize; ++y)
+                {
+                    for (long x = 0; x < GridSize; ++x)
+                    {
+                        const long a = y * Row + x - Count;
+                        const long b = a + 1, c = a + Row + 1, d = a + Row;
+                        file << "f " << a << "/" << a << "/" << a << " " << b << "/" << b << "/" << b << " "
+                             << c << "/" << c << "/" << c << " " << d << "/" << d << "/" << d << "\n";
+                    }
+                }
+            }
+        }
+
+        static void read(const int options)
+        {
+            OBJMeshFileReader reader(
+                filename(),
+                OBJMeshFileReader::FavorSpeedOverPrecision | options);
+
+            MeshBuilderBase builder;
+            reader.read(builder);
+        }
+    };
+
+    BENCHMARK_CASE_F(ReadLargeFile_Sequential, Fixture)
+    {
+        read(OBJMeshFileReader::Default);
+    }
+
+    BENCHMARK_CASE_F(ReadLargeFile_Parallel, Fixture)
+    {
+        read(OBJMeshFileReader::ParallelParsing);
+    }
+}
@@ -0,0 +1,116 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/arena.h"
+#include "foundation/utility/memory.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstring>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Utility_Arena)
+{
+    const size_t BlockSize = 1024;
+    const size_t InlineBlockCount = 256;    // number of blocks fitting in the inline page
+
+    TEST_CASE(Allocate_ReturnsAlignedMemory)
+    {
+        Arena arena;
+
+        const void* ptr1 = arena.allocate(3);
+        const void* ptr2 = arena.allocate(5);
+
+        EXPECT_TRUE(is_aligned(ptr1, 16));
+        EXPECT_TRUE(is_aligned(ptr2, 16));
+        EXPECT_EQ(16, static_cast<const char*>(ptr2) - static_cast<const char*>(ptr1));
+    }
+
+    TEST_CASE(Allocate_InlinePageIsExhausted_AllocatesOverflowPage)
+    {
+        Arena arena;
+
+        for (size_t i = 0; i < InlineBlockCount; ++i)
+            arena.allocate(BlockSize);
+
+        EXPECT_EQ(0, arena.get_overflow_page_count());
+
+        void* ptr = arena.allocate(BlockSize);
+        memset(ptr, 0xFF, BlockSize);
+
+        EXPECT_EQ(1, arena.get_overflow_page_count());
+        EXPECT_TRUE(is_aligned(ptr, 16));
+    }
+
+    TEST_CASE(Allocate_BlockLargerThanPage_Succeeds)
+    {
+        Arena arena;
+
+        const size_t Size = 3 * InlineBlockCount * BlockSize;
+        void* ptr = arena.allocate(Size);
+        memset(ptr, 0xFF, Size);
+
+        EXPECT_EQ(1, arena.get_overflow_page_count());
+        EXPECT_EQ(Size, arena.get_high_water_mark());
+    }
+
+    TEST_CASE(Clear_GivenOverflowPages_ReusesThem)
+    {
+        Arena arena;
+
+        for (size_t i = 0; i < 3 * InlineBlockCount; ++i)
+            arena.allocate(BlockSize);
+
+        EXPECT_EQ(2, arena.get_overflow_page_count());
+
+        arena.clear();
+
+        for (size_t i = 0; i < 3 * InlineBlockCount; ++i)
+            arena.allocate(BlockSize);
+
+        EXPECT_EQ(2, arena.get_overflow_page_count());
+    }
+
+    TEST_CASE(GetHighWaterMark_ReturnsLargestAllocatedSizeBetweenClears)
+    {
+        Arena arena;
+
+        EXPECT_EQ(0, arena.get_high_water_mark());
+
+        for (size_t i = 0; i < InlineBlockCount + 10; ++i)
+            arena.allocate(BlockSize);
+
+        arena.clear();
+        arena.allocate(BlockSize);
+
+        EXPECT_EQ((InlineBlockCount + 10) * BlockSize, arena.get_high_water_mark());
+    }
+}
@@ -31,6 +31,7 @@
 #include "foundation/image/genericimagefilewriter.h"
 #include "foundation/image/image.h"
 #include "foundation/image/pixel.h"
+#include "foundation/math/aabb.h"
 #include "foundation/math/beziercurve.h"
 #include "foundation/math/matrix.h"
 #include "foundation/math/ray.h"
@@ -47,6 +48,140 @@
 using namespace foundation;
 using namespace std;
 
+TEST_SUITE(Foundation_Math_BezierCurve)
+{
+    template <typename BezierCurveType>
+    bool oriented_bbox_is_orthonormal(const BezierCurveType& curve)
+    {
+        typedef typename BezierCurveType::ValueType ValueType;
+        typedef typename BezierCurveType::VectorType VectorType;
+
+        VectorType axes[3];
+        curve.compute_oriented_bbox(axes);
+
+        const ValueType Eps(1.0e-5);
+
+        return
+            feq(norm(axes[0]), ValueType(1.0), Eps) &&
+            feq(norm(axes[1]), ValueType(1.0), Eps) &&
+            feq(norm(axes[2]), ValueType(1.0), Eps) &&
+            fz(dot(axes[0], axes[1]), Eps) &&
+            fz(dot(axes[0], axes[2]), Eps) &&
+            fz(dot(axes[1], axes[2]), Eps);
+    }
+
+    // Return true if the oriented bounding box of the curve, grown by half its maximum width
+    // (as done by the curve tree), contains the curve and its width at a number of points.
+    template <typename BezierCurveType>
+    bool oriented_bbox_contains_curve(const BezierCurveType& curve)
+    {
+        typedef typename BezierCurveType::ValueType ValueType;
+        typedef typename BezierCurveType::VectorType VectorType;
+        typedef typename BezierCurveType::AABBType AABBType;
+
+        VectorType axes[3];
+        AABBType extent = curve.compute_oriented_bbox(axes);
+        extent.grow(VectorType(ValueType(0.5) * curve.compute_max_width()));
+        extent.robust_grow(ValueType(1.0e-6));
+
+        const size_t SampleCount = 101;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const ValueType t = static_cast<ValueType>(i) / (SampleCount - 1);
+            const VectorType p = curve.evaluate_point(t);
+            const ValueType radius = ValueType(0.5) * curve.evaluate_width(t);
+
+            for (size_t a = 0; a < 3; ++a)
+            {
+                for (int sign = -1; sign <= 1; sign += 2)
+                {
+                    const VectorType q = p + (sign * radius) * axes[a];
+                    const VectorType q_local(dot(axes[0], q), dot(axes[1], q), dot(axes[2], q));
+
+                    if (!extent.contains(q_local))
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    TEST_CASE(ComputeOrientedBBox_GivenBezier1Curve_ContainsCurve)
+    {
+        const Vector3f ControlPoints[] = { Vector3f(-0.5f, 0.2f, 1.0f), Vector3f(0.7f, -0.4f, 0.3f) };
+        const float Widths[] = { 0.1f, 0.03f };
+        const BezierCurve1f curve(ControlPoints, Widths);
+
+        EXPECT_TRUE(oriented_bbox_is_orthonormal(curve));
+        EXPECT_TRUE(oriented_bbox_contains_curve(curve));
+    }
+
+    TEST_CASE(ComputeOrientedBBox_GivenBezier3Curve_ContainsCurve)
+    {
+        const Vector3f ControlPoints[] =
+        {
+            Vector3f(-0.5f, 0.0f, 0.0f),
+            Vector3f(-0.2f, 0.8f, 0.3f),
+            Vector3f(0.3f, -0.6f, -0.4f),
+            Vector3f(0.6f, 0.1f, 0.2f)
+        };
+        const float Widths[] = { 0.08f, 0.02f, 0.05f, 0.01f };
+        const BezierCurve3f curve(ControlPoints, Widths);
+
+        EXPECT_TRUE(oriented_bbox_is_orthonormal(curve));
+        EXPECT_TRUE(oriented_bbox_contains_curve(curve));
+    }
+
+    TEST_CASE(ComputeOrientedBBox_GivenStraightBezier3Curve_ContainsCurve)
+    {
+        const Vector3f ControlPoints[] =
+        {
+            Vector3f(-0.3f, -0.3f, 0.6f),
+            Vector3f(-0.1f, -0.1f, 0.2f),
+            Vector3f(0.2f, 0.2f, -0.4f),
+            Vector3f(0.3f, 0.3f, -0.6f)
+        };
+        const BezierCurve3f curve(ControlPoints, 0.05f);
+
+        EXPECT_TRUE(oriented_bbox_is_orthonormal(curve));
+        EXPECT_TRUE(oriented_bbox_contains_curve(curve));
+    }
+
+    TEST_CASE(ComputeOrientedBBox_GivenClosedBezier3Curve_ContainsCurve)
+    {
+        // The first and last control points coincide: the chord has zero length.
+        const Vector3f ControlPoints[] =
+        {
+            Vector3f(0.1f, 0.2f, 0.3f),
+            Vector3f(0.8f, 0.9f, -0.2f),
+            Vector3f(-0.6f, 0.7f, 0.5f),
+            Vector3f(0.1f, 0.2f, 0.3f)
+        };
+        const float Widths[] = { 0.02f, 0.06f, 0.04f, 0.02f };
+        const BezierCurve3f curve(ControlPoints, Widths);
+
+        EXPECT_TRUE(oriented_bbox_is_orthonormal(curve));
+        EXPECT_TRUE(oriented_bbox_contains_curve(curve));
+    }
+
+    TEST_CASE(ComputeOrientedBBox_GivenBezier3CurveCollapsedToPoint_ContainsCurve)
+    {
+        const Vector3f ControlPoints[] =
+        {
+            Vector3f(0.4f, -0.2f, 0.1f),
+            Vector3f(0.4f, -0.2f, 0.1f),
+            Vector3f(0.4f, -0.2f, 0.1f),
+            Vector3f(0.4f, -0.2f, 0.1f)
+        };
+        const BezierCurve3f curve(ControlPoints, 0.05f);
+
+        EXPECT_TRUE(oriented_bbox_is_orthonormal(curve));
+        EXPECT_TRUE(oriented_bbox_contains_curve(curve));
+    }
+}
+
 TEST_SUITE(Foundation_Math_BezierCurveIntersector)
 {
 #pragma warning (push)
@@ -0,0 +1,526 @@
+
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfilereader.h"
+#include "foundation/mesh/binarymeshfilewriter.h"
+#include "foundation/mesh/imeshbuilder.h"
+#include "foundation/mesh/imeshwalker.h"
+#include "foundation/mesh/meshbuilderbase.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Mesh_BinaryMeshFile)
+{
+    struct Face
+    {
+        vector<size_t>      m_vertices;
+        vector<size_t>      m_vertex_normals;
+        vector<size_t>      m_tex_coords;
+        size_t              m_material;
+    };
+
+    struct Mesh
+    {
+        string              m_name;
+        vector<Vector3d>    m_vertices;
+        vector<Vector3d>    m_vertex_normals;
+        vector<Vector2d>    m_tex_coords;
+        vector<string>      m_material_slots;
+        vector<Face>        m_faces;
+    };
+
+    struct MeshBuilder
+      : public MeshBuilderBase
+    {
+        vector<Mesh> m_meshes;
+
+        void begin_mesh(const char* name) override
+        {
+            m_meshes.emplace_back();
+            m_meshes.back().m_name = name;
+        }
+
+        size_t push_vertex(const Vector3d& v) override
+        {
+            m_meshes.back().m_vertices.push_back(v);
+            return m_meshes.back().m_vertices.size() - 1;
+        }
+
+        size_t push_vertex_normal(const Vector3d& v) override
+        {
+            m_meshes.back().m_vertex_normals.push_back(v);
+            return m_meshes.back().m_vertex_normals.size() - 1;
+        }
+
+        size_t push_tex_coords(const Vector2d& v) override
+        {
+            m_meshes.back().m_tex_coords.push_back(v);
+            return m_meshes.back().m_tex_coords.size() - 1;
+        }
+
+        size_t push_material_slot(const char* name) override
+        {
+            m_meshes.back().m_material_slots.emplace_back(name);
+            return m_meshes.back().m_material_slots.size() - 1;
+        }
+
+        void begin_face(const size_t vertex_count) override
+        {
+            m_meshes.back().m_faces.emplace_back();
+            m_meshes.back().m_faces.back().m_vertices.resize(vertex_count);
+            m_meshes.back().m_faces.back().m_material = IMeshWalker::None;
+        }
+
+        void set_face_vertices(const size_t vertices[]) override
+        {
+            Face& face = m_meshes.back().m_faces.back();
+            face.m_vertices.assign(vertices, vertices + face.m_vertices.size());
+        }
+
+        void set_face_vertex_normals(const size_t vertex_normals[]) override
+        {
+            Face& face = m_meshes.back().m_faces.back();
+            face.m_vertex_normals.assign(vertex_normals, vertex_normals + face.m_vertices.size());
+        }
+
+        void set_face_vertex_tex_coords(const size_t tex_coords[]) override
+        {
+            Face& face = m_meshes.back().m_faces.back();
+            face.m_tex_coords.assign(tex_coords, tex_coords + face.m_vertices.size());
+        }
+
+        void set_face_material(const size_t material) override
+        {
+            m_meshes.back().m_faces.back().m_material = material;
+        }
+    };
+
+    struct MeshWalker
+      : public IMeshWalker
+    {
+        const Mesh& m_mesh;
+
+        explicit MeshWalker(const Mesh& mesh)
+          : m_mesh(mesh)
+        {
+        }
+
+        const char* get_name() const override
+        {
+            return m_mesh.m_name.c_str();
+        }
+
+        size_t get_vertex_count() const override
+        {
+            return m_mesh.m_vertices.size();
+        }
+
+        Vector3d get_vertex(const size_t i) const override
+        {
+            return m_mesh.m_vertices[i];
+        }
+
+        size_t get_vertex_normal_count() const override
+        {
+            return m_mesh.m_vertex_normals.size();
+        }
+
+        Vector3d get_vertex_normal(const size_t i) const override
+        {
+            return m_mesh.m_vertex_normals[i];
+        }
+
+        size_t get_tex_coords_count() const override
+        {
+            return m_mesh.m_tex_coords.size();
+        }
+
+        Vector2d get_tex_coords(const size_t i) const override
+        {
+            return m_mesh.m_tex_coords[i];
+        }
+
+        size_t get_material_slot_count() const override
+        {
+            return m_mesh.m_material_slots.size();
+        }
+
+        const char* get_material_slot(const size_t i) const override
+        {
+            return m_mesh.m_material_slots[i].c_str();
+        }
+
+        size_t get_face_count() const override
+        {
+            return m_mesh.m_faces.size();
+        }
+
+        size_t get_face_vertex_count(const size_t face_index) const override
+        {
+            return m_mesh.m_faces[face_index].m_vertices.size();
+        }
+
+        size_t get_face_vertex(const size_t face_index, const size_t vertex_index) const override
+        {
+            return m_mesh.m_faces[face_index].m_vertices[vertex_index];
+        }
+
+        size_t get_face_vertex_normal(const size_t face_index, const size_t vertex_index) const override
+        {
+            const Face& face = m_mesh.m_faces[face_index];
+            return face.m_vertex_normals.empty() ? None : face.m_vertex_normals[vertex_index];
+        }
+
+        size_t get_face_tex_coords(const size_t face_index, const size_t vertex_index) const override
+        {
+            const Face& face = m_mesh.m_faces[face_index];
+            return face.m_tex_coords.empty() ? None : face.m_tex_coords[vertex_index];
+        }
+
+        size_t get_face_material(const size_t face_index) const override
+        {
+            return m_mesh.m_faces[face_index].m_material;
+        }
+    };
+
+    Face make_face(const size_t v0, const size_t v1, const size_t v2, const size_t material)
+    {
+        Face face;
+        face.m_vertices.push_back(v0);
+        face.m_vertices.push_back(v1);
+        face.m_vertices.push_back(v2);
+        face.m_vertex_normals = face.m_vertices;
+        face.m_tex_coords = face.m_vertices;
+        face.m_material = material;
+        return face;
+    }
+
+    // Create a square made of two triangles, with normals, texture coordinates and two materials.
+    Mesh create_mesh(const string& name)
+    {
+        Mesh mesh;
+        mesh.m_name = name;
+
+        mesh.m_vertices.emplace_back(0.0, 0.0, 0.0);
+        mesh.m_vertices.emplace_back(1.0, 0.0, 0.0);
+        mesh.m_vertices.emplace_back(1.0, 1.0, 0.0);
+        mesh.m_vertices.emplace_back(0.0, 1.0, 0.0);
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            mesh.m_vertex_normals.emplace_back(0.0, 0.0, 1.0);
+            mesh.m_tex_coords.emplace_back(mesh.m_vertices[i][0], mesh.m_vertices[i][1]);
+        }
+
+        mesh.m_material_slots.push_back("front");
+        mesh.m_material_slots.push_back("back");
+
+        mesh.m_faces.push_back(make_face(0, 1, 2, 0));
+        mesh.m_faces.push_back(make_face(2, 3, 0, 1));
+
+        return mesh;
+    }
+
+    void write_meshes(
+        const char*             filename,
+        const vector<Mesh>&     meshes,
+        const uint16            version,
+        const int               options)
+    {
+        BinaryMeshFileWriter writer(filename, version, options);
+
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            const MeshWalker walker(meshes[i]);
+            writer.write(walker);
+        }
+    }
+
+    bool operator==(const Face& lhs, const Face& rhs)
+    {
+        return
+            lhs.m_vertices == rhs.m_vertices &&
+            lhs.m_vertex_normals == rhs.m_vertex_normals &&
+            lhs.m_tex_coords == rhs.m_tex_coords &&
+            lhs.m_material == rhs.m_material;
+    }
+
+    bool operator==(const Mesh& lhs, const Mesh& rhs)
+    {
+        return
+            lhs.m_name == rhs.m_name &&
+            lhs.m_vertices == rhs.m_vertices &&
+            lhs.m_vertex_normals == rhs.m_vertex_normals &&
+            lhs.m_tex_coords == rhs.m_tex_coords &&
+            lhs.m_material_slots == rhs.m_material_slots &&
+            lhs.m_faces == rhs.m_faces;
+    }
+
+    struct ArrayMeshBuilder
+      : public MeshBuilderBase
+    {
+        vector<string>          m_names;
+        vector<Vector3f>        m_vertices;
+        vector<MeshTriangle>    m_triangles;
+        size_t                  m_array_call_count;
+        size_t                  m_face_call_count;
+
+        ArrayMeshBuilder()
+          : m_array_call_count(0)
+          , m_face_call_count(0)
+        {
+        }
+
+        void begin_mesh(const char* name) override
+        {
+            m_names.push_back(name);
+        }
+
+        size_t push_vertex_array(const Vector3f vertices[], const size_t count) override
+        {
+            ++m_array_call_count;
+            m_vertices.insert(m_vertices.end(), vertices, vertices + count);
+            return m_vertices.size() - count;
+        }
+
+        void push_triangle_array(const MeshTriangle triangles[], const size_t count) override
+        {
+            ++m_array_call_count;
+            m_triangles.insert(m_triangles.end(), triangles, triangles + count);
+        }
+
+        void begin_face(const size_t vertex_count) override
+        {
+            ++m_face_call_count;
+        }
+    };
+
+    struct ArraysHandler
+      : public IBinaryMeshArraysHandler
+    {
+        vector<string>          m_names;
+        vector<Vector3f>        m_vertices;
+        vector<MeshTriangle>    m_triangles;
+
+        void on_mesh(const BinaryMeshArrays& mesh) override
+        {
+            m_names.push_back(mesh.m_name);
+            m_vertices.assign(mesh.m_vertices, mesh.m_vertices + mesh.m_vertex_count);
+            m_triangles.assign(mesh.m_triangles, mesh.m_triangles + mesh.m_triangle_count);
+        }
+    };
+
+    TEST_CASE(Version3_RoundTrip)
+    {
+        vector<Mesh> meshes;
+        meshes.push_back(create_mesh("mesh"));
+
+        write_meshes("unit tests/outputs/test_binarymeshfile_version3.binarymesh", meshes, 3, BinaryMeshFileWriter::Default);
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfile_version3.binarymesh");
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(1, builder.m_meshes.size());
+        EXPECT_TRUE(meshes[0] == builder.m_meshes[0]);
+    }
+
+    TEST_CASE(Version4_RoundTrip)
+    {
+        vector<Mesh> meshes;
+        meshes.push_back(create_mesh("mesh1"));
+        meshes.push_back(create_mesh("mesh2"));
+
+        write_meshes("unit tests/outputs/test_binarymeshfile_version4.binarymesh", meshes, 4, BinaryMeshFileWriter::Default);
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfile_version4.binarymesh");
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(2, builder.m_meshes.size());
+        EXPECT_TRUE(meshes[0] == builder.m_meshes[0]);
+        EXPECT_TRUE(meshes[1] == builder.m_meshes[1]);
+    }
+
+    TEST_CASE(Version4Compressed_RoundTrip)
+    {
+        vector<Mesh> meshes;
+        meshes.push_back(create_mesh("mesh1"));
+        meshes.push_back(create_mesh("mesh2"));
+
+        write_meshes("unit tests/outputs/test_binarymeshfile_version4_compressed.binarymesh", meshes, 4, BinaryMeshFileWriter::CompressArrays);
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfile_version4_compressed.binarymesh");
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(2, builder.m_meshes.size());
+        EXPECT_TRUE(meshes[0] == builder.m_meshes[0]);
+        EXPECT_TRUE(meshes[1] == builder.m_meshes[1]);
+    }
+
+    TEST_CASE(Version4_TriangulatesPolygonsAndMarksMissingAttributes)
+    {
+        Mesh mesh;
+        mesh.m_name = "quad";
+        mesh.m_vertices.emplace_back(0.0, 0.0, 0.0);
+        mesh.m_vertices.emplace_back(1.0, 0.0, 0.0);
+        mesh.m_vertices.emplace_back(1.0, 1.0, 0.0);
+        mesh.m_vertices.emplace_back(0.0, 1.0, 0.0);
+
+        Face face;
+        face.m_vertices.push_back(0);
+        face.m_vertices.push_back(1);
+        face.m_vertices.push_back(2);
+        face.m_vertices.push_back(3);
+        face.m_material = 0;
+        mesh.m_faces.push_back(face);
+
+        vector<Mesh> meshes;
+        meshes.push_back(mesh);
+
+        write_meshes("unit tests/outputs/test_binarymeshfile_version4_quad.binarymesh", meshes, 4, BinaryMeshFileWriter::Default);
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfile_version4_quad.binarymesh");
+        ArrayMeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(1, builder.m_names.size());
+        EXPECT_EQ("quad", builder.m_names[0]);
+        EXPECT_EQ(4, builder.m_vertices.size());
+        ASSERT_EQ(2, builder.m_triangles.size());
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            EXPECT_EQ(uint32(MeshTriangle::None), builder.m_triangles[i].m_n0);
+            EXPECT_EQ(uint32(MeshTriangle::None), builder.m_triangles[i].m_t0);
+            EXPECT_EQ(0, builder.m_triangles[i].m_material);
+        }
+    }
+
+    TEST_CASE(Version4Compressed_LargeMeshSpanningSeveralChunks_RoundTrip)
+    {
+        Mesh mesh;
+        mesh.m_name = "large";
+
+        for (size_t i = 0; i < 300000; ++i)
+            mesh.m_vertices.emplace_back(static_cast<double>(i), 0.0, static_cast<double>(i % 7));
+
+        for (size_t i = 0; i + 2 < mesh.m_vertices.size(); i += 3)
+        {
+            Face face;
+            face.m_vertices.push_back(i);
+            face.m_vertices.push_back(i + 1);
+            face.m_vertices.push_back(i + 2);
+            face.m_material = IMeshWalker::None;
+            mesh.m_faces.push_back(face);
+        }
+
+        vector<Mesh> meshes;
+        meshes.push_back(mesh);
+
+        write_meshes("unit tests/outputs/test_binarymeshfile_version4_large.binarymesh", meshes, 4, BinaryMeshFileWriter::CompressArrays);
+
+        Logger logger;
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfile_version4_large.binarymesh", logger, 4);
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(1, builder.m_meshes.size());
+        EXPECT_TRUE(mesh == builder.m_meshes[0]);
+    }
+
+    TEST_CASE(Version4_PassesArraysInBulkToBuilder)
+    {
+        vector<Mesh> meshes;
+        meshes.push_back(create_mesh("mesh"));
+
+        write_meshes("unit tests/outputs/test_binarymeshfile_version4_bulk.binarymesh", meshes, 4, BinaryMeshFileWriter::CompressArrays);
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfile_version4_bulk.binarymesh");
+        ArrayMeshBuilder builder;
+        reader.read(builder);
+
+        EXPECT_EQ(2, builder.m_array_call_count);
+        EXPECT_EQ(0, builder.m_face_call_count);
+        ASSERT_EQ(4, builder.m_vertices.size());
+        EXPECT_EQ(Vector3f(1.0f, 1.0f, 0.0f), builder.m_vertices[2]);
+        ASSERT_EQ(2, builder.m_triangles.size());
+        EXPECT_EQ(2, builder.m_triangles[1].m_v0);
+        EXPECT_EQ(3, builder.m_triangles[1].m_n1);
+        EXPECT_EQ(0, builder.m_triangles[1].m_t2);
+        EXPECT_EQ(1, builder.m_triangles[1].m_material);
+    }
+
+    TEST_CASE(ReadArrays_GivenVersion4File_ExposesArrays)
+    {
+        vector<Mesh> meshes;
+        meshes.push_back(create_mesh("mesh"));
+
+        write_meshes("unit tests/outputs/test_binarymeshfile_readarrays_version4.binarymesh", meshes, 4, BinaryMeshFileWriter::Default);
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfile_readarrays_version4.binarymesh");
+        ArraysHandler handler;
+        ASSERT_TRUE(reader.read_arrays(handler));
+
+        ASSERT_EQ(1, handler.m_names.size());
+        EXPECT_EQ("mesh", handler.m_names[0]);
+        ASSERT_EQ(4, handler.m_vertices.size());
+        EXPECT_EQ(Vector3f(1.0f, 1.0f, 0.0f), handler.m_vertices[2]);
+        ASSERT_EQ(2, handler.m_triangles.size());
+        EXPECT_EQ(2, handler.m_triangles[1].m_v0);
+        EXPECT_EQ(1, handler.m_triangles[1].m_material);
+    }
+
+    TEST_CASE(ReadArrays_GivenVersion3File_ReturnsFalse)
+    {
+        vector<Mesh> meshes;
+        meshes.push_back(create_mesh("mesh"));
+
+        write_meshes("unit tests/outputs/test_binarymeshfile_readarrays_version3.binarymesh", meshes, 3, BinaryMeshFileWriter::Default);
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfile_readarrays_version3.binarymesh");
+        ArraysHandler handler;
+
+        EXPECT_FALSE(reader.read_arrays(handler));
+        EXPECT_TRUE(handler.m_names.empty());
+    }
+}
@@ -30,10 +30,16 @@
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
 #include "foundation/math/bvh.h"
+#include "foundation/math/intersection/rayaabb.h"
 #include "foundation/math/ray.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/timers.h"
 #include "foundation/utility/alignedvector.h"
 #include "foundation/utility/iostreamop.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
@@ -74,6 +80,111 @@ TEST_SUITE(Foundation_Math_BVH_Node)
     }
 }
 
+namespace
+{
+    typedef AlignedVector<bvh::Node<AABB3d>> NodeVector3d;
+
+    class TestTree
+      : public bvh::Tree<NodeVector3d>
+    {
+      public:
+        const NodeVector3d& get_nodes() const
+        {
+            return m_nodes;
+        }
+    };
+
+    void generate_random_bboxes(
+        vector<AABB3d>&     bboxes,
+        const size_t        count)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Vector3d center = rand_vector1<Vector3d>(rng);
+            const Vector3d extent = 0.01 * rand_vector1<Vector3d>(rng);
+            bboxes.emplace_back(center - extent, center + extent);
+        }
+    }
+
+    bool are_identical(const TestTree& lhs, const TestTree& rhs)
+    {
+        const NodeVector3d& lhs_nodes = lhs.get_nodes();
+        const NodeVector3d& rhs_nodes = rhs.get_nodes();
+
+        if (lhs_nodes.size() != rhs_nodes.size())
+            return false;
+
+        for (size_t i = 0, e = lhs_nodes.size(); i < e; ++i)
+        {
+            const bvh::Node<AABB3d>& lhs_node = lhs_nodes[i];
+            const bvh::Node<AABB3d>& rhs_node = rhs_nodes[i];
+
+            if (lhs_node.is_leaf() != rhs_node.is_leaf())
+                return false;
+
+            if (lhs_node.is_leaf())
+            {
+                if (lhs_node.get_item_index() != rhs_node.get_item_index() ||
+                    lhs_node.get_item_count() != rhs_node.get_item_count())
+                    return false;
+            }
+            else
+            {
+                if (lhs_node.get_child_node_index() != rhs_node.get_child_node_index() ||
+                    lhs_node.get_left_bbox() != rhs_node.get_left_bbox() ||
+                    lhs_node.get_right_bbox() != rhs_node.get_right_bbox())
+                    return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+TEST_SUITE(Foundation_Math_BVH_Builder)
+{
+    template <typename Partitioner>
+    void build_serial_and_parallel_trees(const size_t thread_count, bool& identical)
+    {
+        vector<AABB3d> bboxes;
+        generate_random_bboxes(bboxes, 20000);
+
+        Partitioner serial_partitioner(bboxes, 2);
+        TestTree serial_tree;
+        bvh::Builder<TestTree, Partitioner> serial_builder;
+        serial_builder.template build<DefaultWallclockTimer>(serial_tree, serial_partitioner, bboxes.size(), 2);
+
+        Logger logger;
+        Partitioner parallel_partitioner(bboxes, 2);
+        TestTree parallel_tree;
+        bvh::Builder<TestTree, Partitioner> parallel_builder;
+        parallel_builder.template build<DefaultWallclockTimer>(parallel_tree, parallel_partitioner, bboxes.size(), 2, logger, thread_count);
+
+        identical =
+            are_identical(serial_tree, parallel_tree) &&
+            serial_partitioner.get_item_ordering() == parallel_partitioner.get_item_ordering() &&
+            parallel_builder.get_thread_build_times().size() == thread_count;
+    }
+
+    TEST_CASE(Build_SAHPartitioner_ParallelBuildMatchesSerialBuild)
+    {
+        bool identical;
+        build_serial_and_parallel_trees<bvh::SAHPartitioner<vector<AABB3d>>>(4, identical);
+
+        EXPECT_TRUE(identical);
+    }
+
+    TEST_CASE(Build_MedianPartitioner_ParallelBuildMatchesSerialBuild)
+    {
+        bool identical;
+        build_serial_and_parallel_trees<bvh::MedianPartitioner<vector<AABB3d>>>(4, identical);
+
+        EXPECT_TRUE(identical);
+    }
+}
+
 TEST_SUITE(Foundation_Math_BVH_SpatialBuilder)
 {
     struct ItemHandler
@@ -117,6 +228,77 @@ TEST_SUITE(Foundation_Math_BVH_SpatialBuilder)
         Tree tree;
         bvh::SpatialBuilder<Tree, Partitioner> builder;
     }
+
+    struct BoxItemHandler
+    {
+        const vector<AABB3d>& m_bboxes;
+
+        explicit BoxItemHandler(const vector<AABB3d>& bboxes)
+          : m_bboxes(bboxes)
+        {
+        }
+
+        double get_bbox_grow_eps() const
+        {
+            return 1.0e-9;
+        }
+
+        AABB3d clip(
+            const size_t    item_index,
+            const size_t    dimension,
+            const double    bin_min,
+            const double    bin_max) const
+        {
+            AABB3d bbox = m_bboxes[item_index];
+            bbox.min[dimension] = max(bbox.min[dimension], bin_min);
+            bbox.max[dimension] = min(bbox.max[dimension], bin_max);
+            return bbox;
+        }
+
+        bool intersect(
+            const size_t    item_index,
+            const AABB3d&   bbox) const
+        {
+            return AABB3d::overlap(m_bboxes[item_index], bbox);
+        }
+    };
+
+    TEST_CASE(Build_SBVHPartitioner_ParallelBuildMatchesSerialBuild)
+    {
+        typedef bvh::SBVHPartitioner<BoxItemHandler, vector<AABB3d>> Partitioner;
+
+        vector<AABB3d> bboxes;
+        generate_random_bboxes(bboxes, 20000);
+        BoxItemHandler item_handler(bboxes);
+
+        Partitioner serial_partitioner(item_handler, bboxes, 2, 16);
+        Partitioner::LeafType* serial_root_leaf = serial_partitioner.create_root_leaf();
+        TestTree serial_tree;
+        bvh::SpatialBuilder<TestTree, Partitioner> serial_builder;
+        serial_builder.build<DefaultWallclockTimer>(
+            serial_tree,
+            serial_partitioner,
+            serial_root_leaf,
+            serial_partitioner.compute_leaf_bbox(*serial_root_leaf));
+
+        Logger logger;
+        Partitioner parallel_partitioner(item_handler, bboxes, 2, 16);
+        Partitioner::LeafType* parallel_root_leaf = parallel_partitioner.create_root_leaf();
+        TestTree parallel_tree;
+        bvh::SpatialBuilder<TestTree, Partitioner> parallel_builder;
+        parallel_builder.build<DefaultWallclockTimer>(
+            parallel_tree,
+            parallel_partitioner,
+            parallel_root_leaf,
+            parallel_partitioner.compute_leaf_bbox(*parallel_root_leaf),
+            logger,
+            4);
+
+        EXPECT_TRUE(are_identical(serial_tree, parallel_tree));
+        EXPECT_EQ(serial_partitioner.get_item_ordering(), parallel_partitioner.get_item_ordering());
+        EXPECT_EQ(serial_partitioner.get_spatial_split_count(), parallel_partitioner.get_spatial_split_count());
+        EXPECT_EQ(serial_partitioner.get_object_split_count(), parallel_partitioner.get_object_split_count());
+    }
 }
 
 TEST_SUITE(Foundation_Math_BVH_Intersector_2D)
@@ -148,3 +330,173 @@ TEST_SUITE(Foundation_Math_BVH_Intersector_2D)
         > intersector;
     }
 }
+
+TEST_SUITE(Foundation_Math_BVH_WideNode)
+{
+    TEST_CASE(TestStorageAndRetrievalOfChildren)
+    {
+        static const AABB3d FirstBBox(Vector3d(1.0, 2.0, 3.0), Vector3d(4.0, 5.0, 6.0));
+        static const AABB3d SecondBBox(Vector3d(7.0, 8.0, 9.0), Vector3d(10.0, 11.0, 12.0));
+
+        bvh::WideNode<AABB3d, 4> node;
+        node.clear();
+
+        node.add_interior_child(FirstBBox, 12);
+        node.add_leaf_child(SecondBBox, 34);
+
+        ASSERT_EQ(2, node.get_child_count());
+        EXPECT_FALSE(node.is_leaf_child(0));
+        EXPECT_EQ(12, node.get_child_index(0));
+        EXPECT_EQ(FirstBBox, node.get_child_bbox(0));
+        EXPECT_TRUE(node.is_leaf_child(1));
+        EXPECT_EQ(34, node.get_child_index(1));
+        EXPECT_EQ(SecondBBox, node.get_child_bbox(1));
+    }
+}
+
+TEST_SUITE(Foundation_Math_BVH_WideIntersector)
+{
+    typedef bvh::Node<AABB3d> NodeType;
+    typedef bvh::SAHPartitioner<vector<AABB3d>> Partitioner;
+
+    struct ClosestHitVisitor
+    {
+        const vector<AABB3d>&   m_bboxes;
+        const vector<size_t>&   m_ordering;
+        size_t                  m_hit_item;
+        double                  m_hit_distance;
+
+        ClosestHitVisitor(
+            const vector<AABB3d>&   bboxes,
+            const vector<size_t>&   ordering,
+            const Ray3d&            ray)
+          : m_bboxes(bboxes)
+          , m_ordering(ordering)
+          , m_hit_item(~size_t(0))
+          , m_hit_distance(ray.m_tmax)
+        {
+        }
+
+        bool visit(
+            const NodeType&             node,
+            const Ray3d&                ray,
+            const RayInfo3d&            ray_info,
+            double&                     distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics& stats
+#endif
+            )
+        {
+            const size_t item_begin = node.get_item_index();
+            const size_t item_end = item_begin + node.get_item_count();
+
+            for (size_t i = item_begin; i < item_end; ++i)
+            {
+                double tmin;
+                if (intersect(ray, ray_info, m_bboxes[m_ordering[i]], tmin) && tmin < m_hit_distance)
+                {
+                    m_hit_item = m_ordering[i];
+                    m_hit_distance = tmin;
+                }
+            }
+
+            distance = m_hit_distance;
+            return true;
+        }
+    };
+
+    struct Fixture
+    {
+        vector<AABB3d>          m_bboxes;
+        Partitioner             m_partitioner;
+        TestTree                m_tree;
+        vector<Ray3d>           m_rays;
+
+        static vector<AABB3d> make_random_bboxes(const size_t count)
+        {
+            vector<AABB3d> bboxes;
+            generate_random_bboxes(bboxes, count);
+            return bboxes;
+        }
+
+        Fixture()
+          : m_bboxes(make_random_bboxes(5000))
+          , m_partitioner(m_bboxes, 2)
+        {
+            bvh::Builder<TestTree, Partitioner> builder;
+            builder.build<DefaultWallclockTimer>(m_tree, m_partitioner, m_bboxes.size(), 2);
+
+            MersenneTwister rng;
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                const Vector3d org = 2.0 * rand_vector1<Vector3d>(rng) - Vector3d(0.5);
+                const Vector3d dir = sample_sphere_uniform(rand_vector2<Vector2d>(rng));
+                m_rays.emplace_back(org, dir);
+            }
+        }
+
+        template <size_t Width>
+        bool wide_traversal_matches_binary_traversal() const
+        {
+            bvh::WideTree<AABB3d, Width> wide_tree;
+            wide_tree.build(m_tree);
+
+            if (wide_tree.empty())
+                return false;
+
+            bvh::Intersector<TestTree, ClosestHitVisitor, Ray3d> intersector;
+            bvh::WideIntersector<TestTree, ClosestHitVisitor, Ray3d, Width> wide_intersector;
+
+            for (size_t i = 0; i < m_rays.size(); ++i)
+            {
+                const Ray3d& ray = m_rays[i];
+                const RayInfo3d ray_info(ray);
+
+                ClosestHitVisitor visitor(m_bboxes, m_partitioner.get_item_ordering(), ray);
+                intersector.intersect_no_motion(m_tree, ray, ray_info, visitor);
+
+                ClosestHitVisitor wide_visitor(m_bboxes, m_partitioner.get_item_ordering(), ray);
+                wide_intersector.intersect_no_motion(m_tree, wide_tree, ray, ray_info, wide_visitor);
+
+                if (visitor.m_hit_item != wide_visitor.m_hit_item ||
+                    visitor.m_hit_distance != wide_visitor.m_hit_distance)
+                    return false;
+            }
+
+            return true;
+        }
+    };
+
+    TEST_CASE_F(IntersectNoMotion_GivenBVH4_ReturnsSameClosestHitsAsBinaryBVH, Fixture)
+    {
+        EXPECT_TRUE(wide_traversal_matches_binary_traversal<4>());
+    }
+
+    TEST_CASE_F(IntersectNoMotion_GivenBVH8_ReturnsSameClosestHitsAsBinaryBVH, Fixture)
+    {
+        EXPECT_TRUE(wide_traversal_matches_binary_traversal<8>());
+    }
+
+    TEST_CASE(IntersectNoMotion_GivenSingleLeafTree_VisitsLeaf)
+    {
+        vector<AABB3d> bboxes;
+        generate_random_bboxes(bboxes, 2);
+
+        Partitioner partitioner(bboxes, 2);
+        TestTree tree;
+        bvh::Builder<TestTree, Partitioner> builder;
+        builder.build<DefaultWallclockTimer>(tree, partitioner, bboxes.size(), 2);
+
+        bvh::WideTree<AABB3d, 4> wide_tree;
+        wide_tree.build(tree);
+        EXPECT_TRUE(wide_tree.empty());
+
+        const Ray3d ray(bboxes[0].center() - Vector3d(1.0, 0.0, 0.0), Vector3d(1.0, 0.0, 0.0));
+        const RayInfo3d ray_info(ray);
+        ClosestHitVisitor visitor(bboxes, partitioner.get_item_ordering(), ray);
+        bvh::WideIntersector<TestTree, ClosestHitVisitor, Ray3d, 4> intersector;
+        intersector.intersect_no_motion(tree, wide_tree, ray, ray_info, visitor);
+
+        EXPECT_EQ(0, visitor.m_hit_item);
+    }
+}
@@ -189,6 +189,21 @@ TEST_SUITE(Foundation_Utility_Cache_LRUCache)
         cache.get(9);   // flushes 6, cache contains 9
         ASSERT_EQ(9000, element_swapper.m_memory_size);
     }
+
+    TEST_CASE(Trim_UnloadsElementsUntilCacheIsNoLongerFull)
+    {
+        KeyHasher key_hasher;
+        ElementSwapperTrackingSize element_swapper;
+        LRUCache<Key, KeyHasher, Element, ElementSwapperTrackingSize> cache(key_hasher, element_swapper);
+
+        cache.get(9);   // cache contains 9, which is over the limit
+        ASSERT_EQ(9000, element_swapper.m_memory_size);
+
+        const size_t unloaded_count = cache.trim();
+
+        EXPECT_EQ(1, unloaded_count);
+        EXPECT_EQ(0, element_swapper.m_memory_size);
+    }
 }
 
 TEST_SUITE(Foundation_Utility_Cache_DualStageCache)
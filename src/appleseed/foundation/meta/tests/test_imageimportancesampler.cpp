@@ -228,4 +228,118 @@ TEST_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
 
         EXPECT_GT(0.0f, prob_xy);
     }
+
+    TEST_CASE(AliasImportanceSampler_GetPDF_ReturnsSameProbabilityAsSample)
+    {
+        const size_t Width = 5;
+        const size_t Height = 5;
+
+        AliasImageImportanceSampler<HorizontalGradientSampler::Payload, float> importance_sampler(Width, Height);
+        HorizontalGradientSampler sampler(Width, Height);
+        importance_sampler.rebuild(sampler);
+
+        for (size_t i = 0; i < 64; ++i)
+        {
+            const Vector2f s(
+                radical_inverse_base2<float>(i),
+                radical_inverse<float>(3, i));
+
+            size_t x, y;
+            float prob_xy;
+            importance_sampler.sample(s, x, y, prob_xy);
+
+            EXPECT_NEQ(0, x);
+            EXPECT_EQ(prob_xy, importance_sampler.get_pdf(x, y));
+        }
+    }
+
+    TEST_CASE(AliasImportanceSampler_GetPDF_ReturnsSameProbabilityAsCDFImportanceSampler)
+    {
+        const size_t Width = 7;
+        const size_t Height = 3;
+
+        AliasImageImportanceSampler<HorizontalGradientSampler::Payload, float> alias_importance_sampler(Width, Height);
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float> cdf_importance_sampler(Width, Height);
+        HorizontalGradientSampler sampler(Width, Height);
+        alias_importance_sampler.rebuild(sampler);
+        cdf_importance_sampler.rebuild(sampler);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+                EXPECT_FEQ(cdf_importance_sampler.get_pdf(x, y), alias_importance_sampler.get_pdf(x, y));
+        }
+    }
+
+    TEST_CASE(AliasImportanceSampler_Sample_GivenUniformBlackImage)
+    {
+        AliasImageImportanceSampler<UniformBlackImageSampler::Payload, float> importance_sampler(2, 2);
+        UniformBlackImageSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        size_t x, y;
+        float prob_xy;
+        importance_sampler.sample(Vector2f(0.0f, 0.0f), x, y, prob_xy);
+
+        EXPECT_EQ(0, x);
+        EXPECT_EQ(0, y);
+        EXPECT_EQ(0.25f, prob_xy);
+        EXPECT_EQ(0.25f, importance_sampler.get_pdf(0, 1));
+    }
+
+    class BlackCellsCheckerboardSampler
+    {
+      public:
+        struct Payload {};
+
+        void sample(const size_t x, const size_t y, Payload& payload, float& importance) const
+        {
+            // The second row is entirely black, as in the lower half of many light probes.
+            if ((x / 3 + y) % 2 == 0 || y == 1)
+                importance = 0.0f;
+            else importance = 0.1f + 0.37f * ((x * 7 + y * 13) % 11);
+        }
+    };
+
+    TEST_CASE(AliasImportanceSampler_Sample_GivenCheckerboardWithBlackCells_NeverReturnsBlackPixel)
+    {
+        // Rows must be very wide for rounding errors to accumulate while building the alias tables.
+        const size_t Width = 1 << 17;
+        const size_t Height = 3;
+
+        AliasImageImportanceSampler<BlackCellsCheckerboardSampler::Payload, float> importance_sampler(Width, Height);
+        BlackCellsCheckerboardSampler sampler;
+        importance_sampler.rebuild(sampler);
+
+        size_t zero_probability_count = 0;
+        size_t black_pixel_count = 0;
+
+        // Hit every entry of the alias tables.
+        for (size_t j = 0; j < Height; ++j)
+        {
+            for (size_t i = 0; i < Width; ++i)
+            {
+                const Vector2f s(
+                    (i + 0.5f) / Width,
+                    (j + 0.5f) / Height);
+
+                size_t x, y;
+                float prob_xy;
+                importance_sampler.sample(s, x, y, prob_xy);
+
+                if (prob_xy <= 0.0f)
+                    ++zero_probability_count;
+
+                BlackCellsCheckerboardSampler::Payload payload;
+                float importance;
+                sampler.sample(x, y, payload, importance);
+
+                if (importance == 0.0f)
+                    ++black_pixel_count;
+            }
+        }
+
+        EXPECT_EQ(0, zero_probability_count);
+        EXPECT_EQ(0, black_pixel_count);
+    }
 }
@@ -0,0 +1,152 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/intersection/rayobbpacket.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_Intersection_RayOBBPacket)
+{
+    // A unit cube rotated by 45 degrees around the Z axis.
+    template <typename T, size_t Width>
+    void add_rotated_cube(OBBPacket<T, Width>& packet, const T offset_x)
+    {
+        typedef Vector<T, 3> VectorType;
+
+        const T s = sqrt(T(0.5));
+        const VectorType axes[3] =
+        {
+            VectorType(s, s, T(0.0)),
+            VectorType(-s, s, T(0.0)),
+            VectorType(T(0.0), T(0.0), T(1.0))
+        };
+
+        // Express the offset along the axes of the cube.
+        const VectorType center(s * offset_x, -s * offset_x, T(0.0));
+        packet.add_box(axes, AABB<T, 3>(center - VectorType(T(0.5)), center + VectorType(T(0.5))));
+    }
+
+    template <typename T, size_t Width>
+    size_t test_ray_piercing_rotated_box()
+    {
+        OBBPacket<T, Width> packet;
+        packet.clear();
+        add_rotated_cube(packet, T(0.0));
+
+        // The corners of the rotated cube are at a distance of sqrt(0.5) from its center.
+        const Ray<T, 3> ray(Vector<T, 3>(T(0.65), T(0.0), T(2.0)), Vector<T, 3>(T(0.0), T(0.0), T(-1.0)));
+        const RayOBBPacketTester<T, Width> tester(ray);
+
+        return tester.test(packet, ray.m_tmax);
+    }
+
+    template <typename T, size_t Width>
+    size_t test_ray_missing_rotated_box_but_piercing_its_aabb()
+    {
+        OBBPacket<T, Width> packet;
+        packet.clear();
+        add_rotated_cube(packet, T(0.0));
+
+        const Ray<T, 3> ray(Vector<T, 3>(T(0.6), T(0.6), T(2.0)), Vector<T, 3>(T(0.0), T(0.0), T(-1.0)));
+        const RayOBBPacketTester<T, Width> tester(ray);
+
+        return tester.test(packet, ray.m_tmax);
+    }
+
+    template <typename T, size_t Width>
+    void add_row_of_rotated_cubes(OBBPacket<T, Width>& packet)
+    {
+        add_rotated_cube(packet, T(-3.0));
+        add_rotated_cube(packet, T(0.0));
+        add_rotated_cube(packet, T(3.0));
+    }
+
+    template <typename T, size_t Width>
+    size_t test_ray_along_row_of_boxes(const T ray_tmax)
+    {
+        OBBPacket<T, Width> packet;
+        packet.clear();
+        add_row_of_rotated_cubes(packet);
+
+        const Ray<T, 3> ray(Vector<T, 3>(T(-10.0), T(0.0), T(0.0)), Vector<T, 3>(T(1.0), T(0.0), T(0.0)));
+        const RayOBBPacketTester<T, Width> tester(ray);
+
+        return tester.test(packet, ray_tmax);
+    }
+
+    // The <float, 4>, <float, 8> and <double, 4> testers are specialized when SSE
+    // is enabled, while <double, 8> always falls back to the scalar implementation.
+
+    TEST_CASE(Test_GivenRayPiercingRotatedBox_ReturnsHit)
+    {
+        EXPECT_EQ(1, (test_ray_piercing_rotated_box<float, 4>()));
+        EXPECT_EQ(1, (test_ray_piercing_rotated_box<float, 8>()));
+        EXPECT_EQ(1, (test_ray_piercing_rotated_box<double, 4>()));
+        EXPECT_EQ(1, (test_ray_piercing_rotated_box<double, 8>()));
+    }
+
+    TEST_CASE(Test_GivenRayMissingRotatedBoxButPiercingItsAABB_ReturnsNoHit)
+    {
+        EXPECT_EQ(0, (test_ray_missing_rotated_box_but_piercing_its_aabb<float, 4>()));
+        EXPECT_EQ(0, (test_ray_missing_rotated_box_but_piercing_its_aabb<float, 8>()));
+        EXPECT_EQ(0, (test_ray_missing_rotated_box_but_piercing_its_aabb<double, 4>()));
+        EXPECT_EQ(0, (test_ray_missing_rotated_box_but_piercing_its_aabb<double, 8>()));
+    }
+
+    TEST_CASE(Test_GivenSeveralBoxes_ReturnsMaskOfBoxesHit)
+    {
+        OBBPacket<float, 4> packet;
+        packet.clear();
+        add_row_of_rotated_cubes(packet);
+        EXPECT_EQ(3, packet.get_box_count());
+
+        EXPECT_EQ(7, (test_ray_along_row_of_boxes<float, 4>(numeric_limits<float>::max())));
+        EXPECT_EQ(7, (test_ray_along_row_of_boxes<float, 8>(numeric_limits<float>::max())));
+        EXPECT_EQ(7, (test_ray_along_row_of_boxes<double, 4>(numeric_limits<double>::max())));
+        EXPECT_EQ(7, (test_ray_along_row_of_boxes<double, 8>(numeric_limits<double>::max())));
+    }
+
+    TEST_CASE(Test_GivenBoxesBeyondRayTMax_IgnoresThem)
+    {
+        EXPECT_EQ(1, (test_ray_along_row_of_boxes<float, 4>(8.0f)));
+        EXPECT_EQ(1, (test_ray_along_row_of_boxes<float, 8>(8.0f)));
+        EXPECT_EQ(1, (test_ray_along_row_of_boxes<double, 4>(8.0)));
+        EXPECT_EQ(1, (test_ray_along_row_of_boxes<double, 8>(8.0)));
+    }
+}
@@ -224,7 +224,7 @@ TEST_SUITE(Foundation_Utility_Job_JobQueue)
     {
         JobQueue job_queue;
 
-        EXPECT_EQ(0, job_queue.acquire_scheduled_job().first.m_job);
+        EXPECT_EQ(0, job_queue.acquire_scheduled_job().m_job);
     }
 
     TEST_CASE(AcquireScheduledJobWorksOnNonEmptyJobQueue)
@@ -237,7 +237,7 @@ TEST_SUITE(Foundation_Utility_Job_JobQueue)
         const JobQueue::RunningJobInfo running_job_info =
             job_queue.acquire_scheduled_job();
 
-        EXPECT_EQ(job, running_job_info.first.m_job);
+        EXPECT_EQ(job, running_job_info.m_job);
 
         EXPECT_FALSE(job_queue.has_scheduled_jobs());
         EXPECT_TRUE(job_queue.has_running_jobs());
@@ -334,6 +334,35 @@ TEST_SUITE(Foundation_Utility_Job_JobManager)
         volatile uint32*    m_execution_count;
     };
 
+    class JobCreatingManyJobs
+      : public IJob
+    {
+      public:
+        JobCreatingManyJobs(
+            JobQueue&           job_queue,
+            const size_t        job_count,
+            volatile uint32*    execution_count)
+          : m_job_queue(job_queue)
+          , m_job_count(job_count)
+          , m_execution_count(execution_count)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            for (size_t i = 0; i < m_job_count; ++i)
+            {
+                m_job_queue.schedule(
+                    new JobNotifyingAboutExecution(m_execution_count));
+            }
+        }
+
+      private:
+        JobQueue&           m_job_queue;
+        const size_t        m_job_count;
+        volatile uint32*    m_execution_count;
+    };
+
     TEST_CASE_F(InitialStateIsCorrect, FixtureJobManager)
     {
         EXPECT_EQ(1, job_manager.get_thread_count());
@@ -374,6 +403,32 @@ TEST_SUITE(Foundation_Utility_Job_JobManager)
 
         EXPECT_EQ(1, execution_count);
     }
+
+    TEST_CASE(JobManagerWithMultipleThreadsExecutesAllSubJobs)
+    {
+        // Sub-jobs go to the deque of the worker thread that schedules them and
+        // more sub-jobs are scheduled than a single deque can hold.
+        const size_t JobCount = 8;
+        const size_t SubJobCount = 1500;
+
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(logger, job_queue, 4);
+
+        volatile uint32 execution_count = 0;
+
+        for (size_t i = 0; i < JobCount; ++i)
+        {
+            job_queue.schedule(
+                new JobCreatingManyJobs(job_queue, SubJobCount, &execution_count));
+        }
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        EXPECT_EQ(JobCount * SubJobCount, execution_count);
+        EXPECT_FALSE(job_queue.has_scheduled_or_running_jobs());
+    }
 }
 
 TEST_SUITE(Foundation_Utility_Job_WorkerThread)
@@ -37,6 +37,7 @@
 #include "foundation/math/vector.h"
 #include "foundation/platform/timers.h"
 #include "foundation/utility/iostreamop.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
@@ -141,6 +142,56 @@ TEST_SUITE(Foundation_Math_Knn_Builder)
         knn::Builder3d builder(tree);
         builder.build<DefaultWallclockTimer>(points, PointCount);
     }
+
+    TEST_CASE(BuildMovePoints_GivenMultipleThreads_BuildsSameTreeAsSingleThreadedBuild)
+    {
+        const size_t PointCount = 50000;
+
+        MersenneTwister rng;
+
+        vector<Vector3d> points;
+        points.reserve(PointCount);
+        for (size_t i = 0; i < PointCount; ++i)
+            points.push_back(rand_vector1<Vector3d>(rng));
+
+        // Add coincident points to exercise degenerate partitions.
+        for (size_t i = 0; i < 100; ++i)
+            points[i] = points[0];
+
+        vector<Vector3d> serial_points(points);
+        knn::Tree3d serial_tree;
+        knn::Builder3d serial_builder(serial_tree);
+        serial_builder.build_move_points<DefaultWallclockTimer>(serial_points);
+
+        Logger logger;
+        vector<Vector3d> parallel_points(points);
+        knn::Tree3d parallel_tree;
+        knn::Builder3d parallel_builder(parallel_tree);
+        parallel_builder.build_move_points<DefaultWallclockTimer>(parallel_points, logger, 4);
+
+        ASSERT_EQ(serial_tree.m_nodes.size(), parallel_tree.m_nodes.size());
+
+        bool identical = serial_tree.m_indices == parallel_tree.m_indices;
+
+        for (size_t i = 0, e = serial_tree.m_nodes.size(); i < e; ++i)
+        {
+            const knn::Tree3d::NodeType& lhs = serial_tree.m_nodes[i];
+            const knn::Tree3d::NodeType& rhs = parallel_tree.m_nodes[i];
+
+            if (lhs.is_leaf() != rhs.is_leaf() ||
+                lhs.get_point_index() != rhs.get_point_index() ||
+                lhs.get_point_count() != rhs.get_point_count())
+                identical = false;
+
+            if (lhs.is_interior() &&
+                (lhs.get_child_node_index() != rhs.get_child_node_index() ||
+                 lhs.get_split_dim() != rhs.get_split_dim() ||
+                 lhs.get_split_abs() != rhs.get_split_abs()))
+                identical = false;
+        }
+
+        EXPECT_TRUE(identical);
+    }
 }
 
 TEST_SUITE(Foundation_Math_Knn_Answer)
@@ -444,3 +495,82 @@ TEST_SUITE(Foundation_Math_Knn_Query)
         EXPECT_TRUE(do_results_match_naive_algorithm(points, AnswerSize, QueryCount, rng));
     }
 }
+
+TEST_SUITE(Foundation_Math_Knn_RangeQuery)
+{
+    TEST_CASE(Run_GivenMaxSearchDistance_ReturnsAllPointsWithinDistance)
+    {
+        const size_t PointCount = 1000;
+        const size_t QueryCount = 200;
+        const size_t AnswerSize = 1000;
+        const double QueryMaxSquareDistance = square(0.2);
+
+        MersenneTwister rng;
+
+        vector<Vector3d> points;
+        points.reserve(PointCount);
+        for (size_t i = 0; i < PointCount; ++i)
+            points.push_back(rand_vector1<Vector3d>(rng));
+
+        knn::Tree3d tree;
+        knn::Builder3d builder(tree);
+        builder.build<DefaultWallclockTimer>(&points[0], PointCount);
+
+        knn::Answer<double> answer(AnswerSize);
+        knn::RangeQuery3d query(tree, answer);
+
+        bool correct = true;
+
+        for (size_t i = 0; i < QueryCount; ++i)
+        {
+            const Vector3d q = rand_vector1<Vector3d>(rng);
+
+            if (!query.run(q, QueryMaxSquareDistance))
+                correct = false;
+
+            vector<size_t> found;
+            for (size_t j = 0, e = answer.size(); j < e; ++j)
+            {
+                const knn::Answer<double>::Entry& entry = answer.get(j);
+                if (entry.m_square_dist != square_distance(q, points[tree.remap(entry.m_index)]))
+                    correct = false;
+                found.push_back(tree.remap(entry.m_index));
+            }
+            sort(found.begin(), found.end());
+
+            vector<size_t> expected;
+            for (size_t j = 0; j < PointCount; ++j)
+            {
+                if (square_distance(q, points[j]) <= QueryMaxSquareDistance)
+                    expected.push_back(j);
+            }
+
+            if (found != expected)
+                correct = false;
+        }
+
+        EXPECT_TRUE(correct);
+    }
+
+    TEST_CASE(Run_GivenTooManyPointsWithinDistance_ReturnsFalse)
+    {
+        const size_t PointCount = 8;
+        const size_t AnswerSize = 4;
+
+        Vector3d points[PointCount];
+        for (size_t i = 0; i < PointCount; ++i)
+            points[i] = Vector3d(static_cast<double>(i), 0.0, 0.0);
+
+        knn::Tree3d tree;
+        knn::Builder3d builder(tree);
+        builder.build<DefaultWallclockTimer>(points, PointCount);
+
+        knn::Answer<double> answer(AnswerSize);
+        knn::RangeQuery3d query(tree, answer);
+
+        EXPECT_TRUE(query.run(Vector3d(0.0, 0.0, 0.0), square(2.5)));
+        EXPECT_EQ(3, answer.size());
+
+        EXPECT_FALSE(query.run(Vector3d(3.5, 0.0, 0.0), square(4.0)));
+    }
+}
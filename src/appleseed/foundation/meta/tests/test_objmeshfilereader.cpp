@@ -32,10 +32,14 @@
 #include "foundation/mesh/meshbuilderbase.h"
 #include "foundation/mesh/objmeshfilereader.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/utility/log.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
 #include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -121,4 +125,219 @@ TEST_SUITE(Foundation_Mesh_OBJMeshFileReader)
         EXPECT_EQ(4, mesh.m_tex_coords.size());
         EXPECT_EQ(1, mesh.m_faces.size());
     }
+
+    // Record all calls made to the builder.
+    struct RecordingMeshBuilder
+      : public IMeshBuilder
+    {
+        stringstream        m_log;
+        size_t              m_vertex_count;
+
+        RecordingMeshBuilder()
+          : m_vertex_count(0)
+        {
+            m_log << setprecision(17);
+        }
+
+        void begin_mesh(const char* name) override
+        {
+            m_log << "begin_mesh " << name << "\n";
+        }
+
+        size_t push_vertex(const Vector3d& v) override
+        {
+            m_log << "push_vertex " << v.x << " " << v.y << " " << v.z << "\n";
+            return 0;
+        }
+
+        size_t push_vertex_normal(const Vector3d& v) override
+        {
+            m_log << "push_vertex_normal " << v.x << " " << v.y << " " << v.z << "\n";
+            return 0;
+        }
+
+        size_t push_tex_coords(const Vector2d& v) override
+        {
+            m_log << "push_tex_coords " << v.x << " " << v.y << "\n";
+            return 0;
+        }
+
+        size_t push_material_slot(const char* name) override
+        {
+            m_log << "push_material_slot " << name << "\n";
+            return 0;
+        }
+
+        void begin_face(const size_t vertex_count) override
+        {
+            m_log << "begin_face " << vertex_count << "\n";
+            m_vertex_count = vertex_count;
+        }
+
+        void set_face_vertices(const size_t vertices[]) override
+        {
+            log_indices("set_face_vertices", vertices);
+        }
+
+        void set_face_vertex_normals(const size_t vertex_normals[]) override
+        {
+            log_indices("set_face_vertex_normals", vertex_normals);
+        }
+
+        void set_face_vertex_tex_coords(const size_t tex_coords[]) override
+        {
+            log_indices("set_face_vertex_tex_coords", tex_coords);
+        }
+
+        void set_face_material(const size_t material) override
+        {
+            m_log << "set_face_material " << material << "\n";
+        }
+
+        void end_face() override
+        {
+            m_log << "end_face\n";
+        }
+
+        void end_mesh() override
+        {
+            m_log << "end_mesh\n";
+        }
+
+        void log_indices(const char* name, const size_t indices[])
+        {
+            m_log << name;
+
+            for (size_t i = 0; i < m_vertex_count; ++i)
+                m_log << " " << indices[i];
+
+            m_log << "\n";
+        }
+    };
+
+    // Write a file large enough to be parsed in several chunks.
+    void write_large_obj_file(const char* filename, const char* bad_line = 0)
+    {
+        const size_t GridSize = 40;
+
+        ofstream file(filename);
+        file << "# Large test file.\n";
+        file << setprecision(9);
+
+        for (size_t object = 0; object < 12; ++object)
+        {
+            file << (object % 2 == 0 ? "o" : "g") << " object " << object / 2 << "\n";
+            file << "\n";
+
+            for (size_t y = 0; y <= GridSize; ++y)
+            {
+                for (size_t x = 0; x <= GridSize; ++x)
+                {
+                    file << "v " << x * 0.1 << " " << y * 0.3 << " " << object * 0.7 << "\n";
+                    file << "  vt\t" << x * 0.025 << " " << y * 0.025 << " 0\n";
+                    file << "vn 0.1 " << object + 1 << " " << x * 1.5 << "   # normal\n";
+                }
+            }
+
+            if (object == 7 && bad_line)
+                file << bad_line << "\n";
+
+            const long row = GridSize + 1;
+            const long count = row * row;
+
+            for (long y = 0; y < GridSize; ++y)
+            {
+                if (y % 10 == 0)
+                    file << "usemtl material " << (y / 10) % 3 << "\n";
+
+                for (long x = 0; x < GridSize; ++x)
+                {
+                    const long i = y * row + x;
+                    const long a = i - count, b = a + 1, c = a + row + 1, d = a + row;
+
+                    if (object % 3 == 0)
+                        file << "f " << a << "/" << a << "/" << a << " " << b << "/" << b << "/" << b << " " << c << "/" << c << "/" << c << "\n";
+                    else if (object % 3 == 1)
+                        file << "f " << a << "//" << a << " " << b << "//" << b << " " << c << "//" << c << " " << d << "//" << d << "\n";
+                    else file << "f " << a << " " << b << " " << c << " " << d << "\n";
+                }
+            }
+
+            // Group repeating the name of the current mesh.
+            file << "g object " << object / 2 << "\n";
+        }
+    }
+
+    string read_obj_file(const char* filename, const int options)
+    {
+        RecordingMeshBuilder builder;
+        Logger logger;
+        OBJMeshFileReader reader(filename, options, logger, 4);
+
+        try
+        {
+            reader.read(builder);
+        }
+        catch (const OBJMeshFileReader::ExceptionInvalidFaceDef& e)
+        {
+            builder.m_log << "invalid face definition on line " << e.m_line << "\n";
+        }
+        catch (const OBJMeshFileReader::ExceptionParseError& e)
+        {
+            builder.m_log << "parse error on line " << e.m_line << "\n";
+        }
+
+        return builder.m_log.str();
+    }
+
+    TEST_CASE(ReadLargeFile_ParallelParsing_MatchesSequentialParsing)
+    {
+        const char* Filename = "unit tests/outputs/test_objmeshfilereader_large.obj";
+        write_large_obj_file(Filename);
+
+        const string expected = read_obj_file(Filename, OBJMeshFileReader::Default);
+        const string result = read_obj_file(Filename, OBJMeshFileReader::ParallelParsing);
+
+        EXPECT_TRUE(expected == result);
+    }
+
+    TEST_CASE(ReadLargeFileWithParseError_ParallelParsing_MatchesSequentialParsing)
+    {
+        const char* Filename = "unit tests/outputs/test_objmeshfilereader_large_parseerror.obj";
+        write_large_obj_file(Filename, "f 1 2 x");
+
+        const string expected = read_obj_file(Filename, OBJMeshFileReader::Default);
+        const string result = read_obj_file(Filename, OBJMeshFileReader::ParallelParsing);
+
+        EXPECT_NEQ(string::npos, expected.find("parse error"));
+        EXPECT_TRUE(expected == result);
+    }
+
+    TEST_CASE(ReadLargeFileWithInvalidFaceDef_ParallelParsing_MatchesSequentialParsing)
+    {
+        const char* Filename = "unit tests/outputs/test_objmeshfilereader_large_invalidfacedef.obj";
+        write_large_obj_file(Filename, "f 1 2");
+
+        const string expected =
+            read_obj_file(
+                Filename,
+                OBJMeshFileReader::StopOnInvalidFaceDef);
+        const string result =
+            read_obj_file(
+                Filename,
+                OBJMeshFileReader::StopOnInvalidFaceDef | OBJMeshFileReader::ParallelParsing);
+
+        EXPECT_NEQ(string::npos, expected.find("invalid face definition"));
+        EXPECT_TRUE(expected == result);
+    }
+
+    TEST_CASE(ReadSmallFile_ParallelParsing_MatchesSequentialParsing)
+    {
+        const char* Filename = "unit tests/inputs/test_objmeshfilereader_cube.obj";
+
+        const string expected = read_obj_file(Filename, OBJMeshFileReader::Default);
+        const string result = read_obj_file(Filename, OBJMeshFileReader::ParallelParsing);
+
+        EXPECT_EQ(expected, result);
+    }
 }
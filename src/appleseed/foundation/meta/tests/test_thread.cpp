@@ -44,6 +44,44 @@ TEST_SUITE(Foundation_Platform_Thread)
         sleep(1000 * 3600, abort_switch);
     }
 
+    TEST_CASE(SetCurrentThreadPlacement_NoPlacement_ReturnsFalse)
+    {
+        EXPECT_FALSE(set_current_thread_placement(ThreadPlacementNone, 0));
+    }
+
+    TEST_CASE(GetNumaNodeCount_ReturnsAtLeastOneNode)
+    {
+        EXPECT_GT(0, get_numa_node_count());
+    }
+
+#ifdef __linux__
+
+    void pin_current_thread(const ThreadPlacement placement, bool* success)
+    {
+        *success = set_current_thread_placement(placement, 1);
+    }
+
+    TEST_CASE(SetCurrentThreadPlacement_CompactPlacementOnLinux_ReturnsTrue)
+    {
+        // Pin a separate thread to leave the affinity of the test runner untouched.
+        bool success = false;
+        boost::thread thread(pin_current_thread, ThreadPlacementCompact, &success);
+        thread.join();
+
+        EXPECT_TRUE(success);
+    }
+
+    TEST_CASE(SetCurrentThreadPlacement_ScatterPlacementOnLinux_ReturnsTrue)
+    {
+        bool success = false;
+        boost::thread thread(pin_current_thread, ThreadPlacementScatter, &success);
+        thread.join();
+
+        EXPECT_TRUE(success);
+    }
+
+#endif
+
 #ifdef EXPLORATION_TESTS
 
     TEST_CASE(Sleep_CheckElapsedTime)
@@ -0,0 +1,207 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_PLATFORM_SIMDPACK_H
+#define APPLESEED_FOUNDATION_PLATFORM_SIMDPACK_H
+
+#ifndef APPLESEED_USE_SSE
+    #error SSE support not enabled.
+#endif
+
+// appleseed.foundation headers.
+#include "foundation/platform/sse.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// Thin wrappers around SIMD instructions, so that a single implementation
+// of an algorithm can be used with all instruction sets.
+//
+// WideFloatPack and WideDoublePack are the widest packs supported by the
+// instruction sets enabled at compile time.
+//
+
+struct SSEFloat4
+{
+    typedef float ValueType;
+    typedef __m128 VectorType;
+    static const size_t Lanes = 4;
+    static const int AllLanes = 0xF;
+
+    static VectorType set1(const float x)                       { return _mm_set1_ps(x); }
+    static VectorType load(const float* p)                      { return _mm_load_ps(p); }
+    static void store(float* p, const VectorType x)             { _mm_store_ps(p, x); }
+    static VectorType add(const VectorType a, const VectorType b) { return _mm_add_ps(a, b); }
+    static VectorType sub(const VectorType a, const VectorType b) { return _mm_sub_ps(a, b); }
+    static VectorType mul(const VectorType a, const VectorType b) { return _mm_mul_ps(a, b); }
+    static VectorType div(const VectorType a, const VectorType b) { return _mm_div_ps(a, b); }
+    static VectorType min(const VectorType a, const VectorType b) { return _mm_min_ps(a, b); }
+    static VectorType max(const VectorType a, const VectorType b) { return _mm_max_ps(a, b); }
+
+    // Return a bitmask of the lanes where the interval [tmin, tmax] is empty
+    // or does not overlap the interval [ray_tmin, ray_tmax).
+    static int misses(
+        const VectorType tmin,
+        const VectorType tmax,
+        const VectorType ray_tmin,
+        const VectorType ray_tmax)
+    {
+        return
+            _mm_movemask_ps(
+                _mm_or_ps(
+                    _mm_cmpgt_ps(tmin, tmax),
+                    _mm_or_ps(
+                        _mm_cmplt_ps(tmax, ray_tmin),
+                        _mm_cmpge_ps(tmin, ray_tmax))));
+    }
+};
+
+struct SSEDouble2
+{
+    typedef double ValueType;
+    typedef __m128d VectorType;
+    static const size_t Lanes = 2;
+    static const int AllLanes = 0x3;
+
+    static VectorType set1(const double x)                      { return _mm_set1_pd(x); }
+    static VectorType load(const double* p)                     { return _mm_load_pd(p); }
+    static void store(double* p, const VectorType x)            { _mm_store_pd(p, x); }
+    static VectorType add(const VectorType a, const VectorType b) { return _mm_add_pd(a, b); }
+    static VectorType sub(const VectorType a, const VectorType b) { return _mm_sub_pd(a, b); }
+    static VectorType mul(const VectorType a, const VectorType b) { return _mm_mul_pd(a, b); }
+    static VectorType div(const VectorType a, const VectorType b) { return _mm_div_pd(a, b); }
+    static VectorType min(const VectorType a, const VectorType b) { return _mm_min_pd(a, b); }
+    static VectorType max(const VectorType a, const VectorType b) { return _mm_max_pd(a, b); }
+
+    // Return a bitmask of the lanes where the interval [tmin, tmax] is empty
+    // or does not overlap the interval [ray_tmin, ray_tmax).
+    static int misses(
+        const VectorType tmin,
+        const VectorType tmax,
+        const VectorType ray_tmin,
+        const VectorType ray_tmax)
+    {
+        return
+            _mm_movemask_pd(
+                _mm_or_pd(
+                    _mm_cmpgt_pd(tmin, tmax),
+                    _mm_or_pd(
+                        _mm_cmplt_pd(tmax, ray_tmin),
+                        _mm_cmpge_pd(tmin, ray_tmax))));
+    }
+};
+
+#ifdef APPLESEED_USE_AVX
+
+struct AVXFloat8
+{
+    typedef float ValueType;
+    typedef __m256 VectorType;
+    static const size_t Lanes = 8;
+    static const int AllLanes = 0xFF;
+
+    static VectorType set1(const float x)                       { return _mm256_set1_ps(x); }
+    static VectorType load(const float* p)                      { return _mm256_load_ps(p); }
+    static void store(float* p, const VectorType x)             { _mm256_store_ps(p, x); }
+    static VectorType add(const VectorType a, const VectorType b) { return _mm256_add_ps(a, b); }
+    static VectorType sub(const VectorType a, const VectorType b) { return _mm256_sub_ps(a, b); }
+    static VectorType mul(const VectorType a, const VectorType b) { return _mm256_mul_ps(a, b); }
+    static VectorType div(const VectorType a, const VectorType b) { return _mm256_div_ps(a, b); }
+    static VectorType min(const VectorType a, const VectorType b) { return _mm256_min_ps(a, b); }
+    static VectorType max(const VectorType a, const VectorType b) { return _mm256_max_ps(a, b); }
+
+    // Return a bitmask of the lanes where the interval [tmin, tmax] is empty
+    // or does not overlap the interval [ray_tmin, ray_tmax).
+    static int misses(
+        const VectorType tmin,
+        const VectorType tmax,
+        const VectorType ray_tmin,
+        const VectorType ray_tmax)
+    {
+        return
+            _mm256_movemask_ps(
+                _mm256_or_ps(
+                    _mm256_cmp_ps(tmin, tmax, _CMP_GT_OQ),
+                    _mm256_or_ps(
+                        _mm256_cmp_ps(tmax, ray_tmin, _CMP_LT_OQ),
+                        _mm256_cmp_ps(tmin, ray_tmax, _CMP_GE_OQ))));
+    }
+};
+
+struct AVXDouble4
+{
+    typedef double ValueType;
+    typedef __m256d VectorType;
+    static const size_t Lanes = 4;
+    static const int AllLanes = 0xF;
+
+    static VectorType set1(const double x)                      { return _mm256_set1_pd(x); }
+    static VectorType load(const double* p)                     { return _mm256_load_pd(p); }
+    static void store(double* p, const VectorType x)            { _mm256_store_pd(p, x); }
+    static VectorType add(const VectorType a, const VectorType b) { return _mm256_add_pd(a, b); }
+    static VectorType sub(const VectorType a, const VectorType b) { return _mm256_sub_pd(a, b); }
+    static VectorType mul(const VectorType a, const VectorType b) { return _mm256_mul_pd(a, b); }
+    static VectorType div(const VectorType a, const VectorType b) { return _mm256_div_pd(a, b); }
+    static VectorType min(const VectorType a, const VectorType b) { return _mm256_min_pd(a, b); }
+    static VectorType max(const VectorType a, const VectorType b) { return _mm256_max_pd(a, b); }
+
+    // Return a bitmask of the lanes where the interval [tmin, tmax] is empty
+    // or does not overlap the interval [ray_tmin, ray_tmax).
+    static int misses(
+        const VectorType tmin,
+        const VectorType tmax,
+        const VectorType ray_tmin,
+        const VectorType ray_tmax)
+    {
+        return
+            _mm256_movemask_pd(
+                _mm256_or_pd(
+                    _mm256_cmp_pd(tmin, tmax, _CMP_GT_OQ),
+                    _mm256_or_pd(
+                        _mm256_cmp_pd(tmax, ray_tmin, _CMP_LT_OQ),
+                        _mm256_cmp_pd(tmin, ray_tmax, _CMP_GE_OQ))));
+    }
+};
+
+typedef AVXFloat8 WideFloatPack;
+typedef AVXDouble4 WideDoublePack;
+
+#else
+
+typedef SSEFloat4 WideFloatPack;
+typedef SSEDouble2 WideDoublePack;
+
+#endif  // APPLESEED_USE_AVX
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_PLATFORM_SIMDPACK_H
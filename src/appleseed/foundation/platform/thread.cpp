@@ -33,6 +33,7 @@
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/snprintf.h"
 #ifdef _WIN32
 #include "foundation/platform/windows.h"
 #endif
@@ -44,6 +45,8 @@
 
 // Standard headers.
 #include <cassert>
+#include <cstdio>
+#include <vector>
 
 // Platform headers.
 #if defined __APPLE__
@@ -52,6 +55,7 @@
 #include <pthread.h>
 #include <pthread_np.h>
 #elif defined __linux__
+#include <sched.h>
 #include <sys/prctl.h>
 #endif
 
@@ -167,6 +171,194 @@ void yield()
 }
 
 
+//
+// Thread placement implementation.
+//
+
+const char* get_thread_placement_name(const ThreadPlacement placement)
+{
+    switch (placement)
+    {
+      case ThreadPlacementNone: return "none";
+      case ThreadPlacementCompact: return "compact";
+      case ThreadPlacementScatter: return "scatter";
+      default: return "unknown";
+    }
+}
+
+namespace
+{
+    typedef std::vector<std::vector<size_t>> NumaTopology;    // logical CPU cores of each NUMA node
+
+#ifdef __linux__
+
+    // Parse a CPU list such as "0-3,8,10-11".
+    void parse_cpu_list(const char* str, std::vector<size_t>& cpus)
+    {
+        while (*str != '\0' && *str != '\n')
+        {
+            unsigned int first, last;
+            int consumed;
+
+            if (sscanf(str, "%u-%u%n", &first, &last, &consumed) == 2)
+                str += consumed;
+            else if (sscanf(str, "%u%n", &first, &consumed) == 1)
+            {
+                last = first;
+                str += consumed;
+            }
+            else break;
+
+            for (unsigned int cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+
+            if (*str == ',')
+                ++str;
+        }
+    }
+
+    NumaTopology compute_numa_topology()
+    {
+        // Only consider the cores this process is allowed to run on.
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+            return NumaTopology();
+
+        NumaTopology topology;
+
+        // Node numbers may not be contiguous; don't stop at the first missing node.
+        for (size_t node = 0, missing = 0; missing < 64; ++node)
+        {
+            char path[64];
+            portable_snprintf(path, sizeof(path), "/sys/devices/system/node/node%lu/cpulist", (long unsigned int)node);
+
+            FILE* file = fopen(path, "r");
+            if (file == nullptr)
+            {
+                ++missing;
+                continue;
+            }
+
+            char line[4096];
+            const bool success = fgets(line, sizeof(line), file) != nullptr;
+            fclose(file);
+
+            if (!success)
+                continue;
+
+            std::vector<size_t> cpus;
+            parse_cpu_list(line, cpus);
+
+            std::vector<size_t> node_cpus;
+            for (const size_t cpu : cpus)
+            {
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+                    node_cpus.push_back(cpu);
+            }
+
+            if (!node_cpus.empty())
+                topology.push_back(node_cpus);
+        }
+
+        // Kernels without NUMA support: a single node with all allowed cores.
+        if (topology.empty())
+        {
+            std::vector<size_t> cpus;
+            for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &allowed))
+                    cpus.push_back(cpu);
+            }
+
+            if (!cpus.empty())
+                topology.push_back(cpus);
+        }
+
+        return topology;
+    }
+
+#endif
+
+    const NumaTopology& get_numa_topology()
+    {
+#ifdef __linux__
+        static const NumaTopology topology = compute_numa_topology();
+#else
+        static const NumaTopology topology;
+#endif
+        return topology;
+    }
+
+    bool select_cpu(
+        const NumaTopology&     topology,
+        const ThreadPlacement   placement,
+        const size_t            thread_index,
+        size_t&                 cpu)
+    {
+        if (topology.empty())
+            return false;
+
+        switch (placement)
+        {
+          case ThreadPlacementCompact:
+            {
+                size_t cpu_count = 0;
+                for (const std::vector<size_t>& node_cpus : topology)
+                    cpu_count += node_cpus.size();
+
+                size_t index = thread_index % cpu_count;
+                for (const std::vector<size_t>& node_cpus : topology)
+                {
+                    if (index < node_cpus.size())
+                    {
+                        cpu = node_cpus[index];
+                        return true;
+                    }
+
+                    index -= node_cpus.size();
+                }
+            }
+            return false;
+
+          case ThreadPlacementScatter:
+            {
+                const std::vector<size_t>& node_cpus = topology[thread_index % topology.size()];
+                cpu = node_cpus[(thread_index / topology.size()) % node_cpus.size()];
+            }
+            return true;
+
+          default:
+            return false;
+        }
+    }
+}
+
+size_t get_numa_node_count()
+{
+    const size_t node_count = get_numa_topology().size();
+    return node_count > 1 ? node_count : 1;
+}
+
+bool set_current_thread_placement(
+    const ThreadPlacement   placement,
+    const size_t            thread_index)
+{
+    size_t cpu;
+    if (!select_cpu(get_numa_topology(), placement, thread_index, cpu))
+        return false;
+
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#else
+    return false;
+#endif
+}
+
+
 //
 // ProcessPriorityContext class implementation (Windows).
 //
@@ -44,6 +44,9 @@
 #include "boost/thread/mutex.hpp"
 #include "boost/thread/thread.hpp"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class Logger; }
@@ -67,6 +70,34 @@ APPLESEED_DLLSYMBOL void sleep(const uint32 ms, IAbortSwitch& abort_switch);
 APPLESEED_DLLSYMBOL void yield();
 
 
+//
+// Thread placement.
+//
+// On NUMA systems, pinning threads to cores keeps them close to the memory they
+// allocate: pages are physically allocated on the node of the thread that first
+// writes them. Thread placement is currently only implemented on Linux.
+//
+
+enum ThreadPlacement
+{
+    ThreadPlacementNone,        // let the operating system schedule threads
+    ThreadPlacementCompact,     // fill the cores of one NUMA node before moving to the next one
+    ThreadPlacementScatter      // distribute threads round-robin across NUMA nodes
+};
+
+// Return the name of a thread placement policy.
+APPLESEED_DLLSYMBOL const char* get_thread_placement_name(const ThreadPlacement placement);
+
+// Return the number of NUMA nodes that have logical CPU cores available to this process.
+APPLESEED_DLLSYMBOL size_t get_numa_node_count();
+
+// Pin the current thread to a logical CPU core chosen according to a placement policy
+// and to the index of the thread among its peers. Return true on success.
+APPLESEED_DLLSYMBOL bool set_current_thread_placement(
+    const ThreadPlacement   placement,
+    const size_t            thread_index);
+
+
 //
 // A simple spinlock.
 //
@@ -0,0 +1,97 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "arena.h"
+
+// Standard headers.
+#include <algorithm>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// Arena class implementation.
+//
+
+struct Arena::Page
+{
+    Page*       m_next;
+    size_t      m_size;     // capacity of the page in bytes
+    uint8*      m_storage;
+};
+
+Arena::~Arena()
+{
+    Page* page = m_first_page;
+
+    while (page)
+    {
+        Page* next = page->m_next;
+        aligned_free(page->m_storage);
+        delete page;
+        page = next;
+    }
+}
+
+void* Arena::allocate_overflow(const size_t size)
+{
+    // Account for what was allocated in the page we're leaving.
+    m_previous_pages_size += static_cast<size_t>(m_current - m_begin);
+
+    // Reuse the next page of the chain if it is large enough,
+    // otherwise insert a new page right after the current one.
+    Page* next = m_current_page ? m_current_page->m_next : m_first_page;
+
+    if (next == nullptr || next->m_size < size)
+    {
+        Page* page = new Page();
+        page->m_next = next;
+        page->m_size = max<size_t>(ArenaSize, size);
+        page->m_storage = static_cast<uint8*>(aligned_malloc(page->m_size, 16));
+
+        if (m_current_page)
+            m_current_page->m_next = page;
+        else
+            m_first_page = page;
+
+        ++m_overflow_page_count;
+        next = page;
+    }
+
+    m_current_page = next;
+    m_begin = next->m_storage;
+    m_current = m_begin + size;
+    m_end = m_begin + next->m_size;
+
+    return m_begin;
+}
+
+}   // namespace foundation
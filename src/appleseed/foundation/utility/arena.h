@@ -31,14 +31,18 @@
 #define APPLESEED_FOUNDATION_UTILITY_ARENA_H
 
 // appleseed.foundation headers.
-#include "foundation/core/exceptions/exception.h"
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/memory.h"
 
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <new>
 
 namespace foundation
 {
@@ -46,12 +50,20 @@ namespace foundation
 //
 // An arena is a temporary heap providing extremely cheap memory allocation.
 //
+// Allocations are served from an inline page by bumping a pointer. When the inline
+// page is exhausted, the arena chains heap-allocated overflow pages. clear() rewinds
+// the arena to the inline page but keeps overflow pages around for reuse, so memory
+// is only allocated from the heap the first time a given depth is reached.
+//
 
-class Arena
+class APPLESEED_DLLSYMBOL Arena
+  : public NonCopyable
 {
   public:
     Arena();
 
+    ~Arena();
+
     void clear();
 
     void* allocate(const size_t size);
@@ -59,14 +71,30 @@ class Arena
     template <typename T> T* allocate();
     template <typename T> T* allocate_noinit();
 
-    const uint8* get_storage() const;
+    // Return the number of overflow pages owned by the arena.
+    size_t get_overflow_page_count() const;
+
+    // Return the largest number of bytes allocated between two calls to clear().
+    size_t get_high_water_mark() const;
 
   private:
     enum { ArenaSize = 256 * 1024 };    // bytes
 
+    struct Page;
+
     APPLESEED_SIMD4_ALIGN uint8 m_storage[ArenaSize];
     const uint8*                m_end;
     uint8*                      m_current;
+    uint8*                      m_begin;                // beginning of the current page
+    Page*                       m_current_page;         // current overflow page, or nullptr when allocating from m_storage
+    Page*                       m_first_page;           // first overflow page
+    size_t                      m_overflow_page_count;
+    size_t                      m_previous_pages_size;  // bytes allocated in pages before the current one
+    size_t                      m_high_water_mark;
+
+    void* allocate_overflow(const size_t size);
+
+    size_t get_allocated_size() const;
 };
 
 
@@ -77,21 +105,37 @@ class Arena
 inline Arena::Arena()
   : m_end(m_storage + ArenaSize)
   , m_current(m_storage)
+  , m_begin(m_storage)
+  , m_current_page(nullptr)
+  , m_first_page(nullptr)
+  , m_overflow_page_count(0)
+  , m_previous_pages_size(0)
+  , m_high_water_mark(0)
 {
 }
 
 inline void Arena::clear()
 {
+    const size_t allocated_size = get_allocated_size();
+    if (m_high_water_mark < allocated_size)
+        m_high_water_mark = allocated_size;
+
+    m_end = m_storage + ArenaSize;
     m_current = m_storage;
+    m_begin = m_storage;
+    m_current_page = nullptr;
+    m_previous_pages_size = 0;
 }
 
 inline void* Arena::allocate(const size_t size)
 {
-    if (m_current + size > m_end)
-        throw Exception("out of arena memory");
+    const size_t aligned_size = align(size, 16);
+
+    if (m_current + aligned_size > m_end)
+        return allocate_overflow(aligned_size);
 
     void* ptr = m_current;
-    m_current += align(size, 16);
+    m_current += aligned_size;
 
     assert(is_aligned(ptr, 16));
 
@@ -114,9 +158,20 @@ inline T* Arena::allocate_noinit()
     return static_cast<T*>(allocate(sizeof(T)));
 }
 
-inline const uint8* Arena::get_storage() const
+inline size_t Arena::get_overflow_page_count() const
+{
+    return m_overflow_page_count;
+}
+
+inline size_t Arena::get_high_water_mark() const
+{
+    const size_t allocated_size = get_allocated_size();
+    return m_high_water_mark < allocated_size ? allocated_size : m_high_water_mark;
+}
+
+inline size_t Arena::get_allocated_size() const
 {
-    return m_storage;
+    return m_previous_pages_size + static_cast<size_t>(m_current - m_begin);
 }
 
 }       // namespace foundation
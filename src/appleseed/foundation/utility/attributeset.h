@@ -90,6 +90,14 @@ class AttributeSet
         const ChannelID     channel_id,
         const T&            value);
 
+    // Insert multiple attributes at the end of a given attribute channel.
+    // Return the index of the first inserted attribute in the attribute channel.
+    template <typename T>
+    size_t push_attributes(
+        const ChannelID     channel_id,
+        const T*            values,
+        const size_t        count);
+
     // Set a given attribute.
     template <typename T>
     void set_attribute(
@@ -169,6 +177,30 @@ inline size_t AttributeSet::push_attribute(
     return index;
 }
 
+template <typename T>
+inline size_t AttributeSet::push_attributes(
+    const ChannelID         channel_id,
+    const T*                values,
+    const size_t            count)
+{
+    // Get the channel descriptor.
+    assert(channel_id < m_channels.size());
+    Channel* channel = m_channels[channel_id];
+
+    // Check that the size of the attributes matches the size in the channel descriptor.
+    assert(channel->m_value_size == sizeof(T));
+
+    const size_t current_size = channel->m_storage.size();
+    const size_t index = current_size / sizeof(T);
+
+    // Append the new attributes to the storage.
+    const uint8* bytes = reinterpret_cast<const uint8*>(values);
+    channel->m_storage.insert(channel->m_storage.end(), bytes, bytes + count * sizeof(T));
+
+    // Return the index of the first new attribute.
+    return index;
+}
+
 template <typename T>
 inline void AttributeSet::set_attribute(
     const ChannelID         channel_id,
@@ -473,6 +473,10 @@ class LRUCache
     // Get an element from the cache.
     ElementType& get(const KeyType& key);
 
+    // Unload least recently used elements until the element swapper no longer
+    // reports the cache as full. Return the number of unloaded elements.
+    size_t trim();
+
     // Return the size (in bytes) of this object in memory.
     size_t get_memory_size() const;
 
@@ -510,6 +514,10 @@ class LRUCache
     Queue                   m_queue;
     size_t                  m_queue_size;
     ElementSwapperType&     m_element_swapper;
+
+    // Unload elements from the LRU end of the queue while the cache is full,
+    // optionally sparing the MRU element. Return the number of unloaded elements.
+    size_t unload_lru_elements(const bool keep_mru);
 };
 
 
@@ -941,33 +949,52 @@ get(const KeyType& key)
         // Insert the new element into the index.
         m_index[key] = m_queue.begin();
 
-        typename Queue::reverse_iterator i = m_queue.rbegin();
-
-        while (m_element_swapper.is_full(m_queue_size) && i != pred(m_queue.rend()))
-        {
-            // Try to unload this element.
-            if (m_element_swapper.unload(i->m_key, i->m_element))
-            {
-                // Remove this element from the index.
-                m_index.erase(i->m_key);
-
-                // Remove this element from the queue.
-                // http://stackoverflow.com/questions/1830158/how-to-call-erase-with-a-reverse-iterator
-                m_queue.erase(succ(i).base());
-                --m_queue_size;
-            }
-            else
-            {
-                // Unloading this element failed, try the next one.
-                ++i;
-            }
-        }
+        // Make room for the new element.
+        unload_lru_elements(true);
 
         // Return the element.
         return m_queue.front().m_element;
     }
 }
 
+FOUNDATION_LRUCACHE_TEMPLATE_DEF(inline size_t)
+trim()
+{
+    return unload_lru_elements(false);
+}
+
+FOUNDATION_LRUCACHE_TEMPLATE_DEF(inline size_t)
+unload_lru_elements(const bool keep_mru)
+{
+    size_t unloaded_count = 0;
+
+    typename Queue::reverse_iterator i = m_queue.rbegin();
+
+    while (m_element_swapper.is_full(m_queue_size) &&
+           i != (keep_mru ? pred(m_queue.rend()) : m_queue.rend()))
+    {
+        // Try to unload this element.
+        if (m_element_swapper.unload(i->m_key, i->m_element))
+        {
+            // Remove this element from the index.
+            m_index.erase(i->m_key);
+
+            // Remove this element from the queue.
+            // http://stackoverflow.com/questions/1830158/how-to-call-erase-with-a-reverse-iterator
+            m_queue.erase(succ(i).base());
+            --m_queue_size;
+            ++unloaded_count;
+        }
+        else
+        {
+            // Unloading this element failed, try the next one.
+            ++i;
+        }
+    }
+
+    return unloaded_count;
+}
+
 FOUNDATION_LRUCACHE_TEMPLATE_DEF(inline size_t)
 get_memory_size() const
 {
@@ -54,32 +54,36 @@ struct JobManager::Impl
 {
     typedef vector<WorkerThread*> WorkerThreads;
 
-    Logger&             m_logger;
-    JobQueue&           m_job_queue;
-    size_t              m_thread_count;
-    const int           m_flags;
-    WorkerThreads       m_worker_threads;
+    Logger&                 m_logger;
+    JobQueue&               m_job_queue;
+    size_t                  m_thread_count;
+    const int               m_flags;
+    const ThreadPlacement   m_placement;
+    WorkerThreads           m_worker_threads;
 
     // Constructor.
     Impl(
-        Logger&         logger,
-        JobQueue&       job_queue,
-        const size_t    thread_count,
-        const int       flags)
+        Logger&                 logger,
+        JobQueue&               job_queue,
+        const size_t            thread_count,
+        const int               flags,
+        const ThreadPlacement   placement)
       : m_logger(logger)
       , m_job_queue(job_queue)
       , m_thread_count(thread_count)
       , m_flags(flags)
+      , m_placement(placement)
     {
     }
 };
 
 JobManager::JobManager(
-    Logger&             logger,
-    JobQueue&           job_queue,
-    const size_t        thread_count,
-    const int           flags)
-  : impl(new Impl(logger, job_queue, thread_count, flags))
+    Logger&                 logger,
+    JobQueue&               job_queue,
+    const size_t            thread_count,
+    const int               flags,
+    const ThreadPlacement   placement)
+  : impl(new Impl(logger, job_queue, thread_count, flags, placement))
 {
 }
 
@@ -95,6 +99,11 @@ size_t JobManager::get_thread_count() const
     return impl->m_thread_count;
 }
 
+ThreadPlacement JobManager::get_thread_placement() const
+{
+    return impl->m_placement;
+}
+
 void JobManager::start()
 {
     assert(impl->m_worker_threads.empty() ||
@@ -110,7 +119,8 @@ void JobManager::start()
                     i,
                     impl->m_logger,
                     impl->m_job_queue,
-                    impl->m_flags));
+                    impl->m_flags,
+                    impl->m_placement));
         }
     }
 
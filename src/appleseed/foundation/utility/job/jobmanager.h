@@ -32,6 +32,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/thread.h"
 
 // appleseed.main headers.
 #include "main/dllsymbol.h"
@@ -64,10 +65,11 @@ class APPLESEED_DLLSYMBOL JobManager
 
     // Constructor.
     JobManager(
-        Logger&         logger,
-        JobQueue&       job_queue,
-        const size_t    thread_count,       // the number of simultaneous worker threads
-        const int       flags = 0);
+        Logger&                 logger,
+        JobQueue&               job_queue,
+        const size_t            thread_count,       // the number of simultaneous worker threads
+        const int               flags = 0,
+        const ThreadPlacement   placement = ThreadPlacementNone);
 
     // Destructor. Returns once currently running jobs are completed.
     ~JobManager();
@@ -75,6 +77,9 @@ class APPLESEED_DLLSYMBOL JobManager
     // Return the number of worker threads.
     size_t get_thread_count() const;
 
+    // Return the placement policy of worker threads.
+    ThreadPlacement get_thread_placement() const;
+
     // Start job execution. Returns immediately.
     void start();
 
@@ -31,17 +31,21 @@
 #include "jobqueue.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
 #include "foundation/platform/thread.h"
-#include "foundation/utility/foreach.h"
-#include "foundation/utility/iterators.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/job/abortswitch.h"
 #include "foundation/utility/job/ijob.h"
 
 // Boost headers.
+#include "boost/atomic/atomic.hpp"
+#include "boost/atomic/fences.hpp"
 #include "boost/thread/condition_variable.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
+#include <deque>
 
 using namespace std;
 
@@ -54,23 +58,300 @@ namespace foundation
 
 struct JobQueue::Impl
 {
-    mutable boost::mutex            m_mutex;
-    boost::condition_variable_any   m_event;
-    JobList                         m_scheduled_jobs;
-    JobList                         m_running_jobs;
+    //
+    // A fixed-capacity, lock-free work-stealing deque.
+    //
+    // Only the owning worker thread may call push() and pop(); any thread may call steal().
+    //
+    // Reference:
+    //
+    //   Correct and Efficient Work-Stealing for Weak Memory Models
+    //   https://www.di.ens.fr/~zappa/readings/ppopp13.pdf
+    //
+
+    class LocalQueue
+      : public NonCopyable
+    {
+      public:
+        enum { Capacity = 1024 };
+
+        Impl* const                     m_owner;
+        const size_t                    m_index;
+        boost::atomic<bool>             m_attached;
+
+        LocalQueue(Impl* owner, const size_t index)
+          : m_owner(owner)
+          , m_index(index)
+          , m_attached(false)
+          , m_top(0)
+          , m_bottom(0)
+        {
+            for (size_t i = 0; i < Capacity; ++i)
+            {
+                m_jobs[i].store(nullptr, boost::memory_order_relaxed);
+                m_owned[i].store(false, boost::memory_order_relaxed);
+            }
+        }
+
+        // Return an upper bound on the number of jobs in the deque. Owner only.
+        size_t size() const
+        {
+            const int64 b = m_bottom.load(boost::memory_order_relaxed);
+            const int64 t = m_top.load(boost::memory_order_acquire);
+            return b > t ? static_cast<size_t>(b - t) : 0;
+        }
+
+        // Push a job at the bottom of the deque. Return false if the deque is full.
+        bool push(const JobInfo& job_info)
+        {
+            const int64 b = m_bottom.load(boost::memory_order_relaxed);
+            const int64 t = m_top.load(boost::memory_order_acquire);
+
+            if (b - t >= Capacity)
+                return false;
+
+            m_jobs[b & (Capacity - 1)].store(job_info.m_job, boost::memory_order_relaxed);
+            m_owned[b & (Capacity - 1)].store(job_info.m_owned, boost::memory_order_relaxed);
+            boost::atomic_thread_fence(boost::memory_order_release);
+            m_bottom.store(b + 1, boost::memory_order_relaxed);
+
+            return true;
+        }
+
+        // Pop the most recently pushed job.
+        JobInfo pop()
+        {
+            const int64 b = m_bottom.load(boost::memory_order_relaxed) - 1;
+            m_bottom.store(b, boost::memory_order_relaxed);
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            int64 t = m_top.load(boost::memory_order_relaxed);
+
+            if (t > b)
+            {
+                // The deque is empty.
+                m_bottom.store(b + 1, boost::memory_order_relaxed);
+                return JobInfo(nullptr, false);
+            }
+
+            JobInfo job_info(
+                m_jobs[b & (Capacity - 1)].load(boost::memory_order_relaxed),
+                m_owned[b & (Capacity - 1)].load(boost::memory_order_relaxed));
+
+            if (t == b)
+            {
+                // Last job in the deque: race against thieves.
+                if (!m_top.compare_exchange_strong(t, t + 1, boost::memory_order_seq_cst, boost::memory_order_relaxed))
+                    job_info.m_job = nullptr;
+                m_bottom.store(b + 1, boost::memory_order_relaxed);
+            }
+
+            return job_info;
+        }
+
+        // Steal the oldest job.
+        JobInfo steal()
+        {
+            int64 t = m_top.load(boost::memory_order_acquire);
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            const int64 b = m_bottom.load(boost::memory_order_acquire);
+
+            if (t >= b)
+                return JobInfo(nullptr, false);
+
+            const JobInfo job_info(
+                m_jobs[t & (Capacity - 1)].load(boost::memory_order_relaxed),
+                m_owned[t & (Capacity - 1)].load(boost::memory_order_relaxed));
+
+            if (!m_top.compare_exchange_strong(t, t + 1, boost::memory_order_seq_cst, boost::memory_order_relaxed))
+                return JobInfo(nullptr, false);
+
+            return job_info;
+        }
+
+      private:
+        boost::atomic<int64>            m_top;
+        boost::atomic<int64>            m_bottom;
+        boost::atomic<IJob*>            m_jobs[Capacity];
+        boost::atomic<bool>             m_owned[Capacity];
+    };
+
+    enum { MaxLocalQueueCount = 256 };
+
+    // Maximum number of jobs a worker thread moves from the injection queue to its deque at once.
+    enum { MaxBatchSize = 16 };
+
+    // Deque of the calling worker thread, if any.
+    static APPLESEED_TLS LocalQueue*    s_local_queue;
+
+    // Global injection queue.
+    mutable Spinlock                    m_injection_lock;
+    deque<JobInfo>                      m_injection_queue;
+
+    // Worker thread deques. Deques are never deallocated before the queue is destructed,
+    // but they may be reused by worker threads attaching after others have detached.
+    boost::atomic<LocalQueue*>          m_local_queues[MaxLocalQueueCount];
+    boost::atomic<size_t>               m_local_queue_count;
+
+    // Number of scheduled and running jobs, and number of running jobs.
+    boost::atomic<size_t>               m_pending_job_count;
+    boost::atomic<size_t>               m_running_job_count;
+
+    // Sleeping worker threads and threads waiting for completion block on this event.
+    boost::atomic<size_t>               m_sleeping_thread_count;
+    mutable boost::mutex                m_mutex;
+    boost::condition_variable_any       m_event;
+
+    Impl()
+      : m_local_queue_count(0)
+      , m_pending_job_count(0)
+      , m_running_job_count(0)
+      , m_sleeping_thread_count(0)
+    {
+        for (size_t i = 0; i < MaxLocalQueueCount; ++i)
+            m_local_queues[i].store(nullptr, boost::memory_order_relaxed);
+    }
+
+    ~Impl()
+    {
+        for (size_t i = 0, e = m_local_queue_count; i < e; ++i)
+            delete m_local_queues[i].load();
+    }
 
-    static void delete_jobs(JobList& list)
+    size_t get_scheduled_job_count() const
     {
-        for (each<JobList> i = list; i; ++i)
+        // Read the running job count first: it never exceeds the pending job count.
+        const size_t running = m_running_job_count;
+        const size_t pending = m_pending_job_count;
+        return pending > running ? pending - running : 0;
+    }
+
+    LocalQueue* get_local_queue() const
+    {
+        return s_local_queue && s_local_queue->m_owner == this ? s_local_queue : nullptr;
+    }
+
+    JobInfo pop_from_injection_queue(LocalQueue* local_queue)
+    {
+        Spinlock::ScopedLock lock(m_injection_lock);
+
+        if (m_injection_queue.empty())
+            return JobInfo(nullptr, false);
+
+        const JobInfo job_info = m_injection_queue.front();
+        m_injection_queue.pop_front();
+
+        if (local_queue)
         {
-            if (i->m_owned)
-                delete i->m_job;
+            // Move a share of the remaining jobs to the deque of the calling thread, in reverse
+            // order so that they are popped in the order in which they were scheduled.
+            const size_t worker_count = max<size_t>(m_local_queue_count, 1);
+            const size_t batch_size =
+                min<size_t>(
+                    min<size_t>(m_injection_queue.size() / (2 * worker_count), MaxBatchSize - 1),
+                    LocalQueue::Capacity - local_queue->size());
+
+            for (size_t i = batch_size; i > 0; --i)
+            {
+                APPLESEED_UNUSED const bool pushed = local_queue->push(m_injection_queue[i - 1]);
+                assert(pushed);
+            }
+
+            for (size_t i = 0; i < batch_size; ++i)
+                m_injection_queue.pop_front();
         }
 
-        list.clear();
+        return job_info;
+    }
+
+    JobInfo steal_from_local_queues(LocalQueue* local_queue)
+    {
+        const size_t count = m_local_queue_count;
+
+        // Start from a different deque for every thread to spread thieves.
+        const size_t start = local_queue ? local_queue->m_index + 1 : 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            LocalQueue* victim = m_local_queues[(start + i) % count];
+
+            if (victim == local_queue)
+                continue;
+
+            const JobInfo job_info = victim->steal();
+
+            if (job_info.m_job)
+                return job_info;
+        }
+
+        return JobInfo(nullptr, false);
+    }
+
+    JobInfo try_acquire_job()
+    {
+        LocalQueue* local_queue = get_local_queue();
+
+        if (local_queue)
+        {
+            const JobInfo job_info = local_queue->pop();
+            if (job_info.m_job)
+                return job_info;
+        }
+
+        const JobInfo job_info = pop_from_injection_queue(local_queue);
+        if (job_info.m_job)
+            return job_info;
+
+        return steal_from_local_queues(local_queue);
+    }
+
+    void notify_all()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_event.notify_all();
+    }
+
+    // Remove all scheduled jobs; return the number of jobs removed.
+    size_t delete_scheduled_jobs()
+    {
+        size_t deleted_job_count = 0;
+
+        {
+            Spinlock::ScopedLock lock(m_injection_lock);
+
+            for (const JobInfo& job_info : m_injection_queue)
+            {
+                if (job_info.m_owned)
+                    delete job_info.m_job;
+            }
+
+            deleted_job_count += m_injection_queue.size();
+            m_injection_queue.clear();
+        }
+
+        for (size_t i = 0, e = m_local_queue_count; i < e; ++i)
+        {
+            LocalQueue* local_queue = m_local_queues[i];
+
+            while (true)
+            {
+                const JobInfo job_info = local_queue->steal();
+
+                if (job_info.m_job == nullptr)
+                    break;
+
+                if (job_info.m_owned)
+                    delete job_info.m_job;
+
+                ++deleted_job_count;
+            }
+        }
+
+        return deleted_job_count;
     }
 };
 
+APPLESEED_TLS JobQueue::Impl::LocalQueue* JobQueue::Impl::s_local_queue = nullptr;
+
 JobQueue::JobQueue()
   : impl(new Impl())
 {
@@ -78,79 +359,79 @@ JobQueue::JobQueue()
 
 JobQueue::~JobQueue()
 {
-    // We assume that worker threads are not running, so we don't lock.
+    // We assume that worker threads are not running.
 
     // At this point, no job must be running.
-    assert(impl->m_running_jobs.empty());
+    assert(impl->m_running_job_count == 0);
 
     // Delete all scheduled jobs that the queue owns.
-    Impl::delete_jobs(impl->m_scheduled_jobs);
+    impl->delete_scheduled_jobs();
 
     delete impl;
 }
 
 void JobQueue::clear_scheduled_jobs()
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
+    const size_t deleted_job_count = impl->delete_scheduled_jobs();
 
-    impl->delete_jobs(impl->m_scheduled_jobs);
+    if (deleted_job_count > 0)
+    {
+        impl->m_pending_job_count -= deleted_job_count;
 
-    // Notify worker threads that all scheduled jobs are gone.
-    impl->m_event.notify_all();
+        // Notify waiting threads that all scheduled jobs are gone.
+        impl->notify_all();
+    }
 }
 
 bool JobQueue::has_scheduled_jobs() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return !impl->m_scheduled_jobs.empty();
+    return impl->get_scheduled_job_count() > 0;
 }
 
 bool JobQueue::has_running_jobs() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return !impl->m_running_jobs.empty();
+    return impl->m_running_job_count > 0;
 }
 
 bool JobQueue::has_scheduled_or_running_jobs() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return !impl->m_scheduled_jobs.empty() || !impl->m_running_jobs.empty();
+    return impl->m_pending_job_count > 0;
 }
 
 size_t JobQueue::get_scheduled_job_count() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return impl->m_scheduled_jobs.size();
+    return impl->get_scheduled_job_count();
 }
 
 size_t JobQueue::get_running_job_count() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return impl->m_running_jobs.size();
+    return impl->m_running_job_count;
 }
 
 size_t JobQueue::get_total_job_count() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    return impl->m_scheduled_jobs.size() + impl->m_running_jobs.size();
+    return impl->m_pending_job_count;
 }
 
 void JobQueue::schedule(IJob* job, const bool transfer_ownership)
 {
     assert(job);
 
-    boost::mutex::scoped_lock lock(impl->m_mutex);
+    const JobInfo job_info(job, transfer_ownership);
+
+    ++impl->m_pending_job_count;
 
-    impl->m_scheduled_jobs.push_back(JobInfo(job, transfer_ownership));
+    // Worker threads push the jobs they schedule into their own deque.
+    Impl::LocalQueue* local_queue = impl->get_local_queue();
+    if (local_queue == nullptr || !local_queue->push(job_info))
+    {
+        Spinlock::ScopedLock lock(impl->m_injection_lock);
+        impl->m_injection_queue.push_back(job_info);
+    }
 
-    // Notify worker threads that a new scheduled job is available.
-    impl->m_event.notify_all();
+    // Wake up sleeping worker threads.
+    if (impl->m_sleeping_thread_count > 0)
+        impl->notify_all();
 }
 
 void JobQueue::wait_until_completion()
@@ -158,65 +439,122 @@ void JobQueue::wait_until_completion()
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
     // Wait until there is no more scheduled or running jobs.
-    while (!impl->m_scheduled_jobs.empty() || !impl->m_running_jobs.empty())
+    while (impl->m_pending_job_count > 0)
         impl->m_event.wait(lock);
 }
 
-JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job()
+void JobQueue::register_worker_thread()
 {
+    assert(impl->get_local_queue() == nullptr);
+
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
-    return acquire_scheduled_job_no_lock();
+    // Reuse a detached deque if possible.
+    const size_t count = impl->m_local_queue_count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Impl::LocalQueue* local_queue = impl->m_local_queues[i];
+
+        if (!local_queue->m_attached)
+        {
+            local_queue->m_attached = true;
+            Impl::s_local_queue = local_queue;
+            return;
+        }
+    }
+
+    // Worker threads in excess of the maximum number of deques only use the injection queue.
+    if (count == Impl::MaxLocalQueueCount)
+        return;
+
+    Impl::LocalQueue* local_queue = new Impl::LocalQueue(impl, count);
+    local_queue->m_attached = true;
+    impl->m_local_queues[count] = local_queue;
+    impl->m_local_queue_count = count + 1;
+    Impl::s_local_queue = local_queue;
 }
 
-JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job_no_lock()
+void JobQueue::unregister_worker_thread()
 {
-    // Bail out if there is no scheduled job.
-    if (impl->m_scheduled_jobs.empty())
-        return RunningJobInfo(JobInfo(nullptr, false), impl->m_running_jobs.end());
+    Impl::LocalQueue* local_queue = impl->get_local_queue();
 
-    // Move the next scheduled job to the end of the queue of running jobs.
-    const JobInfo job_info = impl->m_scheduled_jobs.front();
-    impl->m_scheduled_jobs.pop_front();
-    impl->m_running_jobs.push_back(job_info);
+    if (local_queue == nullptr)
+        return;
+
+    // Hand the remaining jobs over to the other worker threads, oldest first.
+    size_t moved_job_count = 0;
+    while (true)
+    {
+        const JobInfo job_info = local_queue->steal();
 
-    // Notify worker threads that a job has moved from the scheduled to the running state.
-    impl->m_event.notify_all();
+        if (job_info.m_job == nullptr)
+            break;
 
-    return RunningJobInfo(job_info, pred(impl->m_running_jobs.end()));
+        Spinlock::ScopedLock lock(impl->m_injection_lock);
+        impl->m_injection_queue.push_back(job_info);
+        ++moved_job_count;
+    }
+
+    Impl::s_local_queue = nullptr;
+
+    {
+        boost::mutex::scoped_lock lock(impl->m_mutex);
+        local_queue->m_attached = false;
+    }
+
+    if (moved_job_count > 0 && impl->m_sleeping_thread_count > 0)
+        impl->notify_all();
 }
 
-JobQueue::RunningJobInfo JobQueue::wait_for_scheduled_job(AbortSwitch& abort_switch)
+JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job()
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
+    const JobInfo job_info = impl->try_acquire_job();
 
-    // Wait for a scheduled job to be available.
-    while (!abort_switch.is_aborted() && impl->m_scheduled_jobs.empty())    // order matters
-        impl->m_event.wait(lock);
+    if (job_info.m_job)
+        ++impl->m_running_job_count;
 
-    return acquire_scheduled_job_no_lock();
+    return job_info;
 }
 
-void JobQueue::retire_running_job(const RunningJobInfo& running_job_info)
+JobQueue::RunningJobInfo JobQueue::wait_for_scheduled_job(AbortSwitch& abort_switch)
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
+    while (!abort_switch.is_aborted())
+    {
+        const RunningJobInfo running_job_info = acquire_scheduled_job();
+
+        if (running_job_info.m_job)
+            return running_job_info;
 
-    // Remove the job from the running list.
-    impl->m_running_jobs.erase(running_job_info.second);
+        // Go to sleep until a job is scheduled. The sleeping thread count must be
+        // incremented before checking for scheduled jobs, see JobQueue::schedule().
+        boost::mutex::scoped_lock lock(impl->m_mutex);
+        ++impl->m_sleeping_thread_count;
 
+        while (!abort_switch.is_aborted() && impl->get_scheduled_job_count() == 0)     // order matters
+            impl->m_event.wait(lock);
+
+        --impl->m_sleeping_thread_count;
+    }
+
+    return RunningJobInfo(nullptr, false);
+}
+
+void JobQueue::retire_running_job(const RunningJobInfo& running_job_info)
+{
     // Delete the job.
-    if (running_job_info.first.m_owned)
-        delete running_job_info.first.m_job;
+    if (running_job_info.m_owned)
+        delete running_job_info.m_job;
+
+    --impl->m_running_job_count;
 
-    // Notify worker threads that a scheduled job was retired.
-    impl->m_event.notify_all();
+    // Notify threads waiting for completion that all jobs are done.
+    if (--impl->m_pending_job_count == 0)
+        impl->notify_all();
 }
 
 void JobQueue::signal_event()
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
-    impl->m_event.notify_all();
+    impl->notify_all();
 }
 
 }   // namespace foundation
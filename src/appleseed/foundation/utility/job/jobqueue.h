@@ -32,7 +32,6 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
-#include "foundation/utility/poolallocator.h"
 #include "foundation/utility/test.h"
 
 // appleseed.main headers.
@@ -40,8 +39,6 @@
 
 // Standard headers.
 #include <cstddef>
-#include <list>
-#include <utility>
 
 // Forward declarations.
 namespace foundation    { class AbortSwitch; }
@@ -67,6 +64,13 @@ namespace foundation
 //   - scheduled: the job was inserted into the job queue, but hasn't yet been executed
 //   - running: the job is currently being executed
 //
+// Scheduling is work-stealing: each worker thread owns a lock-free deque into
+// which it pushes the jobs it schedules itself and from which it pops jobs
+// in LIFO order. Jobs scheduled from other threads go to a global injection
+// queue from which idle worker threads pick up small batches. A worker thread
+// whose deque and the injection queue are both empty steals the oldest job
+// from the deque of another worker thread before going to sleep.
+//
 
 class APPLESEED_DLLSYMBOL JobQueue
   : public NonCopyable
@@ -130,16 +134,17 @@ class APPLESEED_DLLSYMBOL JobQueue
         }
     };
 
-    typedef std::list<JobInfo, PoolAllocator<JobInfo, 64>> JobList;
+    typedef JobInfo RunningJobInfo;
+
+    // Attach the calling thread to this queue as a worker thread, giving it its own deque.
+    void register_worker_thread();
 
-    typedef std::pair<JobInfo, JobList::iterator> RunningJobInfo;
+    // Detach the calling worker thread. Jobs left in its deque are moved to the injection queue.
+    void unregister_worker_thread();
 
     // Acquire a scheduled job and change its state from 'scheduled' to 'running'.
     RunningJobInfo acquire_scheduled_job();
 
-    // Acquire a scheduled job without any locking.
-    RunningJobInfo acquire_scheduled_job_no_lock();
-
     // Wait for a scheduled job to be available.
     RunningJobInfo wait_for_scheduled_job(AbortSwitch& abort_switch);
 
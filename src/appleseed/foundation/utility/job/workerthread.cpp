@@ -53,14 +53,16 @@ namespace foundation
 //
 
 WorkerThread::WorkerThread(
-    const size_t    index,
-    Logger&         logger,
-    JobQueue&       job_queue,
-    const int       flags)
+    const size_t            index,
+    Logger&                 logger,
+    JobQueue&               job_queue,
+    const int               flags,
+    const ThreadPlacement   placement)
   : m_index(index)
   , m_logger(logger)
   , m_job_queue(job_queue)
   , m_flags(flags)
+  , m_placement(placement)
   , m_thread_func(*this)
   , m_thread(nullptr)
 {
@@ -133,10 +135,31 @@ void WorkerThread::set_thread_name()
     set_current_thread_name(thread_name);
 }
 
+void WorkerThread::set_thread_placement()
+{
+    if (m_placement == ThreadPlacementNone)
+        return;
+
+    if (!set_current_thread_placement(m_placement, m_index))
+    {
+        LOG_DEBUG(
+            m_logger,
+            "worker thread " FMT_SIZE_T ": could not apply \"%s\" thread placement.",
+            m_index,
+            get_thread_placement_name(m_placement));
+    }
+}
+
 void WorkerThread::run()
 {
     set_thread_name();
 
+    // Pin the thread before executing any job, so that memory first written by jobs,
+    // such as per-thread framebuffers and arenas, is allocated on the local NUMA node.
+    set_thread_placement();
+
+    m_job_queue.register_worker_thread();
+
     while (!m_abort_switch.is_aborted())
     {
         if (m_pause_flag.is_set())
@@ -152,7 +175,7 @@ void WorkerThread::run()
             m_job_queue.wait_for_scheduled_job(m_abort_switch);
 
         // Handle the case where the job queue is empty.
-        if (running_job_info.first.m_job == nullptr)
+        if (running_job_info.m_job == nullptr)
         {
             if (m_flags & JobManager::KeepRunningOnEmptyQueue)
             {
@@ -167,7 +190,7 @@ void WorkerThread::run()
         }
 
         // Execute the job.
-        const bool success = execute_job(*running_job_info.first.m_job);
+        const bool success = execute_job(*running_job_info.m_job);
 
         // Retire the job.
         m_job_queue.retire_running_job(running_job_info);
@@ -179,6 +202,8 @@ void WorkerThread::run()
             break;
         }
     }
+
+    m_job_queue.unregister_worker_thread();
 }
 
 bool WorkerThread::execute_job(IJob& job)
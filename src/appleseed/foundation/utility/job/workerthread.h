@@ -60,10 +60,11 @@ class WorkerThread
   public:
     // Constructor.
     WorkerThread(
-        const size_t    index,
-        Logger&         logger,
-        JobQueue&       job_queue,
-        const int       flags);     // see foundation::JobManager::Flags
+        const size_t            index,
+        Logger&                 logger,
+        JobQueue&               job_queue,
+        const int               flags,      // see foundation::JobManager::Flags
+        const ThreadPlacement   placement = ThreadPlacementNone);
 
     // Destructor.
     ~WorkerThread();
@@ -102,6 +103,7 @@ class WorkerThread
     Logger&                         m_logger;
     JobQueue&                       m_job_queue;
     const int                       m_flags;
+    const ThreadPlacement           m_placement;
 
     AbortSwitch                     m_abort_switch;
 
@@ -114,6 +116,9 @@ class WorkerThread
 
     void set_thread_name();
 
+    // Pin the thread according to the placement policy.
+    void set_thread_placement();
+
     // Main line of the worker thread.
     void run();
 
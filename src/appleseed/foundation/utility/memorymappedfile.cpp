@@ -0,0 +1,128 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "memorymappedfile.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+#include "boost/system/error_code.hpp"
+
+// Standard headers.
+#include <memory>
+
+using namespace boost;
+using namespace std;
+
+namespace foundation
+{
+
+struct MemoryMappedFile::Impl
+{
+    unique_ptr<interprocess::file_mapping>  m_mapping;
+    unique_ptr<interprocess::mapped_region> m_region;
+    bool                                    m_is_open;
+};
+
+MemoryMappedFile::MemoryMappedFile()
+  : impl(new Impl())
+{
+    impl->m_is_open = false;
+}
+
+MemoryMappedFile::MemoryMappedFile(const char* path)
+  : impl(new Impl())
+{
+    impl->m_is_open = false;
+    open(path);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    close();
+    delete impl;
+}
+
+bool MemoryMappedFile::open(const char* path)
+{
+    close();
+
+    system::error_code ec;
+    const uintmax_t file_size = filesystem::file_size(path, ec);
+
+    if (ec)
+        return false;
+
+    // Empty files cannot be mapped but are otherwise perfectly valid.
+    if (file_size == 0)
+    {
+        impl->m_is_open = true;
+        return true;
+    }
+
+    try
+    {
+        impl->m_mapping.reset(new interprocess::file_mapping(path, interprocess::read_only));
+        impl->m_region.reset(new interprocess::mapped_region(*impl->m_mapping, interprocess::read_only));
+    }
+    catch (const interprocess::interprocess_exception&)
+    {
+        impl->m_region.reset();
+        impl->m_mapping.reset();
+        return false;
+    }
+
+    impl->m_is_open = true;
+    return true;
+}
+
+void MemoryMappedFile::close()
+{
+    impl->m_region.reset();
+    impl->m_mapping.reset();
+    impl->m_is_open = false;
+}
+
+bool MemoryMappedFile::is_open() const
+{
+    return impl->m_is_open;
+}
+
+const uint8* MemoryMappedFile::data() const
+{
+    return impl->m_region ? static_cast<const uint8*>(impl->m_region->get_address()) : 0;
+}
+
+size_t MemoryMappedFile::size() const
+{
+    return impl->m_region ? impl->m_region->get_size() : 0;
+}
+
+}   // namespace foundation
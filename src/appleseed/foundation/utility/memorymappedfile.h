@@ -0,0 +1,87 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_FOUNDATION_UTILITY_MEMORYMAPPEDFILE_H
+#define APPLESEED_FOUNDATION_UTILITY_MEMORYMAPPEDFILE_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// A read-only view of an entire file mapped into the address space of the process.
+//
+// The operating system pages the file in on demand, so opening a file is cheap
+// regardless of its size. The mapping is aligned on a page boundary.
+//
+
+class APPLESEED_DLLSYMBOL MemoryMappedFile
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    MemoryMappedFile();
+
+    // Constructor, opens a file. Use is_open() to check for success.
+    explicit MemoryMappedFile(const char* path);
+
+    // Destructor, closes the file.
+    ~MemoryMappedFile();
+
+    // Open a file. Returns true on success, false otherwise.
+    bool open(const char* path);
+
+    // Close the file. Pointers returned by data() become invalid.
+    void close();
+
+    // Return true if a file is currently mapped.
+    bool is_open() const;
+
+    // Return the address of the first byte of the file, or 0 if the file is empty.
+    const uint8* data() const;
+
+    // Return the size of the file in bytes.
+    size_t size() const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}       // namespace foundation
+
+#endif  // !APPLESEED_FOUNDATION_UTILITY_MEMORYMAPPEDFILE_H
@@ -47,6 +47,7 @@
 #include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/utility/bbox.h"
+#include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/beziercurve.h"
@@ -58,10 +59,13 @@
 #include "foundation/platform/timers.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/alignedallocator.h"
+#include "foundation/utility/api/apistring.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/siphash.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
@@ -81,11 +85,15 @@ namespace renderer
 // AssemblyTree class implementation.
 //
 
-AssemblyTree::AssemblyTree(const Scene& scene)
+AssemblyTree::AssemblyTree(
+    const Scene&    scene,
+    const size_t    thread_count)
   : TreeType(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
   , m_scene(scene)
+  , m_has_wide_tree(false)
+  , m_triangle_tree_build_thread_count(0)
 {
-    update();
+    update(thread_count);
 }
 
 AssemblyTree::~AssemblyTree()
@@ -93,10 +101,10 @@ AssemblyTree::~AssemblyTree()
     RENDERER_LOG_INFO("deleting assembly tree...");
 }
 
-void AssemblyTree::update()
+void AssemblyTree::update(const size_t thread_count)
 {
     rebuild_assembly_tree();
-    update_tree_hierarchy();
+    update_tree_hierarchy(thread_count);
 }
 
 size_t AssemblyTree::get_memory_size() const
@@ -106,6 +114,7 @@ size_t AssemblyTree::get_memory_size() const
         - sizeof(*static_cast<const TreeType*>(this))
         + sizeof(*this)
         + m_items.capacity() * sizeof(AssemblyInstance*)
+        + m_wide_tree.get_memory_size() - sizeof(m_wide_tree)
         + m_assembly_versions.size() * sizeof(pair<UniqueID, VersionID>);
 }
 
@@ -157,6 +166,7 @@ void AssemblyTree::rebuild_assembly_tree()
     // Clear the current tree.
     clear();
     m_items.clear();
+    m_wide_tree.clear();
 
     Statistics statistics;
 
@@ -205,6 +215,15 @@ void AssemblyTree::rebuild_assembly_tree()
         store_items_in_leaves(statistics);
     }
 
+    // Optionally collapse the assembly tree into a wide BVH.
+    const ParamArray& params = m_scene.get_parameters().child("acceleration_structure");
+    m_has_wide_tree = params.get_optional<bool>("wide_bvh", AssemblyTreeDefaultWideBVH);
+    if (m_has_wide_tree)
+    {
+        m_wide_tree.build(*this);
+        statistics.insert("wide bvh nodes", m_wide_tree.get_node_count());
+    }
+
     // Print assembly tree statistics.
     RENDERER_LOG_DEBUG("%s",
         StatisticsVector::make(
@@ -245,7 +264,7 @@ void AssemblyTree::store_items_in_leaves(Statistics& statistics)
     statistics.insert_percent("fat leaves", fat_leaf_count, leaf_count);
 }
 
-void AssemblyTree::update_tree_hierarchy()
+void AssemblyTree::update_tree_hierarchy(const size_t rendering_thread_count)
 {
     // Collect all assemblies in the scene.
     AssemblyVector assemblies;
@@ -254,38 +273,48 @@ void AssemblyTree::update_tree_hierarchy()
     // Delete child trees of assemblies that no longer exist.
     delete_unused_child_trees(assemblies);
 
+    // Collect assemblies whose child trees are missing or out-of-date.
+    AssemblyVector outdated_assemblies;
+    collect_outdated_assemblies(assemblies, outdated_assemblies);
+
+    const ParamArray& params = m_scene.get_parameters().child("acceleration_structure");
+    const bool parallel_build =
+        params.get_optional<bool>("parallel_child_tree_build", AssemblyTreeDefaultParallelChildTreeBuild);
+    const size_t thread_count =
+        max<size_t>(params.get_optional<size_t>("build_thread_count", rendering_thread_count), 1);
+
+    // When child trees are built concurrently, split the threads among the triangle trees
+    // instead of letting each triangle tree build use all of them. This count takes
+    // precedence over the build_thread_count parameter of the triangle trees.
+    const size_t triangle_tree_count =
+        parallel_build ? count_triangle_trees_to_build(outdated_assemblies) : 0;
+    m_triangle_tree_build_thread_count =
+        triangle_tree_count > 1
+            ? max<size_t>(thread_count / triangle_tree_count, 1)
+            : thread_count;
+
     // Create or rebuild the child trees of each assembly.
-    for (const_each<AssemblyVector> i = assemblies; i; ++i)
+    for (const_each<AssemblyVector> i = outdated_assemblies; i; ++i)
     {
         // Retrieve the assembly.
         const Assembly& assembly = **i;
 
-        // Retrieve the current version ID of the assembly.
-        const VersionID current_version_id = assembly.get_version_id();
-
-        // Retrieve the stored version ID of the assembly.
-        const AssemblyVersionMap::const_iterator stored_version_it =
-            m_assembly_versions.find(assembly.get_uid());
-
-        if (stored_version_it != m_assembly_versions.end())
-        {
-            if (stored_version_it->second == current_version_id)
-            {
-                // The child trees of this assembly are up-to-date.
-                continue;
-            }
-
-            // The child trees of this assembly are out-of-date: delete them.
-            delete_child_trees(assembly.get_uid());
-        }
+        // The child trees of this assembly may be out-of-date: delete them.
+        delete_child_trees(assembly.get_uid());
 
         // Lazily build new child trees.
         create_child_trees(assembly);
 
         // Store the current version ID of the assembly.
-        m_assembly_versions[assembly.get_uid()] = current_version_id;
+        m_assembly_versions[assembly.get_uid()] = assembly.get_version_id();
     }
 
+    // Build new child trees ahead of rendering.
+    if (parallel_build)
+        build_pending_child_trees(thread_count);
+
+    clear_pending_child_trees();
+
     // Update child trees.
     update_region_trees();
     update_triangle_trees();
@@ -328,6 +357,30 @@ void AssemblyTree::delete_unused_child_trees(const AssemblyVector& assemblies)
     }
 }
 
+void AssemblyTree::collect_outdated_assemblies(
+    const AssemblyVector&   assemblies,
+    AssemblyVector&         outdated_assemblies) const
+{
+    assert(outdated_assemblies.empty());
+
+    for (const_each<AssemblyVector> i = assemblies; i; ++i)
+    {
+        // Retrieve the assembly.
+        const Assembly& assembly = **i;
+
+        // Retrieve the stored version ID of the assembly.
+        const AssemblyVersionMap::const_iterator stored_version_it =
+            m_assembly_versions.find(assembly.get_uid());
+
+        // Skip assemblies whose child trees are up-to-date.
+        if (stored_version_it != m_assembly_versions.end() &&
+            stored_version_it->second == assembly.get_version_id())
+            continue;
+
+        outdated_assemblies.push_back(&assembly);
+    }
+}
+
 namespace
 {
     bool has_object_instances_of_type(const Assembly& assembly, const char* model)
@@ -402,6 +455,23 @@ namespace
     }
 }
 
+size_t AssemblyTree::count_triangle_trees_to_build(const AssemblyVector& outdated_assemblies) const
+{
+    // Only non-flushable assemblies with mesh objects get a triangle tree, and assemblies
+    // with identical geometry share one. Trees that will be reused are still counted.
+    set<uint64> hashes;
+
+    for (const_each<AssemblyVector> i = outdated_assemblies; i; ++i)
+    {
+        const Assembly& assembly = **i;
+
+        if (!assembly.is_flushable() && has_object_instances_of_type(assembly, MeshObjectFactory().get_model()))
+            hashes.insert(hash_assembly_geometry(assembly, MeshObjectFactory().get_model()));
+    }
+
+    return hashes.size();
+}
+
 void AssemblyTree::create_child_trees(const Assembly& assembly)
 {
     // Create a region or a triangle tree if there are mesh objects.
@@ -433,6 +503,7 @@ void AssemblyTree::create_region_tree(const Assembly& assembly)
 
         tree = new Lazy<RegionTree>(move(region_tree_factory));
         m_region_tree_repository.insert(hash, tree);
+        m_pending_region_trees.emplace_back(format("region tree for assembly \"{0}\"", assembly.get_path()), tree);
     }
 
     m_region_trees.insert(make_pair(assembly.get_uid(), tree));
@@ -461,10 +532,12 @@ void AssemblyTree::create_triangle_tree(const Assembly& assembly)
                     assembly.get_uid(),
                     assembly_bbox,
                     assembly,
-                    regions)));
+                    regions,
+                    m_triangle_tree_build_thread_count)));
 
         tree = new Lazy<TriangleTree>(move(triangle_tree_factory));
         m_triangle_tree_repository.insert(hash, tree);
+        m_pending_triangle_trees.emplace_back(format("triangle tree for assembly \"{0}\"", assembly.get_path()), tree);
     }
 
     m_triangle_trees.insert(make_pair(assembly.get_uid(), tree));
@@ -493,6 +566,7 @@ void AssemblyTree::create_curve_tree(const Assembly& assembly)
 
         tree = new Lazy<CurveTree>(move(curve_tree_factory));
         m_curve_tree_repository.insert(hash, tree);
+        m_pending_curve_trees.emplace_back(format("curve tree for assembly \"{0}\"", assembly.get_path()), tree);
     }
 
     m_curve_trees.insert(make_pair(assembly.get_uid(), tree));
@@ -535,6 +609,118 @@ void AssemblyTree::delete_curve_tree(const UniqueID assembly_id)
     }
 }
 
+namespace
+{
+    template <typename TreeType>
+    class ChildTreeBuildJob
+      : public IJob
+    {
+      public:
+        ChildTreeBuildJob(
+            Lazy<TreeType>*     tree,
+            double&             build_time)
+          : m_tree(tree)
+          , m_build_time(build_time)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            Stopwatch<DefaultWallclockTimer> stopwatch;
+            stopwatch.start();
+
+            // Accessing the tree forces its construction.
+            Access<TreeType> access(m_tree);
+
+            m_build_time = stopwatch.measure().get_seconds();
+        }
+
+      private:
+        Lazy<TreeType>*         m_tree;
+        double&                 m_build_time;
+    };
+
+    template <typename TreeType>
+    void schedule_child_tree_builds(
+        JobQueue&                                   job_queue,
+        const vector<pair<string, Lazy<TreeType>*>>& trees,
+        double*                                     build_times)
+    {
+        for (size_t i = 0; i < trees.size(); ++i)
+            job_queue.schedule(new ChildTreeBuildJob<TreeType>(trees[i].second, build_times[i]));
+    }
+
+    template <typename TreeType>
+    void insert_child_tree_build_times(
+        Statistics&                                 statistics,
+        const vector<pair<string, Lazy<TreeType>*>>& trees,
+        const double*                               build_times)
+    {
+        for (size_t i = 0; i < trees.size(); ++i)
+            statistics.insert_time(trees[i].first, build_times[i]);
+    }
+}
+
+void AssemblyTree::build_pending_child_trees(const size_t thread_count)
+{
+    const size_t region_tree_count = m_pending_region_trees.size();
+    const size_t triangle_tree_count = m_pending_triangle_trees.size();
+    const size_t curve_tree_count = m_pending_curve_trees.size();
+    const size_t tree_count = region_tree_count + triangle_tree_count + curve_tree_count;
+
+    if (tree_count == 0)
+        return;
+
+    RENDERER_LOG_INFO(
+        "building %s %s using %s %s...",
+        pretty_uint(tree_count).c_str(),
+        plural(tree_count, "child tree").c_str(),
+        pretty_uint(thread_count).c_str(),
+        plural(thread_count, "thread").c_str());
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    vector<double> build_times(tree_count, 0.0);
+    double* region_tree_build_times = &build_times[0];
+    double* triangle_tree_build_times = region_tree_build_times + region_tree_count;
+    double* curve_tree_build_times = triangle_tree_build_times + triangle_tree_count;
+
+    // Build all pending child trees concurrently.
+    JobQueue job_queue;
+    schedule_child_tree_builds(job_queue, m_pending_region_trees, region_tree_build_times);
+    schedule_child_tree_builds(job_queue, m_pending_triangle_trees, triangle_tree_build_times);
+    schedule_child_tree_builds(job_queue, m_pending_curve_trees, curve_tree_build_times);
+
+    JobManager job_manager(
+        global_logger(),
+        job_queue,
+        min(thread_count, tree_count));
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    stopwatch.measure();
+
+    // Print per-tree build times.
+    Statistics statistics;
+    insert_child_tree_build_times(statistics, m_pending_region_trees, region_tree_build_times);
+    insert_child_tree_build_times(statistics, m_pending_triangle_trees, triangle_tree_build_times);
+    insert_child_tree_build_times(statistics, m_pending_curve_trees, curve_tree_build_times);
+    statistics.insert_time("total build time", stopwatch.get_seconds());
+
+    RENDERER_LOG_INFO("%s",
+        StatisticsVector::make(
+            "child tree build statistics",
+            statistics).to_string().c_str());
+}
+
+void AssemblyTree::clear_pending_child_trees()
+{
+    m_pending_region_trees.clear();
+    m_pending_triangle_trees.clear();
+    m_pending_curve_trees.clear();
+}
+
 namespace
 {
     template <typename TreeType>
@@ -699,6 +885,7 @@ bool AssemblyLeafVisitor::visit(
             {
                 // Check the intersection between the ray and the triangle tree.
                 TriangleTreeIntersector intersector;
+                TriangleTreeWideIntersector wide_intersector;
                 TriangleLeafVisitor visitor(*triangle_tree, local_shading_point);
                 if (triangle_tree->get_moving_triangle_count() > 0)
                 {
@@ -710,6 +897,19 @@ bool AssemblyLeafVisitor::visit(
                         visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
                         , m_triangle_tree_stats
+#endif
+                        );
+                }
+                else if (triangle_tree->has_wide_tree())
+                {
+                    wide_intersector.intersect_no_motion(
+                        *triangle_tree,
+                        triangle_tree->get_wide_tree(),
+                        local_shading_point.m_ray,
+                        local_ray_info,
+                        visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                        , m_triangle_tree_stats
 #endif
                         );
                 }
@@ -914,6 +1114,7 @@ bool AssemblyLeafProbeVisitor::visit(
             {
                 // Check the intersection between the ray and the triangle tree.
                 TriangleTreeProbeIntersector intersector;
+                TriangleTreeWideProbeIntersector wide_intersector;
                 TriangleLeafProbeVisitor visitor(*triangle_tree, local_ray.m_time.m_normalized, local_ray.m_flags);
                 if (triangle_tree->get_moving_triangle_count() > 0)
                 {
@@ -925,6 +1126,19 @@ bool AssemblyLeafProbeVisitor::visit(
                         visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
                         , m_triangle_tree_stats
+#endif
+                        );
+                }
+                else if (triangle_tree->has_wide_tree())
+                {
+                    wide_intersector.intersect_no_motion(
+                        *triangle_tree,
+                        triangle_tree->get_wide_tree(),
+                        local_ray,
+                        local_ray_info,
+                        visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                        , m_triangle_tree_stats
 #endif
                         );
                 }
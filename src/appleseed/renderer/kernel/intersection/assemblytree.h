@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/intersection/curvetree.h"
+#include "renderer/kernel/intersection/intersectionsettings.h"
 #include "renderer/kernel/intersection/probevisitorbase.h"
 #include "renderer/kernel/intersection/regiontree.h"
 #include "renderer/kernel/intersection/treerepository.h"
@@ -46,12 +47,15 @@
 #include "foundation/math/aabb.h"
 #include "foundation/math/bvh.h"
 #include "foundation/utility/alignedvector.h"
+#include "foundation/utility/lazy.h"
 #include "foundation/utility/uid.h"
 #include "foundation/utility/version.h"
 
 // Standard headers.
 #include <cstddef>
 #include <map>
+#include <string>
+#include <utility>
 #include <vector>
 
 // Forward declarations.
@@ -75,18 +79,27 @@ class AssemblyTree
            >
 {
   public:
-    // Constructor, builds the tree for a given scene.
-    explicit AssemblyTree(const Scene& scene);
+    // Constructor, builds the tree for a given scene using up to `thread_count` threads.
+    AssemblyTree(
+        const Scene&                            scene,
+        const size_t                            thread_count);
 
     // Destructor.
     ~AssemblyTree();
 
-    // Update the assembly tree and all the child trees.
-    void update();
+    // Update the assembly tree and all the child trees using up to `thread_count` threads.
+    void update(const size_t thread_count);
 
     // Return the size (in bytes) of this object in memory.
     size_t get_memory_size() const;
 
+    // Return true if rays traverse the wide BVH rather than the binary one.
+    bool has_wide_tree() const;
+
+    // Return the wide BVH used to traverse the assembly tree.
+    typedef foundation::bvh::WideTree<foundation::AABB3d, AssemblyTreeWideBVHWidth> WideTreeType;
+    const WideTreeType& get_wide_tree() const;
+
   private:
     friend class AssemblyLeafVisitor;
     friend class AssemblyLeafProbeVisitor;
@@ -118,8 +131,15 @@ class AssemblyTree
     typedef std::vector<const Assembly*> AssemblyVector;
     typedef std::map<foundation::UniqueID, foundation::VersionID> AssemblyVersionMap;
 
+    // Child trees created during the current update, along with a descriptive name.
+    typedef std::vector<std::pair<std::string, foundation::Lazy<RegionTree>*>> PendingRegionTreeVector;
+    typedef std::vector<std::pair<std::string, foundation::Lazy<TriangleTree>*>> PendingTriangleTreeVector;
+    typedef std::vector<std::pair<std::string, foundation::Lazy<CurveTree>*>> PendingCurveTreeVector;
+
     const Scene&                    m_scene;
     ItemVector                      m_items;
+    bool                            m_has_wide_tree;
+    WideTreeType                    m_wide_tree;
     AssemblyVersionMap              m_assembly_versions;
 
     TreeRepository<TriangleTree>    m_triangle_tree_repository;
@@ -131,6 +151,11 @@ class AssemblyTree
     TreeRepository<CurveTree>       m_curve_tree_repository;
     CurveTreeContainer              m_curve_trees;
 
+    PendingRegionTreeVector         m_pending_region_trees;
+    PendingTriangleTreeVector       m_pending_triangle_trees;
+    PendingCurveTreeVector          m_pending_curve_trees;
+    size_t                          m_triangle_tree_build_thread_count;
+
     void collect_assembly_instances(
         const AssemblyInstanceContainer&        assembly_instances,
         const TransformSequence&                parent_transform_seq,
@@ -139,9 +164,14 @@ class AssemblyTree
     void rebuild_assembly_tree();
     void store_items_in_leaves(foundation::Statistics& statistics);
 
-    void update_tree_hierarchy();
+    void update_tree_hierarchy(const size_t thread_count);
     void collect_unique_assemblies(AssemblyVector& assemblies) const;
     void delete_unused_child_trees(const AssemblyVector& assemblies);
+    void collect_outdated_assemblies(
+        const AssemblyVector&                   assemblies,
+        AssemblyVector&                         outdated_assemblies) const;
+    size_t count_triangle_trees_to_build(
+        const AssemblyVector&                   outdated_assemblies) const;
 
     void create_child_trees(const Assembly& assembly);
     void create_region_tree(const Assembly& assembly);
@@ -153,6 +183,9 @@ class AssemblyTree
     void delete_triangle_tree(const foundation::UniqueID assembly_id);
     void delete_curve_tree(const foundation::UniqueID assembly_id);
 
+    void build_pending_child_trees(const size_t thread_count);
+    void clear_pending_child_trees();
+
     void update_region_trees();
     void update_triangle_trees();
 };
@@ -267,6 +300,35 @@ typedef foundation::bvh::Intersector<
     ShadingRay
 > AssemblyTreeProbeIntersector;
 
+typedef foundation::bvh::WideIntersector<
+    AssemblyTree,
+    AssemblyLeafVisitor,
+    ShadingRay,
+    AssemblyTreeWideBVHWidth
+> AssemblyTreeWideIntersector;
+
+typedef foundation::bvh::WideIntersector<
+    AssemblyTree,
+    AssemblyLeafProbeVisitor,
+    ShadingRay,
+    AssemblyTreeWideBVHWidth
+> AssemblyTreeWideProbeIntersector;
+
+
+//
+// AssemblyTree class implementation.
+//
+
+inline bool AssemblyTree::has_wide_tree() const
+{
+    return m_has_wide_tree;
+}
+
+inline const AssemblyTree::WideTreeType& AssemblyTree::get_wide_tree() const
+{
+    return m_wide_tree;
+}
+
 
 //
 // AssemblyLeafVisitor class implementation.
@@ -84,6 +84,7 @@ CurveTree::Arguments::Arguments(
 CurveTree::CurveTree(const Arguments& arguments)
   : TreeType(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
   , m_arguments(arguments)
+  , m_curve_bounds(AlignedAllocator<CurveOBBPacketType>(64))
 {
     // Retrieve construction parameters.
     const MessageContext message_context(
@@ -103,6 +104,7 @@ CurveTree::CurveTree(const Arguments& arguments)
     else throw ExceptionNotImplemented();
     statistics.insert_time("total build time", stopwatch.measure().get_seconds());
     statistics.insert_size("nodes alignment", alignment(&m_nodes[0]));
+    statistics.insert_size("curve bounds size", m_curve_bounds.capacity() * sizeof(CurveOBBPacketType));
 
     // Print curve tree statistics.
     RENDERER_LOG_DEBUG("%s",
@@ -222,6 +224,7 @@ void CurveTree::build_bvh(
         reorder_curve_keys(ordering);
         reorder_curves(ordering);
         reorder_curve_keys_in_leaf_nodes();
+        build_curve_bounds();
     }
 }
 
@@ -302,6 +305,52 @@ void CurveTree::reorder_curve_keys_in_leaf_nodes()
     }
 }
 
+void CurveTree::build_curve_bounds()
+{
+    CurveBoundsVector(m_curve_bounds.get_allocator()).swap(m_curve_bounds);
+
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (!m_nodes[i].is_leaf())
+            continue;
+
+        LeafUserData& user_data = m_nodes[i].get_user_data<LeafUserData>();
+        user_data.m_bounds_offset = static_cast<uint32>(m_curve_bounds.size());
+
+        // Degree-1 curves come first, in the same order as the curve keys of the leaf.
+        const size_t curve_count = user_data.m_curve1_count + user_data.m_curve3_count;
+        for (size_t j = 0; j < curve_count; ++j)
+        {
+            if (j % CurveTreeOBBPacketWidth == 0)
+            {
+                m_curve_bounds.emplace_back();
+                m_curve_bounds.back().clear();
+            }
+
+            GVector3 axes[3];
+            GAABB3 extent;
+
+            if (j < user_data.m_curve1_count)
+            {
+                const Curve1Type& curve = m_curves1[user_data.m_curve1_offset + j];
+                extent = curve.compute_oriented_bbox(axes);
+                extent.grow(GVector3(GScalar(0.5) * curve.compute_max_width()));
+            }
+            else
+            {
+                const Curve3Type& curve = m_curves3[user_data.m_curve3_offset + j - user_data.m_curve1_count];
+                extent = curve.compute_oriented_bbox(axes);
+                extent.grow(GVector3(GScalar(0.5) * curve.compute_max_width()));
+            }
+
+            // Account for rounding errors when projecting rays onto the axes.
+            extent.robust_grow(GScalar(1.0e-6));
+
+            m_curve_bounds.back().add_box(axes, extent);
+        }
+    }
+}
+
 
 //
 // CurveTreeFactory class implementation.
@@ -102,12 +102,16 @@ class CurveTree
         foundation::uint32  m_curve1_count;
         foundation::uint32  m_curve3_offset;
         foundation::uint32  m_curve3_count;
+        foundation::uint32  m_bounds_offset;        // index of the first oriented bounding box packet
     };
 
+    typedef foundation::AlignedVector<CurveOBBPacketType> CurveBoundsVector;
+
     const Arguments         m_arguments;
     std::vector<Curve1Type> m_curves1;
     std::vector<Curve3Type> m_curves3;
     std::vector<CurveKey>   m_curve_keys;
+    CurveBoundsVector       m_curve_bounds;
 
     void collect_curves(std::vector<GAABB3>& curve_bboxes);
 
@@ -124,6 +128,9 @@ class CurveTree
 
     // Reorder curve keys in leaf nodes so that all degree-1 curve keys come before degree-3 ones.
     void reorder_curve_keys_in_leaf_nodes();
+
+    // Compute the oriented bounding boxes of the curves of each leaf node.
+    void build_curve_bounds();
 };
 
 
@@ -275,40 +282,57 @@ inline bool CurveLeafVisitor::visit(
     )
 {
     const CurveTree::LeafUserData& user_data = node.get_user_data<CurveTree::LeafUserData>();
+    const size_t curve_count = user_data.m_curve1_count + user_data.m_curve3_count;
+    const CurveOBBPacketTesterType obb_tester(ray);
 
-    size_t curve_index = node.get_item_index();
     size_t hit_curve_index = ~0;
     GScalar u, v, t = ray.m_tmax;
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t intersected_curves = 0);
 
-    for (foundation::uint32 i = 0; i < user_data.m_curve1_count; ++i, ++curve_index)
+    // Test the oriented bounding boxes of a packet of curves at once, then only
+    // intersect the curves whose bounding box is hit by the ray.
+    for (size_t packet_begin = 0; packet_begin < curve_count; packet_begin += CurveTreeOBBPacketWidth)
     {
-        const Curve1Type& curve = m_tree.m_curves1[user_data.m_curve1_offset + i];
-        if (Curve1IntersectorType::intersect(curve, ray, m_xfm_matrix, u, v, t))
-        {
-            m_shading_point.m_primitive_type = ShadingPoint::PrimitiveCurve1;
-            m_shading_point.m_ray.m_tmax = static_cast<double>(t);
-            m_shading_point.m_bary[0] = static_cast<float>(u);
-            m_shading_point.m_bary[1] = static_cast<float>(v);
-            hit_curve_index = curve_index;
-        }
-    }
+        const CurveOBBPacketType& packet =
+            m_tree.m_curve_bounds[user_data.m_bounds_offset + packet_begin / CurveTreeOBBPacketWidth];
 
-    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(curve1_curve_count));
+        size_t hits = obb_tester.test(packet, t);
 
-    for (foundation::uint32 i = 0; i < user_data.m_curve3_count; ++i, ++curve_index)
-    {
-        const Curve3Type& curve = m_tree.m_curves3[user_data.m_curve3_offset + i];
-        if (Curve3IntersectorType::intersect(curve, ray, m_xfm_matrix, u, v, t))
+        for (size_t i = packet_begin; hits != 0; ++i, hits >>= 1)
         {
-            m_shading_point.m_primitive_type = ShadingPoint::PrimitiveCurve3;
-            m_shading_point.m_ray.m_tmax = static_cast<double>(t);
-            m_shading_point.m_bary[0] = static_cast<float>(u);
-            m_shading_point.m_bary[1] = static_cast<float>(v);
-            hit_curve_index = curve_index;
+            if ((hits & 1) == 0)
+                continue;
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(++intersected_curves);
+
+            if (i < user_data.m_curve1_count)
+            {
+                const Curve1Type& curve = m_tree.m_curves1[user_data.m_curve1_offset + i];
+                if (Curve1IntersectorType::intersect(curve, ray, m_xfm_matrix, u, v, t))
+                {
+                    m_shading_point.m_primitive_type = ShadingPoint::PrimitiveCurve1;
+                    m_shading_point.m_ray.m_tmax = static_cast<double>(t);
+                    m_shading_point.m_bary[0] = static_cast<float>(u);
+                    m_shading_point.m_bary[1] = static_cast<float>(v);
+                    hit_curve_index = node.get_item_index() + i;
+                }
+            }
+            else
+            {
+                const Curve3Type& curve = m_tree.m_curves3[user_data.m_curve3_offset + i - user_data.m_curve1_count];
+                if (Curve3IntersectorType::intersect(curve, ray, m_xfm_matrix, u, v, t))
+                {
+                    m_shading_point.m_primitive_type = ShadingPoint::PrimitiveCurve3;
+                    m_shading_point.m_ray.m_tmax = static_cast<double>(t);
+                    m_shading_point.m_bary[0] = static_cast<float>(u);
+                    m_shading_point.m_bary[1] = static_cast<float>(v);
+                    hit_curve_index = node.get_item_index() + i;
+                }
+            }
         }
     }
 
-    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(curve3_curve_count));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(intersected_curves));
 
     if (hit_curve_index != size_t(~0))
     {
@@ -346,32 +370,40 @@ inline bool CurveLeafProbeVisitor::visit(
     )
 {
     const CurveTree::LeafUserData& user_data = node.get_user_data<CurveTree::LeafUserData>();
+    const size_t curve_count = user_data.m_curve1_count + user_data.m_curve3_count;
+    const CurveOBBPacketTesterType obb_tester(ray);
 
-    for (foundation::uint32 i = 0; i < user_data.m_curve1_count; ++i)
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t intersected_curves = 0);
+
+    for (size_t packet_begin = 0; packet_begin < curve_count; packet_begin += CurveTreeOBBPacketWidth)
     {
-        const Curve1Type& curve = m_tree.m_curves1[user_data.m_curve1_offset + i];
-        if (Curve1IntersectorType::intersect(curve, ray, m_xfm_matrix))
-        {
-            FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(i + 1));
-            m_hit = true;
-            return false;
-        }
-    }
+        const CurveOBBPacketType& packet =
+            m_tree.m_curve_bounds[user_data.m_bounds_offset + packet_begin / CurveTreeOBBPacketWidth];
 
-    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(curve1_curve_count));
+        size_t hits = obb_tester.test(packet, ray.m_tmax);
 
-    for (foundation::uint32 i = 0; i < user_data.m_curve3_count; ++i)
-    {
-        const Curve3Type& curve = m_tree.m_curves3[user_data.m_curve3_offset + i];
-        if (Curve3IntersectorType::intersect(curve, ray, m_xfm_matrix))
+        for (size_t i = packet_begin; hits != 0; ++i, hits >>= 1)
         {
-            FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(i + 1));
-            m_hit = true;
-            return false;
+            if ((hits & 1) == 0)
+                continue;
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(++intersected_curves);
+
+            const bool hit =
+                i < user_data.m_curve1_count
+                    ? Curve1IntersectorType::intersect(m_tree.m_curves1[user_data.m_curve1_offset + i], ray, m_xfm_matrix)
+                    : Curve3IntersectorType::intersect(m_tree.m_curves3[user_data.m_curve3_offset + i - user_data.m_curve1_count], ray, m_xfm_matrix);
+
+            if (hit)
+            {
+                FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(intersected_curves));
+                m_hit = true;
+                return false;
+            }
         }
     }
 
-    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(curve3_curve_count));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(intersected_curves));
 
     // Continue traversal.
     distance = ray.m_tmax;
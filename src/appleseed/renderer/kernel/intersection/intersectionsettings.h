@@ -35,6 +35,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/beziercurve.h"
+#include "foundation/math/intersection/rayobbpacket.h"
 #include "foundation/math/intersection/raytrianglemt.h"
 #include "foundation/math/matrix.h"
 
@@ -57,6 +58,15 @@ const double AssemblyTreeInteriorNodeTraversalCost = 1.0;
 // Relative cost of intersecting an assembly.
 const double AssemblyTreeTriangleIntersectionCost = 10.0;
 
+// Whether to build all new child trees concurrently before rendering instead of on first access.
+const bool AssemblyTreeDefaultParallelChildTreeBuild = false;
+
+// Whether to collapse the assembly tree into a wide BVH and traverse it instead of the binary one.
+const bool AssemblyTreeDefaultWideBVH = false;
+
+// Number of children per node of the wide BVH used to traverse the assembly tree.
+const size_t AssemblyTreeWideBVHWidth = 4;
+
 
 //
 // Region tree settings.
@@ -99,6 +109,10 @@ const GScalar TriangleTreeDefaultTriangleIntersectionCost(1.0);
 // Number of bins used during SBVH construction.
 const size_t TriangleTreeDefaultBinCount = 256;
 
+// Whether leaves store static triangles as indices into a shared vertex array, which
+// roughly halves the memory used by triangles at the cost of an extra indirection.
+const bool TriangleTreeDefaultIndexedLeaves = false;
+
 // Define this symbol to enable reordering the nodes of triangle trees for better
 // locality of reference. Requires a lot of temporary memory for minimal results.
 #undef RENDERER_TRIANGLE_TREE_REORDER_NODES
@@ -113,6 +127,16 @@ const size_t TriangleTreeAccessCacheWays = 2;
 // Size of the stack (in number of nodes) used during traversal.
 const size_t TriangleTreeStackSize = 64;
 
+// Whether to collapse triangle trees without motion into wide BVHs and traverse them instead of the binary ones.
+const bool TriangleTreeDefaultWideBVH = false;
+
+// Number of children per node of the wide BVH used to traverse triangle trees without motion.
+#ifdef APPLESEED_USE_AVX
+const size_t TriangleTreeWideBVHWidth = 8;
+#else
+const size_t TriangleTreeWideBVHWidth = 4;
+#endif
+
 
 //
 // Curve tree settings.
@@ -129,8 +153,19 @@ typedef foundation::BezierCurveIntersector<Curve3Type> Curve3IntersectorType;
 // Matrix used in curve intersections
 typedef foundation::Matrix<GScalar, 4, 4> CurveMatrixType;
 
+// Number of curves whose oriented bounding boxes are tested against a ray at once.
+#ifdef APPLESEED_USE_AVX
+const size_t CurveTreeOBBPacketWidth = 8;
+#else
+const size_t CurveTreeOBBPacketWidth = 4;
+#endif
+
+// Packets of oriented bounding boxes of curves, and the matching ray tester.
+typedef foundation::OBBPacket<GScalar, CurveTreeOBBPacketWidth> CurveOBBPacketType;
+typedef foundation::RayOBBPacketTester<GScalar, CurveTreeOBBPacketWidth> CurveOBBPacketTesterType;
+
 // Maximum number of curves per leaf.
-const size_t CurveTreeDefaultMaxLeafSize = 1;
+const size_t CurveTreeDefaultMaxLeafSize = CurveTreeOBBPacketWidth;
 
 // Relative cost of traversing an interior node.
 const GScalar CurveTreeDefaultInteriorNodeTraversalCost(1.0);
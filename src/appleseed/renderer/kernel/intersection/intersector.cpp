@@ -48,6 +48,7 @@
 
 // Standard headers.
 #include <cassert>
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <string>
@@ -270,7 +271,6 @@ bool Intersector::trace(
     const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
 
     // Check the intersection between the ray and the assembly tree.
-    AssemblyTreeIntersector intersector;
     AssemblyLeafVisitor visitor(
         shading_point,
         assembly_tree,
@@ -282,15 +282,33 @@ bool Intersector::trace(
         , m_triangle_tree_traversal_stats
 #endif
         );
-    intersector.intersect_no_motion(
-        assembly_tree,
-        shading_point.m_ray,
-        ray_info,
-        visitor
+    if (assembly_tree.has_wide_tree())
+    {
+        AssemblyTreeWideIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            assembly_tree.get_wide_tree(),
+            shading_point.m_ray,
+            ray_info,
+            visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-        , m_assembly_tree_traversal_stats
+            , m_assembly_tree_traversal_stats
 #endif
-        );
+            );
+    }
+    else
+    {
+        AssemblyTreeIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            shading_point.m_ray,
+            ray_info,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_tree_traversal_stats
+#endif
+            );
+    }
 
     // Detect and report self-intersections.
     if (m_report_self_intersections)
@@ -326,7 +344,6 @@ bool Intersector::trace_probe(
     const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
 
     // Check the intersection between the ray and the assembly tree.
-    AssemblyTreeProbeIntersector intersector;
     AssemblyLeafProbeVisitor visitor(
         assembly_tree,
         m_region_tree_cache,
@@ -337,19 +354,177 @@ bool Intersector::trace_probe(
         , m_triangle_tree_traversal_stats
 #endif
         );
-    intersector.intersect_no_motion(
-        assembly_tree,
-        ray,
-        ray_info,
-        visitor
+    if (assembly_tree.has_wide_tree())
+    {
+        AssemblyTreeWideProbeIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            assembly_tree.get_wide_tree(),
+            ray,
+            ray_info,
+            visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-        , m_assembly_tree_traversal_stats
+            , m_assembly_tree_traversal_stats
 #endif
-        );
+            );
+    }
+    else
+    {
+        AssemblyTreeProbeIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            ray,
+            ray_info,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_tree_traversal_stats
+#endif
+            );
+    }
 
     return visitor.hit();
 }
 
+namespace
+{
+    const size_t MaxRayChunkSize = 64;
+
+    // Compute an ordering of a chunk of rays in which rays are grouped by direction octant.
+    void sort_by_direction_octant(
+        const ShadingRay*   rays,
+        const size_t        ray_count,
+        uint8*              order)
+    {
+        assert(ray_count <= MaxRayChunkSize);
+
+        size_t octant_offsets[9] = { 0 };
+        uint8 octants[MaxRayChunkSize];
+
+        for (size_t i = 0; i < ray_count; ++i)
+        {
+            const Vector3d& dir = rays[i].m_dir;
+            octants[i] =
+                static_cast<uint8>(
+                    (dir[0] < 0.0 ? 1 : 0) |
+                    (dir[1] < 0.0 ? 2 : 0) |
+                    (dir[2] < 0.0 ? 4 : 0));
+            ++octant_offsets[octants[i] + 1];
+        }
+
+        for (size_t i = 1; i < 9; ++i)
+            octant_offsets[i] += octant_offsets[i - 1];
+
+        for (size_t i = 0; i < ray_count; ++i)
+            order[octant_offsets[octants[i]]++] = static_cast<uint8>(i);
+    }
+}
+
+void Intersector::trace(
+    const ShadingRay*                   rays,
+    const size_t                        ray_count,
+    ShadingPoint*                       shading_points) const
+{
+    assert(rays != nullptr || ray_count == 0);
+    assert(shading_points != nullptr || ray_count == 0);
+
+    uint8 order[MaxRayChunkSize];
+
+    for (size_t chunk_begin = 0; chunk_begin < ray_count; chunk_begin += MaxRayChunkSize)
+    {
+        const size_t chunk_size = min(ray_count - chunk_begin, MaxRayChunkSize);
+
+        sort_by_direction_octant(rays + chunk_begin, chunk_size, order);
+
+        for (size_t i = 0; i < chunk_size; ++i)
+        {
+            const size_t ray_index = chunk_begin + order[i];
+            trace(rays[ray_index], shading_points[ray_index]);
+        }
+    }
+}
+
+void Intersector::trace_probe(
+    const ShadingRay*                   rays,
+    const size_t                        ray_count,
+    bool*                               hits,
+    const ShadingPoint*                 parent_shading_point) const
+{
+    assert(rays != nullptr || ray_count == 0);
+    assert(hits != nullptr || ray_count == 0);
+    assert(parent_shading_point == 0 || parent_shading_point->hit_surface());
+
+    // Update ray casting statistics.
+    m_probe_ray_count += ray_count;
+
+    // Refine and offset the previous intersection point once for the whole batch.
+    if (parent_shading_point &&
+        parent_shading_point->hit_surface() &&
+        !(parent_shading_point->m_members & ShadingPoint::HasRefinedPoints))
+        parent_shading_point->refine_and_offset();
+
+    // Retrieve assembly tree.
+    const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
+
+    uint8 order[MaxRayChunkSize];
+
+    for (size_t chunk_begin = 0; chunk_begin < ray_count; chunk_begin += MaxRayChunkSize)
+    {
+        const size_t chunk_size = min(ray_count - chunk_begin, MaxRayChunkSize);
+        const ShadingRay* chunk_rays = rays + chunk_begin;
+
+        sort_by_direction_octant(chunk_rays, chunk_size, order);
+
+        // Trace the rays of this chunk in sorted order.
+        for (size_t i = 0; i < chunk_size; ++i)
+        {
+            const size_t ray_index = order[i];
+            const ShadingRay& ray = chunk_rays[ray_index];
+            const ShadingRay::RayInfoType ray_info(ray);
+
+            AssemblyLeafProbeVisitor visitor(
+                assembly_tree,
+                m_region_tree_cache,
+                m_triangle_tree_cache,
+                m_curve_tree_cache,
+                parent_shading_point
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , m_triangle_tree_traversal_stats
+                , m_curve_tree_traversal_stats
+#endif
+                );
+            if (assembly_tree.has_wide_tree())
+            {
+                AssemblyTreeWideProbeIntersector intersector;
+                intersector.intersect_no_motion(
+                    assembly_tree,
+                    assembly_tree.get_wide_tree(),
+                    ray,
+                    ray_info,
+                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                    , m_assembly_tree_traversal_stats
+#endif
+                    );
+            }
+            else
+            {
+                AssemblyTreeProbeIntersector intersector;
+                intersector.intersect_no_motion(
+                    assembly_tree,
+                    ray,
+                    ray_info,
+                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                    , m_assembly_tree_traversal_stats
+#endif
+                    );
+            }
+
+            hits[chunk_begin + ray_index] = visitor.hit();
+        }
+    }
+}
+
 void Intersector::make_surface_shading_point(
     ShadingPoint&                       shading_point,
     const ShadingRay&                   shading_ray,
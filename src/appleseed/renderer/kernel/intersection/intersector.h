@@ -98,11 +98,31 @@ class Intersector
         ShadingPoint&                       shading_point,
         const ShadingPoint*                 parent_shading_point = nullptr) const;
 
+    // Trace a batch of world space rays through the scene. This is not a packet
+    // traversal: the rays are traced one at a time by the method above, in an order
+    // that groups them by direction octant so that consecutive traversals visit
+    // similar nodes. The shading points must be cleared. On return, shading_points[i]
+    // holds the intersection of rays[i], exactly as if rays[i] had been traced alone.
+    void trace(
+        const ShadingRay*                   rays,
+        const size_t                        ray_count,
+        ShadingPoint*                       shading_points) const;
+
     // Trace a world space probe ray through the scene.
     bool trace_probe(
         const ShadingRay&                   ray,
         const ShadingPoint*                 parent_shading_point = nullptr) const;
 
+    // Trace a batch of world space probe rays through the scene.
+    // Rays are traced grouped by direction octant so that consecutive traversals
+    // visit the scene in the same order and hit the same nodes in the caches.
+    // On return, hits[i] is true if rays[i] hit the scene.
+    void trace_probe(
+        const ShadingRay*                   rays,
+        const size_t                        ray_count,
+        bool*                               hits,
+        const ShadingPoint*                 parent_shading_point = nullptr) const;
+
     // Manufacture a hit "by hand".
     // There is no restriction placed on the shading point passed to this method.
     // For instance it may have been previously initialized and used.
@@ -520,6 +520,7 @@ double RegionLeafVisitor::visit(
     {
         // Check the intersection between the ray and the triangle tree.
         TriangleTreeIntersector intersector;
+        TriangleTreeWideIntersector wide_intersector;
         TriangleLeafVisitor visitor(*triangle_tree, m_shading_point);
         if (triangle_tree->get_moving_triangle_count() > 0)
         {
@@ -531,6 +532,19 @@ double RegionLeafVisitor::visit(
                 visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
                 , m_triangle_tree_stats
+#endif
+                );
+        }
+        else if (triangle_tree->has_wide_tree())
+        {
+            wide_intersector.intersect_no_motion(
+                *triangle_tree,
+                triangle_tree->get_wide_tree(),
+                ray,
+                ray_info,
+                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , m_triangle_tree_stats
 #endif
                 );
         }
@@ -575,6 +589,7 @@ double RegionLeafProbeVisitor::visit(
     {
         // Check the intersection between the ray and the triangle tree.
         TriangleTreeProbeIntersector intersector;
+        TriangleTreeWideProbeIntersector wide_intersector;
         TriangleLeafProbeVisitor visitor(*triangle_tree, ray.m_time.m_normalized, ray.m_flags);
         if (triangle_tree->get_moving_triangle_count() > 0)
         {
@@ -586,6 +601,19 @@ double RegionLeafProbeVisitor::visit(
                 visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
                 , m_triangle_tree_stats
+#endif
+                );
+        }
+        else if (triangle_tree->has_wide_tree())
+        {
+            wide_intersector.intersect_no_motion(
+                *triangle_tree,
+                triangle_tree->get_wide_tree(),
+                ray,
+                ray_info,
+                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , m_triangle_tree_stats
 #endif
                 );
         }
@@ -101,4 +101,60 @@ void TriangleEncoder::encode(
     }
 }
 
+size_t TriangleEncoder::compute_indexed_size(
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count)
+{
+    size_t size = 0;
+
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        const size_t triangle_index = triangle_indices[item_begin + i];
+        const TriangleVertexInfo& vertex_info = triangle_vertex_infos[triangle_index];
+
+        size += sizeof(uint32);         // visibility flags
+        size += sizeof(uint32);         // motion segment count
+
+        if (vertex_info.m_motion_segment_count == 0)
+            size += 3 * sizeof(uint32);
+        else size += (vertex_info.m_motion_segment_count + 1) * 3 * sizeof(GVector3);
+    }
+
+    return size;
+}
+
+void TriangleEncoder::encode_indexed(
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<GVector3>&             triangle_vertices,
+    const vector<uint32>&               vertex_indices,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count,
+    MemoryWriter&                       writer)
+{
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        const size_t triangle_index = triangle_indices[item_begin + i];
+        const TriangleVertexInfo& vertex_info = triangle_vertex_infos[triangle_index];
+
+        writer.write(vertex_info.m_vis_flags);
+        writer.write(static_cast<uint32>(vertex_info.m_motion_segment_count));
+
+        if (vertex_info.m_motion_segment_count == 0)
+        {
+            writer.write(vertex_indices[vertex_info.m_vertex_index + 0]);
+            writer.write(vertex_indices[vertex_info.m_vertex_index + 1]);
+            writer.write(vertex_indices[vertex_info.m_vertex_index + 2]);
+        }
+        else
+        {
+            writer.write(
+                &triangle_vertices[vertex_info.m_vertex_index],
+                (vertex_info.m_motion_segment_count + 1) * 3 * sizeof(GVector3));
+        }
+    }
+}
+
 }   // namespace renderer
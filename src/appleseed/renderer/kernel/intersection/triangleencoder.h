@@ -33,6 +33,9 @@
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
 // Standard headers.
 #include <cstddef>
 #include <vector>
@@ -60,6 +63,24 @@ class TriangleEncoder
         const size_t                            item_begin,
         const size_t                            item_count,
         foundation::MemoryWriter&               writer);
+
+    // Same as above, but static triangles are stored as three indices into a vertex
+    // array shared by the whole tree. 'vertex_indices' gives the index of every
+    // vertex of 'triangle_vertices' in that shared array.
+    static size_t compute_indexed_size(
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count);
+
+    static void encode_indexed(
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<GVector3>&            triangle_vertices,
+        const std::vector<foundation::uint32>&  vertex_indices,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count,
+        foundation::MemoryWriter&               writer);
 };
 
 }       // namespace renderer
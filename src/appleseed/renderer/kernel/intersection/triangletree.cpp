@@ -56,7 +56,9 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/area.h"
+#include "foundation/math/hash.h"
 #include "foundation/math/intersection/aabbtriangle.h"
+#include "foundation/math/population.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/treeoptimizer.h"
@@ -65,6 +67,7 @@
 #include "foundation/platform/timers.h"
 #include "foundation/utility/alignedallocator.h"
 #include "foundation/utility/api/apistring.h"
+#include "foundation/utility/casts.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/memory.h"
@@ -72,6 +75,9 @@
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// Boost headers.
+#include "boost/unordered/unordered_map.hpp"
+
 // Standard headers.
 #include <algorithm>
 #include <cassert>
@@ -398,12 +404,14 @@ TriangleTree::Arguments::Arguments(
     const UniqueID          triangle_tree_uid,
     const GAABB3&           bbox,
     const Assembly&         assembly,
-    const RegionInfoVector& regions)
+    const RegionInfoVector& regions,
+    const size_t            build_thread_count)
   : m_scene(scene)
   , m_triangle_tree_uid(triangle_tree_uid)
   , m_bbox(bbox)
   , m_assembly(assembly)
   , m_regions(regions)
+  , m_build_thread_count(build_thread_count)
 {
 }
 
@@ -418,6 +426,8 @@ TriangleTree::TriangleTree(const Arguments& arguments)
     const string algorithm = params.get_optional<string>("algorithm", "bvh", make_vector("bvh", "sbvh"), message_context);
     const double time = params.get_optional<double>("time", 0.5);
     const bool save_memory = params.get_optional<bool>("save_temporary_memory", false);
+    m_indexed_leaves = params.get_optional<bool>("indexed_leaves", TriangleTreeDefaultIndexedLeaves);
+    const bool wide_bvh = params.get_optional<bool>("wide_bvh", TriangleTreeDefaultWideBVH);
 
     // Start stopwatch.
     Stopwatch<DefaultWallclockTimer> stopwatch;
@@ -438,6 +448,14 @@ TriangleTree::TriangleTree(const Arguments& arguments)
     assert(m_nodes.size() == m_nodes.capacity());
 #endif
 
+    // Optionally collapse the tree into a wide BVH, unless it has motion.
+    m_has_wide_tree = wide_bvh && m_moving_triangle_count == 0;
+    if (m_has_wide_tree)
+    {
+        m_wide_tree.build(*this);
+        statistics.insert("wide bvh nodes", m_wide_tree.get_node_count());
+    }
+
     // Print triangle tree statistics.
     RENDERER_LOG_DEBUG("%s",
         StatisticsVector::make(
@@ -469,7 +487,9 @@ size_t TriangleTree::get_memory_size() const
         - sizeof(*static_cast<const TreeType*>(this))
         + sizeof(*this)
         + m_triangle_keys.capacity() * sizeof(TriangleKey)
-        + m_leaf_data.capacity() * sizeof(uint8);
+        + m_leaf_data.capacity() * sizeof(uint8)
+        + m_leaf_vertices.capacity() * sizeof(GVector3)
+        + m_wide_tree.get_memory_size() - sizeof(m_wide_tree);
 }
 
 namespace
@@ -493,6 +513,29 @@ namespace
 
     #define RENDERER_LOG_VECTOR_STATS(vec) print_vector_stats(#vec, vec)
 
+    void insert_thread_build_times(
+        Statistics&             statistics,
+        const vector<double>&   thread_build_times)
+    {
+        Population<double> population;
+
+        for (size_t i = 0, e = thread_build_times.size(); i < e; ++i)
+            population.insert(thread_build_times[i]);
+
+        statistics.insert("partition time per thread", population, "s");
+    }
+
+    size_t get_build_thread_count(
+        const TriangleTree::Arguments&  arguments,
+        const ParamArray&               params)
+    {
+        // The thread count chosen by the assembly tree accounts for concurrent builds of other trees.
+        if (arguments.m_build_thread_count > 0)
+            return arguments.m_build_thread_count;
+
+        return params.get_optional<size_t>("build_thread_count", System::get_logical_cpu_core_count());
+    }
+
     size_t count_static_triangles(const vector<TriangleVertexInfo>& info)
     {
         size_t count = 0;
@@ -553,6 +596,7 @@ void TriangleTree::build_bvh(
     const size_t max_leaf_size = params.get_optional<size_t>("max_leaf_size", TriangleTreeDefaultMaxLeafSize);
     const GScalar interior_node_traversal_cost = params.get_optional<GScalar>("interior_node_traversal_cost", TriangleTreeDefaultInteriorNodeTraversalCost);
     const GScalar triangle_intersection_cost = params.get_optional<GScalar>("triangle_intersection_cost", TriangleTreeDefaultTriangleIntersectionCost);
+    const size_t build_thread_count = get_build_thread_count(m_arguments, params);
 
     // Create the partitioner.
     typedef bvh::SAHPartitioner<vector<GAABB3>> Partitioner;
@@ -569,7 +613,9 @@ void TriangleTree::build_bvh(
         *this,
         partitioner,
         triangle_keys.size(),
-        max_leaf_size);
+        max_leaf_size,
+        global_logger(),
+        build_thread_count);
     statistics.merge(
         bvh::TreeStatistics<TriangleTree>(*this, AABB3d(m_arguments.m_bbox)));
 
@@ -608,6 +654,7 @@ void TriangleTree::build_bvh(
 
     statistics.insert_time("collection time", collection_time);
     statistics.insert_time("partition time", builder.get_build_time());
+    insert_thread_build_times(statistics, builder.get_thread_build_times());
     statistics.insert_time("store time", storing_time);
 }
 
@@ -659,6 +706,7 @@ void TriangleTree::build_sbvh(
     const size_t bin_count = params.get_optional<size_t>("bin_count", TriangleTreeDefaultBinCount);
     const GScalar interior_node_traversal_cost = params.get_optional<GScalar>("interior_node_traversal_cost", TriangleTreeDefaultInteriorNodeTraversalCost);
     const GScalar triangle_intersection_cost = params.get_optional<GScalar>("triangle_intersection_cost", TriangleTreeDefaultTriangleIntersectionCost);
+    const size_t build_thread_count = get_build_thread_count(m_arguments, params);
 
     // Create the partitioner.
     typedef bvh::SBVHPartitioner<TriangleItemHandler, vector<AABB3d>> Partitioner;
@@ -685,7 +733,9 @@ void TriangleTree::build_sbvh(
         *this,
         partitioner,
         root_leaf,
-        root_leaf_bbox);
+        root_leaf_bbox,
+        global_logger(),
+        build_thread_count);
     statistics.merge(bvh::TreeStatistics<TriangleTree>(*this, AABB3d(m_arguments.m_bbox)));
 
     // Add splits statistics.
@@ -721,6 +771,7 @@ void TriangleTree::build_sbvh(
 
     statistics.insert_time("collection time", collection_time);
     statistics.insert_time("partition time", builder.get_build_time());
+    insert_thread_build_times(statistics, builder.get_thread_build_times());
     statistics.insert_time("store time", storing_time);
 }
 
@@ -892,6 +943,76 @@ vector<GAABB3> TriangleTree::compute_motion_bboxes(
     }
 }
 
+namespace
+{
+    // Bitwise representation of a vertex, used to find identical vertices.
+    struct VertexKey
+    {
+        uint32 m_bits[3];
+
+        explicit VertexKey(const GVector3& v)
+        {
+            m_bits[0] = binary_cast<uint32>(v.x);
+            m_bits[1] = binary_cast<uint32>(v.y);
+            m_bits[2] = binary_cast<uint32>(v.z);
+        }
+
+        bool operator==(const VertexKey& rhs) const
+        {
+            return
+                m_bits[0] == rhs.m_bits[0] &&
+                m_bits[1] == rhs.m_bits[1] &&
+                m_bits[2] == rhs.m_bits[2];
+        }
+    };
+
+    struct VertexKeyHasher
+    {
+        size_t operator()(const VertexKey& key) const
+        {
+            return mix_uint32(key.m_bits[0], key.m_bits[1], key.m_bits[2]);
+        }
+    };
+
+    // Merge the vertices of static triangles into an array of unique vertices.
+    void build_shared_vertices(
+        const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+        const vector<GVector3>&             triangle_vertices,
+        vector<GVector3>&                   shared_vertices,
+        vector<uint32>&                     vertex_indices)
+    {
+        typedef boost::unordered_map<VertexKey, uint32, VertexKeyHasher> VertexMap;
+
+        VertexMap vertex_map;
+        vertex_indices.assign(triangle_vertices.size(), ~uint32(0));
+
+        for (size_t i = 0, e = triangle_vertex_infos.size(); i < e; ++i)
+        {
+            const TriangleVertexInfo& vertex_info = triangle_vertex_infos[i];
+
+            if (vertex_info.m_motion_segment_count > 0)
+                continue;
+
+            for (size_t j = vertex_info.m_vertex_index; j < vertex_info.m_vertex_index + 3; ++j)
+            {
+                const GVector3& vertex = triangle_vertices[j];
+                const pair<VertexMap::iterator, bool> result =
+                    vertex_map.insert(
+                        make_pair(
+                            VertexKey(vertex),
+                            static_cast<uint32>(shared_vertices.size())));
+
+                if (result.second)
+                    shared_vertices.push_back(vertex);
+
+                vertex_indices[j] = result.first->second;
+            }
+        }
+
+        shrink_to_fit(shared_vertices);
+    }
+}
+
 void TriangleTree::store_triangles(
     const vector<size_t>&               triangle_indices,
     const vector<TriangleVertexInfo>&   triangle_vertex_infos,
@@ -901,11 +1022,24 @@ void TriangleTree::store_triangles(
 {
     const size_t node_count = m_nodes.size();
 
+    // Merge the vertices of static triangles if leaves are indexed.
+    vector<uint32> vertex_indices;
+    if (m_indexed_leaves)
+    {
+        build_shared_vertices(
+            triangle_vertex_infos,
+            triangle_vertices,
+            m_leaf_vertices,
+            vertex_indices);
+    }
+
     // Gather statistics.
 
     size_t leaf_count = 0;
     size_t fat_leaf_count = 0;
     size_t leaf_data_size = 0;
+    size_t encoded_size = 0;
+    size_t full_encoded_size = 0;
 
     for (size_t i = 0; i < node_count; ++i)
     {
@@ -919,15 +1053,32 @@ void TriangleTree::store_triangles(
             const size_t item_count = node.get_item_count();
 
             const size_t leaf_size =
-                TriangleEncoder::compute_size(
-                    triangle_vertex_infos,
-                    triangle_indices,
-                    item_begin,
-                    item_count);
+                m_indexed_leaves
+                    ? TriangleEncoder::compute_indexed_size(
+                          triangle_vertex_infos,
+                          triangle_indices,
+                          item_begin,
+                          item_count)
+                    : TriangleEncoder::compute_size(
+                          triangle_vertex_infos,
+                          triangle_indices,
+                          item_begin,
+                          item_count);
 
-            if (leaf_size < NodeType::MaxUserDataSize)
+            if (leaf_size <= NodeType::MaxUserDataSize - sizeof(uint32))
                 ++fat_leaf_count;
             else leaf_data_size += leaf_size;
+
+            // Keep track of what the full encoding would cost, fat leaves included.
+            encoded_size += leaf_size;
+            full_encoded_size +=
+                m_indexed_leaves
+                    ? TriangleEncoder::compute_size(
+                          triangle_vertex_infos,
+                          triangle_indices,
+                          item_begin,
+                          item_count)
+                    : leaf_size;
         }
     }
 
@@ -956,42 +1107,73 @@ void TriangleTree::store_triangles(
             }
 
             const size_t leaf_size =
-                TriangleEncoder::compute_size(
-                    triangle_vertex_infos,
-                    triangle_indices,
-                    item_begin,
-                    item_count);
+                m_indexed_leaves
+                    ? TriangleEncoder::compute_indexed_size(
+                          triangle_vertex_infos,
+                          triangle_indices,
+                          item_begin,
+                          item_count)
+                    : TriangleEncoder::compute_size(
+                          triangle_vertex_infos,
+                          triangle_indices,
+                          item_begin,
+                          item_count);
 
             MemoryWriter user_data_writer(&node.get_user_data<uint8>());
+            MemoryWriter* writer;
 
             if (leaf_size <= NodeType::MaxUserDataSize - sizeof(uint32))
             {
                 user_data_writer.write<uint32>(~0);
+                writer = &user_data_writer;
+            }
+            else
+            {
+                user_data_writer.write(static_cast<uint32>(leaf_data_writer.offset()));
+                writer = &leaf_data_writer;
+            }
 
-                TriangleEncoder::encode(
+            if (m_indexed_leaves)
+            {
+                TriangleEncoder::encode_indexed(
                     triangle_vertex_infos,
                     triangle_vertices,
+                    vertex_indices,
                     triangle_indices,
                     item_begin,
                     item_count,
-                    user_data_writer);
+                    *writer);
             }
             else
             {
-                user_data_writer.write(static_cast<uint32>(leaf_data_writer.offset()));
-
                 TriangleEncoder::encode(
                     triangle_vertex_infos,
                     triangle_vertices,
                     triangle_indices,
                     item_begin,
                     item_count,
-                    leaf_data_writer);
+                    *writer);
             }
         }
     }
 
+    const size_t shared_vertex_data_size = m_leaf_vertices.size() * sizeof(GVector3);
+    const size_t triangle_data_size = leaf_data_size + shared_vertex_data_size;
+
     statistics.insert_percent("fat leaves", fat_leaf_count, leaf_count);
+    statistics.insert<string>("leaf encoding", m_indexed_leaves ? "indexed" : "full");
+    statistics.insert("shared vertices", m_leaf_vertices.size());
+    statistics.insert_size("shared vertex data size", shared_vertex_data_size);
+    statistics.insert_size("full encoding size", full_encoded_size);
+    statistics.insert_percent(
+        "encoding size vs. full",
+        encoded_size + shared_vertex_data_size,
+        full_encoded_size);
+    statistics.insert_size("leaf data size", leaf_data_size);
+    statistics.insert_size("triangle data size", triangle_data_size);
+    statistics.insert_size(
+        "triangle data per item",
+        triangle_indices.empty() ? 0 : triangle_data_size / triangle_indices.size());
 }
 
 namespace
@@ -1296,6 +1478,26 @@ void TriangleTree::delete_intersection_filters()
     m_intersection_filters.clear();
 }
 
+inline const GTriangleType& TriangleTree::read_static_triangle(
+    MemoryReader&               reader,
+    GTriangleType&              indexed_triangle) const
+{
+    if (!m_indexed_leaves)
+        return reader.read<GTriangleType>();
+
+    const uint32 i0 = reader.read<uint32>();
+    const uint32 i1 = reader.read<uint32>();
+    const uint32 i2 = reader.read<uint32>();
+
+    indexed_triangle =
+        GTriangleType(
+            m_leaf_vertices[i0],
+            m_leaf_vertices[i1],
+            m_leaf_vertices[i2]);
+
+    return indexed_triangle;
+}
+
 
 //
 // TriangleTreeFactory class implementation.
@@ -1393,12 +1595,13 @@ bool TriangleLeafVisitor::visit(
             // Check visibility flags.
             if (!(vis_flags & m_shading_point.m_ray.m_flags))
             {
-                reader += sizeof(GTriangleType);
+                reader += m_tree.m_indexed_leaves ? 3 * sizeof(uint32) : sizeof(GTriangleType);
                 continue;
             }
 
             // Read the triangle, converting it to the right format if necessary.
-            const GTriangleType& triangle = reader.read<GTriangleType>();
+            GTriangleType indexed_triangle;
+            const GTriangleType& triangle = m_tree.read_static_triangle(reader, indexed_triangle);
             const TriangleReader triangle_reader(triangle);
 
             // Intersect the triangle.
@@ -1415,7 +1618,14 @@ bool TriangleLeafVisitor::visit(
                         continue;
                 }
 
-                m_hit_triangle = &triangle;
+                // Triangles of indexed leaves only live on the stack, keep a copy.
+                if (&triangle == &indexed_triangle)
+                {
+                    m_interpolated_triangle = indexed_triangle;
+                    m_hit_triangle = &m_interpolated_triangle;
+                }
+                else m_hit_triangle = &triangle;
+
                 m_hit_triangle_index = triangle_index;
                 m_shading_point.m_ray.m_tmax = t;
                 m_shading_point.m_bary[0] = static_cast<float>(u);
@@ -1545,12 +1755,13 @@ bool TriangleLeafProbeVisitor::visit(
             // Check visibility flags.
             if (!(vis_flags & m_ray_flags))
             {
-                reader += sizeof(GTriangleType);
+                reader += m_tree.m_indexed_leaves ? 3 * sizeof(uint32) : sizeof(GTriangleType);
                 continue;
             }
 
             // Read the triangle, converting it to the right format if necessary.
-            const GTriangleType& triangle = reader.read<GTriangleType>();
+            GTriangleType indexed_triangle;
+            const GTriangleType& triangle = m_tree.read_static_triangle(reader, indexed_triangle);
             const TriangleReader triangle_reader(triangle);
 
             // Intersect the triangle.
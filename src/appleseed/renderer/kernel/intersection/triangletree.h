@@ -57,6 +57,7 @@
 #include <vector>
 
 // Forward declarations.
+namespace foundation    { class MemoryReader; }
 namespace foundation    { class Statistics; }
 namespace renderer      { class Assembly; }
 namespace renderer      { class IntersectionFilter; }
@@ -90,6 +91,7 @@ class TriangleTree
         const GAABB3                            m_bbox;
         const Assembly&                         m_assembly;
         const RegionInfoVector                  m_regions;
+        const size_t                            m_build_thread_count;  // 0 to use the build_thread_count parameter or all logical cores
 
         // Constructor.
         Arguments(
@@ -97,7 +99,8 @@ class TriangleTree
             const foundation::UniqueID          triangle_tree_uid,
             const GAABB3&                       bbox,
             const Assembly&                     assembly,
-            const RegionInfoVector&             regions);
+            const RegionInfoVector&             regions,
+            const size_t                        build_thread_count = 0);
     };
 
     // Constructor, builds the tree for a given set of regions.
@@ -113,6 +116,14 @@ class TriangleTree
     size_t get_static_triangle_count() const;
     size_t get_moving_triangle_count() const;
 
+    // Return true if rays traverse the wide BVH rather than the binary one.
+    // Only trees without moving triangles may have a wide BVH.
+    bool has_wide_tree() const;
+
+    // Return the wide BVH used to traverse the tree.
+    typedef foundation::bvh::WideTree<foundation::AABB3d, TriangleTreeWideBVHWidth> WideTreeType;
+    const WideTreeType& get_wide_tree() const;
+
     // Return the size (in bytes) of this object in memory.
     size_t get_memory_size() const;
 
@@ -125,8 +136,13 @@ class TriangleTree
     size_t                                      m_static_triangle_count;
     size_t                                      m_moving_triangle_count;
 
+    bool                                        m_indexed_leaves;
     std::vector<TriangleKey>                    m_triangle_keys;
     std::vector<foundation::uint8>              m_leaf_data;
+    std::vector<GVector3>                       m_leaf_vertices;    // vertices shared by indexed leaves
+
+    bool                                        m_has_wide_tree;
+    WideTreeType                                m_wide_tree;
 
     IntersectionFilterRepository                m_intersection_filters_repository;
     std::vector<const IntersectionFilter*>      m_intersection_filters;
@@ -158,6 +174,12 @@ class TriangleTree
 
     void update_intersection_filters();
     void delete_intersection_filters();
+
+    // Read a static triangle from a leaf. Triangles of indexed leaves are
+    // assembled from the shared vertices into 'indexed_triangle'.
+    const GTriangleType& read_static_triangle(
+        foundation::MemoryReader&               reader,
+        GTriangleType&                          indexed_triangle) const;
 };
 
 
@@ -291,6 +313,20 @@ typedef foundation::bvh::Intersector<
     TriangleTreeStackSize
 > TriangleTreeProbeIntersector;
 
+typedef foundation::bvh::WideIntersector<
+    TriangleTree,
+    TriangleLeafVisitor,
+    foundation::Ray3d,
+    TriangleTreeWideBVHWidth
+> TriangleTreeWideIntersector;
+
+typedef foundation::bvh::WideIntersector<
+    TriangleTree,
+    TriangleLeafProbeVisitor,
+    foundation::Ray3d,
+    TriangleTreeWideBVHWidth
+> TriangleTreeWideProbeIntersector;
+
 
 //
 // TriangleTree class implementation.
@@ -306,6 +342,16 @@ inline size_t TriangleTree::get_moving_triangle_count() const
     return m_moving_triangle_count;
 }
 
+inline bool TriangleTree::has_wide_tree() const
+{
+    return m_has_wide_tree;
+}
+
+inline const TriangleTree::WideTreeType& TriangleTree::get_wide_tree() const
+{
+    return m_wide_tree;
+}
+
 
 //
 // TriangleLeafVisitor class implementation.
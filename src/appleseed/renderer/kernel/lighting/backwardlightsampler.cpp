@@ -38,6 +38,7 @@
 #include "renderer/modeling/light/light.h"
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/settingsparsing.h"
 
 // Standard headers.
 #include <cassert>
@@ -55,7 +56,8 @@ namespace renderer
 
 BackwardLightSampler::BackwardLightSampler(
     const Scene&                        scene,
-    const ParamArray&                   params)
+    const ParamArray&                   params,
+    LightTreeCache*                     light_tree_cache)
   : LightSamplerBase(params)
 {
     // Read which sampling algorithm should be used.
@@ -139,7 +141,10 @@ BackwardLightSampler::BackwardLightSampler(
         m_light_tree.reset(new LightTree(m_light_tree_lights, m_emitting_triangles));
 
         // Build the light tree.
-        const vector<size_t> tri_index_to_node_index = m_light_tree->build();
+        const vector<size_t> tri_index_to_node_index =
+            m_light_tree->build(
+                light_tree_cache,
+                get_rendering_thread_count(params));
         assert(tri_index_to_node_index.size() == m_emitting_triangles.size());
 
         // Associate light tree nodes to emitting triangles.
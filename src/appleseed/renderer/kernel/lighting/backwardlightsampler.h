@@ -62,10 +62,12 @@ class BackwardLightSampler
   : public LightSamplerBase
 {
   public:
-    // Constructor.
+    // Constructor. If a light tree cache is provided, the light tree is only
+    // rebuilt when the lights have changed since the cached tree was built.
     BackwardLightSampler(
         const Scene&                        scene,
-        const ParamArray&                   params = ParamArray());
+        const ParamArray&                   params = ParamArray(),
+        LightTreeCache*                     light_tree_cache = nullptr);
 
     // Return true if the scene contains at least one non-physical light or emitting triangle.
     bool has_lights() const;
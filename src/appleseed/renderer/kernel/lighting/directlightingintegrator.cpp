@@ -33,6 +33,7 @@
 // appleseed.renderer headers.
 #include "renderer/kernel/lighting/backwardlightsampler.h"
 #include "renderer/kernel/lighting/lightpathstream.h"
+#include "renderer/kernel/lighting/lightsample.h"
 #include "renderer/kernel/lighting/tracer.h"
 #include "renderer/kernel/shading/directshadingcomponents.h"
 #include "renderer/kernel/shading/shadingcontext.h"
@@ -57,6 +58,12 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    // Maximum number of light samples whose shadow rays are traced together.
+    const size_t ShadowRayBatchSize = 16;
+}
+
 //
 // DirectLightingIntegrator class implementation.
 //
@@ -66,14 +73,41 @@ namespace renderer
 //       take_single_material_sample
 //
 //   compute_outgoing_radiance_light_sampling_low_variance
-//       add_emitting_triangle_sample_contribution
-//       add_non_physical_light_sample_contribution
+//       prepare_emitting_triangle_sample
+//       prepare_non_physical_light_sample
+//       flush_pending_light_samples
+//           finish_emitting_triangle_sample
+//           finish_non_physical_light_sample
+//
+//   add_emitting_triangle_sample_contribution
+//       prepare_emitting_triangle_sample
+//       finish_emitting_triangle_sample
+//
+//   add_non_physical_light_sample_contribution
+//       prepare_non_physical_light_sample
+//       finish_non_physical_light_sample
 //
 //   compute_outgoing_radiance_combined_sampling_low_variance
 //       compute_outgoing_radiance_material_sampling
 //       compute_outgoing_radiance_light_sampling_low_variance
 //
 
+struct DirectLightingIntegrator::PendingLightSample
+{
+    LightSample     m_sample;
+    Vector3d        m_target;                           // world space end point of the shadow ray
+    Vector3d        m_incoming;                         // world space incoming direction, unit-length
+
+    // Light-emitting triangle samples.
+    double          m_cos_on;
+    double          m_rcp_sample_square_distance;
+    float           m_contribution_prob;
+
+    // Non-physical light samples.
+    Spectrum        m_light_value;
+    float           m_light_probability;
+};
+
 DirectLightingIntegrator::DirectLightingIntegrator(
     const ShadingContext&           shading_context,
     const BackwardLightSampler&     light_sampler,
@@ -139,6 +173,9 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
     if (!m_material_sampler.contributes_to_light_sampling())
         return;
 
+    PendingLightSample pending[ShadowRayBatchSize];
+    size_t pending_count = 0;
+
     if (m_light_sample_count > 0)
     {
         // Add contributions from non-physical light sources that don't belong to the lightset.
@@ -147,13 +184,33 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
             LightSample sample;
             m_light_sampler.sample_non_physical_light(m_time, i, sample);
 
-            add_non_physical_light_sample_contribution(
-                sampling_context,
-                sample,
-                outgoing,
-                radiance,
-                light_path_stream);
+            if (prepare_non_physical_light_sample(
+                    sampling_context,
+                    sample,
+                    pending[pending_count]))
+            {
+                if (++pending_count == ShadowRayBatchSize)
+                {
+                    flush_pending_light_samples(
+                        pending,
+                        pending_count,
+                        mis_heuristic,
+                        outgoing,
+                        radiance,
+                        light_path_stream);
+                    pending_count = 0;
+                }
+            }
         }
+
+        flush_pending_light_samples(
+            pending,
+            pending_count,
+            mis_heuristic,
+            outgoing,
+            radiance,
+            light_path_stream);
+        pending_count = 0;
     }
 
     // Add contributions from the light set.
@@ -173,28 +230,39 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
                 m_material_sampler.get_shading_point(),
                 sample);
 
-            // Add the contribution of the chosen light.
-            if (sample.m_triangle)
+            // Prepare the contribution of the chosen light.
+            const bool contributes =
+                sample.m_triangle
+                    ? prepare_emitting_triangle_sample(
+                          sampling_context,
+                          sample,
+                          pending[pending_count])
+                    : prepare_non_physical_light_sample(
+                          sampling_context,
+                          sample,
+                          pending[pending_count]);
+
+            if (contributes && ++pending_count == ShadowRayBatchSize)
             {
-                add_emitting_triangle_sample_contribution(
-                    sampling_context,
-                    sample,
+                flush_pending_light_samples(
+                    pending,
+                    pending_count,
                     mis_heuristic,
                     outgoing,
                     lightset_radiance,
                     light_path_stream);
-            }
-            else
-            {
-                add_non_physical_light_sample_contribution(
-                    sampling_context,
-                    sample,
-                    outgoing,
-                    lightset_radiance,
-                    light_path_stream);
+                pending_count = 0;
             }
         }
 
+        flush_pending_light_samples(
+            pending,
+            pending_count,
+            mis_heuristic,
+            outgoing,
+            lightset_radiance,
+            light_path_stream);
+
         if (m_light_sample_count > 1)
             lightset_radiance /= static_cast<float>(m_light_sample_count);
 
@@ -341,6 +409,107 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
     const Dual3d&               outgoing,
     DirectShadingComponents&    radiance,
     LightPathStream*            light_path_stream) const
+{
+    PendingLightSample pending;
+    if (!prepare_emitting_triangle_sample(sampling_context, sample, pending))
+        return;
+
+    // Compute the transmission factor between the light sample and the shading point.
+    Spectrum transmission;
+    m_material_sampler.trace_between(
+        m_shading_context,
+        pending.m_target,
+        transmission);
+
+    finish_emitting_triangle_sample(
+        pending,
+        transmission,
+        mis_heuristic,
+        outgoing,
+        radiance,
+        light_path_stream);
+}
+
+void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
+    SamplingContext&            sampling_context,
+    const LightSample&          sample,
+    const Dual3d&               outgoing,
+    DirectShadingComponents&    radiance,
+    LightPathStream*            light_path_stream) const
+{
+    PendingLightSample pending;
+    if (!prepare_non_physical_light_sample(sampling_context, sample, pending))
+        return;
+
+    // Compute the transmission factor between the light sample and the shading point.
+    Spectrum transmission;
+    m_material_sampler.trace_between(
+        m_shading_context,
+        pending.m_target,
+        transmission);
+
+    finish_non_physical_light_sample(
+        pending,
+        transmission,
+        outgoing,
+        radiance,
+        light_path_stream);
+}
+
+void DirectLightingIntegrator::flush_pending_light_samples(
+    const PendingLightSample*   pending,
+    const size_t                pending_count,
+    const MISHeuristic          mis_heuristic,
+    const Dual3d&               outgoing,
+    DirectShadingComponents&    radiance,
+    LightPathStream*            light_path_stream) const
+{
+    assert(pending_count <= ShadowRayBatchSize);
+
+    if (pending_count == 0)
+        return;
+
+    // Compute the transmission factors between the light samples and the shading point.
+    Vector3d targets[ShadowRayBatchSize];
+    for (size_t i = 0; i < pending_count; ++i)
+        targets[i] = pending[i].m_target;
+
+    Spectrum transmissions[ShadowRayBatchSize];
+    m_material_sampler.trace_between(
+        m_shading_context,
+        targets,
+        pending_count,
+        transmissions);
+
+    // Add the contributions of the light samples in the order they were generated.
+    for (size_t i = 0; i < pending_count; ++i)
+    {
+        if (pending[i].m_sample.m_triangle)
+        {
+            finish_emitting_triangle_sample(
+                pending[i],
+                transmissions[i],
+                mis_heuristic,
+                outgoing,
+                radiance,
+                light_path_stream);
+        }
+        else
+        {
+            finish_non_physical_light_sample(
+                pending[i],
+                transmissions[i],
+                outgoing,
+                radiance,
+                light_path_stream);
+        }
+    }
+}
+
+bool DirectLightingIntegrator::prepare_emitting_triangle_sample(
+    SamplingContext&            sampling_context,
+    const LightSample&          sample,
+    PendingLightSample&         pending) const
 {
     const Material* material = sample.m_triangle->m_material;
     const Material::RenderData& material_data = material->get_render_data();
@@ -348,7 +517,7 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
 
     // No contribution if we are computing indirect lighting but this light does not cast indirect light.
     if (m_indirect && !(edf->get_flags() & EDF::CastIndirectLight))
-        return;
+        return false;
 
     // Compute the incoming direction in world space.
     Vector3d incoming = sample.m_point - m_material_sampler.get_point();
@@ -356,14 +525,14 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
     // No contribution if the shading point is behind the light.
     double cos_on = dot(-incoming, sample.m_shading_normal);
     if (cos_on <= 0.0)
-        return;
+        return false;
 
     // Compute the square distance between the light sample and the shading point.
     const double square_distance = square_norm(incoming);
 
     // Don't use this sample if we're closer than the light near start value.
     if (square_distance < square(edf->get_light_near_start()))
-        return;
+        return false;
 
     const double rcp_sample_square_distance = 1.0 / square_distance;
     const double rcp_sample_distance = sqrt(rcp_sample_square_distance);
@@ -396,16 +565,37 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
 
             // Russian Roulette.
             if (!pass_rr(contribution_prob, s))
-                return;
+                return false;
         }
     }
 
-    // Compute the transmission factor between the light sample and the shading point.
-    Spectrum transmission;
-    m_material_sampler.trace_between(
-        m_shading_context,
-        sample.m_point,
-        transmission);
+    pending.m_sample = sample;
+    pending.m_target = sample.m_point;
+    pending.m_incoming = incoming;
+    pending.m_cos_on = cos_on;
+    pending.m_rcp_sample_square_distance = rcp_sample_square_distance;
+    pending.m_contribution_prob = contribution_prob;
+
+    return true;
+}
+
+void DirectLightingIntegrator::finish_emitting_triangle_sample(
+    const PendingLightSample&   pending,
+    const Spectrum&             transmission,
+    const MISHeuristic          mis_heuristic,
+    const Dual3d&               outgoing,
+    DirectShadingComponents&    radiance,
+    LightPathStream*            light_path_stream) const
+{
+    const LightSample& sample = pending.m_sample;
+    const Vector3d& incoming = pending.m_incoming;
+    const double cos_on = pending.m_cos_on;
+    const double rcp_sample_square_distance = pending.m_rcp_sample_square_distance;
+    const float contribution_prob = pending.m_contribution_prob;
+
+    const Material* material = sample.m_triangle->m_material;
+    const Material::RenderData& material_data = material->get_render_data();
+    const EDF* edf = material_data.m_edf;
 
     // Discard occluded samples.
     if (max_value(transmission) == 0.0f)
@@ -470,18 +660,16 @@ void DirectLightingIntegrator::add_emitting_triangle_sample_contribution(
     }
 }
 
-void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
+bool DirectLightingIntegrator::prepare_non_physical_light_sample(
     SamplingContext&            sampling_context,
     const LightSample&          sample,
-    const Dual3d&               outgoing,
-    DirectShadingComponents&    radiance,
-    LightPathStream*            light_path_stream) const
+    PendingLightSample&         pending) const
 {
     const Light* light = sample.m_light;
 
     // No contribution if we are computing indirect lighting but this light does not cast indirect light.
     if (m_indirect && !(light->get_flags() & Light::CastIndirectLight))
-        return;
+        return false;
 
     // Generate a uniform sample in [0,1).
     SamplingContext child_sampling_context = sampling_context.split(2, 1);
@@ -504,12 +692,28 @@ void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
     // Compute the incoming direction in world space.
     const Vector3d incoming = -emission_direction;
 
-    // Compute the transmission factor between the light sample and the shading point.
-    Spectrum transmission;
-    m_material_sampler.trace_between(
-        m_shading_context,
-        emission_position,
-        transmission);
+    pending.m_sample = sample;
+    pending.m_target = emission_position;
+    pending.m_incoming = incoming;
+    pending.m_light_value = light_value;
+    pending.m_light_probability = probability;
+
+    return true;
+}
+
+void DirectLightingIntegrator::finish_non_physical_light_sample(
+    const PendingLightSample&   pending,
+    const Spectrum&             transmission,
+    const Dual3d&               outgoing,
+    DirectShadingComponents&    radiance,
+    LightPathStream*            light_path_stream) const
+{
+    const LightSample& sample = pending.m_sample;
+    const Light* light = sample.m_light;
+    const Vector3d& emission_position = pending.m_target;
+    const Vector3d& incoming = pending.m_incoming;
+    const float probability = pending.m_light_probability;
+    Spectrum light_value = pending.m_light_value;
 
     // Discard occluded samples.
     if (max_value(transmission) == 0.0f)
@@ -67,6 +67,7 @@ namespace renderer
 //
 //   The number of shadow rays cast by these functions may be as high as the number of light
 //   samples passed to the constructor plus the number of non-physical lights in the scene.
+//   Light samples are generated in batches and the shadow rays of a batch are traced together.
 //
 
 class DirectLightingIntegrator
@@ -125,6 +126,9 @@ class DirectLightingIntegrator
         const foundation::Dual3d&       outgoing,
         DirectShadingComponents&        radiance) const;
 
+    // A light sample waiting for its shadow ray to be traced.
+    struct PendingLightSample;
+
     void add_emitting_triangle_sample_contribution(
         SamplingContext&                sampling_context,
         const LightSample&              sample,
@@ -139,6 +143,43 @@ class DirectLightingIntegrator
         const foundation::Dual3d&       outgoing,
         DirectShadingComponents&        radiance,
         LightPathStream*                light_path_stream) const;
+
+    // Do everything up to (but excluding) the shadow ray.
+    // Return false if the sample does not contribute.
+    bool prepare_emitting_triangle_sample(
+        SamplingContext&                sampling_context,
+        const LightSample&              sample,
+        PendingLightSample&             pending) const;
+
+    bool prepare_non_physical_light_sample(
+        SamplingContext&                sampling_context,
+        const LightSample&              sample,
+        PendingLightSample&             pending) const;
+
+    // Add the contribution of a light sample given the transmission along its shadow ray.
+    void finish_emitting_triangle_sample(
+        const PendingLightSample&       pending,
+        const Spectrum&                 transmission,
+        const foundation::MISHeuristic  mis_heuristic,
+        const foundation::Dual3d&       outgoing,
+        DirectShadingComponents&        radiance,
+        LightPathStream*                light_path_stream) const;
+
+    void finish_non_physical_light_sample(
+        const PendingLightSample&       pending,
+        const Spectrum&                 transmission,
+        const foundation::Dual3d&       outgoing,
+        DirectShadingComponents&        radiance,
+        LightPathStream*                light_path_stream) const;
+
+    // Trace the shadow rays of a batch of light samples and add their contributions.
+    void flush_pending_light_samples(
+        const PendingLightSample*       pending,
+        const size_t                    pending_count,
+        const foundation::MISHeuristic  mis_heuristic,
+        const foundation::Dual3d&       outgoing,
+        DirectShadingComponents&        radiance,
+        LightPathStream*                light_path_stream) const;
 };
 
 }       // namespace renderer
@@ -46,9 +46,11 @@
 #include "foundation/math/sampling/mappings.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -188,56 +190,68 @@ void compute_ibl_environment_sampling(
 
     sampling_context.split_in_place(2, env_sample_count);
 
-    for (size_t i = 0; i < env_sample_count; ++i)
+    // Environment samples are processed in batches so that their shadow rays
+    // can be traced together.
+    const size_t BatchSize = 16;
+    Vector3f incoming[BatchSize];
+    Spectrum env_value[BatchSize];
+    float env_prob[BatchSize];
+    Spectrum transmission[BatchSize];
+
+    for (size_t begin = 0; begin < env_sample_count; begin += BatchSize)
     {
-        // Generate a uniform sample in [0,1)^2.
-        const Vector2f s = sampling_context.next2<Vector2f>();
+        const size_t count = min(env_sample_count - begin, BatchSize);
 
-        // Sample the environment.
-        Vector3f incoming;
-        Spectrum env_value(Spectrum::Illuminance);
-        float env_prob;
-        environment_edf.sample(
-            shading_context,
-            s,
-            incoming,
-            env_value,
-            env_prob);
-        assert(is_normalized(incoming));
+        for (size_t i = 0; i < count; ++i)
+        {
+            // Generate a uniform sample in [0,1)^2.
+            const Vector2f s = sampling_context.next2<Vector2f>();
+
+            // Sample the environment.
+            env_value[i] = Spectrum(Spectrum::Illuminance);
+            environment_edf.sample(
+                shading_context,
+                s,
+                incoming[i],
+                env_value[i],
+                env_prob[i]);
+            assert(is_normalized(incoming[i]));
+        }
 
-        // Discard occluded samples.
-        Spectrum transmission;
-        const ShadingPoint& shading_point = material_sampler.trace(
+        // Trace the shadow rays of this batch.
+        material_sampler.trace_simple(
             shading_context,
             incoming,
+            count,
             transmission);
 
-        if (shading_point.hit_surface())
-            continue;
-        
-        if (max_value(transmission) == 0.0f)
-            continue;
-
-        // Evaluate the BSDF.
-        DirectShadingComponents material_value;
-        const float material_prob = material_sampler.evaluate(
-            env_sampling_modes,
-            Vector3f(outgoing.get_value()),
-            incoming,
-            material_value);
-        if (material_prob == 0.0f)
-            continue;
-
-        // Compute MIS weight.
-        const float mis_weight =
-            mis_power2(
-                env_sample_count * env_prob,
-                material_sample_count * material_prob);
+        for (size_t i = 0; i < count; ++i)
+        {
+            // Discard occluded samples.
+            if (max_value(transmission[i]) == 0.0f)
+                continue;
+
+            // Evaluate the BSDF.
+            DirectShadingComponents material_value;
+            const float material_prob = material_sampler.evaluate(
+                env_sampling_modes,
+                Vector3f(outgoing.get_value()),
+                incoming[i],
+                material_value);
+            if (material_prob == 0.0f)
+                continue;
+
+            // Compute MIS weight.
+            const float mis_weight =
+                mis_power2(
+                    env_sample_count * env_prob[i],
+                    material_sample_count * material_prob);
 
-        // Add the contribution of this sample to the illumination.
-        env_value *= transmission;
-        env_value *= mis_weight / env_prob;
-        madd(radiance, material_value, env_value);
+            // Add the contribution of this sample to the illumination.
+            env_value[i] *= transmission[i];
+            env_value[i] *= mis_weight / env_prob[i];
+            madd(radiance, material_value, env_value[i]);
+        }
     }
 
     if (env_sample_count > 1)
@@ -254,6 +254,10 @@ namespace
             stats.insert("path count", m_path_count);
             stats.insert("path length", m_path_length);
 
+            Population<uint64> arena_high_water_mark;
+            arena_high_water_mark.insert(m_arena.get_high_water_mark());
+            stats.insert("arena high-water mark", arena_high_water_mark, "bytes");
+
             return StatisticsVector::make("light tracing statistics", stats);
         }
 
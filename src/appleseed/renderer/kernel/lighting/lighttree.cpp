@@ -40,14 +40,20 @@
 
 // appleseed.foundation headers.
 #include "foundation/image/colorspace.h"
-#include "foundation/math/distance.h"
-#include "foundation/math/permutation.h"
+#include "foundation/math/hash.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/timers.h"
+#include "foundation/utility/casts.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/memory.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
 #include "foundation/utility/vpythonfile.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <limits>
@@ -58,6 +64,479 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    //
+    // Binary light tree construction.
+    //
+
+    const size_t BinCount = 16;                 // number of bins per axis of the SAH partitioner
+    const size_t MinParallelSubtreeSize = 4096; // smallest number of lights in a subtree built by its own job
+    const uint32 InvalidIndex = ~uint32(0);
+
+    struct BuildItem
+    {
+        AABB3d      m_bbox;
+        Vector3d    m_position;                 // centroid of emitting triangles, position of non-physical lights
+        float       m_importance;
+        size_t      m_light_index;
+        LightType   m_light_type;
+    };
+
+    struct BuildNode
+    {
+        AABB3d      m_bbox;
+        Vector3d    m_position;                 // center of the bounding sphere
+        float       m_importance;
+        uint32      m_children[2];
+        uint32      m_item;                     // item index for leaves, InvalidIndex for inner nodes
+
+        bool is_leaf() const
+        {
+            return m_item != InvalidIndex;
+        }
+    };
+
+    struct SubtreeInfo
+    {
+        uint32              m_node_index;       // index of the placeholder node in the top-level tree
+        size_t              m_begin;
+        size_t              m_end;
+        vector<BuildNode>   m_nodes;
+    };
+
+    class BinaryTreeBuilder
+    {
+      public:
+        BinaryTreeBuilder(
+            const vector<BuildItem>&    items,
+            vector<uint32>&             indices)
+          : m_items(items)
+          , m_indices(indices)
+        {
+        }
+
+        // Build the subtree over indices [begin, end) and return the index of its root node.
+        // If subtrees is not null, subtrees of at most max_subtree_size items are not built
+        // but recorded so that they can be built concurrently.
+        uint32 build(
+            vector<BuildNode>&          nodes,
+            const size_t                begin,
+            const size_t                end,
+            vector<SubtreeInfo>*        subtrees = nullptr,
+            const size_t                max_subtree_size = 0) const
+        {
+            assert(end > begin);
+
+            const uint32 node_index = static_cast<uint32>(nodes.size());
+            nodes.push_back(BuildNode());
+
+            if (end - begin == 1)
+            {
+                const BuildItem& item = m_items[m_indices[begin]];
+                BuildNode& node = nodes[node_index];
+                node.m_bbox = item.m_bbox;
+                node.m_position = item.m_position;
+                node.m_importance = item.m_importance;
+                node.m_children[0] = node.m_children[1] = InvalidIndex;
+                node.m_item = m_indices[begin];
+                return node_index;
+            }
+
+            AABB3d bbox, centroid_bbox;
+            float importance;
+            compute_bounds(begin, end, bbox, centroid_bbox, importance);
+
+            BuildNode& node = nodes[node_index];
+            node.m_bbox = bbox;
+            node.m_position = bbox.center();
+            node.m_importance = importance;
+            node.m_item = InvalidIndex;
+
+            if (subtrees != nullptr && end - begin <= max_subtree_size)
+            {
+                SubtreeInfo subtree;
+                subtree.m_node_index = node_index;
+                subtree.m_begin = begin;
+                subtree.m_end = end;
+                subtrees->push_back(subtree);
+                return node_index;
+            }
+
+            const size_t middle = partition(begin, end, centroid_bbox, importance);
+            const uint32 left = build(nodes, begin, middle, subtrees, max_subtree_size);
+            const uint32 right = build(nodes, middle, end, subtrees, max_subtree_size);
+
+            nodes[node_index].m_children[0] = left;
+            nodes[node_index].m_children[1] = right;
+
+            return node_index;
+        }
+
+      private:
+        struct Bin
+        {
+            AABB3d  m_bbox;
+            float   m_weight;
+            size_t  m_count;
+        };
+
+        const vector<BuildItem>&    m_items;
+        vector<uint32>&             m_indices;
+
+        void compute_bounds(
+            const size_t                begin,
+            const size_t                end,
+            AABB3d&                     bbox,
+            AABB3d&                     centroid_bbox,
+            float&                      importance) const
+        {
+            bbox.invalidate();
+            centroid_bbox.invalidate();
+            importance = 0.0f;
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                const BuildItem& item = m_items[m_indices[i]];
+                bbox.insert(item.m_bbox);
+                centroid_bbox.insert(item.m_position);
+                importance += item.m_importance;
+            }
+        }
+
+        static size_t find_bin(
+            const double                value,
+            const double                min_value,
+            const double                scale)
+        {
+            const double bin = (value - min_value) * scale;
+            return min(static_cast<size_t>(max(bin, 0.0)), BinCount - 1);
+        }
+
+        // Partition [begin, end) so that the sum over both sides of the importance times
+        // the surface area is minimal. Partition by count if all lights have zero importance.
+        size_t partition(
+            const size_t                begin,
+            const size_t                end,
+            const AABB3d&               centroid_bbox,
+            const float                 importance) const
+        {
+            const bool use_importance = importance > 0.0f;
+
+            double best_cost = numeric_limits<double>::max();
+            size_t best_axis = ~size_t(0);
+            size_t best_bin = 0;
+
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                const double extent = centroid_bbox.max[axis] - centroid_bbox.min[axis];
+                if (extent <= 0.0)
+                    continue;
+
+                const double scale = BinCount / extent;
+
+                Bin bins[BinCount];
+                for (size_t b = 0; b < BinCount; ++b)
+                {
+                    bins[b].m_bbox.invalidate();
+                    bins[b].m_weight = 0.0f;
+                    bins[b].m_count = 0;
+                }
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const BuildItem& item = m_items[m_indices[i]];
+                    Bin& bin = bins[find_bin(item.m_position[axis], centroid_bbox.min[axis], scale)];
+                    bin.m_bbox.insert(item.m_bbox);
+                    bin.m_weight += use_importance ? item.m_importance : 1.0f;
+                    ++bin.m_count;
+                }
+
+                // Sweep from the right to compute the cost of the right side of each split.
+                double right_cost[BinCount];
+                size_t right_count[BinCount];
+                AABB3d right_bbox;
+                right_bbox.invalidate();
+                float right_weight = 0.0f;
+                size_t count = 0;
+                for (size_t b = BinCount - 1; b > 0; --b)
+                {
+                    right_bbox.insert(bins[b].m_bbox);
+                    right_weight += bins[b].m_weight;
+                    count += bins[b].m_count;
+                    right_cost[b] = count > 0 ? right_weight * half_surface_area(right_bbox) : 0.0;
+                    right_count[b] = count;
+                }
+
+                // Sweep from the left and evaluate each split.
+                AABB3d left_bbox;
+                left_bbox.invalidate();
+                float left_weight = 0.0f;
+                count = 0;
+                for (size_t b = 0; b < BinCount - 1; ++b)
+                {
+                    left_bbox.insert(bins[b].m_bbox);
+                    left_weight += bins[b].m_weight;
+                    count += bins[b].m_count;
+
+                    if (count == 0 || right_count[b + 1] == 0)
+                        continue;
+
+                    const double cost = left_weight * half_surface_area(left_bbox) + right_cost[b + 1];
+                    if (best_cost > cost)
+                    {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_bin = b;
+                    }
+                }
+            }
+
+            size_t middle = (begin + end) / 2;
+
+            if (best_axis != ~size_t(0))
+            {
+                const double min_value = centroid_bbox.min[best_axis];
+                const double scale = BinCount / (centroid_bbox.max[best_axis] - min_value);
+
+                const vector<uint32>::iterator it =
+                    std::partition(
+                        m_indices.begin() + begin,
+                        m_indices.begin() + end,
+                        [&](const uint32 index)
+                        {
+                            const double value = m_items[index].m_position[best_axis];
+                            return find_bin(value, min_value, scale) <= best_bin;
+                        });
+
+                const size_t split = static_cast<size_t>(it - m_indices.begin());
+                if (split > begin && split < end)
+                    middle = split;
+            }
+
+            return middle;
+        }
+    };
+
+    class SubtreeBuildJob
+      : public IJob
+    {
+      public:
+        SubtreeBuildJob(
+            const BinaryTreeBuilder&    builder,
+            SubtreeInfo&                subtree)
+          : m_builder(builder)
+          , m_subtree(subtree)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            m_builder.build(m_subtree.m_nodes, m_subtree.m_begin, m_subtree.m_end);
+        }
+
+      private:
+        const BinaryTreeBuilder&        m_builder;
+        SubtreeInfo&                    m_subtree;
+    };
+
+    // Build the binary tree. The upper levels are built serially until the remaining
+    // subtrees are small enough, the subtrees are then built concurrently and spliced in.
+    void build_binary_tree(
+        const vector<BuildItem>&        items,
+        const size_t                    thread_count,
+        vector<BuildNode>&              nodes)
+    {
+        vector<uint32> indices(items.size());
+        for (size_t i = 0, e = items.size(); i < e; ++i)
+            indices[i] = static_cast<uint32>(i);
+
+        const BinaryTreeBuilder builder(items, indices);
+
+        if (thread_count <= 1 || items.size() < 2 * MinParallelSubtreeSize)
+        {
+            builder.build(nodes, 0, items.size());
+            return;
+        }
+
+        // Aim for several subtrees per thread to balance the load.
+        const size_t max_subtree_size =
+            max(items.size() / (4 * thread_count), MinParallelSubtreeSize);
+
+        vector<SubtreeInfo> subtrees;
+        builder.build(nodes, 0, items.size(), &subtrees, max_subtree_size);
+
+        JobQueue job_queue;
+        for (size_t i = 0, e = subtrees.size(); i < e; ++i)
+            job_queue.schedule(new SubtreeBuildJob(builder, subtrees[i]));
+
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            min(thread_count, subtrees.size()));
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        // Splice the subtrees into the top-level tree. The root of each subtree
+        // replaces its placeholder node, the other nodes are appended.
+        for (size_t i = 0, e = subtrees.size(); i < e; ++i)
+        {
+            SubtreeInfo& subtree = subtrees[i];
+            const uint32 offset = static_cast<uint32>(nodes.size()) - 1;
+
+            for (size_t j = 0, je = subtree.m_nodes.size(); j < je; ++j)
+            {
+                BuildNode& node = subtree.m_nodes[j];
+                if (!node.is_leaf())
+                {
+                    node.m_children[0] += offset;
+                    node.m_children[1] += offset;
+                }
+            }
+
+            nodes[subtree.m_node_index] = subtree.m_nodes[0];
+            nodes.insert(nodes.end(), subtree.m_nodes.begin() + 1, subtree.m_nodes.end());
+
+            clear_release_memory(subtree.m_nodes);
+        }
+    }
+
+    // Convert the binary subtree rooted at a given node into 4-wide nodes,
+    // append them to the node vector and return the index of the root node.
+    size_t collapse(
+        const vector<BuildItem>&        items,
+        const vector<BuildNode>&        build_nodes,
+        const size_t                    build_node_index,
+        const size_t                    parent_location,
+        const size_t                    level,
+        AlignedVector<LightTreeNode>&   nodes,
+        size_t&                         tree_depth,
+        vector<size_t>&                 tri_index_to_location)
+    {
+        const size_t node_index = nodes.size();
+        nodes.push_back(LightTreeNode());
+        nodes[node_index].m_parent = static_cast<uint32>(parent_location);
+        nodes[node_index].m_level = static_cast<uint32>(level);
+
+        // Gather up to four descendants by repeatedly opening the inner child with the largest surface area.
+        uint32 children[LightTreeNode::MaxChildCount];
+        size_t child_count;
+
+        const BuildNode& build_node = build_nodes[build_node_index];
+        if (build_node.is_leaf())
+        {
+            // Only happens when the tree contains a single light.
+            children[0] = static_cast<uint32>(build_node_index);
+            child_count = 1;
+        }
+        else
+        {
+            children[0] = build_node.m_children[0];
+            children[1] = build_node.m_children[1];
+            child_count = 2;
+
+            while (child_count < LightTreeNode::MaxChildCount)
+            {
+                size_t best_child = ~size_t(0);
+                double best_area = -1.0;
+
+                for (size_t i = 0; i < child_count; ++i)
+                {
+                    const BuildNode& child = build_nodes[children[i]];
+                    if (child.is_leaf())
+                        continue;
+
+                    const double area = half_surface_area(child.m_bbox);
+                    if (best_area < area)
+                    {
+                        best_area = area;
+                        best_child = i;
+                    }
+                }
+
+                if (best_child == ~size_t(0))
+                    break;
+
+                const BuildNode& opened = build_nodes[children[best_child]];
+                children[best_child] = opened.m_children[0];
+                children[child_count++] = opened.m_children[1];
+            }
+        }
+
+        for (size_t i = 0; i < child_count; ++i)
+        {
+            const BuildNode& child = build_nodes[children[i]];
+            const Vector3f center(child.m_position);
+
+            LightTreeNode& node = nodes[node_index];
+            node.m_center_x[i] = center[0];
+            node.m_center_y[i] = center[1];
+            node.m_center_z[i] = center[2];
+            node.m_square_radius[i] = static_cast<float>(child.m_bbox.square_radius());
+            node.m_importance[i] = child.m_importance;
+
+            const size_t location = LightTreeNode::make_location(node_index, i);
+
+            if (child.is_leaf())
+            {
+                node.m_leaf_mask |= 1UL << i;
+                node.m_children[i] = child.m_item;
+
+                const BuildItem& item = items[child.m_item];
+                if (item.m_light_type == EmittingTriangleType)
+                    tri_index_to_location[item.m_light_index] = location;
+
+                // Keep track of the tree depth.
+                if (tree_depth < level + 1)
+                    tree_depth = level + 1;
+            }
+            else
+            {
+                // The recursion may reallocate the node vector.
+                const size_t child_index =
+                    collapse(
+                        items,
+                        build_nodes,
+                        children[i],
+                        location,
+                        level + 1,
+                        nodes,
+                        tree_depth,
+                        tri_index_to_location);
+                nodes[node_index].m_children[i] = static_cast<uint32>(child_index);
+            }
+        }
+
+        nodes[node_index].m_child_count = static_cast<uint32>(child_count);
+
+        return node_index;
+    }
+
+    uint64 hash_double(const double value)
+    {
+        return hash_uint64(binary_cast<uint64>(value));
+    }
+
+    // Compute a signature of the lights that changes whenever their geometry or importance changes.
+    uint64 compute_signature(const vector<BuildItem>& items)
+    {
+        uint64 signature = items.size();
+
+        for (size_t i = 0, e = items.size(); i < e; ++i)
+        {
+            const BuildItem& item = items[i];
+            signature = mix_uint64(signature, item.m_light_index, static_cast<uint64>(item.m_light_type));
+            signature = mix_uint64(signature, binary_cast<uint32>(item.m_importance));
+            signature = mix_uint64(signature, hash_double(item.m_position[0]), hash_double(item.m_position[1]), hash_double(item.m_position[2]));
+            signature = mix_uint64(signature, hash_double(item.m_bbox.min[0]), hash_double(item.m_bbox.min[1]), hash_double(item.m_bbox.min[2]));
+            signature = mix_uint64(signature, hash_double(item.m_bbox.max[0]), hash_double(item.m_bbox.max[1]), hash_double(item.m_bbox.max[2]));
+        }
+
+        return signature;
+    }
+}
+
+
 //
 // LightTree class implementation.
 //
@@ -69,12 +548,19 @@ LightTree::LightTree(
   , m_emitting_triangles(emitting_triangles)
   , m_tree_depth(0)
   , m_is_built(false)
+  , m_is_reused(false)
 {
 }
 
-vector<size_t> LightTree::build()
+vector<size_t> LightTree::build(
+    LightTreeCache*                         cache,
+    const size_t                            thread_count)
 {
-    AABBVector light_bboxes;
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    vector<BuildItem> build_items;
+    build_items.reserve(m_non_physical_lights.size() + m_emitting_triangles.size());
 
     // Collect non-physical light sources.
     for (size_t i = 0, e = m_non_physical_lights.size(); i < e; ++i)
@@ -89,15 +575,18 @@ vector<size_t> LightTree::build()
         // Non physical light has no real size - hence some arbitrary small
         // value is assigned.
         const double BboxSize = 0.001f;
-        const AABB3d bbox = AABB3d(Vector3d(position[0] - BboxSize,
-                                            position[1] - BboxSize,
-                                            position[2] - BboxSize),
-                                   Vector3d(position[0] + BboxSize,
-                                            position[1] + BboxSize,
-                                            position[2] + BboxSize));
-        light_bboxes.push_back(bbox);
-
-        m_items.emplace_back(bbox, i, NonPhysicalLightType);
+
+        // Retrieve the non-physical light importance.
+        Spectrum spectrum;
+        light->get_inputs().find("intensity").source()->evaluate_uniform(spectrum);
+
+        BuildItem item;
+        item.m_bbox = AABB3d(position - Vector3d(BboxSize), position + Vector3d(BboxSize));
+        item.m_position = position;
+        item.m_importance = average_value(spectrum);
+        item.m_light_index = i;
+        item.m_light_type = NonPhysicalLightType;
+        build_items.push_back(item);
     }
 
     // Collect emitting triangles.
@@ -105,143 +594,175 @@ vector<size_t> LightTree::build()
     {
         const EmittingTriangle& triangle = m_emitting_triangles[i];
 
-        AABB3d bbox;
-        bbox.invalidate();
-        bbox.insert(triangle.m_v0);
-        bbox.insert(triangle.m_v1);
-        bbox.insert(triangle.m_v2);
-
-        light_bboxes.push_back(bbox);
-        m_items.emplace_back(bbox, i, EmittingTriangleType);
+        // Retrieve the emitting triangle importance.
+        const EDF* edf = triangle.m_material->get_uncached_edf();
+        assert(edf != nullptr);
+
+        const float max_contribution = edf->get_uncached_max_contribution();
+
+        BuildItem item;
+        item.m_bbox.invalidate();
+        item.m_bbox.insert(triangle.m_v0);
+        item.m_bbox.insert(triangle.m_v1);
+        item.m_bbox.insert(triangle.m_v2);
+        item.m_position = (triangle.m_v0 + triangle.m_v1 + triangle.m_v2) * (1.0 / 3.0);
+
+        // max_contribution is reported as std::numeric_limits<float>::max() when
+        // we can't compute the max_contribution easily (ex: textured lights)
+        // In such cases, we can use a default importance value of 1.0 to avoid
+        // infinite importance values in the light tree nodes.
+        item.m_importance =
+            max_contribution == numeric_limits<float>::max()
+                ? 1.0f
+                : max_contribution * edf->get_uncached_importance_multiplier();
+
+        item.m_light_index = i;
+        item.m_light_type = EmittingTriangleType;
+        build_items.push_back(item);
     }
 
-    // Create the partitioner.
-    typedef bvh::MiddlePartitioner<AABBVector> Partitioner;
-    Partitioner partitioner(light_bboxes);
-
-    // Build the light tree.
-    typedef bvh::Builder<LightTree, Partitioner> Builder;
-    Builder builder;
-    builder.build<DefaultWallclockTimer>(*this, partitioner, m_items.size(), 1);
-
-    // Reorder m_items vector to match the ordering in the LightTree.
-    if (!m_items.empty())
+    if (build_items.empty())
     {
-        m_is_built = true;
-
-        const vector<size_t>& ordering = partitioner.get_item_ordering();
-        assert(m_items.size() == ordering.size());
-
-        // Reorder items according to the tree ordering.
-        ItemVector temp(ordering.size());
-        small_item_reorder(
-            &m_items[0],
-            &temp[0],
-            &ordering[0],
-            ordering.size());
-
-        // Set total node importance and level for each node of the LightTree.
-        IndexLUT tri_index_to_node_index;
-        tri_index_to_node_index.resize(m_emitting_triangles.size());
-        recursive_node_update(0, 0, 0, tri_index_to_node_index);
-
-        // Print light tree statistics.
-        Statistics statistics;
-        statistics.insert("nodes", m_nodes.size());
-        statistics.insert("max tree depth", m_tree_depth);
-        statistics.insert_time("total build time", builder.get_build_time());
-        RENDERER_LOG_INFO("%s",
-            StatisticsVector::make(
-                "light tree statistics",
-                statistics).to_string().c_str());
-        
-        return tri_index_to_node_index;
+        RENDERER_LOG_INFO("no light tree compatible lights in the scene; light tree not built.");
+        return IndexLUT();
     }
 
-    RENDERER_LOG_INFO("no light tree compatible lights in the scene; light tree not built.");
-    return IndexLUT();
-}
-
-bool LightTree::is_built() const
-{
-    return m_is_built;
-}
-
-float LightTree::recursive_node_update(
-    const size_t    parent_index,
-    const size_t    node_index, 
-    const size_t    node_level,
-    IndexLUT&       tri_index_to_node_index)
-{
-    float importance = 0.0f;
-
-    if (!m_nodes[node_index].is_leaf())
-    {
-        const auto& child1 = m_nodes[node_index].get_child_node_index();
-        const auto& child2 = m_nodes[node_index].get_child_node_index() + 1;
+    m_is_built = true;
+    m_is_reused = false;
 
-        const float importance1 = recursive_node_update(node_index, child1, node_level + 1, tri_index_to_node_index);
-        const float importance2 = recursive_node_update(node_index, child2, node_level + 1, tri_index_to_node_index);
+    const uint64 signature = compute_signature(build_items);
 
-        importance = importance1 + importance2;
-    }
-    else
+    // Reuse the cached tree if the lights did not change.
+    if (cache != nullptr)
     {
-        // Retrieve the light source associated to this leaf.
-        const size_t item_index = m_nodes[node_index].get_item_index();
-        const size_t light_index = m_items[item_index].m_light_index;
+        boost::mutex::scoped_lock lock(cache->m_mutex);
 
-        if (m_items[item_index].m_light_type == NonPhysicalLightType)
-        {
-            const Light* light = m_non_physical_lights[light_index].m_light;
-            
-            // Retrieve the non-physical light importance.
-            Spectrum spectrum;
-            light->get_inputs().find("intensity").source()->evaluate_uniform(spectrum);
-            importance = average_value(spectrum);
-        }
-        else
+        if (cache->m_valid && cache->m_signature == signature)
         {
-            assert(m_items[item_index].m_light_type == EmittingTriangleType);
-
-            const EmittingTriangle& triangle = m_emitting_triangles[light_index];
-
-            // Retrieve the emitting triangle importance.
-            const EDF* edf = triangle.m_material->get_uncached_edf();
-            assert(edf != nullptr);
+            m_nodes = cache->m_nodes;
+            m_items = cache->m_items;
+            m_tree_depth = cache->m_tree_depth;
+            m_is_reused = true;
 
-            const float max_contribution = edf->get_uncached_max_contribution();
+            RENDERER_LOG_INFO(
+                "reusing light tree with %s %s.",
+                pretty_uint(m_nodes->size()).c_str(),
+                plural(m_nodes->size(), "node").c_str());
 
-            // max_contribution is reported as std::numeric_limits<float>::max() when
-            // we can't compute the max_contribution easily (ex: textured lights)
-            // In such cases, we can use a default importance value of 1.0 to avoid
-            // infinite importance values in the light tree nodes.
-            if (max_contribution == numeric_limits<float>::max()) 
-                importance = 1.0f;
-            else
-                importance = max_contribution * edf->get_uncached_importance_multiplier();
-    
-            // Save the index of the light tree node containing the EMT in the look up table.
-            tri_index_to_node_index[light_index] = node_index;
+            return cache->m_tri_index_to_location;
         }
+    }
 
-        // Keep track of the tree depth.
-        if (m_tree_depth < node_level)
-            m_tree_depth = node_level;
+    RENDERER_LOG_INFO(
+        "building light tree for %s %s...",
+        pretty_uint(build_items.size()).c_str(),
+        plural(build_items.size(), "light").c_str());
+
+    // Build the binary tree.
+    vector<BuildNode> build_nodes;
+    build_nodes.reserve(2 * build_items.size() - 1);
+    build_binary_tree(build_items, thread_count, build_nodes);
+
+    // Collapse it into 4-wide nodes.
+    IndexLUT tri_index_to_location(m_emitting_triangles.size());
+    shared_ptr<NodeVector> nodes = make_shared<NodeVector>();
+    nodes->reserve(build_items.size() / 2 + 1);
+    collapse(
+        build_items,
+        build_nodes,
+        0,
+        ~uint32(0),
+        0,
+        *nodes,
+        m_tree_depth,
+        tri_index_to_location);
+    m_nodes = nodes;
+
+    shared_ptr<ItemVector> items = make_shared<ItemVector>(build_items.size());
+    for (size_t i = 0, e = build_items.size(); i < e; ++i)
+    {
+        (*items)[i].m_light_index = build_items[i].m_light_index;
+        (*items)[i].m_light_type = build_items[i].m_light_type;
+    }
+    m_items = items;
+
+    stopwatch.measure();
+
+    // Print light tree statistics.
+    Statistics statistics;
+    statistics.insert("lights", build_items.size());
+    statistics.insert("nodes", m_nodes->size());
+    statistics.insert("max tree depth", m_tree_depth);
+    statistics.insert("build threads", thread_count);
+    statistics.insert_time("total build time", stopwatch.get_seconds());
+    RENDERER_LOG_INFO("%s",
+        StatisticsVector::make(
+            "light tree statistics",
+            statistics).to_string().c_str());
+
+    if (cache != nullptr)
+    {
+        boost::mutex::scoped_lock lock(cache->m_mutex);
+
+        cache->m_valid = true;
+        cache->m_signature = signature;
+        cache->m_nodes = m_nodes;
+        cache->m_items = m_items;
+        cache->m_tri_index_to_location = tri_index_to_location;
+        cache->m_tree_depth = m_tree_depth;
     }
 
-    if (node_index == 0)
-        m_nodes[node_index].set_root();
-    else m_nodes[node_index].set_parent(parent_index);
+    return tri_index_to_location;
+}
 
-    m_nodes[node_index].set_importance(importance);
-    m_nodes[node_index].set_level(node_level);
+bool LightTree::is_built() const
+{
+    return m_is_built;
+}
 
-    return importance;
+bool LightTree::is_reused() const
+{
+    return m_is_reused;
+}
+
+void LightTree::get_surface_point_and_normal(
+    const ShadingPoint&     shading_point,
+    Vector3f&               surface_point,
+    Vector3f&               surface_normal)
+{
+    surface_point = Vector3f(shading_point.get_point());
+
+    // [1] "Arbitrary direction D receives light only if dot(D,L) >= 0".
+    const Vector3d& incoming_light_direction = shading_point.get_ray().m_dir;
+    surface_normal =
+        Vector3f(
+            dot(shading_point.get_geometric_normal(), incoming_light_direction) <= 0.0
+                ? shading_point.get_shading_normal()
+                : -shading_point.get_shading_normal());
 }
 
 void LightTree::sample(
     const ShadingPoint&     shading_point,
+    const float             s,
+    LightType&              light_type,
+    size_t&                 light_index,
+    float&                  light_probability) const
+{
+    Vector3f surface_point, surface_normal;
+    get_surface_point_and_normal(shading_point, surface_point, surface_normal);
+
+    sample(
+        surface_point,
+        surface_normal,
+        s,
+        light_type,
+        light_index,
+        light_probability);
+}
+
+void LightTree::sample(
+    const Vector3f&         surface_point,
+    const Vector3f&         surface_normal,
     float                   s,
     LightType&              light_type,
     size_t&                 light_index,
@@ -249,65 +770,84 @@ void LightTree::sample(
 {
     assert(is_built());
 
+    const NodeVector& nodes = *m_nodes;
+    const ItemVector& items = *m_items;
+
     light_probability = 1.0f;
     size_t node_index = 0;
 
-    while (!m_nodes[node_index].is_leaf())
+    while (true)
     {
-        const auto& node = m_nodes[node_index];
+        const LightTreeNode& node = nodes[node_index];
 
-        float p1, p2;
-        child_node_probabilites(node, shading_point, p1, p2);
+        float p[LightTreeNode::MaxChildCount];
+        child_node_probabilities(node, surface_point, surface_normal, p);
 
-        if (s < p1)
+        // Choose a child and rescale the sample to [0, 1) for the next level.
+        size_t slot = 0;
+        float cdf = 0.0f;
+        while (slot + 1 < node.m_child_count && (p[slot] == 0.0f || s >= cdf + p[slot]))
         {
-            light_probability *= p1;
-            s /= p1;
-            node_index = node.get_child_node_index();
+            cdf += p[slot];
+            ++slot;
         }
-        else
+
+        // Rounding may have selected a trailing child with zero probability.
+        while (p[slot] == 0.0f && slot > 0)
+            cdf -= p[--slot];
+
+        assert(p[slot] > 0.0f);
+        light_probability *= p[slot];
+        s = min((s - cdf) / p[slot], 1.0f - numeric_limits<float>::epsilon());
+        s = max(s, 0.0f);
+
+        if (node.is_leaf(slot))
         {
-            light_probability *= p2;
-            s = (s - p1) / p2;
-            node_index = node.get_child_node_index() + 1;
+            const Item& item = items[node.m_children[slot]];
+            light_type = item.m_light_type;
+            light_index = item.m_light_index;
+            return;
         }
-    }
 
-    const size_t item_index = m_nodes[node_index].get_item_index();
-    const Item& item = m_items[item_index];
-    light_type = item.m_light_type;
-    light_index = item.m_light_index;
+        node_index = node.m_children[slot];
+    }
 }
 
 float LightTree::evaluate_node_pdf(
     const ShadingPoint&     shading_point,
-    size_t                  node_index) const
+    const size_t            location) const
+{
+    Vector3f surface_point, surface_normal;
+    get_surface_point_and_normal(shading_point, surface_point, surface_normal);
+
+    return evaluate_node_pdf(surface_point, surface_normal, location);
+}
+
+float LightTree::evaluate_node_pdf(
+    const Vector3f&         surface_point,
+    const Vector3f&         surface_normal,
+    size_t                  location) const
 {
-    size_t parent_index = m_nodes[node_index].get_parent();
+    const NodeVector& nodes = *m_nodes;
+
     float pdf = 1.0f;
 
-    do
+    while (true)
     {
-        const LightTreeNode<AABB3d>& node = m_nodes[parent_index];
+        const LightTreeNode& node = nodes[LightTreeNode::location_node(location)];
 
-        float p1, p2;
-        child_node_probabilites(node, shading_point, p1, p2);
+        float p[LightTreeNode::MaxChildCount];
+        child_node_probabilities(node, surface_point, surface_normal, p);
 
-        pdf *= node.get_child_node_index() == node_index ? p1 : p2;
+        pdf *= p[LightTreeNode::location_slot(location)];
 
-        // Save the child index to be sure which probability should be taken
-        // into consideration.
-        node_index = parent_index;
-        parent_index = m_nodes[node_index].get_parent();
-    } while (!m_nodes[node_index].is_root());
+        if (node.is_root())
+            break;
 
-    return pdf;
-}
+        location = node.m_parent;
+    }
 
-Vector3d LightTree::emitting_triangle_centroid(const size_t triangle_index) const
-{
-    const EmittingTriangle& triangle = m_emitting_triangles[triangle_index];
-    return (triangle.m_v0 + triangle.m_v1 + triangle.m_v2) * (1.0 / 3.0);
+    return pdf;
 }
 
 namespace
@@ -360,93 +900,85 @@ namespace
     }
 }
 
-float LightTree::compute_node_probability(
-    const LightTreeNode<AABB3d>&    node,
-    const AABB3d&                   bbox,
-    const ShadingPoint&             shading_point) const
+void LightTree::child_node_probabilities(
+    const LightTreeNode&    node,
+    const Vector3f&         surface_point,
+    const Vector3f&         surface_normal,
+    float                   probabilities[LightTreeNode::MaxChildCount]) const
 {
-    // Calculate probability of a single node based on its contribution over solid angle.
-    const float r2 = static_cast<float>(bbox.square_radius());
-    const float rcp_surface_area = 1.0f / r2;
-
-    // Triangle centroid is a more precise position than the center of the bbox.
-    Vector3d position;
-    if (node.is_leaf())
+    // Compute the square distance to each child and the cosine of the angle between
+    // the normal and the direction to the child. Unused slots are computed too so
+    // that this loop has a fixed trip count and no branches.
+    float distance2[LightTreeNode::MaxChildCount];
+    float cos_omega[LightTreeNode::MaxChildCount];
+    for (size_t i = 0; i < LightTreeNode::MaxChildCount; ++i)
     {
-        const Item& item = m_items[node.get_item_index()];
-        if (item.m_light_type == EmittingTriangleType)
-            position = emitting_triangle_centroid(item.m_light_index);
-        else position = bbox.center();
+        const float dx = node.m_center_x[i] - surface_point[0];
+        const float dy = node.m_center_y[i] - surface_point[1];
+        const float dz = node.m_center_z[i] - surface_point[2];
+        distance2[i] = max(dx * dx + dy * dy + dz * dz, numeric_limits<float>::min());
+        cos_omega[i] = clamp((surface_normal[0] * dx + surface_normal[1] * dy + surface_normal[2] * dz) / sqrt(distance2[i]), -1.0f, 1.0f);
     }
-    else position = bbox.center();
-
-    const Vector3d& surface_point = shading_point.get_point();
-
-    const float distance2 =
-        static_cast<float>(square_distance(surface_point, position));
-
-    // Evaluated point is outside the bbox.
-    // The original Nathan's implementation returns importance divided by the node surface area.
-    // However, replacing the surface area by the square distance showed to result in less noise.
-    if (distance2 <= r2)
-        return node.get_importance() / distance2;
 
-    //
-    // Implementation of Lambertian lighting model for sub-hemispherical light sources.
-    // Reference:
-    //  [1] Area Light Sources for Real-Time Graphics
-    //      https://www.microsoft.com/en-us/research/wp-content/uploads/1996/03/arealights.pdf
-    //
-    const Vector3d outcoming_light_direction = normalize(bbox.center() - surface_point);
-    const float sin_sigma2 = min(1.0f, (r2 / distance2));
-    const float cos_sigma = sqrt(1.0f - sin_sigma2);
-
-    const Vector3d& incoming_light_direction = shading_point.get_ray().m_dir;
-
-    // [1] "Arbitrary direction D receives light only if dot(D,L) >= 0".
-    const Vector3d& N = (dot(shading_point.get_geometric_normal(), incoming_light_direction) <= 0.0f)
-        ? shading_point.get_shading_normal()
-        : -shading_point.get_shading_normal();
-
-    const float cos_omega = clamp(static_cast<float>(dot(N, outcoming_light_direction)), -1.0f, 1.0f);
-    const float approx_contribution = sub_hemispherical_light_source_contribution(cos_omega, cos_sigma);
-    
-    assert(approx_contribution > 0.0f);
-    return node.get_importance() * rcp_surface_area * approx_contribution;
-}
+    float total = 0.0f;
 
-void LightTree::child_node_probabilites(
-    const LightTreeNode<AABB3d>&    node,
-    const ShadingPoint&             shading_point,
-    float&                          p1,
-    float&                          p2) const
-{
-    const auto& child1 = m_nodes[node.get_child_node_index()];
-    const auto& child2 = m_nodes[node.get_child_node_index() + 1];
+    for (size_t i = 0; i < LightTreeNode::MaxChildCount; ++i)
+    {
+        const float importance = node.m_importance[i];
+        const float r2 = node.m_square_radius[i];
 
-    // Node has currently no info about its own bbox characteristics.
-    // Hence we have to extract it before from its parent.
-    // todo: make LightTreeNode aware of its bbox!
-    const auto& bbox_left = node.get_left_bbox();
-    const auto& bbox_right = node.get_right_bbox();
+        float p;
+        if (importance == 0.0f)
+            p = 0.0f;
+        else if (distance2[i] <= r2)
+        {
+            // The shading point is inside the bounding sphere of the child.
+            // The original Nathan's implementation returns importance divided by the node surface area.
+            // However, replacing the surface area by the square distance showed to result in less noise.
+            p = importance / distance2[i];
+        }
+        else
+        {
+            //
+            // Implementation of Lambertian lighting model for sub-hemispherical light sources.
+            // Reference:
+            //  [1] Area Light Sources for Real-Time Graphics
+            //      https://www.microsoft.com/en-us/research/wp-content/uploads/1996/03/arealights.pdf
+            //
+            const float sin_sigma2 = min(1.0f, r2 / distance2[i]);
+            const float cos_sigma = sqrt(1.0f - sin_sigma2);
+            const float approx_contribution = sub_hemispherical_light_source_contribution(cos_omega[i], cos_sigma);
+            assert(approx_contribution > 0.0f);
+            p = importance / r2 * approx_contribution;
+        }
 
-    p1 = compute_node_probability(child1, bbox_left, shading_point);
-    p2 = compute_node_probability(child2, bbox_right, shading_point);
+        probabilities[i] = p;
+        total += p;
+    }
 
     // Normalize probabilities.
-    const float total = p1 + p2;
     if (total <= 0.0f)
     {
-        p1 = 0.5f;
-        p2 = 0.5f;
+        const float rcp_child_count = 1.0f / node.m_child_count;
+        for (size_t i = 0; i < LightTreeNode::MaxChildCount; ++i)
+            probabilities[i] = i < node.m_child_count ? rcp_child_count : 0.0f;
     }
     else
     {
-        p1 /= total;
-        p2 /= total;
+        const float rcp_total = 1.0f / total;
+        for (size_t i = 0; i < LightTreeNode::MaxChildCount; ++i)
+            probabilities[i] *= rcp_total;
     }
+}
 
-    assert(feq(p1 + p2, 1.0f));
+namespace
+{
+    AABB3d child_bbox(const LightTreeNode& node, const size_t slot)
+    {
+        const Vector3d center(node.m_center_x[slot], node.m_center_y[slot], node.m_center_z[slot]);
+        const Vector3d radius(sqrt(static_cast<double>(node.m_square_radius[slot])));
+        return AABB3d(center - radius, center + radius);
+    }
 }
 
 void LightTree::draw_tree_structure(
@@ -456,6 +988,7 @@ void LightTree::draw_tree_structure(
 {
     // todo: add a possibility to shift each level of bboxes along the z-axis.
 
+    const NodeVector& nodes = *m_nodes;
     const double Width = 0.1;
 
     if (separate_by_levels)
@@ -473,18 +1006,12 @@ void LightTree::draw_tree_structure(
             file.draw_aabb(root_bbox, color, Width);
 
             // Find every node at the parent level and draw its child bboxes.
-            for (size_t i = 0; i < m_nodes.size(); ++i)
+            for (size_t i = 0; i < nodes.size(); ++i)
             {
-                if (m_nodes[i].is_leaf())
-                    continue;
-
-                if (m_nodes[i].get_level() == parent_level)
+                if (nodes[i].m_level == parent_level)
                 {
-                    const auto& bbox_left = m_nodes[i].get_left_bbox();
-                    const auto& bbox_right = m_nodes[i].get_right_bbox();
-
-                    file.draw_aabb(bbox_left, color, Width);
-                    file.draw_aabb(bbox_right, color, Width);
+                    for (size_t j = 0; j < nodes[i].m_child_count; ++j)
+                        file.draw_aabb(child_bbox(nodes[i], j), color, Width);
                 }
             }
         }
@@ -499,25 +1026,40 @@ void LightTree::draw_tree_structure(
         file.draw_aabb(root_bbox, "color.yellow", Width);
 
         // Find nodes on each level of the tree and draw their child bboxes.
-        for (size_t i = 0; i < m_nodes.size(); ++i)
+        for (size_t i = 0; i < nodes.size(); ++i)
         {
-            if (m_nodes[i].is_leaf())
-                continue;
-
             // Make even levels red and odd green.
             const char* color =
-                m_nodes[i].get_level() % 2 != 0
+                nodes[i].m_level % 2 != 0
                     ? "color.red"
                     : "color.green";
 
-            const auto& bbox_left = m_nodes[i].get_left_bbox();
-            const auto& bbox_right = m_nodes[i].get_right_bbox();
-
-            file.draw_aabb(bbox_left, color, Width);
-            file.draw_aabb(bbox_right, color, Width);
+            for (size_t j = 0; j < nodes[i].m_child_count; ++j)
+                file.draw_aabb(child_bbox(nodes[i], j), color, Width);
         }
     }
 }
 
-}   // namespace renderer
 
+//
+// LightTreeCache class implementation.
+//
+
+LightTreeCache::LightTreeCache()
+  : m_valid(false)
+  , m_signature(0)
+  , m_tree_depth(0)
+{
+}
+
+void LightTreeCache::clear()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    m_valid = false;
+    m_nodes.reset();
+    m_items.reset();
+    clear_release_memory(m_tri_index_to_location);
+}
+
+}   // namespace renderer
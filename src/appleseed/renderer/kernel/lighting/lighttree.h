@@ -34,15 +34,21 @@
 #include "renderer/kernel/lighting/lighttypes.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/aabb.h"
-#include "foundation/math/bvh.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/alignedvector.h"
-#include "foundation/utility/statistics.h"
 
 // Standard headers.
 #include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
 
 // Forward declarations.
+namespace renderer  { class LightTreeCache; }
 namespace renderer  { class ShadingPoint; }
 
 namespace renderer
@@ -51,25 +57,32 @@ namespace renderer
 //
 // Light tree.
 //
+// The tree is first built as a binary tree using a binned surface area heuristic
+// weighted by light importance, then collapsed into a tree of 4-wide nodes.
+// Large trees are built in parallel.
+//
 
 class LightTree
-  : public foundation::bvh::Tree<
-               foundation::AlignedVector<
-                   LightTreeNode<foundation::AABB3d>
-               >
-            >
+  : public foundation::NonCopyable
 {
   public:
     // Constructor.
-    // Build the tree based on the lights collected by the BackwardLightSampler.
     LightTree(
         const std::vector<NonPhysicalLightInfo>&      non_physical_lights,
         const std::vector<EmittingTriangle>&          emitting_triangles);
 
-    std::vector<size_t> build();
+    // Build the tree based on the lights collected by the BackwardLightSampler and
+    // return the location in the tree of each emitting triangle. If a cache is
+    // provided and holds a tree built for the same lights, that tree is reused.
+    std::vector<size_t> build(
+        LightTreeCache*                 cache = nullptr,
+        const size_t                    thread_count = 1);
 
     bool is_built() const;
 
+    // Return true if the last call to build() reused the tree held by the cache.
+    bool is_reused() const;
+
     void sample(
         const ShadingPoint&             shading_point,
         const float                     s,
@@ -77,75 +90,100 @@ class LightTree
         size_t&                         light_index,
         float&                          light_probability) const;
 
-    // Compute the light probability of a particular tree node. Start from the
-    // node and go backwards towards the root node.
+    // Same as above, given a surface point and a normal facing the incoming light.
+    void sample(
+        const foundation::Vector3f&     surface_point,
+        const foundation::Vector3f&     surface_normal,
+        float                           s,
+        LightType&                      light_type,
+        size_t&                         light_index,
+        float&                          light_probability) const;
+
+    // Compute the probability of choosing the light at a given location of the
+    // tree, as returned by build(). Start from the location and go backwards
+    // towards the root node.
     float evaluate_node_pdf(
         const ShadingPoint&             surface_point,
-        const size_t                    node_index) const;
+        const size_t                    location) const;
+
+    // Same as above, given a surface point and a normal facing the incoming light.
+    float evaluate_node_pdf(
+        const foundation::Vector3f&     surface_point,
+        const foundation::Vector3f&     surface_normal,
+        size_t                          location) const;
 
   private:
+    friend class LightTreeCache;
+
     struct Item
     {
-        foundation::AABB3d      m_bbox;
-        size_t                  m_light_index;
+        size_t                  m_light_index;      // index in the non-physical lights or emitting triangles vector
         LightType               m_light_type;
-
-        Item() {}
-
-        // Item contains bbox and source index of each light source.
-        // source_index represents the light index in m_light_sources vector.
-        // external_source_index represents the light index in light_tree_lights
-        // and emitting_triangles vectors within the BackwardLightSampler.
-        Item(
-            const foundation::AABB3d&       bbox,
-            const size_t                    light_index,
-            const LightType                 light_type) 
-            : m_bbox(bbox)
-            , m_light_index(light_index)
-            , m_light_type(light_type)
-        {
-        }
     };
 
-    typedef std::vector<NonPhysicalLightInfo>       NonPhysicalLightVector;
-    typedef std::vector<EmittingTriangle>           EmittingTriangleVector;
-    typedef std::vector<Item>                       ItemVector;
-    typedef std::vector<size_t>                     IndexLUT;
-
-    const NonPhysicalLightVector&                   m_non_physical_lights;
-    const EmittingTriangleVector&                   m_emitting_triangles;
-    ItemVector                                      m_items;
-    size_t                                          m_tree_depth;
-    bool                                            m_is_built;
-
-    // Calculate the tree depth.
-    // Assign total importance to each node of the tree, where total importance
-    // represents the sum of all its child nodes importances.
-    float recursive_node_update(
-        const size_t                                parent_index,
-        const size_t                                node_index, 
-        const size_t                                node_level,
-        IndexLUT&                                   tri_index_to_node_index);
-    
-    foundation::Vector3d emitting_triangle_centroid(
-        const size_t                                triangle_index) const;
-
-    float compute_node_probability(
-        const LightTreeNode<foundation::AABB3d>&    node,
-        const foundation::AABB3d&                   bbox,
-        const ShadingPoint&                         shading_point) const;
-
-    void child_node_probabilites(
-        const LightTreeNode<foundation::AABB3d>&    node,
-        const ShadingPoint&                         shading_point,
-        float&                                      p1,
-        float&                                      p2) const;
-
-    // Dump the tree bounding boxes to a VPython file on disk.
+    typedef std::vector<NonPhysicalLightInfo>                   NonPhysicalLightVector;
+    typedef std::vector<EmittingTriangle>                       EmittingTriangleVector;
+    typedef foundation::AlignedVector<LightTreeNode>            NodeVector;
+    typedef std::vector<Item>                                   ItemVector;
+    typedef std::vector<size_t>                                 IndexLUT;
+
+    const NonPhysicalLightVector&                               m_non_physical_lights;
+    const EmittingTriangleVector&                               m_emitting_triangles;
+    std::shared_ptr<const NodeVector>                           m_nodes;
+    std::shared_ptr<const ItemVector>                           m_items;
+    size_t                                                      m_tree_depth;
+    bool                                                        m_is_built;
+    bool                                                        m_is_reused;
+
+    // Retrieve the surface point and the normal facing the incoming light.
+    static void get_surface_point_and_normal(
+        const ShadingPoint&                                     shading_point,
+        foundation::Vector3f&                                   surface_point,
+        foundation::Vector3f&                                   surface_normal);
+
+    // Compute the probability of choosing each child of a node.
+    void child_node_probabilities(
+        const LightTreeNode&                                    node,
+        const foundation::Vector3f&                             surface_point,
+        const foundation::Vector3f&                             surface_normal,
+        float                                                   probabilities[LightTreeNode::MaxChildCount]) const;
+
+    // Dump the bounding boxes of the children's bounding spheres to a VPython file on disk.
     void draw_tree_structure(
-        const std::string&                          filename_base,
-        const foundation::AABB3d&                   root_bbox,
-        const bool                                  separate_by_levels = false) const;
+        const std::string&                                      filename_base,
+        const foundation::AABB3d&                               root_bbox,
+        const bool                                              separate_by_levels = false) const;
+};
+
+
+//
+// A light tree kept across renders.
+//
+// The tree is rebuilt only when the geometry or the importance of the lights changes.
+// Nodes and items are immutable once built and are shared with the light trees
+// using them rather than copied.
+//
+
+class LightTreeCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    LightTreeCache();
+
+    // Forget the cached tree.
+    void clear();
+
+  private:
+    friend class LightTree;
+
+    boost::mutex                                                m_mutex;
+    bool                                                        m_valid;
+    foundation::uint64                                          m_signature;
+    std::shared_ptr<const LightTree::NodeVector>                m_nodes;
+    std::shared_ptr<const LightTree::ItemVector>                m_items;
+    LightTree::IndexLUT                                         m_tri_index_to_location;
+    size_t                                                      m_tree_depth;
 };
 
 }       // namespace renderer
@@ -30,8 +30,8 @@
 #define APPLESEED_RENDERER_KERNEL_LIGHTING_LIGHTTREE_NODE_H
 
 // appleseed.foundation headers.
-#include "foundation/math/aabb.h"
-#include "foundation/math/bvh.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cstddef>
@@ -40,70 +40,87 @@ namespace renderer
 {
 
 //
-// LightTreeNode class implementation.
+// A node of the light tree.
+//
+// Each node has up to four children. The bounding spheres and importances of
+// the children are stored in structure-of-arrays form so that the selection
+// probabilities of all children can be computed together.
 //
 
-template <typename AABB>
-class LightTreeNode
-  : public foundation::bvh::Node<AABB>
+class APPLESEED_SIMD4_ALIGN LightTreeNode
 {
   public:
-    LightTreeNode()
-      : m_importance(0.0f)
-      , m_root(false)
-      , m_parent(0)
-    {
-    }
+    enum { MaxChildCount = 4 };
+
+    float               m_center_x[MaxChildCount];      // center of the bounding sphere of each child
+    float               m_center_y[MaxChildCount];
+    float               m_center_z[MaxChildCount];
+    float               m_square_radius[MaxChildCount]; // square radius of the bounding sphere of each child
+    float               m_importance[MaxChildCount];    // total importance of each child, 0 for unused slots
+    foundation::uint32  m_children[MaxChildCount];      // node index for inner children, item index for leaves
+    foundation::uint32  m_parent;                       // location of this node in its parent, see make_location()
+    foundation::uint32  m_leaf_mask;                    // bit i is set if child i is a leaf
+    foundation::uint32  m_child_count;
+    foundation::uint32  m_level;
+
+    // Constructor. The node has no children.
+    LightTreeNode();
+
+    bool is_leaf(const size_t slot) const;
+    bool is_root() const;
+
+    // A location identifies a child slot of a given node.
+    static foundation::uint32 make_location(const size_t node_index, const size_t slot);
+    static size_t location_node(const size_t location);
+    static size_t location_slot(const size_t location);
+};
 
-    float get_importance() const
-    {
-        return m_importance;
-    }
 
-    size_t get_level() const
-    {
-        return m_tree_level;
-    }
-
-    size_t get_parent() const
-    {
-        return m_parent;
-    }
+//
+// LightTreeNode class implementation.
+//
 
-    bool is_root() const
+inline LightTreeNode::LightTreeNode()
+  : m_parent(~foundation::uint32(0))
+  , m_leaf_mask(0)
+  , m_child_count(0)
+  , m_level(0)
+{
+    for (size_t i = 0; i < MaxChildCount; ++i)
     {
-        return m_root;
+        m_center_x[i] = 0.0f;
+        m_center_y[i] = 0.0f;
+        m_center_z[i] = 0.0f;
+        m_square_radius[i] = 0.0f;
+        m_importance[i] = 0.0f;
+        m_children[i] = 0;
     }
+}
 
-    void set_importance(const float importance)
-    {
-        m_importance = importance;
-    }
+inline bool LightTreeNode::is_leaf(const size_t slot) const
+{
+    return (m_leaf_mask & (1UL << slot)) != 0;
+}
 
-    // todo: set this during the construction
-    void set_level(const size_t node_level)
-    {
-        m_tree_level = node_level;
-    }
+inline bool LightTreeNode::is_root() const
+{
+    return m_parent == ~foundation::uint32(0);
+}
 
-    // todo: set this during the construction
-    void set_parent(const size_t node_parent)
-    {
-        m_parent = node_parent;
-    }
+inline foundation::uint32 LightTreeNode::make_location(const size_t node_index, const size_t slot)
+{
+    return static_cast<foundation::uint32>(node_index * MaxChildCount + slot);
+}
 
-    // todo: set this during the construction
-    void set_root()
-    {
-        m_root = true;
-    }
+inline size_t LightTreeNode::location_node(const size_t location)
+{
+    return location / MaxChildCount;
+}
 
-  private:
-    float   m_importance;
-    size_t  m_tree_level;
-    size_t  m_parent;
-    bool    m_root;
-};
+inline size_t LightTreeNode::location_slot(const size_t location)
+{
+    return location % MaxChildCount;
+}
 
 }       // namespace renderer
 
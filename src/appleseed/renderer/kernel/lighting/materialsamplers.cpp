@@ -38,12 +38,21 @@
 #include "renderer/modeling/bsdf/bsdfsample.h"
 #include "renderer/modeling/volume/volume.h"
 
+// Standard headers.
+#include <algorithm>
+
 using namespace foundation;
 using namespace std;
 
 namespace renderer
 {
 
+namespace
+{
+    // Number of rays built at once by the batched tracing methods.
+    const size_t RayChunkSize = 16;
+}
+
 //
 // BSDFSampler class implementation.
 //
@@ -160,6 +169,55 @@ void BSDFSampler::trace_between(
         transmission);
 }
 
+void BSDFSampler::trace_simple(
+    const ShadingContext&       shading_context,
+    const Vector3f*             directions,
+    const size_t                direction_count,
+    Spectrum*                   transmissions) const
+{
+    ShadingRay rays[RayChunkSize];
+
+    for (size_t begin = 0; begin < direction_count; begin += RayChunkSize)
+    {
+        const size_t count = min(direction_count - begin, RayChunkSize);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            rays[i] =
+                ShadingRay(
+                    m_shading_point.get_point(),
+                    Vector3d(directions[begin + i]),
+                    m_shading_point.get_ray().m_time,
+                    VisibilityFlags::ShadowRay,
+                    m_shading_point.get_ray().m_depth + 1);
+            rays[i].copy_media_from(m_shading_point.get_ray());
+        }
+
+        shading_context.get_tracer().trace_simple(
+            shading_context,
+            m_shading_point,
+            rays,
+            count,
+            transmissions + begin);
+    }
+}
+
+void BSDFSampler::trace_between(
+    const ShadingContext&       shading_context,
+    const Vector3d*             target_positions,
+    const size_t                target_count,
+    Spectrum*                   transmissions) const
+{
+    shading_context.get_tracer().trace_between_simple(
+        shading_context,
+        m_shading_point,
+        target_positions,
+        target_count,
+        m_shading_point.get_ray(),
+        VisibilityFlags::ShadowRay,
+        transmissions);
+}
+
 
 //
 // VolumeSampler class implementation.
@@ -279,4 +337,52 @@ void VolumeSampler::trace_between(
         transmission);
 }
 
+void VolumeSampler::trace_simple(
+    const ShadingContext&       shading_context,
+    const Vector3f*             directions,
+    const size_t                direction_count,
+    Spectrum*                   transmissions) const
+{
+    ShadingRay rays[RayChunkSize];
+
+    for (size_t begin = 0; begin < direction_count; begin += RayChunkSize)
+    {
+        const size_t count = min(direction_count - begin, RayChunkSize);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            rays[i] =
+                ShadingRay(
+                    m_point,
+                    Vector3d(directions[begin + i]),
+                    m_volume_ray.m_time,
+                    VisibilityFlags::ShadowRay,
+                    m_volume_ray.m_depth + 1);
+            rays[i].copy_media_from(m_volume_ray);
+        }
+
+        shading_context.get_tracer().trace_simple(
+            shading_context,
+            rays,
+            count,
+            transmissions + begin);
+    }
+}
+
+void VolumeSampler::trace_between(
+    const ShadingContext&       shading_context,
+    const Vector3d*             target_positions,
+    const size_t                target_count,
+    Spectrum*                   transmissions) const
+{
+    shading_context.get_tracer().trace_between_simple(
+        shading_context,
+        m_point,
+        target_positions,
+        target_count,
+        m_volume_ray,
+        VisibilityFlags::ShadowRay,
+        transmissions);
+}
+
 }   // namespace renderer
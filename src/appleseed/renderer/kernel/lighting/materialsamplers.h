@@ -38,6 +38,9 @@
 #include "foundation/math/dual.h"
 #include "foundation/math/vector.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace renderer  { class BSDF; }
 namespace renderer  { class DirectShadingComponents; }
@@ -72,6 +75,19 @@ class IMaterialSampler
         const foundation::Vector3d&     target_position,
         Spectrum&                       transmission) const = 0;
 
+    // Batched counterparts of trace() and trace_between() that only compute transmission.
+    virtual void trace_simple(
+        const ShadingContext&           shading_context,
+        const foundation::Vector3f*     directions,
+        const size_t                    direction_count,
+        Spectrum*                       transmissions) const = 0;
+
+    virtual void trace_between(
+        const ShadingContext&           shading_context,
+        const foundation::Vector3d*     target_positions,
+        const size_t                    target_count,
+        Spectrum*                       transmissions) const = 0;
+
     virtual bool sample(
         SamplingContext&                sampling_context,
         const foundation::Dual3d&       outgoing,
@@ -112,6 +128,18 @@ class BSDFSampler
         const foundation::Vector3d&     target_position,
         Spectrum&                       transmission) const override;
 
+    void trace_simple(
+        const ShadingContext&           shading_context,
+        const foundation::Vector3f*     directions,
+        const size_t                    direction_count,
+        Spectrum*                       transmissions) const override;
+
+    void trace_between(
+        const ShadingContext&           shading_context,
+        const foundation::Vector3d*     target_positions,
+        const size_t                    target_count,
+        Spectrum*                       transmissions) const override;
+
     bool sample(
         SamplingContext&                sampling_context,
         const foundation::Dual3d&       outgoing,
@@ -161,6 +189,18 @@ class VolumeSampler
         const foundation::Vector3d&     target_position,
         Spectrum&                       transmission) const override;
 
+    void trace_simple(
+        const ShadingContext&           shading_context,
+        const foundation::Vector3f*     directions,
+        const size_t                    direction_count,
+        Spectrum*                       transmissions) const override;
+
+    void trace_between(
+        const ShadingContext&           shading_context,
+        const foundation::Vector3d*     target_positions,
+        const size_t                    target_count,
+        Spectrum*                       transmissions) const override;
+
     bool sample(
         SamplingContext&                sampling_context,
         const foundation::Dual3d&       outgoing,
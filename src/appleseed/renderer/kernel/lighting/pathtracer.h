@@ -36,6 +36,7 @@
 #include "renderer/kernel/intersection/intersector.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/sdtree.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
@@ -87,7 +88,8 @@ class PathTracer
         const size_t            max_specular_bounces,
         const size_t            max_volume_bounces,
         const size_t            max_iterations = 1000,
-        const double            near_start = 0.0);          // abort tracing if the first ray is shorter than this
+        const double            near_start = 0.0,           // abort tracing if the first ray is shorter than this
+        const SDTree*           sd_tree = nullptr);         // optional path guiding structure, only used in non-adjoint mode
 
     size_t trace(
         SamplingContext&        sampling_context,
@@ -102,8 +104,6 @@ class PathTracer
         const ShadingPoint&     shading_point,
         const bool              clear_arena = true);
 
-    const ShadingPoint& get_path_vertex(const size_t i) const;
-
   private:
     PathVisitor&                m_path_visitor;
     VolumeVisitor&              m_volume_visitor;
@@ -115,6 +115,7 @@ class PathTracer
     const size_t                m_max_volume_bounces;
     const size_t                m_max_iterations;
     const double                m_near_start;
+    const SDTree*               m_sd_tree;
     size_t                      m_diffuse_bounces;
     size_t                      m_glossy_bounces;
     size_t                      m_specular_bounces;
@@ -141,6 +142,16 @@ class PathTracer
         BSDFSample&             sample,
         ShadingRay&             ray);
 
+    // Sample the BSDF and the guiding distribution using one-sample MIS.
+    // On return, the probability of the sample is the combined density while
+    // bsdf_prob holds the density of the BSDF alone.
+    void sample_guided_bsdf(
+        SamplingContext&        sampling_context,
+        const PathVertex&       vertex,
+        const DTree&            dtree,
+        BSDFSample&             sample,
+        float&                  bsdf_prob) const;
+
     // This method performs raymarching across the volume.
     // Returns whether the path should be continued.
     bool march(
@@ -167,7 +178,8 @@ inline PathTracer<PathVisitor, VolumeVisitor, Adjoint>::PathTracer(
     const size_t                max_specular_bounces,
     const size_t                max_volume_bounces,
     const size_t                max_iterations,
-    const double                near_start)
+    const double                near_start,
+    const SDTree*               sd_tree)
   : m_path_visitor(path_visitor)
   , m_volume_visitor(volume_visitor)
   , m_rr_min_path_length(rr_min_path_length)
@@ -178,6 +190,7 @@ inline PathTracer<PathVisitor, VolumeVisitor, Adjoint>::PathTracer(
   , m_max_volume_bounces(max_volume_bounces)
   , m_max_iterations(max_iterations)
   , m_near_start(near_start)
+  , m_sd_tree(sd_tree)
 {
 }
 
@@ -218,6 +231,7 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
     vertex.m_shading_point = &shading_point;
     vertex.m_prev_mode = ScatteringMode::Specular;
     vertex.m_prev_prob = BSDF::DiracDelta;
+    vertex.m_prev_sampling_prob = BSDF::DiracDelta;
     vertex.m_aov_mode = ScatteringMode::None;
 
     // This variable tracks the beginning of the path segment inside the current medium.
@@ -668,16 +682,38 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
     if (vertex.m_scattering_modes == ScatteringMode::None)
         return false;
 
-    // Above-surface scattering.
-    if (vertex.m_bssrdf == nullptr)
+    // Retrieve the guiding distribution at this vertex, if any.
+    // Only BSDFs without specular components are guided.
+    const DTree* dtree =
+        !Adjoint &&
+        m_sd_tree != nullptr &&
+        vertex.m_bssrdf == nullptr &&
+        vertex.m_bsdf->is_purely_diffuse_or_glossy()
+            ? m_sd_tree->get_sampling_dtree(vertex.get_point())
+            : nullptr;
+
+    float bsdf_prob;
+
+    if (dtree != nullptr)
     {
-        vertex.m_bsdf->sample(
-            sampling_context,
-            vertex.m_bsdf_data,
-            Adjoint,
-            true,       // multiply by |cos(incoming, normal)|
-            vertex.m_scattering_modes,
-            sample);
+        // Guided above-surface scattering.
+        sample_guided_bsdf(sampling_context, vertex, *dtree, sample, bsdf_prob);
+    }
+    else
+    {
+        // Above-surface scattering.
+        if (vertex.m_bssrdf == nullptr)
+        {
+            vertex.m_bsdf->sample(
+                sampling_context,
+                vertex.m_bsdf_data,
+                Adjoint,
+                true,       // multiply by |cos(incoming, normal)|
+                vertex.m_scattering_modes,
+                sample);
+        }
+
+        bsdf_prob = sample.m_probability;
     }
 
     // Terminate the path if it gets absorbed.
@@ -689,8 +725,11 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
         return false;
 
     // Save the scattering properties for MIS at light-emitting vertices.
+    // Light sampling only knows about the BSDF density, so MIS weights use
+    // it even when the direction was drawn from the guiding distribution.
     vertex.m_prev_mode = sample.m_mode;
-    vertex.m_prev_prob = sample.m_probability;
+    vertex.m_prev_prob = bsdf_prob;
+    vertex.m_prev_sampling_prob = sample.m_probability;
 
     // Update the AOV scattering mode only for the first bounce.
     if (vertex.m_path_length == 1)
@@ -729,6 +768,87 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
     return true;
 }
 
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
+void PathTracer<PathVisitor, VolumeVisitor, Adjoint>::sample_guided_bsdf(
+    SamplingContext&            sampling_context,
+    const PathVertex&           vertex,
+    const DTree&                dtree,
+    BSDFSample&                 sample,
+    float&                      bsdf_prob) const
+{
+    const float bsdf_sampling_fraction = m_sd_tree->get_bsdf_sampling_fraction();
+
+    sampling_context.split_in_place(1, 1);
+    const float s = sampling_context.next2<float>();
+
+    float guide_prob;
+
+    if (s < bsdf_sampling_fraction)
+    {
+        // Sample the BSDF.
+        vertex.m_bsdf->sample(
+            sampling_context,
+            vertex.m_bsdf_data,
+            Adjoint,
+            true,       // multiply by |cos(incoming, normal)|
+            vertex.m_scattering_modes,
+            sample);
+
+        if (sample.m_mode == ScatteringMode::None)
+            return;
+
+        bsdf_prob = sample.m_probability;
+
+        // Some glossy BSDFs degenerate to perfect mirrors; such directions
+        // can only be produced by this strategy.
+        if (bsdf_prob == BSDF::DiracDelta)
+        {
+            sample.m_value /= bsdf_sampling_fraction;
+            return;
+        }
+
+        guide_prob = dtree.evaluate_pdf(sample.m_incoming.get_value());
+    }
+    else
+    {
+        // Sample the guiding distribution.
+        sampling_context.split_in_place(2, 1);
+        const foundation::Vector3f incoming =
+            dtree.sample(sampling_context.next2<foundation::Vector2f>(), guide_prob);
+
+        bsdf_prob =
+            vertex.m_bsdf->evaluate(
+                vertex.m_bsdf_data,
+                Adjoint,
+                true,   // multiply by |cos(incoming, normal)|
+                sample.m_geometric_normal,
+                sample.m_shading_basis,
+                sample.m_outgoing.get_value(),
+                incoming,
+                vertex.m_scattering_modes,
+                sample.m_value);
+
+        if (bsdf_prob == 0.0f)
+        {
+            sample.m_mode = ScatteringMode::None;
+            return;
+        }
+
+        sample.m_mode =
+            ScatteringMode::has_diffuse(vertex.m_scattering_modes & vertex.m_bsdf->get_modes())
+                ? ScatteringMode::Diffuse
+                : ScatteringMode::Glossy;
+        sample.m_incoming = foundation::Dual3f(incoming);
+    }
+
+    sample.m_probability =
+        bsdf_sampling_fraction * bsdf_prob +
+        (1.0f - bsdf_sampling_fraction) * guide_prob;
+
+    if (sample.m_probability <= 0.0f)
+        sample.m_mode = ScatteringMode::None;
+}
+
 template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
 bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::march(
     SamplingContext&            sampling_context,
@@ -795,49 +915,118 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::march(
             break;
         }
 
-        // Retrieve extinction spectrum.
-        const Spectrum& extinction_coef =
-            volume->extinction_coefficient(vertex.m_volume_data, volume_ray);
-
-        // Sample channel uniformly at random.
-        sampling_context.split_in_place(1, 1);
-        const float s = sampling_context.next2<float>();
-        const size_t channel = foundation::truncate<size_t>(s * Spectrum::size());
-        const bool extinction_is_null = extinction_coef[channel] < 1.0e-6f;
+        float distance_sample;
 
-        // Sample distance.
-        float distance_sample, distance_pdf;
-        if (extinction_is_null)
-        {
-            distance_sample = 0.0f;
-            distance_pdf = 0.0f;
-        }
-        else
+        if (volume->is_homogeneous())
         {
+            // Retrieve extinction spectrum.
+            const Spectrum& extinction_coef =
+                volume->extinction_coefficient(vertex.m_volume_data, volume_ray);
+
+            // Sample channel uniformly at random.
             sampling_context.split_in_place(1, 1);
-            distance_sample =
-                foundation::sample_exponential_distribution(
-                    sampling_context.next2<float>(),
-                    extinction_coef[channel]);
-            distance_pdf =
-                foundation::exponential_distribution_pdf(
-                    distance_sample,
-                    extinction_coef[channel]);
-        }
+            const float s = sampling_context.next2<float>();
+            const size_t channel = foundation::truncate<size_t>(s * Spectrum::size());
+            const bool extinction_is_null = extinction_coef[channel] < 1.0e-6f;
 
-        // Continue path tracing if sampled distance exceeds total length of the ray,
-        // otherwise process the scattering event.
-        if (extinction_is_null || volume_ray.m_tmax < distance_sample)
-        {
+            // Sample distance.
+            float distance_pdf;
+            if (extinction_is_null)
+            {
+                distance_sample = 0.0f;
+                distance_pdf = 0.0f;
+            }
+            else
+            {
+                sampling_context.split_in_place(1, 1);
+                distance_sample =
+                    foundation::sample_exponential_distribution(
+                        sampling_context.next2<float>(),
+                        extinction_coef[channel]);
+                distance_pdf =
+                    foundation::exponential_distribution_pdf(
+                        distance_sample,
+                        extinction_coef[channel]);
+            }
+
+            // Continue path tracing if sampled distance exceeds total length of the ray,
+            // otherwise process the scattering event.
+            if (extinction_is_null || volume_ray.m_tmax < distance_sample)
+            {
+                Spectrum transmission;
+                volume->evaluate_transmission(
+                    vertex.m_volume_data,
+                    volume_ray,
+                    transmission);
+                vertex.m_throughput *= transmission;
+                vertex.m_throughput /=                       // equivalent to multiplying by MIS weight
+                    foundation::average_value(transmission); // and then dividing by transmission[channel]
+                break;
+            }
+
+            // Retrieve scattering spectrum.
+            const Spectrum& scattering_coef =
+                volume->scattering_coefficient(vertex.m_volume_data, volume_ray);
+
+            // Evaluate transmission between the origin and the sampled distance.
             Spectrum transmission;
             volume->evaluate_transmission(
                 vertex.m_volume_data,
                 volume_ray,
+                distance_sample,
                 transmission);
+
+            // Compute MIS weight.
+            // MIS terms are:
+            //  - scattering albedo,
+            //  - throughput of the entire path up to the sampled point.
+            // Reference: "Practical and Controllable Subsurface Scattering
+            // for Production Path Tracing", p. 1 [ACM 2016 Article].
+            float mis_weights_sum = 0.0f;
+            for (size_t i = 0, e = Spectrum::size(); i < e; ++i)
+            {
+                if (extinction_coef[i] > 1.0e-6f)
+                {
+                    const float probability =
+                        foundation::exponential_distribution_pdf(
+                            distance_sample,
+                            extinction_coef[i]);
+
+                    mis_weights_sum += foundation::square(probability);
+                }
+            }
+            if (mis_weights_sum < 1.0e-6f)
+                return false;  // no scattering
+            const float current_mis_weight =
+                Spectrum::size() *
+                foundation::square(distance_pdf) /
+                mis_weights_sum;
+
+            vertex.m_throughput *= scattering_coef;
             vertex.m_throughput *= transmission;
-            vertex.m_throughput /=                       // equivalent to multiplying by MIS weight
-                foundation::average_value(transmission); // and then dividing by transmission[channel]
-            break;
+            vertex.m_throughput *= current_mis_weight / distance_pdf;
+        }
+        else
+        {
+            // Sample a free-flight distance by delta tracking. The returned weight
+            // accounts for the transmission and the scattering coefficient.
+            Spectrum weight;
+            const bool scattered =
+                volume->sample_distance(
+                    sampling_context,
+                    vertex.m_volume_data,
+                    volume_ray,
+                    distance_sample,
+                    weight);
+            vertex.m_throughput *= weight;
+
+            // Continue path tracing if no real collision occurred along the ray.
+            if (!scattered)
+            {
+                if (foundation::is_zero(weight))
+                    return false;
+                break;
+            }
         }
 
         //
@@ -857,48 +1046,6 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::march(
         // Let the volume visitor handle the scattering event.
         m_volume_visitor.on_scatter(vertex);
 
-        // Retrieve scattering spectrum.
-        const Spectrum& scattering_coef =
-            volume->scattering_coefficient(vertex.m_volume_data, volume_ray);
-
-        // Evaluate transmission between the origin and the sampled distance.
-        Spectrum transmission;
-        volume->evaluate_transmission(
-            vertex.m_volume_data,
-            volume_ray,
-            distance_sample,
-            transmission);
-        
-        // Compute MIS weight.
-        // MIS terms are:
-        //  - scattering albedo,
-        //  - throughput of the entire path up to the sampled point.
-        // Reference: "Practical and Controllable Subsurface Scattering
-        // for Production Path Tracing", p. 1 [ACM 2016 Article].
-        float mis_weights_sum = 0.0f;
-        for (size_t i = 0, e = Spectrum::size(); i < e; ++i)
-        {
-            if (extinction_coef[i] > 1.0e-6f)
-            {
-                const float probability =
-                    foundation::exponential_distribution_pdf(
-                        distance_sample,
-                        extinction_coef[i]);
-
-                mis_weights_sum += foundation::square(probability);
-            }
-        }
-        if (mis_weights_sum < 1.0e-6f)
-            return false;  // no scattering
-        const float current_mis_weight =
-            Spectrum::size() *
-            foundation::square(distance_pdf) /
-            mis_weights_sum;
-
-        vertex.m_throughput *= scattering_coef;
-        vertex.m_throughput *= transmission;
-        vertex.m_throughput *= current_mis_weight / distance_pdf;
-
         // Sample phase function.
         foundation::Vector3f incoming;
         const float pdf = volume->sample(
@@ -911,6 +1058,7 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::march(
         // Save the scattering properties for MIS at light-emitting vertices.
         vertex.m_prev_mode = ScatteringMode::Volume;
         vertex.m_prev_prob = pdf;
+        vertex.m_prev_sampling_prob = pdf;
 
         // Update the AOV scattering mode only for the first bounce.
         if (vertex.m_path_length == 1)
@@ -942,12 +1090,6 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::march(
     return true;
 }
 
-template<typename PathVisitor, typename VolumeVisitor, bool Adjoint>
-inline const ShadingPoint& PathTracer<PathVisitor, VolumeVisitor, Adjoint>::get_path_vertex(const size_t i) const
-{
-    return reinterpret_cast<const ShadingPoint*>(m_shading_point_arena.get_storage())[i];
-}
-
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_PATHTRACER_H
@@ -88,6 +88,7 @@ class PathVertex
     // Properties of the scattering event leading to this vertex.
     ScatteringMode::Mode        m_prev_mode;
     float                       m_prev_prob;
+    float                       m_prev_sampling_prob;   // actual sampling density, differs from m_prev_prob with path guiding
 
     // AOV properties.
     ScatteringMode::Mode        m_aov_mode;
@@ -40,6 +40,7 @@
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/sdtree.h"
 #include "renderer/kernel/lighting/volumelightingintegrator.h"
 #include "renderer/kernel/shading/shadingcomponents.h"
 #include "renderer/kernel/shading/shadingcontext.h"
@@ -52,6 +53,7 @@
 #include "renderer/utility/stochasticcast.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/aabb.h"
 #include "foundation/math/mis.h"
 #include "foundation/math/population.h"
 #include "foundation/math/vector.h"
@@ -97,6 +99,7 @@ namespace
         PTLightingEngine(
             const BackwardLightSampler&     light_sampler,
             LightPathRecorder&              light_path_recorder,
+            SDTree*                         sd_tree,
             const ParamArray&               params)
           : m_params(params)
           , m_light_sampler(light_sampler)
@@ -104,6 +107,7 @@ namespace
               m_params.m_record_light_paths
                   ? light_path_recorder.create_stream()
                   : nullptr)
+          , m_sd_tree(sd_tree)
           , m_path_count(0)
           , m_inf_volume_ray_warnings(0)
         {
@@ -133,7 +137,9 @@ namespace
                 "  ibl env samples               %s\n"
                 "  max ray intensity             %s\n"
                 "  volume distance samples       %s\n"
-                "  equiangular sampling          %s",
+                "  equiangular sampling          %s\n"
+                "  path guiding                  %s\n"
+                "  guiding bsdf fraction         %s",
                 m_params.m_enable_dl ? "on" : "off",
                 m_params.m_enable_ibl ? "on" : "off",
                 m_params.m_enable_caustics ? "on" : "off",
@@ -149,7 +155,9 @@ namespace
                 pretty_scalar(m_params.m_ibl_env_sample_count).c_str(),
                 m_params.m_has_max_ray_intensity ? pretty_scalar(m_params.m_max_ray_intensity).c_str() : "unlimited",
                 pretty_int(m_params.m_distance_sample_count).c_str(),
-                m_params.m_enable_equiangular_sampling ? "on" : "off");
+                m_params.m_enable_equiangular_sampling ? "on" : "off",
+                m_sd_tree != nullptr ? "on" : "off",
+                m_sd_tree != nullptr ? pretty_scalar(m_sd_tree->get_bsdf_sampling_fraction(), 2).c_str() : "n/a");
         }
 
         void compute_lighting(
@@ -195,6 +203,8 @@ namespace
             const ShadingPoint&     shading_point,
             ShadingComponents&      radiance)               // output radiance, in W.sr^-1.m^-2
         {
+            GuidedPath guided_path(m_sd_tree);
+
             PathVisitor path_visitor(
                 m_params,
                 m_light_sampler,
@@ -202,7 +212,8 @@ namespace
                 shading_context,
                 shading_point.get_scene(),
                 radiance,
-                m_light_path_stream);
+                m_light_path_stream,
+                guided_path);
 
             VolumeVisitor volume_visitor(
                 m_params,
@@ -222,7 +233,9 @@ namespace
                 m_params.m_max_glossy_bounces,
                 m_params.m_max_specular_bounces,
                 m_params.m_max_volume_bounces,
-                shading_context.get_max_iterations());
+                shading_context.get_max_iterations(),
+                0.0,                                                        // near_start
+                m_sd_tree);
 
             const size_t path_length =
                 path_tracer.trace(
@@ -230,6 +243,9 @@ namespace
                     shading_context,
                     shading_point);
 
+            // Train the path guiding structure with the radiance found along the path.
+            guided_path.splat(radiance.m_beauty);
+
             // Update statistics.
             ++m_path_count;
             m_path_length.insert(path_length);
@@ -321,6 +337,7 @@ namespace
         const Parameters                m_params;
         const BackwardLightSampler&     m_light_sampler;
         LightPathStream*                m_light_path_stream;
+        SDTree*                         m_sd_tree;
 
         uint64                          m_path_count;
         Population<uint64>              m_path_length;
@@ -365,6 +382,7 @@ namespace
             const EnvironmentEDF*               m_env_edf;
             ShadingComponents&                  m_path_radiance;
             LightPathStream*                    m_light_path_stream;
+            GuidedPath&                         m_guided_path;
             bool                                m_omit_emitted_light;
 
             PathVisitorBase(
@@ -374,7 +392,8 @@ namespace
                 const ShadingContext&           shading_context,
                 const Scene&                    scene,
                 ShadingComponents&              path_radiance,
-                LightPathStream*                light_path_stream)
+                LightPathStream*                light_path_stream,
+                GuidedPath&                     guided_path)
               : m_params(params)
               , m_light_sampler(light_sampler)
               , m_sampling_context(sampling_context)
@@ -382,9 +401,30 @@ namespace
               , m_env_edf(scene.get_environment()->get_environment_edf())
               , m_path_radiance(path_radiance)
               , m_light_path_stream(light_path_stream)
+              , m_guided_path(guided_path)
               , m_omit_emitted_light(false)
             {
             }
+
+            void begin_guided_vertex(const PathVertex& vertex)
+            {
+                if (vertex.m_bssrdf == nullptr)
+                    m_guided_path.begin_vertex(vertex.get_point(), m_path_radiance.m_beauty);
+            }
+
+            void end_guided_vertex(const PathVertex& vertex)
+            {
+                // Only train the guiding structure with directions sampled from diffuse or glossy BSDFs.
+                if (vertex.m_prev_mode == ScatteringMode::Diffuse ||
+                    vertex.m_prev_mode == ScatteringMode::Glossy)
+                {
+                    m_guided_path.end_vertex(
+                        -Vector3f(vertex.m_outgoing.get_value()),
+                        vertex.m_throughput,
+                        vertex.m_prev_sampling_prob);
+                }
+                else m_guided_path.cancel_vertex();
+            }
         };
 
         //
@@ -402,7 +442,8 @@ namespace
                 const ShadingContext&           shading_context,
                 const Scene&                    scene,
                 ShadingComponents&              path_radiance,
-                LightPathStream*                light_path_stream)
+                LightPathStream*                light_path_stream,
+                GuidedPath&                     guided_path)
               : PathVisitorBase(
                     params,
                     light_sampler,
@@ -410,7 +451,8 @@ namespace
                     shading_context,
                     scene,
                     path_radiance,
-                    light_path_stream)
+                    light_path_stream,
+                    guided_path)
             {
             }
 
@@ -418,6 +460,8 @@ namespace
             {
                 assert(vertex.m_prev_mode != ScatteringMode::None);
 
+                end_guided_vertex(vertex);
+
                 // Can't look up the environment if there's no environment EDF.
                 if (m_env_edf == nullptr)
                     return;
@@ -445,6 +489,8 @@ namespace
 
             void on_hit(const PathVertex& vertex)
             {
+                end_guided_vertex(vertex);
+
                 // Emitted light contribution.
                 if ((!m_omit_emitted_light || m_params.m_enable_caustics) &&
                     vertex.m_edf &&
@@ -490,6 +536,8 @@ namespace
                 // Terminate the path if all scattering modes are disabled.
                 if (vertex.m_scattering_modes == ScatteringMode::None)
                     return;
+
+                begin_guided_vertex(vertex);
             }
         };
 
@@ -508,7 +556,8 @@ namespace
                 const ShadingContext&           shading_context,
                 const Scene&                    scene,
                 ShadingComponents&              path_radiance,
-                LightPathStream*                light_path_stream)
+                LightPathStream*                light_path_stream,
+                GuidedPath&                     guided_path)
               : PathVisitorBase(
                     params,
                     light_sampler,
@@ -516,7 +565,8 @@ namespace
                     shading_context,
                     scene,
                     path_radiance,
-                    light_path_stream)
+                    light_path_stream,
+                    guided_path)
               , m_is_indirect_lighting(false)
             {
             }
@@ -525,6 +575,8 @@ namespace
             {
                 assert(vertex.m_prev_mode != ScatteringMode::None);
 
+                end_guided_vertex(vertex);
+
                 // Can't look up the environment if there's no environment EDF.
                 if (m_env_edf == nullptr)
                     return;
@@ -575,6 +627,8 @@ namespace
 
             void on_hit(const PathVertex& vertex)
             {
+                end_guided_vertex(vertex);
+
                 // Emitted light contribution.
                 if ((!m_omit_emitted_light || m_params.m_enable_caustics) &&
                     vertex.m_edf &&
@@ -694,6 +748,8 @@ namespace
                     vertex.m_path_length,
                     vertex.m_aov_mode,
                     vertex_radiance);
+
+                begin_guided_vertex(vertex);
             }
 
           private:
@@ -1049,13 +1105,34 @@ namespace
 // PTLightingEngineFactory class implementation.
 //
 
+namespace
+{
+    // Maximum depth of the directional quadtrees used for path guiding.
+    const size_t MaxGuidingDirectionalDepth = 20;
+}
+
 PTLightingEngineFactory::PTLightingEngineFactory(
+    const Scene&                    scene,
     const BackwardLightSampler&     light_sampler,
     LightPathRecorder&              light_path_recorder,
     const ParamArray&               params)
   : m_light_sampler(light_sampler)
   , m_light_path_recorder(light_path_recorder)
   , m_params(params)
+{
+    if (m_params.get_optional<bool>("enable_path_guiding", false))
+    {
+        m_sd_tree.reset(
+            new SDTree(
+                AABB3d(scene.compute_bbox()),
+                m_params.get_optional<float>("guiding_bsdf_sampling_fraction", 0.5f),
+                m_params.get_optional<float>("guiding_spatial_threshold", 12000.0f),
+                m_params.get_optional<float>("guiding_directional_threshold", 0.01f),
+                MaxGuidingDirectionalDepth));
+    }
+}
+
+PTLightingEngineFactory::~PTLightingEngineFactory()
 {
 }
 
@@ -1070,9 +1147,15 @@ ILightingEngine* PTLightingEngineFactory::create()
         new PTLightingEngine(
             m_light_sampler,
             m_light_path_recorder,
+            m_sd_tree.get(),
             m_params);
 }
 
+SDTree* PTLightingEngineFactory::get_sd_tree() const
+{
+    return m_sd_tree.get();
+}
+
 Dictionary PTLightingEngineFactory::get_params_metadata()
 {
     Dictionary metadata;
@@ -1189,6 +1272,43 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "Optimize for Lights Outside Volumes")
             .insert("help", "Optimize distance sampling for lights that are located outside volumes"));
 
+    metadata.dictionaries().insert(
+        "enable_path_guiding",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Path Guiding")
+            .insert("help", "Learn the distribution of incident light across passes and use it to guide diffuse and glossy bounces"));
+
+    metadata.dictionaries().insert(
+        "guiding_bsdf_sampling_fraction",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.5")
+            .insert("min", "0.0")
+            .insert("max", "1.0")
+            .insert("label", "Guiding BSDF Sampling Fraction")
+            .insert("help", "Fraction of guided bounces that sample the BSDF instead of the learned distribution"));
+
+    metadata.dictionaries().insert(
+        "guiding_spatial_threshold",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "12000.0")
+            .insert("min", "1.0")
+            .insert("label", "Guiding Spatial Threshold")
+            .insert("help", "Number of samples a spatial cell must receive during a pass to be split"));
+
+    metadata.dictionaries().insert(
+        "guiding_directional_threshold",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.01")
+            .insert("min", "0.0")
+            .insert("max", "1.0")
+            .insert("label", "Guiding Directional Threshold")
+            .insert("help", "Fraction of the incident energy above which a directional cell is split"));
+
     metadata.dictionaries().insert(
         "record_light_paths",
         Dictionary()
@@ -37,10 +37,15 @@
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
 
+// Standard headers.
+#include <memory>
+
 // Forward declarations.
 namespace foundation    { class Dictionary; }
 namespace renderer      { class BackwardLightSampler; }
 namespace renderer      { class LightPathRecorder; }
+namespace renderer      { class Scene; }
+namespace renderer      { class SDTree; }
 
 namespace renderer
 {
@@ -55,16 +60,23 @@ class PTLightingEngineFactory
   public:
     // Constructor.
     PTLightingEngineFactory(
+        const Scene&                    scene,
         const BackwardLightSampler&     light_sampler,
         LightPathRecorder&              light_path_recorder,
         const ParamArray&               params);
 
+    // Destructor.
+    ~PTLightingEngineFactory() override;
+
     // Delete this instance.
     void release() override;
 
     // Return a new path tracing lighting engine instance.
     ILightingEngine* create() override;
 
+    // Return the path guiding structure shared by all engines, or nullptr if path guiding is disabled.
+    SDTree* get_sd_tree() const;
+
     // Return the metadata of the PT lighting engine parameters.
     static foundation::Dictionary get_params_metadata();
 
@@ -72,6 +84,7 @@ class PTLightingEngineFactory
     const BackwardLightSampler&         m_light_sampler;
     LightPathRecorder&                  m_light_path_recorder;
     ParamArray                          m_params;
+    std::unique_ptr<SDTree>             m_sd_tree;
 };
 
 }       // namespace renderer
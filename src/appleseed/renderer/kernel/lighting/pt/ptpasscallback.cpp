@@ -0,0 +1,95 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "ptpasscallback.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/lighting/sdtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// PTPassCallback class implementation.
+//
+
+PTPassCallback::PTPassCallback(SDTree& sd_tree)
+  : m_sd_tree(sd_tree)
+{
+}
+
+void PTPassCallback::release()
+{
+    delete this;
+}
+
+void PTPassCallback::on_pass_begin(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+}
+
+void PTPassCallback::on_pass_end(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+    // Don't train on the partial results of an aborted pass.
+    if (abort_switch.is_aborted())
+        return;
+
+    m_stopwatch.start();
+
+    // Make what was learned during this pass available for sampling.
+    m_sd_tree.refine();
+
+    m_stopwatch.measure();
+
+    RENDERER_LOG_INFO(
+        "path guiding pass %s: %s spatial %s, refined in %s.",
+        pretty_uint(m_sd_tree.get_iteration()).c_str(),
+        pretty_uint(m_sd_tree.get_leaf_count()).c_str(),
+        plural(m_sd_tree.get_leaf_count(), "cell").c_str(),
+        pretty_time(m_stopwatch.get_seconds()).c_str());
+}
+
+}   // namespace renderer
@@ -0,0 +1,452 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sdtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+#include "foundation/platform/atomic.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Map a unit-length direction to the unit square using the equal-area
+    // cylindrical mapping (cos(theta), phi), with theta measured from +Y.
+    Vector2f direction_to_square(const Vector3f& direction)
+    {
+        const float cos_theta = clamp(direction[1], -1.0f, 1.0f);
+
+        float phi = atan2(direction[2], direction[0]);
+        if (phi < 0.0f)
+            phi += TwoPi<float>();
+
+        return
+            Vector2f(
+                saturate((cos_theta + 1.0f) * 0.5f),
+                saturate(phi * RcpTwoPi<float>()));
+    }
+
+    // Inverse of direction_to_square().
+    Vector3f square_to_direction(const Vector2f& p)
+    {
+        const float cos_theta = 2.0f * p[0] - 1.0f;
+        const float sin_theta = sqrt(max(1.0f - cos_theta * cos_theta, 0.0f));
+        const float phi = TwoPi<float>() * p[1];
+
+        return
+            Vector3f(
+                sin_theta * cos(phi),
+                cos_theta,
+                sin_theta * sin(phi));
+    }
+
+    // Return the quadrant of the unit square containing a given point,
+    // and remap the point to the unit square of that quadrant.
+    size_t descend(Vector2f& p)
+    {
+        size_t quadrant = 0;
+
+        if (p[0] >= 0.5f)
+        {
+            p[0] = p[0] * 2.0f - 1.0f;
+            quadrant |= 1;
+        }
+        else p[0] *= 2.0f;
+
+        if (p[1] >= 0.5f)
+        {
+            p[1] = p[1] * 2.0f - 1.0f;
+            quadrant |= 2;
+        }
+        else p[1] *= 2.0f;
+
+        return quadrant;
+    }
+
+    // Pick one of two outcomes with probabilities proportional to their weights,
+    // and remap the random number so that it can be reused.
+    bool choose_second(float& s, const float first, const float second)
+    {
+        const float total = first + second;
+        const float p = total > 0.0f ? first / total : 0.5f;
+
+        if (s < p)
+        {
+            s = min(s / p, 1.0f - numeric_limits<float>::epsilon());
+            return false;
+        }
+        else
+        {
+            s = min((s - p) / (1.0f - p), 1.0f - numeric_limits<float>::epsilon());
+            return true;
+        }
+    }
+
+    Vector3d compute_rcp_extent(const AABB3d& bbox)
+    {
+        // Use a cubic domain to keep the spatial leaves roughly isotropic.
+        const double extent = max_value(bbox.extent());
+        const double rcp_extent = extent > 0.0 ? 1.0 / extent : 0.0;
+        return Vector3d(rcp_extent);
+    }
+}
+
+
+//
+// DTree class implementation.
+//
+
+DTree::Node::Node()
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        m_sums[i] = 0.0f;
+        m_children[i] = 0;
+    }
+}
+
+DTree::DTree()
+  : m_nodes(1)
+  , m_sample_weight(0.0f)
+{
+}
+
+void DTree::record(
+    const Vector3f& direction,
+    const float     radiance)
+{
+    atomic_add(&m_sample_weight, 1.0f);
+
+    // Also rejects NaNs.
+    if (!(radiance > 0.0f))
+        return;
+
+    Vector2f p = direction_to_square(direction);
+    size_t node_index = 0;
+
+    while (true)
+    {
+        Node& node = m_nodes[node_index];
+        const size_t quadrant = descend(p);
+
+        atomic_add(&node.m_sums[quadrant], radiance);
+
+        if (node.is_leaf(quadrant))
+            break;
+
+        node_index = node.m_children[quadrant];
+    }
+}
+
+Vector3f DTree::sample(
+    const Vector2f& s,
+    float&          probability) const
+{
+    assert(is_valid());
+
+    Vector2f u = s;
+    Vector2f origin(0.0f);
+    float size = 1.0f;
+    float pdf = RcpFourPi<float>();
+    size_t node_index = 0;
+
+    while (true)
+    {
+        const Node& node = m_nodes[node_index];
+
+        // Choose the column, then the row within that column.
+        size_t quadrant =
+            choose_second(u[0], node.m_sums[0] + node.m_sums[2], node.m_sums[1] + node.m_sums[3]) ? 1 : 0;
+        if (choose_second(u[1], node.m_sums[quadrant], node.m_sums[quadrant + 2]))
+            quadrant += 2;
+
+        const float sum = node.get_sum();
+        pdf *= sum > 0.0f ? 4.0f * node.m_sums[quadrant] / sum : 1.0f;
+
+        size *= 0.5f;
+        origin[0] += (quadrant & 1) * size;
+        origin[1] += (quadrant >> 1) * size;
+
+        if (node.is_leaf(quadrant))
+            break;
+
+        node_index = node.m_children[quadrant];
+    }
+
+    probability = pdf;
+
+    // The density is uniform within a leaf since the mapping preserves areas.
+    return square_to_direction(origin + u * size);
+}
+
+float DTree::evaluate_pdf(const Vector3f& direction) const
+{
+    Vector2f p = direction_to_square(direction);
+    float pdf = RcpFourPi<float>();
+    size_t node_index = 0;
+
+    while (true)
+    {
+        const Node& node = m_nodes[node_index];
+
+        const float sum = node.get_sum();
+        if (sum <= 0.0f)
+            return 0.0f;
+
+        const size_t quadrant = descend(p);
+        pdf *= 4.0f * node.m_sums[quadrant] / sum;
+
+        if (node.is_leaf(quadrant) || pdf == 0.0f)
+            return pdf;
+
+        node_index = node.m_children[quadrant];
+    }
+}
+
+void DTree::scale(const float factor)
+{
+    for (size_t i = 0, e = m_nodes.size(); i < e; ++i)
+    {
+        for (size_t q = 0; q < 4; ++q)
+            m_nodes[i].m_sums[q] *= factor;
+    }
+
+    m_sample_weight *= factor;
+}
+
+void DTree::refine(
+    const DTree&    source,
+    const float     subdiv_threshold,
+    const size_t    max_depth)
+{
+    const float total = source.get_sum();
+
+    if (total <= 0.0f)
+    {
+        // Nothing was recorded: keep the current topology.
+        m_nodes = source.m_nodes;
+        scale(0.0f);
+        return;
+    }
+
+    struct Entry
+    {
+        uint32  m_node_index;
+        uint32  m_source_index;     // 0 if the node has no counterpart in the source tree
+        float   m_energy;           // energy of the node, used when it has no counterpart
+        size_t  m_depth;
+    };
+
+    m_nodes.clear();
+    m_nodes.emplace_back();
+    m_sample_weight = 0.0f;
+
+    vector<Entry> stack;
+    stack.push_back(Entry{ 0, 0, total, 1 });
+
+    while (!stack.empty())
+    {
+        const Entry entry = stack.back();
+        stack.pop_back();
+
+        const bool has_source = entry.m_node_index == 0 || entry.m_source_index != 0;
+
+        for (size_t q = 0; q < 4; ++q)
+        {
+            float energy;
+            uint32 source_child = 0;
+
+            if (has_source)
+            {
+                const Node& source_node = source.m_nodes[entry.m_source_index];
+                energy = source_node.m_sums[q];
+                source_child = source_node.m_children[q];
+            }
+            else energy = entry.m_energy * 0.25f;
+
+            // Only subdivide quadrants that hold a significant fraction of the energy.
+            if (entry.m_depth < max_depth && energy > subdiv_threshold * total)
+            {
+                const uint32 child = static_cast<uint32>(m_nodes.size());
+                m_nodes.emplace_back();
+                m_nodes[entry.m_node_index].m_children[q] = child;
+                stack.push_back(Entry{ child, source_child, energy, entry.m_depth + 1 });
+            }
+        }
+    }
+}
+
+
+//
+// SDTree class implementation.
+//
+
+SDTree::SDTree(
+    const AABB3d&   bbox,
+    const float     bsdf_sampling_fraction,
+    const float     spatial_threshold,
+    const float     directional_threshold,
+    const size_t    max_directional_depth)
+  : m_bbox(bbox)
+  , m_rcp_extent(compute_rcp_extent(bbox))
+  , m_bsdf_sampling_fraction(saturate(bsdf_sampling_fraction))
+  , m_spatial_threshold(spatial_threshold)
+  , m_directional_threshold(directional_threshold)
+  , m_max_directional_depth(max_directional_depth)
+  , m_iteration(0)
+{
+    Node root;
+    root.m_children[0] = root.m_children[1] = 0;
+    root.m_leaf_index = 0;
+    root.m_axis = 0;
+    m_nodes.push_back(root);
+
+    m_leaves.resize(1);
+}
+
+void SDTree::record(
+    const Vector3d& point,
+    const Vector3f& direction,
+    const float     radiance)
+{
+    m_leaves[m_nodes[find_leaf(point)].m_leaf_index].m_building.record(direction, radiance);
+}
+
+void SDTree::refine()
+{
+    // Split spatial leaves that received many samples. Newly created
+    // children are visited as well since they are appended to m_nodes.
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (m_nodes[i].m_children[0] == 0 &&
+            m_leaves[m_nodes[i].m_leaf_index].m_building.get_sample_weight() > m_spatial_threshold)
+            subdivide(i);
+    }
+
+    // Sample from what was learned in this pass and adapt the directional
+    // topology for the next one.
+    for (size_t i = 0, e = m_leaves.size(); i < e; ++i)
+    {
+        Leaf& leaf = m_leaves[i];
+        leaf.m_sampling = leaf.m_building;
+        leaf.m_building.refine(
+            leaf.m_sampling,
+            m_directional_threshold,
+            m_max_directional_depth);
+    }
+
+    ++m_iteration;
+}
+
+size_t SDTree::find_leaf(const Vector3d& point) const
+{
+    Vector3d p = (point - m_bbox.min) * m_rcp_extent;
+    size_t node_index = 0;
+
+    while (true)
+    {
+        const Node& node = m_nodes[node_index];
+
+        if (node.m_children[0] == 0)
+            return node_index;
+
+        double& x = p[node.m_axis];
+        if (x < 0.5)
+        {
+            x *= 2.0;
+            node_index = node.m_children[0];
+        }
+        else
+        {
+            x = x * 2.0 - 1.0;
+            node_index = node.m_children[1];
+        }
+    }
+}
+
+void SDTree::subdivide(const size_t node_index)
+{
+    const size_t leaf_index = m_nodes[node_index].m_leaf_index;
+    const uint8 child_axis = static_cast<uint8>((m_nodes[node_index].m_axis + 1) % 3);
+
+    // Each child inherits half of the samples of its parent.
+    m_leaves[leaf_index].m_building.scale(0.5f);
+    m_leaves.push_back(m_leaves[leaf_index]);
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        Node child;
+        child.m_children[0] = child.m_children[1] = 0;
+        child.m_leaf_index = i == 0 ? leaf_index : m_leaves.size() - 1;
+        child.m_axis = child_axis;
+
+        m_nodes[node_index].m_children[i] = m_nodes.size();
+        m_nodes.push_back(child);
+    }
+}
+
+
+//
+// GuidedPath class implementation.
+//
+
+void GuidedPath::splat(const Spectrum& path_radiance)
+{
+    const float final_radiance = average_value(path_radiance);
+
+    for (size_t i = 0; i < m_vertex_count; ++i)
+    {
+        const Vertex& vertex = m_vertices[i];
+
+        // Radiance gathered after this vertex arrived along the sampled direction.
+        const float incident_radiance =
+            max(final_radiance - vertex.m_radiance, 0.0f) / vertex.m_throughput;
+
+        m_sd_tree->record(
+            vertex.m_point,
+            vertex.m_direction,
+            incident_radiance / vertex.m_probability);
+    }
+
+    m_vertex_count = 0;
+    m_pending = false;
+}
+
+}   // namespace renderer
@@ -0,0 +1,358 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_LIGHTING_SDTREE_H
+#define APPLESEED_RENDERER_KERNEL_LIGHTING_SDTREE_H
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// Spatio-directional tree (SD-tree) for path guiding.
+//
+// A binary spatial tree over the scene bounding box whose leaves hold a pair
+// of directional quadtrees: one that collects incident radiance during the
+// current pass and one, built from the previous pass, that is sampled.
+//
+// Reference:
+//
+//   Practical Path Guiding for Efficient Light-Transport Simulation
+//   Thomas Müller, Markus Gross, Jan Novák
+//   https://tom94.net/data/publications/mueller17practical/mueller17practical.pdf
+//
+
+//
+// Directional quadtree over the cylindrical (cos(theta), phi) parameterization of the sphere.
+//
+
+class DTree
+{
+  public:
+    // Constructor. The tree initially consists of a single subdivided node.
+    DTree();
+
+    // Record a radiance sample. Thread-safe.
+    void record(
+        const foundation::Vector3f& direction,
+        const float                 radiance);
+
+    // Return the sum of the recorded radiance.
+    float get_sum() const;
+
+    // Return the number of recorded samples.
+    float get_sample_weight() const;
+
+    // Return true if the tree can be sampled.
+    bool is_valid() const;
+
+    // Sample a direction. The tree must be valid.
+    foundation::Vector3f sample(
+        const foundation::Vector2f& s,
+        float&                      probability) const;
+
+    // Evaluate the probability density of a given direction, wrt. solid angle.
+    float evaluate_pdf(const foundation::Vector3f& direction) const;
+
+    // Scale all recorded values, e.g. when splitting a spatial node.
+    void scale(const float factor);
+
+    // Rebuild this tree with a topology adapted to the radiance distribution
+    // recorded in another tree, and clear all recorded values.
+    void refine(
+        const DTree&                source,
+        const float                 subdiv_threshold,   // subdivide nodes holding more than this fraction of the total energy
+        const size_t                max_depth);
+
+    // Return the number of nodes in the tree.
+    size_t get_node_count() const;
+
+  private:
+    struct Node
+    {
+        float                       m_sums[4];
+        foundation::uint32          m_children[4];      // 0 for leaves since the root is never a child
+
+        Node();
+
+        float get_sum() const;
+        bool is_leaf(const size_t quadrant) const;
+    };
+
+    std::vector<Node>               m_nodes;
+    float                           m_sample_weight;
+};
+
+
+//
+// Spatial binary tree whose leaves hold directional quadtrees.
+//
+
+class SDTree
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    SDTree(
+        const foundation::AABB3d&   bbox,
+        const float                 bsdf_sampling_fraction,
+        const float                 spatial_threshold,
+        const float                 directional_threshold,
+        const size_t                max_directional_depth);
+
+    // Return the fraction of samples that follow BSDF sampling rather than the guiding distribution.
+    float get_bsdf_sampling_fraction() const;
+
+    // Return the directional quadtree to sample from at a given point.
+    // Return nullptr if no guiding information is available yet at this point.
+    const DTree* get_sampling_dtree(const foundation::Vector3d& point) const;
+
+    // Record a radiance sample at a given point. Thread-safe.
+    void record(
+        const foundation::Vector3d& point,
+        const foundation::Vector3f& direction,
+        const float                 radiance);
+
+    // Refine the spatial and directional structures using the samples recorded
+    // so far, make them available for sampling and start a new training pass.
+    // Must not be called concurrently with rendering.
+    void refine();
+
+    // Return the number of spatial leaves.
+    size_t get_leaf_count() const;
+
+    // Return the number of completed training passes.
+    size_t get_iteration() const;
+
+  private:
+    struct Node
+    {
+        size_t                      m_children[2];      // 0 for leaves since the root is never a child
+        size_t                      m_leaf_index;       // index into m_leaves, only for leaves
+        foundation::uint8           m_axis;             // split axis of this node or of its future children
+    };
+
+    struct Leaf
+    {
+        DTree                       m_building;
+        DTree                       m_sampling;
+    };
+
+    const foundation::AABB3d        m_bbox;
+    const foundation::Vector3d      m_rcp_extent;
+    const float                     m_bsdf_sampling_fraction;
+    const float                     m_spatial_threshold;
+    const float                     m_directional_threshold;
+    const size_t                    m_max_directional_depth;
+    std::vector<Node>               m_nodes;
+    std::vector<Leaf>               m_leaves;
+    size_t                          m_iteration;
+
+    size_t find_leaf(const foundation::Vector3d& point) const;
+
+    void subdivide(const size_t node_index);
+};
+
+
+//
+// Vertices of a guided path, collected while the path is traced and used to
+// train the SD-tree once the path's total radiance is known.
+//
+
+class GuidedPath
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    explicit GuidedPath(SDTree* sd_tree);
+
+    // Start a new vertex at a given point. The radiance is the path radiance
+    // accumulated so far, including the direct lighting at this vertex.
+    void begin_vertex(
+        const foundation::Vector3d& point,
+        const Spectrum&             path_radiance);
+
+    // Complete the pending vertex with the direction in which the path continued,
+    // the throughput of the path after that bounce and the density with which
+    // the direction was sampled.
+    void end_vertex(
+        const foundation::Vector3f& direction,
+        const Spectrum&             throughput,
+        const float                 probability);
+
+    // Drop the pending vertex, if any.
+    void cancel_vertex();
+
+    // Record the incident radiance of all completed vertices given the total path radiance.
+    void splat(const Spectrum& path_radiance);
+
+  private:
+    struct Vertex
+    {
+        foundation::Vector3d        m_point;
+        foundation::Vector3f        m_direction;
+        float                       m_radiance;         // average path radiance when the vertex was created
+        float                       m_throughput;       // average path throughput after the bounce
+        float                       m_probability;
+    };
+
+    enum { MaxVertexCount = 32 };
+
+    SDTree*                         m_sd_tree;
+    Vertex                          m_vertices[MaxVertexCount];
+    size_t                          m_vertex_count;
+    bool                            m_pending;
+};
+
+
+//
+// DTree class implementation.
+//
+
+inline float DTree::get_sum() const
+{
+    return m_nodes[0].get_sum();
+}
+
+inline float DTree::get_sample_weight() const
+{
+    return m_sample_weight;
+}
+
+inline bool DTree::is_valid() const
+{
+    return get_sum() > 0.0f;
+}
+
+inline size_t DTree::get_node_count() const
+{
+    return m_nodes.size();
+}
+
+inline float DTree::Node::get_sum() const
+{
+    return m_sums[0] + m_sums[1] + m_sums[2] + m_sums[3];
+}
+
+inline bool DTree::Node::is_leaf(const size_t quadrant) const
+{
+    return m_children[quadrant] == 0;
+}
+
+
+//
+// SDTree class implementation.
+//
+
+inline float SDTree::get_bsdf_sampling_fraction() const
+{
+    return m_bsdf_sampling_fraction;
+}
+
+inline const DTree* SDTree::get_sampling_dtree(const foundation::Vector3d& point) const
+{
+    const DTree& dtree = m_leaves[m_nodes[find_leaf(point)].m_leaf_index].m_sampling;
+    return dtree.is_valid() ? &dtree : nullptr;
+}
+
+inline size_t SDTree::get_leaf_count() const
+{
+    return m_leaves.size();
+}
+
+inline size_t SDTree::get_iteration() const
+{
+    return m_iteration;
+}
+
+
+//
+// GuidedPath class implementation.
+//
+
+inline GuidedPath::GuidedPath(SDTree* sd_tree)
+  : m_sd_tree(sd_tree)
+  , m_vertex_count(0)
+  , m_pending(false)
+{
+}
+
+inline void GuidedPath::begin_vertex(
+    const foundation::Vector3d&     point,
+    const Spectrum&                 path_radiance)
+{
+    if (m_sd_tree == nullptr || m_vertex_count == MaxVertexCount)
+        return;
+
+    Vertex& vertex = m_vertices[m_vertex_count];
+    vertex.m_point = point;
+    vertex.m_radiance = foundation::average_value(path_radiance);
+    m_pending = true;
+}
+
+inline void GuidedPath::end_vertex(
+    const foundation::Vector3f&     direction,
+    const Spectrum&                 throughput,
+    const float                     probability)
+{
+    if (!m_pending)
+        return;
+
+    m_pending = false;
+
+    const float average_throughput = foundation::average_value(throughput);
+
+    if (probability > 0.0f && average_throughput > 0.0f)
+    {
+        Vertex& vertex = m_vertices[m_vertex_count++];
+        vertex.m_direction = direction;
+        vertex.m_throughput = average_throughput;
+        vertex.m_probability = probability;
+    }
+}
+
+inline void GuidedPath::cancel_vertex()
+{
+    m_pending = false;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_LIGHTING_SDTREE_H
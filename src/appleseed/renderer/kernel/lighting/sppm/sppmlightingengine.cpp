@@ -388,9 +388,15 @@ namespace
                 const Vector3f point(vertex.get_point());
                 const float radius = m_pass_callback.get_lookup_radius();
 
-                // Find the nearby photons around the path vertex.
-                const knn::Query3f query(photon_map, m_answer);
-                query.run(point, radius * radius);
+                // Find the nearby photons around the path vertex. A fixed-radius query
+                // is cheaper than a k-nn query; only fall back to the latter when there
+                // are too many photons within the lookup radius.
+                const knn::RangeQuery3f range_query(photon_map, m_answer);
+                if (!range_query.run(point, radius * radius))
+                {
+                    const knn::Query3f query(photon_map, m_answer);
+                    query.run(point, radius * radius);
+                }
                 const size_t photon_count = m_answer.size();
 
                 // Compute the square radius of the lookup disk.
@@ -410,24 +416,51 @@ namespace
                 const float rcp_max_square_dist = 1.0f / max_square_dist;
 
                 // Accumulate photons contributions.
+                // The photon storage mode is tested once here rather than for each photon.
                 Spectrum indirect_radiance(Spectrum::Illuminance);
                 if (m_params.m_photon_type == SPPMParameters::Monochromatic)
                 {
                     indirect_radiance.set(0.0f);
-                    accumulate_mono_photons(
-                        vertex,
-                        photon_count,
-                        rcp_max_square_dist,
-                        indirect_radiance);
+                    if (m_params.m_photon_storage == SPPMParameters::Compact)
+                    {
+                        accumulate_mono_photons(
+                            vertex,
+                            photon_count,
+                            rcp_max_square_dist,
+                            [this](const size_t i) { return m_pass_callback.decode_mono_photon(i); },
+                            indirect_radiance);
+                    }
+                    else
+                    {
+                        accumulate_mono_photons(
+                            vertex,
+                            photon_count,
+                            rcp_max_square_dist,
+                            [this](const size_t i) -> const SPPMMonoPhoton& { return m_pass_callback.get_mono_photon(i); },
+                            indirect_radiance);
+                    }
                 }
                 else
                 {
                     indirect_radiance.set(0.0f);
-                    accumulate_poly_photons(
-                        vertex,
-                        photon_count,
-                        rcp_max_square_dist,
-                        indirect_radiance);
+                    if (m_params.m_photon_storage == SPPMParameters::Compact)
+                    {
+                        accumulate_poly_photons(
+                            vertex,
+                            photon_count,
+                            rcp_max_square_dist,
+                            [this](const size_t i) { return m_pass_callback.decode_poly_photon(i); },
+                            indirect_radiance);
+                    }
+                    else
+                    {
+                        accumulate_poly_photons(
+                            vertex,
+                            photon_count,
+                            rcp_max_square_dist,
+                            [this](const size_t i) -> const SPPMPolyPhoton& { return m_pass_callback.get_poly_photon(i); },
+                            indirect_radiance);
+                    }
                 }
 
                 // Estimate photon density.
@@ -438,22 +471,21 @@ namespace
                 vertex_radiance.m_beauty += indirect_radiance;
             }
 
+            template <typename GetPhoton>
             void accumulate_mono_photons(
                 const PathVertex&       vertex,
                 const size_t            photon_count,
                 const float             rcp_max_square_dist,
+                const GetPhoton&        get_photon,
                 Spectrum&               radiance)
             {
-                const SPPMPhotonMap& photon_map = m_pass_callback.get_photon_map();
                 const Vector3f normal(vertex.get_geometric_normal());
 
                 for (size_t i = 0; i < photon_count; ++i)
                 {
                     // Retrieve the i'th photon.
                     const knn::Answer<float>::Entry& entry = m_answer.get(i);
-                    const SPPMMonoPhoton& photon =
-                        m_pass_callback.get_mono_photon(
-                            photon_map.remap(entry.m_index));
+                    const SPPMMonoPhoton& photon = get_photon(entry.m_index);
 
                     // Reject photons from the opposite hemisphere as they won't contribute.
                     if (dot(normal, photon.m_incoming) <= 0.0f)
@@ -510,22 +542,21 @@ namespace
                 }
             }
 
+            template <typename GetPhoton>
             void accumulate_poly_photons(
                 const PathVertex&       vertex,
                 const size_t            photon_count,
                 const float             rcp_max_square_dist,
+                const GetPhoton&        get_photon,
                 Spectrum&               radiance)
             {
-                const SPPMPhotonMap& photon_map = m_pass_callback.get_photon_map();
                 const Vector3f normal(vertex.get_geometric_normal());
 
                 for (size_t i = 0; i < photon_count; ++i)
                 {
                     // Retrieve the i'th photon.
                     const knn::Answer<float>::Entry& entry = m_answer.get(i);
-                    const SPPMPolyPhoton& photon =
-                        m_pass_callback.get_poly_photon(
-                            photon_map.remap(entry.m_index));
+                    const SPPMPolyPhoton& photon = get_photon(entry.m_index);
 
                     // Reject photons from the opposite hemisphere as they won't contribute.
                     if (dot(normal, photon.m_incoming) <= 0.0f)
@@ -614,13 +645,17 @@ namespace
 
             const size_t photon_count = m_answer.size();
 
+            const bool compact = m_params.m_photon_storage == SPPMParameters::Compact;
+
             if (m_params.m_photon_type == SPPMParameters::Monochromatic)
             {
                 for (size_t i = 0; i < photon_count; ++i)
                 {
                     const knn::Answer<float>::Entry& photon = m_answer.get(i);
-                    const SpectrumLine& flux =
-                        m_pass_callback.get_mono_photon(photon_map.remap(photon.m_index)).m_flux;
+                    const SpectrumLine flux =
+                        compact
+                            ? m_pass_callback.decode_mono_photon(photon.m_index).m_flux
+                            : m_pass_callback.get_mono_photon(photon.m_index).m_flux;
                     radiance[flux.m_wavelength] += flux.m_amplitude;
                 }
             }
@@ -629,7 +664,9 @@ namespace
                 for (size_t i = 0; i < photon_count; ++i)
                 {
                     const knn::Answer<float>::Entry& photon = m_answer.get(i);
-                    radiance += m_pass_callback.get_poly_photon(photon_map.remap(photon.m_index)).m_flux;
+                    if (compact)
+                        radiance += m_pass_callback.decode_poly_photon(photon.m_index).m_flux;
+                    else radiance += m_pass_callback.get_poly_photon(photon.m_index).m_flux;
                 }
             }
 
@@ -707,6 +744,28 @@ Dictionary SPPMLightingEngineFactory::get_params_metadata()
                             .insert("label", "Poly")
                             .insert("help", "Polychromatic photons"))));
 
+    metadata.dictionaries().insert(
+        "photon_storage",
+        Dictionary()
+            .insert("type", "enum")
+            .insert("values", "full|compact")
+            .insert("default", "full")
+            .insert("label", "Photon Storage")
+            .insert("help", "Photon storage")
+            .insert(
+                "options",
+                Dictionary()
+                    .insert(
+                        "full",
+                        Dictionary()
+                            .insert("label", "Full")
+                            .insert("help", "Store photons in full precision"))
+                    .insert(
+                        "compact",
+                        Dictionary()
+                            .insert("label", "Compact")
+                            .insert("help", "Store photons in a compact form, using less memory at the cost of precision"))));
+
     metadata.dictionaries().insert(
         "dl_type",
         Dictionary()
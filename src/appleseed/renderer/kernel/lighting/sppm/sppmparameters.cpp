@@ -77,6 +77,23 @@ namespace
                 : SPPMParameters::Polychromatic;
     }
 
+    SPPMParameters::PhotonStorage get_photon_storage(
+        const ParamArray&   params,
+        const char*         name,
+        const char*         default_value)
+    {
+        const string value =
+            params.get_optional<string>(
+                name,
+                default_value,
+                make_vector("full", "compact"));
+
+        return
+            value == "full"
+                ? SPPMParameters::Full
+                : SPPMParameters::Compact;
+    }
+
     SPPMParameters::Mode get_mode(
         const ParamArray&   params,
         const char*         name,
@@ -99,12 +116,14 @@ SPPMParameters::SPPMParameters(const ParamArray& params)
   : m_spectrum_mode(get_spectrum_mode(params))
   , m_sampling_mode(get_sampling_context_mode(params))
   , m_photon_type(get_photon_type(params, "photon_type", "poly"))
+  , m_photon_storage(get_photon_storage(params, "photon_storage", "full"))
   , m_dl_mode(get_mode(params, "dl_mode", "rt"))
   , m_enable_ibl(params.get_optional<bool>("enable_ibl", true))
   , m_enable_caustics(params.get_optional<bool>("enable_caustics", true))
   , m_light_photon_count(params.get_optional<size_t>("light_photons_per_pass", 1000000))
   , m_env_photon_count(params.get_optional<size_t>("env_photons_per_pass", 1000000))
   , m_photon_packet_size(params.get_optional<size_t>("photon_packet_size", 100000))
+  , m_photon_map_build_thread_count(get_rendering_thread_count(params))
   , m_photon_tracing_max_bounces(fixup_bounces(params.get_optional<int>("photon_tracing_max_bounces", -1)))
   , m_photon_tracing_rr_min_path_length(fixup_path_length(params.get_optional<size_t>("photon_tracing_rr_min_path_length", 6)))
   , m_path_tracing_max_bounces(fixup_bounces(params.get_optional<int>("path_tracing_max_bounces", -1)))
@@ -131,9 +150,11 @@ void SPPMParameters::print() const
     RENDERER_LOG_INFO(
         "sppm settings:\n"
         "  photon type                   %s\n"
+        "  photon storage                %s\n"
         "  dl                            %s\n"
         "  ibl                           %s",
         m_photon_type == Monochromatic ? "monochromatic" : "polychromatic",
+        m_photon_storage == Full ? "full" : "compact",
         m_dl_mode == RayTraced ? "ray traced" :
         m_dl_mode == SPPM ? "sppm" : "off",
         m_enable_ibl ? "on" : "off");
@@ -45,12 +45,14 @@ namespace renderer
 struct SPPMParameters
 {
     enum PhotonType { Monochromatic, Polychromatic };
+    enum PhotonStorage { Full, Compact };
     enum Mode { RayTraced, SPPM, Off };
 
     const Spectrum::Mode        m_spectrum_mode;
     const SamplingContext::Mode m_sampling_mode;
 
     const PhotonType            m_photon_type;
+    const PhotonStorage         m_photon_storage;                       // how photons are stored in memory
 
     const Mode                  m_dl_mode;                              // direct lighting mode
     const bool                  m_enable_ibl;                           // is image-based lighting enabled?
@@ -59,6 +61,7 @@ struct SPPMParameters
     const size_t                m_light_photon_count;                   // number of photons emitted from the lights
     const size_t                m_env_photon_count;                     // number of photons emitted from the environment
     const size_t                m_photon_packet_size;                   // number of photons per tracing job
+    const size_t                m_photon_map_build_thread_count;        // number of threads used to build the photon map
 
     const size_t                m_photon_tracing_max_bounces;           // maximum number of photon bounces, ~0 for unlimited
     const size_t                m_photon_tracing_rr_min_path_length;    // minimum photon tracing path length before Russian Roulette kicks in, ~0 for unlimited
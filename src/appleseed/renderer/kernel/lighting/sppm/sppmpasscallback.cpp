@@ -119,7 +119,10 @@ void SPPMPassCallback::on_pass_begin(
         return;
 
     // Build a new photon map.
-    m_photon_map.reset(new SPPMPhotonMap(m_photons));
+    m_photon_map.reset(
+        new SPPMPhotonMap(
+            m_photons,
+            m_params.m_photon_map_build_thread_count));
 }
 
 void SPPMPassCallback::on_pass_end(
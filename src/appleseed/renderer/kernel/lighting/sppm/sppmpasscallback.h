@@ -94,10 +94,16 @@ class SPPMPassCallback
         foundation::JobQueue&       job_queue,
         foundation::IAbortSwitch&   abort_switch) override;
 
-    // Return the i'th photon.
+    // Return the i'th photon, where i is an internal index of the photon map.
+    // Only valid when photons are stored in full precision.
     const SPPMMonoPhoton& get_mono_photon(const size_t i) const;
     const SPPMPolyPhoton& get_poly_photon(const size_t i) const;
 
+    // Decode the i'th photon, where i is an internal index of the photon map.
+    // Only valid when photons are stored in compact form.
+    SPPMMonoPhoton decode_mono_photon(const size_t i) const;
+    SPPMPolyPhoton decode_poly_photon(const size_t i) const;
+
     // Return the current photon map.
     const SPPMPhotonMap& get_photon_map() const;
 
@@ -131,6 +137,16 @@ inline const SPPMPolyPhoton& SPPMPassCallback::get_poly_photon(const size_t i) c
     return m_photons.m_poly_photons[i];
 }
 
+inline SPPMMonoPhoton SPPMPassCallback::decode_mono_photon(const size_t i) const
+{
+    return m_photons.m_compact_mono_photons[i].decode();
+}
+
+inline SPPMPolyPhoton SPPMPassCallback::decode_poly_photon(const size_t i) const
+{
+    return m_photons.m_compact_poly_photons[i].decode();
+}
+
 inline const SPPMPhotonMap& SPPMPassCallback::get_photon_map() const
 {
     return *m_photon_map.get();
@@ -31,13 +31,166 @@
 #include "sppmphoton.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/scalar.h"
 #include "foundation/utility/memory.h"
 
+// Standard headers.
+#include <cassert>
+#include <cmath>
+
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
 
+namespace
+{
+    //
+    // Octahedral encoding of unit vectors.
+    //
+    // Reference:
+    //
+    //   A Survey of Efficient Representations for Independent Unit Vectors
+    //   Zina H. Cigolle, Sam Donow, Daniel Evangelakos, Michael Mara, Morgan McGuire, Quirin Meyer
+    //   http://jcgt.org/published/0003/02/01/paper.pdf
+    //
+
+    inline float sign_not_zero(const float x)
+    {
+        return x >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    inline uint32 quantize_unit(const float x, const size_t bits)
+    {
+        const float max_code = static_cast<float>((1UL << bits) - 1);
+        return truncate<uint32>(saturate(x * 0.5f + 0.5f) * max_code + 0.5f);
+    }
+
+    inline float dequantize_unit(const uint32 x, const size_t bits)
+    {
+        const float max_code = static_cast<float>((1UL << bits) - 1);
+        return static_cast<float>(x) / max_code * 2.0f - 1.0f;
+    }
+
+    // Encode a unit vector into 2 x 'bits' bits.
+    uint32 encode_octahedral(const Vector3f& v, const size_t bits)
+    {
+        const float rcp_norm1 = 1.0f / (abs(v[0]) + abs(v[1]) + abs(v[2]));
+        float x = v[0] * rcp_norm1;
+        float y = v[1] * rcp_norm1;
+
+        // Fold the lower hemisphere over the diagonals.
+        if (v[2] < 0.0f)
+        {
+            const float fx = (1.0f - abs(y)) * sign_not_zero(x);
+            const float fy = (1.0f - abs(x)) * sign_not_zero(y);
+            x = fx;
+            y = fy;
+        }
+
+        return (quantize_unit(x, bits) << bits) | quantize_unit(y, bits);
+    }
+
+    Vector3f decode_octahedral(const uint32 code, const size_t bits)
+    {
+        const uint32 mask = static_cast<uint32>((1UL << bits) - 1);
+
+        Vector3f v(
+            dequantize_unit((code >> bits) & mask, bits),
+            dequantize_unit(code & mask, bits),
+            0.0f);
+
+        v[2] = 1.0f - abs(v[0]) - abs(v[1]);
+
+        // Unfold the lower hemisphere.
+        const float t = max(-v[2], 0.0f);
+        v[0] += v[0] >= 0.0f ? -t : t;
+        v[1] += v[1] >= 0.0f ? -t : t;
+
+        return normalize(v);
+    }
+
+    const size_t DirectionBits = 16;
+    const size_t NormalBits = 12;
+    const size_t WavelengthBits = 8;
+}
+
+
+//
+// SPPMCompactMonoPhoton class implementation.
+//
+
+SPPMCompactMonoPhoton::SPPMCompactMonoPhoton(const SPPMMonoPhoton& photon)
+  : m_incoming(encode_octahedral(photon.m_incoming, DirectionBits))
+  , m_normal_wavelength(
+        (encode_octahedral(photon.m_geometric_normal, NormalBits) << WavelengthBits) |
+        photon.m_flux.m_wavelength)
+  , m_amplitude(photon.m_flux.m_amplitude)
+{
+    assert(photon.m_flux.m_wavelength < (1UL << WavelengthBits));
+}
+
+SPPMMonoPhoton SPPMCompactMonoPhoton::decode() const
+{
+    SPPMMonoPhoton photon;
+    photon.m_incoming = decode_octahedral(m_incoming, DirectionBits);
+    photon.m_geometric_normal = decode_octahedral(m_normal_wavelength >> WavelengthBits, NormalBits);
+    photon.m_flux.m_wavelength = m_normal_wavelength & ((1UL << WavelengthBits) - 1);
+    photon.m_flux.m_amplitude = m_amplitude;
+    return photon;
+}
+
+
+//
+// SPPMCompactPolyPhoton class implementation.
+//
+
+SPPMCompactPolyPhoton::SPPMCompactPolyPhoton(const SPPMPolyPhoton& photon)
+  : m_incoming(encode_octahedral(photon.m_incoming, DirectionBits))
+  , m_geometric_normal(encode_octahedral(photon.m_geometric_normal, DirectionBits))
+  , m_flux_exponent(0)
+{
+    const size_t size = Spectrum::size();
+
+    float max_flux = 0.0f;
+    for (size_t i = 0; i < size; ++i)
+        max_flux = max(max_flux, photon.m_flux[i]);
+
+    for (size_t i = 0; i < Spectrum::Samples; ++i)
+        m_flux[i] = 0;
+
+    if (max_flux < 1.0e-35f)
+        return;
+
+    // Express all components with 8-bit mantissas relative to the exponent of the largest one.
+    int exponent;
+    frexp(max_flux, &exponent);
+    exponent = clamp(exponent, -126, 127);
+    m_flux_exponent = static_cast<int8>(exponent);
+
+    const float scale = ldexp(1.0f, 8 - exponent);
+    for (size_t i = 0; i < size; ++i)
+    {
+        const float mantissa = max(photon.m_flux[i], 0.0f) * scale + 0.5f;
+        m_flux[i] = static_cast<uint8>(min(mantissa, 255.0f));
+    }
+}
+
+SPPMPolyPhoton SPPMCompactPolyPhoton::decode() const
+{
+    SPPMPolyPhoton photon;
+    photon.m_incoming = decode_octahedral(m_incoming, DirectionBits);
+    photon.m_geometric_normal = decode_octahedral(m_geometric_normal, DirectionBits);
+
+    const float scale = ldexp(1.0f, m_flux_exponent - 8);
+    photon.m_flux.set(0.0f);
+    for (size_t i = 0, e = Spectrum::size(); i < e; ++i)
+        photon.m_flux[i] = static_cast<float>(m_flux[i]) * scale;
+
+    return photon;
+}
+
 //
 // SPPMPhotonVector class implementation.
 //
@@ -57,7 +210,9 @@ size_t SPPMPhotonVector::get_memory_size() const
     return
         m_positions.capacity() * sizeof(Vector3f) +
         m_mono_photons.capacity() * sizeof(SPPMMonoPhoton) +
-        m_poly_photons.capacity() * sizeof(SPPMPolyPhoton);
+        m_poly_photons.capacity() * sizeof(SPPMPolyPhoton) +
+        m_compact_mono_photons.capacity() * sizeof(SPPMCompactMonoPhoton) +
+        m_compact_poly_photons.capacity() * sizeof(SPPMCompactPolyPhoton);
 }
 
 void SPPMPhotonVector::swap(SPPMPhotonVector& rhs)
@@ -65,6 +220,8 @@ void SPPMPhotonVector::swap(SPPMPhotonVector& rhs)
     m_positions.swap(rhs.m_positions);
     m_mono_photons.swap(rhs.m_mono_photons);
     m_poly_photons.swap(rhs.m_poly_photons);
+    m_compact_mono_photons.swap(rhs.m_compact_mono_photons);
+    m_compact_poly_photons.swap(rhs.m_compact_poly_photons);
 }
 
 void SPPMPhotonVector::clear_keep_memory()
@@ -72,6 +229,8 @@ void SPPMPhotonVector::clear_keep_memory()
     foundation::clear_keep_memory(m_positions);
     foundation::clear_keep_memory(m_mono_photons);
     foundation::clear_keep_memory(m_poly_photons);
+    foundation::clear_keep_memory(m_compact_mono_photons);
+    foundation::clear_keep_memory(m_compact_poly_photons);
 }
 
 void SPPMPhotonVector::reserve_mono_photons(const size_t capacity)
@@ -102,13 +261,20 @@ void SPPMPhotonVector::push_back(
     m_poly_photons.push_back(photon);
 }
 
-void SPPMPhotonVector::append(const SPPMPhotonVector& rhs)
+void SPPMPhotonVector::push_back(
+    const Vector3f&                 position,
+    const SPPMCompactMonoPhoton&    photon)
 {
-    boost::mutex::scoped_lock lock(m_mutex);
+    m_positions.push_back(position);
+    m_compact_mono_photons.push_back(photon);
+}
 
-    m_positions.insert(m_positions.end(), rhs.m_positions.begin(), rhs.m_positions.end());
-    m_mono_photons.insert(m_mono_photons.end(), rhs.m_mono_photons.begin(), rhs.m_mono_photons.end());
-    m_poly_photons.insert(m_poly_photons.end(), rhs.m_poly_photons.begin(), rhs.m_poly_photons.end());
+void SPPMPhotonVector::push_back(
+    const Vector3f&                 position,
+    const SPPMCompactPolyPhoton&    photon)
+{
+    m_positions.push_back(position);
+    m_compact_poly_photons.push_back(photon);
 }
 
 }   // namespace renderer
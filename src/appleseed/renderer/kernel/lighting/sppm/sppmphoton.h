@@ -35,9 +35,6 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
-
-// Boost headers.
-#include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 
 // Standard headers.
@@ -79,9 +76,57 @@ class SPPMPolyPhoton
 };
 
 
+//
+// A monochromatic photon in compact form (12 bytes instead of 32).
+//
+// Directions are octahedral-encoded. The wavelength shares a 32-bit word
+// with the geometric normal which is encoded with a lower precision.
+//
+
+class SPPMCompactMonoPhoton
+{
+  public:
+    SPPMCompactMonoPhoton() {}
+    explicit SPPMCompactMonoPhoton(const SPPMMonoPhoton& photon);
+
+    SPPMMonoPhoton decode() const;
+
+  private:
+    foundation::uint32      m_incoming;             // octahedral-encoded incoming direction, 2x16 bits
+    foundation::uint32      m_normal_wavelength;    // octahedral-encoded geometric normal (2x12 bits) and wavelength (8 bits)
+    float                   m_amplitude;            // flux carried by this photon (in W)
+};
+
+
+//
+// A polychromatic photon in compact form (40 bytes instead of 160).
+//
+// Directions are octahedral-encoded. The flux is stored as 8-bit mantissas
+// with a shared exponent, which preserves its dynamic range.
+//
+
+class SPPMCompactPolyPhoton
+{
+  public:
+    SPPMCompactPolyPhoton() {}
+    explicit SPPMCompactPolyPhoton(const SPPMPolyPhoton& photon);
+
+    SPPMPolyPhoton decode() const;
+
+  private:
+    foundation::uint32      m_incoming;             // octahedral-encoded incoming direction, 2x16 bits
+    foundation::uint32      m_geometric_normal;     // octahedral-encoded geometric normal, 2x16 bits
+    foundation::uint8       m_flux[Spectrum::Samples];
+    foundation::int8        m_flux_exponent;
+};
+
+
 //
 // A vector of photons.
 //
+// Only one kind of photon is stored during a given render; the i'th photon
+// of that kind is located at the i'th position.
+//
 
 class SPPMPhotonVector
 {
@@ -89,7 +134,8 @@ class SPPMPhotonVector
     std::vector<foundation::Vector3f>   m_positions;
     std::vector<SPPMMonoPhoton>         m_mono_photons;
     std::vector<SPPMPolyPhoton>         m_poly_photons;
-    boost::mutex                        m_mutex;
+    std::vector<SPPMCompactMonoPhoton>  m_compact_mono_photons;
+    std::vector<SPPMCompactPolyPhoton>  m_compact_poly_photons;
 
     bool empty() const;
     size_t size() const;
@@ -107,9 +153,12 @@ class SPPMPhotonVector
     void push_back(
         const foundation::Vector3f&     position,
         const SPPMPolyPhoton&           photon);
-
-    // The only thread-safe method of this class.
-    void append(const SPPMPhotonVector& rhs);
+    void push_back(
+        const foundation::Vector3f&     position,
+        const SPPMCompactMonoPhoton&    photon);
+    void push_back(
+        const foundation::Vector3f&     position,
+        const SPPMCompactPolyPhoton&    photon);
 };
 
 }       // namespace renderer
@@ -42,13 +42,56 @@
 // Standard headers.
 #include <cstddef>
 #include <string>
+#include <vector>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
 
-SPPMPhotonMap::SPPMPhotonMap(SPPMPhotonVector& photons)
+namespace
+{
+    // Reorder photon data such that the i'th element corresponds to the i'th point of the map.
+    // The permutation is applied in place by following its cycles, so that peak memory
+    // usage only grows by one bit per photon.
+    template <typename T>
+    void reorder_photon_data(
+        const SPPMPhotonMap&    photon_map,
+        vector<T>&              data)
+    {
+        const size_t size = data.size();
+        vector<bool> placed(size, false);
+
+        for (size_t start = 0; start < size; ++start)
+        {
+            if (placed[start])
+                continue;
+
+            T first = data[start];
+            size_t i = start;
+
+            while (true)
+            {
+                placed[i] = true;
+
+                const size_t source = photon_map.remap(i);
+                if (source == start)
+                {
+                    data[i] = first;
+                    break;
+                }
+
+                data[i] = data[source];
+                i = source;
+            }
+        }
+    }
+}
+
+SPPMPhotonMap::SPPMPhotonMap(
+    SPPMPhotonVector&   photons,
+    const size_t        thread_count)
 {
     const size_t photon_count = photons.size();
 
@@ -60,11 +103,25 @@ SPPMPhotonMap::SPPMPhotonMap(SPPMPhotonVector& photons)
             photon_count > 1 ? "photons" : "photon");
 
         knn::Builder3f builder(*this);
-        builder.build_move_points<DefaultWallclockTimer>(photons.m_positions);
+        builder.build_move_points<DefaultWallclockTimer>(
+            photons.m_positions,
+            global_logger(),
+            thread_count);
+
+        // Lay out the photons in the order of the leaves of the map such that
+        // nearby photons are close in memory.
+        reorder_photon_data(*this, photons.m_mono_photons);
+        reorder_photon_data(*this, photons.m_poly_photons);
+        reorder_photon_data(*this, photons.m_compact_mono_photons);
+        reorder_photon_data(*this, photons.m_compact_poly_photons);
+
+        const size_t memory_size = photons.get_memory_size() + get_memory_size();
 
         Statistics statistics;
         statistics.insert_time("build time", builder.get_build_time());
-        statistics.insert_size("size", photons.get_memory_size());
+        statistics.insert("build threads", thread_count);
+        statistics.insert_size("size", memory_size);
+        statistics.insert_size("memory per photon", memory_size / photon_count);
         statistics.merge(knn::TreeStatistics<knn::Tree3f>(*this));
 
         RENDERER_LOG_DEBUG("%s",
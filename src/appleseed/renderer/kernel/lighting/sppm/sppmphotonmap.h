@@ -33,6 +33,9 @@
 // appleseed.foundation headers.
 #include "foundation/math/knn.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace renderer  { class SPPMPhotonVector; }
 
@@ -43,8 +46,12 @@ class SPPMPhotonMap
   : public foundation::knn::Tree3f
 {
   public:
-    // Constructor, *moves* the photon positions into the map.
-    explicit SPPMPhotonMap(SPPMPhotonVector& photons);
+    // Constructor, *moves* the photon positions into the map and reorders the
+    // photons such that the i'th photon matches the i'th point of the map.
+    // The map is built using a given number of threads.
+    SPPMPhotonMap(
+        SPPMPhotonVector&   photons,
+        const size_t        thread_count = 1);
 };
 
 }       // namespace renderer
@@ -82,8 +82,10 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <vector>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -173,7 +175,7 @@ namespace
                         m_initial_flux[wavelength] *
                         Spectrum::size() *
                         vertex.m_throughput[wavelength];
-                    m_photons.push_back(Vector3f(vertex.get_point()), photon);
+                    store(Vector3f(vertex.get_point()), photon);
                 }
                 else
                 {
@@ -185,7 +187,7 @@ namespace
                     photon.m_geometric_normal = Vector3f(vertex.get_geometric_normal());
                     photon.m_flux = m_initial_flux;
                     photon.m_flux *= vertex.m_throughput;
-                    m_photons.push_back(Vector3f(vertex.get_point()), photon);
+                    store(Vector3f(vertex.get_point()), photon);
                 }
             }
         }
@@ -193,6 +195,20 @@ namespace
         void on_scatter(const PathVertex& vertex)
         {
         }
+
+        void store(const Vector3f& position, const SPPMMonoPhoton& photon)
+        {
+            if (m_params.m_photon_storage == SPPMParameters::Compact)
+                m_photons.push_back(position, SPPMCompactMonoPhoton(photon));
+            else m_photons.push_back(position, photon);
+        }
+
+        void store(const Vector3f& position, const SPPMPolyPhoton& photon)
+        {
+            if (m_params.m_photon_storage == SPPMParameters::Compact)
+                m_photons.push_back(position, SPPMCompactPolyPhoton(photon));
+            else m_photons.push_back(position, photon);
+        }
     };
 
     //
@@ -233,7 +249,7 @@ namespace
             OIIOTextureSystem&              oiio_texture_system,
             OSLShadingSystem&               shading_system,
             const SPPMParameters&           params,
-            SPPMPhotonVector&               global_photons,
+            SPPMPhotonVector&               photons,
             const size_t                    photon_begin,
             const size_t                    photon_end,
             const size_t                    pass_hash,
@@ -254,7 +270,7 @@ namespace
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
                 false)
-          , m_global_photons(global_photons)
+          , m_local_photons(photons)
           , m_photon_begin(photon_begin)
           , m_photon_end(photon_end)
           , m_pass_hash(pass_hash)
@@ -293,8 +309,6 @@ namespace
                 m_arena.clear();
                 trace_light_photon(shading_context, sampling_context);
             }
-
-            m_global_photons.append(m_local_photons);
         }
 
       private:
@@ -308,12 +322,11 @@ namespace
         OSLShaderGroupExec          m_shadergroup_exec;
         const SPPMParameters        m_params;
         Tracer                      m_tracer;
-        SPPMPhotonVector&           m_global_photons;
+        SPPMPhotonVector&           m_local_photons;
         const size_t                m_photon_begin;
         const size_t                m_photon_end;
         const size_t                m_pass_hash;
         IAbortSwitch&               m_abort_switch;
-        SPPMPhotonVector            m_local_photons;
         float                       m_shutter_open_begin_time;
         float                       m_shutter_close_end_time;
 
@@ -529,7 +542,7 @@ namespace
             OIIOTextureSystem&          oiio_texture_system,
             OSLShadingSystem&           shading_system,
             const SPPMParameters&       params,
-            SPPMPhotonVector&           global_photons,
+            SPPMPhotonVector&           photons,
             const size_t                photon_begin,
             const size_t                photon_end,
             const size_t                pass_hash,
@@ -551,7 +564,7 @@ namespace
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
                 false)
-          , m_global_photons(global_photons)
+          , m_local_photons(photons)
           , m_photon_begin(photon_begin)
           , m_photon_end(photon_end)
           , m_pass_hash(pass_hash)
@@ -595,8 +608,6 @@ namespace
                 m_arena.clear();
                 trace_env_photon(shading_context, sampling_context);
             }
-
-            m_global_photons.append(m_local_photons);
         }
 
       private:
@@ -611,12 +622,11 @@ namespace
         OSLShaderGroupExec          m_shadergroup_exec;
         const SPPMParameters        m_params;
         Tracer                      m_tracer;
-        SPPMPhotonVector&           m_global_photons;
+        SPPMPhotonVector&           m_local_photons;
         const size_t                m_photon_begin;
         const size_t                m_photon_end;
         const size_t                m_pass_hash;
         IAbortSwitch&               m_abort_switch;
-        SPPMPhotonVector            m_local_photons;
         float                       m_shutter_open_begin_time;
         float                       m_shutter_close_end_time;
 
@@ -717,6 +727,57 @@ namespace
                 ray);
         }
     };
+
+
+    //
+    // Copy the photons stored by one photon tracing job to their final location.
+    //
+
+    template <typename T>
+    void copy_photon_data(
+        const vector<T>&                    source,
+        vector<T>&                          destination,
+        const size_t                        offset)
+    {
+        copy(source.begin(), source.end(), destination.begin() + offset);
+    }
+
+    class PhotonCopyJob
+      : public IJob
+    {
+      public:
+        PhotonCopyJob(
+            const SPPMPhotonVector&         source,
+            SPPMPhotonVector&               destination,
+            const size_t                    offset)
+          : m_source(source)
+          , m_destination(destination)
+          , m_offset(offset)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            // Only one kind of photon is stored, so all arrays share the same offset.
+            copy_photon_data(m_source.m_positions, m_destination.m_positions, m_offset);
+            copy_photon_data(m_source.m_mono_photons, m_destination.m_mono_photons, m_offset);
+            copy_photon_data(m_source.m_poly_photons, m_destination.m_poly_photons, m_offset);
+            copy_photon_data(m_source.m_compact_mono_photons, m_destination.m_compact_mono_photons, m_offset);
+            copy_photon_data(m_source.m_compact_poly_photons, m_destination.m_compact_poly_photons, m_offset);
+        }
+
+      private:
+        const SPPMPhotonVector&     m_source;
+        SPPMPhotonVector&           m_destination;
+        const size_t                m_offset;
+    };
+
+    size_t get_photon_tracing_job_count(
+        const size_t                        photon_count,
+        const size_t                        photon_packet_size)
+    {
+        return (photon_count + photon_packet_size - 1) / photon_packet_size;
+    }
 }
 
 
@@ -819,25 +880,37 @@ void SPPMPhotonTracer::trace_photons(
         Transformd::identity(),
         photon_targets);
 
+    const bool trace_light_photons = m_light_sampler.has_lights();
+    const bool trace_env_photons =
+        m_params.m_enable_ibl && m_scene.get_environment()->get_environment_edf();
+
+    // Each photon tracing job stores its photons into its own vector.
+    size_t max_job_count = 0;
+    if (trace_light_photons)
+        max_job_count += get_photon_tracing_job_count(m_params.m_light_photon_count, m_params.m_photon_packet_size);
+    if (trace_env_photons)
+        max_job_count += get_photon_tracing_job_count(m_params.m_env_photon_count, m_params.m_photon_packet_size);
+    vector<SPPMPhotonVector> job_photons(max_job_count);
+
     // Schedule photon tracing jobs.
     size_t job_count = 0;
     size_t emitted_photon_count = 0;
-    if (m_light_sampler.has_lights())
+    if (trace_light_photons)
     {
         schedule_light_photon_tracing_jobs(
             photon_targets,
-            photons,
+            job_photons,
             pass_hash,
             job_queue,
             job_count,
             emitted_photon_count,
             abort_switch);
     }
-    if (m_params.m_enable_ibl && m_scene.get_environment()->get_environment_edf())
+    if (trace_env_photons)
     {
         schedule_environment_photon_tracing_jobs(
             photon_targets,
-            photons,
+            job_photons,
             pass_hash,
             job_queue,
             job_count,
@@ -848,6 +921,9 @@ void SPPMPhotonTracer::trace_photons(
     // Wait until the photon tracing jobs have completed.
     job_queue.wait_until_completion();
 
+    // Gather the photons of all jobs, in job order.
+    gather_photons(job_photons, photons, job_queue);
+
     // Update photon tracing statistics.
     m_total_emitted_photon_count += emitted_photon_count;
     m_total_stored_photon_count += photons.size();
@@ -870,7 +946,7 @@ void SPPMPhotonTracer::trace_photons(
 
 void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
     const LightTargetArray& photon_targets,
-    SPPMPhotonVector&       photons,
+    PhotonVectorArray&      job_photons,
     const size_t            pass_hash,
     JobQueue&               job_queue,
     size_t&                 job_count,
@@ -897,7 +973,7 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
                 m_oiio_texture_system,
                 m_shading_system,
                 m_params,
-                photons,
+                job_photons[job_count],
                 photon_begin,
                 photon_end,
                 pass_hash,
@@ -910,7 +986,7 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
 
 void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
     const LightTargetArray& photon_targets,
-    SPPMPhotonVector&       photons,
+    PhotonVectorArray&      job_photons,
     const size_t            pass_hash,
     JobQueue&               job_queue,
     size_t&                 job_count,
@@ -937,7 +1013,7 @@ void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
                 m_oiio_texture_system,
                 m_shading_system,
                 m_params,
-                photons,
+                job_photons[job_count],
                 photon_begin,
                 photon_end,
                 pass_hash,
@@ -948,4 +1024,49 @@ void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
     }
 }
 
+void SPPMPhotonTracer::gather_photons(
+    const PhotonVectorArray&    job_photons,
+    SPPMPhotonVector&           photons,
+    JobQueue&                   job_queue)
+{
+    // Compute the location of the photons of each job in the final vector.
+    size_t photon_count = 0;
+    vector<size_t> offsets(job_photons.size());
+    for (size_t i = 0, e = job_photons.size(); i < e; ++i)
+    {
+        offsets[i] = photon_count;
+        photon_count += job_photons[i].size();
+    }
+
+    // Only allocate the arrays of the kind of photons that were stored.
+    const SPPMPhotonVector* first_nonempty = nullptr;
+    for (size_t i = 0, e = job_photons.size(); i < e && first_nonempty == nullptr; ++i)
+    {
+        if (!job_photons[i].empty())
+            first_nonempty = &job_photons[i];
+    }
+
+    photons.m_positions.resize(photon_count);
+    if (first_nonempty != nullptr)
+    {
+        if (!first_nonempty->m_mono_photons.empty())
+            photons.m_mono_photons.resize(photon_count);
+        if (!first_nonempty->m_poly_photons.empty())
+            photons.m_poly_photons.resize(photon_count);
+        if (!first_nonempty->m_compact_mono_photons.empty())
+            photons.m_compact_mono_photons.resize(photon_count);
+        if (!first_nonempty->m_compact_poly_photons.empty())
+            photons.m_compact_poly_photons.resize(photon_count);
+    }
+
+    // Copy the photons of all jobs concurrently.
+    for (size_t i = 0, e = job_photons.size(); i < e; ++i)
+    {
+        if (!job_photons[i].empty())
+            job_queue.schedule(new PhotonCopyJob(job_photons[i], photons, offsets[i]));
+    }
+
+    job_queue.wait_until_completion();
+}
+
 }   // namespace renderer
@@ -38,6 +38,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -84,9 +85,11 @@ class SPPMPhotonTracer
     OIIOTextureSystem&              m_oiio_texture_system;
     OSLShadingSystem&               m_shading_system;
 
+    typedef std::vector<SPPMPhotonVector> PhotonVectorArray;
+
     void schedule_light_photon_tracing_jobs(
         const LightTargetArray&     photon_targets,
-        SPPMPhotonVector&           photons,
+        PhotonVectorArray&          job_photons,
         const size_t                pass_hash,
         foundation::JobQueue&       job_queue,
         size_t&                     job_count,
@@ -95,12 +98,18 @@ class SPPMPhotonTracer
 
     void schedule_environment_photon_tracing_jobs(
         const LightTargetArray&     photon_targets,
-        SPPMPhotonVector&           photons,
+        PhotonVectorArray&          job_photons,
         const size_t                pass_hash,
         foundation::JobQueue&       job_queue,
         size_t&                     job_count,
         size_t&                     emitted_photon_count,
         foundation::IAbortSwitch&   abort_switch);
+
+    // Concatenate the photons stored by all photon tracing jobs.
+    void gather_photons(
+        const PhotonVectorArray&    job_photons,
+        SPPMPhotonVector&           photons,
+        foundation::JobQueue&       job_queue);
 };
 
 }       // namespace renderer
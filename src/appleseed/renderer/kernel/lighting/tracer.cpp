@@ -45,9 +45,11 @@
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <string>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -85,6 +87,164 @@ Tracer::Tracer(
     }
 }
 
+namespace
+{
+    // Number of shadow rays submitted to the intersector at once.
+    const size_t ShadowRayChunkSize = 32;
+}
+
+void Tracer::trace_simple(
+    const ShadingContext&       shading_context,
+    const ShadingRay*           rays,
+    const size_t                ray_count,
+    Spectrum*                   transmissions)
+{
+    if (m_assume_no_alpha_mapping && m_assume_no_participating_media)
+        trace_probes(rays, ray_count, transmissions, nullptr);
+    else
+    {
+        for (size_t i = 0; i < ray_count; ++i)
+            trace_simple(shading_context, rays[i], transmissions[i]);
+    }
+}
+
+void Tracer::trace_simple(
+    const ShadingContext&       shading_context,
+    const ShadingPoint&         origin,
+    const ShadingRay*           rays,
+    const size_t                ray_count,
+    Spectrum*                   transmissions)
+{
+    if (m_assume_no_alpha_mapping && m_assume_no_participating_media)
+        trace_probes(rays, ray_count, transmissions, &origin);
+    else
+    {
+        for (size_t i = 0; i < ray_count; ++i)
+            trace_simple(shading_context, origin, rays[i], transmissions[i]);
+    }
+}
+
+void Tracer::trace_between_simple(
+    const ShadingContext&       shading_context,
+    const ShadingPoint&         origin,
+    const Vector3d*             targets,
+    const size_t                target_count,
+    const ShadingRay&           parent_ray,
+    const VisibilityFlags::Type ray_flags,
+    Spectrum*                   transmissions)
+{
+    if (m_assume_no_alpha_mapping && m_assume_no_participating_media)
+    {
+        ShadingRay rays[ShadowRayChunkSize];
+
+        for (size_t begin = 0; begin < target_count; begin += ShadowRayChunkSize)
+        {
+            const size_t count = min(target_count - begin, ShadowRayChunkSize);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Vector3d direction = targets[begin + i] - origin.get_point();
+                const double dist = norm(direction);
+
+                rays[i] =
+                    ShadingRay(
+                        origin.get_biased_point(direction),
+                        direction / dist,
+                        0.0,                        // ray tmin
+                        dist * (1.0 - 1.0e-6),      // ray tmax
+                        parent_ray.m_time,
+                        ray_flags,
+                        parent_ray.m_depth);
+            }
+
+            trace_probes(rays, count, transmissions + begin, &origin);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < target_count; ++i)
+        {
+            trace_between_simple(
+                shading_context,
+                origin,
+                targets[i],
+                parent_ray,
+                ray_flags,
+                transmissions[i]);
+        }
+    }
+}
+
+void Tracer::trace_between_simple(
+    const ShadingContext&       shading_context,
+    const Vector3d&             origin,
+    const Vector3d*             targets,
+    const size_t                target_count,
+    const ShadingRay&           parent_ray,
+    const VisibilityFlags::Type ray_flags,
+    Spectrum*                   transmissions)
+{
+    if (m_assume_no_alpha_mapping && m_assume_no_participating_media)
+    {
+        ShadingRay rays[ShadowRayChunkSize];
+
+        for (size_t begin = 0; begin < target_count; begin += ShadowRayChunkSize)
+        {
+            const size_t count = min(target_count - begin, ShadowRayChunkSize);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Vector3d direction = targets[begin + i] - origin;
+                const double dist = norm(direction);
+
+                rays[i] =
+                    ShadingRay(
+                        origin,
+                        direction / dist,
+                        0.0,                        // ray tmin
+                        dist * (1.0 - 1.0e-6),      // ray tmax
+                        parent_ray.m_time,
+                        ray_flags,
+                        parent_ray.m_depth);
+            }
+
+            trace_probes(rays, count, transmissions + begin, nullptr);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < target_count; ++i)
+        {
+            trace_between_simple(
+                shading_context,
+                origin,
+                targets[i],
+                parent_ray,
+                ray_flags,
+                transmissions[i]);
+        }
+    }
+}
+
+void Tracer::trace_probes(
+    const ShadingRay*           rays,
+    const size_t                ray_count,
+    Spectrum*                   transmissions,
+    const ShadingPoint*         parent_shading_point) const
+{
+    bool hits[ShadowRayChunkSize];
+
+    for (size_t begin = 0; begin < ray_count; begin += ShadowRayChunkSize)
+    {
+        const size_t count = min(ray_count - begin, ShadowRayChunkSize);
+
+        m_intersector.trace_probe(rays + begin, count, hits, parent_shading_point);
+
+        for (size_t i = 0; i < count; ++i)
+            transmissions[begin + i].set(hits[i] ? 0.0f : 1.0f);
+    }
+}
+
 const ShadingPoint& Tracer::do_trace(
     const ShadingContext&       shading_context,
     const ShadingRay&           ray,
@@ -118,6 +118,42 @@ class Tracer
         const ShadingRay::DepthType     ray_depth,
         Spectrum&                       transmission);
 
+    // Compute the transmission along a batch of rays.
+    // transmissions[i] receives the transmission factor along rays[i].
+    // Occlusion is resolved with a single batched probe query when the scene
+    // has neither alpha mapping nor participating media, otherwise each ray
+    // is traced individually.
+    void trace_simple(
+        const ShadingContext&           shading_context,
+        const ShadingRay*               rays,
+        const size_t                    ray_count,
+        Spectrum*                       transmissions);
+    void trace_simple(
+        const ShadingContext&           shading_context,
+        const ShadingPoint&             origin,
+        const ShadingRay*               rays,
+        const size_t                    ray_count,
+        Spectrum*                       transmissions);
+
+    // Compute the transmission between a point and a batch of target points.
+    // transmissions[i] receives the transmission factor between origin and targets[i].
+    void trace_between_simple(
+        const ShadingContext&           shading_context,
+        const ShadingPoint&             origin,
+        const foundation::Vector3d*     targets,
+        const size_t                    target_count,
+        const ShadingRay&               parent_ray,
+        const VisibilityFlags::Type     ray_flags,
+        Spectrum*                       transmissions);
+    void trace_between_simple(
+        const ShadingContext&           shading_context,
+        const foundation::Vector3d&     origin,
+        const foundation::Vector3d*     targets,
+        const size_t                    target_count,
+        const ShadingRay&               parent_ray,
+        const VisibilityFlags::Type     ray_flags,
+        Spectrum*                       transmissions);
+
     // Compute the transmission in a given direction.
     // Returns the intersection with the closest fully opaque occluder
     // and the transmission factor up to (but excluding) this occluder,
@@ -175,6 +211,12 @@ class Tracer
     const size_t                        m_max_iterations;
     ShadingPoint                        m_shading_points[2];
 
+    void trace_probes(
+        const ShadingRay*               rays,
+        const size_t                    ray_count,
+        Spectrum*                       transmissions,
+        const ShadingPoint*             parent_shading_point) const;
+
     const ShadingPoint& do_trace(
         const ShadingContext&           shading_context,
         const ShadingRay&               ray,
@@ -368,6 +368,17 @@ void VolumeLightingIntegrator::add_single_distance_sample_contribution_exponenti
     radiance += inscattered;
 }
 
+const Spectrum* VolumeLightingIntegrator::get_extinction_majorant() const
+{
+    // For heterogeneous volumes this is a majorant of the extinction along the ray:
+    // distances are drawn from it while transmission is estimated by the volume.
+    const Spectrum& extinction_coef = m_volume.extinction_coefficient(
+        m_volume_data, m_volume_ray);
+
+    // Skip rays that only cross empty space.
+    return is_zero(extinction_coef) ? nullptr : &extinction_coef;
+}
+
 void VolumeLightingIntegrator::compute_radiance_combined_sampling(
     SamplingContext&            sampling_context,
     const MISHeuristic          mis_heuristic,
@@ -379,8 +390,11 @@ void VolumeLightingIntegrator::compute_radiance_combined_sampling(
     if (!m_light_sampler.has_lights())
         return;
 
-    Spectrum extinction_coef = m_volume.extinction_coefficient(
-        m_volume_data, m_volume_ray);
+    const Spectrum* extinction_majorant = get_extinction_majorant();
+    if (extinction_majorant == nullptr)
+        return;
+
+    const Spectrum& extinction_coef = *extinction_majorant;
 
     if (m_distance_sample_count > 0)
     {
@@ -457,8 +471,11 @@ void VolumeLightingIntegrator::compute_radiance_exponential_sampling(
     if (!m_light_sampler.has_lights())
         return;
 
-    const Spectrum& extinction_coef = m_volume.extinction_coefficient(
-        m_volume_data, m_volume_ray);
+    const Spectrum* extinction_majorant = get_extinction_majorant();
+    if (extinction_majorant == nullptr)
+        return;
+
+    const Spectrum& extinction_coef = *extinction_majorant;
 
     if (m_distance_sample_count > 0)
     {
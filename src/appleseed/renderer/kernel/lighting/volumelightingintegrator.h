@@ -110,6 +110,10 @@ namespace renderer
         const float                         m_low_light_threshold;
         const bool                          m_indirect;
 
+        // Return the extinction coefficient used to draw distances along the volume ray,
+        // or nullptr if the ray only crosses empty space.
+        const Spectrum* get_extinction_majorant() const;
+
         // Sample distance and integrate in-scattered lighting at this distance.
         void add_single_distance_sample_contribution(
             const LightSample*              light_sample,
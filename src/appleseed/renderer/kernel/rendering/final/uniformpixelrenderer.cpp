@@ -57,9 +57,13 @@
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <vector>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -70,6 +74,9 @@ namespace
     // Uniform pixel renderer.
     //
 
+    // Number of samples of a pixel rendered together.
+    const size_t SampleBatchSize = 16;
+
     class UniformPixelRenderer
       : public PixelRendererBase
     {
@@ -85,6 +92,11 @@ namespace
           , m_sample_count(m_params.m_samples)
           , m_sqrt_sample_count(round<int>(sqrt(static_cast<double>(m_params.m_samples))))
         {
+            m_sampling_contexts.reserve(SampleBatchSize);
+            m_pixel_contexts.reserve(SampleBatchSize);
+            m_sample_positions.reserve(SampleBatchSize);
+            m_framebuffer_positions.reserve(SampleBatchSize);
+
             if (!m_params.m_decorrelate)
             {
                 m_pixel_sampler.initialize(m_sqrt_sample_count);
@@ -163,32 +175,21 @@ namespace
                     // Compute the sample position in NDC.
                     const Vector2d sample_position = frame.get_sample_position(pi.x + s.x, pi.y + s.y);
 
-                    // Create a pixel context that identifies the pixel and sample currently being rendered.
-                    const PixelContext pixel_context(pi, sample_position);
-
-                    // Render the sample.
-                    ShadingResult shading_result(aov_count);
-                    SamplingContext child_sampling_context(sampling_context);
-                    m_sample_renderer->render_sample(
-                        child_sampling_context,
-                        pixel_context,
-                        sample_position,
-                        aov_accumulators,
-                        shading_result);
-
-                    // Update sampling statistics.
-                    m_total_sampling_dim.insert(child_sampling_context.get_total_dimension());
-
-                    // Merge the sample into the framebuffer.
-                    if (shading_result.is_valid())
-                    {
-                        framebuffer.add(
+                    // Queue the sample.
+                    m_sampling_contexts.push_back(sampling_context);
+                    m_pixel_contexts.push_back(PixelContext(pi, sample_position));
+                    m_sample_positions.push_back(sample_position);
+                    m_framebuffer_positions.push_back(
+                        Vector2f(
                             static_cast<float>(pt.x + s.x),
-                            static_cast<float>(pt.y + s.y),
-                            shading_result);
-                    }
-                    else signal_invalid_sample();
+                            static_cast<float>(pt.y + s.y)));
+
+                    // Render the queued samples once the batch is full.
+                    if (m_sampling_contexts.size() == SampleBatchSize)
+                        render_sample_batch(aov_count, aov_accumulators, framebuffer);
                 }
+
+                render_sample_batch(aov_count, aov_accumulators, framebuffer);
             }
             else
             {
@@ -212,42 +213,30 @@ namespace
                         // Compute the sample position in NDC.
                         const Vector2d sample_position = frame.get_sample_position(s.x, s.y);
 
-                        // Create a pixel context that identifies the pixel and sample currently being rendered.
-                        const PixelContext pixel_context(pi, sample_position);
-
-                        // Create a sampling context. We start with an initial dimension of 1,
-                        // as this seems to give less correlation artifacts than when the
-                        // initial dimension is set to 0 or 2.
-                        SamplingContext sampling_context(
-                            rng,
-                            m_params.m_sampling_mode,
-                            1,                          // number of dimensions
-                            instance,                   // number of samples
-                            instance);                  // initial instance number -- end of sequence
-
-                        // Render the sample.
-                        ShadingResult shading_result(aov_count);
-                        m_sample_renderer->render_sample(
-                            sampling_context,
-                            pixel_context,
-                            sample_position,
-                            aov_accumulators,
-                            shading_result);
-
-                        // Update sampling statistics.
-                        m_total_sampling_dim.insert(sampling_context.get_total_dimension());
-
-                        // Merge the sample into the framebuffer.
-                        if (shading_result.is_valid())
-                        {
-                            framebuffer.add(
+                        // Queue the sample. We start with an initial dimension of 1 for its
+                        // sampling context, as this seems to give less correlation artifacts
+                        // than when the initial dimension is set to 0 or 2.
+                        m_sampling_contexts.push_back(
+                            SamplingContext(
+                                rng,
+                                m_params.m_sampling_mode,
+                                1,                          // number of dimensions
+                                instance,                   // number of samples
+                                instance));                 // initial instance number -- end of sequence
+                        m_pixel_contexts.push_back(PixelContext(pi, sample_position));
+                        m_sample_positions.push_back(sample_position);
+                        m_framebuffer_positions.push_back(
+                            Vector2f(
                                 static_cast<float>(s.x - pi.x + pt.x),
-                                static_cast<float>(s.y - pi.y + pt.y),
-                                shading_result);
-                        }
-                        else signal_invalid_sample();
+                                static_cast<float>(s.y - pi.y + pt.y)));
+
+                        // Render the queued samples once the batch is full.
+                        if (m_sampling_contexts.size() == SampleBatchSize)
+                            render_sample_batch(aov_count, aov_accumulators, framebuffer);
                     }
                 }
+
+                render_sample_batch(aov_count, aov_accumulators, framebuffer);
             }
 
             on_pixel_end(pi, pt, tile_bbox, aov_accumulators);
@@ -293,6 +282,65 @@ namespace
         const int                           m_sqrt_sample_count;
         PixelSampler                        m_pixel_sampler;
         Population<uint64>                  m_total_sampling_dim;
+
+        // Samples of the current pixel waiting to be rendered.
+        vector<SamplingContext>             m_sampling_contexts;
+        vector<PixelContext>                m_pixel_contexts;
+        vector<Vector2d>                    m_sample_positions;
+        vector<Vector2f>                    m_framebuffer_positions;
+        ShadingResult                       m_shading_results[SampleBatchSize];
+
+        // Render the queued samples and merge them into the framebuffer.
+        void render_sample_batch(
+            const size_t                    aov_count,
+            AOVAccumulatorContainer&        aov_accumulators,
+            ShadingResultFrameBuffer&       framebuffer)
+        {
+            const size_t sample_count = m_sampling_contexts.size();
+            assert(sample_count <= SampleBatchSize);
+
+            if (sample_count == 0)
+                return;
+
+            // Reset the shading results, like ShadingResult's constructor does.
+            for (size_t i = 0; i < sample_count; ++i)
+            {
+                ShadingResult& shading_result = m_shading_results[i];
+                shading_result.m_aov_count = aov_count;
+                for (size_t j = 0; j < aov_count; ++j)
+                    shading_result.m_aovs[j].set(0.0f);
+            }
+
+            // Render the samples.
+            m_sample_renderer->render_samples(
+                &m_sampling_contexts[0],
+                &m_pixel_contexts[0],
+                &m_sample_positions[0],
+                sample_count,
+                aov_accumulators,
+                m_shading_results);
+
+            for (size_t i = 0; i < sample_count; ++i)
+            {
+                // Update sampling statistics.
+                m_total_sampling_dim.insert(m_sampling_contexts[i].get_total_dimension());
+
+                // Merge the sample into the framebuffer.
+                if (m_shading_results[i].is_valid())
+                {
+                    framebuffer.add(
+                        m_framebuffer_positions[i].x,
+                        m_framebuffer_positions[i].y,
+                        m_shading_results[i]);
+                }
+                else signal_invalid_sample();
+            }
+
+            m_sampling_contexts.clear();
+            m_pixel_contexts.clear();
+            m_sample_positions.clear();
+            m_framebuffer_positions.clear();
+        }
     };
 }
 
@@ -99,7 +99,8 @@ namespace
                     global_logger(),
                     m_job_queue,
                     m_params.m_thread_count,
-                    JobManager::KeepRunningOnEmptyQueue));
+                    JobManager::KeepRunningOnEmptyQueue,
+                    m_params.m_thread_placement));
 
             // Instantiate tile renderers, one per rendering thread.
             m_tile_renderers.reserve(m_params.m_thread_count);
@@ -145,11 +146,13 @@ namespace
                 "  spectrum mode                 %s\n"
                 "  sampling mode                 %s\n"
                 "  rendering threads             %s\n"
+                "  thread placement              %s\n"
                 "  tile ordering                 %s\n"
                 "  passes                        %s",
                 get_spectrum_mode_name(m_params.m_spectrum_mode).c_str(),
                 get_sampling_context_mode_name(m_params.m_sampling_mode).c_str(),
                 pretty_uint(m_params.m_thread_count).c_str(),
+                get_thread_placement_name(m_params.m_thread_placement),
                 m_params.m_tile_ordering == TileJobFactory::TileOrdering::LinearOrdering ? "linear" :
                 m_params.m_tile_ordering == TileJobFactory::TileOrdering::SpiralOrdering ? "spiral" :
                 m_params.m_tile_ordering == TileJobFactory::TileOrdering::HilbertOrdering ? "hilbert" : "random",
@@ -236,6 +239,7 @@ namespace
             const Spectrum::Mode                m_spectrum_mode;
             const SamplingContext::Mode         m_sampling_mode;
             const size_t                        m_thread_count;     // number of rendering threads
+            const ThreadPlacement               m_thread_placement; // placement of rendering threads
             const TileJobFactory::TileOrdering  m_tile_ordering;    // tile rendering order
             const size_t                        m_pass_count;       // number of rendering passes
 
@@ -243,6 +247,7 @@ namespace
               : m_spectrum_mode(get_spectrum_mode(params))
               , m_sampling_mode(get_sampling_context_mode(params))
               , m_thread_count(get_rendering_thread_count(params))
+              , m_thread_placement(get_rendering_thread_placement(params))
               , m_tile_ordering(get_tile_ordering(params))
               , m_pass_count(params.get_optional<size_t>("passes", 1))
             {
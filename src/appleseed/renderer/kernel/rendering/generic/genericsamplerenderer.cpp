@@ -40,6 +40,7 @@
 #include "renderer/kernel/lighting/tracer.h"
 #include "renderer/kernel/shading/oslshadergroupexec.h"
 #include "renderer/kernel/shading/oslshadingsystem.h"
+#include "renderer/kernel/shading/shadergroupprofiler.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingengine.h"
 #include "renderer/kernel/shading/shadingpoint.h"
@@ -55,6 +56,7 @@
 #include "foundation/image/color.h"
 #include "foundation/image/image.h"
 #include "foundation/image/regularspectrum.h"
+#include "foundation/math/population.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/arena.h"
@@ -62,6 +64,7 @@
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstddef>
 #include <limits>
 #include <string>
@@ -81,6 +84,9 @@ namespace
     // Generic sample renderer.
     //
 
+    // Maximum number of primary rays traced before the corresponding samples are shaded.
+    const size_t PrimaryRayBatchSize = 16;
+
     // If defined, the texture cache returns solid tiles whose color depends on whether
     // the requested tile could be found in the cache or not.
     #undef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCES
@@ -98,6 +104,7 @@ namespace
             ShadingEngine&          shading_engine,
             OIIOTextureSystem&      oiio_texture_system,
             OSLShadingSystem&       shading_system,
+            ShaderGroupProfiler&    shader_group_profiler,
             const size_t            thread_index,
             const ParamArray&       params)
           : m_params(params)
@@ -108,7 +115,12 @@ namespace
           , m_shading_engine(shading_engine)
           , m_oiio_texture_system(oiio_texture_system)
           , m_thread_index(thread_index)
-          , m_shadergroup_exec(shading_system, m_arena)
+          , m_shadergroup_exec(
+                shading_system,
+                m_arena,
+                m_params.m_profile_shader_groups
+                    ? shader_group_profiler.create_stream()
+                    : nullptr)
           , m_intersector(
                 trace_context,
                 m_texture_cache,
@@ -155,10 +167,14 @@ namespace
                 "generic sample renderer settings:\n"
                 "  transparency threshold        %f\n"
                 "  max iterations                %s\n"
-                "  report self intersections     %s",
+                "  report self intersections     %s\n"
+                "  reorder primary rays          %s\n"
+                "  profile shader groups         %s",
                 m_params.m_transparency_threshold,
                 pretty_uint(m_params.m_max_iterations).c_str(),
-                m_params.m_report_self_intersections ? "on" : "off");
+                m_params.m_report_self_intersections ? "on" : "off",
+                m_params.m_reorder_primary_rays ? "on" : "off",
+                m_params.m_profile_shader_groups ? "on" : "off");
 
             m_lighting_engine->print_settings();
         }
@@ -170,13 +186,6 @@ namespace
             AOVAccumulatorContainer&    aov_accumulators,
             ShadingResult&              shading_result) override
         {
-#ifdef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCES
-
-            const uint64 last_texture_cache_hit_count = m_texture_cache.get_hit_count();
-            const uint64 last_texture_cache_miss_count = m_texture_cache.get_miss_count();
-
-#endif
-
             // Construct a primary ray.
             ShadingRay primary_ray;
             m_scene.get_active_camera()->spawn_ray(
@@ -184,6 +193,149 @@ namespace
                 Dual2d(image_point, m_image_point_dx, m_image_point_dy),
                 primary_ray);
 
+            trace_and_shade(
+                sampling_context,
+                pixel_context,
+                primary_ray,
+                nullptr,
+                aov_accumulators,
+                shading_result);
+        }
+
+        void render_samples(
+            SamplingContext*            sampling_contexts,
+            const PixelContext*         pixel_contexts,
+            const Vector2d*             image_points,
+            const size_t                sample_count,
+            AOVAccumulatorContainer&    aov_accumulators,
+            ShadingResult*              shading_results) override
+        {
+            if (!m_params.m_reorder_primary_rays)
+            {
+                ISampleRenderer::render_samples(
+                    sampling_contexts,
+                    pixel_contexts,
+                    image_points,
+                    sample_count,
+                    aov_accumulators,
+                    shading_results);
+                return;
+            }
+
+            const Camera* camera = m_scene.get_active_camera();
+
+            for (size_t begin = 0; begin < sample_count; begin += PrimaryRayBatchSize)
+            {
+                const size_t count = min(sample_count - begin, PrimaryRayBatchSize);
+
+                // Construct the primary rays of this batch.
+                for (size_t i = 0; i < count; ++i)
+                {
+                    camera->spawn_ray(
+                        sampling_contexts[begin + i],
+                        Dual2d(image_points[begin + i], m_image_point_dx, m_image_point_dy),
+                        m_primary_rays[i]);
+                }
+
+                // Trace them one after the other, grouped by direction octant.
+                for (size_t i = 0; i < count; ++i)
+                    m_primary_shading_points[i].clear();
+                m_intersector.trace(m_primary_rays, count, m_primary_shading_points);
+
+                // Shade the samples.
+                for (size_t i = 0; i < count; ++i)
+                {
+                    trace_and_shade(
+                        sampling_contexts[begin + i],
+                        pixel_contexts[begin + i],
+                        m_primary_rays[i],
+                        &m_primary_shading_points[i],
+                        aov_accumulators,
+                        shading_results[begin + i]);
+                }
+            }
+        }
+
+        StatisticsVector get_statistics() const override
+        {
+            StatisticsVector stats;
+            stats.merge(m_texture_cache.get_statistics());
+            stats.merge(m_intersector.get_statistics());
+            stats.merge(m_lighting_engine->get_statistics());
+
+            // Merging per-thread populations gives the spread of arena usage across threads.
+            Population<uint64> arena_high_water_mark;
+            arena_high_water_mark.insert(m_arena.get_high_water_mark());
+
+            Population<uint64> arena_overflow_pages;
+            arena_overflow_pages.insert(m_arena.get_overflow_page_count());
+
+            Statistics arena_stats;
+            arena_stats.insert("high-water mark", arena_high_water_mark, "bytes");
+            arena_stats.insert("overflow pages", arena_overflow_pages);
+            stats.merge(StatisticsVector::make("shading arena statistics", arena_stats));
+
+            return stats;
+        }
+
+      private:
+        struct Parameters
+        {
+            const float     m_transparency_threshold;
+            const size_t    m_max_iterations;
+            const bool      m_report_self_intersections;
+            const bool      m_reorder_primary_rays;
+            const bool      m_profile_shader_groups;
+
+            explicit Parameters(const ParamArray& params)
+              : m_transparency_threshold(params.get_optional<float>("transparency_threshold", 0.001f))
+              , m_max_iterations(params.get_optional<size_t>("max_iterations", 100))
+              , m_report_self_intersections(params.get_optional<bool>("report_self_intersections", false))
+              , m_reorder_primary_rays(params.get_optional<bool>("reorder_primary_rays", false))
+              , m_profile_shader_groups(params.get_optional<bool>("profile_shader_groups", false))
+            {
+            }
+        };
+
+        const Parameters            m_params;
+        const Scene&                m_scene;
+        const float                 m_opacity_threshold;
+        TextureCache                m_texture_cache;
+        ILightingEngine*            m_lighting_engine;
+        ShadingEngine&              m_shading_engine;
+        OIIOTextureSystem&          m_oiio_texture_system;
+        const size_t                m_thread_index;
+
+        Arena                       m_arena;
+        OSLShaderGroupExec          m_shadergroup_exec;
+        const Intersector           m_intersector;
+        Tracer                      m_tracer;
+        const ShadingContext        m_shading_context;
+
+        Vector2d                    m_image_point_dx;
+        Vector2d                    m_image_point_dy;
+
+        // Primary rays of a batch of samples, traced by render_samples() before shading.
+        ShadingRay                  m_primary_rays[PrimaryRayBatchSize];
+        ShadingPoint                m_primary_shading_points[PrimaryRayBatchSize];
+
+        // Shade the surface hit by a primary ray, continuing the ray through transparent surfaces.
+        // If first_shading_point is not null, it holds the result of tracing primary_ray.
+        void trace_and_shade(
+            SamplingContext&            sampling_context,
+            const PixelContext&         pixel_context,
+            ShadingRay&                 primary_ray,
+            const ShadingPoint*         first_shading_point,
+            AOVAccumulatorContainer&    aov_accumulators,
+            ShadingResult&              shading_result)
+        {
+#ifdef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCES
+
+            const uint64 last_texture_cache_hit_count = m_texture_cache.get_hit_count();
+            const uint64 last_texture_cache_miss_count = m_texture_cache.get_miss_count();
+
+#endif
+
             ShadingPoint shading_points[2];
             size_t shading_point_index = 0;
             const ShadingPoint* shading_point_ptr = nullptr;
@@ -205,16 +357,24 @@ namespace
 
                 m_arena.clear();
 
-                // Trace the ray.
-                shading_points[shading_point_index].clear();
-                m_intersector.trace(
-                    primary_ray,
-                    shading_points[shading_point_index],
-                    shading_point_ptr);
-
-                // Update the pointers to the shading points.
-                shading_point_ptr = &shading_points[shading_point_index];
-                shading_point_index = 1 - shading_point_index;
+                if (iterations == 1 && first_shading_point != nullptr)
+                {
+                    // The primary ray was already traced.
+                    shading_point_ptr = first_shading_point;
+                }
+                else
+                {
+                    // Trace the ray.
+                    shading_points[shading_point_index].clear();
+                    m_intersector.trace(
+                        primary_ray,
+                        shading_points[shading_point_index],
+                        shading_point_ptr);
+
+                    // Update the pointers to the shading points.
+                    shading_point_ptr = &shading_points[shading_point_index];
+                    shading_point_index = 1 - shading_point_index;
+                }
 
                 if (iterations == 1)
                 {
@@ -295,48 +455,6 @@ namespace
 
 #endif
         }
-
-        StatisticsVector get_statistics() const override
-        {
-            StatisticsVector stats;
-            stats.merge(m_texture_cache.get_statistics());
-            stats.merge(m_intersector.get_statistics());
-            stats.merge(m_lighting_engine->get_statistics());
-            return stats;
-        }
-
-      private:
-        struct Parameters
-        {
-            const float     m_transparency_threshold;
-            const size_t    m_max_iterations;
-            const bool      m_report_self_intersections;
-
-            explicit Parameters(const ParamArray& params)
-              : m_transparency_threshold(params.get_optional<float>("transparency_threshold", 0.001f))
-              , m_max_iterations(params.get_optional<size_t>("max_iterations", 100))
-              , m_report_self_intersections(params.get_optional<bool>("report_self_intersections", false))
-            {
-            }
-        };
-
-        const Parameters            m_params;
-        const Scene&                m_scene;
-        const float                 m_opacity_threshold;
-        TextureCache                m_texture_cache;
-        ILightingEngine*            m_lighting_engine;
-        ShadingEngine&              m_shading_engine;
-        OIIOTextureSystem&          m_oiio_texture_system;
-        const size_t                m_thread_index;
-
-        Arena                       m_arena;
-        OSLShaderGroupExec          m_shadergroup_exec;
-        const Intersector           m_intersector;
-        Tracer                      m_tracer;
-        const ShadingContext        m_shading_context;
-
-        Vector2d                    m_image_point_dx;
-        Vector2d                    m_image_point_dy;
     };
 }
 
@@ -354,6 +472,7 @@ GenericSampleRendererFactory::GenericSampleRendererFactory(
     ShadingEngine&          shading_engine,
     OIIOTextureSystem&      oiio_texture_system,
     OSLShadingSystem&       shading_system,
+    ShaderGroupProfiler&    shader_group_profiler,
     const ParamArray&       params)
   : m_scene(scene)
   , m_frame(frame)
@@ -363,6 +482,7 @@ GenericSampleRendererFactory::GenericSampleRendererFactory(
   , m_shading_engine(shading_engine)
   , m_oiio_texture_system(oiio_texture_system)
   , m_shading_system(shading_system)
+  , m_shader_group_profiler(shader_group_profiler)
   , m_params(params)
 {
 }
@@ -384,6 +504,7 @@ ISampleRenderer* GenericSampleRendererFactory::create(const size_t thread_index)
             m_shading_engine,
             m_oiio_texture_system,
             m_shading_system,
+            m_shader_group_profiler,
             thread_index,
             m_params);
 }
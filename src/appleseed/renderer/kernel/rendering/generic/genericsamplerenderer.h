@@ -43,6 +43,7 @@ namespace renderer  { class ILightingEngineFactory; }
 namespace renderer  { class OIIOTextureSystem; }
 namespace renderer  { class OSLShadingSystem; }
 namespace renderer  { class Scene; }
+namespace renderer  { class ShaderGroupProfiler; }
 namespace renderer  { class ShadingEngine; }
 namespace renderer  { class TextureStore; }
 namespace renderer  { class TraceContext; }
@@ -68,6 +69,7 @@ class GenericSampleRendererFactory
         ShadingEngine&          shading_engine,
         OIIOTextureSystem&      oiio_texture_system,
         OSLShadingSystem&       shading_system,
+        ShaderGroupProfiler&    shader_group_profiler,
         const ParamArray&       params);
 
     // Delete this instance.
@@ -86,6 +88,7 @@ class GenericSampleRendererFactory
     ShadingEngine&              m_shading_engine;
     OIIOTextureSystem&          m_oiio_texture_system;
     OSLShadingSystem&           m_shading_system;
+    ShaderGroupProfiler&        m_shader_group_profiler;
     const ParamArray            m_params;
 };
 
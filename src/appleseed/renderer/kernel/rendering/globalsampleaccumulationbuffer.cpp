@@ -40,10 +40,16 @@
 #include "foundation/image/image.h"
 #include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/thread.h"
 #include "foundation/utility/job/iabortswitch.h"
 
-// Boost headers.
-#include "boost/chrono/duration.hpp"
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -51,23 +57,45 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    // Minimum height of a band, in pixels.
+    const size_t MinBandHeight = 16;
+
+    size_t compute_band_height(const Filter2f& filter)
+    {
+        // A filter footprint covers at most 2 * ceil(yradius) + 1 rows.
+        const size_t footprint_height =
+            2 * static_cast<size_t>(std::ceil(filter.get_yradius())) + 1;
+
+        return max(MinBandHeight, footprint_height);
+    }
+}
+
 GlobalSampleAccumulationBuffer::GlobalSampleAccumulationBuffer(
     const size_t    width,
     const size_t    height,
     const Filter2f& filter)
   : m_fb(width, height, 3, filter)
   , m_filter_rcp_norm_factor(1.0f / compute_normalization_factor(filter))
+  , m_band_height(compute_band_height(filter))
+  , m_band_count(max<size_t>((height + m_band_height - 1) / m_band_height, 1))
+  , m_bands(m_band_count, AlignedAllocator<Band>(64))
 {
 }
 
 void GlobalSampleAccumulationBuffer::clear()
 {
-    // Request exclusive access.
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+    // Request exclusive access to the whole buffer. Bands are always locked in increasing order.
+    for (size_t i = 0; i < m_band_count; ++i)
+        m_bands[i].m_lock.lock();
 
     m_sample_count = 0;
 
     m_fb.clear();
+
+    for (size_t i = 0; i < m_band_count; ++i)
+        m_bands[i].m_lock.unlock();
 }
 
 void GlobalSampleAccumulationBuffer::store_samples(
@@ -75,33 +103,55 @@ void GlobalSampleAccumulationBuffer::store_samples(
     const Sample    samples[],
     IAbortSwitch&   abort_switch)
 {
-    // Request non-exclusive access.
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex, boost::defer_lock);
-    while (true)
+    if (sample_count == 0)
+        return;
+
+    const float fh = static_cast<float>(m_fb.get_height());
+
+    // Fetch this thread's scratch storage; it is reused across calls.
+    StoreScratch* scratch = m_store_scratch.get();
+    if (scratch == nullptr)
     {
-        if (abort_switch.is_aborted())
-            return;
-        if (lock.try_lock_for(boost::chrono::milliseconds(5)))
-            break;
+        scratch = new StoreScratch();
+        m_store_scratch.reset(scratch);
     }
 
-    const float fw = static_cast<float>(m_fb.get_width());
-    const float fh = static_cast<float>(m_fb.get_height());
-    size_t counter = 0;
+    vector<size_t>& band_indices = scratch->m_band_indices;
+    vector<size_t>& band_offsets = scratch->m_band_offsets;
+    vector<size_t>& cursors = scratch->m_cursors;
+    vector<const Sample*>& sorted_samples = scratch->m_sorted_samples;
 
-    const Sample* sample_end = samples + sample_count;
-    for (const Sample* s = samples; s < sample_end; ++s)
+    // Bucket samples by the band containing the top of their footprint (counting sort).
+    band_indices.resize(sample_count);
+    band_offsets.assign(m_band_count + 1, 0);
+    for (size_t i = 0; i < sample_count; ++i)
     {
-        if ((counter++ & 4096) == 0 && abort_switch.is_aborted())
-            return;
+        const size_t band_index = get_band_index(samples[i].m_position.y * fh);
+        band_indices[i] = band_index;
+        ++band_offsets[band_index + 1];
+    }
 
-        const float fx = s->m_position.x * fw;
-        const float fy = s->m_position.y * fh;
+    for (size_t i = 0; i < m_band_count; ++i)
+        band_offsets[i + 1] += band_offsets[i];
 
-        Color3f value(s->m_color.rgb());
-        value *= m_filter_rcp_norm_factor;
+    sorted_samples.resize(sample_count);
+    cursors.assign(band_offsets.begin(), band_offsets.end() - 1);
+    for (size_t i = 0; i < sample_count; ++i)
+        sorted_samples[cursors[band_indices[i]]++] = &samples[i];
 
-        m_fb.atomic_add(fx, fy, &value[0]);
+    // Splat each bucket while holding only the locks of the bands it touches.
+    for (size_t i = 0; i < m_band_count; ++i)
+    {
+        const size_t begin = band_offsets[i];
+        const size_t end = band_offsets[i + 1];
+
+        if (begin == end)
+            continue;
+
+        if (abort_switch.is_aborted())
+            return;
+
+        store_band_samples(i, end - begin, &sorted_samples[begin], abort_switch);
     }
 }
 
@@ -109,16 +159,6 @@ void GlobalSampleAccumulationBuffer::develop_to_frame(
     Frame&          frame,
     IAbortSwitch&   abort_switch)
 {
-    // Request exclusive access.
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex, boost::defer_lock);
-    while (true)
-    {
-        if (abort_switch.is_aborted())
-            return;
-        if (lock.try_lock_for(boost::chrono::milliseconds(5)))
-            break;
-    }
-
     Image& image = frame.image();
     const CanvasProperties& frame_props = image.properties();
 
@@ -126,22 +166,22 @@ void GlobalSampleAccumulationBuffer::develop_to_frame(
     assert(frame_props.m_canvas_height == m_fb.get_height());
     assert(frame_props.m_channel_count == 4);
 
+    // The sample count is read once while bands are copied out one at a time, so that
+    // sample generators are never blocked for longer than it takes to copy a single band.
+    // The result is therefore not an exact snapshot: since sample generators store samples
+    // before counting them, bands may hold samples that the count does not account for yet,
+    // and bands copied later may hold more of them. This only affects progressive updates;
+    // the final develop happens once all sample generators have stopped.
     const float scale = 1.0f / m_sample_count;
 
-    for (size_t ty = 0; ty < frame_props.m_tile_count_y; ++ty)
-    {
-        for (size_t tx = 0; tx < frame_props.m_tile_count_x; ++tx)
-        {
-            if (abort_switch.is_aborted())
-                return;
-
-            Tile& tile = image.tile(tx, ty);
+    vector<float> scratch(m_band_height * m_fb.get_width() * m_fb.get_channel_count());
 
-            const size_t x = tx * frame_props.m_tile_width;
-            const size_t y = ty * frame_props.m_tile_height;
+    for (size_t i = 0; i < m_band_count; ++i)
+    {
+        if (abort_switch.is_aborted())
+            return;
 
-            develop_to_tile(tile, x, y, tx, ty, scale);
-        }
+        develop_band(image, i, scale, &scratch[0]);
     }
 }
 
@@ -150,27 +190,100 @@ void GlobalSampleAccumulationBuffer::increment_sample_count(const uint64 delta_s
     m_sample_count += delta_sample_count;
 }
 
-void GlobalSampleAccumulationBuffer::develop_to_tile(
-    Tile&           tile,
-    const size_t    origin_x,
-    const size_t    origin_y,
-    const size_t    tile_x,
-    const size_t    tile_y,
-    const float     scale) const
+size_t GlobalSampleAccumulationBuffer::get_band_index(const float fy) const
+{
+    // Must match the footprint computation of FilteredTile::add().
+    const float dy = fy - 0.5f;
+    const int min_y = truncate<int>(fast_ceil(dy - m_fb.get_filter().get_yradius()));
+
+    if (min_y <= 0)
+        return 0;
+
+    return min(static_cast<size_t>(min_y) / m_band_height, m_band_count - 1);
+}
+
+void GlobalSampleAccumulationBuffer::store_band_samples(
+    const size_t        band_index,
+    const size_t        sample_count,
+    const Sample* const samples[],
+    IAbortSwitch&       abort_switch)
+{
+    // The footprint of samples in this bucket may extend into the next band.
+    const bool lock_next_band = band_index + 1 < m_band_count;
+
+    Spinlock::ScopedLock lock(m_bands[band_index].m_lock);
+    if (lock_next_band)
+        m_bands[band_index + 1].m_lock.lock();
+
+    const float fw = static_cast<float>(m_fb.get_width());
+    const float fh = static_cast<float>(m_fb.get_height());
+
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        if ((i & 4095) == 4095 && abort_switch.is_aborted())
+            break;
+
+        const Sample& sample = *samples[i];
+
+        const float fx = sample.m_position.x * fw;
+        const float fy = sample.m_position.y * fh;
+
+        Color3f value(sample.m_color.rgb());
+        value *= m_filter_rcp_norm_factor;
+
+        m_fb.add(fx, fy, &value[0]);
+    }
+
+    if (lock_next_band)
+        m_bands[band_index + 1].m_lock.unlock();
+}
+
+void GlobalSampleAccumulationBuffer::develop_band(
+    Image&          image,
+    const size_t    band_index,
+    const float     scale,
+    float*          scratch)
 {
-    const size_t tile_width = tile.get_width();
-    const size_t tile_height = tile.get_height();
+    const CanvasProperties& frame_props = image.properties();
+
+    const size_t width = m_fb.get_width();
+    const size_t channel_count = m_fb.get_channel_count();
+    const size_t y0 = band_index * m_band_height;
+    const size_t y1 = min(y0 + m_band_height, m_fb.get_height());
 
-    for (size_t y = 0; y < tile_height; ++y)
+    // Rows are contiguous in the buffer: copy the band out under its lock.
     {
-        for (size_t x = 0; x < tile_width; ++x)
+        Spinlock::ScopedLock lock(m_bands[band_index].m_lock);
+        memcpy(
+            scratch,
+            m_fb.pixel(0, y0),
+            (y1 - y0) * width * channel_count * sizeof(float));
+    }
+
+    for (size_t y = y0; y < y1; ++y)
+    {
+        const size_t ty = y / frame_props.m_tile_height;
+        const size_t py = y - ty * frame_props.m_tile_height;
+        const float* ptr = scratch + (y - y0) * width * channel_count;
+
+        for (size_t tx = 0; tx < frame_props.m_tile_count_x; ++tx)
         {
-            const float* ptr = m_fb.pixel(origin_x + x, origin_y + y);
+            Tile& tile = image.tile(tx, ty);
+
+            const size_t x0 = tx * frame_props.m_tile_width;
+            const size_t tile_width = tile.get_width();
+
+            for (size_t px = 0; px < tile_width; ++px)
+            {
+                assert(x0 + px < width);
+
+                Color4f color(ptr[1], ptr[2], ptr[3], 1.0f);
+                color.rgb() *= scale;
 
-            Color4f color(ptr[1], ptr[2], ptr[3], 1.0f);
-            color.rgb() *= scale;
+                tile.set_pixel(px, py, color);
 
-            tile.set_pixel(x, y, color);
+                ptr += channel_count;
+            }
         }
     }
 }
@@ -39,13 +39,18 @@
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
+#include "foundation/utility/alignedallocator.h"
+
+// Boost headers.
+#include "boost/thread/tss.hpp"
 
 // Standard headers.
 #include <cstddef>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
-namespace foundation    { class Tile; }
+namespace foundation    { class Image; }
 namespace renderer      { class Frame; }
 namespace renderer      { class Sample; }
 
@@ -80,17 +85,49 @@ class GlobalSampleAccumulationBuffer
     void increment_sample_count(const foundation::uint64 delta_sample_count);
 
   private:
-    boost::shared_mutex             m_mutex;
+    // The buffer is split into horizontal bands of rows, each protected by its own lock.
+    // Bands are at least as tall as the filter footprint so that a sample touches at most
+    // two consecutive bands. Threads splatting into different regions of the image never
+    // contend, and developing the buffer only ever holds one band at a time.
+    // Bands are padded and allocated on 64-byte boundaries so that each lock sits in its own cache line.
+    struct Band
+    {
+        foundation::Spinlock        m_lock;
+        char                        m_padding[64 - sizeof(foundation::Spinlock)];
+    };
+
+    typedef std::vector<Band, foundation::AlignedAllocator<Band>> BandVector;
+
+    // Per-thread storage used by store_samples() to bucket samples by band.
+    struct StoreScratch
+    {
+        std::vector<size_t>         m_band_indices;
+        std::vector<size_t>         m_band_offsets;
+        std::vector<size_t>         m_cursors;
+        std::vector<const Sample*>  m_sorted_samples;
+    };
+
     foundation::FilteredTile        m_fb;
     const float                     m_filter_rcp_norm_factor;
+    const size_t                    m_band_height;
+    const size_t                    m_band_count;
+    BandVector                      m_bands;
+    boost::thread_specific_ptr<StoreScratch> m_store_scratch;
+
+    size_t get_band_index(const float fy) const;
+
+    void store_band_samples(
+        const size_t                band_index,
+        const size_t                sample_count,
+        const Sample* const         samples[],
+        foundation::IAbortSwitch&   abort_switch);
+
+    void develop_band(
+        foundation::Image&          image,
+        const size_t                band_index,
+        const float                 scale,
+        float*                      scratch);
 
-    void develop_to_tile(
-        foundation::Tile&           tile,
-        const size_t                origin_x,
-        const size_t                origin_y,
-        const size_t                tile_x,
-        const size_t                tile_y,
-        const float                 scale) const;
 };
 
 }       // namespace renderer
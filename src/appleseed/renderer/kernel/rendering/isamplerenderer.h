@@ -32,6 +32,8 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/rendering/pixelcontext.h"
+#include "renderer/kernel/shading/shadingresult.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/iunknown.h"
@@ -43,8 +45,6 @@
 // Forward declarations.
 namespace foundation    { class StatisticsVector; }
 namespace renderer      { class AOVAccumulatorContainer; }
-namespace renderer      { class PixelContext; }
-namespace renderer      { class ShadingResult; }
 
 namespace renderer
 {
@@ -69,11 +69,46 @@ class ISampleRenderer
         AOVAccumulatorContainer&        aov_accumulators,
         ShadingResult&                  shading_result) = 0;
 
+    // Render a batch of independent samples. All arrays have sample_count elements.
+    // Implementations may trace all the primary rays of the batch before shading any sample.
+    // The default implementation calls render_sample() for each sample in turn.
+    virtual void render_samples(
+        SamplingContext*                sampling_contexts,
+        const PixelContext*             pixel_contexts,
+        const foundation::Vector2d*     image_points,
+        const size_t                    sample_count,
+        AOVAccumulatorContainer&        aov_accumulators,
+        ShadingResult*                  shading_results);
+
     // Retrieve performance statistics.
     virtual foundation::StatisticsVector get_statistics() const = 0;
 };
 
 
+//
+// ISampleRenderer class implementation.
+//
+
+inline void ISampleRenderer::render_samples(
+    SamplingContext*                    sampling_contexts,
+    const PixelContext*                 pixel_contexts,
+    const foundation::Vector2d*         image_points,
+    const size_t                        sample_count,
+    AOVAccumulatorContainer&            aov_accumulators,
+    ShadingResult*                      shading_results)
+{
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        render_sample(
+            sampling_contexts[i],
+            pixel_contexts[i],
+            image_points[i],
+            aov_accumulators,
+            shading_results[i]);
+    }
+}
+
+
 //
 // Interface of a ISampleRenderer factory.
 //
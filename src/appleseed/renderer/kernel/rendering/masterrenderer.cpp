@@ -41,7 +41,9 @@
 #include "renderer/kernel/rendering/serialrenderercontroller.h"
 #include "renderer/kernel/rendering/serialtilecallback.h"
 #include "renderer/kernel/shading/closures.h"
+#include "renderer/kernel/shading/oslshadergroupcache.h"
 #include "renderer/kernel/shading/oslshadingsystem.h"
+#include "renderer/kernel/shading/shadergroupprofiler.h"
 #include "renderer/kernel/texturing/oiiotexturesystem.h"
 #include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/display/display.h"
@@ -63,6 +65,7 @@
 #include "foundation/utility/otherwise.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
 #include <cassert>
@@ -122,6 +125,7 @@ struct MasterRenderer::Impl
 
     RendererServices*           m_renderer_services;
     OSLShadingSystem*           m_shading_system;
+    OSLShaderGroupCache         m_shader_group_cache;
 
     IRendererController*        m_renderer_controller;
     ITileCallbackFactory*       m_tile_callback_factory;
@@ -194,6 +198,7 @@ struct MasterRenderer::Impl
 
         RENDERER_LOG_DEBUG("destroying osl shading system...");
         m_project.get_scene()->release_optimized_osl_shader_groups();
+        m_shader_group_cache.clear();
         m_shading_system->release();
         delete m_renderer_services;
 
@@ -244,14 +249,29 @@ struct MasterRenderer::Impl
         {
             RENDERER_LOG_INFO("setting osl shader search path to %s", new_search_path.c_str());
             m_project.get_scene()->release_optimized_osl_shader_groups();
+            m_shader_group_cache.clear();
             m_shading_system->attribute("searchpath:shader", new_search_path);
         }
 
         // Re-optimize the shader groups that need updating.
-        return
+        const bool success =
             m_project.get_scene()->create_optimized_osl_shader_groups(
                 *m_shading_system,
+                &m_shader_group_cache,
+                get_rendering_thread_count(m_params),
                 &abort_switch);
+
+        // Forget the optimized shader groups that the scene no longer uses.
+        const size_t evicted_count = m_shader_group_cache.evict_unused();
+        if (evicted_count > 0)
+        {
+            RENDERER_LOG_DEBUG(
+                "evicted %s unused osl shader %s from the cache.",
+                pretty_uint(evicted_count).c_str(),
+                plural(evicted_count, "group").c_str());
+        }
+
+        return success;
     }
 
     // Return true if the scene passes basic integrity checks.
@@ -370,6 +390,9 @@ struct MasterRenderer::Impl
         if (!check_scene())
             return IRendererController::AbortRendering;
 
+        // Let entities know how many threads they may use while preparing for rendering.
+        m_project.set_rendering_thread_count(get_rendering_thread_count(m_params));
+
         // Expand all procedural assemblies.
         if (!m_project.get_scene()->expand_procedural_assemblies(m_project, &abort_switch))
             return IRendererController::AbortRendering;
@@ -398,6 +421,9 @@ struct MasterRenderer::Impl
         if (!m_project.get_scene()->on_render_begin(m_project, &abort_switch))
             return IRendererController::AbortRendering;
 
+        // Discard the shader group profiling streams of the previous render.
+        m_project.get_shader_group_profiler().clear_streams();
+
         // Create renderer components.
         RendererComponents components(
             m_project,
@@ -423,6 +449,12 @@ struct MasterRenderer::Impl
             props.m_canvas_width,
             props.m_canvas_height);
 
+        // Print the most expensive shader groups.
+        ShaderGroupProfiler& shader_group_profiler = m_project.get_shader_group_profiler();
+        shader_group_profiler.finalize();
+        if (shader_group_profiler.get_shader_group_count() > 0)
+            RENDERER_LOG_INFO("%s", shader_group_profiler.get_statistics().to_string().c_str());
+
         // Print texture store performance statistics.
         RENDERER_LOG_DEBUG("%s", texture_store.get_statistics().to_string().c_str());
 
@@ -436,8 +468,9 @@ struct MasterRenderer::Impl
     {
         while (true)
         {
-            // Discard recorded light paths.
+            // Discard recorded light paths and shader group execution counters.
             m_project.get_light_path_recorder().clear();
+            m_project.get_shader_group_profiler().clear();
 
             // The on_frame_begin() method of the renderer controller might alter the scene
             // (e.g. transform the camera), thus it needs to be called before the on_frame_begin()
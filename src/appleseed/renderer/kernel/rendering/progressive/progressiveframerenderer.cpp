@@ -119,7 +119,8 @@ namespace
                     global_logger(),
                     m_job_queue,
                     m_params.m_thread_count,
-                    JobManager::KeepRunningOnEmptyQueue));
+                    JobManager::KeepRunningOnEmptyQueue,
+                    m_params.m_thread_placement));
 
             // Instantiate sample generators, one per rendering thread.
             m_sample_generators.reserve(m_params.m_thread_count);
@@ -215,6 +216,7 @@ namespace
                 "  spectrum mode                 %s\n"
                 "  sampling mode                 %s\n"
                 "  rendering threads             %s\n"
+                "  thread placement              %s\n"
                 "  max samples                   %s\n"
                 "  max fps                       %f\n"
                 "  collect performance stats     %s\n"
@@ -223,6 +225,7 @@ namespace
                 get_spectrum_mode_name(m_params.m_spectrum_mode).c_str(),
                 get_sampling_context_mode_name(m_params.m_sampling_mode).c_str(),
                 pretty_uint(m_params.m_thread_count).c_str(),
+                get_thread_placement_name(m_params.m_thread_placement),
                 m_params.m_max_sample_count == numeric_limits<uint64>::max()
                     ? "unlimited"
                     : pretty_uint(m_params.m_max_sample_count).c_str(),
@@ -387,6 +390,7 @@ namespace
             const Spectrum::Mode        m_spectrum_mode;
             const SamplingContext::Mode m_sampling_mode;
             const size_t                m_thread_count;         // number of rendering threads
+            const ThreadPlacement       m_thread_placement;     // placement of rendering threads
             const uint64                m_max_sample_count;     // maximum total number of samples to compute
             const double                m_max_fps;              // maximum display frequency in frames/second
             const bool                  m_perf_stats;           // collect and print performance statistics?
@@ -397,6 +401,7 @@ namespace
               : m_spectrum_mode(get_spectrum_mode(params))
               , m_sampling_mode(get_sampling_context_mode(params))
               , m_thread_count(get_rendering_thread_count(params))
+              , m_thread_placement(get_rendering_thread_placement(params))
               , m_max_sample_count(params.get_optional<uint64>("max_samples", numeric_limits<uint64>::max()))
               , m_max_fps(params.get_optional<double>("max_fps", 30.0))
               , m_perf_stats(params.get_optional<bool>("performance_statistics", false))
@@ -34,6 +34,7 @@
 #include "renderer/kernel/lighting/bdpt/bdptlightingengine.h"
 #include "renderer/kernel/lighting/lighttracing/lighttracingsamplegenerator.h"
 #include "renderer/kernel/lighting/pt/ptlightingengine.h"
+#include "renderer/kernel/lighting/pt/ptpasscallback.h"
 #include "renderer/kernel/lighting/sppm/sppmlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmparameters.h"
 #include "renderer/kernel/lighting/sppm/sppmpasscallback.h"
@@ -86,6 +87,7 @@ namespace
         copy_param(child, source, "spectrum_mode");
         copy_param(child, source, "sampling_mode");
         copy_param(child, source, "rendering_threads");
+        copy_param(child, source, "thread_placement");
         return child;
     }
 }
@@ -157,13 +159,21 @@ bool RendererComponents::create_lighting_engine_factory()
         m_backward_light_sampler.reset(
             new BackwardLightSampler(
                 m_scene,
-                get_child_and_inherit_globals(m_params, "light_sampler")));
+                get_child_and_inherit_globals(m_params, "light_sampler"),
+                &m_project.get_light_tree_cache()));
 
-        m_lighting_engine_factory.reset(
+        PTLightingEngineFactory* pt_factory =
             new PTLightingEngineFactory(
+                m_scene,
                 *m_backward_light_sampler,
                 m_project.get_light_path_recorder(),
-                get_child_and_inherit_globals(m_params, "pt")));    // todo: change to "pt_lighting_engine"?
+                get_child_and_inherit_globals(m_params, "pt"));     // todo: change to "pt_lighting_engine"?
+
+        m_lighting_engine_factory.reset(pt_factory);
+
+        // Train the path guiding structure between passes.
+        if (pt_factory->get_sd_tree() != nullptr)
+            m_pass_callback.reset(new PTPassCallback(*pt_factory->get_sd_tree()));
 
         return true;
     }
@@ -192,7 +202,8 @@ bool RendererComponents::create_lighting_engine_factory()
         m_backward_light_sampler.reset(
             new BackwardLightSampler(
                 m_scene,
-                get_child_and_inherit_globals(m_params, "light_sampler")));
+                get_child_and_inherit_globals(m_params, "light_sampler"),
+                &m_project.get_light_tree_cache()));
 
         const SPPMParameters sppm_params(
             get_child_and_inherit_globals(m_params, "sppm"));
@@ -247,6 +258,7 @@ bool RendererComponents::create_sample_renderer_factory()
                 m_shading_engine,
                 m_texture_system,
                 m_shading_system,
+                m_project.get_shader_group_profiler(),
                 get_child_and_inherit_globals(m_params, "generic_sample_renderer")));
         return true;
     }
@@ -2050,6 +2050,27 @@ Color3f process_background_tree(const OSL::ClosureColor* ci)
     return do_process_closure_id_tree(ci, BackgroundID);
 }
 
+size_t get_closure_tree_size(const OSL::ClosureColor* ci)
+{
+    if (ci == nullptr)
+        return 0;
+
+    switch (ci->id)
+    {
+      case OSL::ClosureColor::MUL:
+        return 1 + get_closure_tree_size(reinterpret_cast<const OSL::ClosureMul*>(ci)->closure);
+
+      case OSL::ClosureColor::ADD:
+        {
+            const OSL::ClosureAdd* c = reinterpret_cast<const OSL::ClosureAdd*>(ci);
+            return 1 + get_closure_tree_size(c->closureA) + get_closure_tree_size(c->closureB);
+        }
+
+      default:
+        return 1;
+    }
+}
+
 namespace
 {
     template <typename ClosureType>
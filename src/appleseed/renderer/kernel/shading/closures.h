@@ -316,6 +316,9 @@ void process_transparency_tree(const OSL::ClosureColor* ci, Alpha& alpha);
 float process_holdout_tree(const OSL::ClosureColor* ci);
 foundation::Color3f process_background_tree(const OSL::ClosureColor* ci);
 
+// Return the number of nodes in a closure tree.
+size_t get_closure_tree_size(const OSL::ClosureColor* ci);
+
 void register_closures(OSLShadingSystem& shading_system);
 
 
@@ -0,0 +1,80 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "oslshadergroupcache.h"
+
+using namespace std;
+
+namespace renderer
+{
+
+//
+// OSLShaderGroupCache class implementation.
+//
+
+OSL::ShaderGroupRef OSLShaderGroupCache::get(const string& key) const
+{
+    const ShaderGroupMap::const_iterator i = m_shader_groups.find(key);
+    return i != m_shader_groups.end() ? i->second : OSL::ShaderGroupRef();
+}
+
+void OSLShaderGroupCache::insert(const string& key, const OSL::ShaderGroupRef& shader_group_ref)
+{
+    m_shader_groups[key] = shader_group_ref;
+}
+
+size_t OSLShaderGroupCache::size() const
+{
+    return m_shader_groups.size();
+}
+
+size_t OSLShaderGroupCache::evict_unused()
+{
+    size_t evicted_count = 0;
+
+    for (ShaderGroupMap::iterator i = m_shader_groups.begin(); i != m_shader_groups.end(); )
+    {
+        if (i->second.use_count() <= 1)
+        {
+            i = m_shader_groups.erase(i);
+            ++evicted_count;
+        }
+        else ++i;
+    }
+
+    return evicted_count;
+}
+
+void OSLShaderGroupCache::clear()
+{
+    m_shader_groups.clear();
+}
+
+}   // namespace renderer
@@ -0,0 +1,93 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_KERNEL_SHADING_OSLSHADERGROUPCACHE_H
+#define APPLESEED_RENDERER_KERNEL_SHADING_OSLSHADERGROUPCACHE_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/shading/oslshadingsystem.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Boost headers.
+#include "boost/unordered/unordered_map.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+namespace renderer
+{
+
+//
+// A cache of OSL shader groups keyed on their serialized form, that is, on the
+// shaders they are made of, the values of their parameters and their connections.
+//
+// Shader groups that appear several times in a scene, or that are recreated
+// identically between two renders, share a single OSL shader group and are only
+// optimized once. OSL does not allow to save the code it generates, so the cache
+// is only valid as long as the shading system that created the groups.
+//
+// Shader groups of the scene hold references to the OSL shader groups they use.
+// An OSL shader group only referenced by the cache is no longer used by the scene
+// and is evicted by evict_unused(), which should be called after the shader groups
+// of the scene have been updated.
+//
+
+class OSLShaderGroupCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Return the shader group cached for a given serialized shader group,
+    // or an empty reference if there is none.
+    OSL::ShaderGroupRef get(const std::string& key) const;
+
+    // Cache a shader group.
+    void insert(const std::string& key, const OSL::ShaderGroupRef& shader_group_ref);
+
+    // Return the number of cached shader groups.
+    size_t size() const;
+
+    // Forget the shader groups that are only referenced by the cache.
+    // Return the number of shader groups that were forgotten.
+    size_t evict_unused();
+
+    // Forget all cached shader groups.
+    void clear();
+
+  private:
+    typedef boost::unordered_map<std::string, OSL::ShaderGroupRef> ShaderGroupMap;
+
+    ShaderGroupMap m_shader_groups;
+};
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_SHADING_OSLSHADERGROUPCACHE_H
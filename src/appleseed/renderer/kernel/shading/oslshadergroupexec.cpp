@@ -32,11 +32,15 @@
 // appleseed.renderer headers.
 #include "renderer/kernel/shading/closures.h"
 #include "renderer/kernel/shading/oslshadingsystem.h"
+#include "renderer/kernel/shading/shadergroupprofiler.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/modeling/bsdf/bsdf.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
 // Standard headers.
 #include <cassert>
 
@@ -49,9 +53,13 @@ namespace renderer
 // OSLShaderGroupExec class implementation.
 //
 
-OSLShaderGroupExec::OSLShaderGroupExec(OSLShadingSystem& shading_system, Arena& arena)
+OSLShaderGroupExec::OSLShaderGroupExec(
+    OSLShadingSystem&               shading_system,
+    Arena&                          arena,
+    ShaderGroupProfileStream*       profile_stream)
   : m_osl_shading_system(shading_system)
   , m_arena(arena)
+  , m_profile_stream(profile_stream)
   , m_osl_thread_info(shading_system.create_thread_info())
   , m_osl_shading_context(shading_system.get_context(m_osl_thread_info))
 {
@@ -176,10 +184,7 @@ Color3f OSLShaderGroupExec::execute_background(
     sg.renderer = m_osl_shading_system.renderer();
     sg.raytype = VisibilityFlags::CameraRay;
 
-    m_osl_shading_system.execute(
-        m_osl_shading_context,
-        *reinterpret_cast<OSL::ShaderGroup*>(shader_group.osl_shader_group()),
-        sg);
+    execute_and_profile(shader_group, sg);
 
     return process_background_tree(sg.Ci);
 }
@@ -197,10 +202,36 @@ void OSLShaderGroupExec::do_execute(
         ray_flags,
         m_osl_shading_system.renderer());
 
+    execute_and_profile(shader_group, shading_point.get_osl_shader_globals());
+}
+
+void OSLShaderGroupExec::execute_and_profile(
+    const ShaderGroup&              shader_group,
+    OSL::ShaderGlobals&             shader_globals) const
+{
+    if (m_profile_stream == nullptr)
+    {
+        m_osl_shading_system.execute(
+            m_osl_shading_context,
+            *reinterpret_cast<OSL::ShaderGroup*>(shader_group.osl_shader_group()),
+            shader_globals);
+        return;
+    }
+
+    ShaderGroupProfileTimer& timer = m_profile_stream->get_timer();
+    const uint64 start = timer.read_start();
+
     m_osl_shading_system.execute(
         m_osl_shading_context,
         *reinterpret_cast<OSL::ShaderGroup*>(shader_group.osl_shader_group()),
-        shading_point.get_osl_shader_globals());
+        shader_globals);
+
+    const uint64 end = timer.read_end();
+
+    m_profile_stream->record(
+        shader_group,
+        end - start,
+        get_closure_tree_size(shader_globals.Ci));
 }
 
 void OSLShaderGroupExec::choose_bsdf_closure_shading_basis(
@@ -48,6 +48,7 @@
 namespace foundation    { class Arena; }
 namespace renderer      { class OSLShadingSystem; }
 namespace renderer      { class ShaderGroup; }
+namespace renderer      { class ShaderGroupProfileStream; }
 namespace renderer      { class ShadingContext; }
 namespace renderer      { class ShadingPoint; }
 namespace renderer      { class Tracer; }
@@ -59,9 +60,11 @@ class OSLShaderGroupExec
   : public foundation::NonCopyable
 {
   public:
+    // Constructor. Shader group executions are recorded into profile_stream if it is not null.
     OSLShaderGroupExec(
         OSLShadingSystem&               shading_system,
-        foundation::Arena&              arena);
+        foundation::Arena&              arena,
+        ShaderGroupProfileStream*       profile_stream = nullptr);
 
     ~OSLShaderGroupExec();
 
@@ -71,6 +74,7 @@ class OSLShaderGroupExec
 
     OSLShadingSystem&                   m_osl_shading_system;
     foundation::Arena&                  m_arena;
+    ShaderGroupProfileStream*           m_profile_stream;
 
     OSL::PerThreadInfo*                 m_osl_thread_info;
     OSL::ShadingContext*                m_osl_shading_context;
@@ -115,6 +119,10 @@ class OSLShaderGroupExec
         const ShadingPoint&             shading_point,
         const VisibilityFlags::Type     ray_flags) const;
 
+    void execute_and_profile(
+        const ShaderGroup&              shader_group,
+        OSL::ShaderGlobals&             shader_globals) const;
+
     void choose_bsdf_closure_shading_basis(
         const ShadingPoint&             shading_point,
         const foundation::Vector2f&     s) const;
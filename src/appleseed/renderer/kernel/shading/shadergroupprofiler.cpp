@@ -0,0 +1,316 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Interface header.
+#include "shadergroupprofiler.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/thread.h"
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem/path.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace renderer
+{
+
+//
+// ShaderGroupProfile class implementation.
+//
+
+ShaderGroupProfile::ShaderGroupProfile()
+  : m_execution_count(0)
+  , m_cycle_count(0)
+  , m_closure_count(0)
+{
+}
+
+void ShaderGroupProfile::merge(const ShaderGroupProfile& other)
+{
+    m_execution_count += other.m_execution_count;
+    m_cycle_count += other.m_cycle_count;
+    m_closure_count += other.m_closure_count;
+}
+
+
+//
+// ShaderGroupProfileStream class implementation.
+//
+
+ShaderGroupProfileStream::ShaderGroupProfileStream(ShaderGroupProfileTimer& timer)
+  : m_timer(timer)
+  , m_last_shader_group(nullptr)
+  , m_last_profile(nullptr)
+{
+}
+
+void ShaderGroupProfileStream::clear()
+{
+    m_profiles.clear();
+    m_last_shader_group = nullptr;
+    m_last_profile = nullptr;
+}
+
+
+//
+// ShaderGroupProfiler class implementation.
+//
+
+namespace
+{
+    struct ProfiledShaderGroup
+    {
+        string              m_path;
+        ShaderGroupProfile  m_profile;
+    };
+
+    double average(const uint64 total, const uint64 count)
+    {
+        return count > 0 ? static_cast<double>(total) / count : 0.0;
+    }
+
+    string escape_json_string(const string& s)
+    {
+        string result;
+        result.reserve(s.size());
+
+        for (const char c : s)
+        {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            result += c;
+        }
+
+        return result;
+    }
+
+    string escape_csv_string(const string& s)
+    {
+        return "\"" + replace(s, "\"", "\"\"") + "\"";
+    }
+}
+
+struct ShaderGroupProfiler::Impl
+{
+    boost::mutex                                m_mutex;
+    unique_ptr<ShaderGroupProfileTimer>         m_timer;        // created on demand since calibration takes time
+    vector<unique_ptr<ShaderGroupProfileStream>> m_streams;
+    vector<ProfiledShaderGroup>                 m_shader_groups;
+    uint64                                      m_total_cycle_count;
+};
+
+ShaderGroupProfiler::ShaderGroupProfiler()
+  : impl(new Impl())
+{
+    impl->m_total_cycle_count = 0;
+}
+
+ShaderGroupProfiler::~ShaderGroupProfiler()
+{
+    delete impl;
+}
+
+void ShaderGroupProfiler::clear()
+{
+    for (auto& stream : impl->m_streams)
+        stream->clear();
+
+    impl->m_shader_groups.clear();
+    impl->m_total_cycle_count = 0;
+}
+
+void ShaderGroupProfiler::clear_streams()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    impl->m_streams.clear();
+}
+
+ShaderGroupProfileStream* ShaderGroupProfiler::create_stream()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    if (!impl->m_timer)
+        impl->m_timer.reset(new ShaderGroupProfileTimer());
+
+    auto stream = new ShaderGroupProfileStream(*impl->m_timer);
+    impl->m_streams.push_back(unique_ptr<ShaderGroupProfileStream>(stream));
+
+    return stream;
+}
+
+void ShaderGroupProfiler::finalize()
+{
+    // Merge the counters of all streams.
+    ShaderGroupProfileStream::ProfileMap profiles;
+    for (const auto& stream : impl->m_streams)
+    {
+        for (const auto& entry : stream->m_profiles)
+            profiles[entry.first].merge(entry.second);
+    }
+
+    impl->m_shader_groups.clear();
+    impl->m_shader_groups.reserve(profiles.size());
+    impl->m_total_cycle_count = 0;
+
+    for (const auto& entry : profiles)
+    {
+        ProfiledShaderGroup shader_group;
+        shader_group.m_path = entry.first->get_path().c_str();
+        shader_group.m_profile = entry.second;
+        impl->m_shader_groups.push_back(shader_group);
+        impl->m_total_cycle_count += entry.second.m_cycle_count;
+    }
+
+    // Sort shader groups by decreasing execution time.
+    sort(
+        impl->m_shader_groups.begin(),
+        impl->m_shader_groups.end(),
+        [](const ProfiledShaderGroup& lhs, const ProfiledShaderGroup& rhs)
+        {
+            return lhs.m_profile.m_cycle_count > rhs.m_profile.m_cycle_count;
+        });
+}
+
+size_t ShaderGroupProfiler::get_shader_group_count() const
+{
+    return impl->m_shader_groups.size();
+}
+
+const char* ShaderGroupProfiler::get_shader_group_path(const size_t index) const
+{
+    assert(index < impl->m_shader_groups.size());
+    return impl->m_shader_groups[index].m_path.c_str();
+}
+
+const ShaderGroupProfile& ShaderGroupProfiler::get_shader_group_profile(const size_t index) const
+{
+    assert(index < impl->m_shader_groups.size());
+    return impl->m_shader_groups[index].m_profile;
+}
+
+StatisticsVector ShaderGroupProfiler::get_statistics(const size_t max_shader_group_count) const
+{
+    const size_t shader_group_count = min(impl->m_shader_groups.size(), max_shader_group_count);
+
+    Statistics stats;
+    stats.insert("shader groups", static_cast<uint64>(impl->m_shader_groups.size()));
+
+    for (size_t i = 0; i < shader_group_count; ++i)
+    {
+        const ProfiledShaderGroup& shader_group = impl->m_shader_groups[i];
+        const ShaderGroupProfile& profile = shader_group.m_profile;
+
+        stats.insert<string>(
+            shader_group.m_path,
+            pretty_percent(profile.m_cycle_count, impl->m_total_cycle_count) + " of cycles, " +
+            pretty_uint(profile.m_execution_count) + " " + plural(profile.m_execution_count, "execution") + ", " +
+            pretty_scalar(average(profile.m_cycle_count, profile.m_execution_count), 0) + " cycles/execution, " +
+            pretty_scalar(average(profile.m_closure_count, profile.m_execution_count)) + " closures/execution");
+    }
+
+    return StatisticsVector::make("shader group profiling statistics", stats);
+}
+
+bool ShaderGroupProfiler::write(const char* filename) const
+{
+    const bool json = lower_case(bf::path(filename).extension().string()) == ".json";
+
+    RENDERER_LOG_INFO("writing shader group profile to %s...", filename);
+
+    ofstream file(filename);
+    if (!file.is_open())
+    {
+        RENDERER_LOG_ERROR("failed to open %s for writing.", filename);
+        return false;
+    }
+
+    if (json)
+    {
+        file << "[\n";
+
+        for (size_t i = 0, e = impl->m_shader_groups.size(); i < e; ++i)
+        {
+            const ProfiledShaderGroup& shader_group = impl->m_shader_groups[i];
+            const ShaderGroupProfile& profile = shader_group.m_profile;
+
+            file << "    { "
+                 << "\"shader_group\": \"" << escape_json_string(shader_group.m_path) << "\", "
+                 << "\"executions\": " << profile.m_execution_count << ", "
+                 << "\"cycles\": " << profile.m_cycle_count << ", "
+                 << "\"closures\": " << profile.m_closure_count << " }"
+                 << (i + 1 < e ? ",\n" : "\n");
+        }
+
+        file << "]\n";
+    }
+    else
+    {
+        file << "shader_group,executions,cycles,closures\n";
+
+        for (const auto& shader_group : impl->m_shader_groups)
+        {
+            const ShaderGroupProfile& profile = shader_group.m_profile;
+
+            file << escape_csv_string(shader_group.m_path) << ","
+                 << profile.m_execution_count << ","
+                 << profile.m_cycle_count << ","
+                 << profile.m_closure_count << "\n";
+        }
+    }
+
+    file.close();
+
+    if (file.fail())
+    {
+        RENDERER_LOG_ERROR("failed to write %s.", filename);
+        return false;
+    }
+
+    return true;
+}
+
+}   // namespace renderer
@@ -0,0 +1,197 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#ifndef APPLESEED_RENDERER_KERNEL_SHADING_SHADERGROUPPROFILER_H
+#define APPLESEED_RENDERER_KERNEL_SHADING_SHADERGROUPPROFILER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/statistics.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Boost headers.
+#include "boost/unordered/unordered_map.hpp"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace renderer  { class ShaderGroup; }
+
+namespace renderer
+{
+
+//
+// Timer used to measure shader group executions.
+//
+
+#ifdef APPLESEED_X86
+typedef foundation::X86Timer ShaderGroupProfileTimer;
+#else
+typedef foundation::DefaultProcessorTimer ShaderGroupProfileTimer;
+#endif
+
+
+//
+// Execution counters of a shader group.
+//
+
+struct ShaderGroupProfile
+{
+    foundation::uint64  m_execution_count;
+    foundation::uint64  m_cycle_count;          // time spent executing the shader group, in timer ticks (cycles on x86)
+    foundation::uint64  m_closure_count;        // number of closure tree nodes, summed over all executions
+
+    ShaderGroupProfile();
+
+    void merge(const ShaderGroupProfile& other);
+};
+
+
+//
+// This class allows a single thread to collect shader group execution counters.
+//
+
+class ShaderGroupProfileStream
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    explicit ShaderGroupProfileStream(ShaderGroupProfileTimer& timer);
+
+    // Access the timer shared by all streams of the profiler.
+    ShaderGroupProfileTimer& get_timer() const;
+
+    // Record one execution of a shader group.
+    void record(
+        const ShaderGroup&          shader_group,
+        const foundation::uint64    cycle_count,
+        const size_t                closure_count);
+
+    // Discard all counters.
+    void clear();
+
+  private:
+    friend class ShaderGroupProfiler;
+
+    typedef boost::unordered_map<const ShaderGroup*, ShaderGroupProfile> ProfileMap;
+
+    ShaderGroupProfileTimer&        m_timer;
+    ProfileMap                      m_profiles;
+
+    // Shader groups tend to be executed several times in a row.
+    const ShaderGroup*              m_last_shader_group;
+    ShaderGroupProfile*             m_last_profile;
+};
+
+
+//
+// This class allows to
+//   - create per-thread streams to collect shader group execution counters
+//   - merge these counters at the end of a render
+//   - print them and write them to disk
+//
+
+class APPLESEED_DLLSYMBOL ShaderGroupProfiler
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    ShaderGroupProfiler();
+
+    // Destructor.
+    ~ShaderGroupProfiler();
+
+    // Clear all streams (but don't discard the streams themselves).
+    void clear();
+
+    // Discard all streams. None of them may be in use.
+    void clear_streams();
+
+    // Create a new stream.
+    // Thread-safe. Returns a non-owning pointer.
+    ShaderGroupProfileStream* create_stream();
+
+    // Merge the counters of all streams and sort shader groups by decreasing execution time.
+    void finalize();
+
+    // Return the number of profiled shader groups. `finalize()` must have been called.
+    size_t get_shader_group_count() const;
+
+    // Return the path of a profiled shader group. `finalize()` must have been called.
+    const char* get_shader_group_path(const size_t index) const;
+
+    // Return the counters of a profiled shader group. `finalize()` must have been called.
+    const ShaderGroupProfile& get_shader_group_profile(const size_t index) const;
+
+    // Retrieve statistics for the most expensive shader groups. `finalize()` must have been called.
+    foundation::StatisticsVector get_statistics(const size_t max_shader_group_count = 20) const;
+
+    // Write the counters of all shader groups to disk, in JSON format if the file
+    // extension is .json or in CSV format otherwise. `finalize()` must have been called.
+    bool write(const char* filename) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+
+//
+// ShaderGroupProfileStream class implementation.
+//
+
+inline ShaderGroupProfileTimer& ShaderGroupProfileStream::get_timer() const
+{
+    return m_timer;
+}
+
+inline void ShaderGroupProfileStream::record(
+    const ShaderGroup&              shader_group,
+    const foundation::uint64        cycle_count,
+    const size_t                    closure_count)
+{
+    if (&shader_group != m_last_shader_group)
+    {
+        m_last_shader_group = &shader_group;
+        m_last_profile = &m_profiles[&shader_group];
+    }
+
+    ++m_last_profile->m_execution_count;
+    m_last_profile->m_cycle_count += cycle_count;
+    m_last_profile->m_closure_count += closure_count;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_SHADING_SHADERGROUPPROFILER_H
@@ -86,6 +86,7 @@ class StaticTessellation
     // Insert and access texture coordinates.
     void reserve_tex_coords(const size_t count);
     size_t push_tex_coords(const GVector2& uv);
+    size_t push_tex_coords(const GVector2* uvs, const size_t count);
     size_t get_tex_coords_count() const;
     GVector2 get_tex_coords(const size_t index) const;
 
@@ -205,6 +206,15 @@ inline size_t StaticTessellation<Primitive>::push_tex_coords(const GVector2& uv)
     return m_vertex_attributes.push_attribute(m_uv_0_cid, uv);
 }
 
+template <typename Primitive>
+inline size_t StaticTessellation<Primitive>::push_tex_coords(const GVector2* uvs, const size_t count)
+{
+    if (m_uv_0_cid == foundation::AttributeSet::InvalidChannelID)
+        create_uv_0_attribute();
+
+    return m_vertex_attributes.push_attributes(m_uv_0_cid, uvs, count);
+}
+
 template <typename Primitive>
 inline size_t StaticTessellation<Primitive>::get_tex_coords_count() const
 {
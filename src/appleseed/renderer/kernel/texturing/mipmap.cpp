@@ -0,0 +1,111 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "mipmap.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+Tile* generate_mip_tile(
+    const CanvasProperties& parent_props,
+    const CanvasProperties& level_props,
+    const size_t            tile_x,
+    const size_t            tile_y,
+    const Tile*             parent_tiles[2][2])
+{
+    assert(tile_x < level_props.m_tile_count_x);
+    assert(tile_y < level_props.m_tile_count_y);
+    assert(parent_tiles[0][0]);
+
+    const size_t channel_count = parent_tiles[0][0]->get_channel_count();
+    assert(channel_count <= 4);
+
+    const size_t tile_width = level_props.get_tile_width(tile_x);
+    const size_t tile_height = level_props.get_tile_height(tile_y);
+
+    Tile* tile = new Tile(tile_width, tile_height, channel_count, PixelFormatFloat);
+
+    const size_t origin_x = tile_x * level_props.m_tile_width;
+    const size_t origin_y = tile_y * level_props.m_tile_height;
+    const size_t parent_origin_x = 2 * tile_x * parent_props.m_tile_width;
+    const size_t parent_origin_y = 2 * tile_y * parent_props.m_tile_height;
+    const size_t parent_max_x = parent_props.m_canvas_width - 1;
+    const size_t parent_max_y = parent_props.m_canvas_height - 1;
+
+    for (size_t y = 0; y < tile_height; ++y)
+    {
+        for (size_t x = 0; x < tile_width; ++x)
+        {
+            float result[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+            // Average the 2x2 corresponding pixels of the parent level.
+            for (size_t j = 0; j < 2; ++j)
+            {
+                const size_t py = min(2 * (origin_y + y) + j, parent_max_y) - parent_origin_y;
+                const size_t ty = py / parent_props.m_tile_height;
+
+                for (size_t i = 0; i < 2; ++i)
+                {
+                    const size_t px = min(2 * (origin_x + x) + i, parent_max_x) - parent_origin_x;
+                    const size_t tx = px / parent_props.m_tile_width;
+
+                    const Tile* parent_tile = parent_tiles[ty][tx];
+                    assert(parent_tile);
+
+                    float values[4];
+                    parent_tile->get_pixel<float>(
+                        px - tx * parent_props.m_tile_width,
+                        py - ty * parent_props.m_tile_height,
+                        values);
+
+                    for (size_t c = 0; c < channel_count; ++c)
+                        result[c] += values[c];
+                }
+            }
+
+            for (size_t c = 0; c < channel_count; ++c)
+                result[c] *= 0.25f;
+
+            tile->set_pixel<float>(x, y, result);
+        }
+    }
+
+    return tile;
+}
+
+}   // namespace renderer
@@ -0,0 +1,110 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_RENDERER_KERNEL_TEXTURING_MIPMAP_H
+#define APPLESEED_RENDERER_KERNEL_TEXTURING_MIPMAP_H
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class Tile; }
+
+namespace renderer
+{
+
+//
+// Mipmap levels of tiled textures.
+//
+// Level 0 is the texture itself. Level n + 1 has half the resolution of level n
+// (rounded down, but never less than one pixel) and uses the same tile size,
+// so that each tile of level n + 1 is computed from at most 2x2 tiles of level n.
+//
+
+// Maximum number of mipmap levels of a texture, including the base level.
+const size_t MaxMipLevelCount = 16;
+
+// Return the number of mipmap levels of a texture, including the base level.
+size_t get_mip_level_count(const foundation::CanvasProperties& base_props);
+
+// Return the properties of a given mipmap level of a texture.
+foundation::CanvasProperties get_mip_level_properties(
+    const foundation::CanvasProperties& base_props,
+    const size_t                        level);
+
+// Compute a tile of a mipmap level by box-filtering the 2x2 corresponding tiles
+// of the previous (finer) level. parent_tiles[j][i] is the tile (2 * tile_x + i,
+// 2 * tile_y + j) of the previous level and may be null if it lies outside of the
+// canvas. The returned tile stores 32-bit floating point pixels and must be deleted
+// by the caller.
+foundation::Tile* generate_mip_tile(
+    const foundation::CanvasProperties& parent_props,
+    const foundation::CanvasProperties& level_props,
+    const size_t                        tile_x,
+    const size_t                        tile_y,
+    const foundation::Tile*             parent_tiles[2][2]);
+
+
+//
+// Implementation.
+//
+
+inline size_t get_mip_level_count(const foundation::CanvasProperties& base_props)
+{
+    size_t level_count = 1;
+    size_t size = std::max(base_props.m_canvas_width, base_props.m_canvas_height);
+
+    while (size > 1 && level_count < MaxMipLevelCount)
+    {
+        size /= 2;
+        ++level_count;
+    }
+
+    return level_count;
+}
+
+inline foundation::CanvasProperties get_mip_level_properties(
+    const foundation::CanvasProperties& base_props,
+    const size_t                        level)
+{
+    return
+        foundation::CanvasProperties(
+            std::max<size_t>(base_props.m_canvas_width >> level, 1),
+            std::max<size_t>(base_props.m_canvas_height >> level, 1),
+            base_props.m_tile_width,
+            base_props.m_tile_height,
+            base_props.m_channel_count,
+            base_props.m_pixel_format);
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_TEXTURING_MIPMAP_H
@@ -38,9 +38,11 @@
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/tile.h"
+#include "foundation/math/scalar.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
@@ -65,16 +67,63 @@ namespace renderer
 TextureStore::TextureStore(
     const Scene&        scene,
     const ParamArray&   params)
-  : m_tile_swapper(scene, params)
-  , m_tile_cache(m_tile_key_hasher, m_tile_swapper)
+  : m_tile_swapper(*this, scene, params)
+  , m_next_trimmed_shard(0)
+  , m_cross_shard_unload_count(0)
 {
+    const size_t shard_count =
+        next_pow2(
+            max<size_t>(
+                params.get_optional<size_t>("shard_count", get_default_shard_count()),
+                1));
+
+    // Each mipmap level has four times fewer tiles than the previous one.
+    size_t total_shard_count = 0;
+    for (size_t level = 0; level < MaxMipLevelCount; ++level)
+    {
+        const size_t level_shard_count = max<size_t>(shard_count >> (2 * level), 1);
+        m_shard_levels[level].m_first_shard = total_shard_count;
+        m_shard_levels[level].m_shard_mask = level_shard_count - 1;
+        total_shard_count += level_shard_count;
+    }
+
+    m_shards.reserve(total_shard_count);
+
+    for (size_t i = 0; i < total_shard_count; ++i)
+        m_shards.emplace_back(new Shard(m_tile_key_hasher, m_tile_swapper));
 }
 
 StatisticsVector TextureStore::get_statistics() const
 {
-    Statistics stats = make_single_stage_cache_stats(m_tile_cache);
+    uint64 hit_count = 0;
+    uint64 miss_count = 0;
+    uint64 contention_count = 0;
+
+    for (const_each<vector<unique_ptr<Shard>>> i = m_shards; i; ++i)
+    {
+        const Shard& shard = **i;
+        hit_count += shard.m_tile_cache.get_hit_count();
+        miss_count += shard.m_tile_cache.get_miss_count();
+        contention_count += shard.m_contention_count;
+    }
+
+    Statistics stats;
+    stats.insert(
+        unique_ptr<cache_impl::CacheStatisticsEntry>(
+            new cache_impl::CacheStatisticsEntry(
+                "performances",
+                hit_count,
+                miss_count)));
+    stats.insert("shards", m_shards.size());
+    stats.insert_percent("contention", contention_count, hit_count + miss_count);
+    stats.insert("cross-shard unloads", m_cross_shard_unload_count.load());
     stats.insert_size("peak size", m_tile_swapper.get_peak_memory_size());
 
+    // The limit is exceeded while tiles in use cannot be unloaded.
+    const size_t peak_memory_size = m_tile_swapper.get_peak_memory_size();
+    const size_t memory_limit = m_tile_swapper.get_memory_limit();
+    stats.insert_size("peak overshoot", peak_memory_size > memory_limit ? peak_memory_size - memory_limit : 0);
+
     return StatisticsVector::make("texture store statistics", stats);
 }
 
@@ -83,6 +132,11 @@ size_t TextureStore::get_default_size()
     return 1024 * 1024 * 1024;
 }
 
+size_t TextureStore::get_default_shard_count()
+{
+    return 64;
+}
+
 Dictionary TextureStore::get_params_metadata()
 {
     Dictionary metadata;
@@ -93,10 +147,38 @@ Dictionary TextureStore::get_params_metadata()
             .insert("default", get_default_size())
             .insert("label", "Texture Cache Size")
             .insert("help", "Texture cache size in bytes"));
+    metadata.dictionaries().insert(
+        "shard_count",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", get_default_shard_count())
+            .insert("label", "Texture Cache Shards")
+            .insert("help", "Number of independently locked parts of the texture cache, rounded up to a power of two"));
 
     return metadata;
 }
 
+void TextureStore::trim_shards(const Shard& origin)
+{
+    // Shards are only tried, never waited on, since this thread may already
+    // hold other shards while it generates mipmap tiles.
+    const size_t shard_count = m_shards.size();
+    const size_t first_shard = m_next_trimmed_shard++;
+
+    for (size_t i = 0; i < shard_count && m_tile_swapper.is_full(0); ++i)
+    {
+        Shard& shard = *m_shards[(first_shard + i) % shard_count];
+
+        if (&shard == &origin)
+            continue;
+
+        boost::mutex::scoped_lock lock(shard.m_mutex, boost::try_to_lock);
+
+        if (lock.owns_lock())
+            m_cross_shard_unload_count += shard.m_tile_cache.trim();
+    }
+}
+
 
 //
 // TextureStore::TileSwapper class implementation.
@@ -164,9 +246,11 @@ namespace
 }
 
 TextureStore::TileSwapper::TileSwapper(
+    TextureStore&       store,
     const Scene&        scene,
     const ParamArray&   params)
-  : m_scene(scene)
+  : m_store(store)
+  , m_scene(scene)
   , m_params(params)
   , m_memory_size(0)
   , m_peak_memory_size(0)
@@ -176,67 +260,76 @@ TextureStore::TileSwapper::TileSwapper(
 
 void TextureStore::TileSwapper::load(const TileKey& key, TileRecord& record)
 {
-    // Fetch the texture container.
-    const TextureContainer& textures =
-        key.m_assembly_uid == UniqueID(~0)
-            ? m_scene.textures()
-            : m_assemblies[key.m_assembly_uid]->textures();
-
     // Fetch the texture.
-    Texture* texture = textures.get_by_uid(key.m_texture_uid);
+    Texture* texture = get_texture(key);
 
     if (m_params.m_track_tile_loading)
     {
         RENDERER_LOG_DEBUG(
-            "loading tile (" FMT_SIZE_T ", " FMT_SIZE_T ") "
+            "loading tile (" FMT_SIZE_T ", " FMT_SIZE_T ") of level " FMT_SIZE_T " "
             "from texture \"%s\"...",
             key.get_tile_x(),
             key.get_tile_y(),
+            key.get_level(),
             texture->get_path().c_str());
     }
 
-    // Load the tile.
-    record.m_tile = texture->load_tile(key.get_tile_x(), key.get_tile_y());
     record.m_owners = 0;
 
-    // Convert the tile to the linear RGB color space.
-    switch (texture->get_color_space())
+    if (key.get_level() > 0)
     {
-      case ColorSpaceLinearRGB:
-        break;
+        // Generate the tile. Tiles of the previous level are already in the linear RGB color space.
+        record.m_tile = generate_mip_tile(key, *texture);
+    }
+    else
+    {
+        // Load the tile.
+        record.m_tile = texture->load_tile(key.get_tile_x(), key.get_tile_y());
 
-      case ColorSpaceSRGB:
-        convert_tile_srgb_to_linear_rgb(*record.m_tile);
-        break;
+        // Convert the tile to the linear RGB color space.
+        switch (texture->get_color_space())
+        {
+          case ColorSpaceLinearRGB:
+            break;
 
-      case ColorSpaceCIEXYZ:
-        convert_tile_ciexyz_to_linear_rgb(*record.m_tile);
-        break;
+          case ColorSpaceSRGB:
+            convert_tile_srgb_to_linear_rgb(*record.m_tile);
+            break;
 
-      assert_otherwise;
+          case ColorSpaceCIEXYZ:
+            convert_tile_ciexyz_to_linear_rgb(*record.m_tile);
+            break;
+
+          assert_otherwise;
+        }
     }
 
-    // Track the amount of memory used by the tile cache.
-    m_memory_size += record.m_tile->get_memory_size();
-    m_peak_memory_size = max(m_peak_memory_size, m_memory_size);
+    // Track the amount of memory used by the tile cache (shared by all shards).
+    const size_t memory_size = m_memory_size += record.m_tile->get_memory_size();
+    size_t peak_memory_size = m_peak_memory_size;
+    while (peak_memory_size < memory_size)
+    {
+        if (m_peak_memory_size.compare_exchange_weak(peak_memory_size, memory_size))
+            break;
+    }
 
     if (m_params.m_track_store_size)
     {
-        if (m_memory_size > m_params.m_memory_limit)
+        if (memory_size > m_params.m_memory_limit)
         {
             RENDERER_LOG_DEBUG(
                 "texture store size is %s, exceeding capacity %s by %s",
-                pretty_size(m_memory_size).c_str(),
+                pretty_size(memory_size).c_str(),
                 pretty_size(m_params.m_memory_limit).c_str(),
-                pretty_size(m_memory_size - m_params.m_memory_limit).c_str());
+                pretty_size(memory_size - m_params.m_memory_limit).c_str());
         }
         else
         {
             RENDERER_LOG_DEBUG(
                 "texture store size is %s, below capacity %s by %s",
-                pretty_size(m_memory_size).c_str(),
+                pretty_size(memory_size).c_str(),
                 pretty_size(m_params.m_memory_limit).c_str(),
-                pretty_size(m_params.m_memory_limit - m_memory_size).c_str());
+                pretty_size(m_params.m_memory_limit - memory_size).c_str());
         }
     }
 }
@@ -252,27 +345,24 @@ bool TextureStore::TileSwapper::unload(const TileKey& key, TileRecord& record)
     assert(m_memory_size >= tile_memory_size);
     m_memory_size -= tile_memory_size;
 
-    // Fetch the texture container.
-    const TextureContainer& textures =
-        key.m_assembly_uid == UniqueID(~0)
-            ? m_scene.textures()
-            : m_assemblies[key.m_assembly_uid]->textures();
-
     // Fetch the texture.
-    Texture* texture = textures.get_by_uid(key.m_texture_uid);
+    Texture* texture = get_texture(key);
 
     if (m_params.m_track_tile_unloading)
     {
         RENDERER_LOG_DEBUG(
-            "unloading tile (" FMT_SIZE_T ", " FMT_SIZE_T ") "
+            "unloading tile (" FMT_SIZE_T ", " FMT_SIZE_T ") of level " FMT_SIZE_T " "
             "from texture \"%s\"...",
             key.get_tile_x(),
             key.get_tile_y(),
+            key.get_level(),
             texture->get_path().c_str());
     }
 
-    // Unload the tile.
-    texture->unload_tile(key.get_tile_x(), key.get_tile_y(), record.m_tile);
+    // Unload the tile. Tiles of mipmap levels are owned by the store.
+    if (key.get_level() > 0)
+        delete record.m_tile;
+    else texture->unload_tile(key.get_tile_x(), key.get_tile_y(), record.m_tile);
 
     // Successfully unloaded the tile.
     return true;
@@ -287,6 +377,89 @@ void TextureStore::TileSwapper::gather_assemblies(const AssemblyContainer& assem
     }
 }
 
+Texture* TextureStore::TileSwapper::get_texture(const TileKey& key) const
+{
+    // Fetch the texture container. The assembly map is only read here since
+    // tiles may be loaded and unloaded concurrently by different shards.
+    const TextureContainer& textures =
+        key.m_assembly_uid == UniqueID(~0)
+            ? m_scene.textures()
+            : m_assemblies.find(key.m_assembly_uid)->second->textures();
+
+    // Fetch the texture.
+    return textures.get_by_uid(key.m_texture_uid);
+}
+
+Tile* TextureStore::TileSwapper::generate_mip_tile(const TileKey& key, Texture& texture)
+{
+    const size_t level = key.get_level();
+    const size_t tile_x = key.get_tile_x();
+    const size_t tile_y = key.get_tile_y();
+    assert(level > 0);
+
+    const CanvasProperties& base_props = texture.properties();
+    const CanvasProperties parent_props = get_mip_level_properties(base_props, level - 1);
+    const CanvasProperties level_props = get_mip_level_properties(base_props, level);
+
+    // Acquire the corresponding tiles of the previous level.
+    TileRecord* parent_records[2][2];
+    const Tile* parent_tiles[2][2];
+    for (size_t j = 0; j < 2; ++j)
+    {
+        for (size_t i = 0; i < 2; ++i)
+        {
+            const size_t parent_x = 2 * tile_x + i;
+            const size_t parent_y = 2 * tile_y + j;
+
+            if (parent_x < parent_props.m_tile_count_x && parent_y < parent_props.m_tile_count_y)
+            {
+                parent_records[j][i] =
+                    &m_store.acquire(
+                        TileKey(key.m_assembly_uid, key.m_texture_uid, parent_x, parent_y, level - 1));
+                parent_tiles[j][i] = parent_records[j][i]->m_tile;
+            }
+            else
+            {
+                parent_records[j][i] = nullptr;
+                parent_tiles[j][i] = nullptr;
+            }
+        }
+    }
+
+    Tile* tile =
+        renderer::generate_mip_tile(
+            parent_props,
+            level_props,
+            tile_x,
+            tile_y,
+            parent_tiles);
+
+    // Release the tiles of the previous level.
+    for (size_t j = 0; j < 2; ++j)
+    {
+        for (size_t i = 0; i < 2; ++i)
+        {
+            if (parent_records[j][i])
+                m_store.release(*parent_records[j][i]);
+        }
+    }
+
+    return tile;
+}
+
+
+//
+// TextureStore::Shard class implementation.
+//
+
+TextureStore::Shard::Shard(
+    TileKeyHasher&      tile_key_hasher,
+    TileSwapper&        tile_swapper)
+  : m_tile_cache(tile_key_hasher, tile_swapper)
+  , m_contention_count(0)
+{
+}
+
 
 //
 // TextureStore::TileSwapper::Parameters class implementation.
@@ -31,6 +31,7 @@
 #define APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTURESTORE_H
 
 // appleseed.renderer headers.
+#include "renderer/kernel/texturing/mipmap.h"
 #include "renderer/modeling/scene/containers.h"
 
 // appleseed.foundation headers.
@@ -46,6 +47,8 @@
 #include <cassert>
 #include <cstddef>
 #include <map>
+#include <memory>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class Dictionary; }
@@ -60,6 +63,16 @@ namespace renderer
 //
 // A shared store for texture tiles (the backend of the thread-local texture cache).
 //
+// Tiles are distributed over a number of independently locked shards according
+// to the hash of their key, so that render threads missing their thread-local
+// texture cache rarely compete for the same lock. Memory usage is tracked and
+// limited globally: when a shard cannot bring the store back under its memory
+// limit by itself, tiles are unloaded from the other shards that are not busy.
+//
+// Tiles of mipmap levels are generated on demand from the tiles of the previous
+// level, which are themselves fetched from the store. Each level has its own set
+// of shards: since a level only ever waits on finer levels, this cannot deadlock.
+//
 
 class TextureStore
   : public foundation::NonCopyable
@@ -71,6 +84,7 @@ class TextureStore
         foundation::UniqueID    m_assembly_uid;
         foundation::UniqueID    m_texture_uid;
         foundation::uint32      m_tile_xy;
+        foundation::uint32      m_level;            // mipmap level, 0 for the texture itself
 
         TileKey();
 
@@ -78,7 +92,8 @@ class TextureStore
             const foundation::UniqueID  assembly_uid,
             const foundation::UniqueID  texture_uid,
             const size_t                tile_x,
-            const size_t                tile_y);
+            const size_t                tile_y,
+            const size_t                level = 0);
 
         TileKey(
             const foundation::UniqueID  assembly_uid,
@@ -89,6 +104,7 @@ class TextureStore
 
         size_t get_tile_x() const;
         size_t get_tile_y() const;
+        size_t get_level() const;
 
         // Return an invalid key.
         static TileKey invalid();
@@ -122,6 +138,9 @@ class TextureStore
     // Return the default texture store size in bytes.
     static size_t get_default_size();
 
+    // Return the default number of shards.
+    static size_t get_default_shard_count();
+
     // Return the metadata of the texture store parameters.
     static foundation::Dictionary get_params_metadata();
 
@@ -137,6 +156,7 @@ class TextureStore
       public:
         // Constructor.
         TileSwapper(
+            TextureStore&       store,
             const Scene&        scene,
             const ParamArray&   params);
 
@@ -152,6 +172,9 @@ class TextureStore
         // Return the peak memory size in bytes of the tile cache.
         size_t get_peak_memory_size() const;
 
+        // Return the maximum memory size in bytes of the tile cache.
+        size_t get_memory_limit() const;
+
       private:
         struct Parameters
         {
@@ -165,13 +188,19 @@ class TextureStore
 
         typedef std::map<foundation::UniqueID, const Assembly*> AssemblyMap;
 
-        const Scene&        m_scene;
-        const Parameters    m_params;
-        size_t              m_memory_size;
-        size_t              m_peak_memory_size;
-        AssemblyMap         m_assemblies;
+        TextureStore&               m_store;
+        const Scene&                m_scene;
+        const Parameters            m_params;
+        boost::atomic<size_t>       m_memory_size;
+        boost::atomic<size_t>       m_peak_memory_size;
+        AssemblyMap                 m_assemblies;
 
         void gather_assemblies(const AssemblyContainer& assemblies);
+
+        Texture* get_texture(const TileKey& key) const;
+
+        // Compute a tile of a mipmap level from tiles of the previous level.
+        foundation::Tile* generate_mip_tile(const TileKey& key, Texture& texture);
     };
 
     typedef foundation::LRUCache<
@@ -181,10 +210,35 @@ class TextureStore
         TileSwapper
     > TileCache;
 
-    boost::mutex            m_mutex;
-    TileKeyHasher           m_tile_key_hasher;
-    TileSwapper             m_tile_swapper;
-    TileCache               m_tile_cache;
+    struct Shard
+      : public foundation::NonCopyable
+    {
+        boost::mutex                m_mutex;
+        TileCache                   m_tile_cache;
+        foundation::uint64          m_contention_count;
+
+        Shard(
+            TileKeyHasher&          tile_key_hasher,
+            TileSwapper&            tile_swapper);
+    };
+
+    struct ShardLevel
+    {
+        size_t                      m_first_shard;
+        size_t                      m_shard_mask;
+    };
+
+    TileKeyHasher                   m_tile_key_hasher;
+    TileSwapper                     m_tile_swapper;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    ShardLevel                      m_shard_levels[MaxMipLevelCount];
+    boost::atomic<size_t>           m_next_trimmed_shard;
+    boost::atomic<foundation::uint64> m_cross_shard_unload_count;
+
+    Shard& get_shard(const TileKey& key);
+
+    // Unload tiles from shards other than `origin` until the store fits in its memory limit.
+    void trim_shards(const Shard& origin);
 };
 
 
@@ -194,12 +248,31 @@ class TextureStore
 
 inline TextureStore::TileRecord& TextureStore::acquire(const TileKey& key)
 {
-    boost::mutex::scoped_lock lock(m_mutex);
+    Shard& shard = get_shard(key);
+    TileRecord* record;
+    bool miss;
 
-    TileRecord& record = m_tile_cache.get(key);
-    foundation::atomic_inc(&record.m_owners);
+    {
+        boost::mutex::scoped_lock lock(shard.m_mutex, boost::try_to_lock);
 
-    return record;
+        if (!lock.owns_lock())
+        {
+            // Another thread holds this shard: wait for it.
+            lock.lock();
+            ++shard.m_contention_count;
+        }
+
+        const foundation::uint64 miss_count = shard.m_tile_cache.get_miss_count();
+        record = &shard.m_tile_cache.get(key);
+        foundation::atomic_inc(&record->m_owners);
+        miss = shard.m_tile_cache.get_miss_count() != miss_count;
+    }
+
+    // The shard only unloads its own tiles: honor the global memory limit.
+    if (miss && m_tile_swapper.is_full(0))
+        trim_shards(shard);
+
+    return *record;
 }
 
 inline void TextureStore::release(TileRecord& record) const
@@ -208,6 +281,17 @@ inline void TextureStore::release(TileRecord& record) const
     foundation::atomic_dec(&record.m_owners);
 }
 
+inline TextureStore::Shard& TextureStore::get_shard(const TileKey& key)
+{
+    assert(key.m_level < MaxMipLevelCount);
+    const ShardLevel& shard_level = m_shard_levels[key.m_level];
+
+    // Use the high bits of the hash since the low bits drive the shard's own index.
+    const foundation::uint64 h =
+        foundation::mix_uint64(key.m_assembly_uid, key.m_texture_uid, key.m_tile_xy);
+    return *m_shards[shard_level.m_first_shard + (static_cast<size_t>(h >> 32) & shard_level.m_shard_mask)];
+}
+
 
 //
 // TextureStore::TileKey class implementation.
@@ -221,13 +305,16 @@ inline TextureStore::TileKey::TileKey(
     const foundation::UniqueID  assembly_uid,
     const foundation::UniqueID  texture_uid,
     const size_t                tile_x,
-    const size_t                tile_y)
+    const size_t                tile_y,
+    const size_t                level)
   : m_assembly_uid(assembly_uid)
   , m_texture_uid(texture_uid)
   , m_tile_xy(static_cast<foundation::uint32>((tile_y << 16) | tile_x))
+  , m_level(static_cast<foundation::uint32>(level))
 {
     assert(tile_x < (1UL << 16));
     assert(tile_y < (1UL << 16));
+    assert(level < MaxMipLevelCount);
 }
 
 inline TextureStore::TileKey::TileKey(
@@ -237,6 +324,7 @@ inline TextureStore::TileKey::TileKey(
   : m_assembly_uid(assembly_uid)
   , m_texture_uid(texture_uid)
   , m_tile_xy(tile_xy)
+  , m_level(0)
 {
 }
 
@@ -244,6 +332,7 @@ inline TextureStore::TileKey::TileKey(const TileKey& rhs)
   : m_assembly_uid(rhs.m_assembly_uid)
   , m_texture_uid(rhs.m_texture_uid)
   , m_tile_xy(rhs.m_tile_xy)
+  , m_level(rhs.m_level)
 {
 }
 
@@ -257,6 +346,11 @@ inline size_t TextureStore::TileKey::get_tile_y() const
     return static_cast<size_t>(m_tile_xy >> 16);
 }
 
+inline size_t TextureStore::TileKey::get_level() const
+{
+    return static_cast<size_t>(m_level);
+}
+
 inline TextureStore::TileKey TextureStore::TileKey::invalid()
 {
     return TileKey(~0, ~0, ~0);
@@ -266,6 +360,7 @@ inline bool TextureStore::TileKey::operator==(const TileKey& rhs) const
 {
     return
         m_tile_xy == rhs.m_tile_xy &&
+        m_level == rhs.m_level &&
         m_texture_uid == rhs.m_texture_uid &&
         m_assembly_uid == rhs.m_assembly_uid;
 }
@@ -280,7 +375,9 @@ inline bool TextureStore::TileKey::operator<(const TileKey& rhs) const
     return
         m_assembly_uid == rhs.m_assembly_uid ?
             m_texture_uid == rhs.m_texture_uid ?
-                m_tile_xy < rhs.m_tile_xy :
+                m_level == rhs.m_level ?
+                    m_tile_xy < rhs.m_tile_xy :
+                m_level < rhs.m_level :
             m_texture_uid < rhs.m_texture_uid :
         m_assembly_uid < rhs.m_assembly_uid;
 }
@@ -292,7 +389,7 @@ inline bool TextureStore::TileKey::operator<(const TileKey& rhs) const
 
 inline size_t TextureStore::TileKeyHasher::operator()(const TileKey& key) const
 {
-    return foundation::mix_uint64(key.m_assembly_uid, key.m_texture_uid, key.m_tile_xy);
+    return foundation::mix_uint64(key.m_assembly_uid, key.m_texture_uid, key.m_tile_xy, key.m_level);
 }
 
 
@@ -302,7 +399,7 @@ inline size_t TextureStore::TileKeyHasher::operator()(const TileKey& key) const
 
 inline bool TextureStore::TileSwapper::is_full(const size_t element_count) const
 {
-    return m_memory_size >= m_params.m_memory_limit;
+    return m_memory_size.load(boost::memory_order_relaxed) >= m_params.m_memory_limit;
 }
 
 inline size_t TextureStore::TileSwapper::get_peak_memory_size() const
@@ -310,6 +407,11 @@ inline size_t TextureStore::TileSwapper::get_peak_memory_size() const
     return m_peak_memory_size;
 }
 
+inline size_t TextureStore::TileSwapper::get_memory_limit() const
+{
+    return m_params.m_memory_limit;
+}
+
 }       // namespace renderer
 
 #endif  // !APPLESEED_RENDERER_KERNEL_TEXTURING_TEXTURESTORE_H
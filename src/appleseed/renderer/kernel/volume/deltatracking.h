@@ -0,0 +1,221 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_VOLUME_DELTATRACKING_H
+#define APPLESEED_RENDERER_KERNEL_VOLUME_DELTATRACKING_H
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/hash.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/xoroshiro128plus.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/casts.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+
+namespace renderer
+{
+
+//
+// Building blocks for null-collision tracking in heterogeneous media.
+//
+// Tentative collisions are sampled with a majorant of the extinction coefficient.
+// At each of them, free-flight sampling (delta tracking) chooses between a real
+// scattering collision and a null collision, while transmission estimation
+// (ratio tracking) multiplies the estimate by the probability of a null collision.
+// Spectrally varying coefficients are handled with spectral tracking: a single
+// scalar majorant is used and the path weight absorbs the difference between
+// channels. Absorption is never sampled since it doesn't contribute radiance.
+//
+// References:
+//
+//   Monte Carlo Methods for Volumetric Light Transport Simulation
+//   Jan Novák, Iliyan Georgiev, Johannes Hanika, Wojciech Jarosz
+//   http://drz.disneyresearch.com/~jnovak/publications/MCVolumeRendering/
+//
+//   Spectral and Decomposition Tracking for Rendering Heterogeneous Volumes
+//   Peter Kutz, Ralf Habel, Yining Karl Li, Jan Novák
+//   https://disneyresearch.s3.amazonaws.com/wp-content/uploads/20170823124227/Spectral-and-Decomposition-Tracking-for-Rendering-Heterogeneous-Volumes-Paper1.pdf
+//
+
+// Random number generator used to draw the unbounded number of tentative collisions of a tracking walk.
+typedef foundation::Xoroshiro128plus TrackingRNG;
+
+// Create a random number generator from the next sample of a sampling context.
+TrackingRNG make_tracking_rng(SamplingContext& sampling_context);
+
+// Create a random number generator from a ray, for use where no sampling context is available.
+TrackingRNG make_tracking_rng(
+    const foundation::Vector3d&     org,
+    const foundation::Vector3d&     dir,
+    const float                     distance);
+
+// Return the distance to the next tentative collision.
+float sample_tentative_collision(
+    TrackingRNG&                    rng,
+    const float                     majorant);
+
+// Choose the type of a tentative collision and update the path weight accordingly.
+// Return true if the collision is a real scattering collision. The weight is set
+// to zero if neither a scattering nor a null collision is possible.
+bool sample_collision_type(
+    TrackingRNG&                    rng,
+    const Spectrum&                 scattering,
+    const Spectrum&                 extinction,
+    const float                     majorant,
+    Spectrum&                       weight);
+
+// Update a transmission estimate at a tentative collision. Apply Russian Roulette
+// when the estimate gets low. Return false if the estimate dropped to zero.
+bool update_transmission(
+    TrackingRNG&                    rng,
+    const Spectrum&                 extinction,
+    const float                     majorant,
+    Spectrum&                       transmission);
+
+
+//
+// Implementation.
+//
+
+inline TrackingRNG make_tracking_rng(SamplingContext& sampling_context)
+{
+    sampling_context.split_in_place(2, 1);
+    const foundation::Vector2f s = sampling_context.next2<foundation::Vector2f>();
+
+    return
+        TrackingRNG(
+            foundation::hash_uint64(foundation::binary_cast<foundation::uint32>(s[0])),
+            foundation::hash_uint64(foundation::binary_cast<foundation::uint32>(s[1]) + 1));
+}
+
+inline TrackingRNG make_tracking_rng(
+    const foundation::Vector3d&     org,
+    const foundation::Vector3d&     dir,
+    const float                     distance)
+{
+    using namespace foundation;
+
+    const uint64 h0 =
+        mix_uint64(
+            binary_cast<uint64>(org[0]),
+            binary_cast<uint64>(org[1]),
+            binary_cast<uint64>(org[2]));
+
+    const uint64 h1 =
+        mix_uint64(
+            binary_cast<uint64>(dir[0]),
+            binary_cast<uint64>(dir[1]),
+            binary_cast<uint64>(dir[2]),
+            binary_cast<uint32>(distance));
+
+    return TrackingRNG(h0, h1 + 1);
+}
+
+inline float sample_tentative_collision(
+    TrackingRNG&                    rng,
+    const float                     majorant)
+{
+    return foundation::sample_exponential_distribution(foundation::rand_float2(rng), majorant);
+}
+
+inline bool sample_collision_type(
+    TrackingRNG&                    rng,
+    const Spectrum&                 scattering,
+    const Spectrum&                 extinction,
+    const float                     majorant,
+    Spectrum&                       weight)
+{
+    Spectrum null_collision;
+    for (size_t i = 0, e = Spectrum::size(); i < e; ++i)
+        null_collision[i] = std::max(majorant - extinction[i], 0.0f);
+
+    const float scattering_avg = foundation::average_value(scattering);
+    const float null_collision_avg = foundation::average_value(null_collision);
+    const float sum = scattering_avg + null_collision_avg;
+
+    if (sum <= 0.0f)
+    {
+        weight.set(0.0f);
+        return false;
+    }
+
+    if (foundation::rand_float2(rng) * sum < scattering_avg)
+    {
+        // Real scattering collision.
+        weight *= scattering;
+        weight *= sum / (majorant * scattering_avg);
+        return true;
+    }
+    else
+    {
+        // Null collision.
+        weight *= null_collision;
+        weight *= sum / (majorant * null_collision_avg);
+        return false;
+    }
+}
+
+inline bool update_transmission(
+    TrackingRNG&                    rng,
+    const Spectrum&                 extinction,
+    const float                     majorant,
+    Spectrum&                       transmission)
+{
+    const float rcp_majorant = 1.0f / majorant;
+
+    for (size_t i = 0, e = Spectrum::size(); i < e; ++i)
+        transmission[i] *= std::max(1.0f - extinction[i] * rcp_majorant, 0.0f);
+
+    const float max_transmission = foundation::max_value(transmission);
+
+    if (max_transmission < 0.1f)
+    {
+        if (foundation::rand_float2(rng) >= max_transmission)
+        {
+            transmission.set(0.0f);
+            return false;
+        }
+
+        transmission /= max_transmission;
+    }
+
+    return true;
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_VOLUME_DELTATRACKING_H
@@ -0,0 +1,208 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sparsedensitygrid.h"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SparseDensityGrid class implementation.
+//
+
+const uint32 SparseDensityGrid::EmptyBrick;
+
+SparseDensityGrid::SparseDensityGrid(
+    const VoxelGrid&    voxel_grid,
+    const size_t        density_channel_index)
+  : m_max_density(0.0f)
+{
+    assert(density_channel_index < voxel_grid.get_channel_count());
+
+    m_res[0] = voxel_grid.get_xres();
+    m_res[1] = voxel_grid.get_yres();
+    m_res[2] = voxel_grid.get_zres();
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        m_bricks.m_res[i] = (m_res[i] + BrickSize - 1) / BrickSize;
+        m_blocks.m_res[i] = (m_bricks.m_res[i] + BlockSize - 1) / BlockSize;
+    }
+
+    m_bricks.m_cell_size = static_cast<float>(BrickSize);
+    m_blocks.m_cell_size = static_cast<float>(BrickSize * BlockSize);
+
+    const size_t brick_count = m_bricks.m_res[0] * m_bricks.m_res[1] * m_bricks.m_res[2];
+    m_brick_indices.resize(brick_count, EmptyBrick);
+
+    // Store the bricks that contain at least one nonzero voxel.
+    for (size_t bz = 0; bz < m_bricks.m_res[2]; ++bz)
+    {
+        for (size_t by = 0; by < m_bricks.m_res[1]; ++by)
+        {
+            for (size_t bx = 0; bx < m_bricks.m_res[0]; ++bx)
+            {
+                float brick[BrickVoxelCount];
+                bool empty = true;
+
+                for (size_t z = 0; z < BrickSize; ++z)
+                {
+                    for (size_t y = 0; y < BrickSize; ++y)
+                    {
+                        for (size_t x = 0; x < BrickSize; ++x)
+                        {
+                            const size_t vx = bx * BrickSize + x;
+                            const size_t vy = by * BrickSize + y;
+                            const size_t vz = bz * BrickSize + z;
+
+                            float density = 0.0f;
+                            if (vx < m_res[0] && vy < m_res[1] && vz < m_res[2])
+                                density = max(voxel_grid.voxel(vx, vy, vz)[density_channel_index], 0.0f);
+
+                            brick[(z * BrickSize + y) * BrickSize + x] = density;
+
+                            if (density > 0.0f)
+                                empty = false;
+                        }
+                    }
+                }
+
+                if (!empty)
+                {
+                    m_brick_indices[m_bricks.cell_index(bx, by, bz)] =
+                        static_cast<uint32>(m_brick_data.size() / BrickVoxelCount);
+                    m_brick_data.insert(m_brick_data.end(), brick, brick + BrickVoxelCount);
+                }
+            }
+        }
+    }
+
+    // Compute brick majorants. Since density is interpolated between voxel centers,
+    // the density inside a brick also depends on the voxels adjacent to the brick.
+    m_bricks.m_majorants.resize(brick_count, 0.0f);
+    for (size_t bz = 0; bz < m_bricks.m_res[2]; ++bz)
+    {
+        for (size_t by = 0; by < m_bricks.m_res[1]; ++by)
+        {
+            for (size_t bx = 0; bx < m_bricks.m_res[0]; ++bx)
+            {
+                const size_t brick[3] = { bx, by, bz };
+                size_t voxel_min[3], voxel_max[3];
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    voxel_min[i] = brick[i] * BrickSize;
+                    voxel_max[i] = min(voxel_min[i] + BrickSize, m_res[i] - 1);
+                    if (voxel_min[i] > 0)
+                        --voxel_min[i];
+                }
+
+                float majorant = 0.0f;
+                for (size_t z = voxel_min[2]; z <= voxel_max[2]; ++z)
+                {
+                    for (size_t y = voxel_min[1]; y <= voxel_max[1]; ++y)
+                    {
+                        for (size_t x = voxel_min[0]; x <= voxel_max[0]; ++x)
+                            majorant = max(majorant, get_voxel(x, y, z));
+                    }
+                }
+
+                m_bricks.m_majorants[m_bricks.cell_index(bx, by, bz)] = majorant;
+                m_max_density = max(m_max_density, majorant);
+            }
+        }
+    }
+
+    // Compute block majorants.
+    m_blocks.m_majorants.resize(m_blocks.m_res[0] * m_blocks.m_res[1] * m_blocks.m_res[2], 0.0f);
+    for (size_t bz = 0; bz < m_bricks.m_res[2]; ++bz)
+    {
+        for (size_t by = 0; by < m_bricks.m_res[1]; ++by)
+        {
+            for (size_t bx = 0; bx < m_bricks.m_res[0]; ++bx)
+            {
+                float& block_majorant =
+                    m_blocks.m_majorants[m_blocks.cell_index(bx / BlockSize, by / BlockSize, bz / BlockSize)];
+                block_majorant = max(block_majorant, m_bricks.m_majorants[m_bricks.cell_index(bx, by, bz)]);
+            }
+        }
+    }
+}
+
+size_t SparseDensityGrid::get_stored_brick_count() const
+{
+    return m_brick_data.size() / BrickVoxelCount;
+}
+
+size_t SparseDensityGrid::get_brick_count() const
+{
+    return m_brick_indices.size();
+}
+
+size_t SparseDensityGrid::get_memory_size() const
+{
+    return
+        sizeof(*this) +
+        m_brick_indices.capacity() * sizeof(uint32) +
+        m_brick_data.capacity() * sizeof(float) +
+        m_bricks.m_majorants.capacity() * sizeof(float) +
+        m_blocks.m_majorants.capacity() * sizeof(float);
+}
+
+namespace
+{
+    struct MaxDensityVisitor
+    {
+        float m_max_density;
+
+        bool operator()(const float t0, const float t1, const float majorant)
+        {
+            m_max_density = max(m_max_density, majorant);
+            return true;
+        }
+    };
+}
+
+float SparseDensityGrid::get_max_density(
+    const Vector3f&     org,
+    const Vector3f&     dir,
+    const float         tmin,
+    const float         tmax) const
+{
+    MaxDensityVisitor visitor = { 0.0f };
+    traverse(org, dir, tmin, tmax, visitor);
+    return visitor.m_max_density;
+}
+
+}   // namespace renderer
@@ -0,0 +1,377 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef APPLESEED_RENDERER_KERNEL_VOLUME_SPARSEDENSITYGRID_H
+#define APPLESEED_RENDERER_KERNEL_VOLUME_SPARSEDENSITYGRID_H
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/volume.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A sparse grid of density values.
+//
+// Voxels are stored in bricks of 8x8x8 voxels and bricks whose voxels are all
+// zero are not stored. The grid keeps a hierarchy of majorants (upper bounds of
+// the density): one per brick and one per block of 4x4x4 bricks. Traversals use
+// them to skip empty space and to bound the density along ray segments, as
+// required by delta tracking and ratio tracking.
+//
+// The grid spans [0, xres] x [0, yres] x [0, zres] in grid space, voxel centers
+// are located at integer coordinates plus one half. Density is trilinearly
+// interpolated and is zero outside of the grid.
+//
+
+class SparseDensityGrid
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. Build the grid from one channel of a dense voxel grid.
+    SparseDensityGrid(
+        const VoxelGrid&                voxel_grid,
+        const size_t                    density_channel_index);
+
+    // Return the resolution of the grid.
+    size_t get_xres() const;
+    size_t get_yres() const;
+    size_t get_zres() const;
+
+    // Return the number of stored bricks and the total number of bricks.
+    size_t get_stored_brick_count() const;
+    size_t get_brick_count() const;
+
+    // Return the approximate amount of memory used by the grid, in bytes.
+    size_t get_memory_size() const;
+
+    // Return the maximum density in the grid.
+    float get_max_density() const;
+
+    // Return the density at a given point in grid space.
+    float lookup(const foundation::Vector3f& point) const;
+
+    // Visit the segments of a ray (in grid space) where the density may be
+    // nonzero, from front to back, with an upper bound of the density on each
+    // segment. The visitor is invoked as visitor(t0, t1, majorant) and returns
+    // false to stop the traversal.
+    template <typename Visitor>
+    void traverse(
+        const foundation::Vector3f&     org,
+        const foundation::Vector3f&     dir,
+        const float                     tmin,
+        const float                     tmax,
+        Visitor&                        visitor) const;
+
+    // Return an upper bound of the density along a ray segment (in grid space).
+    float get_max_density(
+        const foundation::Vector3f&     org,
+        const foundation::Vector3f&     dir,
+        const float                     tmin,
+        const float                     tmax) const;
+
+  private:
+    enum
+    {
+        BrickSize = 8,                  // size of a brick, in voxels
+        BrickVoxelCount = BrickSize * BrickSize * BrickSize,
+        BlockSize = 4                   // size of a block, in bricks
+    };
+
+    static const foundation::uint32 EmptyBrick = ~foundation::uint32(0);
+
+    struct Level
+    {
+        size_t                          m_res[3];
+        float                           m_cell_size;        // size of a cell, in voxels
+        std::vector<float>              m_majorants;
+
+        size_t cell_index(const size_t x, const size_t y, const size_t z) const;
+    };
+
+    size_t                              m_res[3];
+    std::vector<foundation::uint32>     m_brick_indices;    // index of each brick in m_brick_data, or EmptyBrick
+    std::vector<float>                  m_brick_data;
+    Level                               m_bricks;
+    Level                               m_blocks;
+    float                               m_max_density;
+
+    float get_voxel(const size_t x, const size_t y, const size_t z) const;
+
+    // Visit the cells of a level overlapping a ray segment, restricted to a range of cells.
+    // The visitor is invoked as visitor(x, y, z, t0, t1) and returns false to stop.
+    template <typename Visitor>
+    static bool walk(
+        const Level&                    level,
+        const size_t                    cell_min[3],
+        const size_t                    cell_max[3],
+        const foundation::Vector3f&     org,
+        const foundation::Vector3f&     dir,
+        const float                     tmin,
+        const float                     tmax,
+        Visitor&                        visitor);
+
+    template <typename Visitor> struct BlockVisitor;
+    template <typename Visitor> struct BrickVisitor;
+};
+
+
+//
+// SparseDensityGrid class implementation.
+//
+
+inline size_t SparseDensityGrid::get_xres() const
+{
+    return m_res[0];
+}
+
+inline size_t SparseDensityGrid::get_yres() const
+{
+    return m_res[1];
+}
+
+inline size_t SparseDensityGrid::get_zres() const
+{
+    return m_res[2];
+}
+
+inline float SparseDensityGrid::get_max_density() const
+{
+    return m_max_density;
+}
+
+inline size_t SparseDensityGrid::Level::cell_index(const size_t x, const size_t y, const size_t z) const
+{
+    return (z * m_res[1] + y) * m_res[0] + x;
+}
+
+inline float SparseDensityGrid::get_voxel(const size_t x, const size_t y, const size_t z) const
+{
+    const size_t brick = m_bricks.cell_index(x / BrickSize, y / BrickSize, z / BrickSize);
+    const foundation::uint32 brick_index = m_brick_indices[brick];
+
+    if (brick_index == EmptyBrick)
+        return 0.0f;
+
+    const size_t voxel =
+        ((z % BrickSize) * BrickSize + (y % BrickSize)) * BrickSize + (x % BrickSize);
+
+    return m_brick_data[brick_index * BrickVoxelCount + voxel];
+}
+
+inline float SparseDensityGrid::lookup(const foundation::Vector3f& point) const
+{
+    if (point.x < 0.0f || point.y < 0.0f || point.z < 0.0f ||
+        point.x > m_res[0] || point.y > m_res[1] || point.z > m_res[2])
+        return 0.0f;
+
+    // Find the voxels surrounding the lookup point and the interpolation weights.
+    size_t i0[3], i1[3];
+    float w1[3];
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const float x = std::max(point[i] - 0.5f, 0.0f);
+        i0[i] = std::min(foundation::truncate<size_t>(x), m_res[i] - 1);
+        i1[i] = std::min(i0[i] + 1, m_res[i] - 1);
+        w1[i] = foundation::saturate(x - i0[i]);
+    }
+
+    const float w0[3] = { 1.0f - w1[0], 1.0f - w1[1], 1.0f - w1[2] };
+
+    return
+        w0[2] * (
+            w0[1] * (w0[0] * get_voxel(i0[0], i0[1], i0[2]) + w1[0] * get_voxel(i1[0], i0[1], i0[2])) +
+            w1[1] * (w0[0] * get_voxel(i0[0], i1[1], i0[2]) + w1[0] * get_voxel(i1[0], i1[1], i0[2]))) +
+        w1[2] * (
+            w0[1] * (w0[0] * get_voxel(i0[0], i0[1], i1[2]) + w1[0] * get_voxel(i1[0], i0[1], i1[2])) +
+            w1[1] * (w0[0] * get_voxel(i0[0], i1[1], i1[2]) + w1[0] * get_voxel(i1[0], i1[1], i1[2])));
+}
+
+template <typename Visitor>
+bool SparseDensityGrid::walk(
+    const Level&                        level,
+    const size_t                        cell_min[3],
+    const size_t                        cell_max[3],
+    const foundation::Vector3f&         org,
+    const foundation::Vector3f&         dir,
+    const float                         tmin,
+    const float                         tmax,
+    Visitor&                            visitor)
+{
+    // Find the cell containing the start of the segment.
+    size_t cell[3];
+    float next_t[3], delta_t[3];
+    int step[3];
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const float x = (org[i] + tmin * dir[i]) / level.m_cell_size;
+        const float c = foundation::clamp(std::floor(x), static_cast<float>(cell_min[i]), static_cast<float>(cell_max[i]));
+        cell[i] = static_cast<size_t>(c);
+
+        if (dir[i] > 0.0f)
+        {
+            step[i] = 1;
+            next_t[i] = ((cell[i] + 1) * level.m_cell_size - org[i]) / dir[i];
+            delta_t[i] = level.m_cell_size / dir[i];
+        }
+        else if (dir[i] < 0.0f)
+        {
+            step[i] = -1;
+            next_t[i] = (cell[i] * level.m_cell_size - org[i]) / dir[i];
+            delta_t[i] = -level.m_cell_size / dir[i];
+        }
+        else
+        {
+            step[i] = 0;
+            next_t[i] = std::numeric_limits<float>::max();
+            delta_t[i] = std::numeric_limits<float>::max();
+        }
+    }
+
+    float t = tmin;
+
+    while (true)
+    {
+        // Find the axis along which the ray leaves the current cell.
+        const size_t axis =
+            next_t[0] < next_t[1]
+                ? (next_t[0] < next_t[2] ? 0 : 2)
+                : (next_t[1] < next_t[2] ? 1 : 2);
+
+        const float t1 = std::min(next_t[axis], tmax);
+
+        if (t1 > t && !visitor(cell[0], cell[1], cell[2], t, t1))
+            return false;
+
+        if (t1 >= tmax)
+            return true;
+
+        // Move to the next cell.
+        if (step[axis] > 0 ? cell[axis] == cell_max[axis] : cell[axis] == cell_min[axis])
+            return true;
+
+        cell[axis] += step[axis];
+        next_t[axis] += delta_t[axis];
+        t = t1;
+    }
+}
+
+template <typename Visitor>
+struct SparseDensityGrid::BrickVisitor
+{
+    const SparseDensityGrid&    m_grid;
+    Visitor&                    m_visitor;
+
+    bool operator()(const size_t x, const size_t y, const size_t z, const float t0, const float t1)
+    {
+        const float majorant = m_grid.m_bricks.m_majorants[m_grid.m_bricks.cell_index(x, y, z)];
+        return majorant == 0.0f || m_visitor(t0, t1, majorant);
+    }
+};
+
+template <typename Visitor>
+struct SparseDensityGrid::BlockVisitor
+{
+    const SparseDensityGrid&    m_grid;
+    const foundation::Vector3f& m_org;
+    const foundation::Vector3f& m_dir;
+    Visitor&                    m_visitor;
+
+    bool operator()(const size_t x, const size_t y, const size_t z, const float t0, const float t1)
+    {
+        // Skip empty blocks.
+        if (m_grid.m_blocks.m_majorants[m_grid.m_blocks.cell_index(x, y, z)] == 0.0f)
+            return true;
+
+        // Walk the bricks of this block.
+        const size_t block[3] = { x, y, z };
+        size_t brick_min[3], brick_max[3];
+        for (size_t i = 0; i < 3; ++i)
+        {
+            brick_min[i] = block[i] * BlockSize;
+            brick_max[i] = std::min(brick_min[i] + BlockSize, m_grid.m_bricks.m_res[i]) - 1;
+        }
+
+        BrickVisitor<Visitor> brick_visitor = { m_grid, m_visitor };
+        return walk(m_grid.m_bricks, brick_min, brick_max, m_org, m_dir, t0, t1, brick_visitor);
+    }
+};
+
+template <typename Visitor>
+void SparseDensityGrid::traverse(
+    const foundation::Vector3f&         org,
+    const foundation::Vector3f&         dir,
+    float                               tmin,
+    float                               tmax,
+    Visitor&                            visitor) const
+{
+    // Clip the segment to the bounds of the grid.
+    for (size_t i = 0; i < 3; ++i)
+    {
+        if (dir[i] == 0.0f)
+        {
+            if (org[i] < 0.0f || org[i] > m_res[i])
+                return;
+        }
+        else
+        {
+            const float rcp_dir = 1.0f / dir[i];
+            float t0 = -org[i] * rcp_dir;
+            float t1 = (m_res[i] - org[i]) * rcp_dir;
+            if (t0 > t1)
+                std::swap(t0, t1);
+            tmin = std::max(tmin, t0);
+            tmax = std::min(tmax, t1);
+        }
+    }
+
+    if (tmin >= tmax)
+        return;
+
+    const size_t block_min[3] = { 0, 0, 0 };
+    const size_t block_max[3] = { m_blocks.m_res[0] - 1, m_blocks.m_res[1] - 1, m_blocks.m_res[2] - 1 };
+
+    BlockVisitor<Visitor> block_visitor = { *this, org, dir, visitor };
+    walk(m_blocks, block_min, block_max, org, dir, tmin, tmax, block_visitor);
+}
+
+}       // namespace renderer
+
+#endif  // !APPLESEED_RENDERER_KERNEL_VOLUME_SPARSEDENSITYGRID_H
@@ -0,0 +1,133 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/globalsampleaccumulationbuffer.h"
+#include "renderer/kernel/rendering/sample.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/filter.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/benchmark.h"
+
+// Boost headers.
+#include "boost/thread/thread.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Rendering_GlobalSampleAccumulationBuffer)
+{
+    // Total number of samples stored by each benchmark case, regardless of the number of threads.
+    // Dividing this number by the time reported for a case gives the sample throughput.
+    const size_t TotalSampleCount = 256 * 1024;
+
+    // Number of samples in one batch, similar to what light tracing generates per job.
+    const size_t BatchSize = 4096;
+
+    struct Fixture
+    {
+        BlackmanHarrisFilter2<float>    m_filter;
+        GlobalSampleAccumulationBuffer  m_buffer;
+        vector<Sample>                  m_samples;
+        AbortSwitch                     m_abort_switch;
+
+        Fixture()
+          : m_filter(1.5f, 1.5f)
+          , m_buffer(640, 480, m_filter)
+          , m_samples(TotalSampleCount)
+        {
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < TotalSampleCount; ++i)
+            {
+                m_samples[i].m_position = rand_vector2<Vector2f>(rng);
+                m_samples[i].m_color = Color4f(0.5f, 0.5f, 0.5f, 1.0f);
+            }
+        }
+
+        void store_samples(const size_t thread_index, const size_t thread_count)
+        {
+            const size_t batch_count = TotalSampleCount / BatchSize;
+
+            for (size_t i = thread_index; i < batch_count; i += thread_count)
+            {
+                m_buffer.store_samples(
+                    BatchSize,
+                    &m_samples[i * BatchSize],
+                    m_abort_switch);
+            }
+        }
+
+        void store_samples_in_parallel(const size_t thread_count)
+        {
+            boost::thread_group threads;
+
+            for (size_t i = 1; i < thread_count; ++i)
+                threads.create_thread([this, i, thread_count]() { store_samples(i, thread_count); });
+
+            store_samples(0, thread_count);
+
+            threads.join_all();
+        }
+    };
+
+    BENCHMARK_CASE_F(StoreSamples_1Thread, Fixture)
+    {
+        store_samples_in_parallel(1);
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_2Threads, Fixture)
+    {
+        store_samples_in_parallel(2);
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_4Threads, Fixture)
+    {
+        store_samples_in_parallel(4);
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_8Threads, Fixture)
+    {
+        store_samples_in_parallel(8);
+    }
+
+    BENCHMARK_CASE_F(StoreSamples_16Threads, Fixture)
+    {
+        store_samples_in_parallel(16);
+    }
+}
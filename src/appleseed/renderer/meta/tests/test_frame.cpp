@@ -27,6 +27,7 @@
 //
 
 // appleseed.renderer headers.
+#include "renderer/modeling/aov/aov.h"
 #include "renderer/modeling/aov/aovcontainer.h"
 #include "renderer/modeling/aov/diffuseaov.h"
 #include "renderer/modeling/aov/glossyaov.h"
@@ -34,17 +35,27 @@
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/genericimagefilereader.h"
+#include "foundation/image/image.h"
 #include "foundation/platform/thread.h"
 #include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/countof.h"
 #include "foundation/utility/test.h"
 
 // Boost headers.
 #include "boost/filesystem/operations.hpp"
 #include "boost/filesystem/path.hpp"
 
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <string>
+
 namespace bf = boost::filesystem;
 using namespace foundation;
 using namespace renderer;
+using namespace std;
 
 TEST_SUITE(Renderer_Modeling_Frame_Frame)
 {
@@ -101,7 +112,7 @@ TEST_SUITE(Renderer_Modeling_Frame_Frame)
 
     TEST_CASE_F(WriteMainAndAOVImages, Fixture)
     {
-        m_frame->write_main_and_aov_images();
+        m_frame->write_main_and_aov_images(4);
 
         EXPECT_TRUE(bf::exists(m_output_directory / "default-main.png"));
 
@@ -111,6 +122,102 @@ TEST_SUITE(Renderer_Modeling_Frame_Frame)
         EXPECT_TRUE(bf::exists(m_output_directory / "default-indirect-glossy.exr"));        // note: exr extension added
     }
 
+    void fill_image(Image& image, const float blue)
+    {
+        const CanvasProperties& props = image.properties();
+
+        for (size_t y = 0; y < props.m_canvas_height; ++y)
+        {
+            for (size_t x = 0; x < props.m_canvas_width; ++x)
+            {
+                const float components[4] =
+                {
+                    static_cast<float>(x) / props.m_canvas_width,
+                    static_cast<float>(y) / props.m_canvas_height,
+                    blue,
+                    1.0f
+                };
+
+                image.set_pixel(x, y, components);
+            }
+        }
+    }
+
+    void fill_main_and_aov_images(Frame& frame, const float blue)
+    {
+        fill_image(frame.image(), blue);
+
+        for (size_t i = 0, e = frame.aovs().size(); i < e; ++i)
+            fill_image(frame.aovs().get_by_index(i)->get_image(), blue);
+    }
+
+    bool image_files_are_equal(const bf::path& lhs_path, const bf::path& rhs_path)
+    {
+        GenericImageFileReader reader;
+        unique_ptr<Image> lhs(reader.read(lhs_path.string().c_str()));
+        unique_ptr<Image> rhs(reader.read(rhs_path.string().c_str()));
+
+        const CanvasProperties& lhs_props = lhs->properties();
+        const CanvasProperties& rhs_props = rhs->properties();
+
+        if (lhs_props.m_canvas_width != rhs_props.m_canvas_width ||
+            lhs_props.m_canvas_height != rhs_props.m_canvas_height ||
+            lhs_props.m_channel_count != rhs_props.m_channel_count)
+            return false;
+
+        for (size_t y = 0; y < lhs_props.m_canvas_height; ++y)
+        {
+            for (size_t x = 0; x < lhs_props.m_canvas_width; ++x)
+            {
+                float lhs_components[4], rhs_components[4];
+                lhs->get_pixel(x, y, lhs_components);
+                rhs->get_pixel(x, y, rhs_components);
+
+                for (size_t c = 0; c < lhs_props.m_channel_count; ++c)
+                {
+                    if (lhs_components[c] != rhs_components[c])
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    TEST_CASE_F(WriteMainAndAOVImagesAsync_WritesSameImagesAsWriteMainAndAOVImages, Fixture)
+    {
+        const char* FileNames[] =
+        {
+            "default-main.png",
+            "default-direct-diffuse.exr",
+            "default-indirect-diffuse.exr",
+            "default-direct-glossy.exr",
+            "default-indirect-glossy.exr"
+        };
+
+        fill_main_and_aov_images(m_frame.ref(), 0.5f);
+
+        EXPECT_TRUE(m_frame->write_main_and_aov_images(4));
+
+        for (size_t i = 0; i < countof(FileNames); ++i)
+            bf::rename(m_output_directory / FileNames[i], m_output_directory / (string("sync-") + FileNames[i]));
+
+        m_frame->write_main_and_aov_images_async(4);
+
+        // The images being written are copies: rendering to the frame again must not affect them.
+        fill_main_and_aov_images(m_frame.ref(), 0.0f);
+
+        EXPECT_TRUE(m_frame->wait_for_pending_image_writes());
+
+        for (size_t i = 0; i < countof(FileNames); ++i)
+        {
+            EXPECT_TRUE(
+                image_files_are_equal(
+                    m_output_directory / (string("sync-") + FileNames[i]),
+                    m_output_directory / FileNames[i]));
+        }
+    }
+
     TEST_CASE_F(WriteMainImage_FilenameHasEXRExtension_WritesEXRFile, Fixture)
     {
         m_frame->write_main_image((m_output_directory / "override.exr").string().c_str());
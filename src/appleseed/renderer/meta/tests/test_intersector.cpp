@@ -35,7 +35,9 @@
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/kernel/texturing/texturecache.h"
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/object/meshobject.h"
 #include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/containers.h"
@@ -51,10 +53,16 @@
 #include "foundation/math/vector.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/iostreamop.h"
 #include "foundation/utility/test.h"
 
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
 using namespace foundation;
 using namespace renderer;
+using namespace std;
 
 TEST_SUITE(Renderer_Kernel_Intersection_Intersector)
 {
@@ -100,7 +108,7 @@ TEST_SUITE(Renderer_Kernel_Intersection_Intersector)
         Intersector     m_intersector;
 
         Fixture()
-          : m_trace_context(m_scene)
+          : m_trace_context(m_scene, 1)
           , m_texture_store(m_scene)
           , m_texture_cache(m_texture_store)
           , m_intersector(m_trace_context, m_texture_cache)
@@ -140,4 +148,202 @@ TEST_SUITE(Renderer_Kernel_Intersection_Intersector)
 
         EXPECT_FALSE(hit);
     }
+
+    // A tessellated square in the z = 0 plane.
+    template <bool IndexedLeaves, bool WideBVH = false>
+    struct GridScene
+      : public TestSceneBase
+    {
+        static const size_t GridSize = 8;
+
+        GridScene()
+        {
+            m_scene.get_parameters().insert_path("acceleration_structure.wide_bvh", WideBVH);
+
+            ParamArray assembly_params;
+            assembly_params.insert_path("acceleration_structure.indexed_leaves", IndexedLeaves);
+            assembly_params.insert_path("acceleration_structure.wide_bvh", WideBVH);
+
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", assembly_params));
+
+            auto_release_ptr<MeshObject> mesh_object(
+                MeshObjectFactory().create("grid", ParamArray()));
+
+            for (size_t y = 0; y <= GridSize; ++y)
+            {
+                for (size_t x = 0; x <= GridSize; ++x)
+                {
+                    mesh_object->push_vertex(
+                        GVector3(
+                            static_cast<GScalar>(2.0 * x / GridSize - 1.0),
+                            static_cast<GScalar>(2.0 * y / GridSize - 1.0),
+                            GScalar(0.0)));
+                }
+            }
+
+            for (size_t y = 0; y < GridSize; ++y)
+            {
+                for (size_t x = 0; x < GridSize; ++x)
+                {
+                    const size_t v0 = y * (GridSize + 1) + x;
+                    const size_t v1 = v0 + 1;
+                    const size_t v2 = v0 + GridSize + 2;
+                    const size_t v3 = v0 + GridSize + 1;
+                    mesh_object->push_triangle(Triangle(v0, v1, v2, 0));
+                    mesh_object->push_triangle(Triangle(v2, v3, v0, 0));
+                }
+            }
+
+            assembly->objects().insert(auto_release_ptr<Object>(mesh_object.release()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "grid_instance",
+                    ParamArray(),
+                    "grid",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            m_scene.assembly_instances().insert(
+                auto_release_ptr<AssemblyInstance>(
+                    AssemblyInstanceFactory::create(
+                        "assembly_instance",
+                        ParamArray(),
+                        "assembly")));
+
+            m_scene.assemblies().insert(assembly);
+        }
+    };
+
+    template <typename Scene>
+    struct GridFixture
+      : public StaticTestSceneContext<Scene>
+    {
+        TraceContext    m_trace_context;
+        TextureStore    m_texture_store;
+        TextureCache    m_texture_cache;
+        Intersector     m_intersector;
+
+        GridFixture()
+          : m_trace_context(Scene::m_scene, 1)
+          , m_texture_store(Scene::m_scene)
+          , m_texture_cache(m_texture_store)
+          , m_intersector(m_trace_context, m_texture_cache)
+        {
+        }
+
+        bool trace(const double x, const double y, ShadingPoint& shading_point)
+        {
+            const ShadingRay ray(
+                Vector3d(x, y, 2.0),
+                Vector3d(0.0, 0.0, -1.0),
+                0.0,                                // tmin
+                10.0,                               // tmax
+                ShadingRay::Time(),
+                VisibilityFlags::CameraRay,
+                0);                                 // depth
+
+            return m_intersector.trace(ray, shading_point);
+        }
+    };
+
+    TEST_CASE(Trace_GivenIndexedTriangleTreeLeaves_ReturnsSameHitsAsFullTriangles)
+    {
+        GridFixture<GridScene<false>> full;
+        GridFixture<GridScene<true>> indexed;
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const double x = -1.1 + 2.2 * ((i * 37) % 100) / 100.0;
+            const double y = -1.1 + 2.2 * i / 100.0;
+
+            ShadingPoint full_shading_point;
+            const bool full_hit = full.trace(x, y, full_shading_point);
+
+            ShadingPoint indexed_shading_point;
+            const bool indexed_hit = indexed.trace(x, y, indexed_shading_point);
+
+            EXPECT_EQ(full_hit, indexed_hit);
+
+            if (full_hit && indexed_hit)
+            {
+                EXPECT_EQ(full_shading_point.get_distance(), indexed_shading_point.get_distance());
+                EXPECT_EQ(full_shading_point.get_primitive_index(), indexed_shading_point.get_primitive_index());
+                EXPECT_EQ(full_shading_point.get_bary(), indexed_shading_point.get_bary());
+            }
+        }
+    }
+
+    TEST_CASE(Trace_GivenWideBVHs_ReturnsSameHitsAsBinaryBVHs)
+    {
+        GridFixture<GridScene<false, false>> binary;
+        GridFixture<GridScene<false, true>> wide;
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const double x = -1.1 + 2.2 * ((i * 37) % 100) / 100.0;
+            const double y = -1.1 + 2.2 * i / 100.0;
+
+            ShadingPoint binary_shading_point;
+            const bool binary_hit = binary.trace(x, y, binary_shading_point);
+
+            ShadingPoint wide_shading_point;
+            const bool wide_hit = wide.trace(x, y, wide_shading_point);
+
+            EXPECT_EQ(binary_hit, wide_hit);
+
+            if (binary_hit && wide_hit)
+            {
+                EXPECT_EQ(binary_shading_point.get_distance(), wide_shading_point.get_distance());
+                EXPECT_EQ(binary_shading_point.get_primitive_index(), wide_shading_point.get_primitive_index());
+            }
+        }
+    }
+
+    TEST_CASE_F(TraceBatch_GivenRaysInAllDirectionOctants_ReturnsSameHitsAsTracingEachRayAlone, GridFixture<GridScene<false>>)
+    {
+        const size_t RayCount = 100;
+
+        // Shoot rays from both sides of the grid toward points on and around it.
+        vector<ShadingRay> rays;
+        for (size_t i = 0; i < RayCount; ++i)
+        {
+            const Vector3d org(
+                -2.0 + 4.0 * ((i * 13) % RayCount) / RayCount,
+                -2.0 + 4.0 * ((i * 29) % RayCount) / RayCount,
+                i % 2 == 0 ? 2.0 : -2.0);
+            const Vector3d target(
+                -1.1 + 2.2 * ((i * 37) % RayCount) / RayCount,
+                -1.1 + 2.2 * i / RayCount,
+                0.0);
+
+            rays.emplace_back(
+                org,
+                normalize(target - org),
+                0.0,                                // tmin
+                10.0,                               // tmax
+                ShadingRay::Time(),
+                VisibilityFlags::CameraRay,
+                0);                                 // depth
+        }
+
+        vector<ShadingPoint> batch_shading_points(RayCount);
+        m_intersector.trace(&rays[0], RayCount, &batch_shading_points[0]);
+
+        for (size_t i = 0; i < RayCount; ++i)
+        {
+            ShadingPoint shading_point;
+            const bool hit = m_intersector.trace(rays[i], shading_point);
+
+            EXPECT_EQ(hit, batch_shading_points[i].hit_surface());
+
+            if (hit && batch_shading_points[i].hit_surface())
+            {
+                EXPECT_EQ(shading_point.get_distance(), batch_shading_points[i].get_distance());
+                EXPECT_EQ(shading_point.get_primitive_index(), batch_shading_points[i].get_primitive_index());
+                EXPECT_EQ(shading_point.get_bary(), batch_shading_points[i].get_bary());
+            }
+        }
+    }
 }
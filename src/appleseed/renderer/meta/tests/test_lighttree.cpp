@@ -0,0 +1,263 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/lighttree.h"
+#include "renderer/kernel/lighting/lighttypes.h"
+#include "renderer/modeling/edf/diffuseedf.h"
+#include "renderer/modeling/edf/edf.h"
+#include "renderer/modeling/material/genericmaterial.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_LightTree)
+{
+    struct TestScene
+      : public TestSceneBase
+    {
+        Assembly* m_assembly;
+
+        TestScene()
+        {
+            m_scene.assemblies().insert(
+                AssemblyFactory().create("assembly", ParamArray()));
+            m_assembly = m_scene.assemblies().get_by_name("assembly");
+
+            create_emitting_material("dim_material", "dim_edf", "1.0");
+            create_emitting_material("bright_material", "bright_edf", "20.0");
+        }
+
+        void create_emitting_material(
+            const char*     material_name,
+            const char*     edf_name,
+            const char*     radiance)
+        {
+            m_assembly->edfs().insert(
+                DiffuseEDFFactory().create(
+                    edf_name,
+                    ParamArray().insert("radiance", radiance)));
+
+            m_assembly->materials().insert(
+                GenericMaterialFactory().create(
+                    material_name,
+                    ParamArray().insert("edf", edf_name)));
+        }
+    };
+
+    struct Fixture
+      : public StaticTestSceneContext<TestScene>
+    {
+        vector<NonPhysicalLightInfo>    m_non_physical_lights;
+        vector<EmittingTriangle>        m_emitting_triangles;
+
+        // Create small emitting triangles scattered in the unit cube.
+        void create_emitting_triangles(const size_t count)
+        {
+            const Material* materials[2] =
+            {
+                m_assembly->materials().get_by_name("dim_material"),
+                m_assembly->materials().get_by_name("bright_material")
+            };
+
+            MersenneTwister rng;
+
+            m_emitting_triangles.resize(count);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Vector3d center(rand_double1(rng), rand_double1(rng), rand_double1(rng));
+
+                EmittingTriangle& triangle = m_emitting_triangles[i];
+                triangle.m_v0 = center + Vector3d(0.01, 0.0, 0.0);
+                triangle.m_v1 = center + Vector3d(0.0, 0.01, 0.0);
+                triangle.m_v2 = center + Vector3d(0.0, 0.0, 0.01);
+                triangle.m_material = materials[i % 8 == 0 ? 1 : 0];
+            }
+        }
+    };
+
+    TEST_CASE_F(Sample_ReturnsProbabilityEqualToPdfOfSampledLight, Fixture)
+    {
+        create_emitting_triangles(1000);
+
+        LightTree light_tree(m_non_physical_lights, m_emitting_triangles);
+        const vector<size_t> tri_index_to_location = light_tree.build();
+
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const Vector3f surface_point(
+                rand_float1(rng, -1.0f, 2.0f),
+                rand_float1(rng, -1.0f, 2.0f),
+                rand_float1(rng, -1.0f, 2.0f));
+            const Vector3f surface_normal =
+                sample_sphere_uniform(Vector2f(rand_float1(rng), rand_float1(rng)));
+
+            LightType light_type;
+            size_t light_index;
+            float light_probability;
+            light_tree.sample(
+                surface_point,
+                surface_normal,
+                rand_float1(rng),
+                light_type,
+                light_index,
+                light_probability);
+
+            ASSERT_EQ(EmittingTriangleType, light_type);
+
+            const float pdf =
+                light_tree.evaluate_node_pdf(
+                    surface_point,
+                    surface_normal,
+                    tri_index_to_location[light_index]);
+
+            EXPECT_FEQ_EPS(light_probability, pdf, 1.0e-4f);
+        }
+    }
+
+    TEST_CASE_F(EvaluateNodePdf_SumsToOneOverAllLights, Fixture)
+    {
+        create_emitting_triangles(1000);
+
+        LightTree light_tree(m_non_physical_lights, m_emitting_triangles);
+        const vector<size_t> tri_index_to_location = light_tree.build();
+
+        const Vector3f surface_point(0.5f, 0.5f, -0.5f);
+        const Vector3f surface_normal(0.0f, 0.0f, 1.0f);
+
+        double sum = 0.0;
+        for (size_t i = 0, e = m_emitting_triangles.size(); i < e; ++i)
+            sum += light_tree.evaluate_node_pdf(surface_point, surface_normal, tri_index_to_location[i]);
+
+        EXPECT_FEQ_EPS(1.0, sum, 1.0e-3);
+    }
+
+    TEST_CASE_F(Build_InParallel_ReturnsSameTreeAsSerialBuild, Fixture)
+    {
+        // Enough lights for the top levels of the tree to be split into concurrent jobs.
+        create_emitting_triangles(20000);
+
+        LightTree serial_light_tree(m_non_physical_lights, m_emitting_triangles);
+        const vector<size_t> serial_locations = serial_light_tree.build(nullptr, 1);
+
+        LightTree parallel_light_tree(m_non_physical_lights, m_emitting_triangles);
+        const vector<size_t> parallel_locations = parallel_light_tree.build(nullptr, 4);
+
+        ASSERT_EQ(serial_locations.size(), parallel_locations.size());
+        EXPECT_SEQUENCE_EQ(serial_locations.size(), &serial_locations[0], &parallel_locations[0]);
+
+        const Vector3f surface_point(0.25f, 0.5f, 0.75f);
+        const Vector3f surface_normal(0.0f, 1.0f, 0.0f);
+
+        for (size_t i = 0, e = m_emitting_triangles.size(); i < e; ++i)
+        {
+            EXPECT_EQ(
+                serial_light_tree.evaluate_node_pdf(surface_point, surface_normal, serial_locations[i]),
+                parallel_light_tree.evaluate_node_pdf(surface_point, surface_normal, parallel_locations[i]));
+        }
+    }
+
+    TEST_CASE_F(Build_GivenCacheAndUnchangedLights_ReusesCachedTree, Fixture)
+    {
+        create_emitting_triangles(100);
+
+        LightTreeCache cache;
+
+        LightTree first_light_tree(m_non_physical_lights, m_emitting_triangles);
+        const vector<size_t> first_locations = first_light_tree.build(&cache);
+
+        LightTree second_light_tree(m_non_physical_lights, m_emitting_triangles);
+        const vector<size_t> second_locations = second_light_tree.build(&cache);
+
+        EXPECT_FALSE(first_light_tree.is_reused());
+        EXPECT_TRUE(second_light_tree.is_reused());
+        ASSERT_EQ(first_locations.size(), second_locations.size());
+        EXPECT_SEQUENCE_EQ(first_locations.size(), &first_locations[0], &second_locations[0]);
+    }
+
+    TEST_CASE_F(Build_GivenCacheAndMovedLight_RebuildsTree, Fixture)
+    {
+        create_emitting_triangles(100);
+
+        LightTreeCache cache;
+
+        LightTree first_light_tree(m_non_physical_lights, m_emitting_triangles);
+        first_light_tree.build(&cache);
+
+        m_emitting_triangles[42].m_v0 += Vector3d(0.0, 0.0, 0.5);
+
+        LightTree second_light_tree(m_non_physical_lights, m_emitting_triangles);
+        second_light_tree.build(&cache);
+
+        LightTree third_light_tree(m_non_physical_lights, m_emitting_triangles);
+        third_light_tree.build(&cache);
+
+        EXPECT_FALSE(second_light_tree.is_reused());
+        EXPECT_TRUE(third_light_tree.is_reused());
+    }
+
+    TEST_CASE_F(Build_GivenClearedCache_RebuildsTree, Fixture)
+    {
+        create_emitting_triangles(100);
+
+        LightTreeCache cache;
+
+        LightTree first_light_tree(m_non_physical_lights, m_emitting_triangles);
+        first_light_tree.build(&cache);
+
+        cache.clear();
+
+        LightTree second_light_tree(m_non_physical_lights, m_emitting_triangles);
+        second_light_tree.build(&cache);
+
+        EXPECT_FALSE(second_light_tree.is_reused());
+    }
+}
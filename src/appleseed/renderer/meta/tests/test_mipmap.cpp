@@ -0,0 +1,125 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// appleseed.renderer headers.
+#include "renderer/kernel/texturing/mipmap.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Texturing_MipMap)
+{
+    TEST_CASE(GetMipLevelCount_GivenSinglePixelTexture_ReturnsOne)
+    {
+        const CanvasProperties props(1, 1, 32, 32, 3, PixelFormatFloat);
+
+        EXPECT_EQ(1, get_mip_level_count(props));
+    }
+
+    TEST_CASE(GetMipLevelCount_GivenNonSquareTexture_ReturnsLevelCountOfLargestDimension)
+    {
+        const CanvasProperties props(1024, 100, 32, 32, 3, PixelFormatFloat);
+
+        EXPECT_EQ(11, get_mip_level_count(props));
+    }
+
+    TEST_CASE(GetMipLevelProperties_NeverReturnsEmptyLevels)
+    {
+        const CanvasProperties base_props(1024, 100, 32, 32, 3, PixelFormatFloat);
+
+        const CanvasProperties props = get_mip_level_properties(base_props, 8);
+
+        EXPECT_EQ(4, props.m_canvas_width);
+        EXPECT_EQ(1, props.m_canvas_height);
+        EXPECT_EQ(32, props.m_tile_width);
+        EXPECT_EQ(1, props.m_tile_count);
+    }
+
+    TEST_CASE(GenerateMipTile_AveragesParentPixels)
+    {
+        // A 4x4 texture made of 2x2 tiles.
+        const CanvasProperties parent_props(4, 4, 2, 2, 3, PixelFormatFloat);
+        const CanvasProperties level_props = get_mip_level_properties(parent_props, 1);
+
+        Tile t00(2, 2, 3, PixelFormatFloat);
+        Tile t10(2, 2, 3, PixelFormatFloat);
+        Tile t01(2, 2, 3, PixelFormatFloat);
+        Tile t11(2, 2, 3, PixelFormatFloat);
+        t00.clear(Color3f(1.0f));
+        t10.clear(Color3f(2.0f));
+        t01.clear(Color3f(3.0f));
+        t11.clear(Color3f(4.0f));
+        t11.set_pixel(1, 1, Color3f(8.0f));
+
+        const Tile* parent_tiles[2][2] = { { &t00, &t10 }, { &t01, &t11 } };
+        unique_ptr<Tile> tile(generate_mip_tile(parent_props, level_props, 0, 0, parent_tiles));
+
+        ASSERT_EQ(2, tile->get_width());
+        ASSERT_EQ(2, tile->get_height());
+
+        Color3f c;
+        tile->get_pixel(0, 0, c); EXPECT_EQ(Color3f(1.0f), c);
+        tile->get_pixel(1, 0, c); EXPECT_EQ(Color3f(2.0f), c);
+        tile->get_pixel(0, 1, c); EXPECT_EQ(Color3f(3.0f), c);
+        tile->get_pixel(1, 1, c); EXPECT_EQ(Color3f(5.0f), c);
+    }
+
+    TEST_CASE(GenerateMipTile_GivenOddParentSize_ClampsToParentCanvas)
+    {
+        // A 3x1 texture made of a single tile.
+        const CanvasProperties parent_props(3, 1, 4, 4, 3, PixelFormatFloat);
+        const CanvasProperties level_props = get_mip_level_properties(parent_props, 1);
+
+        Tile t00(3, 1, 3, PixelFormatFloat);
+        t00.set_pixel(0, 0, Color3f(1.0f));
+        t00.set_pixel(1, 0, Color3f(3.0f));
+        t00.set_pixel(2, 0, Color3f(5.0f));
+
+        const Tile* parent_tiles[2][2] = { { &t00, nullptr }, { nullptr, nullptr } };
+        unique_ptr<Tile> tile(generate_mip_tile(parent_props, level_props, 0, 0, parent_tiles));
+
+        ASSERT_EQ(1, tile->get_width());
+        ASSERT_EQ(1, tile->get_height());
+
+        Color3f c;
+        tile->get_pixel(0, 0, c);
+        EXPECT_EQ(Color3f(2.0f), c);
+    }
+}
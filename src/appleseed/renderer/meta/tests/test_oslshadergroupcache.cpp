@@ -0,0 +1,128 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/rendererservices.h"
+#include "renderer/kernel/shading/oslshadergroupcache.h"
+#include "renderer/kernel/shading/oslshadingsystem.h"
+#include "renderer/kernel/texturing/oiiotexturesystem.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Shading_OSLShaderGroupCache)
+{
+    struct Fixture
+      : public TestSceneBase
+    {
+        shared_ptr<OIIOTextureSystem>   m_texture_system;
+        RendererServices                m_renderer_services;
+        shared_ptr<OSLShadingSystem>    m_shading_system;
+        OSLShaderGroupCache             m_cache;
+
+        Fixture()
+          : m_texture_system(
+                OIIOTextureSystemFactory::create(),
+                [](OIIOTextureSystem* object) { object->release(); })
+          , m_renderer_services(m_project, *m_texture_system)
+          , m_shading_system(
+                OSLShadingSystemFactory::create(&m_renderer_services, m_texture_system.get()),
+                [](OSLShadingSystem* object) { object->release(); })
+        {
+        }
+
+        ~Fixture()
+        {
+            // Cached shader groups must be released before the shading system.
+            m_cache.clear();
+        }
+
+        OSL::ShaderGroupRef create_shader_group(const char* name)
+        {
+            OSL::ShaderGroupRef shader_group_ref = m_shading_system->ShaderGroupBegin(name);
+            m_shading_system->ShaderGroupEnd();
+            return shader_group_ref;
+        }
+    };
+
+    TEST_CASE_F(Get_GivenInsertedKey_ReturnsCachedShaderGroup, Fixture)
+    {
+        const OSL::ShaderGroupRef shader_group_ref = create_shader_group("group");
+        m_cache.insert("key", shader_group_ref);
+
+        EXPECT_TRUE(m_cache.get("key") == shader_group_ref);
+    }
+
+    TEST_CASE_F(Get_GivenUnknownKey_ReturnsEmptyReference, Fixture)
+    {
+        m_cache.insert("key", create_shader_group("group"));
+
+        EXPECT_TRUE(m_cache.get("other key").get() == nullptr);
+    }
+
+    TEST_CASE_F(EvictUnused_GivenShaderGroupsStillInUse_KeepsThem, Fixture)
+    {
+        const OSL::ShaderGroupRef shader_group_ref1 = create_shader_group("group1");
+        const OSL::ShaderGroupRef shader_group_ref2 = create_shader_group("group2");
+        m_cache.insert("key1", shader_group_ref1);
+        m_cache.insert("key2", shader_group_ref2);
+
+        EXPECT_EQ(0, m_cache.evict_unused());
+
+        EXPECT_EQ(2, m_cache.size());
+        EXPECT_TRUE(m_cache.get("key1") == shader_group_ref1);
+        EXPECT_TRUE(m_cache.get("key2") == shader_group_ref2);
+    }
+
+    TEST_CASE_F(EvictUnused_GivenShaderGroupNoLongerInUse_EvictsIt, Fixture)
+    {
+        const OSL::ShaderGroupRef used_shader_group_ref = create_shader_group("used");
+        OSL::ShaderGroupRef unused_shader_group_ref = create_shader_group("unused");
+        m_cache.insert("used key", used_shader_group_ref);
+        m_cache.insert("unused key", unused_shader_group_ref);
+
+        // The scene stops using one of the shader groups.
+        unused_shader_group_ref.reset();
+
+        EXPECT_EQ(1, m_cache.evict_unused());
+
+        EXPECT_EQ(1, m_cache.size());
+        EXPECT_TRUE(m_cache.get("used key") == used_shader_group_ref);
+        EXPECT_TRUE(m_cache.get("unused key").get() == nullptr);
+    }
+}
@@ -0,0 +1,154 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sdtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/qmc.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SDTree)
+{
+    TEST_CASE(DTree_IsInitiallyInvalid)
+    {
+        const DTree dtree;
+
+        EXPECT_FALSE(dtree.is_valid());
+    }
+
+    TEST_CASE(DTree_EvaluatePdf_GivenSingleRecordedDirection_ConcentratesProbabilityAroundIt)
+    {
+        DTree building;
+        building.record(Vector3f(0.0f, 1.0f, 0.0f), 1.0f);
+
+        const DTree sampling = building;
+
+        EXPECT_GT(RcpFourPi<float>(), sampling.evaluate_pdf(Vector3f(0.0f, 1.0f, 0.0f)));
+        EXPECT_EQ(0.0f, sampling.evaluate_pdf(Vector3f(0.0f, -1.0f, 0.0f)));
+    }
+
+    TEST_CASE(DTree_Sample_ReturnsSameProbabilityAsEvaluatePdf)
+    {
+        DTree building;
+        building.record(normalize(Vector3f(1.0f, 1.0f, 0.0f)), 2.0f);
+        building.record(normalize(Vector3f(0.0f, -1.0f, 1.0f)), 1.0f);
+        building.record(normalize(Vector3f(-1.0f, 0.2f, -0.3f)), 0.5f);
+
+        DTree sampling;
+        sampling.refine(building, 0.01f, 6);
+        sampling.record(normalize(Vector3f(1.0f, 1.0f, 0.0f)), 2.0f);
+        sampling.record(normalize(Vector3f(0.0f, -1.0f, 1.0f)), 1.0f);
+        sampling.record(normalize(Vector3f(-1.0f, 0.2f, -0.3f)), 0.5f);
+
+        for (size_t i = 0; i < 64; ++i)
+        {
+            const Vector2f s(
+                radical_inverse_base2<float>(i),
+                radical_inverse<float>(3, i));
+
+            float probability;
+            const Vector3f direction = sampling.sample(s, probability);
+
+            EXPECT_FEQ_EPS(1.0f, norm(direction), 1.0e-4f);
+            EXPECT_FEQ_EPS(probability, sampling.evaluate_pdf(direction), 1.0e-3f * probability);
+        }
+    }
+
+    TEST_CASE(DTree_EvaluatePdf_IntegratesToOne)
+    {
+        DTree building;
+        building.record(normalize(Vector3f(1.0f, 1.0f, 0.0f)), 2.0f);
+        building.record(normalize(Vector3f(0.0f, -1.0f, 1.0f)), 1.0f);
+
+        DTree refined;
+        refined.refine(building, 0.01f, 6);
+        refined.record(normalize(Vector3f(1.0f, 1.0f, 0.0f)), 2.0f);
+        refined.record(normalize(Vector3f(0.0f, -1.0f, 1.0f)), 1.0f);
+
+        const size_t SampleCount = 4096;
+        float integral = 0.0f;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const Vector2f s(
+                radical_inverse_base2<float>(i),
+                radical_inverse<float>(3, i));
+
+            const Vector3f direction = sample_sphere_uniform(s);
+            integral += refined.evaluate_pdf(direction) * FourPi<float>();
+        }
+
+        EXPECT_FEQ_EPS(1.0f, integral / SampleCount, 0.05f);
+    }
+
+    TEST_CASE(DTree_Refine_OnlySubdividesQuadrantsAboveThreshold)
+    {
+        DTree building;
+        building.record(Vector3f(0.0f, 1.0f, 0.0f), 1.0f);
+
+        DTree refined;
+        refined.refine(building, 0.3f, 20);
+
+        // The quadrant holding all the energy is split once; its children
+        // are only expected to hold a quarter of the energy each.
+        EXPECT_EQ(2, refined.get_node_count());
+        EXPECT_FALSE(refined.is_valid());
+    }
+
+    TEST_CASE(SDTree_Refine_SplitsCellsThatReceivedManySamples)
+    {
+        SDTree sd_tree(
+            AABB3d(Vector3d(0.0), Vector3d(1.0)),
+            0.5f,       // bsdf sampling fraction
+            10.0f,      // spatial threshold
+            0.01f,      // directional threshold
+            20);        // max directional depth
+
+        for (size_t i = 0; i < 15; ++i)
+            sd_tree.record(Vector3d(0.25), Vector3f(0.0f, 1.0f, 0.0f), 1.0f);
+
+        EXPECT_EQ(nullptr, sd_tree.get_sampling_dtree(Vector3d(0.25)));
+
+        sd_tree.refine();
+
+        EXPECT_EQ(2, sd_tree.get_leaf_count());
+        EXPECT_NEQ(nullptr, sd_tree.get_sampling_dtree(Vector3d(0.25)));
+        EXPECT_EQ(1, sd_tree.get_iteration());
+    }
+}
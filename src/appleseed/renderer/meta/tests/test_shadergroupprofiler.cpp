@@ -0,0 +1,113 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/kernel/shading/shadergroupprofiler.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Shading_ShaderGroupProfiler)
+{
+    TEST_CASE(Finalize_MergesStreamsAndSortsShaderGroupsByDecreasingCycleCount)
+    {
+        auto_release_ptr<ShaderGroup> cheap_group(ShaderGroupFactory::create("cheap"));
+        auto_release_ptr<ShaderGroup> expensive_group(ShaderGroupFactory::create("expensive"));
+
+        ShaderGroupProfiler profiler;
+        ShaderGroupProfileStream* stream1 = profiler.create_stream();
+        ShaderGroupProfileStream* stream2 = profiler.create_stream();
+
+        stream1->record(cheap_group.ref(), 10, 1);
+        stream1->record(expensive_group.ref(), 100, 2);
+        stream2->record(expensive_group.ref(), 200, 4);
+        stream2->record(cheap_group.ref(), 20, 1);
+
+        profiler.finalize();
+
+        ASSERT_EQ(2, profiler.get_shader_group_count());
+
+        EXPECT_EQ(string(expensive_group->get_path().c_str()), profiler.get_shader_group_path(0));
+        EXPECT_EQ(2, profiler.get_shader_group_profile(0).m_execution_count);
+        EXPECT_EQ(300, profiler.get_shader_group_profile(0).m_cycle_count);
+        EXPECT_EQ(6, profiler.get_shader_group_profile(0).m_closure_count);
+
+        EXPECT_EQ(string(cheap_group->get_path().c_str()), profiler.get_shader_group_path(1));
+        EXPECT_EQ(2, profiler.get_shader_group_profile(1).m_execution_count);
+        EXPECT_EQ(30, profiler.get_shader_group_profile(1).m_cycle_count);
+        EXPECT_EQ(2, profiler.get_shader_group_profile(1).m_closure_count);
+    }
+
+    TEST_CASE(Clear_DiscardsCountersButKeepsStreams)
+    {
+        auto_release_ptr<ShaderGroup> shader_group(ShaderGroupFactory::create("shader_group"));
+
+        ShaderGroupProfiler profiler;
+        ShaderGroupProfileStream* stream = profiler.create_stream();
+
+        stream->record(shader_group.ref(), 10, 1);
+        profiler.finalize();
+        profiler.clear();
+        EXPECT_EQ(0, profiler.get_shader_group_count());
+
+        stream->record(shader_group.ref(), 20, 2);
+        profiler.finalize();
+
+        ASSERT_EQ(1, profiler.get_shader_group_count());
+        EXPECT_EQ(1, profiler.get_shader_group_profile(0).m_execution_count);
+        EXPECT_EQ(20, profiler.get_shader_group_profile(0).m_cycle_count);
+    }
+
+    TEST_CASE(ClearStreams_DiscardsStreams)
+    {
+        auto_release_ptr<ShaderGroup> shader_group(ShaderGroupFactory::create("shader_group"));
+
+        ShaderGroupProfiler profiler;
+        profiler.create_stream()->record(shader_group.ref(), 10, 1);
+        profiler.clear_streams();
+
+        profiler.create_stream()->record(shader_group.ref(), 20, 2);
+        profiler.finalize();
+
+        ASSERT_EQ(1, profiler.get_shader_group_count());
+        EXPECT_EQ(1, profiler.get_shader_group_profile(0).m_execution_count);
+        EXPECT_EQ(20, profiler.get_shader_group_profile(0).m_cycle_count);
+    }
+}
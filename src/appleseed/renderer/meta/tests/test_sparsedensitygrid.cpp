@@ -0,0 +1,158 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/sparsedensitygrid.h"
+#include "renderer/kernel/volume/volume.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/qmc.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Volume_SparseDensityGrid)
+{
+    struct Fixture
+    {
+        VoxelGrid   m_voxel_grid;
+
+        // A 40x20x60 grid whose density is nonzero only in a small box.
+        Fixture()
+          : m_voxel_grid(40, 20, 60, 2)
+        {
+            for (size_t z = 0; z < 60; ++z)
+            {
+                for (size_t y = 0; y < 20; ++y)
+                {
+                    for (size_t x = 0; x < 40; ++x)
+                    {
+                        float* values = m_voxel_grid.voxel(x, y, z);
+                        values[0] = 1.0f;
+                        values[1] = x > 10 && x < 20 && z > 40 && z < 50 ? (x + y) / 40.0f : 0.0f;
+                    }
+                }
+            }
+        }
+    };
+
+    struct SegmentCollector
+    {
+        const SparseDensityGrid&    m_grid;
+        const Vector3f              m_org;
+        const Vector3f              m_dir;
+        float                       m_last_t1;
+        size_t                      m_error_count;
+
+        SegmentCollector(
+            const SparseDensityGrid&    grid,
+            const Vector3f&             org,
+            const Vector3f&             dir)
+          : m_grid(grid)
+          , m_org(org)
+          , m_dir(dir)
+          , m_last_t1(0.0f)
+          , m_error_count(0)
+        {
+        }
+
+        bool operator()(const float t0, const float t1, const float majorant)
+        {
+            // Segments must be visited front to back.
+            if (t0 < m_last_t1 - 1.0e-4f)
+                ++m_error_count;
+            m_last_t1 = t1;
+
+            // The majorant must bound the density over the whole segment.
+            for (size_t i = 0; i <= 16; ++i)
+            {
+                const float t = t0 + (t1 - t0) * (i / 16.0f);
+                if (m_grid.lookup(m_org + t * m_dir) > majorant + 1.0e-5f)
+                    ++m_error_count;
+            }
+
+            return true;
+        }
+    };
+
+    TEST_CASE_F(Constructor_StoresOnlyNonEmptyBricks, Fixture)
+    {
+        const SparseDensityGrid grid(m_voxel_grid, 1);
+
+        EXPECT_EQ(40, grid.get_xres());
+        EXPECT_EQ(20, grid.get_yres());
+        EXPECT_EQ(60, grid.get_zres());
+        EXPECT_LT(grid.get_stored_brick_count() * 4, grid.get_brick_count());
+        EXPECT_FEQ(38.0f / 40.0f, grid.get_max_density());
+    }
+
+    TEST_CASE_F(Lookup_AtVoxelCenter_ReturnsVoxelValue, Fixture)
+    {
+        const SparseDensityGrid grid(m_voxel_grid, 1);
+
+        EXPECT_FEQ(m_voxel_grid.voxel(15, 3, 45)[1], grid.lookup(Vector3f(15.5f, 3.5f, 45.5f)));
+        EXPECT_EQ(0.0f, grid.lookup(Vector3f(2.5f, 3.5f, 5.5f)));
+        EXPECT_EQ(0.0f, grid.lookup(Vector3f(-10.0f, 3.5f, 45.5f)));
+    }
+
+    TEST_CASE_F(Traverse_MajorantsBoundDensity, Fixture)
+    {
+        const SparseDensityGrid grid(m_voxel_grid, 1);
+
+        size_t error_count = 0;
+
+        for (size_t i = 0; i < 256; ++i)
+        {
+            const Vector3f org(
+                -10.0f + 60.0f * radical_inverse_base2<float>(i),
+                -10.0f + 40.0f * radical_inverse<float>(3, i),
+                -10.0f + 80.0f * radical_inverse<float>(5, i));
+            const Vector3f target(15.0f, 10.0f, 45.0f);
+            const Vector3f dir = normalize(target - org);
+
+            SegmentCollector collector(grid, org, dir);
+            grid.traverse(org, dir, 0.0f, 200.0f, collector);
+            error_count += collector.m_error_count;
+        }
+
+        EXPECT_EQ(0, error_count);
+    }
+
+    TEST_CASE_F(GetMaxDensity_GivenRayMissingNonEmptyBricks_ReturnsZero, Fixture)
+    {
+        const SparseDensityGrid grid(m_voxel_grid, 1);
+
+        EXPECT_EQ(0.0f, grid.get_max_density(Vector3f(0.5f, 10.0f, 0.5f), Vector3f(1.0f, 0.0f, 0.0f), 0.0f, 100.0f));
+        EXPECT_LT(0.0f, grid.get_max_density(Vector3f(0.5f, 10.0f, 45.5f), Vector3f(1.0f, 0.0f, 0.0f), 0.0f, 100.0f));
+    }
+}
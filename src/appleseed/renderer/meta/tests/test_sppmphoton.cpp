@@ -0,0 +1,131 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/lighting/sppm/sppmphoton.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SPPM_SPPMPhoton)
+{
+    Vector3f random_direction(MersenneTwister& rng)
+    {
+        return sample_sphere_uniform(rand_vector2<Vector2f>(rng));
+    }
+
+    TEST_CASE(CompactMonoPhoton_Decode_ReturnsOriginalPhotonWithinPrecision)
+    {
+        MersenneTwister rng;
+
+        bool accurate = true;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            SPPMMonoPhoton photon;
+            photon.m_incoming = random_direction(rng);
+            photon.m_geometric_normal = random_direction(rng);
+            photon.m_flux.m_wavelength = static_cast<uint32>(i % 31);
+            photon.m_flux.m_amplitude = rand_float1(rng) * 1.0e-4f;
+
+            const SPPMMonoPhoton decoded = SPPMCompactMonoPhoton(photon).decode();
+
+            if (dot(decoded.m_incoming, photon.m_incoming) < 0.99999f ||
+                dot(decoded.m_geometric_normal, photon.m_geometric_normal) < 0.9999f ||
+                decoded.m_flux.m_wavelength != photon.m_flux.m_wavelength ||
+                decoded.m_flux.m_amplitude != photon.m_flux.m_amplitude)
+                accurate = false;
+        }
+
+        EXPECT_TRUE(accurate);
+    }
+
+    TEST_CASE(CompactPolyPhoton_Decode_ReturnsOriginalPhotonWithinPrecision)
+    {
+        const Spectrum::Mode old_mode = Spectrum::set_mode(Spectrum::Spectral);
+
+        MersenneTwister rng;
+
+        bool accurate = true;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            SPPMPolyPhoton photon;
+            photon.m_incoming = random_direction(rng);
+            photon.m_geometric_normal = random_direction(rng);
+            for (size_t j = 0; j < Spectrum::size(); ++j)
+                photon.m_flux[j] = rand_float1(rng) * 1.0e-6f;
+
+            const SPPMPolyPhoton decoded = SPPMCompactPolyPhoton(photon).decode();
+
+            if (dot(decoded.m_incoming, photon.m_incoming) < 0.99999f ||
+                dot(decoded.m_geometric_normal, photon.m_geometric_normal) < 0.99999f)
+                accurate = false;
+
+            // Components are quantized to 1/256 of the largest power of two below the largest one.
+            const float tolerance = max_value(photon.m_flux) / 256.0f;
+            for (size_t j = 0; j < Spectrum::size(); ++j)
+            {
+                if (std::abs(decoded.m_flux[j] - photon.m_flux[j]) > tolerance)
+                    accurate = false;
+            }
+        }
+
+        EXPECT_TRUE(accurate);
+
+        Spectrum::set_mode(old_mode);
+    }
+
+    TEST_CASE(CompactPolyPhoton_GivenZeroFlux_DecodesZeroFlux)
+    {
+        SPPMPolyPhoton photon;
+        photon.m_incoming = Vector3f(0.0f, 0.0f, -1.0f);
+        photon.m_geometric_normal = Vector3f(0.0f, 1.0f, 0.0f);
+        photon.m_flux.set(0.0f);
+
+        const SPPMPolyPhoton decoded = SPPMCompactPolyPhoton(photon).decode();
+
+        EXPECT_EQ(0.0f, max_value(decoded.m_flux));
+        EXPECT_FEQ_EPS(Vector3f(0.0f, 0.0f, -1.0f), decoded.m_incoming, 1.0e-4f);
+        EXPECT_FEQ_EPS(Vector3f(0.0f, 1.0f, 0.0f), decoded.m_geometric_normal, 1.0e-4f);
+    }
+}
@@ -29,10 +29,25 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/test.h"
+#include "foundation/utility/uid.h"
 
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
 using namespace renderer;
 
 TEST_SUITE(Renderer_Kernel_Texturing_TextureStore_TileKey)
@@ -45,5 +60,167 @@ TEST_SUITE(Renderer_Kernel_Texturing_TextureStore_TileKey)
         EXPECT_EQ(12345, key.m_texture_uid);
         EXPECT_EQ(32323, key.get_tile_x());
         EXPECT_EQ(56565, key.get_tile_y());
+        EXPECT_EQ(0, key.get_level());
+    }
+
+    TEST_CASE(KeysOfDifferentMipLevelsAreDifferent)
+    {
+        const TextureStore::TileKey key0(123, 12345, 3, 5, 0);
+        const TextureStore::TileKey key1(123, 12345, 3, 5, 1);
+
+        EXPECT_EQ(1, key1.get_level());
+        EXPECT_TRUE(key0 != key1);
+        EXPECT_TRUE(key0 < key1);
+    }
+}
+
+TEST_SUITE(Renderer_Kernel_Texturing_TextureStore)
+{
+    // A texture made of 8x8 tiles of 4x4 pixels, counting tile loads and unloads.
+    class TiledTexture
+      : public Texture
+    {
+      public:
+        static const size_t TileCount = 8;
+        static const size_t TileSize = 4;
+
+        size_t m_load_count;
+        size_t m_unload_count;
+
+        explicit TiledTexture(const char* name)
+          : Texture(name, ParamArray())
+          , m_load_count(0)
+          , m_unload_count(0)
+          , m_props(
+                TileCount * TileSize, TileCount * TileSize,
+                TileSize, TileSize,
+                3,
+                PixelFormatFloat)
+        {
+        }
+
+        void release() override
+        {
+            delete this;
+        }
+
+        const char* get_model() const override
+        {
+            return "tiled_texture";
+        }
+
+        ColorSpace get_color_space() const override
+        {
+            return ColorSpaceLinearRGB;
+        }
+
+        const CanvasProperties& properties() override
+        {
+            return m_props;
+        }
+
+        Source* create_source(
+            const UniqueID          assembly_uid,
+            const TextureInstance&  texture_instance) override
+        {
+            return nullptr;
+        }
+
+        Tile* load_tile(
+            const size_t            tile_x,
+            const size_t            tile_y) override
+        {
+            ++m_load_count;
+
+            return
+                new Tile(
+                    m_props.m_tile_width,
+                    m_props.m_tile_height,
+                    m_props.m_channel_count,
+                    m_props.m_pixel_format);
+        }
+
+        void unload_tile(
+            const size_t            tile_x,
+            const size_t            tile_y,
+            const Tile*             tile) override
+        {
+            ++m_unload_count;
+            delete tile;
+        }
+
+      private:
+        const CanvasProperties  m_props;
+    };
+
+    struct Fixture
+      : public TestSceneBase
+    {
+        TiledTexture* m_texture;
+
+        Fixture()
+        {
+            auto_release_ptr<Texture> texture(new TiledTexture("texture"));
+            m_texture = static_cast<TiledTexture*>(texture.get());
+            m_scene.textures().insert(texture);
+        }
+
+        void acquire_and_release_all_tiles(TextureStore& store)
+        {
+            for (size_t y = 0; y < TiledTexture::TileCount; ++y)
+            {
+                for (size_t x = 0; x < TiledTexture::TileCount; ++x)
+                {
+                    TextureStore::TileRecord& record =
+                        store.acquire(TextureStore::TileKey(~UniqueID(0), m_texture->get_uid(), x, y));
+                    store.release(record);
+                }
+            }
+        }
+
+        size_t get_loaded_tile_count() const
+        {
+            return m_texture->m_load_count - m_texture->m_unload_count;
+        }
+    };
+
+    TEST_CASE_F(Acquire_GivenTilesSpreadOverShards_LoadsEachTileOnce, Fixture)
+    {
+        ParamArray params;
+        params.insert("shard_count", 8);
+
+        TextureStore store(m_scene, params);
+
+        acquire_and_release_all_tiles(store);
+        acquire_and_release_all_tiles(store);
+
+        EXPECT_EQ(TiledTexture::TileCount * TiledTexture::TileCount, m_texture->m_load_count);
+        EXPECT_EQ(0, m_texture->m_unload_count);
+    }
+
+    TEST_CASE_F(Acquire_GivenMoreTilesThanFitInMemory_HonorsMemoryLimitAcrossShards, Fixture)
+    {
+        const Tile tile(TiledTexture::TileSize, TiledTexture::TileSize, 3, PixelFormatFloat);
+        const size_t MaxLoadedTileCount = 4;
+
+        ParamArray params;
+        params.insert("shard_count", 16);
+        params.insert("max_size", MaxLoadedTileCount * tile.get_memory_size());
+
+        TextureStore store(m_scene, params);
+
+        for (size_t y = 0; y < TiledTexture::TileCount; ++y)
+        {
+            for (size_t x = 0; x < TiledTexture::TileCount; ++x)
+            {
+                TextureStore::TileRecord& record =
+                    store.acquire(TextureStore::TileKey(~UniqueID(0), m_texture->get_uid(), x, y));
+                store.release(record);
+
+                EXPECT_TRUE(get_loaded_tile_count() <= MaxLoadedTileCount);
+            }
+        }
+
+        EXPECT_EQ(TiledTexture::TileCount * TiledTexture::TileCount, m_texture->m_load_count);
     }
 }
@@ -221,7 +221,7 @@ TEST_SUITE(Renderer_Kernel_Lighting_Tracer)
         Tracer                                  m_tracer;
 
         Fixture()
-          : m_trace_context(Base::m_scene)
+          : m_trace_context(Base::m_scene, 1)
           , m_texture_store(Base::m_scene)
           , m_texture_cache(m_texture_store)
           , m_intersector(m_trace_context, m_texture_cache)
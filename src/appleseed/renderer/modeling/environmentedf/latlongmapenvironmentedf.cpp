@@ -57,11 +57,14 @@
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/defaulttimers.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
 #include <cassert>
@@ -90,20 +93,23 @@ namespace
     //   http://www.cs.kuleuven.be/~graphics/index.php/environment-maps
     //
 
-    typedef ImageImportanceSampler<Color3f, float> ImageImportanceSamplerType;
+    typedef AliasImageImportanceSampler<Color3f, float> ImageImportanceSamplerType;
 
+    // Copies of this sampler are used concurrently by multiple threads,
+    // so each copy has its own texture cache.
     class ImageSampler
     {
       public:
         ImageSampler(
-            TextureCache&   texture_cache,
+            TextureStore&   texture_store,
             const Source*   radiance_source,
             const Source*   multiplier_source,
             const Source*   exposure_source,
             const Source*   exposure_multiplier_source,
             const size_t    width,
             const size_t    height)
-          : m_texture_cache(texture_cache)
+          : m_texture_store(texture_store)
+          , m_texture_cache(texture_store)
           , m_radiance_source(radiance_source)
           , m_multiplier_source(multiplier_source)
           , m_exposure_source(exposure_source)
@@ -113,6 +119,18 @@ namespace
         {
         }
 
+        ImageSampler(const ImageSampler& rhs)
+          : m_texture_store(rhs.m_texture_store)
+          , m_texture_cache(rhs.m_texture_store)
+          , m_radiance_source(rhs.m_radiance_source)
+          , m_multiplier_source(rhs.m_multiplier_source)
+          , m_exposure_source(rhs.m_exposure_source)
+          , m_exposure_multiplier_source(rhs.m_exposure_multiplier_source)
+          , m_rcp_width(rhs.m_rcp_width)
+          , m_rcp_height(rhs.m_rcp_height)
+        {
+        }
+
         void sample(const size_t x, const size_t y, Color3f& payload, float& importance)
         {
             if (m_radiance_source == nullptr)
@@ -150,7 +168,8 @@ namespace
         }
 
       private:
-        TextureCache&   m_texture_cache;
+        TextureStore&   m_texture_store;
+        TextureCache    m_texture_cache;
         const Source*   m_radiance_source;
         const Source*   m_multiplier_source;
         const Source*   m_exposure_source;
@@ -172,6 +191,7 @@ namespace
           , m_importance_map_width(0)
           , m_importance_map_height(0)
           , m_probability_scale(0.0f)
+          , m_importance_map_signature(0)
         {
             m_inputs.declare("radiance", InputFormatSpectralIlluminance);
             m_inputs.declare("radiance_multiplier", InputFormatFloat, "1.0");
@@ -207,8 +227,13 @@ namespace
             {
                 check_non_zero_emission("radiance", "radiance_multiplier");
 
-                if (m_importance_sampler.get() == nullptr)
-                    build_importance_map(*project.get_scene(), abort_switch);
+                // Only rebuild the importance map if the environment map or its modifiers changed.
+                const uint64 signature = compute_importance_map_signature();
+                if (m_importance_sampler.get() == nullptr || signature != m_importance_map_signature)
+                {
+                    build_importance_map(project, abort_switch);
+                    m_importance_map_signature = signature;
+                }
             }
 
             return true;
@@ -379,8 +404,18 @@ namespace
         float   m_probability_scale;
 
         unique_ptr<ImageImportanceSamplerType> m_importance_sampler;
+        uint64  m_importance_map_signature;
+
+        uint64 compute_importance_map_signature() const
+        {
+            uint64 signature = m_inputs.source("radiance")->compute_signature();
+            signature = combine_signatures(signature, m_inputs.source("radiance_multiplier")->compute_signature());
+            signature = combine_signatures(signature, m_inputs.source("exposure")->compute_signature());
+            signature = combine_signatures(signature, m_inputs.source("exposure_multiplier")->compute_signature());
+            return signature;
+        }
 
-        void build_importance_map(const Scene& scene, IAbortSwitch*abort_switch)
+        void build_importance_map(const Project& project, IAbortSwitch* abort_switch)
         {
             const Source* radiance_source = m_inputs.source("radiance");
             assert(radiance_source);
@@ -395,10 +430,9 @@ namespace
             const size_t texel_count = m_importance_map_width * m_importance_map_height;
             m_probability_scale = texel_count / (2.0f * PiSquare<float>());
 
-            TextureStore texture_store(scene);
-            TextureCache texture_cache(texture_store);
+            TextureStore texture_store(*project.get_scene());
             ImageSampler sampler(
-                texture_cache,
+                texture_store,
                 radiance_source,
                 m_inputs.source("radiance_multiplier"),
                 m_inputs.source("exposure"),
@@ -418,15 +452,25 @@ namespace
                 m_importance_map_height,
                 get_path().c_str());
 
-            m_importance_sampler->rebuild(sampler, abort_switch);
+            Stopwatch<DefaultWallclockTimer> stopwatch;
+            stopwatch.start();
+
+            m_importance_sampler->rebuild(
+                sampler,
+                global_logger(),
+                project.get_rendering_thread_count(),
+                abort_switch);
 
             if (is_aborted(abort_switch))
                 m_importance_sampler.reset();
             else
             {
+                stopwatch.measure();
                 RENDERER_LOG_INFO(
-                    "built importance map for environment edf \"%s\".",
-                    get_path().c_str());
+                    "built importance map for environment edf \"%s\" in %s (%s).",
+                    get_path().c_str(),
+                    pretty_time(stopwatch.get_seconds()).c_str(),
+                    pretty_size(m_importance_sampler->get_memory_size()).c_str());
             }
         }
 
@@ -61,6 +61,7 @@
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/iostreamop.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
@@ -71,6 +72,7 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <vector>
 
 using namespace bcd;
 using namespace foundation;
@@ -90,6 +92,22 @@ namespace
     const UniqueID g_class_uid = new_guid();
 
     const string DefaultRenderStampFormat = "appleseed {lib-version} | Time: {render-time}";
+
+    // Background image writes are meant to overlap with rendering: keep them from competing with it.
+    const size_t MaxBackgroundWriteThreadCount = 2;
+
+    // A request to write an image to disk.
+    struct ImageWriteRequest
+    {
+        string              m_file_path;
+        const Image*        m_image;
+        unique_ptr<Image>   m_image_copy;       // private copy of the image, for background writes
+        const AOV*          m_aov;
+        bool                m_convert_to_half;  // convert the image to half floats before writing it
+        bool                m_success;
+    };
+
+    typedef vector<unique_ptr<ImageWriteRequest>> ImageWriteRequestVector;
 }
 
 UniqueID Frame::get_class_uid()
@@ -120,6 +138,11 @@ struct Frame::Impl
     AOVContainer            m_internal_aovs;
     DenoiserAOV*            m_denoiser_aov;
     vector<size_t>          m_extra_aovs;
+
+    // Background image writing.
+    JobQueue                m_write_job_queue;
+    unique_ptr<JobManager>  m_write_job_manager;
+    ImageWriteRequestVector m_pending_writes;
 };
 
 Frame::Frame(
@@ -200,6 +223,9 @@ Frame::Frame(
 
 Frame::~Frame()
 {
+    wait_for_pending_image_writes();
+    impl->m_write_job_manager.reset();
+
     delete impl;
 }
 
@@ -702,6 +728,132 @@ namespace
 
         return true;
     }
+
+    class WriteImageJob
+      : public IJob
+    {
+      public:
+        explicit WriteImageJob(ImageWriteRequest& request)
+          : m_request(request)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            if (m_request.m_convert_to_half)
+            {
+                const CanvasProperties& props = m_request.m_image->properties();
+                const Image half_image(*m_request.m_image, props.m_tile_width, props.m_tile_height, PixelFormatHalf);
+                m_request.m_success = write_image(m_request.m_file_path.c_str(), half_image, m_request.m_aov);
+            }
+            else
+            {
+                m_request.m_success = write_image(m_request.m_file_path.c_str(), *m_request.m_image, m_request.m_aov);
+            }
+        }
+
+      private:
+        ImageWriteRequest&  m_request;
+    };
+
+    // Collect the main image and the AOV images that have an output file path.
+    // If copy_images is true, requests hold a private copy of their image.
+    void collect_main_and_aov_image_writes(
+        const Frame&                frame,
+        const bool                  copy_images,
+        ImageWriteRequestVector&    requests)
+    {
+        // Main image.
+        {
+            const string filepath = frame.get_parameters().get_optional<string>("output_filename");
+            if (!filepath.empty())
+            {
+                unique_ptr<ImageWriteRequest> request(new ImageWriteRequest());
+                request->m_file_path = filepath;
+                request->m_aov = nullptr;
+                request->m_success = false;
+
+                // The main image is always saved as half floats.
+                if (copy_images)
+                {
+                    const CanvasProperties& props = frame.image().properties();
+                    request->m_image_copy.reset(
+                        new Image(frame.image(), props.m_tile_width, props.m_tile_height, PixelFormatHalf));
+                    request->m_image = request->m_image_copy.get();
+                    request->m_convert_to_half = false;
+                }
+                else
+                {
+                    request->m_image = &frame.image();
+                    request->m_convert_to_half = true;
+                }
+
+                requests.push_back(move(request));
+            }
+        }
+
+        // AOV images.
+        for (size_t i = 0, e = frame.aovs().size(); i < e; ++i)
+        {
+            const AOV* aov = frame.aovs().get_by_index(i);
+            bf::path filepath = aov->get_parameters().get_optional<string>("output_filename");
+            if (!filepath.empty())
+            {
+                const bf::path filepath_ext = filepath.extension();
+                if (filepath_ext != ".exr")
+                {
+                    bf::path new_filepath(filepath);
+                    new_filepath.replace_extension(".exr");
+
+                    if (has_extension(filepath_ext))
+                    {
+                        RENDERER_LOG_WARNING(
+                            "aov \"%s\" cannot be saved to %s file; saving it to \"%s\" instead.",
+                            aov->get_path().c_str(),
+                            filepath_ext.string().substr(1).c_str(),
+                            new_filepath.string().c_str());
+                    }
+
+                    filepath = new_filepath;
+                }
+
+                unique_ptr<ImageWriteRequest> request(new ImageWriteRequest());
+                request->m_file_path = filepath.string();
+                request->m_aov = aov;
+                request->m_convert_to_half = false;
+                request->m_success = false;
+
+                if (copy_images)
+                {
+                    request->m_image_copy.reset(new Image(aov->get_image()));
+                    request->m_image = request->m_image_copy.get();
+                }
+                else request->m_image = &aov->get_image();
+
+                requests.push_back(move(request));
+            }
+        }
+    }
+
+    void schedule_image_writes(
+        JobQueue&                   job_queue,
+        ImageWriteRequestVector&    requests,
+        const size_t                first_request)
+    {
+        for (size_t i = first_request, e = requests.size(); i < e; ++i)
+            job_queue.schedule(new WriteImageJob(*requests[i]));
+    }
+
+    bool all_succeeded(const ImageWriteRequestVector& requests)
+    {
+        for (size_t i = 0, e = requests.size(); i < e; ++i)
+        {
+            if (!requests[i]->m_success)
+                return false;
+        }
+
+        return true;
+    }
 }
 
 bool Frame::write_main_image(const char* file_path) const
@@ -791,50 +943,83 @@ bool Frame::write_aov_images(const char* file_path) const
     return success;
 }
 
-bool Frame::write_main_and_aov_images() const
+bool Frame::write_main_and_aov_images(const size_t thread_count) const
 {
+    ImageWriteRequestVector requests;
+    collect_main_and_aov_image_writes(*this, false, requests);
+
     bool success = true;
 
-    // Write main image.
+    // Write all images in parallel. OpenEXR additionally compresses the tiles
+    // of each image in parallel using its own thread pool.
+    if (!requests.empty())
     {
-        const string filepath = get_parameters().get_optional<string>("output_filename");
-        if (!filepath.empty())
-        {
-            if (!write_main_image(filepath.c_str()))
-                success = false;
-        }
+        JobQueue job_queue;
+        schedule_image_writes(job_queue, requests, 0);
+
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            max<size_t>(min(requests.size(), thread_count), 1));
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        success = all_succeeded(requests);
     }
 
-    // Write AOV images.
-    for (size_t i = 0, e = aovs().size(); i < e; ++i)
+    // Write BCD histograms and covariances if enabled.
+    const string filepath = get_parameters().get_optional<string>("output_filename");
+    if (!filepath.empty() && impl->m_denoising_mode == DenoisingMode::WriteOutputs)
     {
-        const AOV* aov = aovs().get_by_index(i);
-        bf::path filepath = aov->get_parameters().get_optional<string>("output_filename");
-        if (!filepath.empty())
-        {
-            const bf::path filepath_ext = filepath.extension();
-            if (filepath_ext != ".exr")
-            {
-                bf::path new_filepath(filepath);
-                new_filepath.replace_extension(".exr");
+        bf::path boost_file_path(filepath);
+        boost_file_path.replace_extension(".exr");
 
-                if (has_extension(filepath_ext))
-                {
-                    RENDERER_LOG_WARNING(
-                        "aov \"%s\" cannot be saved to %s file; saving it to \"%s\" instead.",
-                        aov->get_path().c_str(),
-                        filepath_ext.string().substr(1).c_str(),
-                        new_filepath.string().c_str());
-                }
+        if (!impl->m_denoiser_aov->write_images(boost_file_path.string().c_str()))
+            success = false;
+    }
 
-                filepath = new_filepath;
-            }
+    return success;
+}
 
-            if (!write_image(filepath.string().c_str(), aov->get_image(), aov))
-                success = false;
-        }
+void Frame::write_main_and_aov_images_async(const size_t thread_count) const
+{
+    // Copy the images so that the frame can be rendered to while they are written.
+    const size_t first_request = impl->m_pending_writes.size();
+    collect_main_and_aov_image_writes(*this, true, impl->m_pending_writes);
+
+    if (impl->m_write_job_manager.get() == nullptr)
+    {
+        impl->m_write_job_manager.reset(
+            new JobManager(
+                global_logger(),
+                impl->m_write_job_queue,
+                clamp<size_t>(thread_count, 1, MaxBackgroundWriteThreadCount),
+                JobManager::KeepRunningOnEmptyQueue));
+        impl->m_write_job_manager->start();
     }
 
+    schedule_image_writes(impl->m_write_job_queue, impl->m_pending_writes, first_request);
+
+    // BCD histograms and covariances are written synchronously.
+    const string filepath = get_parameters().get_optional<string>("output_filename");
+    if (!filepath.empty() && impl->m_denoising_mode == DenoisingMode::WriteOutputs)
+    {
+        bf::path boost_file_path(filepath);
+        boost_file_path.replace_extension(".exr");
+        impl->m_denoiser_aov->write_images(boost_file_path.string().c_str());
+    }
+}
+
+bool Frame::wait_for_pending_image_writes() const
+{
+    if (impl->m_pending_writes.empty())
+        return true;
+
+    impl->m_write_job_queue.wait_until_completion();
+
+    const bool success = all_succeeded(impl->m_pending_writes);
+    impl->m_pending_writes.clear();
+
     return success;
 }
 
@@ -169,10 +169,20 @@ class APPLESEED_DLLSYMBOL Frame
     // Return true if successful, false otherwise.
     bool write_aov_images(const char* file_path) const;
 
-    // Write the main image and the AOV images to disk.
+    // Write the main image and the AOV images to disk. Images are written in parallel
+    // using up to `thread_count` threads (typically the number of rendering threads).
     // Output file paths are taken from the frame's and AOVs' "output_filename" parameters.
     // Return true if successful, false otherwise.
-    bool write_main_and_aov_images() const;
+    bool write_main_and_aov_images(const size_t thread_count) const;
+
+    // Same as write_main_and_aov_images() but images are copied and written in the
+    // background, so that the frame can be rendered to again right away. To leave the
+    // processor to the next render, at most two of the `thread_count` threads are used.
+    void write_main_and_aov_images_async(const size_t thread_count) const;
+
+    // Wait until all images written in the background are on disk.
+    // Return true if all of them were successfully written, false otherwise.
+    bool wait_for_pending_image_writes() const;
 
     // Write the main image and the AOV images to a multipart OpenEXR file.
     void write_main_and_aov_images_to_multipart_exr(const char* file_path) const;
@@ -35,6 +35,26 @@ namespace renderer
 SourceInputs::SourceInputs(const foundation::Vector2f& uv)
     : m_uv_x(uv.x)
     , m_uv_y(uv.y)
+    , m_duvdx_x(0.0f)
+    , m_duvdx_y(0.0f)
+    , m_duvdy_x(0.0f)
+    , m_duvdy_y(0.0f)
+    , m_point_x(0)
+    , m_point_y(0)
+    , m_point_z(0)
+{
+}
+
+SourceInputs::SourceInputs(
+    const foundation::Vector2f& uv,
+    const foundation::Vector2f& duvdx,
+    const foundation::Vector2f& duvdy)
+    : m_uv_x(uv.x)
+    , m_uv_y(uv.y)
+    , m_duvdx_x(duvdx.x)
+    , m_duvdx_y(duvdx.y)
+    , m_duvdy_x(duvdy.x)
+    , m_duvdy_y(duvdy.y)
     , m_point_x(0)
     , m_point_y(0)
     , m_point_z(0)
@@ -43,8 +43,17 @@ class APPLESEED_DLLSYMBOL SourceInputs
   public:
     explicit SourceInputs(const foundation::Vector2f& uv);
 
+    SourceInputs(
+        const foundation::Vector2f& uv,
+        const foundation::Vector2f& duvdx,
+        const foundation::Vector2f& duvdy);
+
     float       m_uv_x;           // texture coordinates from UV set #0
     float       m_uv_y;
+    float       m_duvdx_x;        // screen space partial derivatives of the texture coordinates, zero if unknown
+    float       m_duvdx_y;
+    float       m_duvdy_x;
+    float       m_duvdy_y;
     double      m_point_x;        // world space intersection point
     double      m_point_y;
     double      m_point_z;
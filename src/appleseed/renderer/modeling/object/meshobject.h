@@ -92,12 +92,14 @@ class APPLESEED_DLLSYMBOL MeshObject
     // Insert and access vertices.
     void reserve_vertices(const size_t count);
     size_t push_vertex(const GVector3& vertex);
+    size_t push_vertices(const GVector3* vertices, const size_t count);
     size_t get_vertex_count() const;
     const GVector3& get_vertex(const size_t index) const;
 
     // Insert and access vertex normals.
     void reserve_vertex_normals(const size_t count);
     size_t push_vertex_normal(const GVector3& normal);      // the normal must be unit-length
+    size_t push_vertex_normals(const GVector3* normals, const size_t count);
     size_t get_vertex_normal_count() const;
     const GVector3& get_vertex_normal(const size_t index) const;
     void clear_vertex_normals();
@@ -111,12 +113,14 @@ class APPLESEED_DLLSYMBOL MeshObject
     // Insert and access texture coordinates.
     void reserve_tex_coords(const size_t count);
     size_t push_tex_coords(const GVector2& tex_coords);
+    size_t push_tex_coords(const GVector2* tex_coords, const size_t count);
     size_t get_tex_coords_count() const;
     GVector2 get_tex_coords(const size_t index) const;
 
     // Insert and access triangles.
     void reserve_triangles(const size_t count);
     size_t push_triangle(const Triangle& triangle);
+    size_t push_triangles(const Triangle* triangles, const size_t count);
     size_t get_triangle_count() const;
     const Triangle& get_triangle(const size_t index) const;
     Triangle& get_triangle(const size_t index);
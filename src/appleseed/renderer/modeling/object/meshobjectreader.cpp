@@ -49,6 +49,7 @@
 #include "foundation/mesh/objmeshfilereader.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/system.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/autoreleaseptr.h"
@@ -174,21 +175,7 @@ namespace
 
         size_t push_vertex_normal(const Vector3d& v) override
         {
-            GVector3 n(v);
-
-            const GScalar norm_n = norm(n);
-
-            if (norm_n > GScalar(0.0))
-                n /= norm_n;
-            else
-            {
-                ++m_null_normal_vector_count;
-                n = GVector3(GScalar(1.0), GScalar(0.0), GScalar(0.0));
-            }
-
-            ++m_normal_count;
-
-            return m_objects.back()->push_vertex_normal(n);
+            return m_objects.back()->push_vertex_normal(normalize_vertex_normal(GVector3(v)));
         }
 
         size_t push_tex_coords(const Vector2d& v) override
@@ -291,6 +278,62 @@ namespace
             m_face_material = static_cast<uint32>(material);
         }
 
+        size_t push_vertex_array(const Vector3f vertices[], const size_t count) override
+        {
+            return m_objects.back()->push_vertices(vertices, count);
+        }
+
+        size_t push_vertex_normal_array(const Vector3f vertex_normals[], const size_t count) override
+        {
+            m_normals.resize(count);
+
+            for (size_t i = 0; i < count; ++i)
+                m_normals[i] = normalize_vertex_normal(vertex_normals[i]);
+
+            const size_t index = m_objects.back()->push_vertex_normals(m_normals.data(), count);
+
+            clear_release_memory(m_normals);
+
+            return index;
+        }
+
+        size_t push_tex_coords_array(const Vector2f tex_coords[], const size_t count) override
+        {
+            return m_objects.back()->push_tex_coords(tex_coords, count);
+        }
+
+        void push_triangle_array(const MeshTriangle triangles[], const size_t count) override
+        {
+            MeshObject* object = m_objects.back();
+            object->reserve_triangles(object->get_triangle_count() + count);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const MeshTriangle& t = triangles[i];
+
+                if (m_ignore_vertex_normals)
+                {
+                    object->push_triangle(
+                        Triangle(
+                            t.m_v0, t.m_v1, t.m_v2,
+                            Triangle::None, Triangle::None, Triangle::None,
+                            t.m_t0, t.m_t1, t.m_t2,
+                            t.m_material));
+                }
+                else
+                {
+                    object->push_triangle(
+                        Triangle(
+                            t.m_v0, t.m_v1, t.m_v2,
+                            t.m_n0, t.m_n1, t.m_n2,
+                            t.m_t0, t.m_t1, t.m_t2,
+                            t.m_material));
+                }
+            }
+
+            m_face_count += count;
+        }
+
       private:
         const ParamArray        m_params;
         const bool              m_ignore_vertex_normals;
@@ -309,6 +352,9 @@ namespace
         vector<uint32>          m_face_tex_coords;
         uint32                  m_face_material;
 
+        // Support data for bulk loading.
+        vector<GVector3>        m_normals;
+
         // Support data for face triangulation.
         Triangulator<double>    m_triangulator;
         vector<Vector3d>        m_polygon;
@@ -332,6 +378,23 @@ namespace
             m_null_normal_vector_count = 0;
         }
 
+        GVector3 normalize_vertex_normal(GVector3 n)
+        {
+            const GScalar norm_n = norm(n);
+
+            if (norm_n > GScalar(0.0))
+                n /= norm_n;
+            else
+            {
+                ++m_null_normal_vector_count;
+                n = GVector3(GScalar(1.0), GScalar(0.0), GScalar(0.0));
+            }
+
+            ++m_normal_count;
+
+            return n;
+        }
+
         string make_unique_mesh_name(string mesh_name)
         {
             if (mesh_name.empty())
@@ -427,6 +490,16 @@ namespace
                 reader.get_obj_options() | OBJMeshFileReader::FavorSpeedOverPrecision);
         }
 
+        if (params.get_optional<bool>("obj_parallel_parsing", false))
+        {
+            reader.set_obj_options(
+                reader.get_obj_options() | OBJMeshFileReader::ParallelParsing);
+        }
+
+        reader.set_thread_count(
+            global_logger(),
+            params.get_optional<size_t>("reading_threads", System::get_logical_cpu_core_count()));
+
         MeshObjectBuilder builder(params, base_object_name);
 
         Stopwatch<DefaultWallclockTimer> stopwatch;
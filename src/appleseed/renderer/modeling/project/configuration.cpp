@@ -181,6 +181,33 @@ Dictionary Configuration::get_metadata()
             .insert("label", "Render Threads")
             .insert("help", "Number of threads to use for rendering"));
 
+    metadata.insert(
+        "thread_placement",
+        Dictionary()
+            .insert("type", "enum")
+            .insert("values", "none|compact|scatter")
+            .insert("default", "none")
+            .insert("label", "Thread Placement")
+            .insert("help", "Pinning of rendering threads to CPU cores and NUMA nodes (Linux only)")
+            .insert(
+                "options",
+                Dictionary()
+                    .insert(
+                        "none",
+                        Dictionary()
+                            .insert("label", "None")
+                            .insert("help", "Let the operating system schedule rendering threads"))
+                    .insert(
+                        "compact",
+                        Dictionary()
+                            .insert("label", "Compact")
+                            .insert("help", "Fill the cores of one NUMA node before moving to the next one"))
+                    .insert(
+                        "scatter",
+                        Dictionary()
+                            .insert("label", "Scatter")
+                            .insert("help", "Distribute rendering threads round-robin across NUMA nodes"))));
+
     metadata.dictionaries().insert(
         "light_sampler",
         BackwardLightSampler::get_params_metadata());
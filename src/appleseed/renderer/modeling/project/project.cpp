@@ -34,6 +34,8 @@
 #include "renderer/global/globallogger.h"
 #include "renderer/kernel/intersection/tracecontext.h"
 #include "renderer/kernel/lighting/lightpathrecorder.h"
+#include "renderer/kernel/lighting/lighttree.h"
+#include "renderer/kernel/shading/shadergroupprofiler.h"
 #include "renderer/modeling/display/display.h"
 #include "renderer/modeling/edf/edf.h"
 #include "renderer/modeling/environment/environment.h"
@@ -55,6 +57,7 @@
 #include "renderer/modeling/surfaceshader/surfaceshader.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/system.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/searchpaths.h"
@@ -92,12 +95,16 @@ struct Project::Impl
     auto_release_ptr<Frame>     m_frame;
     auto_release_ptr<Display>   m_display;
     LightPathRecorder           m_light_path_recorder;
+    LightTreeCache              m_light_tree_cache;
+    ShaderGroupProfiler         m_shader_group_profiler;
+    size_t                      m_rendering_thread_count;
     ConfigurationContainer      m_configurations;
     SearchPaths                 m_search_paths;
     unique_ptr<TraceContext>    m_trace_context;
 
     Impl()
       : m_format_revision(ProjectFormatRevision)
+      , m_rendering_thread_count(System::get_logical_cpu_core_count())
       , m_search_paths("APPLESEED_SEARCHPATH", SearchPaths::environment_path_separator())
     {
     }
@@ -202,6 +209,26 @@ LightPathRecorder& Project::get_light_path_recorder() const
     return impl->m_light_path_recorder;
 }
 
+LightTreeCache& Project::get_light_tree_cache() const
+{
+    return impl->m_light_tree_cache;
+}
+
+ShaderGroupProfiler& Project::get_shader_group_profiler() const
+{
+    return impl->m_shader_group_profiler;
+}
+
+void Project::set_rendering_thread_count(const size_t thread_count)
+{
+    impl->m_rendering_thread_count = thread_count;
+}
+
+size_t Project::get_rendering_thread_count() const
+{
+    return impl->m_rendering_thread_count;
+}
+
 ConfigurationContainer& Project::configurations() const
 {
     return impl->m_configurations;
@@ -241,7 +268,8 @@ const TraceContext& Project::get_trace_context() const
     if (impl->m_trace_context.get() == nullptr)
     {
         assert(impl->m_scene.get());
-        impl->m_trace_context.reset(new TraceContext(*impl->m_scene));
+        impl->m_trace_context.reset(
+            new TraceContext(*impl->m_scene, impl->m_rendering_thread_count));
     }
 
     return *impl->m_trace_context;
@@ -250,7 +278,7 @@ const TraceContext& Project::get_trace_context() const
 void Project::update_trace_context()
 {
     if (impl->m_trace_context.get())
-        impl->m_trace_context->update();
+        impl->m_trace_context->update(impl->m_rendering_thread_count);
 }
 
 void Project::add_base_configurations()
@@ -87,9 +87,11 @@ namespace renderer      { class EnvironmentShader; }
 namespace renderer      { class Frame; }
 namespace renderer      { class Light; }
 namespace renderer      { class LightPathRecorder; }
+namespace renderer      { class LightTreeCache; }
 namespace renderer      { class Material; }
 namespace renderer      { class Object; }
 namespace renderer      { class Scene; }
+namespace renderer      { class ShaderGroupProfiler; }
 namespace renderer      { class SurfaceShader; }
 namespace renderer      { class Texture; }
 namespace renderer      { class TraceContext; }
@@ -154,6 +156,19 @@ class APPLESEED_DLLSYMBOL Project
     // Access the light path recorder.
     LightPathRecorder& get_light_path_recorder() const;
 
+    // Access the light tree kept across renders.
+    LightTreeCache& get_light_tree_cache() const;
+
+    // Access the shader group profiler.
+    ShaderGroupProfiler& get_shader_group_profiler() const;
+
+    // Set or get the number of threads that entities may use for work performed
+    // when rendering starts, such as building acceleration structures and importance
+    // maps. Defaults to the number of logical CPU cores; the master renderer sets it
+    // before each render.
+    void set_rendering_thread_count(const size_t thread_count);
+    size_t get_rendering_thread_count() const;
+
     // Access the configurations.
     ConfigurationContainer& configurations() const;
 
@@ -31,6 +31,7 @@
 #include "basegroup.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/kernel/shading/oslshadingsystem.h"
 #include "renderer/modeling/color/colorentity.h"
 #include "renderer/modeling/scene/assembly.h"
@@ -40,10 +41,19 @@
 #include "renderer/modeling/texture/texture.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/defaulttimers.h"
 #include "foundation/utility/foreach.h"
-#include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <string>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -98,9 +108,111 @@ ShaderGroupContainer& BaseGroup::shader_groups() const
     return impl->m_shader_groups;
 }
 
+namespace
+{
+    class ShaderGroupOptimizationJob
+      : public IJob
+    {
+      public:
+        ShaderGroupOptimizationJob(
+            OSLShadingSystem&   shading_system,
+            ShaderGroup&        shader_group,
+            IAbortSwitch*       abort_switch)
+          : m_shading_system(shading_system)
+          , m_shader_group(shader_group)
+          , m_abort_switch(abort_switch)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            if (!is_aborted(m_abort_switch))
+                m_shader_group.optimize_osl_shader_group(m_shading_system);
+        }
+
+      private:
+        OSLShadingSystem&       m_shading_system;
+        ShaderGroup&            m_shader_group;
+        IAbortSwitch*           m_abort_switch;
+    };
+}
+
 bool BaseGroup::create_optimized_osl_shader_groups(
-    OSLShadingSystem&   shading_system,
-    IAbortSwitch*       abort_switch)
+    OSLShadingSystem&       shading_system,
+    OSLShaderGroupCache*    cache,
+    const size_t            thread_count,
+    IAbortSwitch*           abort_switch)
+{
+    // OSL does not allow to create shader groups concurrently.
+    vector<ShaderGroup*> pending_shader_groups;
+    const bool success =
+        create_osl_shader_groups(
+            shading_system,
+            cache,
+            pending_shader_groups,
+            abort_switch);
+
+    if (!success || is_aborted(abort_switch) || pending_shader_groups.empty())
+        return success;
+
+    const size_t shader_group_count = pending_shader_groups.size();
+
+    RENDERER_LOG_INFO(
+        "optimizing %s %s using %s %s...",
+        pretty_uint(shader_group_count).c_str(),
+        plural(shader_group_count, "shader group").c_str(),
+        pretty_uint(thread_count).c_str(),
+        plural(thread_count, "thread").c_str());
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    // Optimize and JIT-compile all shader groups concurrently, instead of
+    // letting OSL do it lazily while rendering threads wait for each other.
+    JobQueue job_queue;
+    for (size_t i = 0; i < shader_group_count; ++i)
+    {
+        job_queue.schedule(
+            new ShaderGroupOptimizationJob(
+                shading_system,
+                *pending_shader_groups[i],
+                abort_switch));
+    }
+
+    JobManager job_manager(
+        global_logger(),
+        job_queue,
+        max<size_t>(min(thread_count, shader_group_count), 1));
+    job_manager.start();
+    job_queue.wait_until_completion();
+
+    if (is_aborted(abort_switch))
+        return true;
+
+    bool all_succeeded = true;
+    for (size_t i = 0; i < shader_group_count; ++i)
+        all_succeeded = pending_shader_groups[i]->finalize_osl_shader_group(shading_system) && all_succeeded;
+
+    stopwatch.measure();
+
+    Statistics statistics;
+    statistics.insert("shader groups", shader_group_count);
+    statistics.insert("threads", thread_count);
+    statistics.insert_time("optimization time", stopwatch.get_seconds());
+
+    RENDERER_LOG_INFO("%s",
+        StatisticsVector::make(
+            "shader group optimization statistics",
+            statistics).to_string().c_str());
+
+    return all_succeeded;
+}
+
+bool BaseGroup::create_osl_shader_groups(
+    OSLShadingSystem&       shading_system,
+    OSLShaderGroupCache*    cache,
+    vector<ShaderGroup*>&   pending_shader_groups,
+    IAbortSwitch*           abort_switch)
 {
     bool success = true;
 
@@ -109,8 +221,10 @@ bool BaseGroup::create_optimized_osl_shader_groups(
         if (is_aborted(abort_switch))
             return true;
 
-        success = success && i->create_optimized_osl_shader_groups(
+        success = success && i->create_osl_shader_groups(
             shading_system,
+            cache,
+            pending_shader_groups,
             abort_switch);
     }
 
@@ -119,9 +233,16 @@ bool BaseGroup::create_optimized_osl_shader_groups(
         if (is_aborted(abort_switch))
             return true;
 
-        success = success && i->create_optimized_osl_shader_group(
+        if (i->is_valid())
+            continue;
+
+        success = success && i->create_osl_shader_group(
             shading_system,
+            cache,
             abort_switch);
+
+        if (success && i->has_pending_osl_shader_group())
+            pending_shader_groups.push_back(&*i);
     }
 
     return success;
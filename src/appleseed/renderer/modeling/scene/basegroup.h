@@ -36,12 +36,18 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class StringArray; }
 namespace foundation    { class StringDictionary; }
 namespace renderer      { class Entity; }
+namespace renderer      { class OSLShaderGroupCache; }
 namespace renderer      { class OSLShadingSystem; }
+namespace renderer      { class ShaderGroup; }
 
 namespace renderer
 {
@@ -71,9 +77,12 @@ class APPLESEED_DLLSYMBOL BaseGroup
     // Access the OSL shader groups.
     ShaderGroupContainer& shader_groups() const;
 
-    // Create OSL shader groups and optimize them.
+    // Create OSL shader groups and optimize them using multiple threads.
+    // If a cache is provided, identical shader groups are only optimized once.
     bool create_optimized_osl_shader_groups(
         OSLShadingSystem&           shading_system,
+        OSLShaderGroupCache*        cache = nullptr,
+        const size_t                thread_count = 1,
         foundation::IAbortSwitch*   abort_switch = nullptr);
 
     // Release internal OSL shader groups.
@@ -92,6 +101,14 @@ class APPLESEED_DLLSYMBOL BaseGroup
   private:
     struct Impl;
     Impl* impl;
+
+    // Create the OSL shader groups of this group and of its assemblies without
+    // optimizing them, and collect the shader groups that were created.
+    bool create_osl_shader_groups(
+        OSLShadingSystem&           shading_system,
+        OSLShaderGroupCache*        cache,
+        std::vector<ShaderGroup*>&  pending_shader_groups,
+        foundation::IAbortSwitch*   abort_switch);
 };
 
 }       // namespace renderer
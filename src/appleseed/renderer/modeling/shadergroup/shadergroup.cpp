@@ -31,6 +31,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/shading/oslshadergroupcache.h"
 #include "renderer/kernel/shading/oslshadingsystem.h"
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/shadergroup/shader.h"
@@ -49,6 +50,7 @@
 
 // Standard headers.
 #include <exception>
+#include <string>
 #include <utility>
 
 using namespace foundation;
@@ -81,6 +83,8 @@ struct ShaderGroup::Impl
     ShaderContainer             m_shaders;
     ShaderConnectionContainer   m_connections;
     mutable OSL::ShaderGroupRef m_shader_group_ref;
+    OSL::ShaderGroupRef         m_pending_shader_group_ref;     // created but not yet optimized
+    bool                        m_owns_pending_shader_group;    // false if shared with an identical shader group
     mutable SurfaceAreaMap      m_surface_areas;
 };
 
@@ -112,6 +116,7 @@ void ShaderGroup::clear()
     impl->m_shaders.clear();
     impl->m_connections.clear();
     impl->m_shader_group_ref.reset();
+    impl->m_pending_shader_group_ref.reset();
     m_flags = 0;
 }
 
@@ -163,6 +168,58 @@ bool ShaderGroup::create_optimized_osl_shader_group(
     if (is_valid())
         return true;
 
+    if (!create_osl_shader_group(shading_system, nullptr, abort_switch))
+        return false;
+
+    if (!has_pending_osl_shader_group())
+        return true;
+
+    optimize_osl_shader_group(shading_system);
+
+    return finalize_osl_shader_group(shading_system);
+}
+
+void ShaderGroup::release_optimized_osl_shader_group()
+{
+    impl->m_shader_group_ref.reset();
+    impl->m_pending_shader_group_ref.reset();
+}
+
+const ShaderContainer& ShaderGroup::shaders() const
+{
+    return impl->m_shaders;
+}
+
+const ShaderConnectionContainer& ShaderGroup::shader_connections() const
+{
+    return impl->m_connections;
+}
+
+bool ShaderGroup::is_valid() const
+{
+    return impl->m_shader_group_ref.get() != nullptr;
+}
+
+float ShaderGroup::get_surface_area(
+    const AssemblyInstance* assembly_instance,
+    const ObjectInstance*   object_instance) const
+{
+    assert(has_emission());
+    return impl->m_surface_areas[Impl::SurfaceAreaKey(assembly_instance, object_instance)];
+}
+
+void* ShaderGroup::osl_shader_group() const
+{
+    return impl->m_shader_group_ref.get();
+}
+
+bool ShaderGroup::create_osl_shader_group(
+    OSLShadingSystem&       shading_system,
+    OSLShaderGroupCache*    cache,
+    IAbortSwitch*           abort_switch)
+{
+    impl->m_pending_shader_group_ref.reset();
+
     RENDERER_LOG_DEBUG("setting up shader group \"%s\"...", get_path().c_str());
 
     try
@@ -205,18 +262,33 @@ bool ShaderGroup::create_optimized_osl_shader_group(
             return false;
         }
 
-        impl->m_shader_group_ref = shader_group_ref;
-
-        get_shadergroup_closures_info(shading_system);
-        report_has_closure("bsdf", HasBSDFs);
-        report_has_closure("emission", HasEmission);
-        report_has_closure("transparent", HasTransparency);
-        report_has_closure("subsurface", HasSubsurface);
-        report_has_closure("holdout", HasHoldout);
-        report_has_closure("debug", HasDebug);
+        impl->m_pending_shader_group_ref = shader_group_ref;
+        impl->m_owns_pending_shader_group = true;
+
+        // The serialized form of the OSL shader group describes its shaders,
+        // their parameters and their connections, but not its name.
+        OIIO::ustring serialized_group;
+        if (cache != nullptr &&
+            shading_system.getattribute(
+                shader_group_ref.get(),
+                "pickle",
+                OIIO::TypeDesc::STRING,
+                &serialized_group))
+        {
+            const string key = serialized_group.string();
+            const OSL::ShaderGroupRef cached_shader_group_ref = cache->get(key);
 
-        get_shadergroup_globals_info(shading_system);
-        report_uses_global("dPdtime", UsesdPdTime);
+            if (cached_shader_group_ref.get() != nullptr)
+            {
+                RENDERER_LOG_DEBUG("reusing an identical osl shader group for shader group \"%s\".", get_path().c_str());
+                impl->m_pending_shader_group_ref = cached_shader_group_ref;
+                impl->m_owns_pending_shader_group = false;
+            }
+            else
+            {
+                cache->insert(key, shader_group_ref);
+            }
+        }
 
         return true;
     }
@@ -227,37 +299,58 @@ bool ShaderGroup::create_optimized_osl_shader_group(
     }
 }
 
-void ShaderGroup::release_optimized_osl_shader_group()
+bool ShaderGroup::has_pending_osl_shader_group() const
 {
-    impl->m_shader_group_ref.reset();
+    return impl->m_pending_shader_group_ref.get() != nullptr;
 }
 
-const ShaderContainer& ShaderGroup::shaders() const
+void ShaderGroup::optimize_osl_shader_group(OSLShadingSystem& shading_system)
 {
-    return impl->m_shaders;
-}
+    assert(has_pending_osl_shader_group());
 
-const ShaderConnectionContainer& ShaderGroup::shader_connections() const
-{
-    return impl->m_connections;
-}
+    if (!impl->m_owns_pending_shader_group)
+        return;
 
-bool ShaderGroup::is_valid() const
-{
-    return impl->m_shader_group_ref.get() != nullptr;
-}
+    RENDERER_LOG_DEBUG("optimizing shader group \"%s\"...", get_path().c_str());
 
-float ShaderGroup::get_surface_area(
-    const AssemblyInstance* assembly_instance,
-    const ObjectInstance*   object_instance) const
-{
-    assert(has_emission());
-    return impl->m_surface_areas[Impl::SurfaceAreaKey(assembly_instance, object_instance)];
+    try
+    {
+        shading_system.optimize_group(impl->m_pending_shader_group_ref.get());
+    }
+    catch (const exception& e)
+    {
+        RENDERER_LOG_ERROR("failed to optimize shader group \"%s\": %s.", get_path().c_str(), e.what());
+    }
 }
 
-void* ShaderGroup::osl_shader_group() const
+bool ShaderGroup::finalize_osl_shader_group(OSLShadingSystem& shading_system)
 {
-    return impl->m_shader_group_ref.get();
+    assert(has_pending_osl_shader_group());
+
+    try
+    {
+        impl->m_shader_group_ref = impl->m_pending_shader_group_ref;
+        impl->m_pending_shader_group_ref.reset();
+
+        get_shadergroup_closures_info(shading_system);
+        report_has_closure("bsdf", HasBSDFs);
+        report_has_closure("emission", HasEmission);
+        report_has_closure("transparent", HasTransparency);
+        report_has_closure("subsurface", HasSubsurface);
+        report_has_closure("holdout", HasHoldout);
+        report_has_closure("debug", HasDebug);
+
+        get_shadergroup_globals_info(shading_system);
+        report_uses_global("dPdtime", UsesdPdTime);
+
+        return true;
+    }
+    catch (const exception& e)
+    {
+        impl->m_shader_group_ref.reset();
+        RENDERER_LOG_ERROR("failed to setup shader group \"%s\": %s.", get_path().c_str(), e.what());
+        return false;
+    }
 }
 
 void ShaderGroup::get_shadergroup_closures_info(OSLShadingSystem& shading_system)
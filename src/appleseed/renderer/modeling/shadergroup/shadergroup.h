@@ -46,6 +46,7 @@
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class DictionaryArray; }
 namespace renderer      { class AssemblyInstance; }
+namespace renderer      { class OSLShaderGroupCache; }
 namespace renderer      { class OSLShadingSystem; }
 namespace renderer      { class ParamArray; }
 namespace renderer      { class ObjectInstance; }
@@ -92,6 +93,26 @@ class APPLESEED_DLLSYMBOL ShaderGroup
     // Release internal OSL shader group.
     void release_optimized_osl_shader_group();
 
+    // The following methods split create_optimized_osl_shader_group() into steps,
+    // allowing to optimize many shader groups in parallel.
+
+    // Create the internal OSL shader group without optimizing it. If a cache is
+    // provided and holds an identical shader group, that group is used instead.
+    bool create_osl_shader_group(
+        OSLShadingSystem&           shading_system,
+        OSLShaderGroupCache*        cache,
+        foundation::IAbortSwitch*   abort_switch);
+
+    // Return true if the internal OSL shader group was created but is not yet usable.
+    bool has_pending_osl_shader_group() const;
+
+    // Optimize and JIT-compile the internal OSL shader group, unless it is shared
+    // with another shader group. Can be called concurrently on different shader groups.
+    void optimize_osl_shader_group(OSLShadingSystem& shading_system);
+
+    // Query the properties of the internal OSL shader group and make it usable.
+    bool finalize_osl_shader_group(OSLShadingSystem& shading_system);
+
     // Access the shaders.
     const ShaderContainer& shaders() const;
 
@@ -0,0 +1,698 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2026 agent, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "gridvolume.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/volume/deltatracking.h"
+#include "renderer/kernel/volume/sparsedensitygrid.h"
+#include "renderer/kernel/volume/volume.h"
+#include "renderer/modeling/input/inputarray.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/volume/volume.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/phasefunction.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/api/specializedapiarrays.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/makevector.h"
+#include "foundation/utility/searchpaths.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <limits>
+#include <memory>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    const char* Model = "grid_volume";
+}
+
+//
+// Grid volume.
+//
+// The density grid covers the axis-aligned box defined by the bbox_min and
+// bbox_max parameters. Absorption and scattering coefficients are those of
+// the media at unit density.
+//
+
+class GridVolume
+  : public Volume
+{
+  public:
+    GridVolume(
+        const char*         name,
+        const ParamArray&   params)
+      : Volume(name, params)
+    {
+        m_inputs.declare("absorption", InputFormatSpectralReflectance);
+        m_inputs.declare("absorption_multiplier", InputFormatFloat, "1.0");
+        m_inputs.declare("scattering", InputFormatSpectralReflectance);
+        m_inputs.declare("scattering_multiplier", InputFormatFloat, "1.0");
+        m_inputs.declare("density_multiplier", InputFormatFloat, "1.0");
+        m_inputs.declare("average_cosine", InputFormatFloat, "0.0");
+    }
+
+    void release() override
+    {
+        delete this;
+    }
+
+    const char* get_model() const override
+    {
+        return Model;
+    }
+
+    bool on_frame_begin(
+        const Project&          project,
+        const BaseGroup*        parent,
+        OnFrameBeginRecorder&   recorder,
+        IAbortSwitch*           abort_switch) override
+    {
+        if (!Volume::on_frame_begin(project, parent, recorder, abort_switch))
+            return false;
+
+        const EntityDefMessageContext context("volume", this);
+
+        const string phase_function =
+            m_params.get_required<string>(
+                "phase_function_model",
+                "isotropic",
+                make_vector("isotropic", "henyey"),
+                context);
+
+        if (phase_function == "isotropic")
+            m_phase_function.reset(new IsotropicPhaseFunction());
+        else if (phase_function == "henyey")
+        {
+            const float g = clamp(
+                m_params.get_optional<float>("average_cosine", 0.0f),
+                -0.99f, +0.99f);
+            m_phase_function.reset(new HenyeyPhaseFunction(g));
+        }
+        else return false;
+
+        // Load the density grid, unless it was already loaded by a previous render.
+        const string filepath =
+            to_string(project.search_paths().qualify(m_params.get_required<string>("filename", "")));
+        if (m_grid.get() == nullptr || filepath != m_grid_filepath)
+        {
+            if (!load_grid(filepath))
+                return false;
+        }
+
+        // Compute the transform from world space to grid space.
+        const Vector3d bbox_min = m_params.get_required<Vector3d>("bbox_min", Vector3d(0.0));
+        const Vector3d bbox_max = m_params.get_required<Vector3d>("bbox_max", Vector3d(1.0));
+        const Vector3d extent = bbox_max - bbox_min;
+        if (extent[0] <= 0.0 || extent[1] <= 0.0 || extent[2] <= 0.0)
+        {
+            RENDERER_LOG_ERROR(
+                "while defining volume \"%s\": the bounding box of the grid is empty.",
+                get_path().c_str());
+            return false;
+        }
+        m_bbox_min = bbox_min;
+        m_world_to_grid =
+            Vector3d(
+                m_grid->get_xres() / extent[0],
+                m_grid->get_yres() / extent[1],
+                m_grid->get_zres() / extent[2]);
+
+        return true;
+    }
+
+    bool is_homogeneous() const override
+    {
+        return false;
+    }
+
+    size_t compute_input_data_size() const override
+    {
+        return sizeof(InputValues);
+    }
+
+    void prepare_inputs(
+        Arena&              arena,
+        const ShadingRay&   volume_ray,
+        void*               data) const override
+    {
+        InputValues* values = static_cast<InputValues*>(data);
+
+        values->m_absorption *= values->m_absorption_multiplier;
+        values->m_scattering *= values->m_scattering_multiplier;
+
+        // Precompute extinction at unit density.
+        values->m_precomputed.m_extinction = values->m_absorption + values->m_scattering;
+
+        Vector3f org, dir;
+        to_grid_space(volume_ray, org, dir);
+
+        // Precompute the majorant of the extinction coefficient along the ray.
+        const float max_density =
+            m_grid->get_max_density(org, dir, 0.0f, get_ray_length(volume_ray)) *
+            values->m_density_multiplier;
+        values->m_precomputed.m_majorant = values->m_precomputed.m_extinction;
+        values->m_precomputed.m_majorant *= max_density;
+
+        // Precompute the coefficients at the ray origin.
+        const float origin_density = m_grid->lookup(org) * values->m_density_multiplier;
+        values->m_precomputed.m_origin_absorption = values->m_absorption;
+        values->m_precomputed.m_origin_absorption *= origin_density;
+        values->m_precomputed.m_origin_scattering = values->m_scattering;
+        values->m_precomputed.m_origin_scattering *= origin_density;
+    }
+
+    float sample(
+        SamplingContext&    sampling_context,
+        const void*         data,
+        const ShadingRay&   volume_ray,
+        const float         distance,
+        Vector3f&           incoming) const override
+    {
+        sampling_context.split_in_place(2, 1);
+        const Vector2f s = sampling_context.next2<Vector2f>();
+
+        const Vector3f outgoing(normalize(volume_ray.m_dir));
+        return m_phase_function->sample(outgoing, s, incoming);
+    }
+
+    float evaluate(
+        const void*         data,
+        const ShadingRay&   volume_ray,
+        const float         distance,
+        const Vector3f&     incoming) const override
+    {
+        const Vector3f outgoing = Vector3f(normalize(volume_ray.m_dir));
+        return m_phase_function->evaluate(outgoing, incoming);
+    }
+
+    bool sample_distance(
+        SamplingContext&    sampling_context,
+        const void*         data,
+        const ShadingRay&   volume_ray,
+        float&              distance,
+        Spectrum&           weight) const override
+    {
+        const InputValues* values = static_cast<const InputValues*>(data);
+
+        weight.set(1.0f);
+
+        DeltaTrackingVisitor visitor(*m_grid, *values, make_tracking_rng(sampling_context), weight);
+        to_grid_space(volume_ray, visitor.m_org, visitor.m_dir);
+
+        if (visitor.m_density_to_majorant > 0.0f)
+            m_grid->traverse(visitor.m_org, visitor.m_dir, 0.0f, get_ray_length(volume_ray), visitor);
+
+        distance = visitor.m_distance;
+        return visitor.m_scattered;
+    }
+
+    void evaluate_transmission(
+        const void*         data,
+        const ShadingRay&   volume_ray,
+        const float         distance,
+        Spectrum&           spectrum) const override
+    {
+        const InputValues* values = static_cast<const InputValues*>(data);
+
+        spectrum.set(1.0f);
+
+        RatioTrackingVisitor visitor(
+            *m_grid,
+            *values,
+            make_tracking_rng(volume_ray.m_org, volume_ray.m_dir, distance),
+            spectrum);
+        to_grid_space(volume_ray, visitor.m_org, visitor.m_dir);
+
+        if (visitor.m_density_to_majorant > 0.0f)
+            m_grid->traverse(visitor.m_org, visitor.m_dir, 0.0f, distance, visitor);
+    }
+
+    void evaluate_transmission(
+        const void*         data,
+        const ShadingRay&   volume_ray,
+        Spectrum&           spectrum) const override
+    {
+        if (!volume_ray.is_finite())
+            spectrum.set(0.0f);
+        else
+        {
+            const float distance = static_cast<float>(volume_ray.get_length());
+            evaluate_transmission(data, volume_ray, distance, spectrum);
+        }
+    }
+
+    void scattering_coefficient(
+        const void*         data,
+        const ShadingRay&   volume_ray,
+        const float         distance,
+        Spectrum&           spectrum) const override
+    {
+        const InputValues* values = static_cast<const InputValues*>(data);
+        spectrum = values->m_scattering;
+        spectrum *= get_density(*values, volume_ray, distance);
+    }
+
+    const Spectrum& scattering_coefficient(
+        const void*         data,
+        const ShadingRay&   volume_ray) const override
+    {
+        const InputValues* values = static_cast<const InputValues*>(data);
+        return values->m_precomputed.m_origin_scattering;
+    }
+
+    void absorption_coefficient(
+        const void*         data,
+        const ShadingRay&   volume_ray,
+        const float         distance,
+        Spectrum&           spectrum) const override
+    {
+        const InputValues* values = static_cast<const InputValues*>(data);
+        spectrum = values->m_absorption;
+        spectrum *= get_density(*values, volume_ray, distance);
+    }
+
+    const Spectrum& absorption_coefficient(
+        const void*         data,
+        const ShadingRay&   volume_ray) const override
+    {
+        const InputValues* values = static_cast<const InputValues*>(data);
+        return values->m_precomputed.m_origin_absorption;
+    }
+
+    void extinction_coefficient(
+        const void*         data,
+        const ShadingRay&   volume_ray,
+        const float         distance,
+        Spectrum&           spectrum) const override
+    {
+        const InputValues* values = static_cast<const InputValues*>(data);
+        spectrum = values->m_precomputed.m_extinction;
+        spectrum *= get_density(*values, volume_ray, distance);
+    }
+
+    const Spectrum& extinction_coefficient(
+        const void*         data,
+        const ShadingRay&   volume_ray) const override
+    {
+        const InputValues* values = static_cast<const InputValues*>(data);
+        return values->m_precomputed.m_majorant;
+    }
+
+  private:
+    typedef GridVolumeInputValues InputValues;
+
+    unique_ptr<PhaseFunction>       m_phase_function;
+    unique_ptr<SparseDensityGrid>   m_grid;
+    string                          m_grid_filepath;
+    Vector3d                        m_bbox_min;
+    Vector3d                        m_world_to_grid;
+
+    // Base class of the visitors that walk a ray through the density grid.
+    struct TrackingVisitor
+    {
+        const SparseDensityGrid&    m_grid;
+        const InputValues&          m_values;
+        TrackingRNG                 m_rng;
+        Vector3f                    m_org;
+        Vector3f                    m_dir;
+        float                       m_density_to_majorant;  // converts a density bound to a majorant valid for all wavelengths
+
+        TrackingVisitor(
+            const SparseDensityGrid&    grid,
+            const InputValues&          values,
+            const TrackingRNG&          rng)
+          : m_grid(grid)
+          , m_values(values)
+          , m_rng(rng)
+          , m_density_to_majorant(max_value(values.m_precomputed.m_extinction) * values.m_density_multiplier)
+        {
+        }
+
+        float get_density(const float t) const
+        {
+            return m_grid.lookup(m_org + t * m_dir) * m_values.m_density_multiplier;
+        }
+    };
+
+    // Delta tracking: find the first real scattering collision along the ray.
+    struct DeltaTrackingVisitor
+      : public TrackingVisitor
+    {
+        Spectrum&                   m_weight;
+        float                       m_distance;
+        bool                        m_scattered;
+
+        DeltaTrackingVisitor(
+            const SparseDensityGrid&    grid,
+            const InputValues&          values,
+            const TrackingRNG&          rng,
+            Spectrum&                   weight)
+          : TrackingVisitor(grid, values, rng)
+          , m_weight(weight)
+          , m_distance(0.0f)
+          , m_scattered(false)
+        {
+        }
+
+        bool operator()(const float t0, const float t1, const float max_density)
+        {
+            const float majorant = max_density * m_density_to_majorant;
+            Spectrum scattering, extinction;
+
+            for (float t = t0; ;)
+            {
+                t += sample_tentative_collision(m_rng, majorant);
+                if (t >= t1)
+                    return true;
+
+                const float density = get_density(t);
+                scattering = m_values.m_scattering;
+                scattering *= density;
+                extinction = m_values.m_precomputed.m_extinction;
+                extinction *= density;
+
+                if (sample_collision_type(m_rng, scattering, extinction, majorant, m_weight))
+                {
+                    m_distance = t;
+                    m_scattered = true;
+                    return false;
+                }
+
+                if (is_zero(m_weight))
+                    return false;
+            }
+        }
+    };
+
+    // Ratio tracking: estimate the transmission along the ray.
+    struct RatioTrackingVisitor
+      : public TrackingVisitor
+    {
+        Spectrum&                   m_transmission;
+
+        RatioTrackingVisitor(
+            const SparseDensityGrid&    grid,
+            const InputValues&          values,
+            const TrackingRNG&          rng,
+            Spectrum&                   transmission)
+          : TrackingVisitor(grid, values, rng)
+          , m_transmission(transmission)
+        {
+        }
+
+        bool operator()(const float t0, const float t1, const float max_density)
+        {
+            const float majorant = max_density * m_density_to_majorant;
+            Spectrum extinction;
+
+            for (float t = t0; ;)
+            {
+                t += sample_tentative_collision(m_rng, majorant);
+                if (t >= t1)
+                    return true;
+
+                extinction = m_values.m_precomputed.m_extinction;
+                extinction *= get_density(t);
+
+                if (!update_transmission(m_rng, extinction, majorant, m_transmission))
+                    return false;
+            }
+        }
+    };
+
+    bool load_grid(const string& filepath)
+    {
+        m_grid.reset();
+        m_grid_filepath.clear();
+
+        FluidChannels channels;
+        const unique_ptr<VoxelGrid> voxel_grid = read_fluid_file(filepath.c_str(), channels);
+
+        if (voxel_grid.get() == nullptr)
+        {
+            RENDERER_LOG_ERROR(
+                "while defining volume \"%s\": failed to load fluid file %s.",
+                get_path().c_str(),
+                filepath.c_str());
+            return false;
+        }
+
+        if (channels.m_density_index == FluidChannels::NotPresent)
+        {
+            RENDERER_LOG_ERROR(
+                "while defining volume \"%s\": fluid file %s has no density channel.",
+                get_path().c_str(),
+                filepath.c_str());
+            return false;
+        }
+
+        m_grid.reset(new SparseDensityGrid(*voxel_grid, channels.m_density_index));
+        m_grid_filepath = filepath;
+
+        RENDERER_LOG_INFO(
+            "loaded density grid of volume \"%s\": %s x %s x %s voxels, %s of %s bricks stored, %s.",
+            get_path().c_str(),
+            pretty_uint(m_grid->get_xres()).c_str(),
+            pretty_uint(m_grid->get_yres()).c_str(),
+            pretty_uint(m_grid->get_zres()).c_str(),
+            pretty_uint(m_grid->get_stored_brick_count()).c_str(),
+            pretty_uint(m_grid->get_brick_count()).c_str(),
+            pretty_size(m_grid->get_memory_size()).c_str());
+
+        return true;
+    }
+
+    void to_grid_space(
+        const ShadingRay&   volume_ray,
+        Vector3f&           org,
+        Vector3f&           dir) const
+    {
+        // Scaling the direction along with the origin preserves ray distances.
+        org = Vector3f((volume_ray.m_org - m_bbox_min) * m_world_to_grid);
+        dir = Vector3f(volume_ray.m_dir * m_world_to_grid);
+    }
+
+    static float get_ray_length(const ShadingRay& volume_ray)
+    {
+        return
+            volume_ray.is_finite()
+                ? static_cast<float>(volume_ray.get_length())
+                : numeric_limits<float>::max();
+    }
+
+    float get_density(
+        const InputValues&  values,
+        const ShadingRay&   volume_ray,
+        const float         distance) const
+    {
+        const Vector3d point = volume_ray.point_at(static_cast<double>(distance));
+        return
+            m_grid->lookup(Vector3f((point - m_bbox_min) * m_world_to_grid)) *
+            values.m_density_multiplier;
+    }
+};
+
+
+//
+// GridVolumeFactory class implementation.
+//
+
+void GridVolumeFactory::release()
+{
+    delete this;
+}
+
+const char* GridVolumeFactory::get_model() const
+{
+    return Model;
+}
+
+Dictionary GridVolumeFactory::get_model_metadata() const
+{
+    return
+        Dictionary()
+            .insert("name", Model)
+            .insert("label", "Grid Volume");
+}
+
+DictionaryArray GridVolumeFactory::get_input_metadata() const
+{
+    DictionaryArray metadata;
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "filename")
+            .insert("label", "Fluid File")
+            .insert("type", "file")
+            .insert("file_picker_mode", "open")
+            .insert("file_picker_type", "fluid")
+            .insert("use", "required"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "bbox_min")
+            .insert("label", "Bounding Box Min")
+            .insert("type", "text")
+            .insert("use", "required")
+            .insert("default", "0.0 0.0 0.0"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "bbox_max")
+            .insert("label", "Bounding Box Max")
+            .insert("type", "text")
+            .insert("use", "required")
+            .insert("default", "1.0 1.0 1.0"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "density_multiplier")
+            .insert("label", "Density Multiplier")
+            .insert("type", "numeric")
+            .insert("min",
+                Dictionary()
+                    .insert("value", "0.0")
+                    .insert("type", "hard"))
+            .insert("max",
+                Dictionary()
+                    .insert("value", "200.0")
+                    .insert("type", "soft"))
+            .insert("use", "optional")
+            .insert("default", "1.0"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "absorption")
+            .insert("label", "Absorption Coefficient")
+            .insert("type", "colormap")
+            .insert("entity_types",
+                Dictionary().insert("color", "Colors"))
+            .insert("use", "required")
+            .insert("default", "0.5"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "absorption_multiplier")
+            .insert("label", "Absorption Coefficient Multiplier")
+            .insert("type", "numeric")
+            .insert("min",
+                Dictionary()
+                    .insert("value", "0.0")
+                    .insert("type", "hard"))
+            .insert("max",
+                Dictionary()
+                    .insert("value", "200.0")
+                    .insert("type", "soft"))
+            .insert("use", "optional")
+            .insert("default", "1.0"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "scattering")
+            .insert("label", "Scattering Coefficient")
+            .insert("type", "colormap")
+            .insert("entity_types",
+                Dictionary().insert("color", "Colors"))
+            .insert("use", "required")
+            .insert("default", "0.5"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "scattering_multiplier")
+            .insert("label", "Scattering Coefficient Multiplier")
+            .insert("type", "numeric")
+            .insert("min",
+                Dictionary()
+                    .insert("value", "0.0")
+                    .insert("type", "hard"))
+            .insert("max",
+                Dictionary()
+                    .insert("value", "200.0")
+                    .insert("type", "soft"))
+            .insert("use", "optional")
+            .insert("default", "1.0"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "phase_function_model")
+            .insert("label", "Phase Function Model")
+            .insert("type", "enumeration")
+            .insert("items",
+                Dictionary()
+                    .insert("Isotropic", "isotropic")
+                    .insert("Henyey-Greenstein", "henyey"))
+            .insert("use", "required")
+            .insert("default", "isotropic")
+            .insert("on_change", "rebuild_form"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "average_cosine")
+            .insert("label", "Average Cosine (g)")
+            .insert("type", "numeric")
+            .insert("min",
+                Dictionary()
+                    .insert("value", "-1.0")
+                    .insert("type", "soft"))
+            .insert("max",
+                Dictionary()
+                    .insert("value", "1.0")
+                    .insert("type", "soft"))
+            .insert("use", "optional")
+            .insert("default", "0.0")
+            .insert("visible_if",
+                Dictionary().insert("phase_function_model", "henyey")));
+
+    return metadata;
+}
+
+auto_release_ptr<Volume> GridVolumeFactory::create(
+    const char*         name,
+    const ParamArray&   params) const
+{
+    return auto_release_ptr<Volume>(new GridVolume(name, params));
+}
+
+}   // namespace renderer
@@ -32,12 +32,18 @@
 // appleseed.renderer headers.
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/volume/deltatracking.h"
 #include "renderer/modeling/input/inputarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/color.h"
 #include "foundation/utility/arena.h"
 
+// Standard headers.
+#include <limits>
+
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -87,4 +93,44 @@ void Volume::prepare_inputs(
 {
 }
 
+bool Volume::sample_distance(
+    SamplingContext&        sampling_context,
+    const void*             data,
+    const ShadingRay&       volume_ray,
+    float&                  distance,
+    Spectrum&               weight) const
+{
+    weight.set(1.0f);
+
+    const float majorant = max_value(extinction_coefficient(data, volume_ray));
+    if (majorant <= 0.0f)
+        return false;
+
+    const float ray_length =
+        volume_ray.is_finite()
+            ? static_cast<float>(volume_ray.get_length())
+            : numeric_limits<float>::max();
+
+    TrackingRNG rng = make_tracking_rng(sampling_context);
+
+    distance = 0.0f;
+
+    while (true)
+    {
+        distance += sample_tentative_collision(rng, majorant);
+        if (distance >= ray_length)
+            return false;
+
+        Spectrum scattering, extinction;
+        scattering_coefficient(data, volume_ray, distance, scattering);
+        extinction_coefficient(data, volume_ray, distance, extinction);
+
+        if (sample_collision_type(rng, scattering, extinction, majorant, weight))
+            return true;
+
+        if (is_zero(weight))
+            return false;
+    }
+}
+
 }   // namespace renderer
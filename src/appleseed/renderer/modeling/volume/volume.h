@@ -150,9 +150,23 @@ class APPLESEED_DLLSYMBOL Volume
         Spectrum&                   spectrum) const = 0;        // resulting spectrum
 
     // Get the extinction coefficient (spectrum) at the ray origin.
+    // Heterogeneous volumes return a majorant of the extinction coefficient along
+    // the ray instead, which is used to importance sample distances along the ray.
     virtual const Spectrum& extinction_coefficient(
         const void*                 data,                       // input values
         const ShadingRay&           volume_ray) const = 0;      // ray used for marching inside the volume
+
+    // Sample the distance to the next scattering event along the ray using delta tracking.
+    // The weight is the ratio between the contribution of the sampled event and its
+    // probability: it includes the scattering coefficient if a scattering event is found,
+    // or the transmission ratio of the entire ray otherwise. Return true if the ray
+    // scatters. The default implementation is only suitable for homogeneous volumes.
+    virtual bool sample_distance(
+        SamplingContext&            sampling_context,
+        const void*                 data,                       // input values
+        const ShadingRay&           volume_ray,                 // ray used for marching inside the volume
+        float&                      distance,                   // distance to the scattering event
+        Spectrum&                   weight) const;              // sample weight
 };
 
 }       // namespace renderer
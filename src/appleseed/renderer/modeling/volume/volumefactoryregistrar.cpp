@@ -32,6 +32,7 @@
 // appleseed.renderer headers.
 #include "renderer/modeling/entity/registerentityfactories.h"
 #include "renderer/modeling/volume/genericvolume.h"
+#include "renderer/modeling/volume/gridvolume.h"
 #include "renderer/modeling/volume/volumetraits.h"
 
 // appleseed.foundation headers.
@@ -75,6 +76,7 @@ void VolumeFactoryRegistrar::reinitialize(const SearchPaths& search_paths)
 
     // Register built-in factories.
     register_factory(auto_release_ptr<FactoryType>(new GenericVolumeFactory()));
+    register_factory(auto_release_ptr<FactoryType>(new GridVolumeFactory()));
 
     // Register factories defined in plugins.
     register_factories_from_plugins<Volume>(
@@ -143,4 +143,18 @@ size_t get_rendering_thread_count(const ParamArray& params)
     return thread_count;
 }
 
+ThreadPlacement get_rendering_thread_placement(const ParamArray& params)
+{
+    const string placement =
+        params.get_optional<string>(
+            "thread_placement",
+            "none",
+            make_vector("none", "compact", "scatter"));
+
+    return
+        placement == "compact" ? ThreadPlacementCompact :
+        placement == "scatter" ? ThreadPlacementScatter :
+        ThreadPlacementNone;
+}
+
 }   // namespace renderer
@@ -32,6 +32,9 @@
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/thread.h"
+
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
@@ -55,6 +58,7 @@ std::string get_sampling_context_mode_name(const SamplingContext::Mode mode);
 
 // Rendering threads.
 APPLESEED_DLLSYMBOL size_t get_rendering_thread_count(const ParamArray& params);
+APPLESEED_DLLSYMBOL foundation::ThreadPlacement get_rendering_thread_placement(const ParamArray& params);
 
 }       // namespace renderer
 
@@ -57,6 +57,20 @@ CommandLineHandler::CommandLineHandler()
             .add_name("--print-bounding-boxes")
             .add_name("-b")
             .set_description("print mesh bounding boxes"));
+
+    parser().add_option_handler(
+        &m_binarymesh_version
+            .add_name("--binarymesh-version")
+            .set_description("set the format version of output binarymesh files (3 or 4)")
+            .set_syntax("version")
+            .set_exact_value_count(1)
+            .set_default_value(4));
+
+    parser().add_option_handler(
+        &m_compress
+            .add_name("--compress")
+            .add_name("-c")
+            .set_description("compress the arrays of output binarymesh files using format version 4"));
 }
 
 void CommandLineHandler::print_program_usage(
@@ -55,6 +55,8 @@ class CommandLineHandler
   public:
     foundation::ValueOptionHandler<std::string> m_filenames;
     foundation::FlagOptionHandler               m_print_bboxes;
+    foundation::ValueOptionHandler<int>         m_binarymesh_version;
+    foundation::FlagOptionHandler               m_compress;
 
     // Constructor.
     CommandLineHandler();
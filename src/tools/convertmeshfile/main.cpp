@@ -37,20 +37,28 @@
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
 #include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfilewriter.h"
 #include "foundation/mesh/genericmeshfilereader.h"
 #include "foundation/mesh/genericmeshfilewriter.h"
 #include "foundation/mesh/imeshbuilder.h"
+#include "foundation/mesh/imeshfilewriter.h"
 #include "foundation/mesh/imeshwalker.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem/path.hpp"
 
 // Standard headers.
 #include <cstddef>
 #include <deque>
 #include <exception>
 #include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -58,6 +66,7 @@ using namespace appleseed::convertmeshfile;
 using namespace appleseed::shared;
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace
 {
@@ -269,6 +278,25 @@ namespace
             bbox.min[0], bbox.min[1], bbox.min[2],
             bbox.max[0], bbox.max[1], bbox.max[2]);
     }
+
+    IMeshFileWriter* create_mesh_file_writer(
+        const CommandLineHandler&   cl,
+        const string&               filepath)
+    {
+        // binarymesh files honor the format version and compression options.
+        if (lower_case(bf::path(filepath).extension().string()) == ".binarymesh")
+        {
+            return
+                new BinaryMeshFileWriter(
+                    filepath,
+                    static_cast<uint16>(cl.m_binarymesh_version.value()),
+                    cl.m_compress.is_set()
+                        ? BinaryMeshFileWriter::CompressArrays
+                        : BinaryMeshFileWriter::Default);
+        }
+
+        return new GenericMeshFileWriter(filepath.c_str());
+    }
 }
 
 
@@ -334,13 +362,14 @@ int main(int argc, const char* argv[])
     }
 
     // Write the output mesh file.
-    GenericMeshFileWriter writer(output_filepath.c_str());
     try
     {
+        unique_ptr<IMeshFileWriter> writer(create_mesh_file_writer(cl, output_filepath));
+
         for (const_each<list<Mesh>> i = builder.get_meshes(); i; ++i)
         {
             const MeshWalker walker(*i);
-            writer.write(walker);
+            writer->write(walker);
         }
     }
     catch (const exception& e)